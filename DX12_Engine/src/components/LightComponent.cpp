@@ -2,6 +2,8 @@
 
 #include "engine/Utils.h"
 
+IMPLEMENT_POOLED_ALLOCATION(LightComponent, 128)
+
 LightComponent::LightComponent(const LightDesc & i_Desc, Actor * i_Actor)
 	:ActorComponent(i_Actor, "Light Component")
 {
@@ -18,6 +20,8 @@ LightComponent::LightComponent(const LightDesc & i_Desc, Actor * i_Actor)
 	// Spot light
 	m_Light->SetSpotAngleInDegree(i_Desc.SpotAngle);
 	m_Light->SetSoftEdges(i_Desc.SoftEdge);
+	// shadows
+	m_Light->SetCastShadows(i_Desc.CastShadows);
 
 #ifdef WITH_EDITOR
 	m_SpotLightAngle = i_Desc.SpotAngle;
@@ -118,6 +122,14 @@ void LightComponent::DrawUIComponentInternal()
 	case 2:		// directionnal light
 		break;
 	}
+
+	// shadows
+	if (selectedType != 0)
+	{
+		bool castShadows = m_Light->IsCastingShadows();
+		ImGui::Checkbox("Cast Shadows", &castShadows);
+		if (castShadows != m_Light->IsCastingShadows())	m_Light->SetCastShadows(castShadows);
+	}
 	
 
 }
@@ -6,6 +6,7 @@
 
 #include "engine/Light.h"
 #include "ActorComponent.h"
+#include "engine/ObjectPool.h"
 
 class LightComponent : public ActorComponent
 {
@@ -21,6 +22,8 @@ public:
 		// spot light edges
 		float					SpotAngle = 75.f;
 		float					SoftEdge = 0.05f;
+		// shadows (spot and directional lights)
+		bool					CastShadows = true;
 
 	};
 
@@ -28,6 +31,9 @@ public:
 	LightComponent(Actor * i_Actor);
 	~LightComponent();
 
+	// pooled allocation (see World::LoadScene)
+	DECLARE_POOLED_ALLOCATION()
+
 	// light management
 	Light *					GetLight() const;
 	Light::ELightType		GetLightType() const;
@@ -0,0 +1,138 @@
+#include "ParticleComponent.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12UploadBuffer.h"
+
+ParticleComponent::ParticleComponent(const ParticleComponentDesc & i_Desc, Actor * i_Actor)
+	:ActorComponent(i_Actor, "Particle Component")
+	,m_Desc(i_Desc.Emitter)
+	,m_Simulation(i_Desc.Simulation)
+	,m_VisibleCount(0)
+	,m_StreamBuffer(nullptr)
+	,m_KeyBuffer(nullptr)
+	,m_Buffers(nullptr)
+{
+	m_Desc.MaxParticles = Particles::GetCapacity(m_Desc.MaxParticles);
+	m_SimulateConstants = {};
+	m_SortConstants = {};
+
+	CreateSimulationData();
+}
+
+ParticleComponent::~ParticleComponent()
+{
+	ReleaseSimulationData();
+}
+
+RenderComponent::RenderPass ParticleComponent::GetRenderPass() const
+{
+	return RenderComponent::eSemiTransparent;
+}
+
+const Particles::EmitterDesc & ParticleComponent::GetEmitterDesc() const
+{
+	return m_Desc;
+}
+
+ParticleComponent::ESimulation ParticleComponent::GetSimulation() const
+{
+	return (m_Buffers != nullptr) ? eGPUSimulation : eCPUSimulation;
+}
+
+UINT ParticleComponent::GetCapacity() const
+{
+	return m_Desc.MaxParticles;
+}
+
+UINT ParticleComponent::GetVisibleCount() const
+{
+	return (m_Buffers != nullptr) ? m_Buffers->Capacity : m_VisibleCount;
+}
+
+const XMFLOAT3 & ParticleComponent::GetOrigin() const
+{
+	return m_SimulateConstants.Origin;
+}
+
+void ParticleComponent::SetSpawnRate(float i_SpawnRate)
+{
+	m_Desc.SpawnRate = i_SpawnRate;
+}
+
+void ParticleComponent::SetSimulation(ESimulation i_Simulation)
+{
+	m_Simulation = i_Simulation;
+	Reset();
+}
+
+void ParticleComponent::Reset()
+{
+	ReleaseSimulationData();
+	CreateSimulationData();
+}
+
+void ParticleComponent::CreateSimulationData()
+{
+	DX12Particles * particles = DX12RenderEngine::GetInstance().GetParticles();
+
+	m_State = Particles::EmitterState();
+	m_VisibleCount = 0;
+
+	// GPU simulation : the particles only live in GPU memory
+	if (m_Simulation == eGPUSimulation && particles != nullptr && particles->IsValid())
+	{
+		m_Buffers = particles->CreateEmitterBuffers(m_Desc.MaxParticles);
+		return;
+	}
+
+	// CPU simulation (or fallback)
+	Particles::AllocateStorage(m_Storage, m_Desc.MaxParticles);
+	m_Keys.resize(m_Storage.Capacity);
+	m_SortScratch.resize(m_Storage.Capacity);
+
+	m_StreamBuffer	= new DX12UploadBuffer(m_Storage.Capacity * Particles::eRenderStreamCount * sizeof(float), L"ParticleStreams");
+	m_KeyBuffer		= new DX12UploadBuffer(m_Storage.Capacity * sizeof(UINT64), L"ParticleKeys");
+}
+
+void ParticleComponent::ReleaseSimulationData()
+{
+	if (m_Buffers != nullptr)
+	{
+		DX12Particles * particles = DX12RenderEngine::GetInstance().GetParticles();
+
+		if (particles != nullptr)
+			particles->ReleaseEmitterBuffers(m_Buffers);
+
+		m_Buffers = nullptr;
+	}
+
+	Particles::FreeStorage(m_Storage);
+
+	delete m_StreamBuffer;
+	delete m_KeyBuffer;
+	m_StreamBuffer = m_KeyBuffer = nullptr;
+
+	m_Keys.clear();
+	m_SortScratch.clear();
+}
+
+#ifdef WITH_EDITOR
+#include "ui/UI.h"
+
+void ParticleComponent::DrawUIComponentInternal()
+{
+	ImGui::Text("Emitter : %s", m_Desc.Name.c_str());
+	ImGui::Text("Particles : %u / %u", GetVisibleCount(), GetCapacity());
+
+	ImGui::SliderFloat("Spawn Rate", &m_Desc.SpawnRate, 0.f, 100000.f, "%.0f", 3.f);
+	ImGui::SliderFloat("Drag", &m_Desc.Drag, 0.f, 5.f, "%.2f");
+	ImGui::SliderFloat("Size Start", &m_Desc.SizeStart, 0.f, 5.f, "%.2f");
+	ImGui::SliderFloat("Size End", &m_Desc.SizeEnd, 0.f, 5.f, "%.2f");
+	ImGui::ColorEdit4("Color Start", &m_Desc.ColorStart.x);
+	ImGui::ColorEdit4("Color End", &m_Desc.ColorEnd.x);
+
+	bool gpuSimulation = (m_Simulation == eGPUSimulation);
+	ImGui::Checkbox("GPU Simulation", &gpuSimulation);
+	if (gpuSimulation != (m_Simulation == eGPUSimulation))		SetSimulation(gpuSimulation ? eGPUSimulation : eCPUSimulation);
+}
+#endif
@@ -0,0 +1,78 @@
+// particle emitter attached to an actor
+// the particles are spawned around the world position of the actor and simulated in world space (see ParticleSystem)
+// the CPU emitters are simulated with SIMD on the workers, the GPU emitters with compute shaders before their draws
+// a GPU emitter is simulated on the CPU when the render engine has no GPU simulation (headless or shaders not compiled)
+// the particles are semi transparent : they are drawn after the lights, back to front (see RenderList::RenderTransparent)
+
+#pragma once
+
+#include "ActorComponent.h"
+#include "RenderComponent.h"
+#include "engine/Particles.h"
+#include "dx12/DX12Particles.h"
+#include <vector>
+
+class DX12UploadBuffer;
+
+class ParticleComponent : public ActorComponent
+{
+public:
+	enum ESimulation
+	{
+		eCPUSimulation,
+		eGPUSimulation,
+	};
+
+	struct ParticleComponentDesc
+	{
+		Particles::EmitterDesc		Emitter;
+		ESimulation					Simulation = eCPUSimulation;
+	};
+
+	ParticleComponent(const ParticleComponentDesc & i_Desc, Actor * i_Actor);
+	~ParticleComponent();
+
+	// information
+	RenderComponent::RenderPass			GetRenderPass() const;		// semi transparent
+	const Particles::EmitterDesc &		GetEmitterDesc() const;
+	ESimulation							GetSimulation() const;		// simulation used (a GPU emitter can fall back to the CPU)
+	UINT								GetCapacity() const;
+	UINT								GetVisibleCount() const;	// CPU : sorted particles of the last frame, GPU : capacity (sorted on the GPU)
+	const XMFLOAT3 &					GetOrigin() const;			// spawn position of the last frame
+
+	// management
+	void			SetSpawnRate(float i_SpawnRate);
+	void			SetSimulation(ESimulation i_Simulation);	// the particles are killed
+	void			Reset();	// kill the particles
+
+	friend class ParticleSystem;
+	friend class DX12RenderBackend;	// draws of the GPU buffers
+
+private:
+	void			CreateSimulationData();
+	void			ReleaseSimulationData();
+
+	// emitter
+	Particles::EmitterDesc				m_Desc;
+	ESimulation							m_Simulation;
+	Particles::EmitterState				m_State;
+	Particles::SimulateConstants		m_SimulateConstants;	// constants of the frame
+	Particles::SortConstants			m_SortConstants;
+
+	// CPU simulation
+	Particles::Storage					m_Storage;
+	std::vector<UINT64>					m_Keys;				// sorted keys of the visible particles
+	std::vector<UINT64>					m_SortScratch;
+	UINT								m_VisibleCount;
+	DX12UploadBuffer *					m_StreamBuffer;		// render streams of the frame (t0)
+	DX12UploadBuffer *					m_KeyBuffer;		// sorted keys of the frame (t1)
+
+	// GPU simulation
+	DX12Particles::EmitterBuffers *		m_Buffers;
+
+#ifdef WITH_EDITOR
+private:
+	// With editor only : draw component throught ui
+	virtual void	DrawUIComponentInternal() override;
+#endif
+};
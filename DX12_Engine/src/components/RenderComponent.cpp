@@ -6,12 +6,15 @@
 #include "resource/DX12Mesh.h"
 #include "resource/Mesh.h"
 
+IMPLEMENT_POOLED_ALLOCATION(RenderComponent, 512)
+
 RenderComponent::RenderComponent(const RenderComponentDesc & i_Desc, Actor * i_Actor)
 	:ActorComponent(i_Actor, "Render Component")
 	,m_Mesh(i_Desc.Mesh)
 	,m_ConstBuffer(UnavailableAdressId)
 	,m_Material(nullptr)
-	,m_RenderPass(RenderPass::eOpaqueGeometry)
+	,m_Animator(nullptr)
+	,m_RenderPass(i_Desc.Pass)
 {
 	// retreive the engine and load the mesh if needed
 	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
@@ -38,6 +41,7 @@ RenderComponent::RenderComponent(Actor * i_Actor)
 	,m_Mesh(nullptr)
 	,m_ConstBuffer(UnavailableAdressId)
 	,m_Material(nullptr)
+	,m_Animator(nullptr)
 	,m_RenderPass(RenderPass::eOpaqueGeometry)
 {
 	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
@@ -59,8 +63,8 @@ void RenderComponent::PushOnCommandList(ID3D12GraphicsCommandList * i_CommandLis
 	{
 		DX12RenderEngine & render = DX12RenderEngine::GetInstance();
 
-		//// add pso and root signature to the commandlist
-		m_Material->PushPipelineState(i_CommandList);
+		//// add pso and root signature to the commandlist (permutation depends on the mesh layout)
+		m_Material->PushPipelineState(i_CommandList, m_Mesh->GetElementFlags());
 
 		// push transform buffer
 		if (m_ConstBuffer != UnavailableAdressId)
@@ -72,6 +76,8 @@ void RenderComponent::PushOnCommandList(ID3D12GraphicsCommandList * i_CommandLis
 		i_CommandList->SetGraphicsRootConstantBufferView(1,	// 1 for b1 see the dx12 render engine constant buffer placement 
 			render.GetConstantBuffer(DX12RenderEngine::eGlobal)->GetUploadVirtualAddress(0U));
 
+		// parameter buffer and maps, then the parameter block of the material (the bindless heap is set once on the command list by the caller)
+		m_Material->PushSharedResources(i_CommandList);
 		m_Material->PushOnCommandList(i_CommandList);
 
 		// push the mesh on the commandlist (setup vertices)
@@ -94,6 +100,11 @@ ADDRESS_ID RenderComponent::GetConstBufferAddress() const
 	return m_ConstBuffer;
 }
 
+void RenderComponent::SetRenderPass(RenderPass i_Pass)
+{
+	m_RenderPass = i_Pass;
+}
+
 void RenderComponent::SetMaterial(const DX12Material * i_Material)
 {
 	m_Material = i_Material;
@@ -109,11 +120,21 @@ void RenderComponent::SetMeshBuffer(const DX12Mesh * i_Mesh)
 	m_Mesh = i_Mesh;
 }
 
-const DX12Mesh * RenderComponent::GetMeshBuffer()
+const DX12Mesh * RenderComponent::GetMeshBuffer() const
 {
 	return m_Mesh;
 }
 
+void RenderComponent::SetAnimator(const Animator * i_Animator)
+{
+	m_Animator = i_Animator;
+}
+
+const Animator * RenderComponent::GetAnimator() const
+{
+	return m_Animator;
+}
+
 bool RenderComponent::IsRenderable() const
 {
 	return (m_Mesh != nullptr && m_Material != nullptr);
@@ -131,6 +152,10 @@ bool RenderComponent::IsRenderable() const
 
 void RenderComponent::DrawUIComponentInternal()
 {
+	bool semiTransparent = (m_RenderPass == eSemiTransparent);
+	ImGui::Checkbox("Semi Transparent", &semiTransparent);
+	m_RenderPass = semiTransparent ? eSemiTransparent : eOpaqueGeometry;
+
 	DrawUIMaterial();
 	DrawUIMesh();
 }
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "ActorComponent.h"
+#include "engine/ObjectPool.h"
 #include "dx12/d3dx12.h"
 #include "dx12/DX12Utils.h"
 #include "resource/DX12Material.h"
@@ -15,6 +16,7 @@
 class DX12Texture;
 class DX12Mesh;
 class Actor;
+class Animator;
 
 class RenderComponent : public ActorComponent
 {
@@ -23,7 +25,7 @@ public:
 	enum RenderPass
 	{
 		eOpaqueGeometry,	// default
-		eSemiTransparent,
+		eSemiTransparent,	// forward pass after the lights, alpha blended (see RenderList::RenderTransparent)
 	};
 
 	// render flags for specific rendering
@@ -38,13 +40,17 @@ public:
 		// mesh
 		const DX12Mesh *				Mesh = nullptr;			// mesh pointer
 		const DX12Material	 *			Material = nullptr;		// if null, we take the default mesh material
+		RenderPass						Pass = eOpaqueGeometry;
 	};
 
 	RenderComponent(const RenderComponentDesc & i_Desc, Actor * i_Actor);
 	RenderComponent(Actor * i_Actor);	// empty component
 	~RenderComponent();
 
-	// manage command list
+	// pooled allocation (see World::LoadScene)
+	DECLARE_POOLED_ALLOCATION()
+
+	// manage command list (the bindless heap must be set on the command list, see DX12BindlessHeap::SetOnCommandList)
 	virtual void PushOnCommandList(ID3D12GraphicsCommandList * i_CommandList) const;
 	
 	// information
@@ -53,10 +59,13 @@ public:
 	ADDRESS_ID		GetConstBufferAddress() const;
 
 	// manage render stuff
+	void					SetRenderPass(RenderPass i_Pass);	// the alpha of the diffuse color is the opacity of the semi transparent pass
 	void					SetMaterial(const DX12Material * i_Material);
 	const DX12Material *	GetMaterial() const;
 	void					SetMeshBuffer(const DX12Mesh * i_Mesh);
-	const DX12Mesh *		GetMeshBuffer();
+	const DX12Mesh *		GetMeshBuffer() const;
+	void					SetAnimator(const Animator * i_Animator);	// skinned meshes : pose of the mesh (see AnimationSystem)
+	const Animator *		GetAnimator() const;
 
 	// render management
 	bool			IsRenderable() const;
@@ -65,6 +74,7 @@ private:
 	// rendering
 	const DX12Mesh *			m_Mesh;
 	const DX12Material *		m_Material;	// material instance that manage the rendering pass
+	const Animator *			m_Animator;	// skinned meshes are not rendered without animator
 
 	// dx12
 	ADDRESS_ID					m_ConstBuffer;	// const buffer for 3D matrices
@@ -0,0 +1,119 @@
+#include "DX12BindlessHeap.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12DescriptorHeap.h"
+#include "engine/Debug.h"
+
+DX12BindlessHeap::DX12BindlessHeap(UINT i_Capacity)
+	:m_DescriptorHeap(nullptr)
+	,m_Allocator(i_Capacity)
+	,m_Frame(0)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	heapDesc.NumDescriptors		= i_Capacity;
+	heapDesc.Type				= D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	heapDesc.Flags				= D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+	m_DescriptorHeap = new DX12DescriptorHeap(heapDesc, L"Bindless Heap");
+}
+
+DX12BindlessHeap::~DX12BindlessHeap()
+{
+	delete m_DescriptorHeap;
+}
+
+UINT DX12BindlessHeap::Allocate(UINT i_Count)
+{
+	const UINT index = m_Allocator.Allocate(i_Count);
+
+	if (index == DescriptorAllocator::InvalidIndex)
+	{
+		PRINT_DEBUG("Error, the bindless heap is full (%u descriptors)", m_Allocator.GetCapacity());
+		DEBUG_BREAK;
+	}
+
+	return index;
+}
+
+void DX12BindlessHeap::Free(UINT i_Index, UINT i_Count)
+{
+	if (i_Index == DescriptorAllocator::InvalidIndex)
+		return;
+
+	m_PendingRanges.push_back({ i_Index, i_Count, m_Frame });
+}
+
+void DX12BindlessHeap::BeginFrame()
+{
+	++m_Frame;
+
+	// the frames recorded since the free are finished
+	const UINT64 frameCount = (UINT64)DX12RenderEngine::GetInstance().GetFrameBufferCount();
+	auto itr = m_PendingRanges.begin();
+
+	while (itr != m_PendingRanges.end())
+	{
+		if (m_Frame < (*itr).Frame + frameCount)
+		{
+			++itr;
+			continue;
+		}
+
+		m_Allocator.Free((*itr).Index, (*itr).Count);
+		itr = m_PendingRanges.erase(itr);
+	}
+}
+
+void DX12BindlessHeap::CreateShaderResourceView(UINT i_Index, ID3D12Resource * i_Resource, const D3D12_SHADER_RESOURCE_VIEW_DESC * i_Desc) const
+{
+	if (i_Index == DescriptorAllocator::InvalidIndex)
+		return;
+
+	DX12RenderEngine::GetInstance().GetDevice()->CreateShaderResourceView(i_Resource, i_Desc, m_DescriptorHeap->GetCPUDescriptorHandle(i_Index));
+}
+
+void DX12BindlessHeap::CreateUnorderedAccessView(UINT i_Index, ID3D12Resource * i_Resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC * i_Desc) const
+{
+	if (i_Index == DescriptorAllocator::InvalidIndex)
+		return;
+
+	DX12RenderEngine::GetInstance().GetDevice()->CreateUnorderedAccessView(i_Resource, nullptr, i_Desc, m_DescriptorHeap->GetCPUDescriptorHandle(i_Index));
+}
+
+void DX12BindlessHeap::SetOnCommandList(ID3D12GraphicsCommandList * i_CommandList) const
+{
+	ID3D12DescriptorHeap * descriptors = m_DescriptorHeap->GetDescriptorHeap();
+	i_CommandList->SetDescriptorHeaps(1, &descriptors);
+}
+
+ID3D12DescriptorHeap * DX12BindlessHeap::GetDescriptorHeap() const
+{
+	return m_DescriptorHeap->GetDescriptorHeap();
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE DX12BindlessHeap::GetGPUDescriptorHandle() const
+{
+	return m_DescriptorHeap->GetGPUDescriptorHandle();
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE DX12BindlessHeap::GetGPUDescriptorHandle(UINT i_Index) const
+{
+	return m_DescriptorHeap->GetGPUDescriptorHandle(i_Index);
+}
+
+const DescriptorAllocator & DX12BindlessHeap::GetAllocator() const
+{
+	return m_Allocator;
+}
+
+UINT DX12BindlessHeap::GetPendingCount() const
+{
+	UINT count = 0;
+
+	for (size_t i = 0; i < m_PendingRanges.size(); ++i)
+	{
+		count += m_PendingRanges[i].Count;
+	}
+
+	return count;
+}
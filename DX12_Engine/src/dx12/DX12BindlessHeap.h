@@ -0,0 +1,51 @@
+// bindless descriptor heap
+// one shader visible heap (CBV, SRV, UAV) for the textures and the render targets : each resource keeps a persistent index in the heap
+// shaders index the textures with an integer (see Bindless.hlsli), the heap is set once per command list and bound as one table
+// indices are allocated by a DescriptorAllocator, freed indices are reused after the frames in flight (the GPU can still read them)
+
+#pragma once
+
+#include "d3dx12.h"
+#include "engine/DescriptorAllocator.h"
+#include <vector>
+
+class DX12DescriptorHeap;
+
+class DX12BindlessHeap
+{
+public:
+	DX12BindlessHeap(UINT i_Capacity);
+	~DX12BindlessHeap();
+
+	// index management
+	UINT			Allocate(UINT i_Count = 1);	// DescriptorAllocator::InvalidIndex when the heap is full
+	void			Free(UINT i_Index, UINT i_Count = 1);
+	void			BeginFrame();	// call it once per frame when the previous frame of the index is finished : reuse the indices of the retired frames
+
+	// views
+	void			CreateShaderResourceView(UINT i_Index, ID3D12Resource * i_Resource, const D3D12_SHADER_RESOURCE_VIEW_DESC * i_Desc) const;
+	void			CreateUnorderedAccessView(UINT i_Index, ID3D12Resource * i_Resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC * i_Desc) const;	// compute outputs (bound with GetGPUDescriptorHandle(index))
+
+	// dx12
+	void							SetOnCommandList(ID3D12GraphicsCommandList * i_CommandList) const;	// before binding the table
+	ID3D12DescriptorHeap *			GetDescriptorHeap() const;
+	D3D12_GPU_DESCRIPTOR_HANDLE		GetGPUDescriptorHandle() const;	// table of the whole heap
+	D3D12_GPU_DESCRIPTOR_HANDLE		GetGPUDescriptorHandle(UINT i_Index) const;	// table starting at an index
+
+	// information
+	const DescriptorAllocator &		GetAllocator() const;
+	UINT							GetPendingCount() const;	// indices waiting for the frames in flight
+
+private:
+	struct PendingRange
+	{
+		UINT		Index;
+		UINT		Count;
+		UINT64		Frame;	// frame of the free
+	};
+
+	DX12DescriptorHeap *		m_DescriptorHeap;
+	DescriptorAllocator			m_Allocator;
+	std::vector<PendingRange>	m_PendingRanges;
+	UINT64						m_Frame;
+};
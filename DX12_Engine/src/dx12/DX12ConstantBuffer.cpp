@@ -1,16 +1,16 @@
 #include "dx12/DX12ConstantBuffer.h"
 #include "dx12/DX12RenderEngine.h"
+#include "engine/RenderBackend.h"
 
 
 DX12ConstantBuffer::DX12ConstantBuffer(UINT64 i_BufferSize, UINT64 i_ElementSize, const wchar_t * i_Name /* = L"Unnamed" */, bool i_IsDucpliacted /* = true */)
 	:m_ElementSize((i_ElementSize + 255) & ~255)	// align element size on 256 bytes
 	,m_BufferSize(i_BufferSize)
 	,m_IsDuplicated(i_IsDucpliacted)
-	,m_ConstantBufferUploadHeap(nullptr)
+	,m_ConstantBufferMemory(nullptr)
 {
-	// retreive device
 	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
-	ID3D12Device * device = render.GetDevice();
+	RenderBackend * backend = render.GetBackend();
 
 	// retreive the frame count (one buffer is going to be created for each frame index)
 	if (m_IsDuplicated)
@@ -19,8 +19,7 @@ DX12ConstantBuffer::DX12ConstantBuffer(UINT64 i_BufferSize, UINT64 i_ElementSize
 		m_FrameCount = 1;	// only one buffer
 
 	// initialize arrays
-	m_ConstantBufferUploadHeap	= new ID3D12Resource *[m_FrameCount];	// memory where constant buffers for each frame will be placed
-	m_ConstantBufferGPUAdress	= new UINT8 *[m_FrameCount];	// pointer for each of the resource buffer constant heap
+	m_ConstantBufferMemory = new RenderBackend::UploadMemory[m_FrameCount];	// memory where constant buffers for each frame will be placed
 
 	// allocate and intialize available blocks
 	m_ConstantBufferReservedAddress = new bool[i_BufferSize];
@@ -29,33 +28,30 @@ DX12ConstantBuffer::DX12ConstantBuffer(UINT64 i_BufferSize, UINT64 i_ElementSize
 		m_ConstantBufferReservedAddress[i] = false;
 	}
 
+	const UINT64 heapSize = m_ConstantBufferHeapSize * m_ElementSize * 64;	// size of the resource heap. Must be a multiple of 64KB for single-textures and constant buffers
+	m_Allocation = backend->TrackAllocation(i_Name, heapSize * m_FrameCount);
+
 	// create constant buffer
 	for (UINT i = 0; i < m_FrameCount; ++i)
 	{
-		DX12_ASSERT(device->CreateCommittedResource(
-			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // this heap will be used to upload the constant buffer data
-			D3D12_HEAP_FLAG_NONE, // no flags
-			&CD3DX12_RESOURCE_DESC::Buffer(m_ConstantBufferHeapSize * m_ElementSize * 64), // size of the resource heap. Must be a multiple of 64KB for single-textures and constant buffers
-			D3D12_RESOURCE_STATE_GENERIC_READ, // will be data that is read from so we keep it in the generic read state
-			nullptr, // we do not have use an optimized clear value for constant buffers
-			IID_PPV_ARGS(&m_ConstantBufferUploadHeap[i])));
-
-		m_ConstantBufferUploadHeap[i]->SetName(i_Name);
-
-		CD3DX12_RANGE readRange(0, 0);    // We do not intend to read from this resource on the CPU. (so end is less than or equal to begin)
-		DX12_ASSERT(m_ConstantBufferUploadHeap[i]->Map(0, &readRange, reinterpret_cast<void**>(&m_ConstantBufferGPUAdress[i])));
+		backend->CreateUploadMemory(heapSize, i_Name, m_ConstantBufferMemory[i]);
 	}
 }
 
 
 DX12ConstantBuffer::~DX12ConstantBuffer()
 {
+	RenderBackend * backend = DX12RenderEngine::GetInstance().GetBackend();
+
 	for (UINT i = 0; i < m_FrameCount; ++i)
 	{
-		//SAFE_RELEASE(m_ConstantBufferUploadHeap[i]);
+		backend->ReleaseUploadMemory(m_ConstantBufferMemory[i]);
 	}
 
+	backend->ReleaseAllocation(m_Allocation);
+
 	// Delete the array
+	delete[] m_ConstantBufferMemory;
 	delete[] m_ConstantBufferReservedAddress;
 }
 
@@ -84,7 +80,7 @@ ADDRESS_ID DX12ConstantBuffer::ReserveVirtualAddress(bool i_Initialize /* = fals
 		for (size_t i = 0; i < m_FrameCount; ++i)
 		{
 			// zero memory on the constant buffer position
-			ZeroMemory(m_ConstantBufferGPUAdress[i] + (address * m_ElementSize), m_ElementSize);
+			ZeroMemory(m_ConstantBufferMemory[i].CPUAddress + (address * m_ElementSize), m_ElementSize);
 		}
 	}
 
@@ -108,7 +104,7 @@ UINT8 * DX12ConstantBuffer::GetGPUAddress(ADDRESS_ID i_Address) const
 	ASSERT(i_Address < m_BufferSize);
 
 	const int frameIndex = GetFrameIndex();
-	return m_ConstantBufferGPUAdress[frameIndex] + (i_Address * m_ElementSize);
+	return m_ConstantBufferMemory[frameIndex].CPUAddress + (i_Address * m_ElementSize);
 }
 
 D3D12_GPU_VIRTUAL_ADDRESS DX12ConstantBuffer::GetUploadVirtualAddress(ADDRESS_ID i_Address) const
@@ -123,7 +119,7 @@ D3D12_GPU_VIRTUAL_ADDRESS DX12ConstantBuffer::GetUploadVirtualAddress(ADDRESS_ID
 		DEBUG_BREAK;
 	}
 
-	return m_ConstantBufferUploadHeap[frameIndex]->GetGPUVirtualAddress() + (i_Address * m_ElementSize);
+	return m_ConstantBufferMemory[frameIndex].GPUAddress + (i_Address * m_ElementSize);
 }
 
 UINT64 DX12ConstantBuffer::GetConstantElementSize() const
@@ -141,7 +137,7 @@ void DX12ConstantBuffer::UpdateConstantBuffer(ADDRESS_ID i_Address, const void *
 	if (m_ConstantBufferReservedAddress[i_Address] == true)
 	{
 		// copy data to the constant buffer
-		memcpy(m_ConstantBufferGPUAdress[frameIndex] + (i_Address * m_ElementSize), i_Data, i_Size);
+		memcpy(m_ConstantBufferMemory[frameIndex].CPUAddress + (i_Address * m_ElementSize), i_Data, i_Size);
 	}
 	else
 	{
@@ -160,7 +156,7 @@ void DX12ConstantBuffer::UpdateConstantBufferForEachFrame(ADDRESS_ID i_Address,
 		for (UINT i = 0; i < m_FrameCount; ++i)
 		{
 			// copy data to the constant buffer
-			memcpy(m_ConstantBufferGPUAdress[i] + (i_Address * m_ElementSize), i_Data, i_Size);
+			memcpy(m_ConstantBufferMemory[i].CPUAddress + (i_Address * m_ElementSize), i_Data, i_Size);
 		}
 	}
 	else
@@ -4,6 +4,7 @@
 #include <d3d12.h>
 
 #include "dx12/DX12Utils.h"
+#include "engine/RenderBackend.h"
 
 class DX12ConstantBuffer
 {
@@ -30,13 +31,13 @@ private:
 	int							GetFrameIndex() const;
 
 	// dx12
-	ID3D12Resource **			m_ConstantBufferUploadHeap;	// memory where constant buffers for each frame will be placed
-	UINT8 **					m_ConstantBufferGPUAdress;	// pointer for each of the resource buffer constant heap
+	RenderBackend::UploadMemory *	m_ConstantBufferMemory;	// memory where constant buffers for each frame will be placed (created by the render backend)
 	bool *						m_ConstantBufferReservedAddress;	// internal constant buffer management
 	UINT						m_ConstantBufferHeapSize = 32;
 	// internal management
 	UINT					m_FrameCount;
 	const bool				m_IsDuplicated;
+	UINT					m_Allocation;	// allocation tracked by the render backend
 
 	// Constant buffer management
 	const UINT64		m_ElementSize;	// size of one constant buffer per object
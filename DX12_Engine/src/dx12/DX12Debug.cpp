@@ -8,7 +8,10 @@
 #include "dx12/DX12PipelineState.h"
 #include "dx12/DX12RenderTarget.h"
 #include "dx12/DX12DepthBuffer.h"
+#include "dx12/DX12BindlessHeap.h"
 #include "dx12/DX12Utils.h"
+#include "engine/DebugDraw.h"
+#include "engine/Transform.h"
 
 // singleton management
 DX12Debug * DX12Debug::s_Instance = nullptr;
@@ -31,14 +34,19 @@ void DX12Debug::Delete()
 	delete s_Instance;
 }
 
-void DX12Debug::DrawDebugBox(const DirectX::XMFLOAT3 & i_Position, const Transform & i_Transform, Color & i_Color)
+void DX12Debug::DrawDebugBox(const DirectX::XMFLOAT3 & i_Position, const Transform & i_Transform, const Color & i_Color, float i_Lifetime, bool i_DepthTest)
 {
-	TO_DO;
+	// the matrix of the transform is computed on a copy
+	Transform transform = i_Transform;
+	transform.SetPosition(i_Position);
+
+	const DirectX::XMFLOAT4X4 matrix = transform.GetMatrix();
+	DebugDraw::AddBox(DirectX::XMLoadFloat4x4(&matrix), i_Color, i_Lifetime, i_DepthTest);
 }
 
-void DX12Debug::DrawDebugLine(const DirectX::XMFLOAT3 & i_Start, const DirectX::XMFLOAT3 & i_End, Color & i_Color)
+void DX12Debug::DrawDebugLine(const DirectX::XMFLOAT3 & i_Start, const DirectX::XMFLOAT3 & i_End, const Color & i_Color, float i_Lifetime, bool i_DepthTest)
 {
-	TO_DO;
+	DebugDraw::AddLine(i_Start, i_End, i_Color, i_Lifetime, i_DepthTest);
 }
 
 void DX12Debug::SetEnabled(bool i_Enabled)
@@ -54,14 +62,8 @@ bool DX12Debug::IsEnabled() const
 DX12Debug::DX12Debug(const DX12DebugDesc & i_Setup)
 	// debug options
 	:m_Enabled(i_Setup.EnabledByDefault)
+	,m_DepthDesc(i_Setup.DepthBuffer)
 {
-	// retreive render targets
-	for (UINT i = 0; i < DX12RenderEngine::eRenderTargetCount; ++i)
-	{
-		ASSERT(i_Setup.RenderTarget[i] != nullptr);
-		m_GBufferRT[i] = i_Setup.RenderTarget[i];
-	}
-
 	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
 
 	// generate pipeline state object for GBuffer draw debug
@@ -86,19 +88,16 @@ DX12Debug::DX12Debug(const DX12DebugDesc & i_Setup)
 
 	m_GBufferDebugRS->AddStaticSampler(sampler);	// add static sampl
 
-													// add textures
-	D3D12_DESCRIPTOR_RANGE descriptorTableRanges[1];
+	// textures : the GBuffer targets and the depth buffer are indexed in the bindless heap
+	D3D12_DESCRIPTOR_RANGE bindlessRange;
+	bindlessRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+	bindlessRange.NumDescriptors = (UINT)-1;	// unbounded
+	bindlessRange.BaseShaderRegister = 0;
+	bindlessRange.RegisterSpace = 1;
+	bindlessRange.OffsetInDescriptorsFromTableStart = 0;
 
-	for (UINT i = 0; i < 1; ++i)
-	{
-		descriptorTableRanges[i].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV; // this is a range of shader resource views (descriptors)
-		descriptorTableRanges[i].NumDescriptors = 1; // we only have one texture right now, so the range is only 1
-		descriptorTableRanges[i].BaseShaderRegister = i; // start index of the shader registers in the range
-		descriptorTableRanges[i].RegisterSpace = 0; // space 0. can usually be zero
-		descriptorTableRanges[i].OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND; // this appends the range to the end of the root signature descriptor tables
-	}
-
-	m_GBufferDebugRS->AddDescriptorRange(descriptorTableRanges, 1, D3D12_SHADER_VISIBILITY_PIXEL);	// texture to render
+	m_GBufferDebugRS->AddDescriptorRange(&bindlessRange, 1, D3D12_SHADER_VISIBILITY_PIXEL);	// bindless textures (t0, space1)
+	m_GBufferDebugRS->AddConstants(1, 0, 0, D3D12_SHADER_VISIBILITY_PIXEL);					// texture to render (b0)
 
 	m_GBufferDebugRS->Create(device);
 
@@ -135,32 +134,28 @@ void DX12Debug::DrawDebugGBuffer(ID3D12GraphicsCommandList * i_CommandList) cons
 	if (!m_Enabled)		return;
 
 	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
-	const UINT frameIndex = render.GetFrameIndex();
+	DX12BindlessHeap * bindlessHeap = render.GetBindlessHeap();
 
-	static const DX12RenderTarget * rt[4]
+	// the last view is the depth buffer (the position is not stored anymore)
+	const UINT textureIndices[4]
 	{
-		m_GBufferRT[DX12RenderEngine::eDiffuse],
-		m_GBufferRT[DX12RenderEngine::eNormal],
-		m_GBufferRT[DX12RenderEngine::eSpecular],
-		m_GBufferRT[DX12RenderEngine::ePosition]
+		render.GetRenderTargetBindlessIndex(DX12RenderEngine::eDiffuse),
+		render.GetRenderTargetBindlessIndex(DX12RenderEngine::eNormal),
+		render.GetRenderTargetBindlessIndex(DX12RenderEngine::eSpecular),
+		m_DepthDesc->GetBindlessIndex()
 	};
-	
-	ID3D12DescriptorHeap * descriptors = nullptr;
 
 	i_CommandList->SetGraphicsRootSignature(m_GBufferDebugRS->GetRootSignature());
 	i_CommandList->SetPipelineState(m_GBufferDebugPSO->GetPipelineState());
+	bindlessHeap->SetOnCommandList(i_CommandList);
+	i_CommandList->SetGraphicsRootDescriptorTable(0, bindlessHeap->GetGPUDescriptorHandle());
 
 	for (UINT i = 0; i < 4; ++i)
 	{
 		D3D12_VIEWPORT viewport = render.GetViewportOnRect(m_Rect[i]);
 
 		i_CommandList->RSSetViewports(1, &viewport);
-
-		// bind render targets as textures
-		descriptors = rt[i]->GetShaderResourceDescriptorHeap()->GetDescriptorHeap();
-		// update the descriptor for the resources
-		i_CommandList->SetDescriptorHeaps(1, &descriptors);
-		i_CommandList->SetGraphicsRootDescriptorTable(0, rt[i]->GetShaderResourceDescriptorHeap()->GetGPUDescriptorHandle(frameIndex));
+		i_CommandList->SetGraphicsRoot32BitConstant(1, textureIndices[i], 0);
 
 		// draw 2D rect
 		render.PushRectPrimitive2D(i_CommandList);
@@ -33,14 +33,10 @@ public:
 		// default debug
 		bool					EnabledByDefault = true;
 
-		// render target setups
+		// render target setups (the GBuffer targets are retreived each frame from the render engine)
 		DX12RenderTarget *		BackBuffer = nullptr;
-		DX12RenderTarget *		RenderTarget[DX12RenderEngine::eRenderTargetCount];	// Render targets
 		// depth buffer descriptor
 		DX12DepthBuffer *		DepthBuffer = nullptr;
-
-		// 3D render debug
-		UINT32		LineCount;	// line count for 3D debug
 	};
 
 	// Singleton
@@ -48,9 +44,9 @@ public:
 	static void					Create(const DX12DebugDesc & i_Setup);
 	static void					Delete();
 
-	// draw debug 3D (To do : implement)
-	void			DrawDebugBox(const DirectX::XMFLOAT3 & i_Position, const Transform & i_Transform, Color & i_Color);
-	void			DrawDebugLine(const DirectX::XMFLOAT3 & i_Start, const DirectX::XMFLOAT3 & i_End, Color & i_Color);
+	// draw debug 3D (see DebugDraw : the primitives are drawn after the lights, lifetime in seconds)
+	void			DrawDebugBox(const DirectX::XMFLOAT3 & i_Position, const Transform & i_Transform, const Color & i_Color, float i_Lifetime = 0.f, bool i_DepthTest = true);	// [-1, 1] box at the position, rotated and scaled by the transform
+	void			DrawDebugLine(const DirectX::XMFLOAT3 & i_Start, const DirectX::XMFLOAT3 & i_End, const Color & i_Color, float i_Lifetime = 0.f, bool i_DepthTest = true);
 
 	// debug management
 	void			SetEnabled(bool i_Enabled);
@@ -64,7 +60,7 @@ private:
 	static DX12Debug *		s_Instance;
 
 	// internal debug management (managed by RenderEngine)
-	void			DrawDebugGBuffer(ID3D12GraphicsCommandList * i_CommandList) const;	// draw GBuffer on the immediate context
+	void			DrawDebugGBuffer(ID3D12GraphicsCommandList * i_CommandList) const;	// draw GBuffer on the immediate context (textures of the bindless heap)
 	void			GenerateViewportGrid(std::vector<Rect> & o_Vec, UINT i_XCount, UINT i_YCount);
 
 	DX12Debug(const DX12DebugDesc & i_Setup);
@@ -73,8 +69,6 @@ private:
 	// debug management
 	bool		m_Enabled;
 
-	// GBuffer render targets
-	DX12RenderTarget *			m_GBufferRT[DX12RenderEngine::eRenderTargetCount];
 	// Depth
 	DX12DepthBuffer *			m_DepthDesc;	// depth render (special render target)
 
@@ -1,10 +1,14 @@
 #include "DX12DepthBuffer.h"
 
 #include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12DescriptorHeap.h"
+#include "dx12/DX12BindlessHeap.h"
 
 DX12DepthBuffer::DX12DepthBuffer(const DepthBufferDesc & i_Desc)
 	:m_DepthStencilBuffer(nullptr)
 	,m_DepthStencilDescriptorHeap(nullptr)
+	,m_ShaderResourceDesc(nullptr)
+	,m_BindlessIndex(DescriptorAllocator::InvalidIndex)
 	,m_Format(i_Desc.Format)
 {
 	// retreive the device to create resource
@@ -27,11 +31,15 @@ DX12DepthBuffer::DX12DepthBuffer(const DepthBufferDesc & i_Desc)
 	depthOptimizedClearValue.DepthStencil.Depth = 1.0f;
 	depthOptimizedClearValue.DepthStencil.Stencil = 0;
 
+	// a depth read by shaders is typeless : seen as D32 by the depth stencil view and as R32 by the shader resource view
+	// it starts as a texture, the pass writing depth transition it to depth write
+	ASSERT(!i_Desc.IsShaderResource || i_Desc.Format == DXGI_FORMAT_D32_FLOAT);
+
 	device->CreateCommittedResource(
 		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
 		D3D12_HEAP_FLAG_NONE,
-		&CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D32_FLOAT, (UINT)i_Desc.BufferSize.x, (UINT)i_Desc.BufferSize.y, 1, 0, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL),
-		D3D12_RESOURCE_STATE_DEPTH_WRITE,
+		&CD3DX12_RESOURCE_DESC::Tex2D(i_Desc.IsShaderResource ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_D32_FLOAT, (UINT)i_Desc.BufferSize.x, (UINT)i_Desc.BufferSize.y, 1, 0, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL),
+		i_Desc.IsShaderResource ? D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE : D3D12_RESOURCE_STATE_DEPTH_WRITE,
 		&depthOptimizedClearValue,
 		IID_PPV_ARGS(&m_DepthStencilBuffer)
 	);
@@ -39,12 +47,38 @@ DX12DepthBuffer::DX12DepthBuffer(const DepthBufferDesc & i_Desc)
 	m_DepthStencilDescriptorHeap->SetName((i_Desc.Name + L" Resource Heap").c_str());
 	device->CreateDepthStencilView(m_DepthStencilBuffer, &depthStencilViewDesc, m_DepthStencilDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 	m_DepthStencilBuffer->SetName((i_Desc.Name + L" Buffer").c_str());
+
+	if (i_Desc.IsShaderResource)
+	{
+		// shader resource view
+		D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
+		srvHeapDesc.NumDescriptors		= 1;
+		srvHeapDesc.Type				= D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+		srvHeapDesc.Flags				= D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+		m_ShaderResourceDesc = new DX12DescriptorHeap(srvHeapDesc, (i_Desc.Name + L" SRV").c_str());
+
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Shader4ComponentMapping		= D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Format						= DXGI_FORMAT_R32_FLOAT;
+		srvDesc.ViewDimension				= D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels			= 1;
+
+		device->CreateShaderResourceView(m_DepthStencilBuffer, &srvDesc, m_ShaderResourceDesc->GetCPUDescriptorHandle());
+
+		// the same view in the bindless heap
+		DX12BindlessHeap * bindlessHeap = DX12RenderEngine::GetInstance().GetBindlessHeap();
+		m_BindlessIndex = bindlessHeap->Allocate();
+		bindlessHeap->CreateShaderResourceView(m_BindlessIndex, m_DepthStencilBuffer, &srvDesc);
+	}
 }
 
 DX12DepthBuffer::~DX12DepthBuffer()
 {
 	SAFE_RELEASE(m_DepthStencilBuffer);
 	SAFE_RELEASE(m_DepthStencilDescriptorHeap);
+	if (m_ShaderResourceDesc != nullptr) delete m_ShaderResourceDesc;
+	DX12RenderEngine::GetInstance().GetBindlessHeap()->Free(m_BindlessIndex);
 }
 
 DXGI_FORMAT DX12DepthBuffer::GetFormat() const
@@ -56,3 +90,23 @@ ID3D12DescriptorHeap * DX12DepthBuffer::GetDepthStencilDescriptorHeap() const
 {
 	return m_DepthStencilDescriptorHeap;
 }
+
+DX12DescriptorHeap * DX12DepthBuffer::GetShaderResourceDescriptorHeap() const
+{
+	return m_ShaderResourceDesc;
+}
+
+CD3DX12_RESOURCE_BARRIER DX12DepthBuffer::GetResourceBarrier(D3D12_RESOURCE_STATES i_StateBefore, D3D12_RESOURCE_STATES i_StateAfter) const
+{
+	return CD3DX12_RESOURCE_BARRIER::Transition(m_DepthStencilBuffer, i_StateBefore, i_StateAfter);
+}
+
+bool DX12DepthBuffer::IsShaderResource() const
+{
+	return m_ShaderResourceDesc != nullptr;
+}
+
+UINT DX12DepthBuffer::GetBindlessIndex() const
+{
+	return m_BindlessIndex;
+}
@@ -6,6 +6,8 @@
 #include "engine/Utils.h"
 #include <string>
 
+class DX12DescriptorHeap;
+
 class DX12DepthBuffer
 {
 public:
@@ -15,6 +17,7 @@ public:
 		D3D12_DSV_FLAGS	Flags	= D3D12_DSV_FLAG_NONE;
 		D3D12_CLEAR_VALUE	DepthOptimizedClearValue = { DXGI_FORMAT_D32_FLOAT , { 1.f, 0.f } };
 		IntVec2				BufferSize;
+		bool				IsShaderResource = false;	// the depth can be read by shaders (typeless resource that starts in the pixel shader resource state)
 
 		std::wstring			Name = L"Depth Stencil";
 
@@ -27,12 +30,18 @@ public:
 	DXGI_FORMAT			GetFormat() const;
 
 	ID3D12DescriptorHeap *		GetDepthStencilDescriptorHeap() const;
+	DX12DescriptorHeap *		GetShaderResourceDescriptorHeap() const;	// null if the depth buffer is not a shader resource
+	CD3DX12_RESOURCE_BARRIER	GetResourceBarrier(D3D12_RESOURCE_STATES i_StateBefore, D3D12_RESOURCE_STATES i_StateAfter) const;
+	bool						IsShaderResource() const;
+	UINT						GetBindlessIndex() const;	// index of the depth in the bindless heap (see DX12BindlessHeap)
 
 private:
 	// dx12
 	ID3D12Resource*				m_DepthStencilBuffer; // This is the memory for our depth buffer. it will also be used for a stencil buffer in a later tutorial
 	ID3D12DescriptorHeap*		m_DepthStencilDescriptorHeap; // This is a heap for our depth/stencil buffer descriptor
+	DX12DescriptorHeap *		m_ShaderResourceDesc;	// shader resource view of the depth
+	UINT						m_BindlessIndex;
 
 	// informations
 	DXGI_FORMAT			m_Format;
-};
\ No newline at end of file
+};
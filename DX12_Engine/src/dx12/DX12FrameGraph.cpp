@@ -0,0 +1,389 @@
+#include "DX12FrameGraph.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12DescriptorHeap.h"
+#include "dx12/DX12BindlessHeap.h"
+#include "dx12/DX12Utils.h"
+#include "engine/Debug.h"
+
+// formats of the resource and of its views (depth buffers are typeless to be read as textures)
+static FORCEINLINE void GetFormats(DXGI_FORMAT i_Format, bool i_IsDepth, DXGI_FORMAT & o_ResourceFormat, DXGI_FORMAT & o_ShaderResourceFormat)
+{
+	o_ResourceFormat		= i_Format;
+	o_ShaderResourceFormat	= i_Format;
+
+	if (!i_IsDepth)
+		return;
+
+	switch (i_Format)
+	{
+	case DXGI_FORMAT_D32_FLOAT:
+		o_ResourceFormat		= DXGI_FORMAT_R32_TYPELESS;
+		o_ShaderResourceFormat	= DXGI_FORMAT_R32_FLOAT;
+		break;
+	case DXGI_FORMAT_D24_UNORM_S8_UINT:
+		o_ResourceFormat		= DXGI_FORMAT_R24G8_TYPELESS;
+		o_ShaderResourceFormat	= DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+		break;
+	case DXGI_FORMAT_D16_UNORM:
+		o_ResourceFormat		= DXGI_FORMAT_R16_TYPELESS;
+		o_ShaderResourceFormat	= DXGI_FORMAT_R16_UNORM;
+		break;
+	default:
+		o_ShaderResourceFormat	= DXGI_FORMAT_UNKNOWN;	// no shader resource view
+		break;
+	}
+}
+
+DX12FrameGraph::DX12FrameGraph(UINT i_MaxResourceCount)
+	:m_MaxResourceCount(i_MaxResourceCount)
+	,m_Heap(nullptr)
+	,m_HeapSize(0)
+{
+	m_PlacedResources.resize(m_MaxResourceCount);
+	m_Resources.resize(m_MaxResourceCount, nullptr);
+
+	// views are created in the slot of the resource id
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	heapDesc.NumDescriptors		= m_MaxResourceCount;
+	heapDesc.Flags				= D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+	m_RenderTargetHeap = new DX12DescriptorHeap(heapDesc, L"Frame Graph RTV");
+
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+	m_DepthStencilHeap = new DX12DescriptorHeap(heapDesc, L"Frame Graph DSV");
+}
+
+DX12FrameGraph::~DX12FrameGraph()
+{
+	for (size_t i = 0; i < m_ReleaseQueue.size(); ++i)
+	{
+		SAFE_RELEASE(m_ReleaseQueue[i].Object);
+	}
+
+	// deleted after the render engine : the bindless heap is already released with the views
+	for (size_t i = 0; i < m_PlacedResources.size(); ++i)
+	{
+		SAFE_RELEASE(m_PlacedResources[i].Resource);
+	}
+
+	SAFE_RELEASE(m_Heap);
+
+	delete m_RenderTargetHeap;
+	delete m_DepthStencilHeap;
+}
+
+FrameGraph::TextureDesc DX12FrameGraph::GetTextureDesc(UINT i_Width, UINT i_Height, DXGI_FORMAT i_Format, bool i_IsDepth, const float * i_ClearValue)
+{
+	DXGI_FORMAT resourceFormat, shaderResourceFormat;
+	GetFormats(i_Format, i_IsDepth, resourceFormat, shaderResourceFormat);
+
+	FrameGraph::TextureDesc desc;
+	desc.Width		= i_Width;
+	desc.Height		= i_Height;
+	desc.Format		= (UINT)i_Format;
+	desc.IsDepth	= i_IsDepth;
+
+	if (i_ClearValue != nullptr)
+	{
+		for (UINT i = 0; i < 4; ++i)
+		{
+			desc.ClearValue[i] = i_ClearValue[i];
+		}
+	}
+	else if (i_IsDepth)
+	{
+		desc.ClearValue[0] = 1.f;
+	}
+
+	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
+
+	// headless : the graph is compiled without placed resources, the size is estimated from the format
+	if (device == nullptr)
+	{
+		const UINT64 pixelSize = Math::Max((UINT64)GetDXGIFormatBitsPerPixel(resourceFormat) / 8, (UINT64)1);
+		desc.Size = ((UINT64)i_Width * i_Height * pixelSize + desc.Alignment - 1) / desc.Alignment * desc.Alignment;
+		return desc;
+	}
+
+	const D3D12_RESOURCE_FLAGS flags = i_IsDepth ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+	const D3D12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Tex2D(resourceFormat, i_Width, i_Height, 1, 1, 1, 0, flags);
+	const D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+
+	desc.Size		= info.SizeInBytes;
+	desc.Alignment	= info.Alignment;
+
+	return desc;
+}
+
+D3D12_RESOURCE_STATES DX12FrameGraph::GetResourceState(FrameGraph::EResourceState i_State)
+{
+	switch (i_State)
+	{
+	case FrameGraph::eRenderTarget:		return D3D12_RESOURCE_STATE_RENDER_TARGET;
+	case FrameGraph::eDepthWrite:		return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+	case FrameGraph::eDepthRead:		return D3D12_RESOURCE_STATE_DEPTH_READ | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+	case FrameGraph::eShaderResource:	return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+	case FrameGraph::eCopySource:		return D3D12_RESOURCE_STATE_COPY_SOURCE;
+	case FrameGraph::eCopyDest:			return D3D12_RESOURCE_STATE_COPY_DEST;
+	case FrameGraph::ePresent:			return D3D12_RESOURCE_STATE_PRESENT;
+	default:							return D3D12_RESOURCE_STATE_COMMON;
+	}
+}
+
+void DX12FrameGraph::ImportResource(FrameGraph::ResourceId i_Resource, ID3D12Resource * i_D3DResource)
+{
+	ASSERT(i_Resource < m_MaxResourceCount);
+	m_Resources[i_Resource] = i_D3DResource;
+}
+
+HRESULT DX12FrameGraph::Prepare(const FrameGraph & i_Graph)
+{
+	UpdateReleaseQueue();
+
+	if (!i_Graph.IsCompiled() || i_Graph.GetResourceCount() > m_MaxResourceCount)
+	{
+		PRINT_DEBUG("[DX12FrameGraph] unable to prepare the graph (not compiled or too many resources)");
+		DEBUG_BREAK;
+		return E_FAIL;
+	}
+
+	// -- Heap -- //
+	// the heap only grow : placed resources are recreated in the new heap
+	if (i_Graph.GetHeapSize() > m_HeapSize)
+	{
+		for (size_t i = 0; i < m_PlacedResources.size(); ++i)
+		{
+			if (m_PlacedResources[i].Resource != nullptr)
+			{
+				ReleaseLater(m_PlacedResources[i].Resource);
+				m_PlacedResources[i].Resource = nullptr;
+			}
+		}
+
+		if (m_Heap != nullptr)
+			ReleaseLater(m_Heap);
+
+		D3D12_HEAP_DESC heapDesc = {};
+		heapDesc.SizeInBytes	= i_Graph.GetHeapSize();
+		heapDesc.Properties		= CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		heapDesc.Alignment		= D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags			= D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+		DX12_ASSERT(DX12RenderEngine::GetInstance().GetDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_Heap)));
+		m_Heap->SetName(L"Frame Graph Heap");
+		m_HeapSize = heapDesc.SizeInBytes;
+	}
+
+	// -- Placed resources -- //
+	// kept while the description, the offset and the initial state are the same
+	for (FrameGraph::ResourceId i = 0; i < i_Graph.GetResourceCount(); ++i)
+	{
+		if (!i_Graph.IsTransient(i))
+			continue;
+
+		m_Resources[i] = nullptr;
+
+		if (!i_Graph.IsAllocated(i))
+			continue;
+
+		const PlacedResource & placed = m_PlacedResources[i];
+		const FrameGraph::TextureDesc & desc = i_Graph.GetTextureDesc(i);
+
+		const bool isValid = placed.Resource != nullptr
+			&& placed.Desc.Width == desc.Width
+			&& placed.Desc.Height == desc.Height
+			&& placed.Desc.Format == desc.Format
+			&& placed.Desc.IsDepth == desc.IsDepth
+			&& memcmp(placed.Desc.ClearValue, desc.ClearValue, sizeof(desc.ClearValue)) == 0
+			&& placed.Offset == i_Graph.GetHeapOffset(i)
+			&& placed.InitialState == GetResourceState(i_Graph.GetInitialState(i));
+
+		if (!isValid)
+			CreatePlacedResource(i, i_Graph);
+
+		m_Resources[i] = m_PlacedResources[i].Resource;
+	}
+
+	return S_OK;
+}
+
+void DX12FrameGraph::PushBarriers(const FrameGraph & i_Graph, ID3D12GraphicsCommandList * i_CommandList, const std::vector<FrameGraph::Barrier> & i_Barriers) const
+{
+	D3D12_RESOURCE_BARRIER barriers[32];
+	UINT barrierCount = 0;
+
+	// one call for the batch
+	for (size_t i = 0; i < i_Barriers.size(); ++i)
+	{
+		const FrameGraph::Barrier & barrier = i_Barriers[i];
+		ID3D12Resource * resource = GetResource(barrier.Resource);
+
+		if (resource == nullptr)
+		{
+			PRINT_DEBUG("[DX12FrameGraph] no resource for %s", i_Graph.GetResourceName(barrier.Resource).c_str());
+			continue;
+		}
+
+		if (barrier.Type == FrameGraph::Barrier::eAliasing)
+		{
+			ID3D12Resource * before = (barrier.AliasedResource != FrameGraph::InvalidId) ? m_PlacedResources[barrier.AliasedResource].Resource : nullptr;
+			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Aliasing(before, resource);
+		}
+		else
+		{
+			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(resource, GetResourceState(barrier.Before), GetResourceState(barrier.After));
+		}
+
+		if (barrierCount == _countof(barriers))
+		{
+			i_CommandList->ResourceBarrier(barrierCount, barriers);
+			barrierCount = 0;
+		}
+	}
+
+	if (barrierCount > 0)
+		i_CommandList->ResourceBarrier(barrierCount, barriers);
+
+	// the content of aliased memory is undefined (also for the first resources of the range : the previous frame used it)
+	// discard the render targets before their first use : the pass clears or overwrites them
+	for (size_t i = 0; i < i_Barriers.size(); ++i)
+	{
+		const FrameGraph::Barrier & barrier = i_Barriers[i];
+		ID3D12Resource * resource = GetResource(barrier.Resource);
+
+		if (barrier.Type != FrameGraph::Barrier::eAliasing || resource == nullptr)
+			continue;
+
+		const FrameGraph::EResourceState state = i_Graph.GetInitialState(barrier.Resource);
+
+		if (state == FrameGraph::eRenderTarget || state == FrameGraph::eDepthWrite)
+			i_CommandList->DiscardResource(resource, nullptr);
+	}
+}
+
+ID3D12Resource * DX12FrameGraph::GetResource(FrameGraph::ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_MaxResourceCount);
+	return m_Resources[i_Resource];
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DX12FrameGraph::GetRenderTargetView(FrameGraph::ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_MaxResourceCount);
+	return m_PlacedResources[i_Resource].Desc.IsDepth ? m_DepthStencilHeap->GetCPUDescriptorHandle(i_Resource) : m_RenderTargetHeap->GetCPUDescriptorHandle(i_Resource);
+}
+
+UINT DX12FrameGraph::GetBindlessIndex(FrameGraph::ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_MaxResourceCount);
+	return m_PlacedResources[i_Resource].BindlessIndex;
+}
+
+UINT64 DX12FrameGraph::GetHeapSize() const
+{
+	return m_HeapSize;
+}
+
+void DX12FrameGraph::CreatePlacedResource(FrameGraph::ResourceId i_Resource, const FrameGraph & i_Graph)
+{
+	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
+	PlacedResource & placed = m_PlacedResources[i_Resource];
+
+	if (placed.Resource != nullptr)
+		ReleaseLater(placed.Resource);
+
+	placed.Resource		= nullptr;
+	placed.Desc			= i_Graph.GetTextureDesc(i_Resource);
+	placed.Offset		= i_Graph.GetHeapOffset(i_Resource);
+	placed.InitialState	= GetResourceState(i_Graph.GetInitialState(i_Resource));
+
+	const DXGI_FORMAT format = (DXGI_FORMAT)placed.Desc.Format;
+	DXGI_FORMAT resourceFormat, shaderResourceFormat;
+	GetFormats(format, placed.Desc.IsDepth, resourceFormat, shaderResourceFormat);
+
+	// optimized clear value
+	D3D12_CLEAR_VALUE clearValue = {};
+	clearValue.Format = format;
+
+	if (placed.Desc.IsDepth)
+	{
+		clearValue.DepthStencil.Depth = placed.Desc.ClearValue[0];
+	}
+	else
+	{
+		for (UINT i = 0; i < 4; ++i)
+		{
+			clearValue.Color[i] = placed.Desc.ClearValue[i];
+		}
+	}
+
+	const D3D12_RESOURCE_FLAGS flags = placed.Desc.IsDepth ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+	DX12_ASSERT(device->CreatePlacedResource(
+		m_Heap,
+		placed.Offset,
+		&CD3DX12_RESOURCE_DESC::Tex2D(resourceFormat, placed.Desc.Width, placed.Desc.Height, 1, 1, 1, 0, flags),
+		placed.InitialState,
+		&clearValue,
+		IID_PPV_ARGS(&placed.Resource)
+	));
+
+	const std::string & name = i_Graph.GetResourceName(i_Resource);
+	placed.Resource->SetName(std::wstring(name.begin(), name.end()).c_str());
+
+	// views
+	if (placed.Desc.IsDepth)
+	{
+		D3D12_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc = {};
+		depthStencilViewDesc.Format			= format;
+		depthStencilViewDesc.ViewDimension	= D3D12_DSV_DIMENSION_TEXTURE2D;
+		depthStencilViewDesc.Flags			= D3D12_DSV_FLAG_NONE;
+
+		device->CreateDepthStencilView(placed.Resource, &depthStencilViewDesc, m_DepthStencilHeap->GetCPUDescriptorHandle(i_Resource));
+	}
+	else
+	{
+		device->CreateRenderTargetView(placed.Resource, nullptr, m_RenderTargetHeap->GetCPUDescriptorHandle(i_Resource));
+	}
+
+	// a new index : the previous view can still be read by the frames in flight
+	DX12BindlessHeap * bindlessHeap = DX12RenderEngine::GetInstance().GetBindlessHeap();
+	bindlessHeap->Free(placed.BindlessIndex);
+	placed.BindlessIndex = DescriptorAllocator::InvalidIndex;
+
+	if (shaderResourceFormat != DXGI_FORMAT_UNKNOWN)
+	{
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Shader4ComponentMapping		= D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Format						= shaderResourceFormat;
+		srvDesc.ViewDimension				= D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels			= 1;
+
+		placed.BindlessIndex = bindlessHeap->Allocate();
+		bindlessHeap->CreateShaderResourceView(placed.BindlessIndex, placed.Resource, &srvDesc);
+	}
+}
+
+void DX12FrameGraph::ReleaseLater(ID3D12Pageable * i_Object)
+{
+	// released when the frames using it are done
+	m_ReleaseQueue.push_back({ i_Object, (UINT)DX12RenderEngine::GetInstance().GetFrameBufferCount() + 1 });
+}
+
+void DX12FrameGraph::UpdateReleaseQueue()
+{
+	for (size_t i = 0; i < m_ReleaseQueue.size();)
+	{
+		if (--m_ReleaseQueue[i].FrameCount == 0)
+		{
+			SAFE_RELEASE(m_ReleaseQueue[i].Object);
+			m_ReleaseQueue[i] = m_ReleaseQueue.back();
+			m_ReleaseQueue.pop_back();
+			continue;
+		}
+
+		++i;
+	}
+}
@@ -0,0 +1,77 @@
+// frame graph resources on the GPU
+// transient textures of a compiled FrameGraph are placed resources in one shared heap (aliased memory)
+// placed resources are kept between frames while the graph layout does not change
+// barriers of the graph are translated into DX12 resource barriers, aliased render targets are discarded before their first use
+// the shader resource views are in the bindless heap (see DX12BindlessHeap)
+
+#pragma once
+
+#include "dx12/d3dx12.h"
+#include "engine/FrameGraph.h"
+#include "engine/DescriptorAllocator.h"
+#include <vector>
+
+class DX12DescriptorHeap;
+
+class DX12FrameGraph
+{
+public:
+	DX12FrameGraph(UINT i_MaxResourceCount = 64);
+	~DX12FrameGraph();
+
+	// description of a transient texture (size and alignment retreived from the device, estimated when headless)
+	static FrameGraph::TextureDesc		GetTextureDesc(UINT i_Width, UINT i_Height, DXGI_FORMAT i_Format, bool i_IsDepth, const float * i_ClearValue = nullptr);
+	static D3D12_RESOURCE_STATES		GetResourceState(FrameGraph::EResourceState i_State);
+
+	// management
+	void		ImportResource(FrameGraph::ResourceId i_Resource, ID3D12Resource * i_D3DResource);	// resource used by the barriers of an imported resource
+	HRESULT		Prepare(const FrameGraph & i_Graph);	// create the heap and the placed resources of a compiled graph
+	void		PushBarriers(const FrameGraph & i_Graph, ID3D12GraphicsCommandList * i_CommandList, const std::vector<FrameGraph::Barrier> & i_Barriers) const;
+
+	// resources of the graph
+	ID3D12Resource *				GetResource(FrameGraph::ResourceId i_Resource) const;
+	D3D12_CPU_DESCRIPTOR_HANDLE		GetRenderTargetView(FrameGraph::ResourceId i_Resource) const;	// render target or depth stencil view
+	UINT							GetBindlessIndex(FrameGraph::ResourceId i_Resource) const;		// shader resource view in the bindless heap
+
+	// information
+	UINT64		GetHeapSize() const;
+
+private:
+	// placed resource of a transient texture
+	struct PlacedResource
+	{
+		ID3D12Resource *			Resource		= nullptr;
+		FrameGraph::TextureDesc		Desc;
+		UINT64						Offset			= 0;
+		D3D12_RESOURCE_STATES		InitialState	= D3D12_RESOURCE_STATE_COMMON;
+		UINT						BindlessIndex	= DescriptorAllocator::InvalidIndex;
+	};
+
+	// helpers
+	void		CreatePlacedResource(FrameGraph::ResourceId i_Resource, const FrameGraph & i_Graph);
+	void		ReleaseLater(ID3D12Pageable * i_Object);	// the GPU may still use the object
+	void		UpdateReleaseQueue();
+
+	const UINT						m_MaxResourceCount;
+
+	// heap
+	ID3D12Heap *					m_Heap;
+	UINT64							m_HeapSize;
+
+	// resources
+	std::vector<PlacedResource>		m_PlacedResources;		// transient resources (per resource id)
+	std::vector<ID3D12Resource *>	m_Resources;			// all resources of the graph (transient and imported)
+
+	// views (one slot per resource id)
+	DX12DescriptorHeap *			m_RenderTargetHeap;
+	DX12DescriptorHeap *			m_DepthStencilHeap;
+
+	// deferred release
+	struct PendingRelease
+	{
+		ID3D12Pageable *	Object;
+		UINT				FrameCount;		// frames to wait before the release
+	};
+
+	std::vector<PendingRelease>		m_ReleaseQueue;
+};
@@ -0,0 +1,350 @@
+#include "DX12GPUCulling.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12RootSignature.h"
+#include "dx12/DX12PipelineState.h"
+#include "dx12/DX12UploadBuffer.h"
+#include "dx12/DX12BindlessHeap.h"
+#include "dx12/DX12DepthBuffer.h"
+#include "dx12/DX12ShaderCache.h"
+#include "engine/Utils.h"
+
+// Hi-Z mip constants (same layout as the HiZMip buffer of BuildHiZCS.hlsl)
+struct HiZMipConstants
+{
+	UINT		SourceSize[2];
+	UINT		Size[2];
+	UINT		SourceIndex;
+	UINT		Copy;
+};
+
+DX12GPUCulling::DX12GPUCulling(const GPUCullingDesc & i_Desc)
+	:m_ArgumentBuffer(nullptr)
+	,m_VisibleBuffer(nullptr)
+	,m_HiZ(nullptr)
+	,m_HiZIndex(DescriptorAllocator::InvalidIndex)
+	,m_HiZMipIndex(DescriptorAllocator::InvalidIndex)
+	,m_HiZUAVIndex(DescriptorAllocator::InvalidIndex)
+	,m_HiZValid(false)
+	,m_MaxInstanceCount(i_Desc.MaxInstanceCount)
+	,m_MaxBatchCount(i_Desc.MaxBatchCount)
+	,m_Width(i_Desc.Width)
+	,m_Height(i_Desc.Height)
+	,m_OcclusionEnabled(true)
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	ID3D12Device * device = render.GetDevice();
+	DX12BindlessHeap * bindlessHeap = render.GetBindlessHeap();
+
+	// -- Buffers -- //
+	m_InstanceBuffer	= new DX12UploadBuffer(m_MaxInstanceCount * sizeof(GPUCulling::InstanceRecord), L"CullingInstances");
+	m_TemplateBuffer	= new DX12UploadBuffer(m_MaxBatchCount * sizeof(GPUCulling::DrawArguments), L"CullingArgumentTemplates");
+	m_ConstantBuffer	= new DX12UploadBuffer(Math::Max((UINT)sizeof(GPUCulling::CullConstants), 256u), L"CullingConstants");
+
+	// the arguments are written by the culling then read by the draws
+	DX12_ASSERT(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(m_MaxBatchCount * sizeof(GPUCulling::DrawArguments), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+		D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT,
+		nullptr,
+		IID_PPV_ARGS(&m_ArgumentBuffer)
+	));
+
+	m_ArgumentBuffer->SetName(L"CullingArguments");
+
+	DX12_ASSERT(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(m_MaxInstanceCount * sizeof(UINT), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+		D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+		nullptr,
+		IID_PPV_ARGS(&m_VisibleBuffer)
+	));
+
+	m_VisibleBuffer->SetName(L"CullingVisibleInstances");
+
+	// -- Hi-Z pyramid -- //
+	m_HiZMipCount = GPUCulling::GetMipCount(m_Width, m_Height);
+	XMStoreFloat4x4(&m_HiZViewProjection, XMMatrixIdentity());
+
+	DX12_ASSERT(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32_FLOAT, m_Width, m_Height, 1, (UINT16)m_HiZMipCount, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+		D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+		nullptr,
+		IID_PPV_ARGS(&m_HiZ)
+	));
+
+	m_HiZ->SetName(L"Hi-Z");
+
+	// views : the pyramid for the culling, one view of each mip for the reduction
+	m_HiZIndex		= bindlessHeap->Allocate();
+	m_HiZMipIndex	= bindlessHeap->Allocate(m_HiZMipCount);
+	m_HiZUAVIndex	= bindlessHeap->Allocate(m_HiZMipCount);
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping		= D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format						= DXGI_FORMAT_R32_FLOAT;
+	srvDesc.ViewDimension				= D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MipLevels			= m_HiZMipCount;
+
+	bindlessHeap->CreateShaderResourceView(m_HiZIndex, m_HiZ, &srvDesc);
+
+	for (UINT mip = 0; mip < m_HiZMipCount; ++mip)
+	{
+		srvDesc.Texture2D.MostDetailedMip	= mip;
+		srvDesc.Texture2D.MipLevels			= 1;
+
+		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+		uavDesc.Format					= DXGI_FORMAT_R32_FLOAT;
+		uavDesc.ViewDimension			= D3D12_UAV_DIMENSION_TEXTURE2D;
+		uavDesc.Texture2D.MipSlice		= mip;
+
+		if (m_HiZMipIndex != DescriptorAllocator::InvalidIndex)
+			bindlessHeap->CreateShaderResourceView(m_HiZMipIndex + mip, m_HiZ, &srvDesc);
+		if (m_HiZUAVIndex != DescriptorAllocator::InvalidIndex)
+			bindlessHeap->CreateUnorderedAccessView(m_HiZUAVIndex + mip, m_HiZ, &uavDesc);
+	}
+
+	// bindless textures (culling and Hi-Z sources)
+	D3D12_DESCRIPTOR_RANGE bindlessRange;
+	bindlessRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+	bindlessRange.NumDescriptors = (UINT)-1;	// unbounded
+	bindlessRange.BaseShaderRegister = 0;
+	bindlessRange.RegisterSpace = 1;
+	bindlessRange.OffsetInDescriptorsFromTableStart = 0;
+
+	// -- Culling pipeline -- //
+	m_CullRootSignature = new DX12RootSignature;
+
+	m_CullRootSignature->AddConstantBuffer(0);				// culling constants (b0)
+	m_CullRootSignature->AddShaderResourceView(0);			// instance records (t0)
+	m_CullRootSignature->AddUnorderedAccessView(0);			// draw arguments (u0)
+	m_CullRootSignature->AddUnorderedAccessView(1);			// visible instances (u1)
+	m_CullRootSignature->AddDescriptorRange(&bindlessRange, 1);	// Hi-Z pyramid (t0, space1)
+
+	m_CullRootSignature->Create(device, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+	DX12ShaderCache * shaderCache = render.GetShaderCache();
+	DX12PipelineState::ComputePipelineStateDesc cullDesc;
+
+	cullDesc.RootSignature = m_CullRootSignature;
+	cullDesc.ComputeShader = shaderCache->GetShader(DX12Shader::eCompute, L"src/shaders/compute/CullInstancesCS.hlsl", 0);
+
+	m_CullPipelineState = (cullDesc.ComputeShader != nullptr) ? new DX12PipelineState(cullDesc) : nullptr;
+
+	// -- Hi-Z pipeline -- //
+	m_HiZRootSignature = new DX12RootSignature;
+
+	D3D12_DESCRIPTOR_RANGE uavRange;
+	uavRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+	uavRange.NumDescriptors = 1;
+	uavRange.BaseShaderRegister = 0;
+	uavRange.RegisterSpace = 0;
+	uavRange.OffsetInDescriptorsFromTableStart = 0;
+
+	m_HiZRootSignature->AddConstants(sizeof(HiZMipConstants) / sizeof(UINT), 0);	// mip constants (b0)
+	m_HiZRootSignature->AddDescriptorRange(&bindlessRange, 1);	// sources (t0, space1)
+	m_HiZRootSignature->AddDescriptorRange(&uavRange, 1);		// mip output (u0)
+
+	m_HiZRootSignature->Create(device, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+	DX12PipelineState::ComputePipelineStateDesc hizDesc;
+
+	hizDesc.RootSignature = m_HiZRootSignature;
+	hizDesc.ComputeShader = shaderCache->GetShader(DX12Shader::eCompute, L"src/shaders/compute/BuildHiZCS.hlsl", 0);
+
+	m_HiZPipelineState = (hizDesc.ComputeShader != nullptr) ? new DX12PipelineState(hizDesc) : nullptr;
+
+	if (m_CullPipelineState == nullptr || m_HiZPipelineState == nullptr)
+	{
+		PRINT_DEBUG("Error unable to compile the GPU culling shaders");
+		DEBUG_BREAK;
+	}
+
+	// -- Command signatures -- //
+	// the draws only read the arguments : no root signature needed
+	D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+	D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+
+	signatureDesc.ByteStride		= sizeof(GPUCulling::DrawArguments);
+	signatureDesc.NumArgumentDescs	= 1;
+	signatureDesc.pArgumentDescs	= &argumentDesc;
+
+	argumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW;
+	DX12_ASSERT(device->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&m_DrawSignature)));
+
+	argumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+	DX12_ASSERT(device->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&m_DrawIndexedSignature)));
+}
+
+DX12GPUCulling::~DX12GPUCulling()
+{
+	DX12BindlessHeap * bindlessHeap = DX12RenderEngine::GetInstance().GetBindlessHeap();
+
+	bindlessHeap->Free(m_HiZIndex);
+	bindlessHeap->Free(m_HiZMipIndex, m_HiZMipCount);
+	bindlessHeap->Free(m_HiZUAVIndex, m_HiZMipCount);
+
+	delete m_InstanceBuffer;
+	delete m_TemplateBuffer;
+	delete m_ConstantBuffer;
+	SAFE_RELEASE(m_ArgumentBuffer);
+	SAFE_RELEASE(m_VisibleBuffer);
+	SAFE_RELEASE(m_HiZ);
+
+	delete m_CullPipelineState;
+	delete m_CullRootSignature;
+	delete m_HiZPipelineState;
+	delete m_HiZRootSignature;
+	SAFE_RELEASE(m_DrawSignature);
+	SAFE_RELEASE(m_DrawIndexedSignature);
+}
+
+GPUCulling::InstanceRecord * DX12GPUCulling::GetInstanceRecords() const
+{
+	return reinterpret_cast<GPUCulling::InstanceRecord*>(m_InstanceBuffer->GetCPUAddress());
+}
+
+GPUCulling::DrawArguments * DX12GPUCulling::GetArgumentTemplates() const
+{
+	return reinterpret_cast<GPUCulling::DrawArguments*>(m_TemplateBuffer->GetCPUAddress());
+}
+
+void DX12GPUCulling::Cull(ID3D12GraphicsCommandList * i_CommandList, const XMMATRIX & i_ViewProjection, UINT i_InstanceCount, UINT i_BatchCount)
+{
+	ASSERT(i_InstanceCount <= m_MaxInstanceCount && i_BatchCount <= m_MaxBatchCount);
+
+	if (m_CullPipelineState == nullptr || i_BatchCount == 0)
+		return;
+
+	// constants : the Hi-Z is the depth of the previous frame
+	GPUCulling::CullConstants constants = {};
+	GPUCulling::SetupFrustum(constants, i_ViewProjection);
+
+	constants.HiZViewProjection	= m_HiZViewProjection;
+	constants.HiZSize			= XMFLOAT2((float)m_Width, (float)m_Height);
+	constants.HiZMipCount		= m_HiZMipCount;
+	constants.HiZIndex			= m_HiZIndex;
+	constants.InstanceCount		= i_InstanceCount;
+	constants.OcclusionEnabled	= (m_OcclusionEnabled && m_HiZValid && m_HiZIndex != DescriptorAllocator::InvalidIndex) ? 1 : 0;
+
+	m_ConstantBuffer->Update(&constants, sizeof(GPUCulling::CullConstants));
+
+	// reset the instance counts
+	CD3DX12_RESOURCE_BARRIER barriers[2] =
+	{
+		CD3DX12_RESOURCE_BARRIER::Transition(m_ArgumentBuffer, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, D3D12_RESOURCE_STATE_COPY_DEST),
+		CD3DX12_RESOURCE_BARRIER::Transition(m_VisibleBuffer, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+	};
+
+	i_CommandList->ResourceBarrier(_countof(barriers), barriers);
+	i_CommandList->CopyBufferRegion(m_ArgumentBuffer, 0, m_TemplateBuffer->GetResource(), 0, i_BatchCount * sizeof(GPUCulling::DrawArguments));
+
+	barriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(m_ArgumentBuffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	i_CommandList->ResourceBarrier(1, barriers);
+
+	// cull and compact
+	DX12BindlessHeap * bindlessHeap = DX12RenderEngine::GetInstance().GetBindlessHeap();
+	bindlessHeap->SetOnCommandList(i_CommandList);
+
+	i_CommandList->SetComputeRootSignature(m_CullRootSignature->GetRootSignature());
+	i_CommandList->SetPipelineState(m_CullPipelineState->GetPipelineState());
+	i_CommandList->SetComputeRootConstantBufferView(0, m_ConstantBuffer->GetGPUVirtualAddress());
+	i_CommandList->SetComputeRootShaderResourceView(1, m_InstanceBuffer->GetGPUVirtualAddress());
+	i_CommandList->SetComputeRootUnorderedAccessView(2, m_ArgumentBuffer->GetGPUVirtualAddress());
+	i_CommandList->SetComputeRootUnorderedAccessView(3, m_VisibleBuffer->GetGPUVirtualAddress());
+	i_CommandList->SetComputeRootDescriptorTable(4, bindlessHeap->GetGPUDescriptorHandle());
+
+	if (i_InstanceCount > 0)
+		i_CommandList->Dispatch((i_InstanceCount + GPU_CULLING_GROUP_SIZE - 1) / GPU_CULLING_GROUP_SIZE, 1, 1);
+
+	// the draws read the arguments and the vertex shaders the visible instances
+	barriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(m_ArgumentBuffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+	barriers[1] = CD3DX12_RESOURCE_BARRIER::Transition(m_VisibleBuffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+	i_CommandList->ResourceBarrier(_countof(barriers), barriers);
+}
+
+void DX12GPUCulling::ExecuteBatch(ID3D12GraphicsCommandList * i_CommandList, UINT i_Batch, bool i_Indexed) const
+{
+	ASSERT(i_Batch < m_MaxBatchCount);
+
+	// one command : the instance count is the visible instance count of the batch
+	i_CommandList->ExecuteIndirect(i_Indexed ? m_DrawIndexedSignature : m_DrawSignature, 1, m_ArgumentBuffer, i_Batch * sizeof(GPUCulling::DrawArguments), nullptr, 0);
+}
+
+void DX12GPUCulling::BuildHiZ(ID3D12GraphicsCommandList * i_CommandList, const XMMATRIX & i_ViewProjection)
+{
+	if (m_HiZPipelineState == nullptr || m_HiZMipIndex == DescriptorAllocator::InvalidIndex || m_HiZUAVIndex == DescriptorAllocator::InvalidIndex)
+		return;
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	DX12DepthBuffer * depthBuffer = render.GetDepthBuffer();
+	DX12BindlessHeap * bindlessHeap = render.GetBindlessHeap();
+
+	// the depth is read by a compute shader
+	i_CommandList->ResourceBarrier(1, &depthBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+
+	bindlessHeap->SetOnCommandList(i_CommandList);
+	i_CommandList->SetComputeRootSignature(m_HiZRootSignature->GetRootSignature());
+	i_CommandList->SetPipelineState(m_HiZPipelineState->GetPipelineState());
+	i_CommandList->SetComputeRootDescriptorTable(1, bindlessHeap->GetGPUDescriptorHandle());
+
+	// one dispatch per mip : the mip is written then read by the next one
+	for (UINT mip = 0; mip < m_HiZMipCount; ++mip)
+	{
+		HiZMipConstants constants;
+		constants.Size[0]		= GPUCulling::GetMipSize(m_Width, mip);
+		constants.Size[1]		= GPUCulling::GetMipSize(m_Height, mip);
+		constants.SourceSize[0]	= GPUCulling::GetMipSize(m_Width, (mip > 0) ? mip - 1 : 0);
+		constants.SourceSize[1]	= GPUCulling::GetMipSize(m_Height, (mip > 0) ? mip - 1 : 0);
+		constants.SourceIndex	= (mip > 0) ? m_HiZMipIndex + mip - 1 : depthBuffer->GetBindlessIndex();
+		constants.Copy			= (mip == 0) ? 1 : 0;
+
+		i_CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_HiZ, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, mip));
+
+		i_CommandList->SetComputeRoot32BitConstants(0, sizeof(HiZMipConstants) / sizeof(UINT), &constants, 0);
+		i_CommandList->SetComputeRootDescriptorTable(2, bindlessHeap->GetGPUDescriptorHandle(m_HiZUAVIndex + mip));
+		i_CommandList->Dispatch((constants.Size[0] + GPU_CULLING_HIZ_GROUP_SIZE - 1) / GPU_CULLING_HIZ_GROUP_SIZE, (constants.Size[1] + GPU_CULLING_HIZ_GROUP_SIZE - 1) / GPU_CULLING_HIZ_GROUP_SIZE, 1);
+
+		i_CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_HiZ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, mip));
+	}
+
+	i_CommandList->ResourceBarrier(1, &depthBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+	// the next culling tests the instances against this depth
+	XMStoreFloat4x4(&m_HiZViewProjection, XMMatrixTranspose(i_ViewProjection));
+	m_HiZValid = true;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS DX12GPUCulling::GetInstanceBufferAddress() const
+{
+	return m_InstanceBuffer->GetGPUVirtualAddress();
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS DX12GPUCulling::GetVisibleBufferAddress() const
+{
+	return m_VisibleBuffer->GetGPUVirtualAddress();
+}
+
+UINT DX12GPUCulling::GetMaxInstanceCount() const
+{
+	return m_MaxInstanceCount;
+}
+
+UINT DX12GPUCulling::GetMaxBatchCount() const
+{
+	return m_MaxBatchCount;
+}
+
+void DX12GPUCulling::SetOcclusionEnabled(bool i_Enabled)
+{
+	m_OcclusionEnabled = i_Enabled;
+}
+
+bool DX12GPUCulling::OcclusionIsEnabled() const
+{
+	return m_OcclusionEnabled;
+}
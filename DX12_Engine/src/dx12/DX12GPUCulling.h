@@ -0,0 +1,82 @@
+// GPU driven culling and indirect draws
+// the render list writes the instance records of the frame and one draw arguments template per batch (see GPUCulling)
+// the culling is dispatched on the deferred context before the GBuffer : the templates are copied in the argument buffer,
+// the visible instances are compacted per batch and each batch is drawn with one ExecuteIndirect (one command per batch)
+// the Hi-Z pyramid is built from the depth buffer after the GBuffer and used by the culling of the next frame (no occlusion on the first frame)
+
+#pragma once
+
+#include "d3dx12.h"
+#include "engine/GPUCulling.h"
+
+class DX12RootSignature;
+class DX12PipelineState;
+class DX12UploadBuffer;
+
+class DX12GPUCulling
+{
+public:
+	struct GPUCullingDesc
+	{
+		UINT		MaxInstanceCount = 16384;
+		UINT		MaxBatchCount = 1024;
+		UINT		Width = 0;		// depth buffer size
+		UINT		Height = 0;
+	};
+
+	DX12GPUCulling(const GPUCullingDesc & i_Desc);
+	~DX12GPUCulling();
+
+	// frame data (written by the main thread before the culling)
+	GPUCulling::InstanceRecord *	GetInstanceRecords() const;		// records of the current frame
+	GPUCulling::DrawArguments *		GetArgumentTemplates() const;	// arguments of the batches (instance count is 0)
+
+	// culling : deferred context, before the draws of the batches
+	void		Cull(ID3D12GraphicsCommandList * i_CommandList, const XMMATRIX & i_ViewProjection, UINT i_InstanceCount, UINT i_BatchCount);
+	void		ExecuteBatch(ID3D12GraphicsCommandList * i_CommandList, UINT i_Batch, bool i_Indexed) const;
+
+	// Hi-Z : the depth buffer must be a pixel shader resource (after the GBuffer resolve)
+	void		BuildHiZ(ID3D12GraphicsCommandList * i_CommandList, const XMMATRIX & i_ViewProjection);
+
+	// dx12
+	D3D12_GPU_VIRTUAL_ADDRESS		GetInstanceBufferAddress() const;	// records of the current frame
+	D3D12_GPU_VIRTUAL_ADDRESS		GetVisibleBufferAddress() const;	// visible instance indices of the batches
+
+	// information
+	UINT		GetMaxInstanceCount() const;
+	UINT		GetMaxBatchCount() const;
+	void		SetOcclusionEnabled(bool i_Enabled);
+	bool		OcclusionIsEnabled() const;
+
+private:
+	// buffers
+	DX12UploadBuffer *			m_InstanceBuffer;		// instance records (t0)
+	DX12UploadBuffer *			m_TemplateBuffer;		// arguments copied before the culling
+	DX12UploadBuffer *			m_ConstantBuffer;		// culling constants (b0)
+	ID3D12Resource *			m_ArgumentBuffer;		// draw arguments of the batches (u0, then indirect arguments)
+	ID3D12Resource *			m_VisibleBuffer;		// visible instances (u1, then read by the vertex shader)
+
+	// Hi-Z pyramid
+	ID3D12Resource *			m_HiZ;
+	UINT						m_HiZIndex;				// bindless index of the pyramid (all mips)
+	UINT						m_HiZMipIndex;			// bindless indices of each mip (one mip views)
+	UINT						m_HiZUAVIndex;			// bindless indices of the mip outputs
+	UINT						m_HiZMipCount;
+	XMFLOAT4X4					m_HiZViewProjection;	// transposed view projection of the depth of the pyramid
+	bool						m_HiZValid;
+
+	// pipelines
+	DX12RootSignature *			m_CullRootSignature;
+	DX12PipelineState *			m_CullPipelineState;
+	DX12RootSignature *			m_HiZRootSignature;
+	DX12PipelineState *			m_HiZPipelineState;
+	ID3D12CommandSignature *	m_DrawSignature;
+	ID3D12CommandSignature *	m_DrawIndexedSignature;
+
+	// informations
+	const UINT					m_MaxInstanceCount;
+	const UINT					m_MaxBatchCount;
+	const UINT					m_Width;
+	const UINT					m_Height;
+	bool						m_OcclusionEnabled;
+};
@@ -0,0 +1,135 @@
+#include "DX12GPUProfiler.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12Utils.h"
+#include "engine/Debug.h"
+
+DX12GPUProfiler::Scope::Scope(ID3D12GraphicsCommandList * i_CommandList, const char * i_Name)
+	:m_Profiler(DX12RenderEngine::GetInstance().GetGPUProfiler())
+	,m_CommandList(i_CommandList)
+{
+	// headless : no profiler and no command list
+	if (m_Profiler != nullptr && m_CommandList != nullptr)
+		m_Profiler->BeginScope(m_CommandList, i_Name);
+}
+
+DX12GPUProfiler::Scope::~Scope()
+{
+	if (m_Profiler != nullptr && m_CommandList != nullptr)
+		m_Profiler->EndScope(m_CommandList);
+}
+
+DX12GPUProfiler::DX12GPUProfiler(UINT i_FrameCount, UINT i_MaxScope)
+	:m_Profiler(i_FrameCount, i_MaxScope)
+	,m_QueryHeap(nullptr)
+	,m_ReadbackBuffer(nullptr)
+	,m_Frequency(0)
+	,m_FrameSlot(0)
+	,m_IsRecording(false)
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	ID3D12Device * device = render.GetDevice();
+
+	D3D12_QUERY_HEAP_DESC heapDesc = {};
+	heapDesc.Type		= D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	heapDesc.Count		= m_Profiler.GetMaxQueryCount();
+	heapDesc.NodeMask	= 0;
+
+	DX12_ASSERT(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&m_QueryHeap)));
+	m_QueryHeap->SetName(L"GPU Profiler Queries");
+
+	// one timestamp per query
+	m_ReadbackBuffer = render.CreateComittedResource(DX12RenderEngine::HeapProperty::ReadBack, (UINT64)m_Profiler.GetMaxQueryCount() * sizeof(UINT64));
+	m_ReadbackBuffer->SetName(L"GPU Profiler Readback");
+
+	// all the scopes are on the direct queue
+	DX12_ASSERT(render.GetCommandQueue()->GetTimestampFrequency(&m_Frequency));
+}
+
+DX12GPUProfiler::~DX12GPUProfiler()
+{
+	SAFE_RELEASE(m_QueryHeap);
+	SAFE_RELEASE(m_ReadbackBuffer);
+}
+
+void DX12GPUProfiler::BeginFrame(UINT i_FrameIndex, ID3D12GraphicsCommandList * i_FirstCommandList)
+{
+	// the render engine waited for the previous frame of this index : its timestamps are available
+	if (m_Profiler.IsPending(i_FrameIndex))
+		ReadBack(i_FrameIndex);
+
+	m_Profiler.BeginFrame(i_FrameIndex);
+	m_FrameSlot		= i_FrameIndex;
+	m_IsRecording	= true;
+
+	BeginScope(i_FirstCommandList, "Frame");
+}
+
+void DX12GPUProfiler::EndFrame(ID3D12GraphicsCommandList * i_LastCommandList)
+{
+	if (!m_IsRecording)
+		return;
+
+	EndScope(i_LastCommandList);
+
+	const UINT firstQuery = m_Profiler.GetFirstQuery(m_FrameSlot);
+	const UINT queryCount = m_Profiler.GetQueryCount(m_FrameSlot);
+
+	m_Profiler.EndFrame();
+	m_IsRecording = false;
+
+	if (queryCount > 0)
+		i_LastCommandList->ResolveQueryData(m_QueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, firstQuery, queryCount, m_ReadbackBuffer, (UINT64)firstQuery * sizeof(UINT64));
+}
+
+void DX12GPUProfiler::BeginScope(ID3D12GraphicsCommandList * i_CommandList, const char * i_Name)
+{
+	if (!m_IsRecording)
+		return;
+
+	const UINT query = m_Profiler.BeginScope(i_Name);
+
+	if (query != GPUProfiler::InvalidQuery)
+		i_CommandList->EndQuery(m_QueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, query);
+}
+
+void DX12GPUProfiler::EndScope(ID3D12GraphicsCommandList * i_CommandList)
+{
+	if (!m_IsRecording)
+		return;
+
+	const UINT query = m_Profiler.EndScope();
+
+	if (query != GPUProfiler::InvalidQuery)
+		i_CommandList->EndQuery(m_QueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, query);
+}
+
+const GPUProfiler & DX12GPUProfiler::GetProfiler() const
+{
+	return m_Profiler;
+}
+
+UINT64 DX12GPUProfiler::GetFrequency() const
+{
+	return m_Frequency;
+}
+
+FORCEINLINE void DX12GPUProfiler::ReadBack(UINT i_Slot)
+{
+	const UINT firstQuery = m_Profiler.GetFirstQuery(i_Slot);
+	const UINT queryCount = m_Profiler.GetQueryCount(i_Slot);
+
+	// only the queries of the slot are read
+	D3D12_RANGE readRange = { (SIZE_T)firstQuery * sizeof(UINT64), (SIZE_T)(firstQuery + queryCount) * sizeof(UINT64) };
+	D3D12_RANGE writeRange = { 0, 0 };
+	UINT8 * data = nullptr;
+
+	if (FAILED(m_ReadbackBuffer->Map(0, &readRange, reinterpret_cast<void**>(&data))))
+	{
+		PRINT_DEBUG("[DX12GPUProfiler] unable to map the readback buffer");
+		return;
+	}
+
+	m_Profiler.Resolve(i_Slot, reinterpret_cast<const UINT64 *>(data + readRange.Begin), m_Frequency);
+	m_ReadbackBuffer->Unmap(0, &writeRange);
+}
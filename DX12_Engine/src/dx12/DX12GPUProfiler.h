@@ -0,0 +1,51 @@
+// GPU profiler on the GPU
+// one timestamp query heap for all the frames in flight (a slot per frame index, see GPUProfiler)
+// the queries of a frame are resolved in a readback buffer by the last command list of the frame
+// they are read when the frame index is reused : the render engine already waited for this frame
+
+#pragma once
+
+#include "dx12/d3dx12.h"
+#include "engine/GPUProfiler.h"
+
+class DX12GPUProfiler
+{
+public:
+	// timestamps of a scope on one command list
+	class Scope
+	{
+	public:
+		Scope(ID3D12GraphicsCommandList * i_CommandList, const char * i_Name);
+		~Scope();
+
+	private:
+		DX12GPUProfiler *				m_Profiler;
+		ID3D12GraphicsCommandList *		m_CommandList;
+	};
+
+	DX12GPUProfiler(UINT i_FrameCount, UINT i_MaxScope = MAX_PROFILER_SCOPE);
+	~DX12GPUProfiler();
+
+	// frame management : the root scope begins on the first command list of the frame and ends on the last one
+	void		BeginFrame(UINT i_FrameIndex, ID3D12GraphicsCommandList * i_FirstCommandList);
+	void		EndFrame(ID3D12GraphicsCommandList * i_LastCommandList);	// resolve the queries of the frame
+
+	// scopes : the end can be on another command list (submitted after the begin on the same queue)
+	void		BeginScope(ID3D12GraphicsCommandList * i_CommandList, const char * i_Name);
+	void		EndScope(ID3D12GraphicsCommandList * i_CommandList);
+
+	// information
+	const GPUProfiler &		GetProfiler() const;
+	UINT64					GetFrequency() const;	// ticks per second
+
+private:
+	// helpers
+	void		ReadBack(UINT i_Slot);
+
+	GPUProfiler				m_Profiler;
+	ID3D12QueryHeap *		m_QueryHeap;
+	ID3D12Resource *		m_ReadbackBuffer;
+	UINT64					m_Frequency;
+	UINT					m_FrameSlot;	// slot of the recorded frame
+	bool					m_IsRecording;
+};
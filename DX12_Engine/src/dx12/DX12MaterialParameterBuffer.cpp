@@ -0,0 +1,97 @@
+#include "dx12/DX12MaterialParameterBuffer.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12UploadBuffer.h"
+#include "engine/Debug.h"
+
+DX12MaterialParameterBuffer::DX12MaterialParameterBuffer(UINT i_Capacity)
+	:m_UsedBlockCount(0)
+	,m_BlockCount(0)
+	,m_Buffer(nullptr)
+	,m_Version(1)
+{
+	m_Blocks.resize(i_Capacity);
+	m_Buffer = new DX12UploadBuffer(i_Capacity * sizeof(ParameterBlock), L"MaterialParameters");
+
+	// nothing is uploaded yet
+	m_UploadedVersions.resize(DX12RenderEngine::GetInstance().GetFrameBufferCount(), 0);
+}
+
+DX12MaterialParameterBuffer::~DX12MaterialParameterBuffer()
+{
+	delete m_Buffer;
+}
+
+UINT DX12MaterialParameterBuffer::ReserveBlock()
+{
+	UINT block = InvalidBlock;
+
+	if (!m_FreeBlocks.empty())
+	{
+		block = m_FreeBlocks.back();
+		m_FreeBlocks.pop_back();
+	}
+	else if (m_UsedBlockCount < (UINT)m_Blocks.size())
+	{
+		block = m_UsedBlockCount++;
+	}
+	else
+	{
+		PRINT_DEBUG("Error, the material parameter buffer is full (%u blocks)", (UINT)m_Blocks.size());
+		return InvalidBlock;
+	}
+
+	++m_BlockCount;
+	return block;
+}
+
+void DX12MaterialParameterBuffer::ReleaseBlock(UINT i_Block)
+{
+	if (i_Block == InvalidBlock)
+		return;
+
+	ASSERT(i_Block < m_UsedBlockCount);
+
+	m_FreeBlocks.push_back(i_Block);
+	--m_BlockCount;
+}
+
+void DX12MaterialParameterBuffer::UpdateBlock(UINT i_Block, const ParameterBlock & i_Data)
+{
+	if (i_Block >= m_UsedBlockCount)
+		return;
+
+	m_Blocks[i_Block] = i_Data;
+	++m_Version;
+}
+
+void DX12MaterialParameterBuffer::Upload()
+{
+	UINT64 & uploadedVersion = m_UploadedVersions[DX12RenderEngine::GetInstance().GetFrameIndex()];
+
+	if (uploadedVersion == m_Version)
+		return;
+
+	m_Buffer->Update(m_Blocks.data(), GetUploadSize());
+	uploadedVersion = m_Version;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS DX12MaterialParameterBuffer::GetGPUVirtualAddress() const
+{
+	return m_Buffer->GetGPUVirtualAddress();
+}
+
+UINT DX12MaterialParameterBuffer::GetCapacity() const
+{
+	return (UINT)m_Blocks.size();
+}
+
+UINT DX12MaterialParameterBuffer::GetBlockCount() const
+{
+	return m_BlockCount;
+}
+
+UINT64 DX12MaterialParameterBuffer::GetUploadSize() const
+{
+	return (UINT64)m_UsedBlockCount * sizeof(ParameterBlock);
+}
@@ -0,0 +1,57 @@
+// material parameter buffer
+// the parameter blocks of all materials (colors and specular power) packed in one structured buffer (t3, see Material.hlsli)
+// each material or material instance reserves a block, the draws select their block with a root constant (b2)
+// blocks are written in system memory and uploaded once per frame when they changed (the upload buffer is duplicated for each frame in flight)
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+#include "dx12/DX12Utils.h"
+
+class DX12UploadBuffer;
+
+class DX12MaterialParameterBuffer
+{
+public:
+	static const UINT InvalidBlock = (UINT)-1;
+
+	// same layout as MaterialParameters in Material.hlsli
+	struct ParameterBlock
+	{
+		DirectX::XMFLOAT4		Ka, Kd, Ks, Ke;
+		float					Ns;
+		UINT					MapKa, MapKd, MapKs;	// bindless indices of the maps (see DX12BindlessHeap)
+	};
+
+	DX12MaterialParameterBuffer(UINT i_Capacity);
+	~DX12MaterialParameterBuffer();
+
+	// blocks
+	UINT						ReserveBlock();		// InvalidBlock when the buffer is full
+	void						ReleaseBlock(UINT i_Block);
+	void						UpdateBlock(UINT i_Block, const ParameterBlock & i_Data);
+
+	// copy the blocks to the buffer of the current frame (call it once per frame before the recording)
+	void						Upload();
+
+	// dx12 management
+	D3D12_GPU_VIRTUAL_ADDRESS	GetGPUVirtualAddress() const;
+
+	// information
+	UINT						GetCapacity() const;
+	UINT						GetBlockCount() const;	// reserved blocks
+	UINT64						GetUploadSize() const;	// bytes copied by an upload (blocks until the last reserved one)
+
+private:
+	std::vector<ParameterBlock>		m_Blocks;
+	std::vector<UINT>				m_FreeBlocks;		// released blocks, reused first
+	UINT							m_UsedBlockCount;	// blocks used at least once
+	UINT							m_BlockCount;
+
+	// upload management : a buffer is uploaded again when its version is older than the blocks version
+	DX12UploadBuffer *				m_Buffer;
+	UINT64							m_Version;
+	std::vector<UINT64>				m_UploadedVersions;	// for each frame in flight
+};
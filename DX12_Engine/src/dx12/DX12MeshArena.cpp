@@ -0,0 +1,443 @@
+#include "DX12MeshArena.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12Utils.h"
+#include "engine/RenderBackend.h"
+#include "engine/Debug.h"
+#include "engine/Utils.h"
+
+#include <algorithm>
+
+DX12MeshArena::DX12MeshArena(UINT64 i_PageSize)
+	:m_PageSize(i_PageSize)
+	,m_Frame(0)
+	,m_MovedSize(0)
+	,m_DefragmentPage(InvalidPage)
+{
+	m_Allocations.reserve(0x400);
+}
+
+DX12MeshArena::~DX12MeshArena()
+{
+	for (size_t i = 0; i < m_PendingUploads.size(); ++i)
+	{
+		SAFE_RELEASE(m_PendingUploads[i].Buffer);
+	}
+
+	for (size_t i = 0; i < m_Pages.size(); ++i)
+	{
+		if (m_Pages[i].Buffer == nullptr)
+			continue;
+
+		DX12RenderEngine::GetInstance().GetBackend()->ReleaseAllocation(m_Pages[i].TrackedAllocation);
+		SAFE_RELEASE(m_Pages[i].Buffer);
+		delete m_Pages[i].Allocator;
+	}
+}
+
+DX12MeshArena::Handle DX12MeshArena::Allocate(UINT64 i_Size, Listener * i_Owner)
+{
+	ASSERT(i_Size != 0);
+
+	UINT page;
+	UINT64 offset;
+
+	// a new page when the existing pages are full (the page emptied by the defragmentation is not used)
+	if (!AllocateInPages(i_Size, m_DefragmentPage, page, offset))
+	{
+		page = CreatePage(Math::Max(m_PageSize, (i_Size + MESH_ARENA_GRANULARITY - 1) & ~((UINT64)MESH_ARENA_GRANULARITY - 1)));
+
+		if (page == InvalidPage)
+			return InvalidHandle;
+
+		offset = m_Pages[page].Allocator->Allocate(i_Size);
+		ASSERT(offset != TLSFAllocator::InvalidOffset);
+	}
+
+	Handle handle;
+
+	if (!m_UnusedHandles.empty())
+	{
+		handle = m_UnusedHandles.back();
+		m_UnusedHandles.pop_back();
+	}
+	else
+	{
+		handle = (Handle)m_Allocations.size();
+		m_Allocations.push_back(Allocation());
+	}
+
+	m_Allocations[handle] = { page, offset, i_Size, i_Owner };
+	return handle;
+}
+
+void DX12MeshArena::Free(Handle i_Handle)
+{
+	if (i_Handle == InvalidHandle)
+		return;
+
+	Allocation & allocation = m_Allocations[i_Handle];
+	ASSERT(allocation.Page != InvalidPage);
+
+	// the range is reused after the frames in flight
+	m_PendingRanges.push_back({ allocation.Page, allocation.Offset, m_Frame });
+
+	allocation.Page = InvalidPage;
+	allocation.Owner = nullptr;
+	m_UnusedHandles.push_back(i_Handle);
+}
+
+HRESULT DX12MeshArena::Upload(ID3D12GraphicsCommandList * i_CommandList, Handle i_Handle, const void * i_Data, UINT64 i_Size)
+{
+	const Allocation & allocation = m_Allocations[i_Handle];
+	ASSERT(allocation.Page != InvalidPage && i_Size <= allocation.Size);
+
+	ID3D12Resource * uploadBuffer = nullptr;
+	HRESULT hr = DX12RenderEngine::GetInstance().GetDevice()->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(i_Size),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&uploadBuffer));
+
+	if (FAILED(hr))		return hr;
+
+	uploadBuffer->SetName(L"Mesh Arena Upload");
+
+	void * address = nullptr;
+	CD3DX12_RANGE readRange(0, 0);	// We do not intend to read from this resource on the CPU
+
+	hr = uploadBuffer->Map(0, &readRange, &address);
+	if (FAILED(hr))
+	{
+		uploadBuffer->Release();
+		return hr;
+	}
+
+	memcpy(address, i_Data, (size_t)i_Size);
+	uploadBuffer->Unmap(0, nullptr);
+
+	// the page is promoted to the copy destination state and decays to the common state after the command list
+	i_CommandList->CopyBufferRegion(m_Pages[allocation.Page].Buffer, allocation.Offset, uploadBuffer, 0, i_Size);
+	m_PendingUploads.push_back({ uploadBuffer, m_Frame });
+
+	return S_OK;
+}
+
+void DX12MeshArena::BeginFrame()
+{
+	++m_Frame;
+
+	// the frames recorded since the free are finished
+	const UINT64 frameCount = (UINT64)DX12RenderEngine::GetInstance().GetFrameBufferCount();
+	auto itr = m_PendingRanges.begin();
+
+	while (itr != m_PendingRanges.end())
+	{
+		if (m_Frame < (*itr).Frame + frameCount)
+		{
+			++itr;
+			continue;
+		}
+
+		m_Pages[(*itr).Page].Allocator->Free((*itr).Offset);
+		itr = m_PendingRanges.erase(itr);
+	}
+
+	auto upload = m_PendingUploads.begin();
+
+	while (upload != m_PendingUploads.end())
+	{
+		if (m_Frame < (*upload).Frame + frameCount)
+		{
+			++upload;
+			continue;
+		}
+
+		SAFE_RELEASE((*upload).Buffer);
+		upload = m_PendingUploads.erase(upload);
+	}
+
+	// empty pages are released (the first page is kept for the next loadings)
+	for (UINT i = 1; i < (UINT)m_Pages.size(); ++i)
+	{
+		Page & page = m_Pages[i];
+
+		if (page.Buffer == nullptr || page.Allocator->GetAllocationCount() != 0)
+			continue;
+
+		DX12RenderEngine::GetInstance().GetBackend()->ReleaseAllocation(page.TrackedAllocation);
+		SAFE_RELEASE(page.Buffer);
+		delete page.Allocator;
+		page.Allocator = nullptr;
+
+		if (m_DefragmentPage == i)
+			m_DefragmentPage = InvalidPage;
+	}
+}
+
+UINT64 DX12MeshArena::Defragment(ID3D12GraphicsCommandList * i_CommandList, UINT64 i_Budget)
+{
+	// the page emptied is kept until all its allocations are moved
+	if (m_DefragmentPage == InvalidPage)
+		m_DefragmentPage = FindDefragmentPage();
+
+	if (m_DefragmentPage == InvalidPage)
+		return 0;
+
+	// destination of the moved allocations
+	struct Move
+	{
+		Handle		Source;
+		UINT		Page;
+		UINT64		Offset;
+	};
+
+	std::vector<Move> moves;
+	UINT64 movedSize = 0;
+
+	for (Handle i = 0; i < (Handle)m_Allocations.size() && movedSize < i_Budget; ++i)
+	{
+		const Allocation & allocation = m_Allocations[i];
+
+		if (allocation.Page != m_DefragmentPage)
+			continue;
+
+		// the other pages are full : the defragmentation waits for free ranges
+		Move move;
+		move.Source = i;
+
+		if (!AllocateInPages(allocation.Size, m_DefragmentPage, move.Page, move.Offset))
+			break;
+
+		moves.push_back(move);
+		movedSize += allocation.Size;
+	}
+
+	if (moves.empty())
+		return 0;
+
+	// explicit transitions : the copies are followed by the draws of the frame
+	ID3D12Resource * source = m_Pages[m_DefragmentPage].Buffer;
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	std::vector<bool> destinations(m_Pages.size(), false);
+
+	barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(source, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_SOURCE));
+
+	for (size_t i = 0; i < moves.size(); ++i)
+	{
+		if (destinations[moves[i].Page])
+			continue;
+
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_Pages[moves[i].Page].Buffer, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+		destinations[moves[i].Page] = true;
+	}
+
+	i_CommandList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+
+	for (size_t i = 0; i < moves.size(); ++i)
+	{
+		Allocation & allocation = m_Allocations[moves[i].Source];
+
+		i_CommandList->CopyBufferRegion(m_Pages[moves[i].Page].Buffer, moves[i].Offset, source, allocation.Offset, allocation.Size);
+
+		// the old range can still be read by the frames in flight
+		m_PendingRanges.push_back({ allocation.Page, allocation.Offset, m_Frame });
+		allocation.Page		= moves[i].Page;
+		allocation.Offset	= moves[i].Offset;
+
+		if (allocation.Owner != nullptr)
+			allocation.Owner->OnAllocationMoved(moves[i].Source);
+	}
+
+	for (size_t i = 0; i < barriers.size(); ++i)
+	{
+		std::swap(barriers[i].Transition.StateBefore, barriers[i].Transition.StateAfter);
+	}
+
+	i_CommandList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+
+	m_MovedSize += movedSize;
+	return movedSize;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS DX12MeshArena::GetGPUVirtualAddress(Handle i_Handle) const
+{
+	const Allocation & allocation = m_Allocations[i_Handle];
+	return m_Pages[allocation.Page].Buffer->GetGPUVirtualAddress() + allocation.Offset;
+}
+
+UINT DX12MeshArena::GetPageCount() const
+{
+	UINT count = 0;
+
+	for (size_t i = 0; i < m_Pages.size(); ++i)
+	{
+		if (m_Pages[i].Buffer != nullptr)
+			++count;
+	}
+
+	return count;
+}
+
+UINT64 DX12MeshArena::GetPageMemory() const
+{
+	UINT64 size = 0;
+
+	for (size_t i = 0; i < m_Pages.size(); ++i)
+	{
+		if (m_Pages[i].Buffer != nullptr)
+			size += m_Pages[i].Allocator->GetSize();
+	}
+
+	return size;
+}
+
+UINT64 DX12MeshArena::GetAllocatedSize() const
+{
+	UINT64 size = 0;
+
+	for (size_t i = 0; i < m_Pages.size(); ++i)
+	{
+		if (m_Pages[i].Buffer != nullptr)
+			size += m_Pages[i].Allocator->GetAllocatedSize();
+	}
+
+	return size;
+}
+
+UINT DX12MeshArena::GetAllocationCount() const
+{
+	return (UINT)(m_Allocations.size() - m_UnusedHandles.size());
+}
+
+UINT64 DX12MeshArena::GetCommittedMemory() const
+{
+	UINT64 size = 0;
+
+	for (size_t i = 0; i < m_Allocations.size(); ++i)
+	{
+		if (m_Allocations[i].Page != InvalidPage)
+			size += (m_Allocations[i].Size + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) & ~((UINT64)D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+	}
+
+	return size;
+}
+
+UINT64 DX12MeshArena::GetMovedSize() const
+{
+	return m_MovedSize;
+}
+
+float DX12MeshArena::GetFragmentation() const
+{
+	UINT64 freeSize = 0, largestSize = 0;
+
+	for (size_t i = 0; i < m_Pages.size(); ++i)
+	{
+		if (m_Pages[i].Buffer == nullptr)
+			continue;
+
+		freeSize += m_Pages[i].Allocator->GetSize() - m_Pages[i].Allocator->GetAllocatedSize();
+		largestSize += m_Pages[i].Allocator->GetLargestFreeBlock();
+	}
+
+	if (freeSize == 0)
+		return 0.f;
+
+	return 1.f - (float)largestSize / (float)freeSize;
+}
+
+UINT DX12MeshArena::CreatePage(UINT64 i_Size)
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	ID3D12Resource * buffer = nullptr;
+
+	HRESULT hr = render.GetDevice()->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(i_Size),
+		D3D12_RESOURCE_STATE_COMMON,	// buffers are promoted to the copy and vertex states
+		nullptr,
+		IID_PPV_ARGS(&buffer));
+
+	if (FAILED(hr))
+	{
+		PRINT_DEBUG("Error, unable to create a mesh arena page (%llu bytes)", i_Size);
+		DEBUG_BREAK;
+		return InvalidPage;
+	}
+
+	buffer->SetName(L"Mesh Arena Page");
+
+	Page page;
+	page.Buffer				= buffer;
+	page.Allocator			= new TLSFAllocator(i_Size, MESH_ARENA_GRANULARITY);
+	page.TrackedAllocation	= render.GetBackend()->TrackAllocation(L"Mesh Arena Page", i_Size);
+
+	// reuse the slot of a released page
+	for (UINT i = 0; i < (UINT)m_Pages.size(); ++i)
+	{
+		if (m_Pages[i].Buffer == nullptr)
+		{
+			m_Pages[i] = page;
+			return i;
+		}
+	}
+
+	m_Pages.push_back(page);
+	return (UINT)m_Pages.size() - 1;
+}
+
+bool DX12MeshArena::AllocateInPages(UINT64 i_Size, UINT i_ExcludedPage, UINT & o_Page, UINT64 & o_Offset)
+{
+	for (UINT i = 0; i < (UINT)m_Pages.size(); ++i)
+	{
+		if (i == i_ExcludedPage || m_Pages[i].Buffer == nullptr)
+			continue;
+
+		o_Offset = m_Pages[i].Allocator->Allocate(i_Size);
+
+		if (o_Offset != TLSFAllocator::InvalidOffset)
+		{
+			o_Page = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+UINT DX12MeshArena::FindDefragmentPage() const
+{
+	// the least used page, when the other pages can contain its allocations
+	UINT page = InvalidPage;
+	UINT64 freeSize = 0;
+	float minUsage = MESH_ARENA_DEFRAGMENT_THRESHOLD;
+
+	for (UINT i = 0; i < (UINT)m_Pages.size(); ++i)
+	{
+		if (m_Pages[i].Buffer == nullptr)
+			continue;
+
+		const TLSFAllocator * allocator = m_Pages[i].Allocator;
+		const float usage = (float)allocator->GetAllocatedSize() / (float)allocator->GetSize();
+
+		freeSize += allocator->GetSize() - allocator->GetAllocatedSize();
+
+		if (allocator->GetAllocationCount() != 0 && usage < minUsage)
+		{
+			page = i;
+			minUsage = usage;
+		}
+	}
+
+	if (page == InvalidPage)
+		return InvalidPage;
+
+	const TLSFAllocator * allocator = m_Pages[page].Allocator;
+	const UINT64 otherFreeSize = freeSize - (allocator->GetSize() - allocator->GetAllocatedSize());
+
+	return (otherFreeSize >= allocator->GetAllocatedSize()) ? page : InvalidPage;
+}
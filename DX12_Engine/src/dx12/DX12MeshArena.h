@@ -0,0 +1,106 @@
+// mesh arena
+// the vertex and index buffers of the meshes are sub allocated in a few large default heap buffers (pages) instead of one committed resource each
+// each page has a TLSFAllocator : the views of the meshes point at the offset of their allocation in the page
+// pages are created when needed (a buffer larger than the page size has its own page) and released once empty
+// freed ranges are reused after the frames in flight (the GPU can still read them), like the bindless heap indices
+// defragmentation : each frame, the allocations of the emptiest page are moved to the other pages (budget of bytes per frame)
+// the owners of the moved allocations update their views, the page is released when its last ranges are retired
+// pages stay in the common state : uploads and draws promote them implicitly (buffers), the defragmentation copies transition them explicitly
+
+#pragma once
+
+#include "d3dx12.h"
+#include "engine/TLSFAllocator.h"
+#include <vector>
+
+// define
+#define			MESH_ARENA_PAGE_SIZE				(32 * 1024 * 1024)	// bytes of a page
+#define			MESH_ARENA_GRANULARITY				16					// alignment of the allocations (vertex and index buffers)
+#define			MESH_ARENA_DEFRAGMENT_BUDGET		(2 * 1024 * 1024)	// bytes moved per frame by the defragmentation
+#define			MESH_ARENA_DEFRAGMENT_THRESHOLD		0.5f				// pages used under this ratio are emptied in the other pages
+
+class DX12MeshArena
+{
+public:
+	typedef UINT Handle;
+	static const Handle InvalidHandle = (UINT)-1;
+
+	// owner of allocations : called when the defragmentation moves one of them (main thread, before the recording of the frame)
+	class Listener
+	{
+	public:
+		virtual void	OnAllocationMoved(Handle i_Handle) = 0;
+	};
+
+	DX12MeshArena(UINT64 i_PageSize = MESH_ARENA_PAGE_SIZE);
+	~DX12MeshArena();
+
+	// allocation management
+	Handle		Allocate(UINT64 i_Size, Listener * i_Owner);	// InvalidHandle when the page can't be created
+	void		Free(Handle i_Handle);
+	HRESULT		Upload(ID3D12GraphicsCommandList * i_CommandList, Handle i_Handle, const void * i_Data, UINT64 i_Size);	// copy from an upload buffer (released after the frames in flight)
+	void		BeginFrame();	// call it once per frame when the previous frame of the ranges is finished : reuse the retired ranges and release the empty pages
+
+	// defragmentation : deferred context, before the draws of the frame
+	UINT64		Defragment(ID3D12GraphicsCommandList * i_CommandList, UINT64 i_Budget = MESH_ARENA_DEFRAGMENT_BUDGET);	// return the bytes moved
+
+	// dx12
+	D3D12_GPU_VIRTUAL_ADDRESS		GetGPUVirtualAddress(Handle i_Handle) const;
+
+	// information
+	UINT		GetPageCount() const;
+	UINT64		GetPageMemory() const;			// bytes of the pages
+	UINT64		GetAllocatedSize() const;		// bytes of the allocations (and the ranges waiting for the frames in flight)
+	UINT		GetAllocationCount() const;
+	UINT64		GetCommittedMemory() const;		// bytes the allocations would use as committed resources (64KB alignment)
+	UINT64		GetMovedSize() const;			// bytes moved by the defragmentation since the creation
+	float		GetFragmentation() const;		// free bytes of the pages that are not in the largest free block of their page
+
+private:
+	static const UINT	InvalidPage = (UINT)-1;
+
+	struct Page
+	{
+		ID3D12Resource *	Buffer;		// null : released page
+		TLSFAllocator *		Allocator;
+		UINT				TrackedAllocation;	// see RenderBackend::TrackAllocation
+	};
+
+	struct Allocation
+	{
+		UINT				Page;		// InvalidPage : unused handle
+		UINT64				Offset;
+		UINT64				Size;
+		Listener *			Owner;
+	};
+
+	struct PendingRange
+	{
+		UINT				Page;
+		UINT64				Offset;
+		UINT64				Frame;		// frame of the free
+	};
+
+	struct PendingUpload
+	{
+		ID3D12Resource *	Buffer;
+		UINT64				Frame;
+	};
+
+	// pages
+	UINT		CreatePage(UINT64 i_Size);
+	bool		AllocateInPages(UINT64 i_Size, UINT i_ExcludedPage, UINT & o_Page, UINT64 & o_Offset);	// existing pages only
+	UINT		FindDefragmentPage() const;
+
+	std::vector<Page>				m_Pages;
+	std::vector<Allocation>			m_Allocations;
+	std::vector<Handle>				m_UnusedHandles;
+	std::vector<PendingRange>		m_PendingRanges;
+	std::vector<PendingUpload>		m_PendingUploads;
+
+	// desc
+	const UINT64		m_PageSize;
+	UINT64				m_Frame;
+	UINT64				m_MovedSize;
+	UINT				m_DefragmentPage;	// page emptied by the defragmentation (no allocation in it)
+};
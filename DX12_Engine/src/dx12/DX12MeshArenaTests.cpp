@@ -0,0 +1,154 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <algorithm>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/TLSFAllocator.h"
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12MeshArena.h"
+#include "engine/TestUtils.h"
+
+CFMeshArenaCheck::CFMeshArenaCheck()
+	:Console::Function("mesh_arena_check", "[operation count]", "check the TLSF allocator of the mesh arena (splits, merges and random workload) and print the arena memory")
+{
+}
+
+bool CFMeshArenaCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT operationCount = 100000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		operationCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	const UINT64 size = MESH_ARENA_PAGE_SIZE;
+	UINT errors = 0;
+	TestRandom random(1);
+
+	TLSFAllocator allocator(size, MESH_ARENA_GRANULARITY);
+
+	// the whole range, then nothing fits
+	const UINT64 full = allocator.Allocate(size);
+	if (full != 0 || allocator.Allocate(MESH_ARENA_GRANULARITY) != TLSFAllocator::InvalidOffset || allocator.GetFreeBlockCount() != 0)
+		++errors;
+
+	allocator.Free(full);
+	if (allocator.Allocate(size + 1) != TLSFAllocator::InvalidOffset || allocator.Allocate(0) != TLSFAllocator::InvalidOffset)
+		++errors;
+
+	// splits : contiguous blocks rounded to the granularity
+	UINT64 blocks[3];
+	for (UINT i = 0; i < 3; ++i)
+	{
+		blocks[i] = allocator.Allocate(100);
+		if (blocks[i] != i * 112 || allocator.GetAllocationSize(blocks[i]) != 112)
+			++errors;
+	}
+
+	// merges : the middle block stays alone, then the three blocks and the end are one free block
+	allocator.Free(blocks[1]);
+	if (allocator.GetFreeBlockCount() != 2)
+		++errors;
+
+	allocator.Free(blocks[0]);
+	allocator.Free(blocks[2]);
+	if (allocator.GetFreeBlockCount() != 1 || allocator.GetLargestFreeBlock() != size || allocator.GetAllocationCount() != 0 || !allocator.IsValid())
+		++errors;
+
+	// random workload : sizes of meshes (vertex and index buffers)
+	struct Range
+	{
+		UINT64		Offset;
+		UINT64		Size;
+	};
+
+	std::vector<Range> ranges;
+	UINT64 allocatedSize = 0;
+	UINT failedCount = 0;
+	float maxFragmentation = 0.f;
+	Clock clock;
+
+	for (UINT i = 0; i < operationCount; ++i)
+	{
+		if (ranges.empty() || random.Index(100) < 55)
+		{
+			const UINT64 rangeSize = (random.Index(4) == 0) ? 1 + random.Index(1024 * 1024) : 1 + random.Index(64 * 1024);
+			const UINT64 offset = allocator.Allocate(rangeSize);
+
+			if (offset == TLSFAllocator::InvalidOffset)
+			{
+				++failedCount;
+				continue;
+			}
+
+			ranges.push_back({ offset, allocator.GetAllocationSize(offset) });
+			allocatedSize += ranges.back().Size;
+
+			if (offset % MESH_ARENA_GRANULARITY != 0 || ranges.back().Size < rangeSize)
+				++errors;
+		}
+		else
+		{
+			const UINT index = random.Index((UINT)ranges.size());
+
+			allocator.Free(ranges[index].Offset);
+			allocatedSize -= ranges[index].Size;
+
+			ranges[index] = ranges.back();
+			ranges.pop_back();
+		}
+
+		maxFragmentation = Math::Max(maxFragmentation, allocator.GetFragmentation());
+	}
+
+	const UINT64 elapsed = clock.GetElaspedTime().ToMicroseconds();
+
+	// the allocations don't overlap and the counters follow the workload
+	std::vector<Range> sorted(ranges);
+	std::sort(sorted.begin(), sorted.end(), [](const Range & i_A, const Range & i_B) { return i_A.Offset < i_B.Offset; });
+
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		if (sorted[i].Offset + sorted[i].Size > ((i + 1 < sorted.size()) ? sorted[i + 1].Offset : size))
+			++errors;
+	}
+
+	if (allocator.GetAllocatedSize() != allocatedSize || allocator.GetAllocationCount() != (UINT)ranges.size() || !allocator.IsValid())
+		++errors;
+
+	const float fragmentation = allocator.GetFragmentation();
+
+	// everything freed : one free block again
+	for (size_t i = 0; i < ranges.size(); ++i)
+	{
+		allocator.Free(ranges[i].Offset);
+	}
+
+	if (allocator.GetFreeBlockCount() != 1 || allocator.GetAllocatedSize() != 0 || !allocator.IsValid())
+		++errors;
+
+	GetConsole()->Print("mesh arena check : %u operations, %u allocations left, %u failed, %u errors",
+		operationCount, (UINT)ranges.size(), failedCount, errors);
+	GetConsole()->Print("mesh arena check : %.1f ns per operation, fragmentation %.2f (max %.2f)",
+		(float)elapsed * 1000.f / (float)operationCount, fragmentation, maxFragmentation);
+
+	// arena of the renderer
+	const DX12MeshArena * arena = DX12RenderEngine::GetInstance().GetMeshArena();
+
+	if (arena != nullptr)
+	{
+		GetConsole()->Print("mesh arena : %u pages (%llu KB), %u allocations (%llu KB), %llu KB as committed resources, %llu KB moved, fragmentation %.2f",
+			arena->GetPageCount(), arena->GetPageMemory() / 1024, arena->GetAllocationCount(), arena->GetAllocatedSize() / 1024,
+			arena->GetCommittedMemory() / 1024, arena->GetMovedSize() / 1024, arena->GetFragmentation());
+	}
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -0,0 +1,236 @@
+#include "DX12Particles.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12RootSignature.h"
+#include "dx12/DX12PipelineState.h"
+#include "dx12/DX12RenderTarget.h"
+#include "dx12/DX12DepthBuffer.h"
+#include "dx12/DX12ShaderCache.h"
+#include "engine/Debug.h"
+
+DX12Particles::DX12Particles()
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	ID3D12Device * device = render.GetDevice();
+	DX12ShaderCache * shaderCache = render.GetShaderCache();
+
+	// -- Compute pipelines -- //
+	m_ComputeRootSignature = new DX12RootSignature;
+
+	m_ComputeRootSignature->AddConstants(sizeof(Particles::SimulateConstants) / sizeof(UINT), 0);	// simulate or sort constants (b0)
+	m_ComputeRootSignature->AddShaderResourceView(0);		// particles (t0)
+	m_ComputeRootSignature->AddUnorderedAccessView(0);		// particles (u0)
+	m_ComputeRootSignature->AddUnorderedAccessView(1);		// sort keys (u1)
+
+	m_ComputeRootSignature->Create(device, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+	DX12PipelineState::ComputePipelineStateDesc computeDesc;
+	computeDesc.RootSignature = m_ComputeRootSignature;
+
+	computeDesc.ComputeShader = shaderCache->GetShader(DX12Shader::eCompute, L"src/shaders/compute/SimulateParticlesCS.hlsl", 0);
+	m_SimulatePipelineState = (computeDesc.ComputeShader != nullptr) ? new DX12PipelineState(computeDesc) : nullptr;
+
+	computeDesc.ComputeShader = shaderCache->GetShader(DX12Shader::eCompute, L"src/shaders/compute/ParticleKeysCS.hlsl", 0);
+	m_KeysPipelineState = (computeDesc.ComputeShader != nullptr) ? new DX12PipelineState(computeDesc) : nullptr;
+
+	computeDesc.ComputeShader = shaderCache->GetShader(DX12Shader::eCompute, L"src/shaders/compute/SortParticlesCS.hlsl", 0);
+	m_SortPipelineState = (computeDesc.ComputeShader != nullptr) ? new DX12PipelineState(computeDesc) : nullptr;
+
+	// -- Draw pipelines -- //
+	m_DrawRootSignature = new DX12RootSignature;
+
+	m_DrawRootSignature->AddConstants(sizeof(Particles::DrawConstants) / sizeof(UINT), 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// draw constants (b0)
+	m_DrawRootSignature->AddShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// render streams (t0)
+	m_DrawRootSignature->AddShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// sorted keys (t1)
+
+	m_DrawRootSignature->Create(device);
+
+	DX12Shader * VShader = shaderCache->GetShader(DX12Shader::eVertex, L"src/shaders/rendering/ParticleVS.hlsl", 0);
+	DX12Shader * PShader = shaderCache->GetShader(DX12Shader::ePixel, L"src/shaders/rendering/ParticlePS.hlsl", 0);
+
+	for (UINT i = 0; i < Particles::eBlendModeCount; ++i)
+	{
+		m_DrawPipelineState[i] = nullptr;
+	}
+
+	if (m_SimulatePipelineState == nullptr || m_KeysPipelineState == nullptr || m_SortPipelineState == nullptr || VShader == nullptr || PShader == nullptr)
+	{
+		PRINT_DEBUG("Error unable to compile the particle shaders");
+		DEBUG_BREAK;
+		return;
+	}
+
+	// the depth is tested but not written, the quads are seen from both sides
+	CD3DX12_DEPTH_STENCIL_DESC depthDesc(D3D12_DEFAULT);
+	depthDesc.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+	depthDesc.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+
+	CD3DX12_RASTERIZER_DESC rasterizerDesc(D3D12_DEFAULT);
+	rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE;
+
+	for (UINT i = 0; i < Particles::eBlendModeCount; ++i)
+	{
+		CD3DX12_BLEND_DESC blendDesc(D3D12_DEFAULT);
+		blendDesc.RenderTarget[0].BlendEnable = true;
+		blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blendDesc.RenderTarget[0].DestBlend = (i == Particles::eAdditive) ? D3D12_BLEND_ONE : D3D12_BLEND_INV_SRC_ALPHA;
+		blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+
+		DX12PipelineState::PipelineStateDesc desc;
+
+		desc.InputLayout = {};	// no vertex buffer : the quads are generated from the vertex id
+		desc.RootSignature = m_DrawRootSignature;
+		desc.VertexShader = VShader;
+		desc.PixelShader = PShader;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		desc.RenderTargetCount = 1;
+		desc.RenderTargetFormat[0] = render.GetBackBuffer()->GetFormat();
+		desc.BlendState = blendDesc;
+		desc.RasterizerState = rasterizerDesc;
+		desc.DepthStencilDesc = depthDesc;
+		desc.DepthEnabled = true;
+		desc.DepthStencilFormat = render.GetDepthBuffer()->GetFormat();
+
+		m_DrawPipelineState[i] = new DX12PipelineState(desc);
+	}
+}
+
+DX12Particles::~DX12Particles()
+{
+	delete m_SimulatePipelineState;
+	delete m_KeysPipelineState;
+	delete m_SortPipelineState;
+	delete m_ComputeRootSignature;
+
+	for (UINT i = 0; i < Particles::eBlendModeCount; ++i)
+	{
+		delete m_DrawPipelineState[i];
+	}
+
+	delete m_DrawRootSignature;
+}
+
+DX12Particles::EmitterBuffers * DX12Particles::CreateEmitterBuffers(UINT i_Capacity)
+{
+	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
+	EmitterBuffers * buffers = new EmitterBuffers;
+
+	buffers->Capacity		= Particles::GetCapacity(i_Capacity);
+	buffers->SortCapacity	= Particles::GetSortCapacity(buffers->Capacity);
+	buffers->Particles		= nullptr;
+	buffers->Keys			= nullptr;
+
+	// committed resources are zeroed : age and lifetime are 0, all particles are dead
+	DX12_ASSERT(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(buffers->Capacity * Particles::eStreamCount * sizeof(float), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+		D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+		nullptr,
+		IID_PPV_ARGS(&buffers->Particles)
+	));
+
+	buffers->Particles->SetName(L"Particles");
+
+	DX12_ASSERT(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(buffers->SortCapacity * sizeof(UINT64), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+		D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+		nullptr,
+		IID_PPV_ARGS(&buffers->Keys)
+	));
+
+	buffers->Keys->SetName(L"ParticleKeys");
+
+	return buffers;
+}
+
+void DX12Particles::ReleaseEmitterBuffers(EmitterBuffers * i_Buffers)
+{
+	if (i_Buffers == nullptr)
+		return;
+
+	SAFE_RELEASE(i_Buffers->Particles);
+	SAFE_RELEASE(i_Buffers->Keys);
+	delete i_Buffers;
+}
+
+void DX12Particles::Simulate(ID3D12GraphicsCommandList * i_CommandList, const EmitterBuffers * i_Buffers, const Particles::SimulateConstants & i_Simulate, const Particles::SortConstants & i_Sort) const
+{
+	ASSERT(i_Simulate.Capacity == i_Buffers->Capacity && i_Sort.SortCapacity == i_Buffers->SortCapacity);
+
+	if (!IsValid())
+		return;
+
+	const UINT simulateGroups = (i_Buffers->Capacity + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE;
+	const UINT sortGroups = i_Buffers->SortCapacity / PARTICLE_GROUP_SIZE;
+
+	CD3DX12_RESOURCE_BARRIER barriers[2] =
+	{
+		CD3DX12_RESOURCE_BARRIER::Transition(i_Buffers->Particles, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+		CD3DX12_RESOURCE_BARRIER::Transition(i_Buffers->Keys, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+	};
+
+	i_CommandList->ResourceBarrier(_countof(barriers), barriers);
+
+	i_CommandList->SetComputeRootSignature(m_ComputeRootSignature->GetRootSignature());
+	i_CommandList->SetComputeRootShaderResourceView(1, i_Buffers->Particles->GetGPUVirtualAddress());
+	i_CommandList->SetComputeRootUnorderedAccessView(2, i_Buffers->Particles->GetGPUVirtualAddress());
+	i_CommandList->SetComputeRootUnorderedAccessView(3, i_Buffers->Keys->GetGPUVirtualAddress());
+
+	// simulate
+	i_CommandList->SetPipelineState(m_SimulatePipelineState->GetPipelineState());
+	i_CommandList->SetComputeRoot32BitConstants(0, sizeof(Particles::SimulateConstants) / sizeof(UINT), &i_Simulate, 0);
+	i_CommandList->Dispatch(simulateGroups, 1, 1);
+
+	// sort keys of the particles
+	barriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(i_Buffers->Particles, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+	i_CommandList->ResourceBarrier(1, barriers);
+
+	i_CommandList->SetPipelineState(m_KeysPipelineState->GetPipelineState());
+	i_CommandList->SetComputeRoot32BitConstants(0, sizeof(Particles::SortConstants) / sizeof(UINT), &i_Sort, 0);
+	i_CommandList->Dispatch(sortGroups, 1, 1);
+
+	// bitonic sort : one dispatch per step, each step reads the keys of the previous one
+	Particles::SortConstants sort = i_Sort;
+	i_CommandList->SetPipelineState(m_SortPipelineState->GetPipelineState());
+
+	for (sort.MergeSize = 2; sort.MergeSize <= i_Buffers->SortCapacity; sort.MergeSize <<= 1)
+	{
+		for (sort.CompareDistance = sort.MergeSize >> 1; sort.CompareDistance > 0; sort.CompareDistance >>= 1)
+		{
+			i_CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::UAV(i_Buffers->Keys));
+			i_CommandList->SetComputeRoot32BitConstants(0, sizeof(Particles::SortConstants) / sizeof(UINT), &sort, 0);
+			i_CommandList->Dispatch(sortGroups, 1, 1);
+		}
+	}
+
+	// the keys are read by the draws
+	barriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(i_Buffers->Keys, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+	i_CommandList->ResourceBarrier(1, barriers);
+}
+
+void DX12Particles::SetupDraws(ID3D12GraphicsCommandList * i_CommandList) const
+{
+	i_CommandList->SetGraphicsRootSignature(m_DrawRootSignature->GetRootSignature());
+	i_CommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+}
+
+void DX12Particles::Draw(ID3D12GraphicsCommandList * i_CommandList, Particles::EBlendMode i_BlendMode, const Particles::DrawConstants & i_Constants,
+	D3D12_GPU_VIRTUAL_ADDRESS i_Particles, D3D12_GPU_VIRTUAL_ADDRESS i_Keys, UINT i_InstanceCount) const
+{
+	if (!IsValid() || i_InstanceCount == 0)
+		return;
+
+	i_CommandList->SetPipelineState(m_DrawPipelineState[i_BlendMode]->GetPipelineState());
+	i_CommandList->SetGraphicsRoot32BitConstants(0, sizeof(Particles::DrawConstants) / sizeof(UINT), &i_Constants, 0);
+	i_CommandList->SetGraphicsRootShaderResourceView(1, i_Particles);
+	i_CommandList->SetGraphicsRootShaderResourceView(2, i_Keys);
+	i_CommandList->DrawInstanced(4, i_InstanceCount, 0, 0);
+}
+
+bool DX12Particles::IsValid() const
+{
+	return m_DrawPipelineState[0] != nullptr;
+}
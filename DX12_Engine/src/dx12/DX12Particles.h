@@ -0,0 +1,55 @@
+// particle rendering and GPU simulation
+// the CPU emitters upload their render streams and their sorted keys each frame (see ParticleSystem)
+// the GPU emitters keep their particles in a default buffer : the simulation, the sort keys and a bitonic sort are dispatched
+// on the immediate context before the draws of the transparent pass (see RenderList::RenderTransparent)
+// both paths are drawn with the same pipelines : one camera facing quad per sorted key, alpha blended or additive
+
+#pragma once
+
+#include "d3dx12.h"
+#include "engine/Particles.h"
+
+class DX12RootSignature;
+class DX12PipelineState;
+
+class DX12Particles
+{
+public:
+	// particles of a GPU emitter
+	struct EmitterBuffers
+	{
+		ID3D12Resource *	Particles;		// streams (u0 of the simulation, then read by the keys and the draws)
+		ID3D12Resource *	Keys;			// sort keys (u1 of the sort, then read by the draws)
+		UINT				Capacity;
+		UINT				SortCapacity;
+	};
+
+	DX12Particles();
+	~DX12Particles();
+
+	// GPU emitters
+	EmitterBuffers *	CreateEmitterBuffers(UINT i_Capacity);	// all particles are dead
+	void				ReleaseEmitterBuffers(EmitterBuffers * i_Buffers);
+
+	// GPU simulation : simulate and sort the particles of the frame (before the draws)
+	void				Simulate(ID3D12GraphicsCommandList * i_CommandList, const EmitterBuffers * i_Buffers, const Particles::SimulateConstants & i_Simulate, const Particles::SortConstants & i_Sort) const;
+
+	// draws : the back buffer and the depth buffer are bound by the render list
+	void				SetupDraws(ID3D12GraphicsCommandList * i_CommandList) const;
+	void				Draw(ID3D12GraphicsCommandList * i_CommandList, Particles::EBlendMode i_BlendMode, const Particles::DrawConstants & i_Constants,
+							D3D12_GPU_VIRTUAL_ADDRESS i_Particles, D3D12_GPU_VIRTUAL_ADDRESS i_Keys, UINT i_InstanceCount) const;
+
+	// information
+	bool				IsValid() const;	// false if the shaders are not compiled (the emitters are simulated on the CPU)
+
+private:
+	// compute
+	DX12RootSignature *			m_ComputeRootSignature;
+	DX12PipelineState *			m_SimulatePipelineState;
+	DX12PipelineState *			m_KeysPipelineState;
+	DX12PipelineState *			m_SortPipelineState;
+
+	// draws
+	DX12RootSignature *			m_DrawRootSignature;
+	DX12PipelineState *			m_DrawPipelineState[Particles::eBlendModeCount];
+};
@@ -7,8 +7,8 @@
 
 bool DX12PipelineState::IsValid(EElementFlags i_Flag)
 {
-	// if the flag have nothing more than position only (need normal to be rendered)
-	return (i_Flag != eNone);
+	// position only is valid : the shader permutation handle missing elements
+	return (i_Flag & ~(eHaveNormal | eHaveTexcoord | eHaveSkinning)) == 0;
 }
 
 UINT DX12PipelineState::GetElementSize(D3D12_INPUT_LAYOUT_DESC i_InputLayout)
@@ -43,6 +43,7 @@ UINT64 DX12PipelineState::CreateFlagsFromInputLayout(D3D12_INPUT_LAYOUT_DESC i_I
 
 		if (strcmp(element.SemanticName, "TEXCOORD") == 0)	flags |= EElementFlags::eHaveTexcoord;
 		else if (strcmp(element.SemanticName, "NORMAL") == 0)	flags |= EElementFlags::eHaveNormal;
+		else if (strcmp(element.SemanticName, "BLENDINDICES") == 0)	flags |= EElementFlags::eHaveSkinning;
 	}
 
 	return flags;
@@ -58,6 +59,7 @@ void DX12PipelineState::CreateInputLayoutFromFlags(D3D12_INPUT_LAYOUT_DESC & o_I
 
 	if (i_Flags & EElementFlags::eHaveTexcoord)			++size;
 	if (i_Flags & EElementFlags::eHaveNormal)			++size;
+	if (i_Flags & EElementFlags::eHaveSkinning)			size += 2;
 
 	elements = new D3D12_INPUT_ELEMENT_DESC[size];
 	o_InputLayout.NumElements = size;
@@ -67,7 +69,8 @@ void DX12PipelineState::CreateInputLayoutFromFlags(D3D12_INPUT_LAYOUT_DESC & o_I
 	// 1 - Position
 	// 2 - Normal
 	// 3 - Texcoord
-	// 4 - Color
+	// 4 - Bone indices and weights
+	// 5 - Color
 
 	// default position
 	elements[index++] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offset, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
@@ -83,12 +86,20 @@ void DX12PipelineState::CreateInputLayoutFromFlags(D3D12_INPUT_LAYOUT_DESC & o_I
 		elements[index++] = { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offset, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
 		offset += 2 * sizeof(float);
 	}
+	if (i_Flags & EElementFlags::eHaveSkinning)
+	{
+		elements[index++] = { "BLENDINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, offset, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+		offset += 4 * sizeof(BYTE);
+		elements[index++] = { "BLENDWEIGHT", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, offset, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+		offset += 4 * sizeof(BYTE);
+	}
 }
 
 DX12PipelineState::DX12PipelineState(const PipelineStateDesc & i_Desc)
 	:m_RootSignature(i_Desc.RootSignature)
 	,m_PixelShader(i_Desc.PixelShader)
 	,m_VertexShader(i_Desc.VertexShader)
+	,m_ComputeShader(nullptr)
 	,m_IsCreated(false)
 	,m_PipelineState(nullptr)
 	,m_RenderTargetCount(i_Desc.RenderTargetCount)
@@ -99,7 +110,7 @@ DX12PipelineState::DX12PipelineState(const PipelineStateDesc & i_Desc)
 	CopyInputLayout(m_InputLayout, i_Desc.InputLayout);
 
 	// assert error
-	ASSERT(m_PixelShader->GetType() == DX12Shader::ePixel);
+	ASSERT(m_PixelShader == nullptr || m_PixelShader->GetType() == DX12Shader::ePixel);
 	ASSERT(m_VertexShader->GetType() == DX12Shader::eVertex);
 	ASSERT(i_Desc.RenderTargetCount < 8);
 
@@ -113,11 +124,14 @@ DX12PipelineState::DX12PipelineState(const PipelineStateDesc & i_Desc)
 	pipelineDesc.InputLayout = m_InputLayout;
 	pipelineDesc.pRootSignature = m_RootSignature->GetRootSignature(); 
 	pipelineDesc.VS = m_VertexShader->GetByteCode(); // Special thanks to Zeldarck
-	pipelineDesc.PS = m_PixelShader->GetByteCode();
+	if (m_PixelShader != nullptr)
+	{
+		pipelineDesc.PS = m_PixelShader->GetByteCode();
+	}
 	pipelineDesc.PrimitiveTopologyType = i_Desc.PrimitiveTopologyType;
 	pipelineDesc.SampleDesc = sampleDesc;
 	pipelineDesc.SampleMask = 0xffffffff;
-	pipelineDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	pipelineDesc.RasterizerState = i_Desc.RasterizerState;
 	pipelineDesc.BlendState = i_Desc.BlendState;
 	pipelineDesc.NumRenderTargets = i_Desc.RenderTargetCount;
 
@@ -136,6 +150,31 @@ DX12PipelineState::DX12PipelineState(const PipelineStateDesc & i_Desc)
 	DX12_ASSERT(device->CreateGraphicsPipelineState(&pipelineDesc, IID_PPV_ARGS(&m_PipelineState)));
 }
 
+DX12PipelineState::DX12PipelineState(const ComputePipelineStateDesc & i_Desc)
+	:m_RootSignature(i_Desc.RootSignature)
+	,m_PixelShader(nullptr)
+	,m_VertexShader(nullptr)
+	,m_ComputeShader(i_Desc.ComputeShader)
+	,m_IsCreated(false)
+	,m_PipelineState(nullptr)
+	,m_RenderTargetCount(0)
+{
+	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
+
+	// no input layout for a compute pipeline
+	m_InputLayout.pInputElementDescs = nullptr;
+	m_InputLayout.NumElements = 0;
+
+	ASSERT(m_ComputeShader->GetType() == DX12Shader::eCompute);
+
+	D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineDesc = {};
+
+	pipelineDesc.pRootSignature = m_RootSignature->GetRootSignature();
+	pipelineDesc.CS = m_ComputeShader->GetByteCode();
+
+	DX12_ASSERT(device->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(&m_PipelineState)));
+}
+
 DX12PipelineState::~DX12PipelineState()
 {
 	// clean DX12 resources
@@ -14,10 +14,11 @@ public:
 	// input layout definition
 	enum EElementFlags
 	{
-		eNone			= 0,	// default : error if only that flag
+		eNone			= 0,	// default : position only (flat normals are computed in the GBuffer shader)
 		// start
-		eHaveNormal		= 1 << 0,	// required for rendering (if not present, crash)
+		eHaveNormal		= 1 << 0,	// vertex normals (if not present, face normals are used)
 		eHaveTexcoord	= 1 << 1,	// required for texture rendering or post process effects
+		eHaveSkinning	= 1 << 2,	// 4 bone indices and weights per vertex (skinned in the GBuffer shader with the palette of the animator)
 	};
 
 	// input element layout helper
@@ -33,7 +34,7 @@ public:
 	{
 		// engine
 		DX12RootSignature *		RootSignature;
-		const DX12Shader *		VertexShader, * PixelShader;	// to do : support other shader
+		const DX12Shader *		VertexShader, * PixelShader;	// to do : support other shader (pixel shader can be null for depth only passes)
 		// dx12
 		D3D12_PRIMITIVE_TOPOLOGY_TYPE	PrimitiveTopologyType;
 		D3D12_INPUT_LAYOUT_DESC			InputLayout;
@@ -44,10 +45,19 @@ public:
 		bool							DepthEnabled;
 		DXGI_FORMAT						DepthStencilFormat;
 		D3D12_BLEND_DESC				BlendState;
+		CD3DX12_RASTERIZER_DESC			RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);	// depth bias, culling...
+	};
+
+	// compute pipeline state descriptor
+	struct ComputePipelineStateDesc
+	{
+		DX12RootSignature *		RootSignature;
+		const DX12Shader *		ComputeShader;
 	};
 
 	// pipeline state object implementation
 	DX12PipelineState(const PipelineStateDesc & i_Desc);
+	DX12PipelineState(const ComputePipelineStateDesc & i_Desc);
 	~DX12PipelineState();
 
 	// information
@@ -71,6 +81,7 @@ private:
 	bool						m_IsCreated;
 	const DX12Shader *			m_PixelShader;
 	const DX12Shader *			m_VertexShader;
+	const DX12Shader *			m_ComputeShader;
 	const DX12RootSignature *	m_RootSignature;
 
 
@@ -0,0 +1,513 @@
+#include "DX12RenderBackend.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12RootSignature.h"
+#include "dx12/DX12PipelineState.h"
+#include "dx12/DX12ConstantBuffer.h"
+#include "dx12/DX12DepthBuffer.h"
+#include "dx12/DX12UploadBuffer.h"
+#include "dx12/DX12ShadowMap.h"
+#include "dx12/DX12BindlessHeap.h"
+#include "dx12/DX12DescriptorHeap.h"
+#include "dx12/DX12Context.h"
+#include "dx12/DX12GPUProfiler.h"
+#include "dx12/DX12GPUCulling.h"
+#include "dx12/DX12Particles.h"
+#include "dx12/DX12Transparency.h"
+#include "components/RenderComponent.h"
+#include "components/ParticleComponent.h"
+#include "resource/DX12Mesh.h"
+#include "resource/DX12Material.h"
+#include "engine/DebugDraw.h"
+#include "engine/TransparentSort.h"
+
+DX12RenderBackend::DX12RenderBackend()
+	:RenderBackend(eDX12Backend)
+{
+}
+
+DX12RenderBackend::~DX12RenderBackend()
+{
+}
+
+HRESULT DX12RenderBackend::BeginFrame()
+{
+	return DX12RenderEngine::GetInstance().PrepareForRender();
+}
+
+HRESULT DX12RenderBackend::EndFrame()
+{
+	const HRESULT hr = DX12RenderEngine::GetInstance().Render();
+	++m_FrameCount;
+
+	return hr;
+}
+
+HRESULT DX12RenderBackend::Close()
+{
+	return DX12RenderEngine::GetInstance().Close();
+}
+
+bool DX12RenderBackend::CreateUploadMemory(UINT64 i_Size, const wchar_t * i_Name, UploadMemory & o_Memory)
+{
+	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
+
+	DX12_ASSERT(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // this heap will be used to upload the data
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(i_Size),
+		D3D12_RESOURCE_STATE_GENERIC_READ, // will be data that is read from so we keep it in the generic read state
+		nullptr,
+		IID_PPV_ARGS(&o_Memory.Resource)));
+
+	if (o_Memory.Resource == nullptr)
+		return false;
+
+	o_Memory.Resource->SetName(i_Name);
+
+	CD3DX12_RANGE readRange(0, 0);    // We do not intend to read from this resource on the CPU
+	DX12_ASSERT(o_Memory.Resource->Map(0, &readRange, reinterpret_cast<void**>(&o_Memory.CPUAddress)));
+	o_Memory.GPUAddress = o_Memory.Resource->GetGPUVirtualAddress();
+
+	return true;
+}
+
+void DX12RenderBackend::ReleaseUploadMemory(UploadMemory & io_Memory)
+{
+	if (io_Memory.Resource == nullptr)
+		return;
+
+	io_Memory.Resource->Unmap(0, nullptr);
+	SAFE_RELEASE(io_Memory.Resource);
+	io_Memory.CPUAddress = nullptr;
+	io_Memory.GPUAddress = 0;
+}
+
+bool DX12RenderBackend::PreparePipelineState(const DX12Material * i_Material, UINT64 i_ElementFlags, bool i_IndirectDraw)
+{
+	return i_Material->PreparePipelineState(i_ElementFlags, i_IndirectDraw);
+}
+
+void DX12RenderBackend::RecordLightPass(ID3D12GraphicsCommandList * i_CommandList, const Lighting & i_Lighting, const DX12Mesh * i_RectMesh)
+{
+	ASSERT(i_CommandList != nullptr);
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	DX12GPUProfiler::Scope gpuScope(i_CommandList, "Lights");
+
+	// setup pipeline state objects
+	DX12RootSignature * rootSignature = render.GetLightRootSignature();
+	DX12PipelineState * pipelineState = render.GetLightPipelineState();
+
+	// setup rendering pipeline for lights
+	i_CommandList->SetGraphicsRootSignature(rootSignature->GetRootSignature());
+	i_CommandList->SetPipelineState(pipelineState->GetPipelineState());
+
+	// bind textures : one heap for the pass, the shader reads the textures by index (same order as the TextureIndices buffer of DeferredLightPS.hlsl)
+	// the GBuffer targets are transient textures of the frame graph
+	DX12BindlessHeap * bindlessHeap = render.GetBindlessHeap();
+	const UINT textureIndices[5] =
+	{
+		render.GetRenderTargetBindlessIndex(DX12RenderEngine::eNormal),
+		render.GetRenderTargetBindlessIndex(DX12RenderEngine::eDiffuse),
+		render.GetRenderTargetBindlessIndex(DX12RenderEngine::eSpecular),
+		render.GetDepthBuffer()->GetBindlessIndex(),
+		render.GetShadowMap()->GetBindlessIndex(),
+	};
+
+	bindlessHeap->SetOnCommandList(i_CommandList);
+	i_CommandList->SetGraphicsRootDescriptorTable(0, bindlessHeap->GetGPUDescriptorHandle());
+	i_CommandList->SetGraphicsRoot32BitConstants(1, _countof(textureIndices), textureIndices, 0);
+
+	// bind buffers
+	i_CommandList->SetGraphicsRootConstantBufferView(2, render.GetConstantBuffer(DX12RenderEngine::eGlobal)->GetUploadVirtualAddress(i_Lighting.SceneData));
+	i_CommandList->SetGraphicsRootShaderResourceView(3, i_Lighting.PointLights->GetGPUVirtualAddress());
+	i_CommandList->SetGraphicsRootShaderResourceView(4, i_Lighting.SpotLights->GetGPUVirtualAddress());
+	i_CommandList->SetGraphicsRootShaderResourceView(5, i_Lighting.DirectionalLights->GetGPUVirtualAddress());
+	i_CommandList->SetGraphicsRootShaderResourceView(6, i_Lighting.Clusters->GetGPUVirtualAddress());
+	i_CommandList->SetGraphicsRootShaderResourceView(7, i_Lighting.LightIndices->GetGPUVirtualAddress());
+
+	// bind shadows
+	i_CommandList->SetGraphicsRootShaderResourceView(8, i_Lighting.ShadowViews->GetGPUVirtualAddress());
+	i_CommandList->SetGraphicsRootShaderResourceView(9, i_Lighting.LightShadows->GetGPUVirtualAddress());
+
+	// draw rect mesh
+	i_RectMesh->PushOnCommandList(i_CommandList);
+}
+
+void DX12RenderBackend::RecordGBufferRange(UINT i_Worker, const MeshDraw * i_Draws, UINT i_Count, bool i_DepthPrePass)
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+
+	// -- Depth pre pass -- //
+	// depth only : the GBuffer pass only shades the visible pixels
+	if (i_DepthPrePass)
+	{
+		ID3D12GraphicsCommandList * commandList = render.GetRecordContext(DX12RenderEngine::eRecordDepth, i_Worker)->GetCommandList();
+
+		// command lists do not inherit states
+		render.SetGBufferTargets(commandList, true);
+		commandList->RSSetViewports(1, &render.GetViewport());
+		commandList->RSSetScissorRects(1, &render.GetScissor());
+		commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		commandList->SetGraphicsRootSignature(render.GetDepthRootSignature()->GetRootSignature());
+
+		const DX12PipelineState * currentPipelineState = nullptr;
+
+		for (UINT i = 0; i < i_Count; ++i)
+		{
+			const DX12PipelineState * pipelineState = render.GetDepthPipelineState(i_Draws[i].ElementFlags);
+
+			if (pipelineState == nullptr)
+				continue;
+
+			if (pipelineState != currentPipelineState)
+			{
+				commandList->SetPipelineState(pipelineState->GetPipelineState());
+				currentPipelineState = pipelineState;
+			}
+
+			commandList->SetGraphicsRootConstantBufferView(0, render.GetConstantBuffer(DX12RenderEngine::eTransform)->GetUploadVirtualAddress(i_Draws[i].Component->GetConstBufferAddress()));
+			i_Draws[i].Mesh->PushOnCommandList(commandList);
+		}
+	}
+
+	// -- GBuffer -- //
+	// constant buffers are already updated
+	ID3D12GraphicsCommandList * commandList = render.GetRecordContext(DX12RenderEngine::eRecordGBuffer, i_Worker)->GetCommandList();
+
+	render.SetGBufferTargets(commandList, false);
+	render.GetBindlessHeap()->SetOnCommandList(commandList);	// material maps are indexed in the bindless heap
+	commandList->RSSetViewports(1, &render.GetViewport());
+	commandList->RSSetScissorRects(1, &render.GetScissor());
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	// the pipeline state and the shared resources only change with the parent material
+	const DX12Material * currentParent = nullptr;
+	UINT64 currentFlags = 0;
+
+	for (UINT i = 0; i < i_Count; ++i)
+	{
+		const MeshDraw & draw = i_Draws[i];
+
+		if (draw.Parent != currentParent || draw.ElementFlags != currentFlags)
+		{
+			draw.Parent->PushPipelineState(commandList, draw.ElementFlags);
+			draw.Parent->PushSharedResources(commandList);
+
+			// push the global buffer (b1)
+			commandList->SetGraphicsRootConstantBufferView(1, render.GetConstantBuffer(DX12RenderEngine::eGlobal)->GetUploadVirtualAddress(0U));
+
+			currentParent = draw.Parent;
+			currentFlags = draw.ElementFlags;
+		}
+
+		commandList->SetGraphicsRootConstantBufferView(0, render.GetConstantBuffer(DX12RenderEngine::eTransform)->GetUploadVirtualAddress(draw.Component->GetConstBufferAddress()));
+		draw.Material->PushOnCommandList(commandList);
+
+		if (draw.ElementFlags & DX12PipelineState::eHaveSkinning)
+			draw.Parent->PushFirstBone(commandList, draw.FirstBone);
+
+		draw.Mesh->PushOnCommandList(commandList);
+	}
+}
+
+void DX12RenderBackend::RecordIndirectRange(UINT i_Worker, const IndirectBatch * i_Batches, UINT i_FirstBatch, UINT i_Count, ADDRESS_ID i_Transform)
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	const DX12GPUCulling * culling = render.GetGPUCulling();
+
+	// -- GBuffer -- //
+	ID3D12GraphicsCommandList * commandList = render.GetRecordContext(DX12RenderEngine::eRecordGBuffer, i_Worker)->GetCommandList();
+
+	render.SetGBufferTargets(commandList, false);
+	render.GetBindlessHeap()->SetOnCommandList(commandList);	// material maps are indexed in the bindless heap
+	commandList->RSSetViewports(1, &render.GetViewport());
+	commandList->RSSetScissorRects(1, &render.GetScissor());
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	const DX12Material * currentParent = nullptr;
+	UINT64 currentFlags = 0;
+
+	for (UINT i = 0; i < i_Count; ++i)
+	{
+		const IndirectBatch & batch = i_Batches[i];
+
+		if (batch.Parent != currentParent || batch.ElementFlags != currentFlags)
+		{
+			batch.Parent->PushPipelineState(commandList, batch.ElementFlags, true);
+			batch.Parent->PushSharedResources(commandList, true);
+
+			// push the global buffer (b1) and the view of the instances (b0)
+			commandList->SetGraphicsRootConstantBufferView(0, render.GetConstantBuffer(DX12RenderEngine::eTransform)->GetUploadVirtualAddress(i_Transform));
+			commandList->SetGraphicsRootConstantBufferView(1, render.GetConstantBuffer(DX12RenderEngine::eGlobal)->GetUploadVirtualAddress(0U));
+
+			currentParent = batch.Parent;
+			currentFlags = batch.ElementFlags;
+		}
+
+		batch.Parent->PushFirstInstance(commandList, batch.FirstInstance);
+
+		commandList->IASetVertexBuffers(0, 1, &batch.Mesh->GetVertexBufferView());
+		if (batch.Mesh->HaveIndexBuffer())
+			commandList->IASetIndexBuffer(&batch.Mesh->GetIndexBufferView());
+
+		culling->ExecuteBatch(commandList, i_FirstBatch + i, batch.Mesh->HaveIndexBuffer());
+	}
+}
+
+UINT DX12RenderBackend::RecordShadowPass(const ShadowPass & i_Pass)
+{
+	ASSERT(i_Pass.CommandList != nullptr);
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	DX12ShadowMap * shadowMap = render.GetShadowMap();
+	ID3D12GraphicsCommandList * commandList = i_Pass.CommandList;
+	DX12GPUProfiler::Scope gpuScope(commandList, "Shadows");
+
+	// the atlas is cleared even without caster (the light pass reads it)
+	commandList->ResourceBarrier(1, &shadowMap->GetResourceBarrier(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+
+	const D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = shadowMap->GetDepthStencilCPUDescriptorHandle();
+	commandList->OMSetRenderTargets(0, nullptr, FALSE, &dsvHandle);
+	commandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
+
+	commandList->SetGraphicsRootSignature(render.GetShadowRootSignature()->GetRootSignature());
+	commandList->SetGraphicsRootShaderResourceView(1, i_Pass.Instances->GetGPUVirtualAddress());
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	const DX12PipelineState * currentPipelineState = nullptr;
+	UINT drawCount = 0;
+
+	for (UINT view = 0; view < i_Pass.ViewCount; ++view)
+	{
+		// setup the view
+		const ShadowView & shadowView = i_Pass.Views[view];
+		const D3D12_VIEWPORT viewport = { (float)shadowView.X, (float)shadowView.Y, (float)shadowView.Size, (float)shadowView.Size, 0.f, 1.f };
+		const D3D12_RECT scissor = { (LONG)shadowView.X, (LONG)shadowView.Y, (LONG)(shadowView.X + shadowView.Size), (LONG)(shadowView.Y + shadowView.Size) };
+
+		commandList->RSSetViewports(1, &viewport);
+		commandList->RSSetScissorRects(1, &scissor);
+		commandList->SetGraphicsRoot32BitConstants(0, 16, &shadowView.ViewProjection, 0);
+
+		// push batches
+		const ShadowBatch * batches = i_Pass.Batches + shadowView.FirstBatch;
+
+		for (UINT i = 0; i < shadowView.BatchCount; ++i)
+		{
+			const DX12PipelineState * pipelineState = render.GetShadowPipelineState(batches[i].ElementFlags);
+
+			if (pipelineState == nullptr)
+				continue;
+
+			if (pipelineState != currentPipelineState)
+			{
+				commandList->SetPipelineState(pipelineState->GetPipelineState());
+				currentPipelineState = pipelineState;
+			}
+
+			commandList->SetGraphicsRoot32BitConstant(0, batches[i].FirstInstance, 16);
+			batches[i].Mesh->PushOnCommandList(commandList, batches[i].InstanceCount);
+			++drawCount;
+		}
+	}
+
+	commandList->ResourceBarrier(1, &shadowMap->GetResourceBarrier(D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+	return drawCount;
+}
+
+UINT DX12RenderBackend::RecordTransparentPass(const TransparentPass & i_Pass)
+{
+	ASSERT(i_Pass.CommandList != nullptr);
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	DX12Particles * particles = render.GetParticles();
+	DX12Transparency * transparency = render.GetTransparency();
+	DX12DepthBuffer * depthBuffer = render.GetDepthBuffer();
+	ID3D12GraphicsCommandList * commandList = i_Pass.CommandList;
+	DX12GPUProfiler::Scope gpuScope(commandList, "Transparent");
+
+	const UINT drawCount = i_Pass.MeshCount + i_Pass.EmitterCount;
+
+	// -- Setup -- //
+	// GPU emitters : simulated and sorted before the draws
+	for (UINT i = 0; i < i_Pass.EmitterCount; ++i)
+	{
+		const ParticleComponent * component = i_Pass.Emitters[i];
+
+		if (component->m_Buffers != nullptr)
+			particles->Simulate(commandList, component->m_Buffers, component->m_SimulateConstants, component->m_SortConstants);
+	}
+
+	// lights of the frame (see RenderList::RenderLight)
+	DX12Material::ForwardLighting lighting;
+	lighting.SceneData			= render.GetConstantBuffer(DX12RenderEngine::eGlobal)->GetUploadVirtualAddress(i_Pass.Lights.SceneData);
+	lighting.ShadowMap			= render.GetShadowMap()->GetBindlessIndex();
+	lighting.PointLights		= i_Pass.Lights.PointLights->GetGPUVirtualAddress();
+	lighting.SpotLights			= i_Pass.Lights.SpotLights->GetGPUVirtualAddress();
+	lighting.DirectionalLights	= i_Pass.Lights.DirectionalLights->GetGPUVirtualAddress();
+	lighting.Clusters			= i_Pass.Lights.Clusters->GetGPUVirtualAddress();
+	lighting.LightIndices		= i_Pass.Lights.LightIndices->GetGPUVirtualAddress();
+	lighting.ShadowViews		= i_Pass.Lights.ShadowViews->GetGPUVirtualAddress();
+	lighting.LightShadows		= i_Pass.Lights.LightShadows->GetGPUVirtualAddress();
+
+	// the depth buffer is bound without depth write
+	const D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = depthBuffer->GetDepthStencilDescriptorHeap()->GetCPUDescriptorHandleForHeapStart();
+	const D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = render.GetBackBufferDesc();
+
+	commandList->ResourceBarrier(1, &depthBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+
+	if (i_Pass.OrderIndependent)
+		transparency->BeginAccumulation(commandList, dsvHandle);
+	else
+		commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
+
+	// -- Draws -- //
+	// the pipeline state and the shared resources of the meshes only change with the parent material
+	const MeshDraw * currentMesh = nullptr;
+	bool particleSetup = false;
+	UINT recorded = 0;
+
+	for (UINT i = 0; i <= drawCount; ++i)
+	{
+		// order independent : the accumulated meshes are composited before the emitters
+		if (i_Pass.OrderIndependent && i == i_Pass.MeshCount)
+		{
+			transparency->Composite(commandList, rtvHandle);
+			commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
+			currentMesh = nullptr;
+		}
+
+		if (i == drawCount)
+			break;
+
+		const UINT index = TransparentSort::GetDrawIndex(i_Pass.Keys[i]);
+
+		// semi transparent mesh
+		if (index < i_Pass.MeshCount)
+		{
+			const MeshDraw & draw = i_Pass.Meshes[index];
+			++recorded;
+
+			if (currentMesh == nullptr || draw.Parent != currentMesh->Parent || draw.ElementFlags != currentMesh->ElementFlags)
+			{
+				// the forward permutation is created when needed (immediate context)
+				if (!draw.Parent->PrepareForwardPipelineState(draw.ElementFlags, i_Pass.OrderIndependent))
+					continue;
+
+				draw.Parent->PushForwardPipelineState(commandList, draw.ElementFlags, i_Pass.OrderIndependent);
+				draw.Parent->PushSharedResources(commandList);
+				draw.Parent->PushForwardLighting(commandList, lighting);
+
+				// push the global buffer (b1)
+				commandList->SetGraphicsRootConstantBufferView(1, render.GetConstantBuffer(DX12RenderEngine::eGlobal)->GetUploadVirtualAddress(0U));
+				commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+				currentMesh = &draw;
+				particleSetup = false;
+			}
+
+			commandList->SetGraphicsRootConstantBufferView(0, render.GetConstantBuffer(DX12RenderEngine::eTransform)->GetUploadVirtualAddress(draw.Component->GetConstBufferAddress()));
+			draw.Material->PushOnCommandList(commandList);
+
+			if (draw.ElementFlags & DX12PipelineState::eHaveSkinning)
+				draw.Parent->PushFirstBone(commandList, draw.FirstBone);
+
+			draw.Mesh->PushOnCommandList(commandList);
+			continue;
+		}
+
+		// particle emitter : one instanced draw
+		const ParticleComponent * component = i_Pass.Emitters[index - i_Pass.MeshCount];
+		const Particles::EmitterDesc & desc = component->GetEmitterDesc();
+		const UINT instanceCount = component->GetVisibleCount();
+
+		if (instanceCount == 0)
+			continue;
+
+		++recorded;
+
+		if (!particleSetup)
+		{
+			particles->SetupDraws(commandList);
+			particleSetup = true;
+			currentMesh = nullptr;
+		}
+
+		Particles::DrawConstants constants;
+		Particles::SetupDraw(desc, i_Pass.View, i_Pass.Projection, component->GetCapacity(), constants);
+
+		if (component->m_Buffers != nullptr)
+			particles->Draw(commandList, desc.BlendMode, constants, component->m_Buffers->Particles->GetGPUVirtualAddress(), component->m_Buffers->Keys->GetGPUVirtualAddress(), instanceCount);
+		else
+			particles->Draw(commandList, desc.BlendMode, constants, component->m_StreamBuffer->GetGPUVirtualAddress(), component->m_KeyBuffer->GetGPUVirtualAddress(), instanceCount);
+	}
+
+	// restore the targets of the immediate context
+	commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+	commandList->ResourceBarrier(1, &depthBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+	return recorded;
+}
+
+UINT DX12RenderBackend::RecordDebugPass(const DebugPass & i_Pass)
+{
+	ASSERT(i_Pass.CommandList != nullptr);
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	DX12DepthBuffer * depthBuffer = render.GetDepthBuffer();
+	ID3D12GraphicsCommandList * commandList = i_Pass.CommandList;
+	DX12GPUProfiler::Scope gpuScope(commandList, "Debug Draw");
+
+	// the depth buffer is bound without depth write for the depth tested primitives
+	const D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = depthBuffer->GetDepthStencilDescriptorHeap()->GetCPUDescriptorHandleForHeapStart();
+	const D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = render.GetBackBufferDesc();
+
+	commandList->ResourceBarrier(1, &depthBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+	commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
+
+	// root constants : view projection, primitive type and instance offset
+	DirectX::XMFLOAT4X4 viewProj;
+	DirectX::XMStoreFloat4x4(&viewProj, DirectX::XMMatrixTranspose(i_Pass.ViewProjection));
+
+	commandList->SetGraphicsRootSignature(render.GetDebugDrawRootSignature()->GetRootSignature());
+	commandList->SetGraphicsRoot32BitConstants(0, 16, &viewProj, 0);
+
+	for (UINT i = 0; i < DebugDraw::ePrimitiveCount; ++i)
+	{
+		commandList->SetGraphicsRootShaderResourceView(1 + i, i_Pass.Instances[i]->GetGPUVirtualAddress());
+	}
+
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+
+	// one instanced draw per primitive type and depth mode (depth tested instances first)
+	UINT drawCount = 0;
+
+	for (UINT pass = 0; pass < 2; ++pass)
+	{
+		const bool depthTest = (pass == 0);
+		commandList->SetPipelineState(render.GetDebugDrawPipelineState(depthTest)->GetPipelineState());
+
+		for (UINT i = 0; i < DebugDraw::ePrimitiveCount; ++i)
+		{
+			const DebugDraw::EPrimitive primitive = (DebugDraw::EPrimitive)i;
+			const UINT depthTestedCount = DebugDraw::GetDepthTestedCount(primitive);
+			const UINT first = depthTest ? 0 : depthTestedCount;
+			const UINT count = depthTest ? depthTestedCount : i_Pass.InstanceCount[i] - depthTestedCount;
+
+			if (count == 0)
+				continue;
+
+			commandList->SetGraphicsRoot32BitConstant(0, (UINT)primitive, 16);
+			commandList->SetGraphicsRoot32BitConstant(0, first, 17);
+			commandList->DrawInstanced(DebugDraw::GetVertexCount(primitive), count, 0, 0);
+			++drawCount;
+		}
+	}
+
+	// restore the targets of the immediate context
+	commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+	commandList->ResourceBarrier(1, &depthBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+	return drawCount;
+}
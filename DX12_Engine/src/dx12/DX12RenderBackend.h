@@ -0,0 +1,28 @@
+// DX12 render backend : frames are submitted by the render engine
+// the passes of the render list are pushed on the command lists of the contexts (nothing is recorded)
+// upload memory is a committed buffer in the upload heap, mapped for its lifetime
+
+#pragma once
+
+#include "engine/RenderBackend.h"
+
+class DX12RenderBackend : public RenderBackend
+{
+public:
+	DX12RenderBackend();
+	~DX12RenderBackend();
+
+	// RenderBackend
+	virtual HRESULT		BeginFrame() override;
+	virtual HRESULT		EndFrame() override;
+	virtual HRESULT		Close() override;
+	virtual bool		CreateUploadMemory(UINT64 i_Size, const wchar_t * i_Name, UploadMemory & o_Memory) override;
+	virtual void		ReleaseUploadMemory(UploadMemory & io_Memory) override;
+	virtual bool		PreparePipelineState(const DX12Material * i_Material, UINT64 i_ElementFlags, bool i_IndirectDraw) override;
+	virtual void		RecordLightPass(ID3D12GraphicsCommandList * i_CommandList, const Lighting & i_Lighting, const DX12Mesh * i_RectMesh) override;
+	virtual void		RecordGBufferRange(UINT i_Worker, const MeshDraw * i_Draws, UINT i_Count, bool i_DepthPrePass) override;
+	virtual void		RecordIndirectRange(UINT i_Worker, const IndirectBatch * i_Batches, UINT i_FirstBatch, UINT i_Count, ADDRESS_ID i_Transform) override;
+	virtual UINT		RecordShadowPass(const ShadowPass & i_Pass) override;
+	virtual UINT		RecordTransparentPass(const TransparentPass & i_Pass) override;
+	virtual UINT		RecordDebugPass(const DebugPass & i_Pass) override;
+};
@@ -8,11 +8,25 @@
 #include "dx12/DX12RenderTarget.h"
 #include "dx12/DX12DepthBuffer.h"
 #include "dx12/DX12ConstantBuffer.h"
+#include "dx12/DX12ShaderCache.h"
+#include "dx12/DX12MaterialParameterBuffer.h"
+#include "dx12/DX12BindlessHeap.h"
+#include "dx12/DX12MeshArena.h"
+#include "dx12/DX12UploadBuffer.h"
+#include "dx12/DX12ShadowMap.h"
+#include "dx12/DX12GPUProfiler.h"
+#include "dx12/DX12GPUCulling.h"
+#include "dx12/DX12Particles.h"
+#include "dx12/DX12Transparency.h"
+#include "dx12/DX12FrameGraph.h"
 #include "dx12/DX12Utils.h"
 #include "resource/DX12ResourceManager.h"
 #include "resource/DX12Mesh.h"
+#include "resource/DX12Material.h"
 #include "engine/Light.h"
 #include "engine/Engine.h"
+#include "engine/RenderBackend.h"
+#include "engine/Animation.h"
 
 #ifdef DX12_DEBUG
 #include "DX12Debug.h"
@@ -27,8 +41,24 @@ const DX12RenderEngine::ConstantBufferDef			DX12RenderEngine::s_ConstantBufferSi
 	// {ElementSize, ElementCount}
 	{256,				1024,	L"Transform",	true},		// transform
 	{256,				8,		L"Global",		true},			// global buffer (always pointing on the same)
-	{256,				1024,	L"Material",	true},		// materials
-	{MAX_LIGHT * 128,	1,		L"Lights",		true},			// lights
+};
+
+// GBuffer layouts are setupped here (the order follows ERenderTargetId)
+const DX12RenderEngine::RenderTargetDef			DX12RenderEngine::s_RenderTargetDef[][DX12RenderEngine::eRenderTargetCount] =
+{
+	// {Format, Name}
+	{
+		// default : 20 bytes per pixel
+		{DXGI_FORMAT_R16G16B16A16_FLOAT,	L"Normal"},		// normal
+		{DXGI_FORMAT_B8G8R8A8_UNORM,		L"Diffuse"},	// diffuse
+		{DXGI_FORMAT_R16G16B16A16_FLOAT,	L"Specular"},	// specular color and exponent
+	},
+	{
+		// packed : 10 bytes per pixel
+		{DXGI_FORMAT_R16G16_SNORM,			L"Normal"},		// octahedral normal
+		{DXGI_FORMAT_R8G8B8A8_UNORM,		L"Albedo"},		// albedo and specular intensity
+		{DXGI_FORMAT_R16_UNORM,				L"Material"},	// roughness and flags
+	},
 };
 
 const DX12RenderEngine::HeapProperty DX12RenderEngine::s_HeapProperties[] =
@@ -45,10 +75,10 @@ DX12RenderEngine & DX12RenderEngine::GetInstance()
 	return *s_Instance;
 }
 
-void DX12RenderEngine::Create(HINSTANCE & i_HInstance)
+void DX12RenderEngine::Create(HINSTANCE & i_HInstance, RenderBackend * i_Backend)
 {
 	assert(s_Instance == nullptr);
-	s_Instance = new DX12RenderEngine(i_HInstance);
+	s_Instance = new DX12RenderEngine(i_HInstance, i_Backend);
 }
 
 void DX12RenderEngine::Delete()
@@ -216,8 +246,14 @@ HRESULT DX12RenderEngine::InitializeDX12()
 	return S_OK;
 }
 
-HRESULT DX12RenderEngine::InitializeRender()
+HRESULT DX12RenderEngine::InitializeRender(EGBufferLayout i_GBufferLayout, UINT i_RecordWorkerCount)
 {
+	// GBuffer recording workers (contexts are created with the deferred context)
+	m_RecordWorkerCount = Math::Max(Math::Min(i_RecordWorkerCount, (UINT)MAX_RECORD_WORKER), 1u);
+
+	// -- Create shader cache -- //
+	m_ShaderCache = new DX12ShaderCache;
+
 	// -- Create constant buffer -- //
 	for (size_t i = 0; i < EConstantBufferId::eConstantBufferCount; ++i)
 	{
@@ -230,6 +266,15 @@ HRESULT DX12RenderEngine::InitializeRender()
 		);
 	}
 
+	m_MaterialParameterBuffer = new DX12MaterialParameterBuffer(MATERIAL_PARAMETER_BLOCK_COUNT);
+	m_SkinningBuffer = new DX12UploadBuffer(MAX_SKINNING_BONES * sizeof(Animation::SkinningMatrix), L"SkinningPalette");
+
+	// -- Create the bindless heap (before the render targets) -- //
+	m_BindlessHeap = new DX12BindlessHeap(BINDLESS_DESCRIPTOR_COUNT);
+
+	// -- Create the mesh arena (before the meshes) -- //
+	m_MeshArena = new DX12MeshArena(MESH_ARENA_PAGE_SIZE);
+
 	// -- Create depth/stencil buffer -- //
 	D3D12_CLEAR_VALUE depthOptimizedClearValue = {};
 	depthOptimizedClearValue.Format = DXGI_FORMAT_D32_FLOAT;
@@ -242,8 +287,10 @@ HRESULT DX12RenderEngine::InitializeRender()
 	depthBufferDesc.Format = DXGI_FORMAT_D32_FLOAT;
 	depthBufferDesc.Flags = D3D12_DSV_FLAG_NONE;
 	depthBufferDesc.DepthOptimizedClearValue = depthOptimizedClearValue;
+	depthBufferDesc.IsShaderResource = true;	// the light pass reconstruct positions from the depth
 
 	m_DepthBuffer = new DX12DepthBuffer(depthBufferDesc);
+	m_DepthPrePass = true;
 
 	// -- Generate GBuffer -- //
 	GenerateDeferredContext();
@@ -261,12 +308,40 @@ HRESULT DX12RenderEngine::InitializeRender()
 	// -- Generate primitive meshes for rendering -- //
 	GeneratePrimitiveShapes();
 
-	// -- Generate primitive meshes -- //
-	GenerateRenderTargets();
+	// -- GBuffer layout (the targets are transient textures of the frame graph) -- //
+	ASSERT(i_GBufferLayout < eGBufferLayoutCount);
+	m_GBufferLayout = i_GBufferLayout;
 
 	// -- Generate light pipeline -- //
 	GenerateLightPipeline();
 
+	// -- Generate shadow pipeline -- //
+	GenerateShadowPipeline();
+
+	// -- Generate depth pre pass pipeline -- //
+	GenerateDepthPipeline();
+
+	// -- Generate debug draw pipeline -- //
+	GenerateDebugDrawPipeline();
+
+	// -- GPU driven culling (Hi-Z of the depth buffer) -- //
+	DX12GPUCulling::GPUCullingDesc cullingDesc;
+	cullingDesc.Width = m_WindowSize.x;
+	cullingDesc.Height = m_WindowSize.y;
+
+	m_GPUCulling = new DX12GPUCulling(cullingDesc);
+	m_GPUCullingEnabled = true;
+
+	// -- Particles (GPU simulation and draws) -- //
+	m_Particles = new DX12Particles;
+
+	// -- Semi transparent meshes (order independent transparency targets) -- //
+	m_Transparency = new DX12Transparency(m_WindowSize);
+	m_OITEnabled = false;
+
+	// -- GPU profiler (one slot per frame in flight) -- //
+	m_GPUProfiler = new DX12GPUProfiler(FRAME_BUFFER_COUNT);
+
 	// -- Debug GBuffer management -- //
 #ifdef DX12_DEBUG
 	DX12Debug::DX12DebugDesc debugDesc;
@@ -275,11 +350,6 @@ HRESULT DX12RenderEngine::InitializeRender()
 	debugDesc.BackBuffer = m_BackBuffer;
 	debugDesc.DepthBuffer = m_DepthBuffer;
 
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
-	{
-		debugDesc.RenderTarget[i] = m_RenderTargets[i];
-	}
-
 	DX12Debug::Create(debugDesc);
 	m_Debug = &DX12Debug::GetInstance();
 #endif
@@ -304,6 +374,104 @@ HRESULT DX12RenderEngine::InitializeRender()
 	return E_NOTIMPL;
 }
 
+HRESULT DX12RenderEngine::InitializeHeadless(IntVec2 i_RenderSize, UINT i_RecordWorkerCount)
+{
+	if (!m_IsHeadless)
+	{
+		PRINT_DEBUG("[DX12RenderEngine] headless initialization with a GPU backend");
+		DEBUG_BREAK;
+		return E_FAIL;
+	}
+
+	m_WindowSize		= i_RenderSize;
+	m_FrameIndex		= 0;
+	m_RecordWorkerCount	= Math::Max(Math::Min(i_RecordWorkerCount, (UINT)MAX_RECORD_WORKER), 1u);
+	m_GBufferLayout		= eGBufferPacked;
+	m_DepthPrePass		= true;
+	m_GPUCullingEnabled	= false;
+
+	// no GPU objects
+	m_Device			= nullptr;
+	m_SwapChain			= nullptr;
+	m_CommandQueue		= nullptr;
+	m_DeferredQueue		= nullptr;
+	m_FenceEvent		= nullptr;
+	m_BackBuffer		= nullptr;
+	m_DepthBuffer		= nullptr;
+	m_RectMesh			= nullptr;
+	m_ShaderCache		= nullptr;
+	m_BindlessHeap		= nullptr;
+	m_MeshArena			= nullptr;
+	m_ShadowMap			= nullptr;
+	m_GPUProfiler		= nullptr;
+	m_GPUCulling		= nullptr;
+	m_Particles			= nullptr;
+	m_Transparency		= nullptr;
+	m_OITEnabled		= false;
+	m_LightRootSignature	= nullptr;
+	m_LightPipelineState	= nullptr;
+	m_ShadowRootSignature	= nullptr;
+	m_DepthRootSignature	= nullptr;
+	m_DebugDrawRootSignature	= nullptr;
+	m_DebugDrawPipelineState[0]	= m_DebugDrawPipelineState[1] = nullptr;
+
+	for (UINT i = 0; i < FRAME_BUFFER_COUNT; ++i)		m_BackBufferResource[i] = nullptr;
+	for (UINT i = 0; i < eContextCount; ++i)			m_Context[i] = nullptr;
+	for (UINT i = 0; i < INPUT_LAYOUT_COUNT; ++i)		m_ShadowPipelineState[i] = m_DepthPipelineState[i] = nullptr;
+
+	for (UINT pass = 0; pass < eRecordPassCount; ++pass)
+	{
+		for (UINT i = 0; i < MAX_RECORD_WORKER; ++i)
+		{
+			m_RecordContext[pass][i] = nullptr;
+		}
+	}
+
+#ifdef DX12_DEBUG
+	m_DebugController	= nullptr;
+	m_Debug				= nullptr;
+#endif
+
+	// constant buffers are in system memory
+	for (size_t i = 0; i < EConstantBufferId::eConstantBufferCount; ++i)
+	{
+		m_ConstantBuffer[i] = new DX12ConstantBuffer(
+			s_ConstantBufferSize[i].ElementCount,
+			s_ConstantBufferSize[i].ElementSize,
+			s_ConstantBufferSize[i].Name,
+			s_ConstantBufferSize[i].IsDuplicated
+		);
+	}
+
+	m_MaterialParameterBuffer = new DX12MaterialParameterBuffer(MATERIAL_PARAMETER_BLOCK_COUNT);
+	m_SkinningBuffer = new DX12UploadBuffer(MAX_SKINNING_BONES * sizeof(Animation::SkinningMatrix), L"SkinningPalette");
+
+	// viewport used by the view clusters
+	m_Viewport.TopLeftX = 0;
+	m_Viewport.TopLeftY = 0;
+	m_Viewport.Width = (FLOAT)m_WindowSize.x;
+	m_Viewport.Height = (FLOAT)m_WindowSize.y;
+	m_Viewport.MinDepth = 0.0f;
+	m_Viewport.MaxDepth = 1.0f;
+
+	m_ScissorRect.left = 0;
+	m_ScissorRect.top = 0;
+	m_ScissorRect.right = m_WindowSize.x;
+	m_ScissorRect.bottom = m_WindowSize.y;
+
+	return S_OK;
+}
+
+bool DX12RenderEngine::IsHeadless() const
+{
+	return m_IsHeadless;
+}
+
+RenderBackend * DX12RenderEngine::GetBackend() const
+{
+	return m_Backend;
+}
+
 FORCEINLINE HRESULT DX12RenderEngine::GenerateContexts()
 {
 	// generate default pipeline states objects
@@ -318,11 +486,18 @@ HRESULT DX12RenderEngine::PrepareForRender()
 {
 	// We have to wait for the gpu to finish with the command allocator before we reset it
 	WaitForPreviousFrame();
+
+	// descriptors freed before the frames in flight can be reused
+	m_BindlessHeap->BeginFrame();
+	m_MeshArena->BeginFrame();
 	
 	// initialize contexts
 	InitializeDeferredContext();
 	InitializeImmediateContext();
 
+	// move the allocations of the emptiest mesh page before the draws
+	m_MeshArena->Defragment(GetContext(eDeferred)->GetCommandList());
+
 	return S_OK;
 }
 
@@ -339,11 +514,24 @@ HRESULT DX12RenderEngine::Render()
 		UINT64 deferredFenceValue = deferred->GetFenceValue(m_FrameIndex);
 		ID3D12Fence * deferredFence = deferred->GetFence(m_FrameIndex);
 		
-		// create an array of command lists (only one command list here)
-		ID3D12CommandList* deferredCommandList[] = { deferred->GetCommandList() };
+		// deferred context (clear and shadows), GBuffer recorded by the workers then the resolve context
+		ID3D12CommandList* deferredCommandList[2 + eRecordPassCount * MAX_RECORD_WORKER];
+		UINT deferredCommandListCount = 0;
 
-		// execute the array of command lists
-		m_CommandQueue->ExecuteCommandLists(_countof(deferredCommandList), deferredCommandList);
+		deferredCommandList[deferredCommandListCount++] = deferred->GetCommandList();
+
+		for (UINT pass = 0; pass < eRecordPassCount; ++pass)
+		{
+			for (UINT i = 0; i < m_RecordWorkerCount; ++i)
+			{
+				deferredCommandList[deferredCommandListCount++] = m_RecordContext[pass][i]->GetCommandList();
+			}
+		}
+
+		deferredCommandList[deferredCommandListCount++] = GetContext(eResolve)->GetCommandList();
+
+		// execute the array of command lists (the order of the list is the order of the draws)
+		m_CommandQueue->ExecuteCommandLists(deferredCommandListCount, deferredCommandList);
 
 		// this command goes in at the end of our command queue. we will know when our command queue 
 		// has finished because the m_Fences value will be set to "m_FenceValue" from the GPU since the command
@@ -403,10 +591,72 @@ DX12ConstantBuffer * DX12RenderEngine::GetConstantBuffer(EConstantBufferId i_Id)
 	return m_ConstantBuffer[i_Id];
 }
 
-DX12RenderTarget * DX12RenderEngine::GetRenderTarget(ERenderTargetId i_Id) const
+DX12MaterialParameterBuffer * DX12RenderEngine::GetMaterialParameterBuffer() const
+{
+	return m_MaterialParameterBuffer;
+}
+
+DX12BindlessHeap * DX12RenderEngine::GetBindlessHeap() const
+{
+	return m_BindlessHeap;
+}
+
+DX12MeshArena * DX12RenderEngine::GetMeshArena() const
+{
+	return m_MeshArena;
+}
+
+DX12UploadBuffer * DX12RenderEngine::GetSkinningBuffer() const
+{
+	return m_SkinningBuffer;
+}
+
+DXGI_FORMAT DX12RenderEngine::GetRenderTargetFormat(ERenderTargetId i_Id) const
 {
 	ASSERT(i_Id < eRenderTargetCount);
-	return m_RenderTargets[i_Id];
+	return s_RenderTargetDef[m_GBufferLayout][i_Id].Format;
+}
+
+FrameGraph::TextureDesc DX12RenderEngine::GetRenderTargetDesc(ERenderTargetId i_Id) const
+{
+	return DX12FrameGraph::GetTextureDesc(m_WindowSize.x, m_WindowSize.y, GetRenderTargetFormat(i_Id), false);
+}
+
+void DX12RenderEngine::BindGBufferResources(const DX12FrameGraph * i_Resources, const FrameGraph::ResourceId * i_Targets)
+{
+	m_GBufferResources = i_Resources;
+
+	for (UINT i = 0; i < eRenderTargetCount; ++i)
+	{
+		m_GBufferTargets[i] = i_Targets[i];
+	}
+}
+
+UINT DX12RenderEngine::GetRenderTargetBindlessIndex(ERenderTargetId i_Id) const
+{
+	ASSERT(i_Id < eRenderTargetCount && m_GBufferResources != nullptr);
+	return m_GBufferResources->GetBindlessIndex(m_GBufferTargets[i_Id]);
+}
+
+void DX12RenderEngine::ClearGBufferTargets(ID3D12GraphicsCommandList * i_CommandList) const
+{
+	ASSERT(m_GBufferResources != nullptr);
+	static const float clearValue[4] = { 0.f, 0.f, 0.f, 0.f };	// same as the optimized clear value (see GetRenderTargetDesc)
+
+	for (UINT i = 0; i < eRenderTargetCount; ++i)
+	{
+		i_CommandList->ClearRenderTargetView(m_GBufferResources->GetRenderTargetView(m_GBufferTargets[i]), clearValue, 0, nullptr);
+	}
+}
+
+DX12RenderEngine::EGBufferLayout DX12RenderEngine::GetGBufferLayout() const
+{
+	return m_GBufferLayout;
+}
+
+UINT64 DX12RenderEngine::GetGBufferFeatureFlags() const
+{
+	return (m_GBufferLayout == eGBufferPacked) ? DX12Material::eGBufferPacked : DX12Material::eNoFeature;
 }
 
 DX12RenderTarget * DX12RenderEngine::GetBackBuffer() const
@@ -419,12 +669,45 @@ DX12DepthBuffer * DX12RenderEngine::GetDepthBuffer() const
 	return m_DepthBuffer;
 }
 
+void DX12RenderEngine::SetGBufferTargets(ID3D12GraphicsCommandList * i_CommandList, bool i_DepthOnly) const
+{
+	const D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = m_DepthBuffer->GetDepthStencilDescriptorHeap()->GetCPUDescriptorHandleForHeapStart();
+
+	if (i_DepthOnly)
+	{
+		i_CommandList->OMSetRenderTargets(0, nullptr, FALSE, &dsvHandle);
+		return;
+	}
+
+	ASSERT(m_GBufferResources != nullptr);
+	D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle[eRenderTargetCount];
+
+	for (UINT i = 0; i < eRenderTargetCount; ++i)
+	{
+		rtvHandle[i] = m_GBufferResources->GetRenderTargetView(m_GBufferTargets[i]);
+	}
+
+	// set the render target for the output merger stage (the output of the pipeline)
+	i_CommandList->OMSetRenderTargets(eRenderTargetCount, rtvHandle, FALSE, &dsvHandle);
+}
+
 DX12Context * DX12RenderEngine::GetContext(EContextId i_Id) const
 {
 	ASSERT(i_Id < eContextCount);
 	return m_Context[i_Id];
 }
 
+DX12Context * DX12RenderEngine::GetRecordContext(ERecordPass i_Pass, UINT i_Worker) const
+{
+	ASSERT(i_Pass < eRecordPassCount && i_Worker < m_RecordWorkerCount);
+	return m_RecordContext[i_Pass][i_Worker];
+}
+
+UINT DX12RenderEngine::GetRecordWorkerCount() const
+{
+	return m_RecordWorkerCount;
+}
+
 ID3D12Resource * DX12RenderEngine::CreateComittedResource(HeapProperty::Enum i_HeapProperty, uint64_t i_Size, D3D12_RESOURCE_FLAGS i_Flags) const
 {
 	if (i_HeapProperty >= HeapProperty::Enum::Count)	return nullptr;
@@ -478,8 +761,110 @@ DX12RootSignature * DX12RenderEngine::GetLightRootSignature() const
 	return m_LightRootSignature;
 }
 
+DX12RootSignature * DX12RenderEngine::GetShadowRootSignature() const
+{
+	return m_ShadowRootSignature;
+}
+
+DX12PipelineState * DX12RenderEngine::GetShadowPipelineState(UINT64 i_ElementFlags) const
+{
+	// skinned meshes have no depth only pipeline state (they are not in the depth passes)
+	if (i_ElementFlags >= INPUT_LAYOUT_COUNT)
+		return nullptr;
+
+	return m_ShadowPipelineState[i_ElementFlags];
+}
+
+DX12ShadowMap * DX12RenderEngine::GetShadowMap() const
+{
+	return m_ShadowMap;
+}
+
+DX12RootSignature * DX12RenderEngine::GetDepthRootSignature() const
+{
+	return m_DepthRootSignature;
+}
+
+DX12PipelineState * DX12RenderEngine::GetDepthPipelineState(UINT64 i_ElementFlags) const
+{
+	// skinned meshes have no depth only pipeline state (they are not in the depth passes)
+	if (i_ElementFlags >= INPUT_LAYOUT_COUNT)
+		return nullptr;
+
+	return m_DepthPipelineState[i_ElementFlags];
+}
+
+DX12RootSignature * DX12RenderEngine::GetDebugDrawRootSignature() const
+{
+	return m_DebugDrawRootSignature;
+}
+
+DX12PipelineState * DX12RenderEngine::GetDebugDrawPipelineState(bool i_DepthTest) const
+{
+	return m_DebugDrawPipelineState[i_DepthTest ? 0 : 1];
+}
+
+void DX12RenderEngine::SetDepthPrePassEnabled(bool i_Enabled)
+{
+	m_DepthPrePass = i_Enabled;
+}
+
+bool DX12RenderEngine::DepthPrePassIsEnabled() const
+{
+	return m_DepthPrePass;
+}
+
+DX12GPUCulling * DX12RenderEngine::GetGPUCulling() const
+{
+	return m_GPUCulling;
+}
+
+void DX12RenderEngine::SetGPUCullingEnabled(bool i_Enabled)
+{
+	m_GPUCullingEnabled = i_Enabled && (m_GPUCulling != nullptr);
+}
+
+bool DX12RenderEngine::GPUCullingIsEnabled() const
+{
+	return m_GPUCullingEnabled;
+}
+
+DX12Particles * DX12RenderEngine::GetParticles() const
+{
+	return m_Particles;
+}
+
+DX12Transparency * DX12RenderEngine::GetTransparency() const
+{
+	return m_Transparency;
+}
+
+void DX12RenderEngine::SetOITEnabled(bool i_Enabled)
+{
+	m_OITEnabled = i_Enabled && (m_Transparency != nullptr) && m_Transparency->IsValid();
+}
+
+bool DX12RenderEngine::OITIsEnabled() const
+{
+	return m_OITEnabled;
+}
+
+DX12ShaderCache * DX12RenderEngine::GetShaderCache() const
+{
+	return m_ShaderCache;
+}
+
+DX12GPUProfiler * DX12RenderEngine::GetGPUProfiler() const
+{
+	return m_GPUProfiler;
+}
+
 int DX12RenderEngine::GetFrameIndex() const
 {
+	// headless : the frame buffers are cycled by the ended frames
+	if (m_IsHeadless)
+		return (int)(m_Backend->GetFrameCount() % m_FrameBufferCount);
+
 	return m_FrameIndex;
 }
 
@@ -496,8 +881,16 @@ void DX12RenderEngine::EnableDebug(bool i_Enable) const
 
 bool DX12RenderEngine::DebugIsEnabled() const
 {
+	if (m_Debug == nullptr)
+		return false;
+
 	return m_Debug->IsEnabled();
 }
+
+void DX12RenderEngine::DrawDebugGBuffer(ID3D12GraphicsCommandList * i_CommandList) const
+{
+	m_Debug->DrawDebugGBuffer(i_CommandList);
+}
 #endif /* DX12_DEBUG */
 
 void DX12RenderEngine::PushRectPrimitive2D(ID3D12GraphicsCommandList * i_CommandList) const
@@ -579,8 +972,16 @@ IntVec2 DX12RenderEngine::GetRenderSize() const
 	return m_WindowSize;
 }
 
-DX12RenderEngine::DX12RenderEngine(HINSTANCE & i_HInstance)
+DX12RenderEngine::DX12RenderEngine(HINSTANCE & i_HInstance, RenderBackend * i_Backend)
+	:m_Backend(i_Backend)
+	,m_IsHeadless(i_Backend->IsHeadless())
+	,m_GPUProfiler(nullptr)
+	,m_GBufferResources(nullptr)
 {
+	for (UINT i = 0; i < eRenderTargetCount; ++i)
+	{
+		m_GBufferTargets[i] = FrameGraph::InvalidId;
+	}
 }
 
 DX12RenderEngine::~DX12RenderEngine()
@@ -589,6 +990,19 @@ DX12RenderEngine::~DX12RenderEngine()
 
 void DX12RenderEngine::CleanUp()
 {
+	// headless : only the constant buffers were created
+	if (m_IsHeadless)
+	{
+		for (int i = 0; i < EConstantBufferId::eConstantBufferCount; ++i)
+		{
+			delete (m_ConstantBuffer[i]);
+		}
+
+		delete m_MaterialParameterBuffer;
+		delete m_SkinningBuffer;
+		return;
+	}
+
 	// Cleanup resources
 	// wait for the gpu to finish all frames
 	for (int i = 0; i < m_FrameBufferCount; ++i)
@@ -602,14 +1016,9 @@ void DX12RenderEngine::CleanUp()
 	if (m_SwapChain->GetFullscreenState(&fs, NULL))
 		m_SwapChain->SetFullscreenState(false, NULL);
 
-	// delete render targets
+	// delete render targets (the GBuffer is owned by the frame graph)
 	delete m_BackBuffer;
 
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
-	{
-		delete m_RenderTargets[i];
-	}
-
 	// To do : release properly data : might have some random crash here
 
 
@@ -619,16 +1028,61 @@ void DX12RenderEngine::CleanUp()
 		delete m_Context[i];
 	}
 
+	for (UINT pass = 0; pass < eRecordPassCount; ++pass)
+	{
+		for (UINT i = 0; i < m_RecordWorkerCount; ++i)
+		{
+			delete m_RecordContext[pass][i];
+		}
+	}
+
 	for (int i = 0; i < m_FrameBufferCount; ++i)
 	{
 		SAFE_RELEASE(m_BackBufferResource[i]);
 	};
 
+	// the frames are finished : the queries can be released
+	delete m_GPUProfiler;
+
 	SAFE_RELEASE(m_SwapChain);
 	SAFE_RELEASE(m_CommandQueue);
 
 	delete m_DepthBuffer;
 
+	// delete shadow resources
+	for (UINT i = 0; i < INPUT_LAYOUT_COUNT; ++i)
+	{
+		delete m_ShadowPipelineState[i];
+	}
+
+	delete m_ShadowRootSignature;
+	delete m_ShadowMap;
+
+	// delete depth pre pass resources
+	for (UINT i = 0; i < INPUT_LAYOUT_COUNT; ++i)
+	{
+		delete m_DepthPipelineState[i];
+	}
+
+	delete m_DepthRootSignature;
+
+	// delete GPU culling resources (free its bindless indices)
+	delete m_GPUCulling;
+
+	// delete particle pipelines
+	delete m_Particles;
+
+	// delete transparency targets and composite pipeline (free their bindless indices)
+	delete m_Transparency;
+
+	// delete debug draw resources
+	delete m_DebugDrawPipelineState[0];
+	delete m_DebugDrawPipelineState[1];
+	delete m_DebugDrawRootSignature;
+
+	// delete compiled shaders
+	delete m_ShaderCache;
+
 	// delete resources
 	for (int i = 0; i < EConstantBufferId::eConstantBufferCount; ++i)
 	{
@@ -636,6 +1090,15 @@ void DX12RenderEngine::CleanUp()
 		delete (m_ConstantBuffer[i]);
 	}
 
+	delete m_MaterialParameterBuffer;
+	delete m_SkinningBuffer;
+
+	// the meshes are released before (render resource manager)
+	delete m_MeshArena;
+
+	// deleted after the render targets and the textures (they free their indices)
+	delete m_BindlessHeap;
+
 	// release debug resources
 #ifdef DX12_DEBUG
 	SAFE_RELEASE(m_DebugController);
@@ -677,14 +1140,25 @@ HRESULT DX12RenderEngine::UpdatePipeline()
 	GetContext(eImmediate)->GetCommandList()->ResourceBarrier(1, &m_BackBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
 	DX12_ASSERT(GetContext(eImmediate)->GetCommandList()->Close());
 
-	// setup the resource barriere for each render textures
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
+	// the resolve context is executed after the GBuffer recorded by the workers
+	// the GBuffer barriers are pushed by the frame graph (see Engine::BuildFrameGraph)
+	ID3D12GraphicsCommandList * resolveCommandList = GetContext(eResolve)->GetCommandList();
+
+	// the depth is read by the light pass
+	resolveCommandList->ResourceBarrier(1, &m_DepthBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+	// we close the command lists
+	DX12_ASSERT(GetContext(eDeferred)->GetCommandList()->Close());
+
+	for (UINT pass = 0; pass < eRecordPassCount; ++pass)
 	{
-		GetContext(eDeferred)->GetCommandList()->ResourceBarrier(1, &m_RenderTargets[i]->GetResourceBarrier(D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+		for (UINT i = 0; i < m_RecordWorkerCount; ++i)
+		{
+			DX12_ASSERT(m_RecordContext[pass][i]->GetCommandList()->Close());
+		}
 	}
 
-	// we close the command list
-	DX12_ASSERT(GetContext(eDeferred)->GetCommandList()->Close());
+	DX12_ASSERT(resolveCommandList->Close());
 
 	return S_OK;
 }
@@ -751,34 +1225,54 @@ FORCEINLINE HRESULT DX12RenderEngine::GenerateLightPipeline()
 
 	m_LightRootSignature->AddStaticSampler(sampler);	// add static sampler
 
-	// add textures
-	D3D12_DESCRIPTOR_RANGE descriptorTableRanges[eRenderTargetCount];
+	// comparison sampler for shadow maps (outside of the tile is lit)
+	D3D12_STATIC_SAMPLER_DESC shadowSampler = sampler;
 
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
-	{
-		descriptorTableRanges[i].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV; // this is a range of shader resource views (descriptors)
-		descriptorTableRanges[i].NumDescriptors = 1; // we only have one texture right now, so the range is only 1
-		descriptorTableRanges[i].BaseShaderRegister = i; // start index of the shader registers in the range
-		descriptorTableRanges[i].RegisterSpace = 0; // space 0. can usually be zero
-		descriptorTableRanges[i].OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND; // this appends the range to the end of the root signature descriptor tables
-	}
+	shadowSampler.Filter = D3D12_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+	shadowSampler.ComparisonFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+	shadowSampler.BorderColor = D3D12_STATIC_BORDER_COLOR_OPAQUE_WHITE;
+	shadowSampler.ShaderRegister = 1;
+
+	m_LightRootSignature->AddStaticSampler(shadowSampler);
 
-	// range descriptors (render targets from GBuffer)
-	m_LightRootSignature->AddDescriptorRange(&descriptorTableRanges[0], 1, D3D12_SHADER_VISIBILITY_PIXEL);	// normal texture
-	m_LightRootSignature->AddDescriptorRange(&descriptorTableRanges[1], 1, D3D12_SHADER_VISIBILITY_PIXEL);	// diffuse
-	m_LightRootSignature->AddDescriptorRange(&descriptorTableRanges[2], 1, D3D12_SHADER_VISIBILITY_PIXEL);	// specular
-	m_LightRootSignature->AddDescriptorRange(&descriptorTableRanges[3], 1, D3D12_SHADER_VISIBILITY_PIXEL);	// position
+	// textures : GBuffer, depth and shadow atlas are indexed in the bindless heap
+	D3D12_DESCRIPTOR_RANGE bindlessRange;
+	bindlessRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+	bindlessRange.NumDescriptors = (UINT)-1;	// unbounded
+	bindlessRange.BaseShaderRegister = 0;
+	bindlessRange.RegisterSpace = 1;
+	bindlessRange.OffsetInDescriptorsFromTableStart = 0;
+
+	m_LightRootSignature->AddDescriptorRange(&bindlessRange, 1, D3D12_SHADER_VISIBILITY_PIXEL);	// bindless textures (t0, space1)
+	m_LightRootSignature->AddConstants(5, 1, 0, D3D12_SHADER_VISIBILITY_PIXEL);					// texture indices (b1)
 
 	// constant buffer
 	m_LightRootSignature->AddConstantBuffer(0, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// transform buffer (b0)
-	m_LightRootSignature->AddConstantBuffer(1, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// light data (b1)
+
+	// structured buffers (clustered lighting)
+	m_LightRootSignature->AddShaderResourceView(5, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// point lights (t5)
+	m_LightRootSignature->AddShaderResourceView(6, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// spot lights (t6)
+	m_LightRootSignature->AddShaderResourceView(7, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// directional lights (t7)
+	m_LightRootSignature->AddShaderResourceView(8, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// light clusters (t8)
+	m_LightRootSignature->AddShaderResourceView(9, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// light index list (t9)
+
+	// shadows
+	m_LightRootSignature->AddShaderResourceView(11, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// shadow views (t11)
+	m_LightRootSignature->AddShaderResourceView(12, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// first shadow view of each lights (t12)
 
 	m_LightRootSignature->Create(m_Device);
 
 	DX12PipelineState::PipelineStateDesc desc;
 
-	DX12Shader * PShader = nullptr;
-	LOAD_SHADER(PShader, DX12Shader::ePixel, L"src/shaders/light/DeferredLightPS.hlsl", L"resources/build/shaders/DeferredLightPS.cso");
+	// the light shader decodes the GBuffer layout
+	const UINT64 key = DX12ShaderCache::MakePermutationKey(DX12PipelineState::eHaveTexcoord, GetGBufferFeatureFlags());
+	DX12Shader * PShader = m_ShaderCache->GetShader(DX12Shader::ePixel, L"src/shaders/light/DeferredLightPS.hlsl", key, DX12Material::s_FeatureDefines, DX12Material::s_FeatureDefineCount);
+
+	if (PShader == nullptr)
+	{
+		PRINT_DEBUG("Error unable to compile light permutation %llx", key);
+		return E_FAIL;
+	}
 
 	DX12Shader * VShader = nullptr;
 	LOAD_SHADER(VShader, DX12Shader::eVertex, L"src/shaders/light/DeferredLightVS.hlsl", L"resources/build/shaders/DeferredLightVS.cso");
@@ -812,6 +1306,176 @@ FORCEINLINE HRESULT DX12RenderEngine::GenerateLightPipeline()
 	return S_OK;
 }
 
+FORCEINLINE HRESULT DX12RenderEngine::GenerateShadowPipeline()
+{
+	// shadow atlas
+	DX12ShadowMap::ShadowMapDesc shadowMapDesc;
+	shadowMapDesc.Size = 4096;
+	shadowMapDesc.Name = L"Shadow Atlas";
+
+	m_ShadowMap = new DX12ShadowMap(shadowMapDesc);
+
+	// root signature : view projection and instance offset are root constants
+	m_ShadowRootSignature = new DX12RootSignature;
+
+	m_ShadowRootSignature->AddConstants(17, 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);		// view projection + instance offset (b0)
+	m_ShadowRootSignature->AddShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// instance transforms (t0)
+
+	m_ShadowRootSignature->Create(m_Device);
+
+	// depth only pipeline states, one for each mesh layout
+	for (UINT64 flags = 0; flags < INPUT_LAYOUT_COUNT; ++flags)
+	{
+		const UINT64 key = DX12ShaderCache::MakePermutationKey(flags, 0);
+		DX12Shader * VShader = m_ShaderCache->GetShader(DX12Shader::eVertex, L"src/shaders/rendering/ShadowVS.hlsl", key);
+
+		m_ShadowPipelineState[flags] = nullptr;
+
+		if (VShader == nullptr)
+		{
+			PRINT_DEBUG("Error unable to compile shadow permutation %llx", key);
+			continue;
+		}
+
+		D3D12_INPUT_LAYOUT_DESC inputLayout;
+		DX12PipelineState::CreateInputLayoutFromFlags(inputLayout, flags);
+
+		// slope scaled bias against shadow acne
+		CD3DX12_RASTERIZER_DESC rasterizer(D3D12_DEFAULT);
+		rasterizer.DepthBias = 100;
+		rasterizer.SlopeScaledDepthBias = 1.5f;
+		rasterizer.DepthBiasClamp = 0.01f;
+		rasterizer.DepthClipEnable = false;		// casters behind the near plane are pancaked
+
+		DX12PipelineState::PipelineStateDesc desc;
+
+		desc.InputLayout = inputLayout;
+		desc.RootSignature = m_ShadowRootSignature;
+		desc.VertexShader = VShader;
+		desc.PixelShader = nullptr;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		desc.RenderTargetCount = 0;
+		desc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+		desc.DepthStencilDesc = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+		desc.DepthEnabled = true;
+		desc.DepthStencilFormat = DXGI_FORMAT_D32_FLOAT;
+		desc.RasterizerState = rasterizer;
+
+		m_ShadowPipelineState[flags] = new DX12PipelineState(desc);
+
+		// the pipeline state keep a copy of the layout
+		delete [] inputLayout.pInputElementDescs;
+	}
+
+	return S_OK;
+}
+
+FORCEINLINE HRESULT DX12RenderEngine::GenerateDepthPipeline()
+{
+	// root signature : same transform buffer as the GBuffer pass
+	m_DepthRootSignature = new DX12RootSignature;
+
+	m_DepthRootSignature->AddConstantBuffer(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// transform constant (b0)
+
+	m_DepthRootSignature->Create(m_Device);
+
+	// depth only pipeline states, one for each mesh layout
+	for (UINT64 flags = 0; flags < INPUT_LAYOUT_COUNT; ++flags)
+	{
+		const UINT64 key = DX12ShaderCache::MakePermutationKey(flags, 0);
+		DX12Shader * VShader = m_ShaderCache->GetShader(DX12Shader::eVertex, L"src/shaders/rendering/DepthVS.hlsl", key);
+
+		m_DepthPipelineState[flags] = nullptr;
+
+		if (VShader == nullptr)
+		{
+			PRINT_DEBUG("Error unable to compile depth permutation %llx", key);
+			continue;
+		}
+
+		D3D12_INPUT_LAYOUT_DESC inputLayout;
+		DX12PipelineState::CreateInputLayoutFromFlags(inputLayout, flags);
+
+		DX12PipelineState::PipelineStateDesc desc;
+
+		desc.InputLayout = inputLayout;
+		desc.RootSignature = m_DepthRootSignature;
+		desc.VertexShader = VShader;
+		desc.PixelShader = nullptr;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		desc.RenderTargetCount = 0;
+		desc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+		desc.DepthStencilDesc = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+		desc.DepthEnabled = true;
+		desc.DepthStencilFormat = m_DepthBuffer->GetFormat();
+
+		m_DepthPipelineState[flags] = new DX12PipelineState(desc);
+
+		// the pipeline state keep a copy of the layout
+		delete [] inputLayout.pInputElementDescs;
+	}
+
+	return S_OK;
+}
+
+FORCEINLINE HRESULT DX12RenderEngine::GenerateDebugDrawPipeline()
+{
+	// root signature : view projection, primitive type and instance offset are root constants
+	m_DebugDrawRootSignature = new DX12RootSignature;
+
+	m_DebugDrawRootSignature->AddConstants(18, 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);		// view projection + primitive type + instance offset (b0)
+	m_DebugDrawRootSignature->AddShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// lines (t0)
+	m_DebugDrawRootSignature->AddShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// boxes (t1)
+	m_DebugDrawRootSignature->AddShaderResourceView(2, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// spheres (t2)
+
+	m_DebugDrawRootSignature->Create(m_Device);
+
+	DX12Shader * VShader = m_ShaderCache->GetShader(DX12Shader::eVertex, L"src/shaders/debug/DebugDrawVS.hlsl", 0);
+	DX12Shader * PShader = m_ShaderCache->GetShader(DX12Shader::ePixel, L"src/shaders/debug/DebugDrawPS.hlsl", 0);
+
+	if (VShader == nullptr || PShader == nullptr)
+	{
+		PRINT_DEBUG("Error unable to compile debug draw shaders");
+		return E_FAIL;
+	}
+
+	// no vertex buffer : vertices are generated from the vertex id
+	D3D12_INPUT_LAYOUT_DESC inputLayout = {};
+
+	// alpha blended, the depth is tested but not written
+	CD3DX12_BLEND_DESC blendDesc(D3D12_DEFAULT);
+	blendDesc.RenderTarget[0].BlendEnable = true;
+	blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
+	blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+
+	for (UINT i = 0; i < 2; ++i)
+	{
+		CD3DX12_DEPTH_STENCIL_DESC depthDesc(D3D12_DEFAULT);
+		depthDesc.DepthEnable = (i == 0);
+		depthDesc.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+		depthDesc.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+
+		DX12PipelineState::PipelineStateDesc desc;
+
+		desc.InputLayout = inputLayout;
+		desc.RootSignature = m_DebugDrawRootSignature;
+		desc.VertexShader = VShader;
+		desc.PixelShader = PShader;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE;
+		desc.RenderTargetCount = 1;
+		desc.RenderTargetFormat[0] = m_BackBuffer->GetFormat();
+		desc.BlendState = blendDesc;
+		desc.DepthStencilDesc = depthDesc;
+		desc.DepthEnabled = true;	// the depth buffer is bound for both pipelines
+		desc.DepthStencilFormat = m_DepthBuffer->GetFormat();
+
+		m_DebugDrawPipelineState[i] = new DX12PipelineState(desc);
+	}
+
+	return S_OK;
+}
+
 FORCEINLINE HRESULT DX12RenderEngine::GenerateDeferredContext()
 {
 	// -- Create Context -- //
@@ -819,6 +1483,7 @@ FORCEINLINE HRESULT DX12RenderEngine::GenerateDeferredContext()
 	const std::wstring contextNames[eContextCount] = {
 		L"Deferred",			// the GBuffer update context
 		L"Immediate",			// the Immediate (final rendering)
+		L"Resolve",				// GBuffer transitions after the recording
 		L"Copy",				// copy commandlist for resources
 	};
 
@@ -833,6 +1498,36 @@ FORCEINLINE HRESULT DX12RenderEngine::GenerateDeferredContext()
 		m_Context[i] = new DX12Context(desc[i]);
 	}
 
+	// the resolve context is recorded at the end of the frame
+	DX12_ASSERT(m_Context[eResolve]->GetCommandList()->Close());
+
+	// -- Create GBuffer record contexts -- //
+	// each worker have its own command list and command allocators (one per frame)
+	const std::wstring recordNames[eRecordPassCount] = {
+		L"Record Depth ",
+		L"Record GBuffer ",
+	};
+
+	for (UINT pass = 0; pass < eRecordPassCount; ++pass)
+	{
+		for (UINT i = 0; i < MAX_RECORD_WORKER; ++i)
+		{
+			m_RecordContext[pass][i] = nullptr;
+
+			if (i >= m_RecordWorkerCount)
+				continue;
+
+			wchar_t buffer[8u];
+			_itow_s(i, buffer, 10);
+
+			DX12Context::ContextDesc recordDesc;
+			recordDesc.Name = recordNames[pass] + buffer;
+
+			m_RecordContext[pass][i] = new DX12Context(recordDesc);
+			DX12_ASSERT(m_RecordContext[pass][i]->GetCommandList()->Close());
+		}
+	}
+
 	return S_OK;
 }
 
@@ -871,46 +1566,6 @@ void DX12RenderEngine::GeneratePrimitiveShapes()
 	m_RectMesh = manager->PushMesh(meshData);
 }
 
-FORCEINLINE void DX12RenderEngine::GenerateRenderTargets()
-{
-	// -- Create different render targets for the deferred rendering -- //
-
-	std::wstring rtName[eRenderTargetCount];
-
-	rtName[eNormal]		= L"Normal";
-	rtName[eSpecular]	= L"Specular";
-	rtName[ePosition]	= L"Position";
-	rtName[eDiffuse]	= L"Diffuse";
-
-
-	DXGI_FORMAT rtFormat[eRenderTargetCount];
-	rtFormat[eNormal]		= DXGI_FORMAT_R16G16B16A16_FLOAT;
-	rtFormat[eSpecular]		= DXGI_FORMAT_R16G16B16A16_FLOAT;
-	rtFormat[ePosition]		= DXGI_FORMAT_R32G32B32A32_FLOAT;
-	rtFormat[eDiffuse]		= DXGI_FORMAT_B8G8R8A8_UNORM;
-	
-	// same description for each render target
-	DX12RenderTarget::RenderTargetDesc rtDesc;
-	rtDesc.BufferSize			= m_WindowSize;
-	rtDesc.IsShaderResource		= true;
-	// default clear value
-	rtDesc.ClearValue[0]		= 0.f;
-	rtDesc.ClearValue[1]		= 0.f;
-	rtDesc.ClearValue[2]		= 0.f;
-	rtDesc.ClearValue[3]		= 0.f;
-
-
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
-	{
-		rtDesc.Name			= rtName[i];
-		rtDesc.Format		= rtFormat[i];
-		m_RenderTargets[i]	= new DX12RenderTarget(rtDesc);
-
-		// transition the render target to the pixel shader resources
-		GetContext(eImmediate)->GetCommandList()->ResourceBarrier(1, &m_RenderTargets[i]->GetResourceBarrier(D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
-	}
-}
-
 FORCEINLINE HRESULT DX12RenderEngine::InitializeImmediateContext()
 {
 	DX12Context * context = GetContext(eImmediate);
@@ -919,15 +1574,9 @@ FORCEINLINE HRESULT DX12RenderEngine::InitializeImmediateContext()
 	context->ResetContext();
 
 	// setup render targets
-	// now render targets for deferred contexts are bound as shader resources to be used for lighting rendering
+	// the GBuffer is transitioned to shader resources by the frame graph before the light pass
 	context->GetCommandList()->ResourceBarrier(1, &m_BackBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
-	{
-		// transition the render target to the pixel shader resources
-		context->GetCommandList()->ResourceBarrier(1, &m_RenderTargets[i]->GetResourceBarrier(D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
-	}
-
 	// here we again get the handle to our current render target view so we can set it as the render target in the output merger stage of the pipeline
 	D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_BackBuffer->GetRenderTargetCPUDescriptorHandle();
 
@@ -945,72 +1594,28 @@ FORCEINLINE HRESULT DX12RenderEngine::InitializeImmediateContext()
 	// setup primitive topology
 	context->GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST); // set the primitive topology
 
-#ifdef DX12_DEBUG
-	if (DebugIsEnabled())
-	{
-		m_Debug->DrawDebugGBuffer(context->GetCommandList());
-	}
-#else
-	// render immediate context here
-	context->GetCommandList()->SetGraphicsRootSignature(m_ImmediateRootSignature->GetRootSignature());
-	context->GetCommandList()->SetPipelineState(m_ImmediatePipelineState->GetPipelineState());
-
-	// bind textures
-	ID3D12DescriptorHeap * descriptors = nullptr;
-
-	DX12RenderTarget * rt[eRenderTargetCount]
-	{
-		m_RenderTargets[eNormal],
-		m_RenderTargets[eDiffuse],
-		m_RenderTargets[eSpecular],
-	};
-
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
-	{
-		// bind render targets as textures
-		descriptors = rt[i]->GetShaderResourceDescriptorHeap()->GetDescriptorHeap();
-		// update the descriptor for the resources
-		context->GetCommandList()->SetDescriptorHeaps(1, &descriptors);
-		context->GetCommandList()->SetGraphicsRootDescriptorTable(i, rt[i]->GetShaderResourceDescriptorHeap()->GetGPUDescriptorHandle(m_FrameIndex));
-	}
-
-	// render the mesh
-	m_RectMesh->PushOnCommandList(context->GetCommandList());
-#endif
-
 	return S_OK;
 }
 
 FORCEINLINE HRESULT DX12RenderEngine::InitializeDeferredContext()
 {
-	// create deferred handle for render targets
-	D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle[ERenderTargetId::eRenderTargetCount] =
-	{
-		m_RenderTargets[ERenderTargetId::eNormal]->GetRenderTargetCPUDescriptorHandle(),
-		m_RenderTargets[ERenderTargetId::eDiffuse]->GetRenderTargetCPUDescriptorHandle(),
-		m_RenderTargets[ERenderTargetId::eSpecular]->GetRenderTargetCPUDescriptorHandle(),
-		m_RenderTargets[ERenderTargetId::ePosition]->GetRenderTargetCPUDescriptorHandle(),
-	};
-
 	DX12Context * context = GetContext(eDeferred);
 	context->ResetContext();
 
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
+	// record contexts are setup by the render list when the workers record them
+	for (UINT pass = 0; pass < eRecordPassCount; ++pass)
 	{
-		// transition the "m_FrameIndex" render target from the present state to the render target state so the command list draws to it starting from here
-		context->GetCommandList()->ResourceBarrier(1, &m_RenderTargets[i]->GetResourceBarrier(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET));
+		for (UINT i = 0; i < m_RecordWorkerCount; ++i)
+		{
+			m_RecordContext[pass][i]->ResetContext();
+		}
 	}
 
-	// get a handle to the depth/stencil buffer
-	CD3DX12_CPU_DESCRIPTOR_HANDLE dsvHandle(m_DepthBuffer->GetDepthStencilDescriptorHeap()->GetCPUDescriptorHandleForHeapStart());
+	GetContext(eResolve)->ResetContext();
 
-	// set the render target for the output merger stage (the output of the pipeline)
-	context->GetCommandList()->OMSetRenderTargets(eRenderTargetCount, rtvHandle, FALSE, &dsvHandle);
-
-	for (UINT i = 0; i < eRenderTargetCount; ++i)
-	{
-		context->GetCommandList()->ClearRenderTargetView(rtvHandle[i], m_RenderTargets[i]->GetClearValue(), 0, nullptr);
-	}
+	// the depth buffer is written by the depth pre pass and the GBuffer pass
+	// the GBuffer targets are cleared by the GBuffer pass (transient targets of the frame graph)
+	context->GetCommandList()->ResourceBarrier(1, &m_DepthBuffer->GetResourceBarrier(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE));
 
 	// clear depth buffer
 	context->GetCommandList()->ClearDepthStencilView(m_DepthBuffer->GetDepthStencilDescriptorHeap()->GetCPUDescriptorHandleForHeapStart(), D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
@@ -14,6 +14,7 @@
 #include "dx12/DX12Shader.h"
 
 #include "engine/Utils.h"
+#include "engine/FrameGraph.h"
 
 #ifdef DX12_DEBUG
 class DX12Debug;
@@ -28,6 +29,18 @@ class DX12PipelineState;
 class DX12DepthBuffer;
 class DX12Mesh;
 class DX12Context;
+class DX12ShaderCache;
+class DX12ShadowMap;
+class DX12GPUProfiler;
+class DX12MaterialParameterBuffer;
+class DX12BindlessHeap;
+class DX12MeshArena;
+class DX12UploadBuffer;
+class DX12GPUCulling;
+class DX12Particles;
+class DX12Transparency;
+class DX12FrameGraph;
+class RenderBackend;
 
 // Render engine implementation
 class DX12RenderEngine
@@ -41,12 +54,25 @@ public:
 
 	// Singleton
 	static DX12RenderEngine &	GetInstance();
-	static void					Create(HINSTANCE & i_HInstance);
+	static void					Create(HINSTANCE & i_HInstance, RenderBackend * i_Backend);
 	static void					Delete();
 
 	// main call for engine
 	HRESULT			InitializeDX12();
-	HRESULT			InitializeRender();	// call this after the DX12Resource manager instanciation
+	// GBuffer layout (see s_RenderTargetDef)
+	enum EGBufferLayout
+	{
+		eGBufferDefault,	// full precision normal and specular color
+		eGBufferPacked,		// octahedral normal (RG16), albedo + specular intensity (RGBA8), roughness and flags (R16)
+
+		eGBufferLayoutCount,
+	};
+
+	HRESULT			InitializeRender(EGBufferLayout i_GBufferLayout = eGBufferPacked, UINT i_RecordWorkerCount = 4);	// call this after the DX12Resource manager instanciation
+	// headless : no device, only the CPU side is initialized (constant buffers in system memory, no contexts or pipelines)
+	HRESULT			InitializeHeadless(IntVec2 i_RenderSize, UINT i_RecordWorkerCount = 4);
+	bool			IsHeadless() const;
+	RenderBackend *	GetBackend() const;
 	// To do : clean this part of code, pre load all data and generate dependant as context etc...
 	HRESULT			PrepareForRender();
 	HRESULT			Render();
@@ -63,14 +89,28 @@ public:
 	{
 		eTransform,		// used for transform matrix 3D space
 		eGlobal,		// used for global buffer
-		eMaterial,		// used for material specs
-		eLight,			// used for light specs
+		// material parameters are in the material parameter buffer
 
 		// count
 		eConstantBufferCount,
 	};
 
 	DX12ConstantBuffer *		GetConstantBuffer(EConstantBufferId i_Id) const;
+
+	// parameter blocks of the materials (see DX12Material)
+#define MATERIAL_PARAMETER_BLOCK_COUNT		16384
+	DX12MaterialParameterBuffer *	GetMaterialParameterBuffer() const;
+
+	// shader visible heap of the textures and render targets (null when headless)
+#define BINDLESS_DESCRIPTOR_COUNT		4096
+	DX12BindlessHeap *				GetBindlessHeap() const;
+
+	// vertex and index buffers of the meshes (null when headless)
+	DX12MeshArena *					GetMeshArena() const;
+
+	// skinning palettes of the animators for the frame (see AnimationSystem)
+#define MAX_SKINNING_BONES		65536
+	DX12UploadBuffer *				GetSkinningBuffer() const;
 	
 	// deferred render target management
 	enum ERenderTargetId
@@ -78,21 +118,30 @@ public:
 		eNormal,			// normal buffer for pixels
 		eDiffuse,			// specular lighting buffer
 		eSpecular,			// diffuse color buffer
-		ePosition,			// position buffer
+		// the position is reconstructed from the depth buffer
 
 		// count
 		eRenderTargetCount,
 	};
 
-	DX12RenderTarget *			GetRenderTarget(ERenderTargetId i_Id) const;
+	// the GBuffer targets are transient textures of the frame graph (see Engine::BuildFrameGraph)
+	DXGI_FORMAT					GetRenderTargetFormat(ERenderTargetId i_Id) const;
+	FrameGraph::TextureDesc		GetRenderTargetDesc(ERenderTargetId i_Id) const;
+	void						BindGBufferResources(const DX12FrameGraph * i_Resources, const FrameGraph::ResourceId * i_Targets);	// targets of the frame (eRenderTargetCount ids)
+	UINT						GetRenderTargetBindlessIndex(ERenderTargetId i_Id) const;
+	void						ClearGBufferTargets(ID3D12GraphicsCommandList * i_CommandList) const;	// the memory is aliased : cleared by the GBuffer pass
+	EGBufferLayout				GetGBufferLayout() const;
+	UINT64						GetGBufferFeatureFlags() const;	// shader permutation flags of the GBuffer layout (see DX12Material::EMaterialFeature)
 	DX12RenderTarget *			GetBackBuffer() const;
 	DX12DepthBuffer *			GetDepthBuffer() const;
+	void						SetGBufferTargets(ID3D12GraphicsCommandList * i_CommandList, bool i_DepthOnly) const;	// bind the GBuffer (or only the depth buffer) on the deferred context
 
 	// deferred contexts
 	enum EContextId
 	{
 		eDeferred,		// deferred context that will render GBuffer
 		eImmediate,		// immediate context that will render the frame using G-Buffer
+		eResolve,		// GBuffer transitions, submitted after the record contexts
 
 		eUpload,		// upload resources to GPU or change state
 
@@ -101,6 +150,19 @@ public:
 	};
 	DX12Context *			GetContext(EContextId i_Id) const;	// context management
 
+	// GBuffer recording contexts : one context per worker and per pass
+	// the lists are submitted between the deferred and the resolve contexts, in pass then worker order
+	enum ERecordPass
+	{
+		eRecordDepth,		// depth pre pass
+		eRecordGBuffer,		// GBuffer pass
+
+		// count
+		eRecordPassCount,
+	};
+	DX12Context *			GetRecordContext(ERecordPass i_Pass, UINT i_Worker) const;
+	UINT					GetRecordWorkerCount() const;
+
 	// dx12 helpers
 	// For creation of resources in the GPU
 	struct HeapProperty
@@ -136,6 +198,40 @@ public:
 	DX12PipelineState *			GetLightPipelineState() const;
 	DX12RootSignature *			GetLightRootSignature() const;
 
+	// shadow management
+	DX12RootSignature *			GetShadowRootSignature() const;
+	DX12PipelineState *			GetShadowPipelineState(UINT64 i_ElementFlags) const;	// depth only pipeline for the mesh layout
+	DX12ShadowMap *				GetShadowMap() const;	// shadow atlas
+
+	// depth pre pass management
+	DX12RootSignature *			GetDepthRootSignature() const;
+	DX12PipelineState *			GetDepthPipelineState(UINT64 i_ElementFlags) const;	// depth only pipeline for the mesh layout
+	void						SetDepthPrePassEnabled(bool i_Enabled);
+	bool						DepthPrePassIsEnabled() const;
+
+	// GPU driven culling management (null when headless) : the GBuffer draws are culled and drawn indirectly when enabled
+	DX12GPUCulling *			GetGPUCulling() const;
+	void						SetGPUCullingEnabled(bool i_Enabled);
+	bool						GPUCullingIsEnabled() const;
+
+	// particles management (null when headless : the emitters are simulated on the CPU)
+	DX12Particles *				GetParticles() const;
+
+	// semi transparent meshes management (null when headless) : weighted blended OIT when enabled, sorted blending otherwise
+	DX12Transparency *			GetTransparency() const;
+	void						SetOITEnabled(bool i_Enabled);
+	bool						OITIsEnabled() const;
+
+	// debug draw management
+	DX12RootSignature *			GetDebugDrawRootSignature() const;
+	DX12PipelineState *			GetDebugDrawPipelineState(bool i_DepthTest) const;
+
+	// shader permutations management
+	DX12ShaderCache *			GetShaderCache() const;
+
+	// profiling (no profiler when headless)
+	DX12GPUProfiler *			GetGPUProfiler() const;
+
 	// Get/Set
 	int								GetFrameIndex() const;
 	int								GetFrameBufferCount() const;
@@ -143,6 +239,7 @@ public:
 #ifdef DX12_DEBUG
 	void			EnableDebug(bool i_Enable) const;
 	bool			DebugIsEnabled() const;
+	void			DrawDebugGBuffer(ID3D12GraphicsCommandList * i_CommandList) const;	// views of the GBuffer on the back buffer (debug GBuffer pass)
 #endif
 
 	// render primitive 2D
@@ -167,7 +264,7 @@ public:
 	DX12Mesh *		GetRectMesh() const;
 	
 private:
-	DX12RenderEngine(HINSTANCE & i_HInstance);
+	DX12RenderEngine(HINSTANCE & i_HInstance, RenderBackend * i_Backend);
 	~DX12RenderEngine();
 
 	// internal
@@ -181,9 +278,11 @@ private:
 	HRESULT				WaitForPreviousFrame();			// called in PrepareForRender()
 	HRESULT				GenerateImmediateContext();		// create immediate context, final rendering pipelines(later : post process management)
 	HRESULT				GenerateLightPipeline();		// create pipeline state for lights
+	HRESULT				GenerateShadowPipeline();		// create shadow atlas and depth only pipeline states
+	HRESULT				GenerateDepthPipeline();		// create depth pre pass pipeline states
+	HRESULT				GenerateDebugDrawPipeline();	// create debug draw pipeline states (line lists)
 	HRESULT				GenerateDeferredContext();		// create different deferred context
 	void				GeneratePrimitiveShapes();		// create primitive 2D shapes
-	void				GenerateRenderTargets();		// create all render target instead of Back Buffer
 	HRESULT				GenerateContexts();
 	// Initialize contexts to prepare for render
 	HRESULT				InitializeImmediateContext();
@@ -193,6 +292,13 @@ private:
 #define FRAME_BUFFER_COUNT		3
 	const int m_FrameBufferCount = FRAME_BUFFER_COUNT; // number of buffers we want, 2 for double buffering, 3 for tripple buffering
 
+	// backend
+	RenderBackend *				m_Backend;
+	const bool					m_IsHeadless;
+
+	// profiling
+	DX12GPUProfiler *			m_GPUProfiler;	// timestamps of the passes
+
 	// dx12
 	ID3D12Device*				m_Device; // direct3d device
 	IDXGISwapChain3*			m_SwapChain; // swapchain used to switch between render targets
@@ -210,9 +316,14 @@ private:
 	// Render target
 	DX12RenderTarget *			m_BackBuffer;	// back buffer render target
 	ID3D12Resource*				m_BackBufferResource[FRAME_BUFFER_COUNT]; // render target pointer (setup with swap buffer in the engine and then pass to DX12RenderTarget)
-	// Deferred rendering
-	DX12RenderTarget *			m_RenderTargets[ERenderTargetId::eRenderTargetCount];
+	// Deferred rendering (GBuffer of the frame graph)
+	const DX12FrameGraph *		m_GBufferResources;
+	FrameGraph::ResourceId		m_GBufferTargets[ERenderTargetId::eRenderTargetCount];
+	EGBufferLayout				m_GBufferLayout;
 	DX12Context *				m_Context[EContextId::eContextCount];
+#define MAX_RECORD_WORKER		16
+	DX12Context *				m_RecordContext[ERecordPass::eRecordPassCount][MAX_RECORD_WORKER];
+	UINT						m_RecordWorkerCount;
 
 	// Immediate context pipeline state
 	ADDRESS_ID				m_ImmediateContextBuffer;
@@ -221,6 +332,28 @@ private:
 	DX12RootSignature *		m_LightRootSignature;
 	DX12PipelineState *		m_LightPipelineState;
 
+	// Shadow pipeline
+#define INPUT_LAYOUT_COUNT	4	// one pipeline for each input layout without skinning (see DX12PipelineState::EElementFlags)
+	DX12RootSignature *		m_ShadowRootSignature;
+	DX12PipelineState *		m_ShadowPipelineState[INPUT_LAYOUT_COUNT];
+	DX12ShadowMap *			m_ShadowMap;
+
+	// Depth pre pass pipeline
+	DX12RootSignature *		m_DepthRootSignature;
+	DX12PipelineState *		m_DepthPipelineState[INPUT_LAYOUT_COUNT];
+	bool					m_DepthPrePass;
+
+	// GPU driven culling
+	DX12GPUCulling *		m_GPUCulling;
+	bool					m_GPUCullingEnabled;
+	DX12Particles *			m_Particles;
+	DX12Transparency *		m_Transparency;
+	bool					m_OITEnabled;
+
+	// Debug draw pipeline (with and without depth test)
+	DX12RootSignature *		m_DebugDrawRootSignature;
+	DX12PipelineState *		m_DebugDrawPipelineState[2];
+
 	// primitive rectangle mesh
 	DX12Mesh *				m_RectMesh;
 
@@ -238,11 +371,24 @@ private:
 	};
 	static const ConstantBufferDef	s_ConstantBufferSize[EConstantBufferId::eConstantBufferCount];	// setup this array to manage the size of the constant buffer
 	DX12ConstantBuffer *			m_ConstantBuffer[EConstantBufferId::eConstantBufferCount];	// constant buffer are created here and used/managed from other space
+	DX12MaterialParameterBuffer *	m_MaterialParameterBuffer;
+	DX12BindlessHeap *				m_BindlessHeap;
+	DX12MeshArena *					m_MeshArena;
+	DX12UploadBuffer *				m_SkinningBuffer;
+
+	// GBuffer render targets
+	struct RenderTargetDef
+	{
+		DXGI_FORMAT		Format;
+		wchar_t *		Name;
+	};
+	static const RenderTargetDef	s_RenderTargetDef[EGBufferLayout::eGBufferLayoutCount][ERenderTargetId::eRenderTargetCount];	// setup this array to manage the GBuffer layouts (must match GBufferPS.hlsl)
 
 	// size
 	IntVec2						m_WindowSize;
 
 	// Shader
+	DX12ShaderCache *			m_ShaderCache;	// shader permutations
 	DX12Shader *				m_DefaultPixelShader;
 	DX12Shader *				m_DefaultVertexShader;
 
@@ -2,6 +2,7 @@
 
 #include "dx12/DX12RenderEngine.h"
 #include "dx12/DX12Context.h"
+#include "dx12/DX12BindlessHeap.h"
 #include "engine/Debug.h"
 
 DX12RenderTarget::DX12RenderTarget(const RenderTargetDesc & i_Desc)
@@ -12,6 +13,7 @@ DX12RenderTarget::DX12RenderTarget(const RenderTargetDesc & i_Desc)
 	,m_IsResourceView(i_Desc.IsShaderResource)
 	// descriptors
 	,m_ShaderResourceDesc(nullptr)
+	,m_BindlessIndex(DescriptorAllocator::InvalidIndex)
 	,m_RenderTargetDesc(nullptr)
 	// resources
 	,m_RenderTarget(i_Desc.Resource)
@@ -125,6 +127,15 @@ DX12RenderTarget::DX12RenderTarget(const RenderTargetDesc & i_Desc)
 			device->CreateShaderResourceView(m_RenderTarget[i], &srvDesc, srvHandle);
 			srvHandle.Offset(1, m_ShaderResourceDesc->GetDescriptorSize());
 		}
+
+		// the same views in the bindless heap (one per buffer)
+		DX12BindlessHeap * bindlessHeap = DX12RenderEngine::GetInstance().GetBindlessHeap();
+		m_BindlessIndex = bindlessHeap->Allocate(m_FrameCount);
+
+		for (UINT i = 0; i < m_FrameCount && m_BindlessIndex != DescriptorAllocator::InvalidIndex; ++i)
+		{
+			bindlessHeap->CreateShaderResourceView(m_BindlessIndex + i, m_RenderTarget[i], &srvDesc);
+		}
 	}
 }
 
@@ -143,6 +154,7 @@ DX12RenderTarget::~DX12RenderTarget()
 	delete m_RenderTargetDesc;
 
 	if (m_ShaderResourceDesc != nullptr) delete m_ShaderResourceDesc;
+	DX12RenderEngine::GetInstance().GetBindlessHeap()->Free(m_BindlessIndex, m_FrameCount);
 }
 
 DX12DescriptorHeap * DX12RenderTarget::GetRenderTargetDescriptorHeap() const
@@ -173,6 +185,16 @@ D3D12_CPU_DESCRIPTOR_HANDLE DX12RenderTarget::GetShaderResourceCPUDescriptorHand
 	return m_ShaderResourceDesc->GetCPUDescriptorHandle(GetIndex(i_Index));
 }
 
+UINT DX12RenderTarget::GetBindlessIndex(UINT i_Index) const
+{
+	ASSERT(m_IsResourceView);
+
+	if (m_BindlessIndex == DescriptorAllocator::InvalidIndex)
+		return DescriptorAllocator::InvalidIndex;
+
+	return m_BindlessIndex + GetIndex(i_Index);
+}
+
 HRESULT DX12RenderTarget::ResizeBuffer(const IntVec2 & i_Size)
 {
 	if (!m_IsAllocator)
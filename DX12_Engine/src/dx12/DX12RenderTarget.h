@@ -34,6 +34,7 @@ public:
 	D3D12_CPU_DESCRIPTOR_HANDLE		GetRenderTargetCPUDescriptorHandle(UINT i_Index = ((UINT)-1)) const;	// get the descriptor as render target (used for drawing in buffer)
 	// handle (shader resource)
 	D3D12_CPU_DESCRIPTOR_HANDLE		GetShaderResourceCPUDescriptorHandle(UINT i_Index = ((UINT)-1)) const;		// get the descriptor as texture (used for reading buffer)
+	UINT							GetBindlessIndex(UINT i_Index = ((UINT)-1)) const;		// index of the texture in the bindless heap (see DX12BindlessHeap)
 
 	// buffer management
 	HRESULT							ResizeBuffer(const IntVec2 & i_Size);
@@ -50,6 +51,7 @@ private:
 	// render target 
 	DX12DescriptorHeap *			m_RenderTargetDesc;	// descriptor heap for render target
 	DX12DescriptorHeap *			m_ShaderResourceDesc;	// descriptor heap for shader resource
+	UINT							m_BindlessIndex;		// first view of the buffers in the bindless heap
 	ID3D12Resource **				m_RenderTarget;		// render target resources
 
 	// information
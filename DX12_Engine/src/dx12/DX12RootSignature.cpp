@@ -78,6 +78,23 @@ void DX12RootSignature::AddShaderResourceView(UINT32 i_ShaderRegister, UINT32 i_
 	RegisterParameter(rootParam);
 }
 
+void DX12RootSignature::AddUnorderedAccessView(UINT32 i_ShaderRegister, UINT32 i_RegisterSpace, D3D12_SHADER_VISIBILITY i_Visibility)
+{
+	ASSERT_AND_EXIT(!m_IsCreated);
+
+	// create the root descriptor
+	D3D12_ROOT_DESCRIPTOR rootDesc = CreateRootDescriptor(i_ShaderRegister, i_RegisterSpace);
+
+	// create the root parameter
+	D3D12_ROOT_PARAMETER rootParam;
+	rootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+	rootParam.ShaderVisibility = i_Visibility;
+	rootParam.Descriptor = rootDesc;
+
+	// push the root parameter
+	RegisterParameter(rootParam);
+}
+
 void DX12RootSignature::AddConstantBuffer(UINT32 i_ShaderRegister, UINT32 i_RegisterSpace, D3D12_SHADER_VISIBILITY i_Visibility)
 {
 	ASSERT(!m_IsCreated);
@@ -94,6 +111,21 @@ void DX12RootSignature::AddConstantBuffer(UINT32 i_ShaderRegister, UINT32 i_Regi
 	RegisterParameter(rootParam);
 }
 
+void DX12RootSignature::AddConstants(UINT32 i_Num32BitValues, UINT32 i_ShaderRegister, UINT32 i_RegisterSpace, D3D12_SHADER_VISIBILITY i_Visibility)
+{
+	ASSERT(!m_IsCreated);
+
+	// constants are directly stored in the root signature
+	D3D12_ROOT_PARAMETER rootParam;
+	rootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	rootParam.ShaderVisibility = i_Visibility;
+	rootParam.Constants.Num32BitValues = i_Num32BitValues;
+	rootParam.Constants.ShaderRegister = i_ShaderRegister;
+	rootParam.Constants.RegisterSpace = i_RegisterSpace;
+
+	RegisterParameter(rootParam);
+}
+
 void DX12RootSignature::AddDescriptorRange(const D3D12_DESCRIPTOR_RANGE * i_RangeTable, UINT32 i_RangeSize, D3D12_SHADER_VISIBILITY i_Visibility)
 {
 	ASSERT(!m_IsCreated);
@@ -284,6 +316,10 @@ FORCEINLINE bool DX12RootSignature::RegisterParameter(const D3D12_ROOT_PARAMETER
 			registers.append(";");
 		}
 	}
+	else if (i_Parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+	{
+		GenerateBufferId(registers, i_Parameter.ParameterType, i_Parameter.Constants.ShaderRegister, i_Parameter.Constants.RegisterSpace);
+	}
 	else
 	{
 		// push back the register
@@ -301,6 +337,7 @@ FORCEINLINE void DX12RootSignature::GenerateBufferId(std::string & o_Buffer, D3D
 	switch (i_Type)
 	{
 	case D3D12_ROOT_PARAMETER_TYPE_CBV:	o_Buffer = "b";	break;
+	case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:	o_Buffer = "b";	break;
 	case D3D12_ROOT_PARAMETER_TYPE_SRV: o_Buffer = "t";	break;
 	case D3D12_ROOT_PARAMETER_TYPE_UAV: o_Buffer = "u";	break;
 	default:
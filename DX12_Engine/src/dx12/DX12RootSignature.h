@@ -26,7 +26,9 @@ public:
 	// add parameters to the root signature (Warning parameters are sorted on the entry you put)
 	void		AddStaticSampler(const D3D12_STATIC_SAMPLER_DESC & i_Sampler);
 	void		AddShaderResourceView(UINT32 i_ShaderRegister /* t0 to t7*/, UINT32 i_RegisterSpace = 0, D3D12_SHADER_VISIBILITY i_Visibility = D3D12_SHADER_VISIBILITY_ALL);
+	void		AddUnorderedAccessView(UINT32 i_ShaderRegister /* u0 to u7*/, UINT32 i_RegisterSpace = 0, D3D12_SHADER_VISIBILITY i_Visibility = D3D12_SHADER_VISIBILITY_ALL);	// buffers only (textures use a descriptor range)
 	void		AddConstantBuffer(UINT32 i_ShaderRegister /* b0 to b7*/, UINT32 i_RegisterSpace = 0, D3D12_SHADER_VISIBILITY i_Visibility = D3D12_SHADER_VISIBILITY_ALL);
+	void		AddConstants(UINT32 i_Num32BitValues, UINT32 i_ShaderRegister /* b0 to b7*/, UINT32 i_RegisterSpace = 0, D3D12_SHADER_VISIBILITY i_Visibility = D3D12_SHADER_VISIBILITY_ALL);	// root constants
 	void		AddDescriptorRange(const D3D12_DESCRIPTOR_RANGE * i_RangeTable, UINT32 i_RangeSize, D3D12_SHADER_VISIBILITY i_Visibility = D3D12_SHADER_VISIBILITY_ALL);
 
 	// create the root signature on the device
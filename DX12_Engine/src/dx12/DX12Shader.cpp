@@ -33,7 +33,7 @@ DX12Shader::DX12Shader(EShaderType i_Type, const wchar_t * i_Filename, const D3D
 	HRESULT hr;
 
 	// Select the shader target depending the shader type
-	char shaderTarget[7] = "*s_5_0";
+	char shaderTarget[7] = "*s_5_1";	// 5.1 : unbounded descriptor tables (see Bindless.hlsli)
 
 	switch (i_Type)
 	{
@@ -43,6 +43,9 @@ DX12Shader::DX12Shader(EShaderType i_Type, const wchar_t * i_Filename, const D3D
 	case eVertex:
 		shaderTarget[0] = 'v';
 		break;
+	case eCompute:
+		shaderTarget[0] = 'c';
+		break;
 	}
 
 	// Compile shader from file
@@ -51,7 +54,7 @@ DX12Shader::DX12Shader(EShaderType i_Type, const wchar_t * i_Filename, const D3D
 		D3D_COMPILE_STANDARD_FILE_INCLUDE,
 		"main",
 		shaderTarget,
-		D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION,
+		D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_ENABLE_UNBOUNDED_DESCRIPTOR_TABLES,
 		0,
 		&shader,
 		&errorBuff);
@@ -106,7 +109,7 @@ DX12Shader::DX12Shader(EShaderType i_Type, const ShaderCode & i_Code)
 	HRESULT hr;
 
 	// Select the shader target depending the shader type
-	char shaderTarget[7] = "*s_5_0";
+	char shaderTarget[7] = "*s_5_1";	// 5.1 : unbounded descriptor tables (see Bindless.hlsli)
 
 	switch (i_Type)
 	{
@@ -116,6 +119,9 @@ DX12Shader::DX12Shader(EShaderType i_Type, const ShaderCode & i_Code)
 	case eVertex:
 		shaderTarget[0] = 'v';
 		break;
+	case eCompute:
+		shaderTarget[0] = 'c';
+		break;
 	}
 
 	// Compile shader from file
@@ -126,7 +132,7 @@ DX12Shader::DX12Shader(EShaderType i_Type, const ShaderCode & i_Code)
 		D3D_COMPILE_STANDARD_FILE_INCLUDE,
 		"main",
 		shaderTarget,
-		D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION,
+		D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_ENABLE_UNBOUNDED_DESCRIPTOR_TABLES,
 		0,
 		&shader,
 		&errorBuff);
@@ -11,6 +11,7 @@ public:
 	{
 		ePixel		= 0,
 		eVertex		= 1,
+		eCompute	= 2,
 	};
 
 	struct ShaderCode
@@ -0,0 +1,118 @@
+#include "dx12/DX12ShaderCache.h"
+
+#include "dx12/DX12PipelineState.h"
+#include "dx12/DX12Utils.h"
+#include "engine/Debug.h"
+
+// defines for the input layout : must follow DX12PipelineState::EElementFlags
+const DX12ShaderCache::PermutationDefine DX12ShaderCache::s_ElementDefines[] =
+{
+	{ DX12PipelineState::EElementFlags::eHaveNormal,	"HAVE_NORMAL" },
+	{ DX12PipelineState::EElementFlags::eHaveTexcoord,	"HAVE_TEXCOORD" },
+	{ DX12PipelineState::EElementFlags::eHaveSkinning,	"HAVE_SKINNING" },
+};
+
+const UINT DX12ShaderCache::s_ElementDefineCount = _countof(DX12ShaderCache::s_ElementDefines);
+
+UINT64 DX12ShaderCache::MakePermutationKey(UINT64 i_ElementFlags, UINT64 i_FeatureFlags)
+{
+	ASSERT(i_ElementFlags <= 0xffffffff);
+	ASSERT(i_FeatureFlags <= 0xffffffff);
+	return (i_ElementFlags & 0xffffffff) | (i_FeatureFlags << 32);
+}
+
+UINT64 DX12ShaderCache::GetElementFlags(UINT64 i_Key)
+{
+	return i_Key & 0xffffffff;
+}
+
+UINT64 DX12ShaderCache::GetFeatureFlags(UINT64 i_Key)
+{
+	return i_Key >> 32;
+}
+
+DX12ShaderCache::DX12ShaderCache()
+{
+}
+
+DX12ShaderCache::~DX12ShaderCache()
+{
+	Clear();
+}
+
+DX12Shader * DX12ShaderCache::GetShader(DX12Shader::EShaderType i_Type, const wchar_t * i_Filename, UINT64 i_Key, const PermutationDefine * i_FeatureDefines, UINT i_FeatureDefineCount)
+{
+	ShaderKey key = { i_Filename, i_Type, i_Key };
+
+	auto itr = m_Shaders.find(key);
+	if (itr != m_Shaders.end())
+	{
+		return itr->second;
+	}
+
+	// compile the permutation
+	std::vector<D3D_SHADER_MACRO> defines;
+	BuildDefines(defines, i_Key, i_FeatureDefines, i_FeatureDefineCount);
+
+	DX12Shader * shader = new DX12Shader(i_Type, i_Filename, defines.data());
+
+	if (!shader->IsLoaded())
+	{
+		PRINT_DEBUG("Unable to compile shader permutation %llx", i_Key);
+		delete shader;
+		return nullptr;
+	}
+
+	m_Shaders[key] = shader;
+	return shader;
+}
+
+void DX12ShaderCache::Precompile(DX12Shader::EShaderType i_Type, const wchar_t * i_Filename, const UINT64 * i_Keys, UINT i_KeyCount, const PermutationDefine * i_FeatureDefines, UINT i_FeatureDefineCount)
+{
+	for (UINT i = 0; i < i_KeyCount; ++i)
+	{
+		GetShader(i_Type, i_Filename, i_Keys[i], i_FeatureDefines, i_FeatureDefineCount);
+	}
+}
+
+size_t DX12ShaderCache::GetShaderCount() const
+{
+	return m_Shaders.size();
+}
+
+void DX12ShaderCache::Clear()
+{
+	for (auto itr = m_Shaders.begin(); itr != m_Shaders.end(); ++itr)
+	{
+		delete itr->second;
+	}
+
+	m_Shaders.clear();
+}
+
+bool DX12ShaderCache::ShaderKey::operator<(const ShaderKey & i_Other) const
+{
+	if (Key != i_Other.Key)		return Key < i_Other.Key;
+	if (Type != i_Other.Type)	return Type < i_Other.Type;
+	return Filename < i_Other.Filename;
+}
+
+FORCEINLINE void DX12ShaderCache::BuildDefines(std::vector<D3D_SHADER_MACRO>& o_Defines, UINT64 i_Key, const PermutationDefine * i_FeatureDefines, UINT i_FeatureDefineCount)
+{
+	const UINT64 elementFlags = GetElementFlags(i_Key);
+	const UINT64 featureFlags = GetFeatureFlags(i_Key);
+
+	// all defines are always set, so shaders can use #if instead of #ifdef
+	for (UINT i = 0; i < s_ElementDefineCount; ++i)
+	{
+		o_Defines.push_back({ s_ElementDefines[i].Name, (elementFlags & s_ElementDefines[i].Flag) ? "1" : "0" });
+	}
+
+	for (UINT i = 0; i < i_FeatureDefineCount; ++i)
+	{
+		o_Defines.push_back({ i_FeatureDefines[i].Name, (featureFlags & i_FeatureDefines[i].Flag) ? "1" : "0" });
+	}
+
+	// end of the define list
+	o_Defines.push_back({ nullptr, nullptr });
+}
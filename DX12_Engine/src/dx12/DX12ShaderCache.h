@@ -0,0 +1,76 @@
+// shader cache : compile and keep shader permutations
+// a permutation is identified by the shader file, the shader type and a 64 bits key
+// the key is converted into a define set (each known flag become a "NAME 0/1" define)
+
+#pragma once
+
+#include "dx12/DX12Shader.h"
+#include <d3d12.h>
+#include <string>
+#include <vector>
+#include <map>
+
+class DX12ShaderCache
+{
+public:
+	// flag to define association used to generate the define set of a permutation
+	struct PermutationDefine
+	{
+		UINT64			Flag;	// flag tested in the permutation key
+		const char *	Name;	// define name set to 1 or 0 in the shader
+	};
+
+	// permutation key management
+	// low part : input layout flags (DX12PipelineState::EElementFlags), high part : feature flags (material, pass...)
+	static UINT64		MakePermutationKey(UINT64 i_ElementFlags, UINT64 i_FeatureFlags);
+	static UINT64		GetElementFlags(UINT64 i_Key);
+	static UINT64		GetFeatureFlags(UINT64 i_Key);
+
+	// default define tables
+	static const PermutationDefine	s_ElementDefines[];		// defines generated from the input layout flags
+	static const UINT				s_ElementDefineCount;
+
+	DX12ShaderCache();
+	~DX12ShaderCache();
+
+	// retreive a shader permutation, the shader is compiled if not in the cache
+	// i_FeatureDefines is used to convert the feature flags of the key into defines
+	DX12Shader *		GetShader(
+		DX12Shader::EShaderType i_Type,
+		const wchar_t * i_Filename,
+		UINT64 i_Key,
+		const PermutationDefine * i_FeatureDefines = nullptr,
+		UINT i_FeatureDefineCount = 0);
+
+	// compile permutations ahead of time (avoid compilation during rendering)
+	void				Precompile(
+		DX12Shader::EShaderType i_Type,
+		const wchar_t * i_Filename,
+		const UINT64 * i_Keys,
+		UINT i_KeyCount,
+		const PermutationDefine * i_FeatureDefines = nullptr,
+		UINT i_FeatureDefineCount = 0);
+
+	// information
+	size_t				GetShaderCount() const;
+	void				Clear();
+
+private:
+	struct ShaderKey
+	{
+		std::wstring				Filename;
+		DX12Shader::EShaderType		Type;
+		UINT64						Key;
+
+		bool operator<(const ShaderKey & i_Other) const;
+	};
+
+	// helpers
+	static void		BuildDefines(
+		std::vector<D3D_SHADER_MACRO> & o_Defines,
+		UINT64 i_Key,
+		const PermutationDefine * i_FeatureDefines,
+		UINT i_FeatureDefineCount);
+
+	std::map<ShaderKey, DX12Shader *>		m_Shaders;
+};
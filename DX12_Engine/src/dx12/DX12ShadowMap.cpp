@@ -0,0 +1,104 @@
+#include "DX12ShadowMap.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12DescriptorHeap.h"
+#include "dx12/DX12BindlessHeap.h"
+
+DX12ShadowMap::DX12ShadowMap(const ShadowMapDesc & i_Desc)
+	:m_ShadowMap(nullptr)
+	,m_DepthStencilDescriptorHeap(nullptr)
+	,m_ShaderResourceDesc(nullptr)
+	,m_BindlessIndex(DescriptorAllocator::InvalidIndex)
+	,m_Size(i_Desc.Size)
+{
+	// retreive the device to create resource
+	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
+
+	// typeless format : the texture is seen as depth buffer and as shader resource
+	D3D12_CLEAR_VALUE depthOptimizedClearValue = {};
+	depthOptimizedClearValue.Format = DXGI_FORMAT_D32_FLOAT;
+	depthOptimizedClearValue.DepthStencil.Depth = 1.0f;
+	depthOptimizedClearValue.DepthStencil.Stencil = 0;
+
+	// the shadow map start as a texture : the shadow pass transition it to depth write
+	DX12_ASSERT(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32_TYPELESS, m_Size, m_Size, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL),
+		D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+		&depthOptimizedClearValue,
+		IID_PPV_ARGS(&m_ShadowMap)
+	));
+
+	m_ShadowMap->SetName((i_Desc.Name + L" Buffer").c_str());
+
+	// depth stencil view
+	D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc = {};
+	dsvHeapDesc.NumDescriptors = 1;
+	dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+	dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+
+	DX12_ASSERT(device->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&m_DepthStencilDescriptorHeap)));
+	m_DepthStencilDescriptorHeap->SetName((i_Desc.Name + L" Resource Heap").c_str());
+
+	D3D12_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc = {};
+	depthStencilViewDesc.Format = DXGI_FORMAT_D32_FLOAT;
+	depthStencilViewDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+	depthStencilViewDesc.Flags = D3D12_DSV_FLAG_NONE;
+
+	device->CreateDepthStencilView(m_ShadowMap, &depthStencilViewDesc, m_DepthStencilDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
+
+	// shader resource view
+	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
+	srvHeapDesc.NumDescriptors		= 1;
+	srvHeapDesc.Type				= D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	srvHeapDesc.Flags				= D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+	m_ShaderResourceDesc = new DX12DescriptorHeap(srvHeapDesc, L"Shadow Map SRV");
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping		= D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format						= DXGI_FORMAT_R32_FLOAT;
+	srvDesc.ViewDimension				= D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MipLevels			= 1;
+
+	device->CreateShaderResourceView(m_ShadowMap, &srvDesc, m_ShaderResourceDesc->GetCPUDescriptorHandle());
+
+	// the same view in the bindless heap
+	DX12BindlessHeap * bindlessHeap = DX12RenderEngine::GetInstance().GetBindlessHeap();
+	m_BindlessIndex = bindlessHeap->Allocate();
+	bindlessHeap->CreateShaderResourceView(m_BindlessIndex, m_ShadowMap, &srvDesc);
+}
+
+DX12ShadowMap::~DX12ShadowMap()
+{
+	SAFE_RELEASE(m_ShadowMap);
+	SAFE_RELEASE(m_DepthStencilDescriptorHeap);
+	delete m_ShaderResourceDesc;
+	DX12RenderEngine::GetInstance().GetBindlessHeap()->Free(m_BindlessIndex);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DX12ShadowMap::GetDepthStencilCPUDescriptorHandle() const
+{
+	return m_DepthStencilDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+}
+
+DX12DescriptorHeap * DX12ShadowMap::GetShaderResourceDescriptorHeap() const
+{
+	return m_ShaderResourceDesc;
+}
+
+CD3DX12_RESOURCE_BARRIER DX12ShadowMap::GetResourceBarrier(D3D12_RESOURCE_STATES i_StateBefore, D3D12_RESOURCE_STATES i_StateAfter) const
+{
+	return CD3DX12_RESOURCE_BARRIER::Transition(m_ShadowMap, i_StateBefore, i_StateAfter);
+}
+
+UINT DX12ShadowMap::GetBindlessIndex() const
+{
+	return m_BindlessIndex;
+}
+
+UINT DX12ShadowMap::GetSize() const
+{
+	return m_Size;
+}
@@ -0,0 +1,42 @@
+// shadow map management
+// one depth texture used as a shadow atlas : written as depth buffer by the shadow pass and read as a texture by the light pass
+
+#pragma once
+
+#include "d3dx12.h"
+#include <string>
+
+class DX12DescriptorHeap;
+
+class DX12ShadowMap
+{
+public:
+	struct ShadowMapDesc
+	{
+		UINT				Size = 4096;	// width and height of the atlas
+		std::wstring		Name = L"Shadow Map";
+	};
+
+	// constructor/destructor
+	DX12ShadowMap(const ShadowMapDesc & i_Desc);
+	~DX12ShadowMap();
+
+	// dx12
+	D3D12_CPU_DESCRIPTOR_HANDLE		GetDepthStencilCPUDescriptorHandle() const;
+	DX12DescriptorHeap *			GetShaderResourceDescriptorHeap() const;
+	CD3DX12_RESOURCE_BARRIER		GetResourceBarrier(D3D12_RESOURCE_STATES i_StateBefore, D3D12_RESOURCE_STATES i_StateAfter) const;
+	UINT							GetBindlessIndex() const;	// index of the atlas in the bindless heap (see DX12BindlessHeap)
+
+	// information
+	UINT				GetSize() const;
+
+private:
+	// dx12
+	ID3D12Resource *			m_ShadowMap;
+	ID3D12DescriptorHeap *		m_DepthStencilDescriptorHeap;
+	DX12DescriptorHeap *		m_ShaderResourceDesc;
+	UINT						m_BindlessIndex;
+
+	// informations
+	const UINT			m_Size;
+};
@@ -0,0 +1,224 @@
+#include "DX12Transparency.h"
+
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12RootSignature.h"
+#include "dx12/DX12RenderTarget.h"
+#include "dx12/DX12DepthBuffer.h"
+#include "dx12/DX12FrameGraph.h"
+#include "dx12/DX12BindlessHeap.h"
+#include "dx12/DX12ShaderCache.h"
+#include "resource/DX12Mesh.h"
+#include "engine/Debug.h"
+
+const DXGI_FORMAT DX12Transparency::s_AccumulationFormat	= DXGI_FORMAT_R16G16B16A16_FLOAT;
+const DXGI_FORMAT DX12Transparency::s_RevealageFormat		= DXGI_FORMAT_R16_FLOAT;
+
+// clear values of the accumulation targets (optimized clear values of the transient textures)
+static const float s_AccumulationClear[4]	= { 0.f, 0.f, 0.f, 0.f };
+static const float s_RevealageClear[4]		= { 1.f, 0.f, 0.f, 0.f };
+
+DX12Transparency::DX12Transparency(const IntVec2 & i_RenderSize)
+	:m_RenderSize(i_RenderSize)
+	,m_Resources(nullptr)
+	,m_Accumulation(FrameGraph::InvalidId)
+	,m_Revealage(FrameGraph::InvalidId)
+	,m_CompositePipelineState(nullptr)
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	ID3D12Device * device = render.GetDevice();
+	DX12ShaderCache * shaderCache = render.GetShaderCache();
+
+	// -- Composite pipeline -- //
+	m_CompositeRootSignature = new DX12RootSignature;
+
+	D3D12_DESCRIPTOR_RANGE bindlessRange;
+	bindlessRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+	bindlessRange.NumDescriptors = (UINT)-1;	// unbounded
+	bindlessRange.BaseShaderRegister = 0;
+	bindlessRange.RegisterSpace = 1;
+	bindlessRange.OffsetInDescriptorsFromTableStart = 0;
+
+	m_CompositeRootSignature->AddDescriptorRange(&bindlessRange, 1, D3D12_SHADER_VISIBILITY_PIXEL);	// bindless textures (t0, space1)
+	m_CompositeRootSignature->AddConstants(2, 0, 0, D3D12_SHADER_VISIBILITY_PIXEL);					// target indices (b0)
+
+	m_CompositeRootSignature->Create(device);
+
+	DX12Shader * VShader = shaderCache->GetShader(DX12Shader::eVertex, L"src/shaders/light/DeferredLightVS.hlsl", 0);
+	DX12Shader * PShader = shaderCache->GetShader(DX12Shader::ePixel, L"src/shaders/rendering/TransparentCompositePS.hlsl", 0);
+
+	if (VShader == nullptr || PShader == nullptr)
+	{
+		PRINT_DEBUG("Error unable to compile the transparency composite shaders");
+		DEBUG_BREAK;
+		return;
+	}
+
+	// average color over the back buffer : color * (1 - revealage) + back buffer * revealage
+	CD3DX12_BLEND_DESC blendDesc(D3D12_DEFAULT);
+	blendDesc.RenderTarget[0].BlendEnable = true;
+	blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_SRC_ALPHA;
+	blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+	blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ZERO;
+	blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ONE;
+	blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+
+	DX12PipelineState::PipelineStateDesc desc;
+
+	desc.InputLayout = render.GetRectMesh()->GetInputLayoutDesc();
+	desc.RootSignature = m_CompositeRootSignature;
+	desc.VertexShader = VShader;
+	desc.PixelShader = PShader;
+	desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	desc.RenderTargetCount = 1;
+	desc.RenderTargetFormat[0] = render.GetBackBuffer()->GetFormat();
+	desc.BlendState = blendDesc;
+	desc.DepthEnabled = false;
+
+	m_CompositePipelineState = new DX12PipelineState(desc);
+}
+
+DX12Transparency::~DX12Transparency()
+{
+	delete m_CompositePipelineState;
+	delete m_CompositeRootSignature;
+}
+
+FrameGraph::TextureDesc DX12Transparency::GetAccumulationDesc() const
+{
+	return DX12FrameGraph::GetTextureDesc(m_RenderSize.x, m_RenderSize.y, s_AccumulationFormat, false, s_AccumulationClear);
+}
+
+FrameGraph::TextureDesc DX12Transparency::GetRevealageDesc() const
+{
+	return DX12FrameGraph::GetTextureDesc(m_RenderSize.x, m_RenderSize.y, s_RevealageFormat, false, s_RevealageClear);
+}
+
+void DX12Transparency::SetAccumulationTargets(const DX12FrameGraph * i_Resources, FrameGraph::ResourceId i_Accumulation, FrameGraph::ResourceId i_Revealage)
+{
+	m_Resources		= i_Resources;
+	m_Accumulation	= i_Accumulation;
+	m_Revealage		= i_Revealage;
+}
+
+void DX12Transparency::SetupPipelineState(DX12PipelineState::PipelineStateDesc & io_Desc, bool i_OrderIndependent) const
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+
+	// the depth of the opaque geometry is tested but not written
+	io_Desc.DepthStencilDesc = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+	io_Desc.DepthStencilDesc.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+	io_Desc.DepthStencilDesc.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+	io_Desc.DepthEnabled = true;
+	io_Desc.DepthStencilFormat = render.GetDepthBuffer()->GetFormat();
+
+	// both faces are drawn (foliage cards), the back faces are lit with the flipped normal
+	io_Desc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+
+	CD3DX12_BLEND_DESC blendDesc(D3D12_DEFAULT);
+
+	if (i_OrderIndependent)
+	{
+		// accumulation : sum of the weighted colors, revealage : product of (1 - alpha)
+		blendDesc.IndependentBlendEnable = true;
+		blendDesc.RenderTarget[0].BlendEnable = true;
+		blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_ONE;
+		blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_ONE;
+		blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+		blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
+		blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ONE;
+		blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+
+		blendDesc.RenderTarget[1].BlendEnable = true;
+		blendDesc.RenderTarget[1].SrcBlend = D3D12_BLEND_ZERO;
+		blendDesc.RenderTarget[1].DestBlend = D3D12_BLEND_INV_SRC_COLOR;
+		blendDesc.RenderTarget[1].BlendOp = D3D12_BLEND_OP_ADD;
+		blendDesc.RenderTarget[1].SrcBlendAlpha = D3D12_BLEND_ZERO;
+		blendDesc.RenderTarget[1].DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+		blendDesc.RenderTarget[1].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+
+		io_Desc.RenderTargetCount = 2;
+		io_Desc.RenderTargetFormat[0] = s_AccumulationFormat;
+		io_Desc.RenderTargetFormat[1] = s_RevealageFormat;
+	}
+	else
+	{
+		// alpha blended on the back buffer (the alpha of the back buffer is kept)
+		blendDesc.RenderTarget[0].BlendEnable = true;
+		blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+		blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+		blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ZERO;
+		blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ONE;
+		blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+
+		io_Desc.RenderTargetCount = 1;
+		io_Desc.RenderTargetFormat[0] = render.GetBackBuffer()->GetFormat();
+	}
+
+	io_Desc.BlendState = blendDesc;
+}
+
+void DX12Transparency::BeginAccumulation(ID3D12GraphicsCommandList * i_CommandList, const D3D12_CPU_DESCRIPTOR_HANDLE & i_DepthStencil) const
+{
+	// the memory of the targets is aliased : they are always cleared (after the discard of the frame graph)
+	ASSERT(m_Resources != nullptr);
+
+	const D3D12_CPU_DESCRIPTOR_HANDLE targets[2] =
+	{
+		m_Resources->GetRenderTargetView(m_Accumulation),
+		m_Resources->GetRenderTargetView(m_Revealage),
+	};
+
+	i_CommandList->ClearRenderTargetView(targets[0], s_AccumulationClear, 0, nullptr);
+	i_CommandList->ClearRenderTargetView(targets[1], s_RevealageClear, 0, nullptr);
+	i_CommandList->OMSetRenderTargets(_countof(targets), targets, FALSE, &i_DepthStencil);
+}
+
+void DX12Transparency::Composite(ID3D12GraphicsCommandList * i_CommandList, const D3D12_CPU_DESCRIPTOR_HANDLE & i_RenderTarget) const
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	DX12BindlessHeap * bindlessHeap = render.GetBindlessHeap();
+
+	// the accumulation targets are read by index in the bindless heap
+	// the frame graph only sees the transparent pass writing them : they are back in the render target state after the composite
+	ID3D12Resource * accumulation = m_Resources->GetResource(m_Accumulation);
+	ID3D12Resource * revealage = m_Resources->GetResource(m_Revealage);
+
+	const D3D12_RESOURCE_BARRIER toShaderResource[2] =
+	{
+		CD3DX12_RESOURCE_BARRIER::Transition(accumulation, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		CD3DX12_RESOURCE_BARRIER::Transition(revealage, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+	};
+
+	i_CommandList->ResourceBarrier(_countof(toShaderResource), toShaderResource);
+	i_CommandList->OMSetRenderTargets(1, &i_RenderTarget, FALSE, nullptr);
+
+	const UINT targetIndices[2] =
+	{
+		m_Resources->GetBindlessIndex(m_Accumulation),
+		m_Resources->GetBindlessIndex(m_Revealage),
+	};
+
+	i_CommandList->SetGraphicsRootSignature(m_CompositeRootSignature->GetRootSignature());
+	i_CommandList->SetPipelineState(m_CompositePipelineState->GetPipelineState());
+	bindlessHeap->SetOnCommandList(i_CommandList);
+	i_CommandList->SetGraphicsRootDescriptorTable(0, bindlessHeap->GetGPUDescriptorHandle());
+	i_CommandList->SetGraphicsRoot32BitConstants(1, _countof(targetIndices), targetIndices, 0);
+	i_CommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	render.GetRectMesh()->PushOnCommandList(i_CommandList);
+
+	const D3D12_RESOURCE_BARRIER toRenderTarget[2] =
+	{
+		CD3DX12_RESOURCE_BARRIER::Transition(accumulation, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET),
+		CD3DX12_RESOURCE_BARRIER::Transition(revealage, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET),
+	};
+
+	i_CommandList->ResourceBarrier(_countof(toRenderTarget), toRenderTarget);
+}
+
+bool DX12Transparency::IsValid() const
+{
+	return m_CompositePipelineState != nullptr;
+}
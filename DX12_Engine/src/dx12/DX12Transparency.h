@@ -0,0 +1,53 @@
+// semi transparent meshes of the forward pass
+// the materials draw the semi transparent meshes with a forward permutation, lit by the clustered lights (see DX12Material::ForwardLighting)
+// sorted blending : the meshes are drawn back to front, alpha blended on the back buffer
+// order independent : weighted blended OIT, the meshes are accumulated without sorting in two targets
+// (weighted premultiplied color and revealage) then the average color is composited on the back buffer
+// the accumulation targets are transient textures of the frame graph (see Engine::BuildFrameGraph)
+// the depth is tested but not written in both modes (see RenderList::RenderTransparent)
+
+#pragma once
+
+#include "d3dx12.h"
+#include "dx12/DX12PipelineState.h"
+#include "engine/Utils.h"
+#include "engine/FrameGraph.h"
+
+class DX12RootSignature;
+class DX12FrameGraph;
+
+class DX12Transparency
+{
+public:
+	DX12Transparency(const IntVec2 & i_RenderSize);
+	~DX12Transparency();
+
+	// pipelines of the forward permutations : render targets, blend and depth states (see DX12Material)
+	void	SetupPipelineState(DX12PipelineState::PipelineStateDesc & io_Desc, bool i_OrderIndependent) const;
+
+	// accumulation targets of the frame
+	FrameGraph::TextureDesc		GetAccumulationDesc() const;
+	FrameGraph::TextureDesc		GetRevealageDesc() const;
+	void	SetAccumulationTargets(const DX12FrameGraph * i_Resources, FrameGraph::ResourceId i_Accumulation, FrameGraph::ResourceId i_Revealage);
+
+	// order independent : clear and bind the accumulation targets with the depth buffer, then composite them on the target
+	void	BeginAccumulation(ID3D12GraphicsCommandList * i_CommandList, const D3D12_CPU_DESCRIPTOR_HANDLE & i_DepthStencil) const;
+	void	Composite(ID3D12GraphicsCommandList * i_CommandList, const D3D12_CPU_DESCRIPTOR_HANDLE & i_RenderTarget) const;	// the target is bound without depth
+
+	// information
+	bool	IsValid() const;	// false if the composite shader is not compiled (the meshes are sorted)
+
+private:
+	// accumulation targets (render target state out of the composite)
+	static const DXGI_FORMAT	s_AccumulationFormat;	// weighted premultiplied color and weighted alpha, additive
+	static const DXGI_FORMAT	s_RevealageFormat;		// product of (1 - alpha), cleared to 1
+
+	IntVec2						m_RenderSize;
+	const DX12FrameGraph *		m_Resources;
+	FrameGraph::ResourceId		m_Accumulation;
+	FrameGraph::ResourceId		m_Revealage;
+
+	// composite
+	DX12RootSignature *		m_CompositeRootSignature;
+	DX12PipelineState *		m_CompositePipelineState;
+};
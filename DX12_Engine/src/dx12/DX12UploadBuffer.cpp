@@ -0,0 +1,82 @@
+#include "dx12/DX12UploadBuffer.h"
+#include "dx12/DX12RenderEngine.h"
+#include "engine/RenderBackend.h"
+
+DX12UploadBuffer::DX12UploadBuffer(UINT64 i_Size, const wchar_t * i_Name /* = L"Unnamed" */, bool i_IsDuplicated /* = true */)
+	:m_Size(i_Size)
+	,m_IsDuplicated(i_IsDuplicated)
+	,m_Memory(nullptr)
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	RenderBackend * backend = render.GetBackend();
+
+	if (m_IsDuplicated)
+		m_FrameCount = render.GetFrameBufferCount();
+	else
+		m_FrameCount = 1;	// only one buffer
+
+	m_Memory		= new RenderBackend::UploadMemory[m_FrameCount];
+	m_Allocation	= backend->TrackAllocation(i_Name, m_Size * m_FrameCount);
+
+	for (UINT i = 0; i < m_FrameCount; ++i)
+	{
+		backend->CreateUploadMemory(m_Size, i_Name, m_Memory[i]);
+	}
+}
+
+DX12UploadBuffer::~DX12UploadBuffer()
+{
+	RenderBackend * backend = DX12RenderEngine::GetInstance().GetBackend();
+
+	for (UINT i = 0; i < m_FrameCount; ++i)
+	{
+		backend->ReleaseUploadMemory(m_Memory[i]);
+	}
+
+	backend->ReleaseAllocation(m_Allocation);
+
+	delete[] m_Memory;
+}
+
+bool DX12UploadBuffer::Update(const void * i_Data, UINT64 i_Size, UINT64 i_Offset /* = 0 */)
+{
+	if (i_Offset + i_Size > m_Size)
+	{
+		PRINT_DEBUG("Error, trying to update an upload buffer out of its range");
+		DEBUG_BREAK;
+		return false;
+	}
+
+	memcpy(m_Memory[GetFrameIndex()].CPUAddress + i_Offset, i_Data, (size_t)i_Size);
+	return true;
+}
+
+UINT8 * DX12UploadBuffer::GetCPUAddress() const
+{
+	return m_Memory[GetFrameIndex()].CPUAddress;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS DX12UploadBuffer::GetGPUVirtualAddress() const
+{
+	return m_Memory[GetFrameIndex()].GPUAddress;
+}
+
+ID3D12Resource * DX12UploadBuffer::GetResource() const
+{
+	return m_Memory[GetFrameIndex()].Resource;
+}
+
+UINT64 DX12UploadBuffer::GetSize() const
+{
+	return m_Size;
+}
+
+inline int DX12UploadBuffer::GetFrameIndex() const
+{
+	if (m_IsDuplicated)
+	{
+		return DX12RenderEngine::GetInstance().GetFrameIndex();
+	}
+	// only one buffer
+	return 0;
+}
@@ -0,0 +1,40 @@
+// upload buffer management
+// a buffer mapped in the upload heap, duplicated for each frame in flight
+// this is used for big buffers read by shaders (structured buffers bound as root shader resource view)
+
+#pragma once
+
+#include <d3d12.h>
+
+#include "dx12/DX12Utils.h"
+#include "engine/RenderBackend.h"
+
+class DX12UploadBuffer
+{
+public:
+	DX12UploadBuffer(UINT64 i_Size, const wchar_t * i_Name = L"Unnamed", bool i_IsDuplicated = true /* if true : create a buffer for each frame index */);
+	~DX12UploadBuffer();
+
+	// update buffer of the current frame
+	bool						Update(const void * i_Data, UINT64 i_Size, UINT64 i_Offset = 0);
+	UINT8 *						GetCPUAddress() const;	// mapped memory of the current frame
+
+	// dx12 management
+	D3D12_GPU_VIRTUAL_ADDRESS	GetGPUVirtualAddress() const;
+	ID3D12Resource *			GetResource() const;	// buffer of the current frame (copy source)
+
+	// information
+	UINT64						GetSize() const;
+
+private:
+	// internal management
+	int							GetFrameIndex() const;
+
+	// memory of each frame (created by the render backend)
+	RenderBackend::UploadMemory *	m_Memory;
+	// internal management
+	UINT						m_FrameCount;
+	const bool					m_IsDuplicated;
+	const UINT64				m_Size;
+	UINT						m_Allocation;	// allocation tracked by the render backend
+};
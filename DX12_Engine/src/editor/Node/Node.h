@@ -4,6 +4,7 @@
 #pragma once
 
 #include "engine/Defines.h"
+#include "editor/Node/NodeSlot.h"
 
 #ifdef WITH_EDITOR
 
@@ -11,23 +12,12 @@
 
 class NodeLink;
 
-class Node
+class Node : public NodeSlot	// slot types
 {
 public:
 	// Max slots input/output per node
 #define MAX_SLOT		8
 
-	enum ENodeSlotType
-	{
-		eInt,
-		eFloat,
-		eVector3,
-		eVector4,
-		eTexture,
-
-		eNone,
-	};
-
 	struct NodeParam
 	{
 		ENodeSlotType		Type;
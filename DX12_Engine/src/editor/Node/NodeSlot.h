@@ -0,0 +1,20 @@
+// Node slots
+// value types of the node inputs and outputs
+// this is not editor only : the material graph compiler uses the same types (see MaterialGraph)
+
+#pragma once
+
+struct NodeSlot
+{
+	enum ENodeSlotType
+	{
+		eInt,
+		eFloat,
+		eVector2,
+		eVector3,
+		eVector4,
+		eTexture,
+
+		eNone,
+	};
+};
@@ -104,7 +104,7 @@ void UIActorBuilder::DrawWindow()
 		ImGui::Text("Components");
 		ImGui::Separator();
 
-		static const char * componentType[] = {"Render Component", "Light Component"};
+		static const char * componentType[] = {"Render Component", "Light Component", "Particle Component"};
 
 		for (size_t i = 0; i < _countof(componentType); ++i)
 		{
@@ -131,6 +131,12 @@ void UIActorBuilder::DrawWindow()
 						m_Actor->AttachLightComponent(lightDesc);
 					}
 					break;
+				case 2:	// particle component (default emitter)
+					{
+						ParticleComponent::ParticleComponentDesc particleDesc;
+						m_Actor->AttachParticleComponent(particleDesc);
+					}
+					break;
 				}
 			}
 		}
@@ -1,19 +1,58 @@
 #include "UIMaterialBuilder.h"
 
 #include "ui/UI.h"
+#include "engine/Debug.h"
+
+#include <fstream>
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include "../lib/imgui-d3d12/imgui_internal.h"
 #undef IMGUI_DEFINE_MATH_OPERATORS
 
+// graph file : nodes and links of the builder, saved next to the generated shader (one line per node or link)
+#define MATERIAL_GRAPH_FILE_VERSION		1
+
+static std::string GetGraphFile(const char * i_ShaderFile)
+{
+	std::string file(i_ShaderFile);
+	const size_t extension = file.find_last_of('.');
+
+	if (extension != std::string::npos && file.find_first_of("/\\", extension) == std::string::npos)
+		file.erase(extension);
+
+	return file + ".graph";
+}
+
+// combo helpers
+static bool GetParameterItem(void * i_Data, int i_Index, const char ** o_Text)
+{
+	*o_Text = MaterialGraph::GetParameterName((MaterialGraph::EParameter)i_Index);
+	return true;
+}
+
+static bool GetTextureMapItem(void * i_Data, int i_Index, const char ** o_Text)
+{
+	*o_Text = MaterialGraph::GetTextureMapName((MaterialGraph::ETextureMap)i_Index);
+	return true;
+}
+
 UIMaterialBuilder::UIMaterialBuilder()
 	:UIWindow("MaterialBuilder", eNone)
+	,m_LinkNode(-1)
+	,m_LinkSlot(0)
 {
-	m_Nodes.push_back(Node(0, "MainTex", ImVec2(40, 50), 0.5f, ImColor(255, 100, 100), 1, 1));
-	m_Nodes.push_back(Node(1, "BumpMap", ImVec2(40, 150), 0.42f, ImColor(200, 100, 200), 1, 1));
-	m_Nodes.push_back(Node(2, "Combine", ImVec2(270, 80), 1.0f, ImColor(0, 200, 100), 2, 2));
-	m_Links.push_back(NodeLink(0, 0, 2, 0));
-	m_Links.push_back(NodeLink(1, 0, 2, 1));
+	strcpy_s(m_ShaderName, "MaterialGraph");
+
+	// diffuse map modulated by the diffuse color
+	m_Nodes.push_back(Node(0, "MainTex", ImVec2(40, 50), MaterialGraph::eTextureMap, MaterialGraph::eDiffuseMap));
+	m_Nodes.push_back(Node(1, "Sample", ImVec2(220, 50), MaterialGraph::eSample, 0));
+	m_Nodes.push_back(Node(2, "Diffuse color", ImVec2(220, 170), MaterialGraph::eParameter, MaterialGraph::eDiffuseColor));
+	m_Nodes.push_back(Node(3, "Multiply", ImVec2(400, 100), MaterialGraph::eMultiply, 0));
+	m_Nodes.push_back(Node(4, "Output", ImVec2(560, 100), MaterialGraph::eOutput, 0));
+	m_Links.push_back(NodeLink(0, 0, 1, 0));
+	m_Links.push_back(NodeLink(1, 0, 3, 0));
+	m_Links.push_back(NodeLink(2, 0, 3, 1));
+	m_Links.push_back(NodeLink(3, 0, 4, MaterialGraph::eOutputDiffuse));
 }
 
 UIMaterialBuilder::~UIMaterialBuilder()
@@ -22,14 +61,157 @@ UIMaterialBuilder::~UIMaterialBuilder()
 
 void UIMaterialBuilder::SaveCurrentMaterial(const char * i_OutputFile)
 {
+	// the graph is saved even if it does not compile yet
+	const std::string graphFile = GetGraphFile(i_OutputFile);
+	std::ofstream file(graphFile, std::ios::out | std::ios::trunc);
+
+	if (file.is_open())
+	{
+		file.precision(9);
+		file << "material_graph " << MATERIAL_GRAPH_FILE_VERSION << "\n";
+
+		for (int node_idx = 0; node_idx < m_Nodes.Size; node_idx++)
+		{
+			const Node & node = m_Nodes[node_idx];
+			file << "node " << (int)node.Operation << " " << node.Parameter << " " << node.Value << " "
+				<< node.Color.x << " " << node.Color.y << " " << node.Color.z << " " << node.Color.w << " "
+				<< node.Pos.x << " " << node.Pos.y << " " << node.Name << "\n";
+		}
+
+		for (int link_idx = 0; link_idx < m_Links.Size; link_idx++)
+		{
+			const NodeLink & link = m_Links[link_idx];
+			file << "link " << link.InputIdx << " " << link.InputSlot << " " << link.OutputIdx << " " << link.OutputSlot << "\n";
+		}
+	}
+
+	if (!file.good())
+	{
+		PRINT_DEBUG("Error, unable to write the material graph %s", graphFile.c_str());
+	}
+
+	MaterialGraph graph;
+	BuildGraph(graph);
+
+	if (!graph.Compile(m_Result))
+	{
+		PRINT_DEBUG("Error, unable to compile the material graph : %s", m_Result.Error.c_str());
+		return;
+	}
+
+	if (!MaterialGraph::WriteShader(i_OutputFile, m_Result))
+	{
+		PRINT_DEBUG("Error, unable to write the material shader %s", i_OutputFile);
+	}
 }
 
 void UIMaterialBuilder::LoadMaterial(const char * i_FilePath)
 {
+	// the graph file of the shader (see SaveCurrentMaterial)
+	const std::string graphFile = GetGraphFile(i_FilePath);
+	std::ifstream file(graphFile);
+
+	if (!file.is_open())
+	{
+		PRINT_DEBUG("Error, unable to open the material graph %s", graphFile.c_str());
+		return;
+	}
+
+	std::string tag;
+	int version = 0;
+
+	if (!(file >> tag >> version) || tag != "material_graph" || version != MATERIAL_GRAPH_FILE_VERSION)
+	{
+		PRINT_DEBUG("Error, %s is not a material graph (expected version %d)", graphFile.c_str(), MATERIAL_GRAPH_FILE_VERSION);
+		return;
+	}
+
+	// the current graph is kept if the file is not valid
+	ImVector<Node> nodes;
+	ImVector<NodeLink> links;
+
+	while (file >> tag)
+	{
+		if (tag == "node")
+		{
+			int operation = 0, parameter = 0;
+			float value = 0.f;
+			ImVec4 color;
+			ImVec2 pos;
+			std::string name;
+
+			file >> operation >> parameter >> value >> color.x >> color.y >> color.z >> color.w >> pos.x >> pos.y;
+			std::getline(file >> std::ws, name);
+
+			if (file.fail() || operation < 0 || operation >= MaterialGraph::eOperationCount)
+			{
+				PRINT_DEBUG("Error, invalid node %d in the material graph %s", nodes.Size, graphFile.c_str());
+				return;
+			}
+
+			nodes.push_back(Node(nodes.Size, name.c_str(), pos, (MaterialGraph::EOperation)operation, parameter, value, color));
+		}
+		else if (tag == "link")
+		{
+			int inputIdx = -1, inputSlot = 0, outputIdx = -1, outputSlot = 0;
+			file >> inputIdx >> inputSlot >> outputIdx >> outputSlot;
+
+			// links are written after the nodes
+			if (file.fail() || inputIdx < 0 || inputIdx >= nodes.Size || outputIdx < 0 || outputIdx >= nodes.Size
+				|| outputSlot < 0 || outputSlot >= nodes[outputIdx].InputsCount)
+			{
+				PRINT_DEBUG("Error, invalid link %d in the material graph %s", links.Size, graphFile.c_str());
+				return;
+			}
+
+			links.push_back(NodeLink(inputIdx, inputSlot, outputIdx, outputSlot));
+		}
+		else
+		{
+			PRINT_DEBUG("Error, unknown entry '%s' in the material graph %s", tag.c_str(), graphFile.c_str());
+			return;
+		}
+	}
+
+	m_Nodes.swap(nodes);
+	m_Links.swap(links);
+
+	m_LinkNode = -1;
+	m_Result = MaterialGraph::CompileResult();
 }
 
 void UIMaterialBuilder::ClearCurrentMaterial()
 {
+	m_Nodes.clear();
+	m_Links.clear();
+	m_Nodes.push_back(Node(0, "Output", ImVec2(400, 100), MaterialGraph::eOutput, 0));
+
+	m_LinkNode = -1;
+	m_Result = MaterialGraph::CompileResult();
+}
+
+void UIMaterialBuilder::BuildGraph(MaterialGraph & o_Graph) const
+{
+	o_Graph.Clear();
+
+	for (int node_idx = 0; node_idx < m_Nodes.Size; node_idx++)
+	{
+		const Node & node = m_Nodes[node_idx];
+
+		if (node.Operation != MaterialGraph::eConstant)
+			o_Graph.AddNode(node.Operation, (UINT)node.Parameter);
+		else if (node.Parameter == 0)
+			o_Graph.AddConstant(MaterialGraph::eFloat, node.Value);
+		else
+			o_Graph.AddConstant(MaterialGraph::eVector3, node.Color.x, node.Color.y, node.Color.z);
+	}
+
+	// links are drawn from the output slot (input node) to the input slot (output node)
+	for (int link_idx = 0; link_idx < m_Links.Size; link_idx++)
+	{
+		const NodeLink & link = m_Links[link_idx];
+		o_Graph.Link((UINT)link.InputIdx, (UINT)link.OutputIdx, (UINT)link.OutputSlot);
+	}
 }
 
 void UIMaterialBuilder::DrawWindow()
@@ -65,6 +247,42 @@ void UIMaterialBuilder::DrawWindow()
 	const float NODE_SLOT_RADIUS = 4.0f;
 	const ImVec2 NODE_WINDOW_PADDING(8.0f, 8.0f);
 
+	// Compile and save the graph
+	if (ImGui::Button("Compile"))
+	{
+		MaterialGraph graph;
+		BuildGraph(graph);
+		graph.Compile(m_Result);
+	}
+	ImGui::SameLine();
+	ImGui::PushItemWidth(160.0f);
+	ImGui::InputText("##shader", m_ShaderName, sizeof(m_ShaderName));
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	if (ImGui::Button("Save"))
+	{
+		// generated shaders include the GBuffer shader with a relative path
+		CreateDirectoryA("src/shaders/materials", nullptr);
+		SaveCurrentMaterial((std::string("src/shaders/materials/") + m_ShaderName + ".hlsl").c_str());
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Load"))
+		LoadMaterial((std::string("src/shaders/materials/") + m_ShaderName + ".hlsl").c_str());
+	ImGui::SameLine();
+	if (ImGui::Button("Clear"))
+		ClearCurrentMaterial();
+	ImGui::SameLine();
+	if (m_Result.Success)
+	{
+		ImGui::Text("%u instructions (%u live nodes, %u folded, %u merged)", m_Result.InstructionCount, m_Result.LiveNodeCount, m_Result.FoldedNodeCount, m_Result.MergedNodeCount);
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("%s", m_Result.Code.c_str());
+	}
+	else if (!m_Result.Error.empty())
+	{
+		ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_Result.Error.c_str());
+	}
+
 	// Create our child canvas
 	ImGui::Text("Hold middle mouse button to scroll (%.2f,%.2f)", scrolling.x, scrolling.y);
 	ImGui::SameLine(ImGui::GetWindowWidth() - 100);
@@ -117,8 +335,28 @@ void UIMaterialBuilder::DrawWindow()
 		ImGui::SetCursorScreenPos(node_rect_min + NODE_WINDOW_PADDING);
 		ImGui::BeginGroup(); // Lock horizontal position
 		ImGui::Text("%s", node->Name);
-		ImGui::SliderFloat("##value", &node->Value, 0.0f, 1.0f, "Alpha %.2f");
-		ImGui::ColorEdit3("##color", &node->Color.x);
+		switch (node->Operation)
+		{
+		case MaterialGraph::eConstant:
+			if (node->Parameter == 0)
+				ImGui::SliderFloat("##value", &node->Value, 0.0f, 1.0f, "%.2f");
+			else
+				ImGui::ColorEdit3("##color", &node->Color.x);
+			break;
+		case MaterialGraph::eParameter:
+			ImGui::Combo("##parameter", &node->Parameter, GetParameterItem, nullptr, MaterialGraph::eParameterCount);
+			break;
+		case MaterialGraph::eTextureMap:
+			ImGui::Combo("##map", &node->Parameter, GetTextureMapItem, nullptr, MaterialGraph::eTextureMapCount);
+			break;
+		case MaterialGraph::eComponent:
+			ImGui::SliderInt("##component", &node->Parameter, 0, 3);
+			break;
+		default:
+			for (int slot_idx = 0; slot_idx < node->InputsCount; slot_idx++)
+				ImGui::TextDisabled("%s", MaterialGraph::GetInputName(node->Operation, (UINT)slot_idx));
+			break;
+		}
 		ImGui::EndGroup();
 
 		// Save the size of what we have emitted and whether any of the widgets are being used
@@ -138,7 +376,7 @@ void UIMaterialBuilder::DrawWindow()
 		bool node_moving_active = ImGui::IsItemActive();
 		if (node_widgets_active || node_moving_active)
 			node_selected = node->Id;
-		if (node_moving_active && ImGui::IsMouseDragging(0))
+		if (node_moving_active && m_LinkNode == -1 && ImGui::IsMouseDragging(0))
 			node->Pos = node->Pos + ImGui::GetIO().MouseDelta;
 
 		ImU32 node_bg_color = (node_hovered_in_list == node->Id || node_hovered_in_scene == node->Id || (node_hovered_in_list == -1 && node_selected == node->Id)) ? IM_COL32(75, 75, 75, 255) : IM_COL32(60, 60, 60, 255);
@@ -153,6 +391,51 @@ void UIMaterialBuilder::DrawWindow()
 	}
 	draw_list->ChannelsMerge();
 
+	// Drag links from an output slot to an input slot
+	const ImVec2 mouse_pos = ImGui::GetIO().MousePos;
+	if (m_LinkNode == -1 && ImGui::IsMouseClicked(0) && ImGui::IsWindowHovered())
+	{
+		for (int node_idx = 0; node_idx < m_Nodes.Size; node_idx++)
+		{
+			for (int slot_idx = 0; slot_idx < m_Nodes[node_idx].OutputsCount; slot_idx++)
+			{
+				const ImVec2 delta = offset + m_Nodes[node_idx].GetOutputSlotPos(slot_idx) - mouse_pos;
+				if (delta.x * delta.x + delta.y * delta.y < NODE_SLOT_RADIUS * NODE_SLOT_RADIUS * 4.0f)
+				{
+					m_LinkNode = node_idx;
+					m_LinkSlot = slot_idx;
+				}
+			}
+		}
+	}
+	if (m_LinkNode != -1)
+	{
+		ImVec2 p1 = offset + m_Nodes[m_LinkNode].GetOutputSlotPos(m_LinkSlot);
+		draw_list->AddBezierCurve(p1, p1 + ImVec2(+50, 0), mouse_pos + ImVec2(-50, 0), mouse_pos, IM_COL32(200, 200, 100, 255), 3.0f);
+
+		if (!ImGui::IsMouseDown(0))
+		{
+			for (int node_idx = 0; node_idx < m_Nodes.Size; node_idx++)
+			{
+				for (int slot_idx = 0; slot_idx < m_Nodes[node_idx].InputsCount; slot_idx++)
+				{
+					const ImVec2 delta = offset + m_Nodes[node_idx].GetInputSlotPos(slot_idx) - mouse_pos;
+					if (node_idx == m_LinkNode || delta.x * delta.x + delta.y * delta.y >= NODE_SLOT_RADIUS * NODE_SLOT_RADIUS * 4.0f)
+						continue;
+
+					// an input has one link
+					for (int link_idx = m_Links.Size - 1; link_idx >= 0; link_idx--)
+					{
+						if (m_Links[link_idx].OutputIdx == node_idx && m_Links[link_idx].OutputSlot == slot_idx)
+							m_Links.erase(m_Links.begin() + link_idx);
+					}
+					m_Links.push_back(NodeLink(m_LinkNode, m_LinkSlot, node_idx, slot_idx));
+				}
+			}
+			m_LinkNode = -1;
+		}
+	}
+
 	// Open context menu
 	if (!ImGui::IsAnyItemHovered() && ImGui::IsMouseHoveringWindow() && ImGui::IsMouseClicked(1))
 	{
@@ -178,13 +461,33 @@ void UIMaterialBuilder::DrawWindow()
 		{
 			ImGui::Text("Node '%s'", node->Name);
 			ImGui::Separator();
+			if (ImGui::MenuItem("Unlink inputs"))
+			{
+				for (int link_idx = m_Links.Size - 1; link_idx >= 0; link_idx--)
+				{
+					if (m_Links[link_idx].OutputIdx == node->Id)
+						m_Links.erase(m_Links.begin() + link_idx);
+				}
+			}
 			if (ImGui::MenuItem("Rename..", NULL, false, false)) {}
 			if (ImGui::MenuItem("Delete", NULL, false, false)) {}
 			if (ImGui::MenuItem("Copy", NULL, false, false)) {}
 		}
 		else
 		{
-			if (ImGui::MenuItem("Add")) { m_Nodes.push_back(Node(m_Nodes.Size, "New node", scene_pos, 0.5f, ImColor(100, 100, 200), 2, 2)); }
+			if (ImGui::BeginMenu("Add"))
+			{
+				// one output node per graph
+				for (int op = 0; op < MaterialGraph::eOutput; op++)
+				{
+					const char * name = MaterialGraph::GetOperationName((MaterialGraph::EOperation)op);
+					if (ImGui::MenuItem(name))
+						m_Nodes.push_back(Node(m_Nodes.Size, name, scene_pos, (MaterialGraph::EOperation)op, 0));
+				}
+				if (ImGui::MenuItem("Color"))
+					m_Nodes.push_back(Node(m_Nodes.Size, "Color", scene_pos, MaterialGraph::eConstant, 1));
+				ImGui::EndMenu();
+			}
 			if (ImGui::MenuItem("Paste", NULL, false, false)) {}
 		}
 		ImGui::EndPopup();
@@ -1,5 +1,7 @@
 // material builder editor
 // this allow to edit and build a material
+// the nodes are material graph operations : the graph is compiled to a GBuffer pixel shader (see MaterialGraph)
+// the graph is saved next to the shader (.graph file) to be loaded again
 
 #pragma once
 
@@ -10,6 +12,7 @@
 
 #include "ui/UIWindow.h"
 #include "ui/UI.h"
+#include "engine/MaterialGraph.h"
 
 class UIMaterialBuilder : public UIWindow
 {
@@ -30,14 +33,19 @@ private:
 		float   Value;
 		ImVec4  Color;
 		int     InputsCount, OutputsCount;
+		// graph node (constants : float value when the parameter is 0, color else)
+		MaterialGraph::EOperation	Operation;
+		int							Parameter;
 
-		Node(int id, const char* name, const ImVec2 & pos, float value, const ImVec4 & color, int inputs_count, int outputs_count)
+		Node(int id, const char* name, const ImVec2 & pos, MaterialGraph::EOperation operation, int parameter, float value = 0.5f, const ImVec4 & color = ImVec4(1.f, 1.f, 1.f, 1.f))
 			:Id(id)
 			,Pos(pos)
 			,Color(color)
 			,Value(value)
-			,InputsCount(inputs_count)
-			,OutputsCount(outputs_count)
+			,InputsCount((int)MaterialGraph::GetInputCount(operation))
+			,OutputsCount(operation == MaterialGraph::eOutput ? 0 : 1)
+			,Operation(operation)
+			,Parameter(parameter)
 		{
 			strncpy_s(Name, name, 31);
 			Name[31] = '\0';
@@ -67,9 +75,10 @@ private:
 	};
 
 	// load/save material
-	void	SaveCurrentMaterial(const char * i_OutputFile);
-	void	LoadMaterial(const char * i_FilePath);	
+	void	SaveCurrentMaterial(const char * i_OutputFile);	// graph file and shader
+	void	LoadMaterial(const char * i_FilePath);			// graph file of the shader
 	void	ClearCurrentMaterial();
+	void	BuildGraph(MaterialGraph & o_Graph) const;	// the nodes keep their index in the graph
 
 	// internal structure for node management
 	
@@ -79,6 +88,14 @@ private:
 
 	ImVector<Node>		m_Nodes;
 	ImVector<NodeLink>	m_Links;
+
+	// link dragged from an output slot
+	int					m_LinkNode;
+	int					m_LinkSlot;
+
+	// last compilation
+	MaterialGraph::CompileResult	m_Result;
+	char							m_ShaderName[64];
 };
 
 
@@ -7,6 +7,7 @@
 #include "engine/Actor.h"
 #include "components/ActorComponent.h"
 #include "engine/Transform.h"
+#include "engine/Debug.h"
 
 // static definition
 const char *		UISceneBuilder::s_ActorSpawnType[] = { "Empty", "Cube", "Plane", "Light"};
@@ -20,6 +21,8 @@ UISceneBuilder::UISceneBuilder(UIActorBuilder * i_ActorBuilder)
 	,m_ActorToDrag(nullptr)
 	,m_MouseIsOnItem(false)
 {
+	strcpy_s(m_SceneFile, "scene.dxscene");
+
 	// empty actor
 	s_ActorDesc[0].Name = L"Empty";
 
@@ -188,6 +191,26 @@ void UISceneBuilder::DrawWindow()
 		return;
 	}
 
+	// scene file
+	ImGui::InputText("File", m_SceneFile, _countof(m_SceneFile));
+	if (ImGui::Button("Save"))
+	{
+		if (!m_World->SaveWorld(m_SceneFile))
+			PRINT_DEBUG("Error, unable to save the scene %s", m_SceneFile);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Load"))
+	{
+		// the actors are destroyed : no actor kept by the window
+		SelectActor(nullptr);
+		m_ActorToSetup	= nullptr;
+		m_ActorToDrag	= nullptr;
+
+		if (!m_World->LoadWorld(m_SceneFile))
+			PRINT_DEBUG("Error, unable to load the scene %s", m_SceneFile);
+	}
+	ImGui::Separator();
+
 	// draw differents actors here
 	for (UINT i = 0; i < m_World->GetRootActorCount(); ++i)
 	{
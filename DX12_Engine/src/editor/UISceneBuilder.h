@@ -53,6 +53,9 @@ private:
 	Actor *					m_ActorToDrag;
 	bool					m_MouseIsOnItem;
 
+	// scene file
+	char					m_SceneFile[256];
+
 	// internal data
 	static const char *			s_ActorSpawnType[];
 	static Actor::ActorDesc *	s_ActorDesc;
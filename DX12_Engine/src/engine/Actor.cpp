@@ -26,6 +26,18 @@ XMMATRIX Actor::GetWorldTransform()
 	return thisMat;
 }
 
+XMMATRIX Actor::GetInterpolatedWorldTransform(float i_Alpha)
+{
+	XMMATRIX thisMat = Transform::Interpolate(m_PreviousTransform, m_Transform, i_Alpha);
+
+	if (m_Parent != nullptr)
+	{
+		thisMat = thisMat * m_Parent->GetInterpolatedWorldTransform(i_Alpha);
+	}
+
+	return thisMat;
+}
+
 bool Actor::IsRoot() const
 {
 	return (m_Parent == nullptr);
@@ -53,7 +65,7 @@ bool Actor::IsHidden() const
 
 bool Actor::NeedRendering() const
 {
-	return ((m_RenderComponent != nullptr) || (m_LightComponent != nullptr)) && (!m_Hidden);
+	return ((m_RenderComponent != nullptr) || (m_LightComponent != nullptr) || (m_ParticleComponent != nullptr)) && (!m_Hidden);
 }
 
 bool Actor::IsChild(const Actor * i_Actor) const
@@ -107,6 +119,7 @@ void Actor::DetachComponent(ActorComponent * i_Component)
 {
 	if (i_Component == m_LightComponent)		DetachLightComponent();
 	else if (i_Component == m_RenderComponent)	DetachRenderComponent();
+	else if (i_Component == m_ParticleComponent)	DetachParticleComponent();
 	else										DetachComponentInternal(i_Component);
 }
 
@@ -170,6 +183,36 @@ LightComponent * Actor::GetLightComponent() const
 	return m_LightComponent;
 }
 
+void Actor::AttachParticleComponent(const ParticleComponent::ParticleComponentDesc & i_Desc)
+{
+	ASSERT(m_ParticleComponent == nullptr);
+	if (m_ParticleComponent != nullptr) return;
+
+	ParticleComponent * component = new ParticleComponent(i_Desc, this);
+
+	if (AttachComponentInternal(component))
+	{
+		m_ParticleComponent = component;
+	}
+}
+
+bool Actor::DetachParticleComponent()
+{
+	ASSERT(m_ParticleComponent != nullptr);
+	if (m_ParticleComponent == nullptr)		return false;
+
+	DetachComponentInternal(m_ParticleComponent);
+
+	m_ParticleComponent = nullptr;
+
+	return true;
+}
+
+ParticleComponent * Actor::GetParticleComponent() const
+{
+	return m_ParticleComponent;
+}
+
 #ifdef WITH_EDITOR
 ActorComponent * Actor::GetComponent(UINT i_Index) const
 {
@@ -181,17 +224,22 @@ void Actor::SetName(const std::wstring & i_NewName)
 }
 #endif
 
+// pool of the actors (slots are added by blocks of 1024 actors when the pool was not reserved)
+IMPLEMENT_POOLED_ALLOCATION(Actor, 1024)
+
 Actor::Actor(const ActorDesc & i_Desc, World * i_World)
 	:m_Children()
 	,m_World(i_World)
 	,m_Parent(nullptr)
 	,m_Transform()
+	,m_PreviousTransform()
 	,m_Enabled(true)
 	,m_Hidden(false)
 	,m_NeedTick(false)
 	// components
 	,m_RenderComponent(nullptr)
 	,m_LightComponent(nullptr)
+	,m_ParticleComponent(nullptr)
 {
 	// initialize the object from the desc
 	m_NeedTick		= i_Desc.NeedTick;
@@ -239,6 +287,7 @@ Actor::Actor(const ActorDesc & i_Desc, World * i_World)
 				// create child actors
 				ActorDesc childDesc;
 				childDesc.Mesh = i_Desc.Mesh;
+				childDesc.Pass = i_Desc.Pass;
 
 				for (size_t i = 0; i < mesh->GetMeshCount(); ++i)
 				{
@@ -261,6 +310,7 @@ Actor::Actor(const ActorDesc & i_Desc, World * i_World)
 				
 				// retreive the material/mesh buffer
 				componentDesc.Mesh = mesh->GetMeshBuffer(0);
+				componentDesc.Pass = i_Desc.Pass;
 				if (mesh->GetMaterialCount(0) > 0)
 					componentDesc.Material = mesh->GetMaterial(0, 0);
 				else
@@ -276,6 +326,7 @@ Actor::Actor(const ActorDesc & i_Desc, World * i_World)
 
 				// retreive the material/mesh buffer
 				componentDesc.Mesh = mesh->GetMeshBuffer(meshName);
+				componentDesc.Pass = i_Desc.Pass;
 #ifdef ENGINE_DEBUG
 				if (mesh->GetMaterialCount(meshName) == 0)
 					componentDesc.Material = manager->GetMaterialByName("Default")->GetDX12Material();	// load default
@@ -310,6 +361,16 @@ Actor::Actor(const ActorDesc & i_Desc, World * i_World)
 
 		AttachLightComponent(desc);
 	}
+	if (i_Desc.Emitter != "")
+	{
+		ParticleComponent::ParticleComponentDesc desc;
+		desc.Simulation = i_Desc.GPUParticles ? ParticleComponent::eGPUSimulation : ParticleComponent::eCPUSimulation;
+
+		if (Particles::LoadEmitter(i_Desc.Emitter, desc.Emitter))
+			AttachParticleComponent(desc);
+		else
+			PRINT_DEBUG("Error, unable to load emitter %s", i_Desc.Emitter.c_str());
+	}
 }
 
 Actor::Actor(World * i_World)
@@ -317,10 +378,12 @@ Actor::Actor(World * i_World)
 	,m_World(i_World)
 	,m_Parent(nullptr)
 	,m_Transform()
+	,m_PreviousTransform()
 	,m_Enabled(true)
 	,m_NeedTick(false)
 	// components
 	,m_RenderComponent(nullptr)
+	,m_ParticleComponent(nullptr)
 {
 	// empty actors : need to be managed by child class
 }
@@ -330,6 +393,7 @@ Actor::~Actor()
 	// delete components
 	if (m_RenderComponent != nullptr)		delete m_RenderComponent;
 	if (m_LightComponent != nullptr)		delete m_LightComponent;
+	if (m_ParticleComponent != nullptr)		delete m_ParticleComponent;
 }
 
 void Actor::Tick(float i_Elapsed)
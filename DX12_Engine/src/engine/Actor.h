@@ -10,9 +10,11 @@
 
 #include "engine/Transform.h"
 #include "engine/Defines.h"
+#include "engine/ObjectPool.h"
 // components
 #include "components/LightComponent.h"
 #include "components/RenderComponent.h"
+#include "components/ParticleComponent.h"
 
 // class predef
 class World;	// world of the actor
@@ -31,11 +33,15 @@ public:
 		// actor rendering
 		std::string Mesh			= "";
 		UINT SubMeshId				= (UINT)-1;
+		RenderComponent::RenderPass Pass	= RenderComponent::eOpaqueGeometry;	// semi transparent meshes are drawn by the forward pass
 		// actor lighting
 		bool IsLight				= false;
 		Color LightColor			= color::White;
 		float LightRange			= 10.f;
 		Light::ELightType LightType = Light::ePointLight;
+		// actor particles
+		std::string Emitter			= "";		// emitter file (see Particles::LoadEmitter)
+		bool GPUParticles			= false;
 	};
 
 	// public
@@ -43,6 +49,7 @@ public:
 
 	// transform
 	XMMATRIX	GetWorldTransform();
+	XMMATRIX	GetInterpolatedWorldTransform(float i_Alpha);	// between the transform of the previous fixed step and the current one
 
 	// information
 	bool	IsRoot() const;
@@ -74,12 +81,20 @@ public:
 	bool				DetachLightComponent();
 	LightComponent *	GetLightComponent() const;
 
+	// particles management
+	void				AttachParticleComponent(const ParticleComponent::ParticleComponentDesc & i_Desc);
+	bool				DetachParticleComponent();
+	ParticleComponent *	GetParticleComponent() const;
+
 #ifdef WITH_EDITOR
 	// editor purpose
 	ActorComponent *	GetComponent(UINT i_Index) const;
 	void				SetName(const std::wstring & i_NewName);
 #endif
 
+	// actors are allocated from a pool (scene loads reserve the slots of all the actors, see World::LoadScene)
+	DECLARE_POOLED_ALLOCATION()
+
 	// friend class
 	friend class World;
 
@@ -104,6 +119,9 @@ private:
 	// specific render informations
 	void			Render();	// render component
 
+	// transform at the beginning of the last fixed step (see World::SaveTransforms)
+	Transform				m_PreviousTransform;
+
 	// parenting system
 	std::vector<Actor*>		m_Children;
 	Actor *					m_Parent;
@@ -121,6 +139,7 @@ private:
 	// specific unique
 	RenderComponent *				m_RenderComponent;
 	LightComponent *				m_LightComponent;
+	ParticleComponent *				m_ParticleComponent;
 
 	// world of the actor
 	World * const			m_World;
@@ -0,0 +1,137 @@
+#include "Animation.h"
+
+#include "resource/Skeleton.h"
+#include "resource/AnimationClip.h"
+#include "engine/Debug.h"
+
+void Animation::BlendPoses(const BoneTransform * i_PoseA, const BoneTransform * i_PoseB, float i_Weight, UINT i_BoneCount, BoneTransform * o_Pose)
+{
+	const XMVECTOR weight = XMVectorReplicate(i_Weight);
+
+	for (UINT i = 0; i < i_BoneCount; ++i)
+	{
+		const BoneTransform & boneA = i_PoseA[i];
+		const BoneTransform & boneB = i_PoseB[i];
+
+		// rotations on the shortest path
+		const XMVECTOR rotationB = XMVectorSelect(boneB.Rotation, XMVectorNegate(boneB.Rotation), XMVectorLess(XMVector4Dot(boneA.Rotation, boneB.Rotation), XMVectorZero()));
+
+		o_Pose[i].Rotation		= XMQuaternionNormalize(XMVectorLerpV(boneA.Rotation, rotationB, weight));
+		o_Pose[i].Translation	= XMVectorLerpV(boneA.Translation, boneB.Translation, weight);
+		o_Pose[i].Scale			= XMVectorLerpV(boneA.Scale, boneB.Scale, weight);
+	}
+}
+
+void Animation::ComputeSkinningPalette(const Skeleton * i_Skeleton, const BoneTransform * i_Pose, XMMATRIX * io_ModelMatrices, SkinningMatrix * o_Palette)
+{
+	const UINT boneCount = i_Skeleton->GetBoneCount();
+
+	for (UINT i = 0; i < boneCount; ++i)
+	{
+		const BoneTransform & bone = i_Pose[i];
+		const UINT parent = i_Skeleton->GetBone(i).Parent;
+
+		// local to model space : the parents are computed before their children
+		const XMMATRIX local = XMMatrixAffineTransformation(bone.Scale, g_XMZero, bone.Rotation, bone.Translation);
+		io_ModelMatrices[i] = (parent == Skeleton::InvalidBone) ? local : XMMatrixMultiply(local, io_ModelMatrices[parent]);
+
+		// bind space to model space, transposed for the 3x4 storage
+		const XMMATRIX skinning = XMMatrixTranspose(XMMatrixMultiply(i_Skeleton->GetInverseBindMatrix(i), io_ModelMatrices[i]));
+
+		XMStoreFloat4(&o_Palette[i].Rows[0], skinning.r[0]);
+		XMStoreFloat4(&o_Palette[i].Rows[1], skinning.r[1]);
+		XMStoreFloat4(&o_Palette[i].Rows[2], skinning.r[2]);
+	}
+}
+
+void Animator::SetClip(ELayer i_Layer, const AnimationClip * i_Clip, bool i_Loop)
+{
+	ASSERT(i_Clip == nullptr || i_Clip->GetBoneCount() == m_Skeleton->GetBoneCount());
+
+	m_Clips[i_Layer] = i_Clip;
+	m_Times[i_Layer] = 0.f;
+	m_Loops[i_Layer] = i_Loop;
+}
+
+void Animator::SetBlendWeight(float i_Weight)
+{
+	m_BlendWeight = (i_Weight < 0.f) ? 0.f : ((i_Weight > 1.f) ? 1.f : i_Weight);
+}
+
+void Animator::SetSpeed(float i_Speed)
+{
+	m_Speed = i_Speed;
+}
+
+void Animator::Advance(float i_Elapsed)
+{
+	for (UINT i = 0; i < eLayerCount; ++i)
+	{
+		m_Times[i] += i_Elapsed * m_Speed;
+	}
+}
+
+void Animator::EvaluatePose(Animation::BoneTransform * io_PoseA, Animation::BoneTransform * io_PoseB) const
+{
+	const UINT boneCount = m_Skeleton->GetBoneCount();
+
+	if (m_Clips[eBaseLayer] != nullptr)
+	{
+		m_Clips[eBaseLayer]->Sample(m_Times[eBaseLayer], m_Loops[eBaseLayer], io_PoseA);
+	}
+	else
+	{
+		// bind pose
+		for (UINT i = 0; i < boneCount; ++i)
+		{
+			const Skeleton::Bone & bone = m_Skeleton->GetBone(i);
+			io_PoseA[i].Rotation	= XMLoadFloat4(&bone.Rotation);
+			io_PoseA[i].Translation	= XMLoadFloat3(&bone.Translation);
+			io_PoseA[i].Scale		= XMLoadFloat3(&bone.Scale);
+		}
+	}
+
+	if (m_Clips[eBlendLayer] != nullptr && m_BlendWeight > 0.f)
+	{
+		m_Clips[eBlendLayer]->Sample(m_Times[eBlendLayer], m_Loops[eBlendLayer], io_PoseB);
+		Animation::BlendPoses(io_PoseA, io_PoseB, m_BlendWeight, boneCount, io_PoseA);
+	}
+}
+
+const Skeleton * Animator::GetSkeleton() const
+{
+	return m_Skeleton;
+}
+
+UINT Animator::GetBoneCount() const
+{
+	return m_Skeleton->GetBoneCount();
+}
+
+UINT Animator::GetFirstBone() const
+{
+	return m_FirstBone;
+}
+
+float Animator::GetTime(ELayer i_Layer) const
+{
+	return m_Times[i_Layer];
+}
+
+Animator::Animator(const Skeleton * i_Skeleton)
+	:m_Skeleton(i_Skeleton)
+	,m_BlendWeight(0.f)
+	,m_Speed(1.f)
+	,m_FirstBone(InvalidBone)
+{
+	for (UINT i = 0; i < eLayerCount; ++i)
+	{
+		m_Clips[i] = nullptr;
+		m_Times[i] = 0.f;
+		m_Loops[i] = true;
+	}
+}
+
+Animator::~Animator()
+{
+}
@@ -0,0 +1,79 @@
+// skeletal animation
+// a pose is the local transform of each bone of a skeleton (parents first), sampled from the clips and blended with SIMD math
+// the skinning palette is the model transform of the bones multiplied by their inverse bind matrix
+// the palette is stored as 3x4 matrices (rows of the transposed matrix) : 48 bytes per bone in the skinning buffer
+// an animator is the animation state of a character : the evaluation of many animators is split on the workers (see AnimationSystem)
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// class predef
+class Skeleton;
+class AnimationClip;
+
+namespace Animation
+{
+	// local transform of a bone
+	struct BoneTransform
+	{
+		XMVECTOR		Rotation;		// quaternion
+		XMVECTOR		Translation;
+		XMVECTOR		Scale;
+	};
+
+	// skinning matrix of a bone (must match SkinningMatrix in GBufferVS.hlsl)
+	struct SkinningMatrix
+	{
+		XMFLOAT4		Rows[3];		// transposed affine matrix : the vertex is transformed by a dot product per row
+	};
+
+	// pose helpers
+	void	BlendPoses(const BoneTransform * i_PoseA, const BoneTransform * i_PoseB, float i_Weight, UINT i_BoneCount, BoneTransform * o_Pose);	// o_Pose can be one of the inputs
+	void	ComputeSkinningPalette(const Skeleton * i_Skeleton, const BoneTransform * i_Pose, XMMATRIX * io_ModelMatrices, SkinningMatrix * o_Palette);	// io_ModelMatrices : scratch of bone count matrices
+}
+
+class Animator
+{
+public:
+	static const UINT InvalidBone = (UINT)-1;
+
+	// clip layers : the pose is the base clip blended with the blend clip
+	enum ELayer
+	{
+		eBaseLayer = 0,
+		eBlendLayer,
+		eLayerCount,
+	};
+
+	// animation management
+	void				SetClip(ELayer i_Layer, const AnimationClip * i_Clip, bool i_Loop = true);	// restart the layer (null : no clip, bind pose for the base layer)
+	void				SetBlendWeight(float i_Weight);	// weight of the blend layer [0, 1]
+	void				SetSpeed(float i_Speed);
+	void				Advance(float i_Elapsed);
+
+	// evaluation : io_PoseA and io_PoseB are scratch poses of bone count transforms
+	void				EvaluatePose(Animation::BoneTransform * io_PoseA, Animation::BoneTransform * io_PoseB) const;	// result in io_PoseA
+
+	// information
+	const Skeleton *	GetSkeleton() const;
+	UINT				GetBoneCount() const;
+	UINT				GetFirstBone() const;	// first matrix of the palette in the skinning buffer for the current frame (InvalidBone : not evaluated)
+	float				GetTime(ELayer i_Layer) const;
+
+	friend class AnimationSystem;
+private:
+	Animator(const Skeleton * i_Skeleton);
+	~Animator();
+
+	const Skeleton *		m_Skeleton;
+	const AnimationClip *	m_Clips[eLayerCount];
+	float					m_Times[eLayerCount];
+	bool					m_Loops[eLayerCount];
+	float					m_BlendWeight;
+	float					m_Speed;
+	UINT					m_FirstBone;	// set by the animation system each frame
+};
@@ -0,0 +1,139 @@
+#include "AnimationSystem.h"
+
+#include "resource/Skeleton.h"
+#include "engine/CPUProfiler.h"
+#include "engine/Debug.h"
+#include <algorithm>
+
+AnimationSystem::AnimationSystem()
+	:m_BoneCount(0)
+	,m_WorkerUsed(0)
+{
+}
+
+AnimationSystem::~AnimationSystem()
+{
+	for (size_t i = 0; i < m_Animators.size(); ++i)
+	{
+		delete m_Animators[i];
+	}
+}
+
+Animator * AnimationSystem::CreateAnimator(const Skeleton * i_Skeleton)
+{
+	ASSERT(i_Skeleton != nullptr && i_Skeleton->GetBoneCount() > 0);
+
+	Animator * animator = new Animator(i_Skeleton);
+	m_Animators.push_back(animator);
+
+	return animator;
+}
+
+void AnimationSystem::DestroyAnimator(Animator * i_Animator)
+{
+	auto itr = std::find(m_Animators.begin(), m_Animators.end(), i_Animator);
+
+	if (itr != m_Animators.end())
+	{
+		// the order of the animators is not kept : the palette ranges are assigned each frame
+		*itr = m_Animators.back();
+		m_Animators.pop_back();
+		delete i_Animator;
+	}
+}
+
+void AnimationSystem::Evaluate(float i_Elapsed, CommandRecorder * i_Recorder, Animation::SkinningMatrix * o_Palette, UINT i_MaxBoneCount)
+{
+	CPU_ZONE("Evaluate Animations");
+
+	// advance the animators and assign their range of the palette
+	m_BoneCount = 0;
+
+	for (size_t i = 0; i < m_Animators.size(); ++i)
+	{
+		Animator * animator = m_Animators[i];
+		const UINT boneCount = animator->GetBoneCount();
+
+		animator->Advance(i_Elapsed);
+
+		if (o_Palette != nullptr && m_BoneCount + boneCount <= i_MaxBoneCount)
+		{
+			animator->m_FirstBone = m_BoneCount;
+			m_BoneCount += boneCount;
+		}
+		else
+		{
+			animator->m_FirstBone = Animator::InvalidBone;
+		}
+	}
+
+	if (m_BoneCount == 0)
+	{
+		m_WorkerUsed = 0;
+		return;
+	}
+
+	// scratch poses of the workers (a skeleton can't have more bones than SKELETON_MAX_BONES)
+	const UINT workerCount = i_Recorder->GetWorkerCount();
+
+	if (m_Scratch.size() != workerCount)
+	{
+		m_Scratch.resize(workerCount);
+
+		for (size_t i = 0; i < m_Scratch.size(); ++i)
+		{
+			m_Scratch[i].PoseA.resize(SKELETON_MAX_BONES);
+			m_Scratch[i].PoseB.resize(SKELETON_MAX_BONES);
+			m_Scratch[i].ModelMatrices.resize(SKELETON_MAX_BONES);
+		}
+	}
+
+	CommandRecorder::Partition((UINT)m_Animators.size(), workerCount, MIN_EVALUATE_ANIMATOR, m_Ranges);
+
+	m_WorkerUsed = 0;
+	for (size_t i = 0; i < m_Ranges.size(); ++i)
+	{
+		if (m_Ranges[i].Count > 0)
+			++m_WorkerUsed;
+	}
+
+	EvaluateRecorder recorder(this, o_Palette);
+	i_Recorder->Record(m_Ranges, &recorder);
+}
+
+UINT AnimationSystem::GetAnimatorCount() const
+{
+	return (UINT)m_Animators.size();
+}
+
+UINT AnimationSystem::GetBoneCount() const
+{
+	return m_BoneCount;
+}
+
+UINT AnimationSystem::GetEvaluateWorkerUsed() const
+{
+	return m_WorkerUsed;
+}
+
+AnimationSystem::EvaluateRecorder::EvaluateRecorder(AnimationSystem * i_System, Animation::SkinningMatrix * o_Palette)
+	:m_System(i_System)
+	,m_Palette(o_Palette)
+{
+}
+
+void AnimationSystem::EvaluateRecorder::RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range)
+{
+	Scratch & scratch = m_System->m_Scratch[i_Worker];
+
+	for (UINT i = i_Range.First; i < i_Range.First + i_Range.Count; ++i)
+	{
+		const Animator * animator = m_System->m_Animators[i];
+
+		if (animator->GetFirstBone() == Animator::InvalidBone)
+			continue;
+
+		animator->EvaluatePose(scratch.PoseA.data(), scratch.PoseB.data());
+		Animation::ComputeSkinningPalette(animator->GetSkeleton(), scratch.PoseA.data(), scratch.ModelMatrices.data(), m_Palette + animator->GetFirstBone());
+	}
+}
@@ -0,0 +1,60 @@
+// animation system
+// owns the animators of the characters and evaluate them each frame on the workers of the command recorder
+// each animator has a range of the skinning palette (prefix of the bone counts), its first bone is read by the skinned draws
+// the workers sample, blend and compute the palettes in their own scratch poses and write the matrices at the range of the animator
+// the palette is written in the mapped memory of the skinning buffer of the frame (see DX12RenderEngine::GetSkinningBuffer)
+
+#pragma once
+
+#include "engine/Animation.h"
+#include "engine/CommandRecorder.h"
+#include <vector>
+
+// define
+#define			MIN_EVALUATE_ANIMATOR		16		// animators evaluated by a worker before using another worker
+
+class AnimationSystem
+{
+public:
+	AnimationSystem();
+	~AnimationSystem();
+
+	// animators management
+	Animator *		CreateAnimator(const Skeleton * i_Skeleton);
+	void			DestroyAnimator(Animator * i_Animator);
+
+	// advance the animators and compute their palettes in o_Palette (max bone count matrices, the animators out of the palette are not evaluated)
+	void			Evaluate(float i_Elapsed, CommandRecorder * i_Recorder, Animation::SkinningMatrix * o_Palette, UINT i_MaxBoneCount);
+
+	// information
+	UINT			GetAnimatorCount() const;
+	UINT			GetBoneCount() const;			// matrices of the palette the last frame
+	UINT			GetEvaluateWorkerUsed() const;	// workers that evaluated animators the last frame
+
+private:
+	// scratch of a worker
+	struct Scratch
+	{
+		std::vector<Animation::BoneTransform>	PoseA, PoseB;
+		std::vector<XMMATRIX>					ModelMatrices;
+		BYTE									Padding[64];	// the workers don't write on the same cache lines
+	};
+
+	// evaluate a range of animators
+	class EvaluateRecorder : public CommandRecorder::Recorder
+	{
+	public:
+		EvaluateRecorder(AnimationSystem * i_System, Animation::SkinningMatrix * o_Palette);
+		virtual void	RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range) override;
+
+	private:
+		AnimationSystem *				m_System;
+		Animation::SkinningMatrix *		m_Palette;
+	};
+
+	std::vector<Animator *>						m_Animators;
+	std::vector<Scratch>						m_Scratch;		// per worker
+	std::vector<CommandRecorder::DrawRange>		m_Ranges;
+	UINT										m_BoneCount;
+	UINT										m_WorkerUsed;
+};
@@ -0,0 +1,280 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <thread>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/Engine.h"
+#include "engine/CommandRecorder.h"
+#include "engine/Animation.h"
+#include "engine/AnimationSystem.h"
+#include "resource/ResourceManager.h"
+#include "resource/Skeleton.h"
+#include "resource/AnimationClip.h"
+#include "engine/TestUtils.h"
+
+CFAnimationBench::CFAnimationBench()
+	:Console::Function("animation_bench", "[character count]", "evaluate characters of 60 bones on the workers (2 blended clips each), check the compressed clips and the palettes against the raw keys and measure the scaling")
+{
+}
+
+bool CFAnimationBench::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT characterCount = 1000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		characterCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	const UINT boneCount = 60;
+	const UINT clipCount = 4;
+	const UINT frameCount = 61;		// 2 seconds at 30 fps, the last frame is the first one (looped clips)
+	const float rotationTolerance = 1e-5f;	// 1 - |dot| between the compressed and the raw rotations
+	const float translationTolerance = 1e-3f;
+	const float paletteTolerance = 5e-3f;		// quantization errors add up along the chains of bones
+
+	TestRandom random(1);
+
+	// skeleton : chains of 12 bones from the root (limbs and spine)
+	Skeleton::SkeletonData skeletonData;
+	skeletonData.Name = "animation_bench";
+
+	for (UINT i = 0; i < boneCount; ++i)
+	{
+		Skeleton::Bone bone;
+		bone.Name			= "bone_" + std::to_string(i);
+		bone.Parent			= (i == 0) ? Skeleton::InvalidBone : ((i % 12 == 1) ? 0 : i - 1);
+		bone.Translation	= XMFLOAT3(0.f, 0.12f, random.Range(-0.02f, 0.02f));
+		XMStoreFloat4(&bone.Rotation, XMQuaternionRotationRollPitchYaw(random.Range(-0.3f, 0.3f), random.Range(-0.3f, 0.3f), random.Range(-0.3f, 0.3f)));
+		skeletonData.Bones.push_back(bone);
+	}
+
+	// clips : looped rotations, the root moves, some bones are static (constant channels)
+	std::vector<AnimationClip::ClipData> clipData(clipCount);
+
+	for (UINT c = 0; c < clipCount; ++c)
+	{
+		AnimationClip::ClipData & data = clipData[c];
+		data.Name		= "animation_bench_" + std::to_string(c);
+		data.SampleRate	= 30.f;
+		data.FrameCount	= frameCount;
+		data.BoneCount	= boneCount;
+		data.Keys.resize(frameCount * boneCount);
+
+		for (UINT b = 0; b < boneCount; ++b)
+		{
+			const float phase = random.Range(0.f, XM_2PI), amplitude = random.Range(0.2f, 1.2f);
+			const bool animated = (b % 5 != 4);
+
+			for (UINT f = 0; f < frameCount; ++f)
+			{
+				const float angle = XM_2PI * (float)f / (float)(frameCount - 1) + phase;
+				AnimationClip::Key & key = data.Keys[f * boneCount + b];
+
+				key.Rotation	= skeletonData.Bones[b].Rotation;
+				key.Translation	= skeletonData.Bones[b].Translation;
+
+				if (animated)
+					XMStoreFloat4(&key.Rotation, XMQuaternionRotationRollPitchYaw(amplitude * sinf(angle), 0.5f * amplitude * cosf(angle), 0.2f * sinf(2.f * angle)));
+
+				if (b == 0)
+					key.Translation = XMFLOAT3(0.3f * sinf(angle), 1.f + 0.05f * cosf(2.f * angle), 0.f);
+			}
+		}
+	}
+
+	ResourceManager * resourceManager = Engine::GetInstance().GetResourceManager();
+	Skeleton * skeleton = resourceManager->LoadSkeletonWithData(&skeletonData);
+	std::vector<AnimationClip *> clips(clipCount, nullptr);
+	UINT errors = 0;
+
+	for (UINT c = 0; c < clipCount; ++c)
+	{
+		clips[c] = resourceManager->LoadAnimationWithData(&clipData[c]);
+		errors += (clips[c] == nullptr) ? 1 : 0;
+	}
+
+	if (skeleton == nullptr || errors > 0)
+	{
+		GetConsole()->Print("animation bench : unable to load the skeleton or the clips");
+		return false;
+	}
+
+	// raw keys sampled as the clips (reference without compression)
+	auto sampleRaw = [boneCount](const AnimationClip::ClipData & i_Clip, float i_Time, bool i_Loop, Animation::BoneTransform * o_Pose)
+	{
+		const UINT lastFrame = i_Clip.FrameCount - 1;
+		float position = i_Time * i_Clip.SampleRate;
+
+		if (i_Loop && lastFrame > 0)
+		{
+			position = fmodf(position, (float)lastFrame);
+			if (position < 0.f)		position += (float)lastFrame;
+		}
+		else
+		{
+			position = Math::Min(Math::Max(position, 0.f), (float)lastFrame);
+		}
+
+		const UINT frame0 = Math::Min((UINT)position, lastFrame);
+		const UINT frame1 = Math::Min(frame0 + 1, lastFrame);
+		const float weight = position - (float)frame0;
+
+		for (UINT b = 0; b < boneCount; ++b)
+		{
+			const AnimationClip::Key & key0 = i_Clip.Keys[frame0 * boneCount + b];
+			const AnimationClip::Key & key1 = i_Clip.Keys[frame1 * boneCount + b];
+			const XMVECTOR rotation0 = XMQuaternionNormalize(XMLoadFloat4(&key0.Rotation));
+			XMVECTOR rotation1 = XMQuaternionNormalize(XMLoadFloat4(&key1.Rotation));
+
+			if (XMVectorGetX(XMVector4Dot(rotation0, rotation1)) < 0.f)
+				rotation1 = XMVectorNegate(rotation1);
+
+			o_Pose[b].Rotation		= XMQuaternionNormalize(XMVectorLerp(rotation0, rotation1, weight));
+			o_Pose[b].Translation	= XMVectorLerp(XMLoadFloat3(&key0.Translation), XMLoadFloat3(&key1.Translation), weight);
+			o_Pose[b].Scale			= XMVectorLerp(XMLoadFloat3(&key0.Scale), XMLoadFloat3(&key1.Scale), weight);
+		}
+	};
+
+	// compression : the compressed clips against the raw keys, between the frames
+	std::vector<Animation::BoneTransform> pose(boneCount), reference(boneCount), blend(boneCount);
+	float rotationError = 0.f, translationError = 0.f;
+	size_t rawSize = 0, compressedSize = 0;
+
+	for (UINT c = 0; c < clipCount; ++c)
+	{
+		for (UINT sample = 0; sample < 4 * frameCount; ++sample)
+		{
+			const float time = (float)sample / (4.f * clipData[c].SampleRate);
+
+			clips[c]->Sample(time, true, pose.data());
+			sampleRaw(clipData[c], time, true, reference.data());
+
+			for (UINT b = 0; b < boneCount; ++b)
+			{
+				rotationError		= Math::Max(rotationError, 1.f - fabsf(XMVectorGetX(XMVector4Dot(pose[b].Rotation, reference[b].Rotation))));
+				translationError	= Math::Max(translationError, XMVectorGetX(XMVector3Length(XMVectorSubtract(pose[b].Translation, reference[b].Translation))));
+			}
+		}
+
+		rawSize			+= clips[c]->GetRawSize();
+		compressedSize	+= clips[c]->GetCompressedSize();
+	}
+
+	if (rotationError > rotationTolerance || translationError > translationTolerance)
+		++errors;
+
+	GetConsole()->Print("animation bench : %u clips, %llu bytes raw, %llu bytes compressed (x%.2f), max error rotation %g translation %g",
+		clipCount, (UINT64)rawSize, (UINT64)compressedSize, (float)rawSize / (float)Math::Max(compressedSize, (size_t)1), rotationError, translationError);
+
+	// characters : two clips blended, random speeds and start times
+	AnimationSystem animationSystem;
+	std::vector<Animator *> animators(characterCount);
+	std::vector<UINT> characterClips(2 * characterCount);
+	std::vector<float> blendWeights(characterCount);
+
+	for (UINT i = 0; i < characterCount; ++i)
+	{
+		characterClips[2 * i]		= (UINT)random.Range(0.f, (float)clipCount) % clipCount;
+		characterClips[2 * i + 1]	= (characterClips[2 * i] + 1) % clipCount;
+		blendWeights[i]				= random.Range(0.f, 1.f);
+
+		animators[i] = animationSystem.CreateAnimator(skeleton);
+		animators[i]->SetClip(Animator::eBaseLayer, clips[characterClips[2 * i]]);
+		animators[i]->SetClip(Animator::eBlendLayer, clips[characterClips[2 * i + 1]]);
+		animators[i]->SetBlendWeight(blendWeights[i]);
+		animators[i]->SetSpeed(random.Range(0.5f, 1.5f));
+		animators[i]->Advance(random.Range(0.f, 2.f));
+	}
+
+	const UINT paletteSize = characterCount * boneCount;
+	std::vector<Animation::SkinningMatrix> palette(paletteSize), serialPalette(paletteSize);
+
+	// evaluation : 1, 2, 4... workers and the hardware thread count
+	const UINT iterationCount = 16;
+	const UINT maxWorker = Math::Max(std::thread::hardware_concurrency(), 1u);
+	std::vector<UINT> workerCounts;
+
+	for (UINT workerCount = 1; workerCount < maxWorker; workerCount *= 2)
+	{
+		workerCounts.push_back(workerCount);
+	}
+	workerCounts.push_back(maxWorker);
+
+	UINT64 serialTime = 0;
+
+	for (size_t w = 0; w < workerCounts.size(); ++w)
+	{
+		const UINT workerCount = workerCounts[w];
+		CommandRecorder recorder(workerCount);
+		Clock clock;
+
+		for (UINT iteration = 0; iteration < iterationCount; ++iteration)
+		{
+			animationSystem.Evaluate(1.f / 60.f, &recorder, palette.data(), paletteSize);
+		}
+
+		const UINT64 time = clock.GetElaspedTime().ToMicroseconds() / iterationCount;
+		serialTime = (w == 0) ? time : serialTime;
+
+		// same palettes for any worker count (the animators are not advanced)
+		animationSystem.Evaluate(0.f, &recorder, palette.data(), paletteSize);
+
+		if (w == 0)
+			serialPalette = palette;
+		else if (memcmp(palette.data(), serialPalette.data(), paletteSize * sizeof(Animation::SkinningMatrix)) != 0)
+			++errors;
+
+		GetConsole()->Print("animation bench : %u characters, %u bones, %u workers, %llu us per frame (x%.2f)",
+			characterCount, animationSystem.GetBoneCount(), workerCount, time, (float)serialTime / (float)Math::Max(time, (UINT64)1));
+	}
+
+	// palettes against the raw keys
+	std::vector<XMMATRIX> modelMatrices(boneCount);
+	std::vector<Animation::SkinningMatrix> referencePalette(boneCount);
+	float paletteError = 0.f;
+
+	for (UINT i = 0; i < characterCount; ++i)
+	{
+		const Animator * animator = animators[i];
+
+		sampleRaw(clipData[characterClips[2 * i]], animator->GetTime(Animator::eBaseLayer), true, reference.data());
+		sampleRaw(clipData[characterClips[2 * i + 1]], animator->GetTime(Animator::eBlendLayer), true, blend.data());
+		Animation::BlendPoses(reference.data(), blend.data(), blendWeights[i], boneCount, reference.data());
+		Animation::ComputeSkinningPalette(skeleton, reference.data(), modelMatrices.data(), referencePalette.data());
+
+		const Animation::SkinningMatrix * characterPalette = palette.data() + animator->GetFirstBone();
+
+		for (UINT b = 0; b < boneCount; ++b)
+		{
+			for (UINT row = 0; row < 3; ++row)
+			{
+				const XMVECTOR difference = XMVectorAbs(XMVectorSubtract(XMLoadFloat4(&characterPalette[b].Rows[row]), XMLoadFloat4(&referencePalette[b].Rows[row])));
+				paletteError = Math::Max(paletteError, XMVectorGetX(XMVector4Dot(difference, XMVectorReplicate(1.f))));
+			}
+		}
+	}
+
+	if (paletteError > paletteTolerance)
+		++errors;
+
+	for (UINT c = 0; c < clipCount; ++c)
+	{
+		resourceManager->ReleaseResource(clips[c]->GetId());
+	}
+	resourceManager->ReleaseResource(skeleton->GetId());
+
+	GetConsole()->Print("animation bench : max palette error %g, %u errors", paletteError, errors);
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
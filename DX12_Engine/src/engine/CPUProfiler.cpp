@@ -0,0 +1,322 @@
+#include "CPUProfiler.h"
+
+#include "engine/Debug.h"
+#include "engine/Utils.h"
+#include <stdio.h>
+
+// thread data
+thread_local CPUProfiler::ThreadBuffer *	CPUProfiler::t_Buffer = nullptr;
+thread_local UINT							CPUProfiler::t_Depth = 0;
+
+// threads
+std::mutex									CPUProfiler::s_ThreadMutex;
+std::vector<CPUProfiler::ThreadBuffer *>	CPUProfiler::s_Threads;
+
+// calibration
+UINT64										CPUProfiler::s_OriginTicks = 0;
+LARGE_INTEGER								CPUProfiler::s_OriginCounter = {};
+double										CPUProfiler::s_TicksPerMicrosecond = 0.0;
+
+// frames
+std::vector<CPUProfiler::Event>				CPUProfiler::s_LastFrame;
+UINT64										CPUProfiler::s_LastFrameStart = 0;
+UINT64										CPUProfiler::s_LastFrameEnd = 0;
+UINT64										CPUProfiler::s_DroppedZoneCount = 0;
+
+// capture
+std::vector<CPUProfiler::Event>				CPUProfiler::s_Capture;
+std::string									CPUProfiler::s_CaptureFilename;
+UINT										CPUProfiler::s_CaptureFrameCount = 0;
+
+// json strings
+static void WriteJsonString(FILE * i_File, const char * i_String)
+{
+	fputc('"', i_File);
+
+	for (const char * c = i_String; *c != '\0'; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+			fputc('\\', i_File);
+		fputc(*c, i_File);
+	}
+
+	fputc('"', i_File);
+}
+
+void CPUProfiler::Initialize()
+{
+	QueryPerformanceCounter(&s_OriginCounter);
+	s_OriginTicks		= __rdtsc();
+	s_LastFrameStart	= s_OriginTicks;
+	s_LastFrameEnd		= s_OriginTicks;
+}
+
+void CPUProfiler::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(s_ThreadMutex);
+
+	for (size_t i = 0; i < s_Threads.size(); ++i)
+	{
+		delete s_Threads[i];
+	}
+
+	s_Threads.clear();
+	s_LastFrame.clear();
+	s_Capture.clear();
+	s_CaptureFrameCount = 0;
+
+	// the buffer of the calling thread is released
+	t_Buffer = nullptr;
+}
+
+void CPUProfiler::SetThreadName(const char * i_Name)
+{
+	ThreadBuffer * buffer = t_Buffer;
+
+	if (buffer == nullptr)
+		buffer = RegisterThread();
+
+	std::lock_guard<std::mutex> lock(s_ThreadMutex);
+	buffer->Name = i_Name;
+}
+
+void CPUProfiler::EndFrame()
+{
+	const UINT64 frameEnd = __rdtsc();
+
+	// the tick rate is measured from the initialization (more precise over time)
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+
+	const double elapsedMicroseconds = (double)(counter.QuadPart - s_OriginCounter.QuadPart) * 1'000'000.0 / (double)frequency.QuadPart;
+
+	if (elapsedMicroseconds > 0.0)
+		s_TicksPerMicrosecond = (double)(frameEnd - s_OriginTicks) / elapsedMicroseconds;
+
+	// collect the zones of the threads
+	s_LastFrame.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(s_ThreadMutex);
+
+		for (size_t i = 0; i < s_Threads.size(); ++i)
+		{
+			Collect(s_Threads[i], s_LastFrame);
+		}
+	}
+
+	s_LastFrameStart	= s_LastFrameEnd;
+	s_LastFrameEnd		= frameEnd;
+
+	// capture
+	if (s_CaptureFrameCount > 0)
+	{
+		s_Capture.insert(s_Capture.end(), s_LastFrame.begin(), s_LastFrame.end());
+
+		if (--s_CaptureFrameCount == 0)
+		{
+			if (ExportChromeTrace(s_Capture, s_CaptureFilename))
+				PRINT_DEBUG("[CPUProfiler] %u zones written in %s", (UINT)s_Capture.size(), s_CaptureFilename.c_str());
+
+			s_Capture.clear();
+		}
+	}
+}
+
+bool CPUProfiler::StartCapture(UINT i_FrameCount, const std::string & i_Filename)
+{
+	if (i_FrameCount == 0 || IsCapturing())
+		return false;
+
+	s_Capture.clear();
+	s_CaptureFilename	= i_Filename;
+	s_CaptureFrameCount	= i_FrameCount;
+
+	return true;
+}
+
+bool CPUProfiler::IsCapturing()
+{
+	return s_CaptureFrameCount > 0;
+}
+
+bool CPUProfiler::ExportChromeTrace(const std::vector<Event> & i_Events, const std::string & i_Filename)
+{
+	FILE * file = nullptr;
+	if (fopen_s(&file, i_Filename.c_str(), "w") != 0 || file == nullptr)
+	{
+		PRINT_DEBUG("[CPUProfiler] unable to open %s", i_Filename.c_str());
+		return false;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	// thread names
+	const UINT threadCount = GetThreadCount();
+
+	for (UINT i = 0; i < threadCount; ++i)
+	{
+		fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", i);
+		WriteJsonString(file, GetThreadName(i));
+		fprintf(file, "}},\n");
+	}
+
+	// complete events (timestamps in microseconds from the initialization)
+	for (size_t i = 0; i < i_Events.size(); ++i)
+	{
+		const Event & event = i_Events[i];
+
+		fprintf(file, "{\"name\":");
+		WriteJsonString(file, event.Name);
+		fprintf(file, ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			event.Thread,
+			TicksToMicroseconds(event.Start - s_OriginTicks),
+			TicksToMicroseconds(event.End - event.Start),
+			(i + 1 < i_Events.size()) ? "," : "");
+	}
+
+	fprintf(file, "]}\n");
+	fclose(file);
+
+	return true;
+}
+
+const std::vector<CPUProfiler::Event> & CPUProfiler::GetLastFrame()
+{
+	return s_LastFrame;
+}
+
+UINT64 CPUProfiler::GetLastFrameStart()
+{
+	return s_LastFrameStart;
+}
+
+UINT64 CPUProfiler::GetLastFrameEnd()
+{
+	return s_LastFrameEnd;
+}
+
+double CPUProfiler::TicksToMicroseconds(UINT64 i_Ticks)
+{
+	return (s_TicksPerMicrosecond > 0.0) ? (double)i_Ticks / s_TicksPerMicrosecond : 0.0;
+}
+
+const char * CPUProfiler::GetThreadName(UINT i_Thread)
+{
+	std::lock_guard<std::mutex> lock(s_ThreadMutex);
+	return (i_Thread < s_Threads.size()) ? s_Threads[i_Thread]->Name.c_str() : "Unknown";
+}
+
+UINT CPUProfiler::GetThreadCount()
+{
+	std::lock_guard<std::mutex> lock(s_ThreadMutex);
+	return (UINT)s_Threads.size();
+}
+
+UINT64 CPUProfiler::GetDroppedZoneCount()
+{
+	return s_DroppedZoneCount;
+}
+
+double CPUProfiler::MeasureZoneCost(UINT i_ZoneCount, UINT i_Depth)
+{
+	ThreadBuffer * buffer = t_Buffer;
+
+	if (buffer == nullptr)
+		buffer = RegisterThread();
+
+	if (i_ZoneCount == 0)
+		return 0.0;
+
+	LARGE_INTEGER frequency, start, end;
+	QueryPerformanceFrequency(&frequency);
+
+	// loop only
+	volatile UINT sink = 0;
+	QueryPerformanceCounter(&start);
+	for (UINT i = 0; i < i_ZoneCount; ++i)
+	{
+		sink = sink + 1;
+	}
+	QueryPerformanceCounter(&end);
+	const double loopTime = (double)(end.QuadPart - start.QuadPart);
+
+	// nested zones : the innermost level is measured at the requested depth
+	for (UINT i = 1; i < i_Depth; ++i)
+	{
+		++t_Depth;
+	}
+
+	QueryPerformanceCounter(&start);
+	for (UINT i = 0; i < i_ZoneCount; ++i)
+	{
+		CPUProfiler::Zone zone("Benchmark");
+		sink = sink + 1;
+	}
+	QueryPerformanceCounter(&end);
+	const double zoneTime = (double)(end.QuadPart - start.QuadPart);
+
+	for (UINT i = 1; i < i_Depth; ++i)
+	{
+		--t_Depth;
+	}
+
+	// the benchmark zones are discarded with the zones of the thread not collected yet
+	buffer->Read = buffer->Write.load(std::memory_order_relaxed);
+
+	return Math::Max(zoneTime - loopTime, 0.0) * 1'000'000'000.0 / (double)frequency.QuadPart / (double)i_ZoneCount;
+}
+
+CPUProfiler::ThreadBuffer * CPUProfiler::RegisterThread()
+{
+	// buffers are kept until the end of the application (threads can end before a collect)
+	ThreadBuffer * buffer = new ThreadBuffer;
+	buffer->Write.store(0, std::memory_order_relaxed);
+	buffer->Read		= 0;
+	buffer->ThreadId	= GetCurrentThreadId();
+
+	{
+		std::lock_guard<std::mutex> lock(s_ThreadMutex);
+
+		buffer->Index	= (UINT)s_Threads.size();
+		buffer->Name	= "Thread " + std::to_string(buffer->ThreadId);
+		s_Threads.push_back(buffer);
+	}
+
+	t_Buffer = buffer;
+	return buffer;
+}
+
+void CPUProfiler::Collect(ThreadBuffer * i_Buffer, std::vector<Event> & o_Events)
+{
+	const UINT64 write = i_Buffer->Write.load(std::memory_order_acquire);
+	UINT64 read = i_Buffer->Read;
+
+	// the thread wrote more zones than the ring size since the last collect
+	if (write - read > CPU_ZONE_RING_SIZE)
+	{
+		s_DroppedZoneCount += write - read - CPU_ZONE_RING_SIZE;
+		read = write - CPU_ZONE_RING_SIZE;
+	}
+
+	const size_t first = o_Events.size();
+
+	for (UINT64 i = read; i < write; ++i)
+	{
+		const ZoneData & zone = i_Buffer->Zones[i & (CPU_ZONE_RING_SIZE - 1)];
+		o_Events.push_back({ zone.Name, zone.Start, zone.End, zone.Depth, i_Buffer->Index });
+	}
+
+	// zones overwritten while they were copied are removed
+	const UINT64 written = i_Buffer->Write.load(std::memory_order_acquire);
+
+	if (written - read > CPU_ZONE_RING_SIZE)
+	{
+		const UINT64 overwritten = Math::Min(written - read - CPU_ZONE_RING_SIZE, write - read);
+		o_Events.erase(o_Events.begin() + first, o_Events.begin() + first + (size_t)overwritten);
+		s_DroppedZoneCount += overwritten;
+	}
+
+	i_Buffer->Read = write;
+}
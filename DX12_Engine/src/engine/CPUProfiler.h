@@ -0,0 +1,154 @@
+// CPU profiler
+// hierarchical scoped zones (see CPU_ZONE) : a zone is written when it ends in the ring buffer of its thread
+// rings have one writer (their thread) and one reader (the main thread at the end of the frame) : no lock on the zones
+// timestamps are CPU ticks (rdtsc), converted in microseconds with the performance counter
+// the main thread collects the zones each frame for the live view and the captures (chrome trace event format)
+// this is a static class
+
+#pragma once
+
+#include <Windows.h>
+#include <intrin.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define CPU_PROFILER_ENABLED		1
+#define CPU_ZONE_RING_SIZE			4096	// zones per thread between two collects (power of two)
+
+#if CPU_PROFILER_ENABLED
+#define CPU_ZONE_CONCAT_(a, b)		a##b
+#define CPU_ZONE_CONCAT(a, b)		CPU_ZONE_CONCAT_(a, b)
+#define CPU_ZONE(name)				CPUProfiler::Zone CPU_ZONE_CONCAT(cpuZone, __LINE__)(name)
+#else
+#define CPU_ZONE(name)
+#endif
+
+class CPUProfiler
+{
+public:
+	// zone of a thread (the name must be a static string)
+	struct ZoneData
+	{
+		const char *	Name;
+		UINT64			Start;		// ticks
+		UINT64			End;
+		UINT			Depth;		// nested level in the thread
+	};
+
+	// collected zone
+	struct Event
+	{
+		const char *	Name;
+		UINT64			Start;
+		UINT64			End;
+		UINT			Depth;
+		UINT			Thread;		// index of the thread (see GetThreadName)
+	};
+
+	// scoped zone
+	class Zone
+	{
+	public:
+		FORCEINLINE Zone(const char * i_Name)
+			:m_Name(i_Name)
+		{
+			++t_Depth;
+			m_Start = __rdtsc();
+		}
+
+		FORCEINLINE ~Zone()
+		{
+			const UINT64 end = __rdtsc();
+			--t_Depth;
+			CPUProfiler::PushZone(m_Name, m_Start, end, t_Depth);
+		}
+
+	private:
+		const char *	m_Name;
+		UINT64			m_Start;
+	};
+
+	// management
+	static void		Initialize();	// calibration origin (called by the engine before any zone)
+	static void		Shutdown();		// release the buffers (the other threads must not record zones anymore)
+	static void		SetThreadName(const char * i_Name);	// name of the calling thread in the captures
+	static void		EndFrame();		// main thread : collect the zones of all the threads
+
+	// capture
+	static bool		StartCapture(UINT i_FrameCount, const std::string & i_Filename);
+	static bool		IsCapturing();
+	static bool		ExportChromeTrace(const std::vector<Event> & i_Events, const std::string & i_Filename);
+
+	// information
+	static const std::vector<Event> &	GetLastFrame();		// zones collected by the last EndFrame
+	static UINT64		GetLastFrameStart();	// ticks of the previous EndFrame
+	static UINT64		GetLastFrameEnd();
+	static double		TicksToMicroseconds(UINT64 i_Ticks);
+	static const char *	GetThreadName(UINT i_Thread);
+	static UINT			GetThreadCount();
+	static UINT64		GetDroppedZoneCount();	// zones overwritten before their collect
+
+	// benchmark : cost of an empty zone in nanoseconds (main thread only : the zones of the frame are discarded)
+	static double		MeasureZoneCost(UINT i_ZoneCount, UINT i_Depth = 1);
+
+	// zone writing (called by the zones)
+	static FORCEINLINE void		PushZone(const char * i_Name, UINT64 i_Start, UINT64 i_End, UINT i_Depth)
+	{
+		ThreadBuffer * buffer = t_Buffer;
+
+		if (buffer == nullptr)
+			buffer = RegisterThread();
+
+		// single writer : the zone is written before the index is published
+		const UINT64 write = buffer->Write.load(std::memory_order_relaxed);
+		ZoneData & zone = buffer->Zones[write & (CPU_ZONE_RING_SIZE - 1)];
+
+		zone.Name	= i_Name;
+		zone.Start	= i_Start;
+		zone.End	= i_End;
+		zone.Depth	= i_Depth;
+
+		buffer->Write.store(write + 1, std::memory_order_release);
+	}
+
+private:
+	// ring of a thread
+	struct ThreadBuffer
+	{
+		ZoneData				Zones[CPU_ZONE_RING_SIZE];
+		std::atomic<UINT64>		Write;		// zones written by the thread
+		UINT64					Read;		// zones collected by the main thread
+		std::string				Name;
+		DWORD					ThreadId;
+		UINT					Index;
+	};
+
+	static ThreadBuffer *	RegisterThread();	// first zone of a thread
+	static void				Collect(ThreadBuffer * i_Buffer, std::vector<Event> & o_Events);
+
+	// thread data
+	static thread_local ThreadBuffer *		t_Buffer;
+	static thread_local UINT				t_Depth;
+
+	// threads
+	static std::mutex						s_ThreadMutex;		// only for the registration of the threads
+	static std::vector<ThreadBuffer *>		s_Threads;
+
+	// calibration
+	static UINT64							s_OriginTicks;
+	static LARGE_INTEGER					s_OriginCounter;
+	static double							s_TicksPerMicrosecond;
+
+	// frames
+	static std::vector<Event>				s_LastFrame;
+	static UINT64							s_LastFrameStart;
+	static UINT64							s_LastFrameEnd;
+	static UINT64							s_DroppedZoneCount;
+
+	// capture
+	static std::vector<Event>				s_Capture;
+	static std::string						s_CaptureFilename;
+	static UINT								s_CaptureFrameCount;	// frames left to capture
+};
@@ -0,0 +1,38 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include "engine/Utils.h"
+#include "engine/CPUProfiler.h"
+
+CFCPUZoneBenchmark::CFCPUZoneBenchmark()
+	:Console::Function("cpu_zone_bench", "[zone count]", "measure the cost of a CPU zone (the zones of the frame are discarded)")
+{
+}
+
+bool CFCPUZoneBenchmark::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT zoneCount = 1000000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		zoneCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	const UINT64 dropped = CPUProfiler::GetDroppedZoneCount();
+
+	// first run warms up the ring (page faults)
+	CPUProfiler::MeasureZoneCost(CPU_ZONE_RING_SIZE);
+	const double flatCost	= CPUProfiler::MeasureZoneCost(zoneCount);
+	const double nestedCost	= CPUProfiler::MeasureZoneCost(zoneCount, 8);
+
+	// the benchmark zones are never collected
+	const bool discarded = (CPUProfiler::GetDroppedZoneCount() == dropped);
+
+	GetConsole()->Print("cpu zone bench : %u zones, %.2f ns per zone, %.2f ns per nested zone%s", zoneCount, flatCost, nestedCost, discarded ? "" : " (zones dropped)");
+	return discarded;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
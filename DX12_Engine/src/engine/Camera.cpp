@@ -3,6 +3,7 @@
 #include "engine/Utils.h"
 #include "engine/Window.h"
 #include "engine/Engine.h"
+#include "dx12/DX12RenderEngine.h"
 
 #include <math.h>
 
@@ -25,10 +26,10 @@ Camera::Camera()
 	,m_Pitch(0)
 	,m_Yaw(0)
 {
-	// build projection matrix
-	Window * wnd = Engine::GetInstance().GetWindow();
+	// build projection matrix (the render size is the window size, or the simulated size when headless)
+	const IntVec2 renderSize = DX12RenderEngine::GetInstance().GetRenderSize();
 
-	const float windowRatio = (float)((float)wnd->GetBackSize().x / (float)wnd->GetBackSize().y);
+	const float windowRatio = (float)((float)renderSize.x / (float)renderSize.y);
 	XMMATRIX tmpProj = XMMatrixPerspectiveFovLH(45.f * DegToRad, windowRatio, 0.1f, 1000.f);
 	XMStoreFloat4x4(&m_Projection, tmpProj);
 }
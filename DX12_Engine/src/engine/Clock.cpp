@@ -1,6 +1,8 @@
 #include "engine/Clock.h"
 
-#include <windows.h>
+#ifndef _WIN32
+#include <time.h>
+#endif
 
 Clock::Clock()
 {
@@ -44,13 +46,25 @@ Time Clock::GetElapsedFromStart() const
 
 Time Clock::GetSystemTime()
 {
-	// Get Frequency of the system (static variable!)
+#ifdef _WIN32
+	// Get Frequency of the system (constant after the boot)
 	static LARGE_INTEGER frequency = {};
-	QueryPerformanceFrequency(&frequency);
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
 
 	// Now get the time of the system
 	LARGE_INTEGER time = {};
 	QueryPerformanceCounter(&time);
 
-	return Time(1'000'000 * time.QuadPart / frequency.QuadPart);
+	// seconds and remainder are converted separately (no overflow of the counter in nanoseconds)
+	const UINT64 seconds	= (UINT64)(time.QuadPart / frequency.QuadPart);
+	const UINT64 remainder	= (UINT64)(time.QuadPart % frequency.QuadPart);
+
+	return Time(seconds * 1'000'000'000 + remainder * 1'000'000'000 / (UINT64)frequency.QuadPart);
+#else
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return Time((UINT64)time.tv_sec * 1'000'000'000 + (UINT64)time.tv_nsec);
+#endif
 }
@@ -1,24 +1,41 @@
+// Clock
+// monotonic clock with a nanosecond resolution
+// backend : performance counter on Windows, clock_gettime (CLOCK_MONOTONIC) on the other platforms
+
 #pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <cstdint>
+typedef uint32_t	UINT;
+typedef uint64_t	UINT64;
+#endif
 
 struct Time
 {
 	Time() {}
 	Time(UINT64 i_Time)
-		:m_Microsecs(i_Time)
+		:m_Nanosecs(i_Time)
 	{}
 
+	// constructors
+	static Time FromSeconds(float i_Seconds)				{ return Time((UINT64)((double)i_Seconds * 1'000'000'000.0)); }
+	static Time FromMicroseconds(UINT64 i_Microseconds)		{ return Time(i_Microseconds * 1'000); }
+
 	// getters
-	float ToSeconds() const { return (m_Microsecs / 1'000'000.f); }
+	float		ToSeconds() const		{ return (float)((double)m_Nanosecs / 1'000'000'000.0); }
+	float		ToMilliseconds() const	{ return (float)((double)m_Nanosecs / 1'000'000.0); }
+	UINT64		ToMicroseconds() const	{ return m_Nanosecs / 1'000; }
 
 	// operators
-	Time		operator+(const Time & i_Other) { return Time(m_Microsecs + i_Other.m_Microsecs); }
-	Time		operator-(const Time & i_Other) { return Time(m_Microsecs - i_Other.m_Microsecs); }
-	Time &		operator=(const Time & i_Other) { m_Microsecs = i_Other.m_Microsecs; return *this; }
+	Time		operator+(const Time & i_Other) const { return Time(m_Nanosecs + i_Other.m_Nanosecs); }
+	Time		operator-(const Time & i_Other) const { return Time(m_Nanosecs - i_Other.m_Nanosecs); }
+	Time &		operator=(const Time & i_Other) { m_Nanosecs = i_Other.m_Nanosecs; return *this; }
+	bool		operator<(const Time & i_Other) const { return m_Nanosecs < i_Other.m_Nanosecs; }
 
-	// time in microsecs
-	UINT64		m_Microsecs;
+	// time in nanosecs
+	UINT64		m_Nanosecs;
 };
 
 class Clock
@@ -35,10 +52,10 @@ public:
 	Time	GetElapsedFromStart() const;
 
 	// Informations from the system
-	static Time	GetSystemTime();
+	static Time	GetSystemTime();	// monotonic (the origin is not specified)
 
 private:
 	// Time management
 	Time	m_StartTime;
 	Time	m_DefaultTime;	// time at the beginning
-};
\ No newline at end of file
+};
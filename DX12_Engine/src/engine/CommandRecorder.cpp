@@ -0,0 +1,133 @@
+#include "CommandRecorder.h"
+
+#include "engine/Debug.h"
+#include "engine/Utils.h"
+#include "engine/CPUProfiler.h"
+
+CommandRecorder::CommandRecorder(UINT i_WorkerCount)
+	:m_WorkerCount((i_WorkerCount > 0) ? i_WorkerCount : 1)
+	,m_Ranges(nullptr)
+	,m_Recorder(nullptr)
+	,m_Job(0)
+	,m_Pending(0)
+	,m_Exit(false)
+{
+	for (UINT i = 1; i < m_WorkerCount; ++i)
+	{
+		m_Threads.push_back(std::thread(&CommandRecorder::WorkerLoop, this, i));
+	}
+}
+
+CommandRecorder::~CommandRecorder()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Exit = true;
+	}
+
+	m_StartCondition.notify_all();
+
+	for (size_t i = 0; i < m_Threads.size(); ++i)
+	{
+		m_Threads[i].join();
+	}
+}
+
+void CommandRecorder::Partition(UINT i_DrawCount, UINT i_WorkerCount, UINT i_MinDrawPerWorker, std::vector<DrawRange> & o_Ranges)
+{
+	ASSERT(i_WorkerCount > 0);
+	o_Ranges.resize(i_WorkerCount);
+
+	// do not wake up workers for a few draws
+	const UINT minDraw		= (i_MinDrawPerWorker > 0) ? i_MinDrawPerWorker : 1;
+	const UINT usedWorker	= Math::Max(Math::Min((i_DrawCount + minDraw - 1) / minDraw, i_WorkerCount), 1u);
+
+	// balanced ranges : the first ranges get one more draw
+	const UINT drawPerWorker	= i_DrawCount / usedWorker;
+	const UINT remainder		= i_DrawCount % usedWorker;
+	UINT first = 0;
+
+	for (UINT i = 0; i < i_WorkerCount; ++i)
+	{
+		const UINT count = (i < usedWorker) ? drawPerWorker + ((i < remainder) ? 1 : 0) : 0;
+
+		o_Ranges[i].First	= first;
+		o_Ranges[i].Count	= count;
+		first += count;
+	}
+}
+
+void CommandRecorder::Record(const std::vector<DrawRange> & i_Ranges, Recorder * i_Recorder)
+{
+	ASSERT(i_Ranges.size() == m_WorkerCount);
+
+	// wake up the workers
+	if (m_WorkerCount > 1)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Ranges	= &i_Ranges;
+			m_Recorder	= i_Recorder;
+			m_Pending	= m_WorkerCount - 1;
+			++m_Job;
+		}
+
+		m_StartCondition.notify_all();
+	}
+
+	// the calling thread record the first range
+	if (i_Ranges[0].Count > 0)
+	{
+		i_Recorder->RecordRange(0, i_Ranges[0]);
+	}
+
+	// wait for the workers
+	if (m_WorkerCount > 1)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneCondition.wait(lock, [this]() { return m_Pending == 0; });
+
+		m_Ranges	= nullptr;
+		m_Recorder	= nullptr;
+	}
+}
+
+UINT CommandRecorder::GetWorkerCount() const
+{
+	return m_WorkerCount;
+}
+
+void CommandRecorder::WorkerLoop(UINT i_Worker)
+{
+	UINT64 job = 0;
+
+	const std::string threadName = "Record Worker " + std::to_string(i_Worker);
+	CPUProfiler::SetThreadName(threadName.c_str());
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_StartCondition.wait(lock, [this, job]() { return m_Exit || m_Job != job; });
+
+		if (m_Exit)
+			return;
+
+		job = m_Job;
+		const DrawRange range	= (*m_Ranges)[i_Worker];
+		Recorder * recorder		= m_Recorder;
+		lock.unlock();
+
+		// each worker only use its own command list
+		if (range.Count > 0)
+		{
+			recorder->RecordRange(i_Worker, range);
+		}
+
+		lock.lock();
+
+		if (--m_Pending == 0)
+		{
+			m_DoneCondition.notify_one();
+		}
+	}
+}
@@ -0,0 +1,59 @@
+// parallel command list recording
+// the sorted draw queue is split in contiguous ranges, one range for each worker
+// each worker record its range on its own command list : submitting the lists in worker order
+// keep the draw order of a serial recording
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class CommandRecorder
+{
+public:
+	// range of the draw queue recorded by a worker
+	struct DrawRange
+	{
+		UINT		First;
+		UINT		Count;
+	};
+
+	// record a range of draws (the render list record on DX12 command lists, the validation use a mock)
+	class Recorder
+	{
+	public:
+		virtual ~Recorder() {};
+		virtual void	RecordRange(UINT i_Worker, const DrawRange & i_Range) = 0;
+	};
+
+	CommandRecorder(UINT i_WorkerCount);	// the calling thread is the worker 0
+	~CommandRecorder();
+
+	// split the draws in one range per worker (empty ranges if there is not enough draws for all workers)
+	static void		Partition(UINT i_DrawCount, UINT i_WorkerCount, UINT i_MinDrawPerWorker, std::vector<DrawRange> & o_Ranges);
+
+	// record the ranges on the workers, return when all ranges are recorded
+	void			Record(const std::vector<DrawRange> & i_Ranges, Recorder * i_Recorder);
+
+	// information
+	UINT			GetWorkerCount() const;
+
+private:
+	void			WorkerLoop(UINT i_Worker);
+
+	const UINT						m_WorkerCount;
+	std::vector<std::thread>		m_Threads;		// workers 1 to count - 1
+
+	// current job
+	std::mutex						m_Mutex;
+	std::condition_variable			m_StartCondition;
+	std::condition_variable			m_DoneCondition;
+	const std::vector<DrawRange> *	m_Ranges;
+	Recorder *						m_Recorder;
+	UINT64							m_Job;			// incremented for each job
+	UINT							m_Pending;		// workers still recording
+	bool							m_Exit;
+};
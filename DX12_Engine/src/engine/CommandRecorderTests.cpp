@@ -0,0 +1,102 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include "engine/Utils.h"
+#include "engine/CommandRecorder.h"
+
+CFRecordCheck::CFRecordCheck()
+	:Console::Function("record_check", "[worker count]", "validate the partition and the order of the parallel command list recording")
+{
+}
+
+bool CFRecordCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT workerCount = 4;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		workerCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	// mock recorder : each worker write the draws in its own list (as a command list)
+	class MockRecorder : public CommandRecorder::Recorder
+	{
+	public:
+		MockRecorder(UINT i_WorkerCount)
+			:m_Lists(i_WorkerCount)
+		{
+		}
+
+		virtual void RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range) override
+		{
+			for (UINT i = 0; i < i_Range.Count; ++i)
+			{
+				m_Lists[i_Worker].push_back(i_Range.First + i);
+			}
+		}
+
+		std::vector<std::vector<UINT>>	m_Lists;
+	};
+
+	CommandRecorder recorder(workerCount);
+	std::vector<CommandRecorder::DrawRange> ranges;
+	UINT errors = 0;
+	UINT jobs = 0;
+
+	static const UINT minDraws[] = { 1, 4, MIN_RECORD_DRAW };
+
+	for (UINT m = 0; m < _countof(minDraws); ++m)
+	{
+		for (UINT drawCount = 0; drawCount < 600; drawCount += (drawCount < 64) ? 1 : 37)
+		{
+			CommandRecorder::Partition(drawCount, workerCount, minDraws[m], ranges);
+
+			// ranges are contiguous, balanced and use the minimum of workers
+			const UINT expectedWorker = Math::Max(Math::Min((drawCount + minDraws[m] - 1) / minDraws[m], workerCount), 1u);
+			UINT first = 0, minCount = drawCount, maxCount = 0;
+
+			for (UINT i = 0; i < workerCount; ++i)
+			{
+				if (ranges[i].First != first || (i >= expectedWorker && ranges[i].Count != 0))
+					++errors;
+
+				if (i < expectedWorker)
+				{
+					minCount = Math::Min(minCount, ranges[i].Count);
+					maxCount = Math::Max(maxCount, ranges[i].Count);
+				}
+
+				first += ranges[i].Count;
+			}
+
+			if (first != drawCount || maxCount - minCount > 1)
+				++errors;
+
+			// submitting the lists in worker order give the serial draw order
+			MockRecorder mock(workerCount);
+			recorder.Record(ranges, &mock);
+			++jobs;
+
+			UINT draw = 0;
+			for (UINT i = 0; i < workerCount; ++i)
+			{
+				for (size_t j = 0; j < mock.m_Lists[i].size(); ++j)
+				{
+					if (mock.m_Lists[i][j] != draw++)
+						++errors;
+				}
+			}
+
+			if (draw != drawCount)
+				++errors;
+		}
+	}
+
+	GetConsole()->Print("record check : %u workers, %u jobs, %u errors", workerCount, jobs, errors);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -8,6 +8,12 @@
 #include "engine/Debug.h"
 #include "engine/Engine.h"
 #include "engine/World.h"
+#include "engine/Clock.h"
+#include "engine/FrameGraph.h"
+#include "engine/CPUProfiler.h"
+#include "engine/SceneFile.h"
+#include "engine/LevelStreamer.h"
+#include "dx12/DX12RenderEngine.h"
 #include "ui/UILayer.h"
 #include "ui/UIConsole.h"
 
@@ -385,3 +391,197 @@ bool CFPrintParam::Execute(const Console::CommandLine & i_CommandLine)
 
 	return false;
 }
+
+CFFrameGraphDump::CFFrameGraphDump()
+	:Console::Function("framegraph_dump", "[filename]", "write the frame graph of the last frame in a graphviz file")
+{
+}
+
+bool CFFrameGraphDump::Execute(const Console::CommandLine & i_CommandLine)
+{
+	const std::string filename = (i_CommandLine.m_Parameters.size() > 0) ? i_CommandLine.ToString(i_CommandLine.m_Parameters[0]) : "framegraph.dot";
+	const FrameGraph * graph = Engine::GetInstance().GetFrameGraph();
+
+	if (graph == nullptr || !graph->IsCompiled())
+	{
+		GetConsole()->Print("the frame graph is not compiled");
+		return false;
+	}
+
+	std::string dot;
+	graph->DumpGraphviz(dot);
+
+	FILE * file = nullptr;
+	if (fopen_s(&file, filename.c_str(), "w") != 0 || file == nullptr)
+	{
+		GetConsole()->Print("unable to open %s", filename.c_str());
+		return false;
+	}
+
+	fwrite(dot.c_str(), 1, dot.size(), file);
+	fclose(file);
+
+	GetConsole()->Print("frame graph written in %s (%u passes, %u resources)", filename.c_str(), graph->GetPassCount(), graph->GetResourceCount());
+	return true;
+}
+
+CFCPUCapture::CFCPUCapture()
+	:Console::Function("cpu_capture", "[frame count] [filename]", "capture the CPU zones of the next frames in a chrome trace file (chrome://tracing)")
+{
+}
+
+bool CFCPUCapture::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT frameCount = 60;
+	std::string filename = "cpu_trace.json";
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		frameCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	if (i_CommandLine.m_Parameters.size() > 1)
+		filename = i_CommandLine.ToString(i_CommandLine.m_Parameters[1]);
+
+	if (!CPUProfiler::StartCapture(frameCount, filename))
+	{
+		GetConsole()->Print("cpu capture : a capture is already running");
+		return false;
+	}
+
+	GetConsole()->Print("cpu capture : %u frames in %s", frameCount, filename.c_str());
+	return true;
+}
+
+CFSceneSave::CFSceneSave()
+	:Console::Function("scene_save", "[filename]", "save the actors of the world in a scene file")
+{
+}
+
+bool CFSceneSave::Execute(const Console::CommandLine & i_CommandLine)
+{
+	std::string filename = "scene.dxscene";
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+		filename = i_CommandLine.ToString(i_CommandLine.m_Parameters[0]);
+
+	World * world = Engine::GetInstance().GetWorld();
+
+	if (world == nullptr || !world->SaveWorld(filename))
+	{
+		GetConsole()->Print("scene save : unable to write %s", filename.c_str());
+		return false;
+	}
+
+	GetConsole()->Print("scene save : %u actors in %s", world->GetActorCount(), filename.c_str());
+	return true;
+}
+
+CFSceneLoad::CFSceneLoad()
+	:Console::Function("scene_load", "[filename]", "replace the actors of the world by the actors of a scene file")
+{
+}
+
+bool CFSceneLoad::Execute(const Console::CommandLine & i_CommandLine)
+{
+	std::string filename = "scene.dxscene";
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+		filename = i_CommandLine.ToString(i_CommandLine.m_Parameters[0]);
+
+	World * world = Engine::GetInstance().GetWorld();
+	Clock clock;
+
+	if (world == nullptr || !world->LoadWorld(filename))
+	{
+		GetConsole()->Print("scene load : unable to read %s", filename.c_str());
+		return false;
+	}
+
+	GetConsole()->Print("scene load : %u actors from %s in %.2f ms", world->GetActorCount(), filename.c_str(), clock.GetElaspedTime().ToMilliseconds());
+	return true;
+}
+
+CFSceneJson::CFSceneJson()
+	:Console::Function("scene_json", "[scene filename] [json filename]", "export a scene file in a readable json file")
+{
+}
+
+bool CFSceneJson::Execute(const Console::CommandLine & i_CommandLine)
+{
+	std::string filename = "scene.dxscene";
+	std::string jsonFilename = "scene.json";
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+		filename = i_CommandLine.ToString(i_CommandLine.m_Parameters[0]);
+	if (i_CommandLine.m_Parameters.size() > 1)
+		jsonFilename = i_CommandLine.ToString(i_CommandLine.m_Parameters[1]);
+
+	SceneFile scene;
+
+	if (!scene.Read(filename) || !scene.ExportJson(jsonFilename))
+	{
+		GetConsole()->Print("scene json : unable to export %s", filename.c_str());
+		return false;
+	}
+
+	GetConsole()->Print("scene json : %s exported in %s", filename.c_str(), jsonFilename.c_str());
+	return true;
+}
+
+CFStreamCell::CFStreamCell()
+	:Console::Function("stream_cell", "[filename] [x] [y] [z] [radius]", "add a streaming cell loaded around the camera (unloaded at 1.2 x radius)")
+{
+}
+
+bool CFStreamCell::Execute(const Console::CommandLine & i_CommandLine)
+{
+	if (i_CommandLine.m_Parameters.size() < 4)
+		return false;
+
+	LevelStreamer::CellDesc desc;
+	desc.File = i_CommandLine.ToString(i_CommandLine.m_Parameters[0]);
+
+	for (UINT i = 1; i < 4; ++i)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[i]))
+			return false;
+	}
+
+	desc.Center = XMFLOAT3(i_CommandLine.ToFloat(i_CommandLine.m_Parameters[1]), i_CommandLine.ToFloat(i_CommandLine.m_Parameters[2]), i_CommandLine.ToFloat(i_CommandLine.m_Parameters[3]));
+
+	if (i_CommandLine.m_Parameters.size() > 4)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[4]))
+			return false;
+		desc.LoadRadius = Math::Max(i_CommandLine.ToFloat(i_CommandLine.m_Parameters[4]), 1.f);
+	}
+
+	desc.UnloadRadius = desc.LoadRadius * 1.2f;
+
+	const UINT cell = Engine::GetInstance().GetLevelStreamer()->AddCell(desc);
+	GetConsole()->Print("stream cell : %s is the cell %u (radius %.1f)", desc.File.c_str(), cell, desc.LoadRadius);
+	return true;
+}
+
+CFSetOIT::CFSetOIT()
+	:Console::Function("set_oit", "[0/1]", "draw the semi transparent meshes with the order independent transparency or sorted back to front")
+{
+}
+
+bool CFSetOIT::Execute(const Console::CommandLine & i_CommandLine)
+{
+	if (i_CommandLine.m_Parameters.size() != 1)
+		return false;
+
+	if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+		return false;
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	render.SetOITEnabled(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]) != 0);
+
+	GetConsole()->Print("order independent transparency : %s", render.OITIsEnabled() ? "enabled" : "disabled");
+	return true;
+}
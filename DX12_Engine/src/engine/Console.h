@@ -8,6 +8,7 @@
 #include <vector>
 #include <map>
 
+#include "engine/Defines.h"
 
 #define CONSOLE_OUTPUT_BUFFER_SIZE	2048
 
@@ -58,7 +59,6 @@ public:
 		~CommandLine();
 	};
 
-
 	// base class for registering command line
 	class Function
 	{
@@ -111,7 +111,6 @@ private:
 	std::vector<std::pair<OutputFunc, void*>>		m_PrintCallback;
 };
 
-
 // create default command here
 // start by CF for CommandFunction class
 class CFHelp : public Console::Function
@@ -159,4 +158,279 @@ public:
 private:
 	// virtual pure to override
 	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
-};
\ No newline at end of file
+};
+
+class CFFrameGraphDump : public Console::Function
+{
+public:
+	CFFrameGraphDump();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFCPUCapture : public Console::Function
+{
+public:
+	CFCPUCapture();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFSceneSave : public Console::Function
+{
+public:
+	CFSceneSave();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFSceneLoad : public Console::Function
+{
+public:
+	CFSceneLoad();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFSceneJson : public Console::Function
+{
+public:
+	CFSceneJson();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFStreamCell : public Console::Function
+{
+public:
+	CFStreamCell();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFSetOIT : public Console::Function
+{
+public:
+	CFSetOIT();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+#ifdef WITH_CONSOLE_TESTS
+// check and bench commands, defined in the tests file of their module
+
+class CFLightCluster : public Console::Function
+{
+public:
+	CFLightCluster();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFShadowCheck : public Console::Function
+{
+public:
+	CFShadowCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFDepthCheck : public Console::Function
+{
+public:
+	CFDepthCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFGBufferCheck : public Console::Function
+{
+public:
+	CFGBufferCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFRecordCheck : public Console::Function
+{
+public:
+	CFRecordCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFFrameGraphCheck : public Console::Function
+{
+public:
+	CFFrameGraphCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFBackendCheck : public Console::Function
+{
+public:
+	CFBackendCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFGPUProfilerCheck : public Console::Function
+{
+public:
+	CFGPUProfilerCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFCPUZoneBenchmark : public Console::Function
+{
+public:
+	CFCPUZoneBenchmark();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFPacingCheck : public Console::Function
+{
+public:
+	CFPacingCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFFixedStepCheck : public Console::Function
+{
+public:
+	CFFixedStepCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFSceneCheck : public Console::Function
+{
+public:
+	CFSceneCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFStreamCheck : public Console::Function
+{
+public:
+	CFStreamCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFDebugDrawCheck : public Console::Function
+{
+public:
+	CFDebugDrawCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFMaterialGraphCheck : public Console::Function
+{
+public:
+	CFMaterialGraphCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFMaterialInstanceCheck : public Console::Function
+{
+public:
+	CFMaterialInstanceCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFDescriptorAllocatorCheck : public Console::Function
+{
+public:
+	CFDescriptorAllocatorCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFGPUCullingCheck : public Console::Function
+{
+public:
+	CFGPUCullingCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFMeshArenaCheck : public Console::Function
+{
+public:
+	CFMeshArenaCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFRenderSubmitBench : public Console::Function
+{
+public:
+	CFRenderSubmitBench();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFAnimationBench : public Console::Function
+{
+public:
+	CFAnimationBench();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFParticleBench : public Console::Function
+{
+public:
+	CFParticleBench();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+class CFTransparencyCheck : public Console::Function
+{
+public:
+	CFTransparencyCheck();
+private:
+	// virtual pure to override
+	virtual bool Execute(const Console::CommandLine & i_CommandLine) override;
+};
+
+#endif /* WITH_CONSOLE_TESTS */
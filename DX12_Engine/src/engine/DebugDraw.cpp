@@ -0,0 +1,301 @@
+#include "DebugDraw.h"
+
+#include "engine/Debug.h"
+#include "engine/CPUProfiler.h"
+
+#include <algorithm>
+
+// primitives
+DebugDraw::PrimitiveBuffer<DebugDraw::LineInstance>		DebugDraw::s_Lines;
+DebugDraw::PrimitiveBuffer<DebugDraw::BoxInstance>		DebugDraw::s_Boxes;
+DebugDraw::PrimitiveBuffer<DebugDraw::SphereInstance>	DebugDraw::s_Spheres;
+
+// management
+UINT										DebugDraw::s_Capacity = 0;
+std::atomic<bool>							DebugDraw::s_Enabled(true);
+std::atomic<UINT64>							DebugDraw::s_DroppedCount(0);
+DebugDraw::Stats							DebugDraw::s_Stats;
+
+template <typename _Instance>
+void DebugDraw::InitializeBuffer(PrimitiveBuffer<_Instance> & o_Buffer, UINT i_Capacity)
+{
+	o_Buffer.Appends.resize(i_Capacity);
+	o_Buffer.AppendCount = 0;
+	o_Buffer.Persistents.clear();
+	o_Buffer.Persistents.reserve(i_Capacity);
+	o_Buffer.Instances.clear();
+	o_Buffer.Instances.reserve(i_Capacity);
+	o_Buffer.DepthTestedCount = 0;
+}
+
+template <typename _Instance>
+void DebugDraw::ReleaseBuffer(PrimitiveBuffer<_Instance> & o_Buffer)
+{
+	std::vector<Entry<_Instance>>().swap(o_Buffer.Appends);
+	std::vector<Entry<_Instance>>().swap(o_Buffer.Persistents);
+	std::vector<_Instance>().swap(o_Buffer.Instances);
+	o_Buffer.AppendCount = 0;
+	o_Buffer.DepthTestedCount = 0;
+}
+
+void DebugDraw::Initialize(UINT i_Capacity)
+{
+	s_Capacity = i_Capacity;
+	s_DroppedCount = 0;
+	s_Stats = Stats();
+
+	InitializeBuffer(s_Lines, i_Capacity);
+	InitializeBuffer(s_Boxes, i_Capacity);
+	InitializeBuffer(s_Spheres, i_Capacity);
+}
+
+void DebugDraw::Shutdown()
+{
+	ReleaseBuffer(s_Lines);
+	ReleaseBuffer(s_Boxes);
+	ReleaseBuffer(s_Spheres);
+
+	s_Capacity = 0;
+}
+
+void DebugDraw::SetEnabled(bool i_Enabled)
+{
+	s_Enabled = i_Enabled;
+}
+
+bool DebugDraw::IsEnabled()
+{
+	return s_Enabled;
+}
+
+void DebugDraw::Clear()
+{
+	s_Lines.Persistents.clear();
+	s_Boxes.Persistents.clear();
+	s_Spheres.Persistents.clear();
+}
+
+void DebugDraw::AddLine(const XMFLOAT3 & i_Start, const XMFLOAT3 & i_End, const Color & i_Color, float i_Lifetime, bool i_DepthTest)
+{
+	LineInstance line;
+	line.Start	= i_Start;
+	line.End	= i_End;
+	line.Color	= PackColor(i_Color);
+	line.Pad	= 0;
+
+	Add(s_Lines, line, i_Lifetime, i_DepthTest);
+}
+
+void DebugDraw::AddPath(const XMFLOAT3 * i_Points, UINT i_PointCount, const Color & i_Color, float i_Lifetime, bool i_DepthTest)
+{
+	for (UINT i = 1; i < i_PointCount; ++i)
+	{
+		AddLine(i_Points[i - 1], i_Points[i], i_Color, i_Lifetime, i_DepthTest);
+	}
+}
+
+void DebugDraw::AddBox(const XMFLOAT3 & i_Center, const XMFLOAT3 & i_Extents, const Color & i_Color, float i_Lifetime, bool i_DepthTest)
+{
+	BoxInstance box = {};
+	box.Rows[0]	= XMFLOAT4(i_Extents.x, 0.f, 0.f, i_Center.x);
+	box.Rows[1]	= XMFLOAT4(0.f, i_Extents.y, 0.f, i_Center.y);
+	box.Rows[2]	= XMFLOAT4(0.f, 0.f, i_Extents.z, i_Center.z);
+	box.Color	= PackColor(i_Color);
+
+	Add(s_Boxes, box, i_Lifetime, i_DepthTest);
+}
+
+void DebugDraw::AddBox(FXMMATRIX i_Transform, const Color & i_Color, float i_Lifetime, bool i_DepthTest)
+{
+	// row vectors : the shader transforms the corners with the rows of the transposed matrix
+	const XMMATRIX transposed = XMMatrixTranspose(i_Transform);
+
+	BoxInstance box = {};
+	XMStoreFloat4(&box.Rows[0], transposed.r[0]);
+	XMStoreFloat4(&box.Rows[1], transposed.r[1]);
+	XMStoreFloat4(&box.Rows[2], transposed.r[2]);
+	box.Color	= PackColor(i_Color);
+
+	Add(s_Boxes, box, i_Lifetime, i_DepthTest);
+}
+
+void DebugDraw::AddSphere(const XMFLOAT3 & i_Center, float i_Radius, const Color & i_Color, float i_Lifetime, bool i_DepthTest)
+{
+	SphereInstance sphere = {};
+	sphere.Center	= i_Center;
+	sphere.Radius	= i_Radius;
+	sphere.Color	= PackColor(i_Color);
+
+	Add(s_Spheres, sphere, i_Lifetime, i_DepthTest);
+}
+
+void DebugDraw::Collect(float i_ElapsedTime)
+{
+	CPU_ZONE("Debug Draw Collect");
+
+	Collect(s_Lines, i_ElapsedTime);
+	Collect(s_Boxes, i_ElapsedTime);
+	Collect(s_Spheres, i_ElapsedTime);
+
+	s_Stats.InstanceCount[eLine]	= (UINT)s_Lines.Instances.size();
+	s_Stats.InstanceCount[eBox]		= (UINT)s_Boxes.Instances.size();
+	s_Stats.InstanceCount[eSphere]	= (UINT)s_Spheres.Instances.size();
+	s_Stats.PersistentCount			= (UINT)(s_Lines.Persistents.size() + s_Boxes.Persistents.size() + s_Spheres.Persistents.size());
+	s_Stats.DroppedCount			= s_DroppedCount;
+}
+
+UINT DebugDraw::GetCapacity()
+{
+	return s_Capacity;
+}
+
+UINT DebugDraw::GetInstanceCount(EPrimitive i_Primitive)
+{
+	switch (i_Primitive)
+	{
+	case eLine:		return (UINT)s_Lines.Instances.size();
+	case eBox:		return (UINT)s_Boxes.Instances.size();
+	case eSphere:	return (UINT)s_Spheres.Instances.size();
+	default:		return 0;
+	}
+}
+
+UINT DebugDraw::GetDepthTestedCount(EPrimitive i_Primitive)
+{
+	switch (i_Primitive)
+	{
+	case eLine:		return s_Lines.DepthTestedCount;
+	case eBox:		return s_Boxes.DepthTestedCount;
+	case eSphere:	return s_Spheres.DepthTestedCount;
+	default:		return 0;
+	}
+}
+
+const void * DebugDraw::GetInstances(EPrimitive i_Primitive)
+{
+	switch (i_Primitive)
+	{
+	case eLine:		return s_Lines.Instances.data();
+	case eBox:		return s_Boxes.Instances.data();
+	case eSphere:	return s_Spheres.Instances.data();
+	default:		return nullptr;
+	}
+}
+
+UINT DebugDraw::GetInstanceSize(EPrimitive i_Primitive)
+{
+	static const UINT s_InstanceSize[ePrimitiveCount] = { sizeof(LineInstance), sizeof(BoxInstance), sizeof(SphereInstance) };
+	ASSERT(i_Primitive < ePrimitiveCount);
+	return s_InstanceSize[i_Primitive];
+}
+
+UINT DebugDraw::GetVertexCount(EPrimitive i_Primitive)
+{
+	// a segment, the 12 edges of a box, three circles for a sphere
+	static const UINT s_VertexCount[ePrimitiveCount] = { 2, 24, 3 * DEBUG_DRAW_SPHERE_SEGMENTS * 2 };
+	ASSERT(i_Primitive < ePrimitiveCount);
+	return s_VertexCount[i_Primitive];
+}
+
+const DebugDraw::Stats & DebugDraw::GetStats()
+{
+	return s_Stats;
+}
+
+UINT DebugDraw::PackColor(const Color & i_Color, float i_Alpha)
+{
+	const UINT r = (UINT)(Math::Min(Math::Max(i_Color.r, 0.f), 1.f) * 255.f + 0.5f);
+	const UINT g = (UINT)(Math::Min(Math::Max(i_Color.g, 0.f), 1.f) * 255.f + 0.5f);
+	const UINT b = (UINT)(Math::Min(Math::Max(i_Color.b, 0.f), 1.f) * 255.f + 0.5f);
+	const UINT a = (UINT)(Math::Min(Math::Max(i_Alpha, 0.f), 1.f) * 255.f + 0.5f);
+
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+template <typename _Instance>
+void DebugDraw::Add(PrimitiveBuffer<_Instance> & io_Buffer, const _Instance & i_Instance, float i_Lifetime, bool i_DepthTest)
+{
+	if (!s_Enabled.load(std::memory_order_relaxed))
+		return;
+
+	// the slot is owned by the caller once taken : the collect reads it after the adds of the frame
+	const UINT index = io_Buffer.AppendCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (index >= s_Capacity)
+	{
+		s_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Entry<_Instance> & entry = io_Buffer.Appends[index];
+	entry.Instance	= i_Instance;
+	entry.Lifetime	= i_Lifetime;
+	entry.DepthTest	= i_DepthTest;
+}
+
+template <typename _Instance>
+void DebugDraw::Collect(PrimitiveBuffer<_Instance> & io_Buffer, float i_ElapsedTime)
+{
+	const UINT appendCount = Math::Min(io_Buffer.AppendCount.exchange(0, std::memory_order_acquire), s_Capacity);
+
+	// expire the primitives drawn the previous frames
+	std::vector<Entry<_Instance>> & persistents = io_Buffer.Persistents;
+
+	for (size_t i = 0; i < persistents.size(); ++i)
+	{
+		persistents[i].Lifetime -= i_ElapsedTime;
+	}
+
+	persistents.erase(std::remove_if(persistents.begin(), persistents.end(),
+		[](const Entry<_Instance> & i_Entry) { return i_Entry.Lifetime <= 0.f; }), persistents.end());
+
+	// pack the instances : depth tested first, the instance buffer is as large as an append buffer
+	std::vector<_Instance> & instances = io_Buffer.Instances;
+	instances.clear();
+
+	UINT dropped = 0;
+
+	for (UINT pass = 0; pass < 2; ++pass)
+	{
+		const bool depthTest = (pass == 0);
+
+		for (size_t i = 0; i < persistents.size(); ++i)
+		{
+			if (persistents[i].DepthTest != depthTest)
+				continue;
+
+			if (instances.size() < s_Capacity)
+				instances.push_back(persistents[i].Instance);
+			else
+				++dropped;
+		}
+
+		for (UINT i = 0; i < appendCount; ++i)
+		{
+			if (io_Buffer.Appends[i].DepthTest != depthTest)
+				continue;
+
+			if (instances.size() < s_Capacity)
+				instances.push_back(io_Buffer.Appends[i].Instance);
+			else
+				++dropped;
+		}
+
+		if (depthTest)
+			io_Buffer.DepthTestedCount = (UINT)instances.size();
+	}
+
+	// keep the new primitives with a lifetime
+	for (UINT i = 0; i < appendCount; ++i)
+	{
+		if (io_Buffer.Appends[i].Lifetime <= 0.f)
+			continue;
+
+		if (persistents.size() < s_Capacity)
+			persistents.push_back(io_Buffer.Appends[i]);
+		else
+			++dropped;
+	}
+
+	s_DroppedCount += dropped;
+}
@@ -0,0 +1,137 @@
+// Debug draw
+// lines, boxes and spheres drawn for one frame or for a lifetime (seconds), with or without depth test
+// primitives can be added from any thread : each type has a fixed append buffer per frame, slots are taken with an atomic index
+// the main thread collects the buffers once per frame (no add during the collect) : expired primitives are removed
+// and the instances to draw are packed per type, depth tested first (see RenderList::RenderDebugDraw : one instanced draw per type and depth mode)
+// primitives added when a buffer is full are dropped (see Stats)
+// this is a static class
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+#include <atomic>
+#include <vector>
+
+#include "engine/Utils.h"
+
+#define DEBUG_DRAW_SPHERE_SEGMENTS		32	// segments of the three circles of a sphere (same in DebugDrawVS.hlsl)
+
+using namespace DirectX;
+
+class DebugDraw
+{
+public:
+	enum EPrimitive
+	{
+		eLine,
+		eBox,
+		eSphere,
+
+		ePrimitiveCount,
+	};
+
+	// GPU instances (same layout in DebugDrawVS.hlsl), colors are RGBA8
+	struct LineInstance
+	{
+		XMFLOAT3		Start;
+		UINT			Color;
+		XMFLOAT3		End;
+		UINT			Pad;
+	};
+
+	struct BoxInstance
+	{
+		XMFLOAT4		Rows[3];	// transform of the [-1, 1] box (rows of the transposed matrix)
+		UINT			Color;
+		UINT			Pad[3];
+	};
+
+	struct SphereInstance
+	{
+		XMFLOAT3		Center;
+		float			Radius;
+		UINT			Color;
+		UINT			Pad[3];
+	};
+
+	// information of the last collect
+	struct Stats
+	{
+		UINT		InstanceCount[ePrimitiveCount]	= {};	// instances to draw
+		UINT		PersistentCount					= 0;	// primitives with a lifetime left
+		UINT64		DroppedCount					= 0;	// primitives dropped since the initialization
+	};
+
+	// management
+	static void		Initialize(UINT i_Capacity);	// primitives of each type per frame
+	static void		Shutdown();
+	static void		SetEnabled(bool i_Enabled);		// primitives added when disabled are ignored
+	static bool		IsEnabled();
+	static void		Clear();						// remove the primitives with a lifetime
+
+	// primitives (any thread)
+	static void		AddLine(const XMFLOAT3 & i_Start, const XMFLOAT3 & i_End, const Color & i_Color, float i_Lifetime = 0.f, bool i_DepthTest = true);
+	static void		AddPath(const XMFLOAT3 * i_Points, UINT i_PointCount, const Color & i_Color, float i_Lifetime = 0.f, bool i_DepthTest = true);
+	static void		AddBox(const XMFLOAT3 & i_Center, const XMFLOAT3 & i_Extents, const Color & i_Color, float i_Lifetime = 0.f, bool i_DepthTest = true);
+	static void		AddBox(FXMMATRIX i_Transform, const Color & i_Color, float i_Lifetime = 0.f, bool i_DepthTest = true);	// transform of the [-1, 1] box
+	static void		AddSphere(const XMFLOAT3 & i_Center, float i_Radius, const Color & i_Color, float i_Lifetime = 0.f, bool i_DepthTest = true);
+
+	// main thread : expire the primitives and pack the instances of the frame
+	static void		Collect(float i_ElapsedTime);
+
+	// instances of the last collect (depth tested instances first)
+	static UINT				GetCapacity();
+	static UINT				GetInstanceCount(EPrimitive i_Primitive);
+	static UINT				GetDepthTestedCount(EPrimitive i_Primitive);
+	static const void *		GetInstances(EPrimitive i_Primitive);
+	static UINT				GetInstanceSize(EPrimitive i_Primitive);
+	static UINT				GetVertexCount(EPrimitive i_Primitive);	// line list vertices of an instance
+	static const Stats &	GetStats();
+
+	// helpers
+	static UINT		PackColor(const Color & i_Color, float i_Alpha = 1.f);
+
+private:
+	// primitive waiting for the collect
+	template <typename _Instance>
+	struct Entry
+	{
+		_Instance		Instance;
+		float			Lifetime;	// seconds left
+		bool			DepthTest;
+	};
+
+	template <typename _Instance>
+	struct PrimitiveBuffer
+	{
+		// append buffer of the frame
+		std::vector<Entry<_Instance>>	Appends;
+		std::atomic<UINT>				AppendCount;
+
+		// primitives with a lifetime
+		std::vector<Entry<_Instance>>	Persistents;
+
+		// instances to draw
+		std::vector<_Instance>			Instances;
+		UINT							DepthTestedCount;
+	};
+
+	template <typename _Instance>
+	static void		InitializeBuffer(PrimitiveBuffer<_Instance> & o_Buffer, UINT i_Capacity);
+	template <typename _Instance>
+	static void		ReleaseBuffer(PrimitiveBuffer<_Instance> & o_Buffer);
+	template <typename _Instance>
+	static void		Add(PrimitiveBuffer<_Instance> & io_Buffer, const _Instance & i_Instance, float i_Lifetime, bool i_DepthTest);
+	template <typename _Instance>
+	static void		Collect(PrimitiveBuffer<_Instance> & io_Buffer, float i_ElapsedTime);
+
+	static PrimitiveBuffer<LineInstance>		s_Lines;
+	static PrimitiveBuffer<BoxInstance>			s_Boxes;
+	static PrimitiveBuffer<SphereInstance>		s_Spheres;
+
+	static UINT									s_Capacity;
+	static std::atomic<bool>					s_Enabled;
+	static std::atomic<UINT64>					s_DroppedCount;
+	static Stats								s_Stats;
+};
@@ -0,0 +1,145 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <thread>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/DebugDraw.h"
+
+CFDebugDrawCheck::CFDebugDrawCheck()
+	:Console::Function("debug_draw_check", "[thread count] [primitives per thread]", "append debug primitives from several threads and check the collect, the lifetimes and the overflow")
+{
+}
+
+bool CFDebugDrawCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT threadCount = 8;
+	UINT primitiveCount = 4000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		threadCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	if (i_CommandLine.m_Parameters.size() > 1)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[1]))
+			return false;
+		primitiveCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[1]), 1);
+	}
+
+	// the primitives of the frame are discarded by the check
+	const UINT capacity = DebugDraw::GetCapacity();
+	const bool enabled = DebugDraw::IsEnabled();
+	const UINT total = threadCount * primitiveCount;
+	const UINT expected = Math::Min(total, capacity);
+	static const float lifetime = 0.5f;
+	UINT errors = 0;
+
+	DebugDraw::Initialize(capacity);
+	DebugDraw::SetEnabled(true);
+
+	// append : each line is identified by its start, every other line is depth tested, one box out of four has a lifetime
+	Clock appendClock;
+	std::vector<std::thread> threads;
+
+	for (UINT thread = 0; thread < threadCount; ++thread)
+	{
+		threads.push_back(std::thread([thread, primitiveCount]()
+		{
+			for (UINT i = 0; i < primitiveCount; ++i)
+			{
+				const UINT id = thread * primitiveCount + i;
+				const XMFLOAT3 position((float)id, 0.f, 0.f);
+
+				DebugDraw::AddLine(position, XMFLOAT3((float)id, 1.f, 0.f), color::Red, 0.f, (id & 1) == 0);
+				DebugDraw::AddBox(position, XMFLOAT3(0.5f, 0.5f, 0.5f), color::Green, (i % 4 == 0) ? lifetime : 0.f);
+				DebugDraw::AddSphere(position, 1.f, color::Blue, 0.f, false);
+			}
+		}));
+	}
+
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+	}
+
+	const float appendTime = appendClock.GetElaspedTime().ToMilliseconds();
+
+	Clock collectClock;
+	DebugDraw::Collect(0.f);
+	const float collectTime = collectClock.GetElaspedTime().ToMilliseconds();
+
+	// every primitive is collected once (the ones over the capacity are dropped)
+	const DebugDraw::Stats stats = DebugDraw::GetStats();
+	const UINT boxLifetimeCount = Math::Min(threadCount * ((primitiveCount + 3) / 4), expected);
+
+	for (UINT i = 0; i < DebugDraw::ePrimitiveCount; ++i)
+	{
+		if (stats.InstanceCount[i] != expected)
+			++errors;
+	}
+
+	if (stats.DroppedCount != (UINT64)(total - expected) * DebugDraw::ePrimitiveCount
+		|| DebugDraw::GetDepthTestedCount(DebugDraw::eSphere) != 0
+		|| DebugDraw::GetDepthTestedCount(DebugDraw::eBox) != expected)
+		++errors;
+
+	// without overflow : each line is found once, depth tested lines first
+	if (total <= capacity)
+	{
+		const DebugDraw::LineInstance * lines = reinterpret_cast<const DebugDraw::LineInstance *>(DebugDraw::GetInstances(DebugDraw::eLine));
+		const UINT depthTestedCount = DebugDraw::GetDepthTestedCount(DebugDraw::eLine);
+		std::vector<BYTE> found(total, 0);
+
+		for (UINT i = 0; i < stats.InstanceCount[DebugDraw::eLine]; ++i)
+		{
+			const UINT id = (UINT)lines[i].Start.x;
+
+			if (id >= total || found[id]++ != 0 || ((id & 1) == 0) != (i < depthTestedCount))
+				++errors;
+		}
+
+		if (depthTestedCount != (total + 1) / 2 || stats.PersistentCount != boxLifetimeCount)
+			++errors;
+	}
+
+	// lifetimes : the boxes are drawn until their lifetime is spent
+	DebugDraw::Collect(lifetime * 0.5f);
+
+	if (DebugDraw::GetInstanceCount(DebugDraw::eBox) != DebugDraw::GetStats().PersistentCount || DebugDraw::GetInstanceCount(DebugDraw::eLine) != 0)
+		++errors;
+
+	DebugDraw::Collect(lifetime);
+
+	if (DebugDraw::GetInstanceCount(DebugDraw::eBox) != 0 || DebugDraw::GetStats().PersistentCount != 0)
+		++errors;
+
+	// overflow : the primitives over the capacity are dropped
+	DebugDraw::Initialize(64);
+
+	for (UINT i = 0; i < 100; ++i)
+	{
+		DebugDraw::AddLine(XMFLOAT3(0.f, 0.f, 0.f), XMFLOAT3(1.f, 1.f, 1.f), color::White);
+	}
+
+	DebugDraw::Collect(0.f);
+
+	if (DebugDraw::GetInstanceCount(DebugDraw::eLine) != 64 || DebugDraw::GetStats().DroppedCount != 36)
+		++errors;
+
+	DebugDraw::Initialize(capacity);
+	DebugDraw::SetEnabled(enabled);
+
+	GetConsole()->Print("debug draw check : %u primitives from %u threads, append %.2f ms (%.1f ns per primitive), collect %.2f ms",
+		total * DebugDraw::ePrimitiveCount, threadCount, appendTime, appendTime * 1'000'000.f / (float)(total * DebugDraw::ePrimitiveCount), collectTime);
+	GetConsole()->Print("debug draw check : %u instances per type (capacity %u), %llu dropped, %u errors", expected, capacity, stats.DroppedCount, errors);
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -8,3 +8,7 @@
 #else
 #define ENGINE_DEBUG	0
 #endif
+
+#ifdef _DEBUG
+#define WITH_CONSOLE_TESTS	1	// check and bench commands are binded in the console
+#endif
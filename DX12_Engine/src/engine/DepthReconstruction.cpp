@@ -0,0 +1,34 @@
+#include "DepthReconstruction.h"
+
+#include "engine/Debug.h"
+
+XMFLOAT2 DepthReconstruction::ProjectViewPosition(const XMMATRIX & i_Projection, FXMVECTOR i_ViewPosition, float & o_Depth)
+{
+	// view to normalized device coordinates
+	XMFLOAT3 ndc;
+	XMStoreFloat3(&ndc, XMVector3TransformCoord(XMVectorSetW(i_ViewPosition, 1.f), i_Projection));
+
+	o_Depth = ndc.z;
+
+	// normalized device coordinates to texture coordinates (y is flipped)
+	return XMFLOAT2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f);
+}
+
+XMVECTOR DepthReconstruction::ReconstructViewPosition(const XMMATRIX & i_InvProjection, const XMFLOAT2 & i_UV, float i_Depth)
+{
+	// same operations as the shader
+	const XMVECTOR ndc = XMVectorSet(i_UV.x * 2.f - 1.f, 1.f - i_UV.y * 2.f, i_Depth, 1.f);
+	const XMVECTOR pos = XMVector4Transform(ndc, i_InvProjection);
+
+	return XMVectorSetW(XMVectorDivide(pos, XMVectorSplatW(pos)), 1.f);
+}
+
+float DepthReconstruction::GetDepthPrecision(float i_Near, float i_Far, float i_ViewDepth)
+{
+	ASSERT(i_Near > 0.f && i_Far > i_Near);
+
+	// depth = far / (far - near) * (1 - near / z) : its derivative is far * near / ((far - near) * z^2)
+	// the depth is stored in [0.5, 1] for most of the range so one float step is 2^-24
+	const float floatStep = 1.f / (float)(1 << 24);
+	return floatStep * (i_Far - i_Near) * i_ViewDepth * i_ViewDepth / (i_Far * i_Near);
+}
@@ -0,0 +1,23 @@
+// view position reconstruction from the depth buffer
+// the GBuffer doesn't store positions : the light pass reconstruct them from the depth and the inverse projection
+// this is the CPU version of the shader code (see DeferredLightPS.hlsl), used to validate the math
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+class DepthReconstruction
+{
+public:
+	// view space position to screen texture coordinates and depth (what the GBuffer pass writes)
+	static XMFLOAT2		ProjectViewPosition(const XMMATRIX & i_Projection, FXMVECTOR i_ViewPosition, float & o_Depth);
+
+	// screen texture coordinates and depth to view space position (what the light pass reads)
+	static XMVECTOR		ReconstructViewPosition(const XMMATRIX & i_InvProjection, const XMFLOAT2 & i_UV, float i_Depth);
+
+	// smallest view depth step that a 32 bits float depth can store at this view depth (perspective projection)
+	static float		GetDepthPrecision(float i_Near, float i_Far, float i_ViewDepth);
+};
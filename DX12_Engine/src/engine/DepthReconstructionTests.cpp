@@ -0,0 +1,70 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include "engine/Utils.h"
+#include "engine/DepthReconstruction.h"
+#include "engine/TestUtils.h"
+
+CFDepthCheck::CFDepthCheck()
+	:Console::Function("depth_check", "[sample count]", "validate the view position reconstruction from depth against the projected positions")
+{
+}
+
+bool CFDepthCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT sampleCount = 10000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		sampleCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	// default camera projection
+	const float fov = 45.f * DegToRad;
+	const float ratio = 16.f / 9.f;
+	const float zNear = 0.1f, zFar = 1000.f;
+
+	const XMMATRIX projection = XMMatrixPerspectiveFovLH(fov, ratio, zNear, zFar);
+	const XMMATRIX invProjection = XMMatrixInverse(nullptr, projection);
+	const XMMATRIX view = XMMatrixLookToLH(XMVectorSet(3.f, 2.f, -5.f, 1.f), XMVectorSet(0.6f, -0.2f, 0.8f, 0.f), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	const XMMATRIX invView = XMMatrixInverse(nullptr, view);
+
+	// random positions in the view frustum (deterministic, depth distributed logarithmically)
+	TestRandom random(0x1234567);
+
+	UINT errors = 0;
+	float maxError = 0.f;		// relative to the depth precision
+
+	for (UINT i = 0; i < sampleCount; ++i)
+	{
+		const float z = zNear * powf(zFar / zNear, random.Unit() * 0.999f);
+		const float halfHeight = z * tanf(fov * 0.5f);
+		const XMVECTOR viewPosition = XMVectorSet((random.Unit() * 2.f - 1.f) * halfHeight * ratio, (random.Unit() * 2.f - 1.f) * halfHeight, z, 1.f);
+
+		// GBuffer pass then light pass
+		float depth;
+		const XMFLOAT2 uv = DepthReconstruction::ProjectViewPosition(projection, viewPosition, depth);
+		const XMVECTOR reconstructed = DepthReconstruction::ReconstructViewPosition(invProjection, uv, depth);
+
+		// compare in world space (the light pass works in world space)
+		const XMVECTOR worldPosition = XMVector3TransformCoord(viewPosition, invView);
+		const XMVECTOR worldReconstructed = XMVector3TransformCoord(reconstructed, invView);
+
+		// error allowed : a few depth steps and float rounding of the transforms
+		const float error = XMVectorGetX(XMVector3Length(XMVectorSubtract(worldReconstructed, worldPosition)));
+		const float tolerance = 8.f * DepthReconstruction::GetDepthPrecision(zNear, zFar, z) + 1e-5f * z;
+
+		if (error > tolerance)
+			++errors;
+		if (error / tolerance > maxError)
+			maxError = error / tolerance;
+	}
+
+	GetConsole()->Print("depth check : %u samples, %u errors (max error %.2f of the tolerance)", sampleCount, errors, maxError);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -0,0 +1,130 @@
+#include "DescriptorAllocator.h"
+
+#include "engine/Debug.h"
+#include "engine/Utils.h"
+
+#include <algorithm>
+
+DescriptorAllocator::DescriptorAllocator(UINT i_Capacity)
+	:m_Capacity(i_Capacity)
+	,m_AllocatedCount(0)
+{
+	Reset();
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+}
+
+UINT DescriptorAllocator::Allocate(UINT i_Count)
+{
+	if (i_Count == 0)
+		return InvalidIndex;
+
+	for (size_t i = 0; i < m_FreeRanges.size(); ++i)
+	{
+		Range & range = m_FreeRanges[i];
+
+		if (range.Count < i_Count)
+			continue;
+
+		// the range is taken from the beginning of the free range
+		const UINT index = range.Index;
+		range.Index += i_Count;
+		range.Count -= i_Count;
+
+		if (range.Count == 0)
+			m_FreeRanges.erase(m_FreeRanges.begin() + i);
+
+		m_AllocatedCount += i_Count;
+		return index;
+	}
+
+	return InvalidIndex;
+}
+
+void DescriptorAllocator::Free(UINT i_Index, UINT i_Count)
+{
+	if (i_Index == InvalidIndex || i_Count == 0)
+		return;
+
+	ASSERT(i_Index + i_Count <= m_Capacity);
+
+	// first free range after the freed one
+	auto next = std::lower_bound(m_FreeRanges.begin(), m_FreeRanges.end(), i_Index,
+		[](const Range & i_Range, UINT i_Value) { return i_Range.Index < i_Value; });
+
+	// a range is freed once
+	ASSERT(next == m_FreeRanges.end() || i_Index + i_Count <= next->Index);
+	ASSERT(next == m_FreeRanges.begin() || (next - 1)->Index + (next - 1)->Count <= i_Index);
+
+	m_AllocatedCount -= i_Count;
+
+	const bool mergePrevious	= (next != m_FreeRanges.begin()) && ((next - 1)->Index + (next - 1)->Count == i_Index);
+	const bool mergeNext		= (next != m_FreeRanges.end()) && (i_Index + i_Count == next->Index);
+
+	if (mergePrevious && mergeNext)
+	{
+		(next - 1)->Count += i_Count + next->Count;
+		m_FreeRanges.erase(next);
+	}
+	else if (mergePrevious)
+	{
+		(next - 1)->Count += i_Count;
+	}
+	else if (mergeNext)
+	{
+		next->Index = i_Index;
+		next->Count += i_Count;
+	}
+	else
+	{
+		m_FreeRanges.insert(next, { i_Index, i_Count });
+	}
+}
+
+void DescriptorAllocator::Reset()
+{
+	m_FreeRanges.clear();
+	m_AllocatedCount = 0;
+
+	if (m_Capacity > 0)
+		m_FreeRanges.push_back({ 0, m_Capacity });
+}
+
+UINT DescriptorAllocator::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+UINT DescriptorAllocator::GetAllocatedCount() const
+{
+	return m_AllocatedCount;
+}
+
+UINT DescriptorAllocator::GetFreeRangeCount() const
+{
+	return (UINT)m_FreeRanges.size();
+}
+
+UINT DescriptorAllocator::GetLargestFreeRange() const
+{
+	UINT largest = 0;
+
+	for (size_t i = 0; i < m_FreeRanges.size(); ++i)
+	{
+		largest = Math::Max(largest, m_FreeRanges[i].Count);
+	}
+
+	return largest;
+}
+
+float DescriptorAllocator::GetFragmentation() const
+{
+	const UINT freeCount = m_Capacity - m_AllocatedCount;
+
+	if (freeCount == 0)
+		return 0.f;
+
+	return 1.f - (float)GetLargestFreeRange() / (float)freeCount;
+}
@@ -0,0 +1,42 @@
+// descriptor index allocator
+// ranges of indices in a descriptor heap (see DX12BindlessHeap), the allocator does not use the device
+// free ranges are sorted by index and merged with their neighbours when freed : the allocation takes the first range large enough
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+
+class DescriptorAllocator
+{
+public:
+	static const UINT InvalidIndex = (UINT)-1;
+
+	DescriptorAllocator(UINT i_Capacity);
+	~DescriptorAllocator();
+
+	// allocation management
+	UINT		Allocate(UINT i_Count = 1);	// first index of the range, InvalidIndex when no free range is large enough
+	void		Free(UINT i_Index, UINT i_Count = 1);
+	void		Reset();	// free all indices
+
+	// information
+	UINT		GetCapacity() const;
+	UINT		GetAllocatedCount() const;	// allocated indices
+	UINT		GetFreeRangeCount() const;
+	UINT		GetLargestFreeRange() const;
+	float		GetFragmentation() const;	// 0 : the free indices are contiguous, near 1 : the free indices are scattered
+
+private:
+	struct Range
+	{
+		UINT		Index;
+		UINT		Count;
+	};
+
+	std::vector<Range>		m_FreeRanges;	// sorted by index, never contiguous
+
+	// desc
+	const UINT				m_Capacity;
+	UINT					m_AllocatedCount;
+};
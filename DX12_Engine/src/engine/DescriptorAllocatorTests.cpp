@@ -0,0 +1,146 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/DescriptorAllocator.h"
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12BindlessHeap.h"
+#include "engine/TestUtils.h"
+
+CFDescriptorAllocatorCheck::CFDescriptorAllocatorCheck()
+	:Console::Function("descriptor_allocator_check", "[operation count]", "check the descriptor index allocator, measure the fragmentation of a random allocation pattern")
+{
+}
+
+bool CFDescriptorAllocatorCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT operationCount = 100000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		operationCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	UINT errors = 0;
+
+	// sequential allocations, then the freed ranges are merged with their neighbours
+	{
+		DescriptorAllocator allocator(16);
+
+		for (UINT i = 0; i < 8; ++i)
+		{
+			if (allocator.Allocate() != i)
+				++errors;
+		}
+
+		allocator.Free(2);		// [2] [8, 16[
+		allocator.Free(4);		// [2] [4] [8, 16[
+		if (allocator.GetFreeRangeCount() != 3)
+			++errors;
+
+		allocator.Free(3);		// merged with both : [2, 5[ [8, 16[
+		allocator.Free(5);		// merged with the previous : [2, 6[ [8, 16[
+		allocator.Free(7);		// merged with the next : [2, 6[ [7, 16[
+		if (allocator.GetFreeRangeCount() != 2 || allocator.GetLargestFreeRange() != 9 || allocator.GetAllocatedCount() != 3)
+			++errors;
+
+		// the first range large enough is used
+		if (allocator.Allocate(4) != 2 || allocator.Allocate(4) != 7 || allocator.Allocate(8) != DescriptorAllocator::InvalidIndex)
+			++errors;
+
+		allocator.Reset();
+		if (allocator.GetAllocatedCount() != 0 || allocator.GetFreeRangeCount() != 1 || allocator.GetLargestFreeRange() != 16 || allocator.GetFragmentation() != 0.f)
+			++errors;
+	}
+
+	// exhaustion and ranges of the frame count (render targets)
+	{
+		const UINT frameCount = FRAME_BUFFER_COUNT;
+		DescriptorAllocator allocator(frameCount * 4);
+
+		for (UINT i = 0; i < 4; ++i)
+		{
+			if (allocator.Allocate(frameCount) != i * frameCount)
+				++errors;
+		}
+
+		if (allocator.Allocate() != DescriptorAllocator::InvalidIndex || allocator.GetFreeRangeCount() != 0)
+			++errors;
+
+		allocator.Free(frameCount, frameCount);
+		if (allocator.Allocate(frameCount + 1) != DescriptorAllocator::InvalidIndex || allocator.Allocate(frameCount) != frameCount)
+			++errors;
+	}
+
+	// fragmentation : textures (one index) and render targets (a range per frame) loaded and released in a random order
+	const UINT capacity = BINDLESS_DESCRIPTOR_COUNT;
+	DescriptorAllocator allocator(capacity);
+	std::vector<std::pair<UINT, UINT>> allocations;	// index, count
+	UINT failedCount = 0;
+	TestRandom random(1);
+
+	allocations.reserve(capacity);
+	Clock clock;
+
+	for (UINT i = 0; i < operationCount; ++i)
+	{
+		const UINT value = random.Next() >> 8;
+
+		// keep the heap three quarter full in average
+		if (allocations.empty() || (value % 4) != 0 || allocator.GetAllocatedCount() < capacity / 2)
+		{
+			if (allocator.GetAllocatedCount() > capacity * 7 / 8)
+				continue;
+
+			const UINT count = (value % 16 == 0) ? FRAME_BUFFER_COUNT : 1;
+			const UINT index = allocator.Allocate(count);
+
+			if (index == DescriptorAllocator::InvalidIndex)
+				++failedCount;
+			else
+				allocations.push_back(std::make_pair(index, count));
+		}
+		else
+		{
+			const size_t freed = (value >> 4) % allocations.size();
+			allocator.Free(allocations[freed].first, allocations[freed].second);
+			allocations[freed] = allocations.back();
+			allocations.pop_back();
+		}
+	}
+
+	const UINT64 elapsed = clock.GetElaspedTime().ToMicroseconds();
+
+	UINT allocatedCount = 0;
+
+	for (size_t i = 0; i < allocations.size(); ++i)
+	{
+		allocatedCount += allocations[i].second;
+	}
+
+	if (allocatedCount != allocator.GetAllocatedCount())
+		++errors;
+
+	GetConsole()->Print("descriptor allocator check : %u operations in %llu us (%.1f ns per operation), %u failed allocations",
+		operationCount, elapsed, (float)elapsed * 1000.f / (float)operationCount, failedCount);
+	GetConsole()->Print("descriptor allocator check : %u / %u indices allocated, %u free ranges, largest %u, fragmentation %.2f, %u errors",
+		allocator.GetAllocatedCount(), capacity, allocator.GetFreeRangeCount(), allocator.GetLargestFreeRange(), allocator.GetFragmentation(), errors);
+
+	// heap of the renderer
+	const DX12BindlessHeap * bindlessHeap = DX12RenderEngine::GetInstance().GetBindlessHeap();
+
+	if (bindlessHeap != nullptr)
+	{
+		const DescriptorAllocator & heapAllocator = bindlessHeap->GetAllocator();
+		GetConsole()->Print("bindless heap : %u / %u descriptors, %u pending, %u free ranges, fragmentation %.2f",
+			heapAllocator.GetAllocatedCount(), heapAllocator.GetCapacity(), bindlessHeap->GetPendingCount(), heapAllocator.GetFreeRangeCount(), heapAllocator.GetFragmentation());
+	}
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
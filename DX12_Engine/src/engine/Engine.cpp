@@ -5,6 +5,7 @@
 #include "dx12/DX12Context.h"
 #include "dx12/DX12RenderEngine.h"
 #include "dx12/DX12ConstantBuffer.h"
+#include "dx12/DX12UploadBuffer.h"
 #include "dx12/DX12ImGui.h"
 // game include
 #include "engine/World.h"
@@ -12,9 +13,22 @@
 #include "components/RenderComponent.h"
 // engine
 #include "engine/Clock.h"
+#include "engine/FramePacer.h"
+#include "engine/FixedTimestep.h"
+#include "engine/LevelStreamer.h"
+#include "engine/AnimationSystem.h"
+#include "engine/ParticleSystem.h"
 #include "engine/Window.h"
 #include "engine/Console.h"
 #include "engine/RenderList.h"
+#include "engine/FrameGraph.h"
+#include "engine/CPUProfiler.h"
+#include "engine/DebugDraw.h"
+#include "dx12/DX12FrameGraph.h"
+#include "dx12/DX12Transparency.h"
+#include "dx12/DX12GPUProfiler.h"
+#include "dx12/DX12RenderBackend.h"
+#include "engine/NullRenderBackend.h"
 // resources
 #include "resource/ResourceManager.h"		// CPU side resource (that can load also GPU resources)
 #include "resource/DX12ResourceManager.h"	// GPU side resources
@@ -22,6 +36,7 @@
 #include "ui/UILayer.h"
 #include "ui/UIConsole.h"
 #include "ui/UIDebug.h"
+#include "ui/UIProfiler.h"
 // editor
 #include "editor/Editor.h"
 // resources
@@ -57,6 +72,10 @@ void Engine::Delete()
 
 float Engine::GetLifeTime() const
 {
+	// headless : simulated time
+	if (m_RenderBackend->IsHeadless())
+		return (float)m_RenderBackend->GetFrameCount() * m_HeadlessFrameTime;
+
 	return m_EngineClock->GetElapsedFromStart().ToSeconds();
 }
 
@@ -78,37 +97,67 @@ UINT Engine::GetFramePerSecondTarget() const
 void Engine::SetFramePerSecondTarget(UINT i_Target)
 {
 	m_FramePerSecondsTargeted = i_Target;
+
+	if (m_FramePacer != nullptr)
+		m_FramePacer->SetTarget(i_Target);
 }
 
 void Engine::Initialize(EngineDesc & i_Desc)
 {
 	// create the DX12RenderEngine
-	if (i_Desc.HInstance == nullptr)
+	if (i_Desc.HInstance == nullptr && !i_Desc.Headless)
 	{
 		PRINT_DEBUG("Error, hInstance not filled in Engine Desc");
 		return;
 	}
 
+	// CPU zones (the main thread is named for the captures)
+	CPUProfiler::Initialize();
+	CPUProfiler::SetThreadName("Main");
+
+	// debug primitives (the buffers are sized before the render list)
+	DebugDraw::Initialize(i_Desc.DebugDrawCapacity);
+
+	// render backend : headless engines run without window and device
+	if (i_Desc.Headless)
+		m_RenderBackend = new NullRenderBackend;
+	else
+		m_RenderBackend = new DX12RenderBackend;
+
+	m_HeadlessFrameCount	= i_Desc.HeadlessFrameCount;
+	m_HeadlessFrameTime		= i_Desc.HeadlessFrameTime;
+
 	// create the window
-	m_Window = new Window(i_Desc.HInstance, i_Desc.WindowName.c_str(), i_Desc.WindowName.c_str(), i_Desc.WindowSize.x, i_Desc.WindowSize.y, i_Desc.WindowIcon);
+	if (!i_Desc.Headless)
+		m_Window = new Window(i_Desc.HInstance, i_Desc.WindowName.c_str(), i_Desc.WindowName.c_str(), i_Desc.WindowSize.x, i_Desc.WindowSize.y, i_Desc.WindowIcon);
 
 	// retreive the render engine
-	DX12RenderEngine::Create(i_Desc.HInstance);
+	DX12RenderEngine::Create(i_Desc.HInstance, m_RenderBackend);
 	m_RenderEngine = &DX12RenderEngine::GetInstance();
-	m_RenderEngine->InitializeDX12();
+
+	if (i_Desc.Headless)
+		m_RenderEngine->InitializeHeadless(i_Desc.WindowSize, i_Desc.RecordWorkerCount);
+	else
+		m_RenderEngine->InitializeDX12();
 
 	// resource management
 	m_ResourceManager			= new ResourceManager;
 	m_RenderResourceManager		= new DX12ResourceManager;	// create GPU resources (need DX12Initialized)
 
 	// initialize rendering pipeline and GBuffer creation (need the DX12ResourceManager)
-	m_RenderEngine->InitializeRender();
+	if (!i_Desc.Headless)
+		m_RenderEngine->InitializeRender(i_Desc.PackedGBuffer ? DX12RenderEngine::eGBufferPacked : DX12RenderEngine::eGBufferDefault, i_Desc.RecordWorkerCount);
+
+	m_RenderEngine->SetDepthPrePassEnabled(i_Desc.DepthPrePass);
+	m_RenderEngine->SetGPUCullingEnabled(i_Desc.GPUCulling);
+	m_RenderEngine->SetOITEnabled(i_Desc.OrderIndependentTransparency);
 
 	// intialize constant buffer
 	m_RenderEngine->GetConstantBuffer(DX12RenderEngine::eGlobal)->ReserveVirtualAddress();	// reserve the first address on the constant buffer
 
 	// create input management
-	m_Window->RegisterInputCallback(&Input::ProcessInputCallbacks);
+	if (m_Window != nullptr)
+		m_Window->RegisterInputCallback(&Input::ProcessInputCallbacks);
 
 	World::WorldDesc worldDesc;
 	// create default camera parameters
@@ -123,11 +172,27 @@ void Engine::Initialize(EngineDesc & i_Desc)
 
 	// create managers
 	m_RenderList = new RenderList;
+	m_FrameGraph = new FrameGraph;
+	m_FrameGraphResources = i_Desc.Headless ? nullptr : new DX12FrameGraph;	// the graph is compiled without GPU memory when headless
 
 	// setup settings
 	m_FramePerSecondsTargeted = i_Desc.FramePerSecondTargeted;
+	m_FramePacer = new FramePacer(m_FramePerSecondsTargeted);
+	m_FixedTimestep = (i_Desc.FixedTickRate != 0) ? new FixedTimestep(i_Desc.FixedTickRate, i_Desc.MaxTickPerFrame) : nullptr;
+	m_LevelStreamer = new LevelStreamer(m_CurrentWorld);
+	m_AnimationSystem = new AnimationSystem;
+	m_ParticleSystem = new ParticleSystem;
+	m_StreamingBudget = i_Desc.StreamingBudget;
 	m_ElapsedTime = 0.f;
 
+	// headless : no UI, console or editor
+	if (i_Desc.Headless)
+	{
+		m_RenderResourceManager->PushResourceOnGPUWithWait();
+		m_Exit = false;
+		return;
+	}
+
 	// initialize UI
 	m_UILayer = new UILayer(m_Window);
 	m_UILayer->SetEnable(i_Desc.UIEnabled);
@@ -136,6 +201,7 @@ void Engine::Initialize(EngineDesc & i_Desc)
 	// ui dev initialization
 	m_UIConsole = new UIConsole;
 	m_UIDebug	= new UIDebug;
+	m_UIProfiler	= new UIProfiler;
 
 	// initialize console
 	m_Console = new Console;
@@ -146,14 +212,49 @@ void Engine::Initialize(EngineDesc & i_Desc)
 	m_Console->RegisterFunction(new CFHelp);
 	m_Console->RegisterFunction(new CFPrintParam);
 	m_Console->RegisterFunction(new CFSetFrameTarget);
+	m_Console->RegisterFunction(new CFFrameGraphDump);
+	m_Console->RegisterFunction(new CFCPUCapture);
+	m_Console->RegisterFunction(new CFSceneSave);
+	m_Console->RegisterFunction(new CFSceneLoad);
+	m_Console->RegisterFunction(new CFSceneJson);
+	m_Console->RegisterFunction(new CFStreamCell);
+	m_Console->RegisterFunction(new CFSetOIT);
+#ifdef WITH_CONSOLE_TESTS
+	// check and bench commands
+	m_Console->RegisterFunction(new CFLightCluster);
+	m_Console->RegisterFunction(new CFShadowCheck);
+	m_Console->RegisterFunction(new CFDepthCheck);
+	m_Console->RegisterFunction(new CFGBufferCheck);
+	m_Console->RegisterFunction(new CFRecordCheck);
+	m_Console->RegisterFunction(new CFFrameGraphCheck);
+	m_Console->RegisterFunction(new CFBackendCheck);
+	m_Console->RegisterFunction(new CFGPUProfilerCheck);
+	m_Console->RegisterFunction(new CFCPUZoneBenchmark);
+	m_Console->RegisterFunction(new CFPacingCheck);
+	m_Console->RegisterFunction(new CFFixedStepCheck);
+	m_Console->RegisterFunction(new CFSceneCheck);
+	m_Console->RegisterFunction(new CFStreamCheck);
+	m_Console->RegisterFunction(new CFDebugDrawCheck);
+	m_Console->RegisterFunction(new CFMaterialGraphCheck);
+	m_Console->RegisterFunction(new CFMaterialInstanceCheck);
+	m_Console->RegisterFunction(new CFDescriptorAllocatorCheck);
+	m_Console->RegisterFunction(new CFGPUCullingCheck);
+	m_Console->RegisterFunction(new CFMeshArenaCheck);
+	m_Console->RegisterFunction(new CFRenderSubmitBench);
+	m_Console->RegisterFunction(new CFAnimationBench);
+	m_Console->RegisterFunction(new CFParticleBench);
+	m_Console->RegisterFunction(new CFTransparencyCheck);
+#endif /* WITH_CONSOLE_TESTS */
 
 	// push windows on layer
 	m_UILayer->PushUIWindowOnLayer(m_UIConsole);
 	m_UILayer->PushUIWindowOnLayer(m_UIDebug);
+	m_UILayer->PushUIWindowOnLayer(m_UIProfiler);
 
 	Input::BindKeyEvent<Engine>(Input::eKeyDown, VK_F1, "F1Debug", this, &Engine::OnF1Down, nullptr);
 	Input::BindKeyEvent<Engine>(Input::eKeyDown, VK_F2, "F2Debug", this, &Engine::OnF2Down, nullptr);
 	Input::BindKeyEvent<Engine>(Input::eKeyDown, VK_F3, "F3Debug", this, &Engine::OnF3Down, nullptr);
+	Input::BindKeyEvent<Engine>(Input::eKeyDown, VK_F4, "F4Profiler", this, &Engine::OnF4Down, nullptr);
 
 	m_IsInGame = false;
 
@@ -201,8 +302,20 @@ void Engine::Initialize(EngineDesc & i_Desc)
 
 void Engine::Run()
 {
+	// the world is ticked by the fixed timestep only (frames before the loop are not simulated)
+	if (m_FixedTimestep != nullptr)
+		m_FixedTimestep->Reset();
+
+	// headless : fixed frame count and frame time
+	if (m_RenderBackend->IsHeadless())
+	{
+		RunHeadless();
+		return;
+	}
+
 	// start engine clock
 	m_EngineClock->Reset();
+	m_FramePacer->Reset();
 
 	// To do : make a command list and a push to GPU
 	// Workaround : render before doing anything
@@ -214,12 +327,12 @@ void Engine::Run()
 		m_RenderResourceManager->PushResourceOnGPUWithWait();	// Workaround : load each time a new objects
 
 		// pre update management
-		m_ElapsedTime = m_EngineClock->Restart().ToSeconds();
+		m_ElapsedTime = m_FramePacer->BeginFrame();
 
-		// retreive performance data
-		if (m_ElapsedTime != 0.f)
+		// retreive performance data (smoothed : stable display)
+		if (m_FramePacer->GetSmoothedDeltaTime() != 0.f)
 		{ 
-			m_FramePerSecond = (UINT)(1.f / m_ElapsedTime);
+			m_FramePerSecond = (UINT)(1.f / m_FramePacer->GetSmoothedDeltaTime() + 0.5f);
 		}
 
 #if defined (_DEBUG) || defined(WITH_EDITOR)
@@ -237,18 +350,29 @@ void Engine::Run()
 		/* -- Update -- */
 
 		// update input and window callbacks
-		m_Window->Update();
+		{
+			CPU_ZONE("Window Update");
+			m_Window->Update();
+		}
 
-		// tick the world (update all actors and components)
+		// load and unload the cells around the camera
 		ASSERT(m_CurrentWorld != nullptr);
+		UpdateStreaming();
+
+		// tick the world (update all actors and components)
 		if (m_IsInGame)
 		{
 			// here we update the game
-			m_CurrentWorld->TickWorld(m_ElapsedTime);
+			TickWorld(m_ElapsedTime);
 		}
 		else
 		{
+			CPU_ZONE("Tick Camera");
 			m_CurrentWorld->TickCamera(m_ElapsedTime);
+
+			// actors moved out of the simulation (editor) are not interpolated
+			if (m_FixedTimestep != nullptr)
+				m_CurrentWorld->SaveTransforms();
 		}
 
 		// update and prepare the ui
@@ -260,78 +384,26 @@ void Engine::Run()
 		/* -- Render -- */
 
 		// prepare the render engine
-		m_RenderEngine->PrepareForRender();	// intialize the command list and other stuff
-		ID3D12GraphicsCommandList * commandList = m_RenderEngine->GetContext(DX12RenderEngine::eImmediate)->GetCommandList();
-
-		// update global buffer
 		{
-			struct GlobalBuffer
-			{
-				// other useful matrix for effects
-				float		Time;		// application time (from engine initialization)
-				float		Elapsed;	// frame time
-				XMFLOAT4	CamPos;		// position of the camera
-			};
-
-			static GlobalBuffer buff = {};
-			buff.Elapsed = m_ElapsedTime;
-			buff.Time = m_EngineClock->GetElapsedFromStart().ToSeconds();
-			buff.CamPos = m_CurrentWorld->GetCurrentCamera()->m_Position;
-
-			// update constant buffer
-			m_RenderEngine->GetConstantBuffer(DX12RenderEngine::eGlobal)->UpdateConstantBuffer(0, &buff, sizeof(GlobalBuffer));
-		}
-
-		// setup and push render list on the commandlist
-		{
-			RenderList::RenderListSetup setup;
-			Camera * cam = m_CurrentWorld->GetCurrentCamera();
-
-			// dx12 related
-			setup.DeferredCommandList	= m_RenderEngine->GetContext(DX12RenderEngine::eDeferred)->GetCommandList();
-			setup.ImmediateCommandList	= m_RenderEngine->GetContext(DX12RenderEngine::eImmediate)->GetCommandList();
-			// camera related
-			setup.ProjectionMatrix	= XMLoadFloat4x4(&cam->GetProjMatrix());
-			setup.ViewMatrix		= XMLoadFloat4x4(&cam->GetViewMatrix());
-			setup.CameraPosition	= XMFLOAT3(&m_CurrentWorld->GetCurrentCamera()->m_Position.x);
-
-			// setup render list
-			m_RenderList->Reset();	// reset the render list of the previous frame
-			m_RenderList->SetupRenderList(setup);
-			// push components to render to the render list
-			m_CurrentWorld->RenderWorld(m_RenderList);
+			CPU_ZONE("Begin Frame");
+			m_RenderBackend->BeginFrame();	// intialize the command list and other stuff
 		}
+		ID3D12GraphicsCommandList * commandList = m_RenderEngine->GetContext(DX12RenderEngine::eImmediate)->GetCommandList();
 
-		// render the GBuffer
-		{
-			// push the components on the commandlist to prepare for a render
-			m_RenderList->RenderGBuffer();
-		}
+		// GPU timings : the deferred context is submitted first and the immediate context last
+		DX12GPUProfiler * gpuProfiler = m_RenderEngine->GetGPUProfiler();
+		gpuProfiler->BeginFrame(m_RenderEngine->GetFrameIndex(), m_RenderEngine->GetContext(DX12RenderEngine::eDeferred)->GetCommandList());
 
-		// render lights in deferred
-		{
-#ifdef ENGINE_DEBUG
-			// if we draw debug
-			if (!m_RenderEngine->DebugIsEnabled())
-			{
-				// render lights
-				m_RenderList->RenderLight();
-			}
-#else
-			// render lights
-			m_RenderList->RenderLight();
+		RenderFrame(commandList);
 
-#endif /* ENGINE_DEBUG */
-		}
+		gpuProfiler->EndFrame(commandList);
 
-		// render ui
+		// update and display backbuffer, also swap buffer and manage commandqueue
 		{
-			m_UILayer->PushOnCommandList(commandList);
+			CPU_ZONE("End Frame");
+			m_RenderBackend->EndFrame();
 		}
 
-		// update and display backbuffer, also swap buffer and manage commandqueue
-		m_RenderEngine->Render();
-
 		/* -- End of the loop -- */
 		// update exit 
 		if (!m_Window->IsOpen())
@@ -342,26 +414,128 @@ void Engine::Run()
 		// wait before the next loop if we are too fast
 		if (m_FramePerSecondsTargeted != 0)
 		{
-			// sleep time
-			float frameTime = m_EngineClock->GetElaspedTime().ToSeconds();
-			const float fpsTime = (1.f / (float)m_FramePerSecondsTargeted);
-
-			if (frameTime < fpsTime)
-			{
-				DWORD sleepTime = (DWORD)((fpsTime - frameTime) * 1000.f);
-				Sleep(sleepTime);
-			}
+			CPU_ZONE("Frame Limiter");
+			m_FramePacer->WaitForNextFrame();
 		}
+
+		// collect the CPU zones of the frame
+		CPUProfiler::EndFrame();
 	}
 
 	// close the dx12 commandlist
-	m_RenderEngine->Close();
+	m_RenderBackend->Close();
 
 	// exit the engine
 	CleanUpResources();
 	CleanUpModules();
 }
 
+void Engine::RunHeadless()
+{
+	// deterministic : the frame time is fixed and nothing depends on the wall clock
+	NullRenderBackend * backend = static_cast<NullRenderBackend *>(m_RenderBackend);
+	m_ElapsedTime		= m_HeadlessFrameTime;
+	m_FramePerSecond	= (m_HeadlessFrameTime > 0.f) ? (UINT)(1.f / m_HeadlessFrameTime) : 0;
+
+	for (UINT frame = 0; frame < m_HeadlessFrameCount && !m_Exit; ++frame)
+	{
+		m_RenderResourceManager->PushResourceOnGPUWithWait();
+
+		// load and unload the cells around the camera
+		UpdateStreaming();
+
+		// tick the world (update all actors and components)
+		TickWorld(m_ElapsedTime);
+
+		// build the render list and record the draws
+		m_RenderBackend->BeginFrame();
+		RenderFrame(nullptr);
+		m_RenderBackend->EndFrame();
+
+		CPUProfiler::EndFrame();
+	}
+
+	m_RenderBackend->Close();
+
+	PRINT_DEBUG("[Engine] headless run : %llu frames, %u draws the last frame, stream hash 0x%016llx, %llu bytes allocated (peak %llu)",
+		backend->GetFrameCount(), (UINT)backend->GetDrawCalls().size(), backend->GetStreamHash(), backend->GetAllocatedSize(), backend->GetPeakAllocatedSize());
+
+	// exit the engine
+	CleanUpResources();
+	CleanUpModules();
+}
+
+void Engine::RenderFrame(ID3D12GraphicsCommandList * i_CommandList)
+{
+	CPU_ZONE("Render Frame");
+
+	// primitives added during the tick (the other threads are done with the frame)
+	DebugDraw::Collect(m_ElapsedTime);
+
+	// update global buffer
+	{
+		struct GlobalBuffer
+		{
+			// other useful matrix for effects
+			float		Time;		// application time (from engine initialization)
+			float		Elapsed;	// frame time
+			XMFLOAT4	CamPos;		// position of the camera
+		};
+
+		static GlobalBuffer buff = {};
+		buff.Elapsed = m_ElapsedTime;
+		buff.Time = GetLifeTime();
+		buff.CamPos = m_CurrentWorld->GetCurrentCamera()->m_Position;
+
+		// update constant buffer
+		m_RenderEngine->GetConstantBuffer(DX12RenderEngine::eGlobal)->UpdateConstantBuffer(0, &buff, sizeof(GlobalBuffer));
+	}
+
+	// setup and push render list on the commandlist
+	{
+		RenderList::RenderListSetup setup;
+		Camera * cam = m_CurrentWorld->GetCurrentCamera();
+
+		// dx12 related
+		setup.DeferredCommandList	= (i_CommandList != nullptr) ? m_RenderEngine->GetContext(DX12RenderEngine::eDeferred)->GetCommandList() : nullptr;
+		setup.ImmediateCommandList	= i_CommandList;
+		// camera related
+		setup.ProjectionMatrix	= XMLoadFloat4x4(&cam->GetProjMatrix());
+		setup.ViewMatrix		= XMLoadFloat4x4(&cam->GetViewMatrix());
+		setup.CameraPosition	= XMFLOAT3(&m_CurrentWorld->GetCurrentCamera()->m_Position.x);
+		// fixed timestep : the world is rendered between the last two steps
+		setup.InterpolationAlpha = (m_FixedTimestep != nullptr) ? m_FixedTimestep->GetAlpha() : 1.f;
+
+		// setup render list
+		m_RenderList->Reset();	// reset the render list of the previous frame
+		m_RenderList->SetupRenderList(setup);
+		// push components to render to the render list
+		m_CurrentWorld->RenderWorld(m_RenderList);
+
+		// skinning palettes of the frame, on the workers of the render list (read by the GBuffer pass)
+		Animation::SkinningMatrix * palette = reinterpret_cast<Animation::SkinningMatrix *>(m_RenderEngine->GetSkinningBuffer()->GetCPUAddress());
+		m_AnimationSystem->Evaluate(m_ElapsedTime, m_RenderList->GetCommandRecorder(), palette, MAX_SKINNING_BONES);
+
+		// particles of the submitted emitters (read by the transparent pass)
+		m_ParticleSystem->Simulate(m_ElapsedTime, m_RenderList->GetParticleComponents(), setup.ViewMatrix, m_RenderList->GetCommandRecorder());
+	}
+
+	// render the passes of the frame
+	{
+		const FrameGraph::PassId gbufferPass = BuildFrameGraph(i_CommandList);
+
+		m_FrameGraph->Execute([this, i_CommandList, gbufferPass](FrameGraph::PassId i_Pass, const std::vector<FrameGraph::Barrier> & i_Barriers)
+		{
+			if (m_FrameGraphResources == nullptr)
+				return;
+
+			// the GBuffer is recorded by the workers : its barriers are on the deferred context (submitted before the record contexts)
+			ID3D12GraphicsCommandList * commandList = (i_Pass == gbufferPass) ? m_RenderEngine->GetContext(DX12RenderEngine::eDeferred)->GetCommandList() : i_CommandList;
+			m_FrameGraphResources->PushBarriers(*m_FrameGraph, commandList, i_Barriers);
+		});
+	}
+}
+
 Window * Engine::GetWindow() const
 {
 	return m_Window;
@@ -397,8 +571,79 @@ RenderList * Engine::GetRenderList() const
 	return m_RenderList;
 }
 
+const FrameGraph * Engine::GetFrameGraph() const
+{
+	return m_FrameGraph;
+}
+
+RenderBackend * Engine::GetRenderBackend() const
+{
+	return m_RenderBackend;
+}
+
+const FramePacer * Engine::GetFramePacer() const
+{
+	return m_FramePacer;
+}
+
+const FixedTimestep * Engine::GetFixedTimestep() const
+{
+	return m_FixedTimestep;
+}
+
+LevelStreamer * Engine::GetLevelStreamer() const
+{
+	return m_LevelStreamer;
+}
+
+AnimationSystem * Engine::GetAnimationSystem() const
+{
+	return m_AnimationSystem;
+}
+
+ParticleSystem * Engine::GetParticleSystem() const
+{
+	return m_ParticleSystem;
+}
+
+void Engine::UpdateStreaming()
+{
+	const XMFLOAT4 & cameraPosition = m_CurrentWorld->GetCurrentCamera()->m_Position;
+	m_LevelStreamer->Update(XMFLOAT3(cameraPosition.x, cameraPosition.y, cameraPosition.z), m_StreamingBudget);
+}
+
+void Engine::TickWorld(float i_ElapsedTime)
+{
+	if (m_FixedTimestep == nullptr)
+	{
+		m_CurrentWorld->TickWorld(i_ElapsedTime);
+		return;
+	}
+
+	// fixed tick rate : the transforms before each step are kept for the render interpolation
+	const UINT stepCount = m_FixedTimestep->Advance(i_ElapsedTime);
+
+	for (UINT i = 0; i < stepCount; ++i)
+	{
+		m_CurrentWorld->SaveTransforms();
+		m_CurrentWorld->TickWorld(m_FixedTimestep->GetStep());
+	}
+}
+
 Engine::Engine()
 	:m_RenderEngine(nullptr)
+	,m_FramePacer(nullptr)
+	,m_FixedTimestep(nullptr)
+	,m_LevelStreamer(nullptr)
+	,m_AnimationSystem(nullptr)
+	,m_ParticleSystem(nullptr)
+	,m_StreamingBudget(0.f)
+	,m_RenderList(nullptr)
+	,m_FrameGraph(nullptr)
+	,m_FrameGraphResources(nullptr)
+	,m_RenderBackend(nullptr)
+	,m_HeadlessFrameCount(0)
+	,m_HeadlessFrameTime(0.f)
 	,m_CurrentWorld(nullptr)
 	,m_EngineClock(nullptr)
 	,m_Window(nullptr)
@@ -409,6 +654,8 @@ Engine::Engine()
 	// ui
 	,m_UILayer(nullptr)
 	,m_UIConsole(nullptr)
+	,m_UIDebug(nullptr)
+	,m_UIProfiler(nullptr)
 	// setup
 	,m_Exit(true)
 {
@@ -430,6 +677,8 @@ void Engine::CleanUpModules()
 	// delete UI
 	delete m_UILayer;
 	delete m_UIConsole;
+	delete m_UIDebug;
+	delete m_UIProfiler;
 
 	// delete manager
 	delete m_Console;
@@ -437,10 +686,147 @@ void Engine::CleanUpModules()
 	delete m_ResourceManager;
 
 	delete m_Window;
+	delete m_FramePacer;
+	delete m_FixedTimestep;
+	delete m_LevelStreamer;	// join the loader thread
+	delete m_AnimationSystem;
+	delete m_ParticleSystem;
+
+	// the render list releases its buffers through the render engine (the workers are joined)
+	m_RenderList->Reset();	// components of the last frame
+	delete m_RenderList;
 
 	// delete the render engine
 	// To do : fix crash when releasing resources
 	DX12RenderEngine::Delete();
+
+	// the render engine waited for the last frames : transient resources can be released
+	delete m_FrameGraph;
+	delete m_FrameGraphResources;
+
+	// buffers are released : allocations can be checked
+	delete m_RenderBackend;
+
+	// no zone is recorded after this point
+	CPUProfiler::Shutdown();
+	DebugDraw::Shutdown();
+}
+
+FrameGraph::PassId Engine::BuildFrameGraph(ID3D12GraphicsCommandList * i_CommandList)
+{
+	// the GBuffer and the order independent transparency targets are transient : they share the memory of the graph heap
+	// the other passes manage the states of their targets : they are imported without barriers
+	m_FrameGraph->Reset();
+
+	const FrameGraph::ResourceId depth		= m_FrameGraph->ImportResource("Depth Buffer", FrameGraph::eExternal, FrameGraph::eExternal, false);
+	const FrameGraph::ResourceId shadow		= m_FrameGraph->ImportResource("Shadow Atlas", FrameGraph::eExternal, FrameGraph::eExternal, false);
+	const FrameGraph::ResourceId backBuffer	= m_FrameGraph->ImportResource("Back Buffer", FrameGraph::eExternal, FrameGraph::eExternal, true);
+
+	static const char * const gbufferNames[DX12RenderEngine::eRenderTargetCount] = { "GBuffer Normal", "GBuffer Diffuse", "GBuffer Specular" };
+	FrameGraph::ResourceId gbuffer[DX12RenderEngine::eRenderTargetCount];
+
+	for (UINT i = 0; i < DX12RenderEngine::eRenderTargetCount; ++i)
+	{
+		gbuffer[i] = m_FrameGraph->CreateTexture(gbufferNames[i], m_RenderEngine->GetRenderTargetDesc((DX12RenderEngine::ERenderTargetId)i));
+	}
+
+	// render the GBuffer (the memory is aliased : the targets are cleared after the discard)
+	const FrameGraph::PassId gbufferPass = m_FrameGraph->AddPass("GBuffer", [this]()
+	{
+		if (m_FrameGraphResources != nullptr)
+			m_RenderEngine->ClearGBufferTargets(m_RenderEngine->GetContext(DX12RenderEngine::eDeferred)->GetCommandList());
+
+		m_RenderList->RenderGBuffer();
+	});
+	m_FrameGraph->Write(gbufferPass, depth, FrameGraph::eDepthWrite);
+
+	for (UINT i = 0; i < DX12RenderEngine::eRenderTargetCount; ++i)
+	{
+		m_FrameGraph->Write(gbufferPass, gbuffer[i], FrameGraph::eRenderTarget);
+	}
+
+	// render the shadow atlas
+	const FrameGraph::PassId shadowPass = m_FrameGraph->AddPass("Shadows", [this]() { m_RenderList->RenderShadows(); });
+	m_FrameGraph->Write(shadowPass, shadow, FrameGraph::eDepthWrite);
+
+	// build the Hi-Z pyramid used by the GPU culling of the next frame (no output in this frame)
+	const FrameGraph::PassId hizPass = m_FrameGraph->AddPass("Hi-Z", [this]() { m_RenderList->BuildHiZ(); }, true);
+	m_FrameGraph->Read(hizPass, depth, FrameGraph::eShaderResource);
+
+	// render lights in deferred
+	FrameGraph::PassId lightPass;
+	bool lightsRendered = true;
+#ifdef ENGINE_DEBUG
+	// the debug view draws the GBuffer on the back buffer : lights and shadows are culled
+	if (m_RenderEngine->DebugIsEnabled())
+	{
+		lightsRendered = false;
+		lightPass = m_FrameGraph->AddPass("Debug GBuffer", [this, i_CommandList]()
+		{
+			if (m_FrameGraphResources != nullptr)
+				m_RenderEngine->DrawDebugGBuffer(i_CommandList);
+		});
+	}
+	else
+#endif /* ENGINE_DEBUG */
+	{
+		lightPass = m_FrameGraph->AddPass("Lights", [this]() { m_RenderList->RenderLight(); });
+		m_FrameGraph->Read(lightPass, depth, FrameGraph::eDepthRead);
+		m_FrameGraph->Read(lightPass, shadow, FrameGraph::eShaderResource);
+	}
+
+	for (UINT i = 0; i < DX12RenderEngine::eRenderTargetCount; ++i)
+	{
+		m_FrameGraph->Read(lightPass, gbuffer[i], FrameGraph::eShaderResource);
+	}
+	m_FrameGraph->Write(lightPass, backBuffer, FrameGraph::eRenderTarget);
+
+	// render the semi transparent components over the lit frame (the meshes are lit with the lights and shadows of the light pass)
+	// order independent : the accumulation targets can use the memory of the GBuffer (not used after the light pass)
+	const FrameGraph::PassId transparentPass = m_FrameGraph->AddPass("Transparent", [this]() { m_RenderList->RenderTransparent(); });
+	m_FrameGraph->Read(transparentPass, depth, FrameGraph::eDepthRead);
+	m_FrameGraph->Write(transparentPass, backBuffer, FrameGraph::eRenderTarget);
+
+	// without the light pass no mesh is drawn (only the emitters) : the shadow atlas is not read and its pass stays culled
+	if (lightsRendered)
+		m_FrameGraph->Read(transparentPass, shadow, FrameGraph::eShaderResource);
+
+	DX12Transparency * transparency = m_RenderEngine->GetTransparency();
+	FrameGraph::ResourceId accumulation = FrameGraph::InvalidId, revealage = FrameGraph::InvalidId;
+
+	if (m_RenderEngine->OITIsEnabled())
+	{
+		accumulation	= m_FrameGraph->CreateTexture("OIT Accumulation", transparency->GetAccumulationDesc());
+		revealage		= m_FrameGraph->CreateTexture("OIT Revealage", transparency->GetRevealageDesc());
+		m_FrameGraph->Write(transparentPass, accumulation, FrameGraph::eRenderTarget);
+		m_FrameGraph->Write(transparentPass, revealage, FrameGraph::eRenderTarget);
+	}
+
+	// render debug primitives over the lit frame
+	const FrameGraph::PassId debugDrawPass = m_FrameGraph->AddPass("Debug Draw", [this]() { m_RenderList->RenderDebugDraw(); });
+	m_FrameGraph->Read(debugDrawPass, depth, FrameGraph::eDepthRead);
+	m_FrameGraph->Write(debugDrawPass, backBuffer, FrameGraph::eRenderTarget);
+
+	// render ui
+	if (m_UILayer != nullptr)
+	{
+		const FrameGraph::PassId uiPass = m_FrameGraph->AddPass("UI", [this, i_CommandList]() { m_UILayer->PushOnCommandList(i_CommandList); }, true);
+		m_FrameGraph->Write(uiPass, backBuffer, FrameGraph::eRenderTarget);
+	}
+
+	if (!m_FrameGraph->Compile() || (m_FrameGraphResources != nullptr && FAILED(m_FrameGraphResources->Prepare(*m_FrameGraph))))
+	{
+		PRINT_DEBUG("[Engine] unable to compile the frame graph");
+		DEBUG_BREAK;
+	}
+
+	// the passes use the placed resources of the frame
+	m_RenderEngine->BindGBufferResources(m_FrameGraphResources, gbuffer);
+
+	if (transparency != nullptr)
+		transparency->SetAccumulationTargets(m_FrameGraphResources, accumulation, revealage);
+
+	return gbufferPass;
 }
  
 #if defined(_DEBUG) || defined(WITH_EDITOR)
@@ -459,6 +845,11 @@ void Engine::OnF3Down(void * i_Void)
 	m_RenderEngine->EnableDebug(!m_RenderEngine->DebugIsEnabled());
 }
 
+void Engine::OnF4Down(void * i_Void)
+{
+	m_UIProfiler->SetActive(!m_UIProfiler->IsActive());
+}
+
 #ifdef WITH_EDITOR
 
 void Engine::OnF5Down(void * i_Void)
@@ -9,6 +9,7 @@
 #include "engine/Window.h"
 #include "engine/Input.h"
 #include "engine/Defines.h"
+#include "engine/FrameGraph.h"
 #include "dx12/d3dx12.h"
 #include "../resource.h"
 
@@ -19,15 +20,23 @@ using namespace DirectX;
 class World;
 // engine
 class Clock;
+class FramePacer;
+class FixedTimestep;
+class LevelStreamer;
+class AnimationSystem;
+class ParticleSystem;
 class Console;	// console management
 class RenderList;
+class RenderBackend;
 class ResourcesManager;
 // dx12
 class DX12RenderEngine;
+class DX12FrameGraph;
 // ui
 class UILayer;	// layer for UI
 class UIConsole;
 class UIDebug;
+class UIProfiler;
 // editor
 class Editor;
 // resources
@@ -43,6 +52,9 @@ public:
 		// engine setup
 		HINSTANCE	HInstance				= nullptr;
 		UINT		FramePerSecondTargeted	= 60;
+		UINT		FixedTickRate			= 0;	// world ticks per second (0 : one tick per frame with the frame time)
+		UINT		MaxTickPerFrame			= 4;	// fixed ticks in a frame at most (the late time is dropped)
+		float		StreamingBudget			= 2.f;	// milliseconds of actor spawn per frame (level streaming)
 		// window setup
 		IntVec2 WindowSize			= IntVec2(1600, 900);
 		std::wstring WindowName		= L"DX12_Engine";
@@ -54,6 +66,17 @@ public:
 		XMMATRIX CameraProjection	= XMMatrixIdentity();
 		// ui setup
 		bool UIEnabled				= true;
+		// render setup
+		bool DepthPrePass			= true;	// render opaque depth before the GBuffer
+		bool GPUCulling				= true;	// GBuffer draws culled on the GPU (frustum and Hi-Z) and drawn indirectly
+		bool OrderIndependentTransparency	= false;	// semi transparent meshes blended without sorting (weighted blended OIT)
+		bool PackedGBuffer			= true;	// octahedral normals and reduced render targets (see DX12RenderEngine::EGBufferLayout)
+		UINT RecordWorkerCount		= 4;	// threads recording the GBuffer command lists (the main thread is one of them)
+		UINT DebugDrawCapacity		= 0x10000;	// debug primitives of each type per frame (see DebugDraw)
+		// headless setup : no window and no device, draws are recorded by a null render backend
+		bool Headless				= false;
+		UINT HeadlessFrameCount		= 600;			// frames simulated by Run
+		float HeadlessFrameTime		= 1.f / 60.f;	// fixed frame time (deterministic runs)
 	};
 
 	// singleton management
@@ -80,8 +103,15 @@ public:
 	ResourceManager *		GetResourceManager() const;
 
 	RenderList *		GetRenderList() const;
+	const FrameGraph *	GetFrameGraph() const;	// graph of the last frame
+	RenderBackend *		GetRenderBackend() const;
 	World *				GetWorld() const;
 	Console *			GetConsole() const;
+	const FramePacer *	GetFramePacer() const;
+	const FixedTimestep *	GetFixedTimestep() const;	// null when the world ticks with the frame time
+	LevelStreamer *		GetLevelStreamer() const;
+	AnimationSystem *	GetAnimationSystem() const;
+	ParticleSystem *	GetParticleSystem() const;
 	// ui specs
 	UILayer *			GetUILayer() const;
 
@@ -95,11 +125,17 @@ private:
 	// internal call
 	void	CleanUpResources();
 	void	CleanUpModules();
+	void	RunHeadless();
+	void	TickWorld(float i_ElapsedTime);	// one tick with the frame time or fixed steps (see EngineDesc::FixedTickRate)
+	void	UpdateStreaming();	// stream the cells around the camera
+	void	RenderFrame(ID3D12GraphicsCommandList * i_CommandList);		// build the render list and execute the passes (no command list when headless)
+	FrameGraph::PassId	BuildFrameGraph(ID3D12GraphicsCommandList * i_CommandList);	// declare and compile the passes of the frame, return the GBuffer pass
 
 #if  defined(_DEBUG) || defined(WITH_EDITOR)
 	void	OnF1Down(void * i_Void);
 	void	OnF2Down(void * i_Void);
 	void	OnF3Down(void * i_Void);
+	void	OnF4Down(void * i_Void);
 	void	OnF5Down(void * i_Void);
 
 	bool	IsInGame() const;
@@ -108,6 +144,7 @@ private:
 	// ui windows for debug, editor and other
 	UIConsole *			m_UIConsole;
 	UIDebug *			m_UIDebug;
+	UIProfiler *		m_UIProfiler;
 
 	Editor *			m_Editor;
 #endif
@@ -119,10 +156,23 @@ private:
 	float			m_ElapsedTime;
 	UINT			m_FramePerSecondsTargeted;
 	UINT			m_FramePerSecond;
+	FramePacer *	m_FramePacer;		// wait for the frame rate target and keep the frame time statistics
+	FixedTimestep *	m_FixedTimestep;	// fixed tick rate of the world (render interpolation)
+	LevelStreamer *	m_LevelStreamer;	// cells of the world loaded around the camera
+	AnimationSystem *	m_AnimationSystem;	// animators of the skinned meshes (evaluated after the world submission)
+	ParticleSystem *	m_ParticleSystem;	// particles of the submitted emitters (simulated after the world submission)
+	float			m_StreamingBudget;
 
 	// DX12 rendering
 	DX12RenderEngine *		m_RenderEngine;
 	RenderList *			m_RenderList;	// render list to render components
+	FrameGraph *			m_FrameGraph;	// passes of the frame
+	DX12FrameGraph *		m_FrameGraphResources;
+	RenderBackend *			m_RenderBackend;
+
+	// headless
+	UINT					m_HeadlessFrameCount;
+	float					m_HeadlessFrameTime;
 
 	// resource management
 	DX12ResourceManager *	m_RenderResourceManager;
@@ -0,0 +1,73 @@
+#include "FixedTimestep.h"
+
+#include <math.h>
+
+FixedTimestep::FixedTimestep(UINT i_TickRate, UINT i_MaxStepPerFrame)
+	:m_TickRate(i_TickRate > 0 ? i_TickRate : 1)
+	,m_MaxStepPerFrame(i_MaxStepPerFrame > 0 ? i_MaxStepPerFrame : 1)
+	,m_Step(1.0 / (double)(i_TickRate > 0 ? i_TickRate : 1))
+{
+	Reset();
+}
+
+FixedTimestep::~FixedTimestep()
+{
+}
+
+void FixedTimestep::Reset()
+{
+	m_Accumulator	= 0.0;
+	m_DroppedTime	= 0.0;
+	m_StepCount		= 0;
+}
+
+UINT FixedTimestep::Advance(float i_ElapsedTime)
+{
+	if (i_ElapsedTime > 0.f)
+		m_Accumulator += (double)i_ElapsedTime;
+
+	UINT stepCount = 0;
+
+	while (m_Accumulator >= m_Step && stepCount < m_MaxStepPerFrame)
+	{
+		m_Accumulator -= m_Step;
+		++stepCount;
+	}
+
+	// too slow to catch up : the late time is dropped (only a part of step is kept for the interpolation)
+	if (m_Accumulator >= m_Step)
+	{
+		const double dropped = m_Accumulator - fmod(m_Accumulator, m_Step);
+
+		m_DroppedTime	+= dropped;
+		m_Accumulator	-= dropped;
+	}
+
+	m_StepCount += stepCount;
+	return stepCount;
+}
+
+UINT FixedTimestep::GetTickRate() const
+{
+	return m_TickRate;
+}
+
+float FixedTimestep::GetStep() const
+{
+	return (float)m_Step;
+}
+
+float FixedTimestep::GetAlpha() const
+{
+	return (float)(m_Accumulator / m_Step);
+}
+
+UINT64 FixedTimestep::GetStepCount() const
+{
+	return m_StepCount;
+}
+
+float FixedTimestep::GetDroppedTime() const
+{
+	return (float)m_DroppedTime;
+}
@@ -0,0 +1,36 @@
+// Fixed timestep
+// accumulate the frame times and give the count of fixed steps to simulate in the frame
+// the steps of a frame are capped : the time that can not be caught up is dropped (no spiral of death)
+// the alpha is the part of a step not simulated yet : renders interpolate the last two simulated states with it
+
+#pragma once
+
+#include <Windows.h>
+
+class FixedTimestep
+{
+public:
+	FixedTimestep(UINT i_TickRate, UINT i_MaxStepPerFrame);
+	~FixedTimestep();
+
+	// simulation
+	void		Reset();
+	UINT		Advance(float i_ElapsedTime);	// steps to simulate for this frame
+
+	// information
+	UINT		GetTickRate() const;
+	float		GetStep() const;			// seconds
+	float		GetAlpha() const;			// [0, 1] : position between the previous and the current step
+	UINT64		GetStepCount() const;		// steps simulated since the reset
+	float		GetDroppedTime() const;		// seconds dropped by the cap since the reset
+
+private:
+	const UINT		m_TickRate;
+	const UINT		m_MaxStepPerFrame;
+	const double	m_Step;
+
+	// double : no precision loss of the accumulator over long sessions
+	double		m_Accumulator;
+	double		m_DroppedTime;
+	UINT64		m_StepCount;
+};
@@ -0,0 +1,138 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <math.h>
+#include <string.h>
+
+#include "engine/Utils.h"
+#include "engine/Transform.h"
+#include "engine/FixedTimestep.h"
+#include "engine/TestUtils.h"
+
+CFFixedStepCheck::CFFixedStepCheck()
+	:Console::Function("fixed_step_check", "[step count]", "run the same simulation at several frame rates with a fixed timestep and compare the states")
+{
+}
+
+bool CFFixedStepCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT stepCount = 1200;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		stepCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	// simulated body : gravity, bounce on the ground and an impulse input every 37 steps
+	struct State
+	{
+		float	Position[3];
+		float	Velocity[3];
+	};
+
+	static const UINT tickRate = 60;
+	static const UINT frameRateCount = 5;
+	static const UINT frameRates[frameRateCount] = { 30, 60, 144, 240, 0 };	// 0 : jittered frame times
+	std::vector<State> reference;
+	UINT errors = 0;
+
+	for (UINT rate = 0; rate < frameRateCount; ++rate)
+	{
+		FixedTimestep timestep(tickRate, 8);
+		std::vector<State> states;
+		State state = { { 0.f, 10.f, 0.f }, { 1.f, 0.f, 0.5f } };
+		TestRandom random(0x2545F491);
+
+		while (states.size() < stepCount)
+		{
+			// frame time of the frame rate (the jittered one goes from 2 ms to 40 ms)
+			float frameTime = (frameRates[rate] != 0) ? 1.f / (float)frameRates[rate] : 0.f;
+
+			if (frameRates[rate] == 0)
+			{
+				frameTime = 0.002f + random.Unit() * 0.038f;
+			}
+
+			const UINT frameSteps = timestep.Advance(frameTime);
+
+			for (UINT i = 0; i < frameSteps; ++i)
+			{
+				const float step = timestep.GetStep();
+				const UINT stepIndex = (UINT)states.size();
+
+				if (stepIndex % 37 == 0)
+					state.Velocity[1] += 5.f;
+
+				state.Velocity[1] -= 9.81f * step;
+
+				for (UINT axis = 0; axis < 3; ++axis)
+				{
+					state.Position[axis] += state.Velocity[axis] * step;
+				}
+
+				if (state.Position[1] < 0.f)
+				{
+					state.Position[1] = -state.Position[1];
+					state.Velocity[1] = -state.Velocity[1] * 0.8f;
+				}
+
+				states.push_back(state);
+			}
+
+			// the alpha is the part of the step not simulated yet
+			if (timestep.GetAlpha() < 0.f || timestep.GetAlpha() > 1.f)
+				++errors;
+		}
+
+		// the states of the same steps must be the same (bitwise) at every frame rate
+		states.resize(stepCount);
+
+		if (rate == 0)
+			reference = states;
+		else if (memcmp(reference.data(), states.data(), stepCount * sizeof(State)) != 0)
+			++errors;
+
+		// no time is dropped when the frames are shorter than the catch up limit
+		if (timestep.GetDroppedTime() != 0.f)
+			++errors;
+	}
+
+	// a long frame is capped and the late time dropped
+	{
+		FixedTimestep timestep(tickRate, 4);
+		const UINT capped = timestep.Advance(1.f);
+
+		if (capped != 4 || timestep.GetDroppedTime() < 1.f - 5.f / (float)tickRate - 1e-4f || timestep.GetAlpha() > 1.f)
+			++errors;
+	}
+
+	// interpolation : the ends are the matrices of the transforms (same rotation order)
+	{
+		Transform previous(XMFLOAT3(0.f, 0.f, 0.f), XMFLOAT3(10.f, 20.f, 30.f), XMFLOAT3(1.f, 1.f, 1.f));
+		Transform current(XMFLOAT3(2.f, 4.f, 6.f), XMFLOAT3(30.f, 45.f, 60.f), XMFLOAT3(2.f, 2.f, 2.f));
+		const XMFLOAT4X4 previousMatrix	= previous.GetMatrix();
+		const XMFLOAT4X4 currentMatrix	= current.GetMatrix();
+
+		XMFLOAT4X4 start, end, middle;
+		XMStoreFloat4x4(&start, Transform::Interpolate(previous, current, 0.f));
+		XMStoreFloat4x4(&end, Transform::Interpolate(previous, current, 1.f));
+		XMStoreFloat4x4(&middle, Transform::Interpolate(previous, current, 0.5f));
+
+		for (UINT i = 0; i < 16; ++i)
+		{
+			if (fabsf((&start._11)[i] - (&previousMatrix._11)[i]) > 1e-4f || fabsf((&end._11)[i] - (&currentMatrix._11)[i]) > 1e-4f)
+				++errors;
+		}
+
+		if (fabsf(middle._41 - 1.f) > 1e-4f || fabsf(middle._42 - 2.f) > 1e-4f || fabsf(middle._43 - 3.f) > 1e-4f)
+			++errors;
+	}
+
+	GetConsole()->Print("fixed step check : %u steps at %u frame rates, %u errors", stepCount, frameRateCount, errors);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
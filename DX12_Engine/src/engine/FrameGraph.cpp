@@ -0,0 +1,663 @@
+#include "FrameGraph.h"
+
+#include "engine/Debug.h"
+#include "engine/Utils.h"
+
+#include <algorithm>
+
+FrameGraph::FrameGraph()
+{
+	Reset();
+}
+
+FrameGraph::~FrameGraph()
+{
+}
+
+void FrameGraph::Reset()
+{
+	m_Passes.clear();
+	m_Resources.clear();
+
+	m_IsCompiled		= false;
+	m_ExecutionOrder.clear();
+	m_Barriers.clear();
+	m_FinalBarriers.clear();
+	m_HeapSize			= 0;
+	m_UnaliasedSize		= 0;
+}
+
+FrameGraph::ResourceId FrameGraph::CreateTexture(const std::string & i_Name, const TextureDesc & i_Desc)
+{
+	ASSERT(i_Desc.Size > 0 && i_Desc.Alignment > 0);
+
+	Resource resource;
+	resource.Name			= i_Name;
+	resource.Desc			= i_Desc;
+	resource.IsTransient	= true;
+	resource.IsOutput		= false;
+	resource.InitialState	= eUndefined;	// first use state (see ComputeLifetimes)
+	resource.FinalState		= eUndefined;
+
+	m_Resources.push_back(resource);
+	m_IsCompiled = false;
+
+	return (ResourceId)(m_Resources.size() - 1);
+}
+
+FrameGraph::ResourceId FrameGraph::ImportResource(const std::string & i_Name, EResourceState i_InitialState, EResourceState i_FinalState, bool i_IsOutput)
+{
+	Resource resource;
+	resource.Name			= i_Name;
+	resource.IsTransient	= false;
+	resource.IsOutput		= i_IsOutput;
+	resource.InitialState	= i_InitialState;
+	resource.FinalState		= i_FinalState;
+
+	m_Resources.push_back(resource);
+	m_IsCompiled = false;
+
+	return (ResourceId)(m_Resources.size() - 1);
+}
+
+FrameGraph::PassId FrameGraph::AddPass(const std::string & i_Name, const ExecuteFunction & i_Execute, bool i_HaveSideEffect)
+{
+	Pass pass;
+	pass.Name				= i_Name;
+	pass.Execute			= i_Execute;
+	pass.HaveSideEffect		= i_HaveSideEffect;
+	pass.IsCulled			= false;
+
+	m_Passes.push_back(pass);
+	m_IsCompiled = false;
+
+	return (PassId)(m_Passes.size() - 1);
+}
+
+void FrameGraph::Read(PassId i_Pass, ResourceId i_Resource, EResourceState i_State)
+{
+	ASSERT(i_Pass < m_Passes.size() && i_Resource < m_Resources.size());
+	m_Passes[i_Pass].Uses.push_back({ i_Resource, i_State, false });
+	m_IsCompiled = false;
+}
+
+void FrameGraph::Write(PassId i_Pass, ResourceId i_Resource, EResourceState i_State)
+{
+	ASSERT(i_Pass < m_Passes.size() && i_Resource < m_Resources.size());
+	m_Passes[i_Pass].Uses.push_back({ i_Resource, i_State, true });
+	m_IsCompiled = false;
+}
+
+bool FrameGraph::Compile()
+{
+	m_IsCompiled = false;
+	m_ExecutionOrder.clear();
+	m_Barriers.clear();
+	m_FinalBarriers.clear();
+	m_HeapSize		= 0;
+	m_UnaliasedSize	= 0;
+
+	CullPasses();
+
+	if (!ComputeLifetimes())
+		return false;
+
+	AllocateResources();
+	ComputeBarriers();
+
+	m_IsCompiled = true;
+	return true;
+}
+
+void FrameGraph::Execute(const BarrierFunction & i_PushBarriers) const
+{
+	if (!m_IsCompiled)
+	{
+		PRINT_DEBUG("[FrameGraph] execute a graph that is not compiled");
+		DEBUG_BREAK;
+		return;
+	}
+
+	for (UINT i = 0; i < (UINT)m_ExecutionOrder.size(); ++i)
+	{
+		if (!m_Barriers[i].empty() && i_PushBarriers)
+			i_PushBarriers(m_ExecutionOrder[i], m_Barriers[i]);
+
+		const Pass & pass = m_Passes[m_ExecutionOrder[i]];
+
+		if (pass.Execute)
+			pass.Execute();
+	}
+
+	if (!m_FinalBarriers.empty() && i_PushBarriers)
+		i_PushBarriers(InvalidId, m_FinalBarriers);
+}
+
+const std::vector<FrameGraph::PassId> & FrameGraph::GetExecutionOrder() const
+{
+	return m_ExecutionOrder;
+}
+
+const std::vector<FrameGraph::Barrier> & FrameGraph::GetBarriers(UINT i_Order) const
+{
+	ASSERT(i_Order < m_Barriers.size());
+	return m_Barriers[i_Order];
+}
+
+const std::vector<FrameGraph::Barrier> & FrameGraph::GetFinalBarriers() const
+{
+	return m_FinalBarriers;
+}
+
+bool FrameGraph::IsCulled(PassId i_Pass) const
+{
+	ASSERT(i_Pass < m_Passes.size());
+	return m_Passes[i_Pass].IsCulled;
+}
+
+bool FrameGraph::IsAllocated(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].IsTransient && m_Resources[i_Resource].FirstUse != InvalidId;
+}
+
+UINT FrameGraph::GetFirstUse(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].FirstUse;
+}
+
+UINT FrameGraph::GetLastUse(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].LastUse;
+}
+
+bool FrameGraph::IsAliased(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].IsAliased;
+}
+
+UINT64 FrameGraph::GetHeapOffset(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].Offset;
+}
+
+FrameGraph::EResourceState FrameGraph::GetInitialState(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].InitialState;
+}
+
+UINT64 FrameGraph::GetHeapSize() const
+{
+	return m_HeapSize;
+}
+
+UINT64 FrameGraph::GetUnaliasedSize() const
+{
+	return m_UnaliasedSize;
+}
+
+UINT FrameGraph::GetBarrierCount() const
+{
+	size_t count = m_FinalBarriers.size();
+
+	for (size_t i = 0; i < m_Barriers.size(); ++i)
+	{
+		count += m_Barriers[i].size();
+	}
+
+	return (UINT)count;
+}
+
+UINT FrameGraph::GetBarrierBatchCount() const
+{
+	UINT count = m_FinalBarriers.empty() ? 0 : 1;
+
+	for (size_t i = 0; i < m_Barriers.size(); ++i)
+	{
+		if (!m_Barriers[i].empty())
+			++count;
+	}
+
+	return count;
+}
+
+UINT FrameGraph::GetPassCount() const
+{
+	return (UINT)m_Passes.size();
+}
+
+UINT FrameGraph::GetResourceCount() const
+{
+	return (UINT)m_Resources.size();
+}
+
+const std::string & FrameGraph::GetPassName(PassId i_Pass) const
+{
+	ASSERT(i_Pass < m_Passes.size());
+	return m_Passes[i_Pass].Name;
+}
+
+const std::string & FrameGraph::GetResourceName(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].Name;
+}
+
+const FrameGraph::TextureDesc & FrameGraph::GetTextureDesc(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].Desc;
+}
+
+bool FrameGraph::IsTransient(ResourceId i_Resource) const
+{
+	ASSERT(i_Resource < m_Resources.size());
+	return m_Resources[i_Resource].IsTransient;
+}
+
+bool FrameGraph::IsCompiled() const
+{
+	return m_IsCompiled;
+}
+
+void FrameGraph::DumpGraphviz(std::string & o_Dot) const
+{
+	char buffer[512];
+
+	o_Dot = "digraph FrameGraph\n{\n";
+	o_Dot += "\trankdir = LR;\n";
+	o_Dot += "\tnode [fontname = \"Consolas\", fontsize = 10];\n";
+	o_Dot += "\tedge [fontname = \"Consolas\", fontsize = 8];\n\n";
+
+	// passes : label with the execution position
+	for (UINT i = 0; i < (UINT)m_Passes.size(); ++i)
+	{
+		const Pass & pass = m_Passes[i];
+		const auto itr = std::find(m_ExecutionOrder.begin(), m_ExecutionOrder.end(), i);
+		const int order = (itr != m_ExecutionOrder.end()) ? (int)(itr - m_ExecutionOrder.begin()) : -1;
+
+		if (pass.IsCulled)
+			sprintf_s(buffer, "\tpass%u [label = \"%s\\n(culled)\", shape = box, style = dashed, color = gray];\n", i, pass.Name.c_str());
+		else
+			sprintf_s(buffer, "\tpass%u [label = \"%d : %s\", shape = box, style = filled, fillcolor = %s];\n", i, order, pass.Name.c_str(), pass.HaveSideEffect ? "orange" : "gold");
+
+		o_Dot += buffer;
+	}
+
+	o_Dot += "\n";
+
+	// resources : transient show their lifetime and memory
+	for (UINT i = 0; i < (UINT)m_Resources.size(); ++i)
+	{
+		const Resource & resource = m_Resources[i];
+
+		if (!resource.IsTransient)
+			sprintf_s(buffer, "\tres%u [label = \"%s\\nimported%s\", shape = ellipse, style = filled, fillcolor = palegreen];\n", i, resource.Name.c_str(), resource.IsOutput ? " output" : "");
+		else if (resource.FirstUse == InvalidId)
+			sprintf_s(buffer, "\tres%u [label = \"%s\\nunused\", shape = ellipse, style = dashed, color = gray];\n", i, resource.Name.c_str());
+		else
+			sprintf_s(buffer, "\tres%u [label = \"%s\\n%ux%u\\n[%u - %u] @ 0x%llx (%llu KB)\", shape = ellipse, style = filled, fillcolor = lightblue];\n",
+				i, resource.Name.c_str(), resource.Desc.Width, resource.Desc.Height, resource.FirstUse, resource.LastUse, resource.Offset, resource.Desc.Size / 1024);
+
+		o_Dot += buffer;
+	}
+
+	o_Dot += "\n";
+
+	// edges : reads go from the resource to the pass, writes from the pass to the resource
+	for (UINT i = 0; i < (UINT)m_Passes.size(); ++i)
+	{
+		const Pass & pass = m_Passes[i];
+
+		for (size_t u = 0; u < pass.Uses.size(); ++u)
+		{
+			const ResourceUse & use = pass.Uses[u];
+
+			if (use.IsWrite)
+				sprintf_s(buffer, "\tpass%u -> res%u [label = \"%s\", color = firebrick%s];\n", i, use.Resource, GetStateName(use.State), pass.IsCulled ? ", style = dashed" : "");
+			else
+				sprintf_s(buffer, "\tres%u -> pass%u [label = \"%s\", color = forestgreen%s];\n", use.Resource, i, GetStateName(use.State), pass.IsCulled ? ", style = dashed" : "");
+
+			o_Dot += buffer;
+		}
+	}
+
+	sprintf_s(buffer, "\n\tlabel = \"heap %llu KB (%llu KB without aliasing), %u barriers in %u batches\";\n", m_HeapSize / 1024, m_UnaliasedSize / 1024, GetBarrierCount(), GetBarrierBatchCount());
+	o_Dot += buffer;
+	o_Dot += "}\n";
+}
+
+const char * FrameGraph::GetStateName(EResourceState i_State)
+{
+	static const char * names[eResourceStateCount] =
+	{
+		"undefined",
+		"render target",
+		"depth write",
+		"depth read",
+		"shader resource",
+		"copy source",
+		"copy dest",
+		"present",
+		"external",
+	};
+
+	return (i_State < eResourceStateCount) ? names[i_State] : "unknown";
+}
+
+void FrameGraph::CullPasses()
+{
+	std::vector<PassId> stack;
+
+	// roots : passes with side effects or writing an output
+	for (UINT i = 0; i < (UINT)m_Passes.size(); ++i)
+	{
+		Pass & pass = m_Passes[i];
+		bool isRoot = pass.HaveSideEffect;
+
+		for (size_t u = 0; u < pass.Uses.size() && !isRoot; ++u)
+		{
+			isRoot = pass.Uses[u].IsWrite && m_Resources[pass.Uses[u].Resource].IsOutput;
+		}
+
+		pass.IsCulled = !isRoot;
+
+		if (isRoot)
+			stack.push_back(i);
+	}
+
+	// a pass depends on the last writer of each resource it uses
+	while (!stack.empty())
+	{
+		const PassId passId = stack.back();
+		stack.pop_back();
+
+		const Pass & pass = m_Passes[passId];
+
+		for (size_t u = 0; u < pass.Uses.size(); ++u)
+		{
+			const ResourceId resource = pass.Uses[u].Resource;
+
+			for (PassId writer = passId; writer-- > 0;)
+			{
+				const std::vector<ResourceUse> & uses = m_Passes[writer].Uses;
+				const bool isWriter = std::find_if(uses.begin(), uses.end(), [resource](const ResourceUse & i_Use)
+				{
+					return i_Use.IsWrite && i_Use.Resource == resource;
+				}) != uses.end();
+
+				if (!isWriter)
+					continue;
+
+				if (m_Passes[writer].IsCulled)
+				{
+					m_Passes[writer].IsCulled = false;
+					stack.push_back(writer);
+				}
+
+				break;
+			}
+		}
+	}
+}
+
+bool FrameGraph::ComputeLifetimes()
+{
+	for (size_t i = 0; i < m_Resources.size(); ++i)
+	{
+		Resource & resource = m_Resources[i];
+		resource.FirstUse			= InvalidId;
+		resource.LastUse			= InvalidId;
+		resource.Offset				= 0;
+		resource.AliasedResource	= InvalidId;
+		resource.IsAliased			= false;
+
+		if (resource.IsTransient)
+			resource.InitialState = eUndefined;
+	}
+
+	// passes are executed in the declaration order (a pass only depends on previous passes)
+	for (UINT i = 0; i < (UINT)m_Passes.size(); ++i)
+	{
+		if (!m_Passes[i].IsCulled)
+			m_ExecutionOrder.push_back(i);
+	}
+
+	for (UINT order = 0; order < (UINT)m_ExecutionOrder.size(); ++order)
+	{
+		const Pass & pass = m_Passes[m_ExecutionOrder[order]];
+
+		for (size_t u = 0; u < pass.Uses.size(); ++u)
+		{
+			const ResourceUse & use = pass.Uses[u];
+			Resource & resource = m_Resources[use.Resource];
+
+			// a resource have only one state in a pass
+			for (size_t other = 0; other < u; ++other)
+			{
+				if (pass.Uses[other].Resource == use.Resource && pass.Uses[other].State != use.State)
+				{
+					PRINT_DEBUG("[FrameGraph] the pass %s use %s with different states", pass.Name.c_str(), resource.Name.c_str());
+					return false;
+				}
+			}
+
+			if (resource.FirstUse == InvalidId)
+			{
+				// the content of a transient resource is undefined before its first write
+				if (resource.IsTransient && !use.IsWrite)
+				{
+					PRINT_DEBUG("[FrameGraph] the pass %s read %s before any write", pass.Name.c_str(), resource.Name.c_str());
+					return false;
+				}
+
+				// transient resources are created in the state of their first use
+				if (resource.IsTransient)
+					resource.InitialState = use.State;
+
+				resource.FirstUse = order;
+			}
+
+			resource.LastUse = order;
+		}
+	}
+
+	return true;
+}
+
+void FrameGraph::AllocateResources()
+{
+	std::vector<ResourceId> resources;
+
+	for (UINT i = 0; i < (UINT)m_Resources.size(); ++i)
+	{
+		if (IsAllocated(i))
+		{
+			resources.push_back(i);
+			m_UnaliasedSize += AlignSize(m_Resources[i].Desc.Size, m_Resources[i].Desc.Alignment);
+		}
+	}
+
+	// biggest resources first (greedy placement)
+	std::sort(resources.begin(), resources.end(), [this](ResourceId i_A, ResourceId i_B)
+	{
+		const Resource & a = m_Resources[i_A];
+		const Resource & b = m_Resources[i_B];
+
+		if (a.Desc.Size != b.Desc.Size)		return a.Desc.Size > b.Desc.Size;
+		if (a.FirstUse != b.FirstUse)		return a.FirstUse < b.FirstUse;
+		return i_A < i_B;
+	});
+
+	std::vector<ResourceId> placed;
+	std::vector<UINT64> candidates;
+
+	for (size_t i = 0; i < resources.size(); ++i)
+	{
+		Resource & resource = m_Resources[resources[i]];
+		const UINT64 size = AlignSize(resource.Desc.Size, resource.Desc.Alignment);
+
+		// resources alive at the same time can not share memory
+		candidates.clear();
+		candidates.push_back(0);
+
+		for (size_t p = 0; p < placed.size(); ++p)
+		{
+			const Resource & other = m_Resources[placed[p]];
+
+			if (other.FirstUse <= resource.LastUse && resource.FirstUse <= other.LastUse)
+				candidates.push_back(AlignSize(other.Offset + AlignSize(other.Desc.Size, other.Desc.Alignment), resource.Desc.Alignment));
+		}
+
+		std::sort(candidates.begin(), candidates.end());
+
+		// lowest offset without overlap
+		for (size_t c = 0; c < candidates.size(); ++c)
+		{
+			const UINT64 offset = candidates[c];
+			bool overlap = false;
+
+			for (size_t p = 0; p < placed.size() && !overlap; ++p)
+			{
+				const Resource & other = m_Resources[placed[p]];
+				const UINT64 otherEnd = other.Offset + AlignSize(other.Desc.Size, other.Desc.Alignment);
+
+				overlap = other.FirstUse <= resource.LastUse && resource.FirstUse <= other.LastUse
+					&& other.Offset < offset + size && offset < otherEnd;
+			}
+
+			if (!overlap)
+			{
+				resource.Offset = offset;
+				break;
+			}
+		}
+
+		m_HeapSize = Math::Max(m_HeapSize, resource.Offset + size);
+		placed.push_back(resources[i]);
+	}
+
+	// aliasing : the last resource that used the same memory before the first use
+	// the heap is reused by the next frame : the first resource in a memory range follows the last one of the previous frame
+	for (size_t i = 0; i < resources.size(); ++i)
+	{
+		Resource & resource = m_Resources[resources[i]];
+		const UINT64 end = resource.Offset + AlignSize(resource.Desc.Size, resource.Desc.Alignment);
+		ResourceId previous = InvalidId, last = InvalidId;
+		UINT previousCount = 0, lastCount = 0;
+
+		for (size_t p = 0; p < resources.size(); ++p)
+		{
+			const Resource & other = m_Resources[resources[p]];
+			const UINT64 otherEnd = other.Offset + AlignSize(other.Desc.Size, other.Desc.Alignment);
+
+			if (p == i || other.Offset >= end || resource.Offset >= otherEnd)
+				continue;
+
+			// resources sharing memory have disjoint lifetimes
+			if (other.LastUse < resource.FirstUse)
+			{
+				++previousCount;
+
+				if (previous == InvalidId || other.LastUse > m_Resources[previous].LastUse)
+					previous = resources[p];
+			}
+			else
+			{
+				++lastCount;
+
+				if (last == InvalidId || other.LastUse > m_Resources[last].LastUse)
+					last = resources[p];
+			}
+		}
+
+		// the memory was used by several resources : aliasing barrier on any resource
+		if (previousCount > 0)
+			resource.AliasedResource = (previousCount == 1) ? previous : InvalidId;
+		else
+			resource.AliasedResource = (lastCount == 1) ? last : InvalidId;
+
+		resource.IsAliased = previousCount + lastCount > 0;
+	}
+}
+
+void FrameGraph::ComputeBarriers()
+{
+	std::vector<EResourceState> states(m_Resources.size());
+
+	for (size_t i = 0; i < m_Resources.size(); ++i)
+	{
+		states[i] = m_Resources[i].InitialState;
+	}
+
+	m_Barriers.resize(m_ExecutionOrder.size());
+
+	for (UINT order = 0; order < (UINT)m_ExecutionOrder.size(); ++order)
+	{
+		const Pass & pass = m_Passes[m_ExecutionOrder[order]];
+		std::vector<Barrier> & barriers = m_Barriers[order];
+
+		for (size_t u = 0; u < pass.Uses.size(); ++u)
+		{
+			const ResourceUse & use = pass.Uses[u];
+			const Resource & resource = m_Resources[use.Resource];
+
+			// states managed outside of the graph
+			if (!resource.IsTransient && resource.InitialState == eExternal)
+				continue;
+
+			// the memory is shared with other resources : every first use (the previous frame used the memory of the first resources)
+			if (resource.IsAliased && resource.FirstUse == order)
+			{
+				const bool exist = std::find_if(barriers.begin(), barriers.end(), [&use](const Barrier & i_Barrier)
+				{
+					return i_Barrier.Type == Barrier::eAliasing && i_Barrier.Resource == use.Resource;
+				}) != barriers.end();
+
+				if (!exist)
+					barriers.push_back({ Barrier::eAliasing, use.Resource, resource.AliasedResource, eUndefined, eUndefined });
+			}
+
+			if (states[use.Resource] != use.State)
+			{
+				barriers.push_back({ Barrier::eTransition, use.Resource, InvalidId, states[use.Resource], use.State });
+				states[use.Resource] = use.State;
+			}
+		}
+	}
+
+	// restore the states expected at the beginning of the next frame
+	for (UINT i = 0; i < (UINT)m_Resources.size(); ++i)
+	{
+		const Resource & resource = m_Resources[i];
+		EResourceState finalState = eUndefined;
+
+		if (resource.IsTransient)
+		{
+			if (resource.FirstUse == InvalidId)
+				continue;
+
+			finalState = resource.InitialState;	// created in this state
+		}
+		else
+		{
+			if (resource.InitialState == eExternal || resource.FinalState == eUndefined || resource.FinalState == eExternal)
+				continue;
+
+			finalState = resource.FinalState;
+		}
+
+		if (states[i] != finalState)
+			m_FinalBarriers.push_back({ Barrier::eTransition, i, InvalidId, states[i], finalState });
+	}
+}
+
+FORCEINLINE UINT64 FrameGraph::AlignSize(UINT64 i_Size, UINT64 i_Alignment)
+{
+	return (i_Size + i_Alignment - 1) / i_Alignment * i_Alignment;
+}
@@ -0,0 +1,167 @@
+// frame graph : passes declare the resources they read and write, the graph is compiled before the execution
+// compilation (CPU only) :
+// - passes that do not contribute to an output (imported output or pass with side effects) are culled
+// - lifetime of the transient resources is computed from the execution order
+// - transient resources with disjoint lifetimes share the same memory of a heap (aliasing)
+//   the heap is reused each frame : the first use of every resource sharing memory gets an aliasing barrier (and a discard)
+// - resource barriers are computed and batched before each pass
+// the graph is rebuilt each frame, DX12FrameGraph create the placed resources and translate barriers
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+class FrameGraph
+{
+public:
+	typedef UINT	ResourceId;
+	typedef UINT	PassId;
+	static const UINT	InvalidId = (UINT)-1;
+
+	// state of a resource used by a pass
+	enum EResourceState
+	{
+		eUndefined,
+		eRenderTarget,
+		eDepthWrite,
+		eDepthRead,
+		eShaderResource,
+		eCopySource,
+		eCopyDest,
+		ePresent,
+		eExternal,		// imported resource : states are managed outside of the graph (no barriers)
+
+		eResourceStateCount,
+	};
+
+	// transient texture
+	struct TextureDesc
+	{
+		UINT		Width		= 0;
+		UINT		Height		= 0;
+		UINT		Format		= 0;		// DXGI_FORMAT
+		bool		IsDepth		= false;	// depth stencil or render target
+		UINT64		Size		= 0;		// bytes in the heap (see DX12FrameGraph::GetTextureDesc)
+		UINT64		Alignment	= 0x10000;
+		float		ClearValue[4] = { 0.f, 0.f, 0.f, 0.f };	// optimized clear value (depth : ClearValue[0])
+	};
+
+	// barrier pushed before a pass
+	struct Barrier
+	{
+		enum EType
+		{
+			eTransition,
+			eAliasing,		// the memory of the resource was used by AliasedResource, in this frame or at the end of the previous one (InvalidId : any resource)
+		};
+
+		EType				Type;
+		ResourceId			Resource;
+		ResourceId			AliasedResource;
+		EResourceState		Before;
+		EResourceState		After;
+	};
+
+	typedef std::function<void()>								ExecuteFunction;
+	typedef std::function<void(PassId, const std::vector<Barrier> &)>	BarrierFunction;	// pass of the batch (InvalidId : final barriers)
+
+	FrameGraph();
+	~FrameGraph();
+
+	// declaration
+	void			Reset();	// remove passes and resources
+	ResourceId		CreateTexture(const std::string & i_Name, const TextureDesc & i_Desc);	// transient : allocated in the shared heap
+	ResourceId		ImportResource(const std::string & i_Name, EResourceState i_InitialState, EResourceState i_FinalState, bool i_IsOutput);
+	PassId			AddPass(const std::string & i_Name, const ExecuteFunction & i_Execute, bool i_HaveSideEffect = false);	// side effect : never culled
+	void			Read(PassId i_Pass, ResourceId i_Resource, EResourceState i_State);
+	void			Write(PassId i_Pass, ResourceId i_Resource, EResourceState i_State);	// the content is kept : the pass depends on the previous writer
+
+	// compilation and execution
+	bool			Compile();
+	void			Execute(const BarrierFunction & i_PushBarriers) const;	// call passes in order, barriers are pushed before each pass
+
+	// compiled data
+	const std::vector<PassId> &		GetExecutionOrder() const;
+	const std::vector<Barrier> &	GetBarriers(UINT i_Order) const;	// barriers before the pass at this position of the execution order
+	const std::vector<Barrier> &	GetFinalBarriers() const;			// barriers at the end of the graph
+	bool			IsCulled(PassId i_Pass) const;
+	bool			IsAllocated(ResourceId i_Resource) const;	// transient resource used by a pass
+	UINT			GetFirstUse(ResourceId i_Resource) const;	// position in the execution order
+	UINT			GetLastUse(ResourceId i_Resource) const;
+	bool			IsAliased(ResourceId i_Resource) const;		// the memory is shared with other resources : the first use must clear or discard it
+	UINT64			GetHeapOffset(ResourceId i_Resource) const;
+	EResourceState	GetInitialState(ResourceId i_Resource) const;	// state of the resource at the beginning of the graph
+	UINT64			GetHeapSize() const;		// memory needed for the transient resources
+	UINT64			GetUnaliasedSize() const;	// memory needed without aliasing
+	UINT			GetBarrierCount() const;
+	UINT			GetBarrierBatchCount() const;
+
+	// information
+	UINT					GetPassCount() const;
+	UINT					GetResourceCount() const;
+	const std::string &		GetPassName(PassId i_Pass) const;
+	const std::string &		GetResourceName(ResourceId i_Resource) const;
+	const TextureDesc &		GetTextureDesc(ResourceId i_Resource) const;
+	bool					IsTransient(ResourceId i_Resource) const;
+	bool					IsCompiled() const;
+
+	// debug
+	void					DumpGraphviz(std::string & o_Dot) const;
+	static const char *		GetStateName(EResourceState i_State);
+
+private:
+	struct ResourceUse
+	{
+		ResourceId			Resource;
+		EResourceState		State;
+		bool				IsWrite;
+	};
+
+	struct Pass
+	{
+		std::string					Name;
+		ExecuteFunction				Execute;
+		bool						HaveSideEffect;
+		std::vector<ResourceUse>	Uses;
+		bool						IsCulled;
+	};
+
+	struct Resource
+	{
+		std::string			Name;
+		TextureDesc			Desc;
+		bool				IsTransient;
+		bool				IsOutput;
+		EResourceState		InitialState;
+		EResourceState		FinalState;
+		// compiled data
+		UINT				FirstUse			= InvalidId;
+		UINT				LastUse				= InvalidId;
+		UINT64				Offset				= 0;
+		ResourceId			AliasedResource		= InvalidId;	// previous resource in the same memory (the last one of the previous frame for the first one)
+		bool				IsAliased			= false;		// the memory is shared with other resources
+	};
+
+	// compilation steps
+	void		CullPasses();
+	bool		ComputeLifetimes();
+	void		AllocateResources();
+	void		ComputeBarriers();
+
+	// helper
+	static UINT64	AlignSize(UINT64 i_Size, UINT64 i_Alignment);
+
+	std::vector<Pass>					m_Passes;
+	std::vector<Resource>				m_Resources;
+
+	// compiled data
+	bool								m_IsCompiled;
+	std::vector<PassId>					m_ExecutionOrder;
+	std::vector<std::vector<Barrier>>	m_Barriers;		// one batch for each executed pass
+	std::vector<Barrier>				m_FinalBarriers;
+	UINT64								m_HeapSize;
+	UINT64								m_UnaliasedSize;
+};
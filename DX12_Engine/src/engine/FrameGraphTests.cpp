@@ -0,0 +1,287 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <algorithm>
+
+#include "engine/Utils.h"
+#include "engine/FrameGraph.h"
+#include "engine/TestUtils.h"
+
+CFFrameGraphCheck::CFFrameGraphCheck()
+	:Console::Function("framegraph_check", "[graph count]", "validate the frame graph compilation (culling, aliasing and barriers)")
+{
+}
+
+bool CFFrameGraphCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT graphCount = 1000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		graphCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	UINT errors = 0;
+	FrameGraph graph;
+
+	FrameGraph::TextureDesc desc;
+	desc.Width		= 1920;
+	desc.Height		= 1080;
+	desc.Size		= 0x800000;
+
+	// -- Known graph : culling, lifetimes and aliasing -- //
+	{
+		const FrameGraph::ResourceId back	= graph.ImportResource("Back buffer", FrameGraph::ePresent, FrameGraph::ePresent, true);
+		const FrameGraph::ResourceId t0		= graph.CreateTexture("T0", desc);
+		const FrameGraph::ResourceId t1		= graph.CreateTexture("T1", desc);
+		const FrameGraph::ResourceId t2		= graph.CreateTexture("T2", desc);
+		const FrameGraph::ResourceId unused	= graph.CreateTexture("Unused", desc);
+
+		const FrameGraph::PassId p0 = graph.AddPass("P0", nullptr);
+		graph.Write(p0, t0, FrameGraph::eRenderTarget);
+		const FrameGraph::PassId p1 = graph.AddPass("P1", nullptr);
+		graph.Read(p1, t0, FrameGraph::eShaderResource);
+		graph.Write(p1, t1, FrameGraph::eRenderTarget);
+		const FrameGraph::PassId culled = graph.AddPass("Culled", nullptr);
+		graph.Read(culled, t1, FrameGraph::eShaderResource);
+		graph.Write(culled, unused, FrameGraph::eRenderTarget);
+		const FrameGraph::PassId p2 = graph.AddPass("P2", nullptr);
+		graph.Read(p2, t1, FrameGraph::eShaderResource);
+		graph.Write(p2, t2, FrameGraph::eRenderTarget);
+		const FrameGraph::PassId p3 = graph.AddPass("P3", nullptr);
+		graph.Read(p3, t2, FrameGraph::eShaderResource);
+		graph.Write(p3, back, FrameGraph::eRenderTarget);
+
+		if (!graph.Compile())
+			++errors;
+
+		// the unused output is culled
+		const std::vector<FrameGraph::PassId> & order = graph.GetExecutionOrder();
+		if (order.size() != 4 || order[0] != p0 || order[1] != p1 || order[2] != p2 || order[3] != p3 || !graph.IsCulled(culled) || graph.IsAllocated(unused))
+			++errors;
+
+		// T0 and T2 share the same memory : T0 follows T2 of the previous frame
+		if (graph.GetHeapSize() != 2 * desc.Size || graph.GetUnaliasedSize() != 3 * desc.Size)
+			++errors;
+		if (graph.GetHeapOffset(t0) != graph.GetHeapOffset(t2) || !graph.IsAliased(t2) || !graph.IsAliased(t0) || graph.IsAliased(t1))
+			++errors;
+
+		// barriers : aliasing before P0 and P2, transitions batched before each pass
+		const std::vector<FrameGraph::Barrier> & p0Barriers = graph.GetBarriers(0);
+		if (p0Barriers.size() != 1 || p0Barriers[0].Type != FrameGraph::Barrier::eAliasing || p0Barriers[0].Resource != t0 || p0Barriers[0].AliasedResource != t2)
+			++errors;
+
+		const std::vector<FrameGraph::Barrier> & p2Barriers = graph.GetBarriers(2);
+		if (p2Barriers.size() != 2 || p2Barriers[0].Type != FrameGraph::Barrier::eTransition || p2Barriers[0].Resource != t1
+			|| p2Barriers[1].Type != FrameGraph::Barrier::eAliasing || p2Barriers[1].Resource != t2 || p2Barriers[1].AliasedResource != t0)
+			++errors;
+
+		const std::vector<FrameGraph::Barrier> & p3Barriers = graph.GetBarriers(3);
+		if (p3Barriers.size() != 2 || p3Barriers[1].Resource != back || p3Barriers[1].Before != FrameGraph::ePresent || p3Barriers[1].After != FrameGraph::eRenderTarget)
+			++errors;
+
+		// states restored at the end : transient to their creation state, back buffer to present
+		if (graph.GetFinalBarriers().size() != 4)
+			++errors;
+
+		// reading a transient resource before its first write is an error
+		graph.Reset();
+		const FrameGraph::ResourceId texture = graph.CreateTexture("Texture", desc);
+		const FrameGraph::PassId pass = graph.AddPass("Pass", nullptr, true);
+		graph.Read(pass, texture, FrameGraph::eShaderResource);
+
+		if (graph.Compile())
+			++errors;
+	}
+
+	// -- Passes of the engine (see Engine::BuildFrameGraph) : the shadows are culled in the debug GBuffer view -- //
+	for (UINT debugView = 0; debugView < 2; ++debugView)
+	{
+		graph.Reset();
+
+		const FrameGraph::ResourceId depth	= graph.ImportResource("Depth Buffer", FrameGraph::eExternal, FrameGraph::eExternal, false);
+		const FrameGraph::ResourceId shadow	= graph.ImportResource("Shadow Atlas", FrameGraph::eExternal, FrameGraph::eExternal, false);
+		const FrameGraph::ResourceId back	= graph.ImportResource("Back Buffer", FrameGraph::eExternal, FrameGraph::eExternal, true);
+		const FrameGraph::ResourceId gbuffer	= graph.CreateTexture("GBuffer", desc);
+
+		const FrameGraph::PassId gbufferPass = graph.AddPass("GBuffer", nullptr);
+		graph.Write(gbufferPass, depth, FrameGraph::eDepthWrite);
+		graph.Write(gbufferPass, gbuffer, FrameGraph::eRenderTarget);
+		const FrameGraph::PassId shadowPass = graph.AddPass("Shadows", nullptr);
+		graph.Write(shadowPass, shadow, FrameGraph::eDepthWrite);
+
+		const FrameGraph::PassId lightPass = graph.AddPass(debugView ? "Debug GBuffer" : "Lights", nullptr);
+		if (!debugView)
+		{
+			graph.Read(lightPass, depth, FrameGraph::eDepthRead);
+			graph.Read(lightPass, shadow, FrameGraph::eShaderResource);
+		}
+		graph.Read(lightPass, gbuffer, FrameGraph::eShaderResource);
+		graph.Write(lightPass, back, FrameGraph::eRenderTarget);
+
+		const FrameGraph::PassId transparentPass = graph.AddPass("Transparent", nullptr);
+		graph.Read(transparentPass, depth, FrameGraph::eDepthRead);
+		graph.Write(transparentPass, back, FrameGraph::eRenderTarget);
+		if (!debugView)
+			graph.Read(transparentPass, shadow, FrameGraph::eShaderResource);
+
+		if (!graph.Compile() || graph.IsCulled(shadowPass) != (debugView != 0) || graph.IsCulled(gbufferPass) || graph.IsCulled(transparentPass))
+			++errors;
+	}
+
+	// -- Random graphs : invariants -- //
+	TestRandom random(0x1234567);
+
+	static const FrameGraph::EResourceState readStates[] = { FrameGraph::eShaderResource, FrameGraph::eDepthRead, FrameGraph::eCopySource };
+	static const FrameGraph::EResourceState writeStates[] = { FrameGraph::eRenderTarget, FrameGraph::eDepthWrite, FrameGraph::eCopyDest };
+	UINT64 heapSize = 0, unaliasedSize = 0;
+
+	for (UINT g = 0; g < graphCount; ++g)
+	{
+		graph.Reset();
+
+		const UINT resourceCount	= 2 + random.Index(10);
+		const UINT passCount		= 2 + random.Index(12);
+		std::vector<bool> written(resourceCount, false);
+		const FrameGraph::ResourceId output = graph.ImportResource("Output", FrameGraph::ePresent, FrameGraph::ePresent, true);
+
+		for (UINT r = 0; r < resourceCount; ++r)
+		{
+			desc.Size = (1 + random.Index(16)) * 0x10000;
+			graph.CreateTexture("T", desc);
+		}
+
+		for (UINT p = 0; p < passCount; ++p)
+		{
+			const FrameGraph::PassId pass = graph.AddPass("P", nullptr, random.Index(8) == 0);
+			std::vector<bool> used(resourceCount, false);
+
+			// read written resources only
+			for (UINT i = random.Index(3); i > 0; --i)
+			{
+				const UINT r = random.Index(resourceCount);
+				if (written[r] && !used[r])
+				{
+					graph.Read(pass, r + 1, readStates[random.Index(_countof(readStates))]);
+					used[r] = true;
+				}
+			}
+
+			for (UINT i = 1 + random.Index(2); i > 0; --i)
+			{
+				const UINT r = random.Index(resourceCount);
+				if (!used[r])
+				{
+					graph.Write(pass, r + 1, writeStates[random.Index(_countof(writeStates))]);
+					used[r] = written[r] = true;
+				}
+			}
+
+			if (random.Index(4) == 0)
+				graph.Write(pass, output, FrameGraph::eRenderTarget);
+		}
+
+		if (!graph.Compile())
+		{
+			++errors;
+			continue;
+		}
+
+		heapSize += graph.GetHeapSize();
+		unaliasedSize += graph.GetUnaliasedSize();
+
+		// resources alive at the same time do not share memory
+		for (FrameGraph::ResourceId a = 1; a <= resourceCount; ++a)
+		{
+			for (FrameGraph::ResourceId b = a + 1; b <= resourceCount && graph.IsAllocated(a); ++b)
+			{
+				if (!graph.IsAllocated(b))
+					continue;
+
+				const bool timeOverlap = graph.GetFirstUse(a) <= graph.GetLastUse(b) && graph.GetFirstUse(b) <= graph.GetLastUse(a);
+				const bool memoryOverlap = graph.GetHeapOffset(a) < graph.GetHeapOffset(b) + graph.GetTextureDesc(b).Size
+					&& graph.GetHeapOffset(b) < graph.GetHeapOffset(a) + graph.GetTextureDesc(a).Size;
+
+				if (timeOverlap && memoryOverlap)
+					++errors;
+			}
+		}
+
+		if (graph.GetHeapSize() > graph.GetUnaliasedSize())
+			++errors;
+
+		// resources sharing memory are aliased : aliasing barrier at their first use
+		for (FrameGraph::ResourceId a = 1; a <= resourceCount; ++a)
+		{
+			if (!graph.IsAllocated(a))
+				continue;
+
+			bool shared = false;
+
+			for (FrameGraph::ResourceId b = 1; b <= resourceCount && !shared; ++b)
+			{
+				shared = b != a && graph.IsAllocated(b)
+					&& graph.GetHeapOffset(a) < graph.GetHeapOffset(b) + graph.GetTextureDesc(b).Size
+					&& graph.GetHeapOffset(b) < graph.GetHeapOffset(a) + graph.GetTextureDesc(a).Size;
+			}
+
+			const std::vector<FrameGraph::Barrier> & barriers = graph.GetBarriers(graph.GetFirstUse(a));
+			const bool haveBarrier = std::find_if(barriers.begin(), barriers.end(), [a](const FrameGraph::Barrier & i_Barrier)
+			{
+				return i_Barrier.Type == FrameGraph::Barrier::eAliasing && i_Barrier.Resource == a;
+			}) != barriers.end();
+
+			if (graph.IsAliased(a) != shared || haveBarrier != shared)
+				++errors;
+		}
+
+		// replay the barriers : each use find the resource in the expected state
+		std::vector<FrameGraph::EResourceState> states(graph.GetResourceCount());
+		for (FrameGraph::ResourceId r = 0; r < graph.GetResourceCount(); ++r)
+		{
+			states[r] = graph.GetInitialState(r);
+		}
+
+		UINT position = 0;
+		graph.Execute([&](FrameGraph::PassId i_Pass, const std::vector<FrameGraph::Barrier> & i_Barriers)
+		{
+			// batches in the execution order (empty batches are skipped), then the final barriers
+			const std::vector<FrameGraph::PassId> & order = graph.GetExecutionOrder();
+			while (position < order.size() && &graph.GetBarriers(position) != &i_Barriers)
+				++position;
+
+			const FrameGraph::PassId expected = (position < order.size()) ? order[position++] : FrameGraph::InvalidId;
+			if (i_Pass != expected || (i_Pass == FrameGraph::InvalidId && &i_Barriers != &graph.GetFinalBarriers()))
+				++errors;
+
+			for (size_t i = 0; i < i_Barriers.size(); ++i)
+			{
+				const FrameGraph::Barrier & barrier = i_Barriers[i];
+
+				if (barrier.Type != FrameGraph::Barrier::eTransition)
+					continue;
+
+				if (states[barrier.Resource] != barrier.Before)
+					++errors;
+				states[barrier.Resource] = barrier.After;
+			}
+		});
+
+		for (FrameGraph::ResourceId r = 0; r < graph.GetResourceCount(); ++r)
+		{
+			if (graph.IsTransient(r) && graph.IsAllocated(r) && states[r] != graph.GetInitialState(r))
+				++errors;
+		}
+
+		if (states[output] != FrameGraph::ePresent)
+			++errors;
+	}
+
+	GetConsole()->Print("frame graph check : %u graphs, heap %llu KB (%llu KB without aliasing), %u errors", graphCount, heapSize / 1024, unaliasedSize / 1024, errors);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
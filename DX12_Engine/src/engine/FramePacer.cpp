@@ -0,0 +1,190 @@
+#include "FramePacer.h"
+
+#include "engine/Utils.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <timeapi.h>
+#else
+#include <sched.h>
+#include <time.h>
+#endif
+
+// sleep margin limits (ns)
+#define FRAME_PACER_DEFAULT_MARGIN		2'000'000
+#define FRAME_PACER_MIN_MARGIN			500'000
+#define FRAME_PACER_MARGIN_EXTRA		250'000		// added to the measured oversleep
+
+// weight of the last frame in the smoothed delta time
+#define FRAME_PACER_SMOOTHING			0.1f
+
+FramePacer::FramePacer(UINT i_FramePerSecondTarget)
+	:m_SleepMargin(FRAME_PACER_DEFAULT_MARGIN)
+	,m_DeltaTime(0.f)
+	,m_SmoothedDeltaTime(0.f)
+	,m_HistoryHead(0)
+	,m_FrameCount(0)
+	,m_MissedFrameCount(0)
+{
+#ifdef _WIN32
+	// scheduler granularity of 1 ms (15.6 ms by default)
+	timeBeginPeriod(1);
+#endif
+
+	memset(m_Histogram, 0, sizeof(m_Histogram));
+	memset(m_History, 0, sizeof(m_History));
+
+	SetTarget(i_FramePerSecondTarget);
+	Reset();
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SetTarget(UINT i_FramePerSecondTarget)
+{
+	m_FramePerSecondTarget	= i_FramePerSecondTarget;
+	m_Interval				= (i_FramePerSecondTarget != 0) ? Time(1'000'000'000 / i_FramePerSecondTarget) : Time(0);
+	m_Deadline				= Clock::GetSystemTime() + m_Interval;
+}
+
+UINT FramePacer::GetTarget() const
+{
+	return m_FramePerSecondTarget;
+}
+
+void FramePacer::Reset()
+{
+	m_LastFrame	= Clock::GetSystemTime();
+	m_Deadline	= m_LastFrame + m_Interval;
+}
+
+float FramePacer::BeginFrame()
+{
+	const Time now = Clock::GetSystemTime();
+	const Time delta = now - m_LastFrame;
+	m_LastFrame = now;
+
+	m_DeltaTime			= delta.ToSeconds();
+	m_SmoothedDeltaTime	= (m_FrameCount == 0) ? m_DeltaTime : m_SmoothedDeltaTime + (m_DeltaTime - m_SmoothedDeltaTime) * FRAME_PACER_SMOOTHING;
+
+	// statistics
+	const float milliseconds = delta.ToMilliseconds();
+	const UINT bucket = Math::Min((UINT)(milliseconds / FRAME_HISTOGRAM_BUCKET_SIZE), (UINT)FRAME_HISTOGRAM_BUCKET_COUNT - 1);
+
+	++m_Histogram[bucket];
+	m_History[m_HistoryHead]	= milliseconds;
+	m_HistoryHead				= (m_HistoryHead + 1) % FRAME_HISTORY_SIZE;
+	++m_FrameCount;
+
+	return m_DeltaTime;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+	if (m_FramePerSecondTarget == 0)
+		return;
+
+	Time now = Clock::GetSystemTime();
+
+	// too late : the pacing restarts from now
+	if (m_Deadline < now)
+	{
+		++m_MissedFrameCount;
+		m_Deadline = now + m_Interval;
+		return;
+	}
+
+	// coarse sleep
+	const Time remaining = m_Deadline - now;
+
+	if (m_SleepMargin < remaining)
+	{
+		const Time requested = remaining - m_SleepMargin;
+		SleepFor(requested);
+
+		const Time slept = Clock::GetSystemTime() - now;
+		const UINT64 oversleep = (requested < slept) ? (slept - requested).m_Nanosecs : 0;
+
+		// the margin grows with the oversleep and decreases slowly
+		const UINT64 margin = Math::Max(oversleep + FRAME_PACER_MARGIN_EXTRA, m_SleepMargin.m_Nanosecs - m_SleepMargin.m_Nanosecs / 16);
+		m_SleepMargin = Time(Math::Min(Math::Max(margin, (UINT64)FRAME_PACER_MIN_MARGIN), m_Interval.m_Nanosecs));
+	}
+
+	// precise end : yield until the deadline
+	now = Clock::GetSystemTime();
+
+	while (now < m_Deadline)
+	{
+		YieldThread();
+		now = Clock::GetSystemTime();
+	}
+
+	m_Deadline = m_Deadline + m_Interval;
+}
+
+float FramePacer::GetDeltaTime() const
+{
+	return m_DeltaTime;
+}
+
+float FramePacer::GetSmoothedDeltaTime() const
+{
+	return m_SmoothedDeltaTime;
+}
+
+const UINT * FramePacer::GetHistogram() const
+{
+	return m_Histogram;
+}
+
+const float * FramePacer::GetHistory() const
+{
+	return m_History;
+}
+
+UINT FramePacer::GetHistoryOffset() const
+{
+	return m_HistoryHead;
+}
+
+UINT64 FramePacer::GetFrameCount() const
+{
+	return m_FrameCount;
+}
+
+UINT64 FramePacer::GetMissedFrameCount() const
+{
+	return m_MissedFrameCount;
+}
+
+float FramePacer::GetSleepMargin() const
+{
+	return m_SleepMargin.ToMilliseconds();
+}
+
+void FramePacer::SleepFor(const Time & i_Time)
+{
+#ifdef _WIN32
+	// milliseconds : the remaining time is done by the yield loop
+	Sleep((DWORD)(i_Time.m_Nanosecs / 1'000'000));
+#else
+	timespec time;
+	time.tv_sec		= (time_t)(i_Time.m_Nanosecs / 1'000'000'000);
+	time.tv_nsec	= (long)(i_Time.m_Nanosecs % 1'000'000'000);
+	nanosleep(&time, nullptr);
+#endif
+}
+
+void FramePacer::YieldThread()
+{
+#ifdef _WIN32
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
@@ -0,0 +1,60 @@
+// Frame pacer
+// wait for the deadline of the next frame : coarse sleep until a margin before the deadline, then yield until the deadline
+// the margin follows the measured oversleep of the system (granularity of the scheduler)
+// a missed deadline restarts the pacing from the current time (no burst of frames to catch up)
+// keep the statistics of the frame times : smoothed delta time, histogram and history
+
+#pragma once
+
+#include "engine/Clock.h"
+
+#define FRAME_HISTOGRAM_BUCKET_COUNT	40
+#define FRAME_HISTOGRAM_BUCKET_SIZE		1.f		// ms per bucket (the last bucket has the longer frames)
+#define FRAME_HISTORY_SIZE				128
+
+class FramePacer
+{
+public:
+	FramePacer(UINT i_FramePerSecondTarget);
+	~FramePacer();
+
+	// target (0 : no pacing)
+	void		SetTarget(UINT i_FramePerSecondTarget);
+	UINT		GetTarget() const;
+
+	// frame management
+	void		Reset();				// the next deadline starts from now
+	float		BeginFrame();			// delta time from the previous frame (in seconds)
+	void		WaitForNextFrame();		// sleep and yield until the deadline of the next frame
+
+	// statistics
+	float			GetDeltaTime() const;			// seconds
+	float			GetSmoothedDeltaTime() const;	// exponential moving average (seconds)
+	const UINT *	GetHistogram() const;			// FRAME_HISTOGRAM_BUCKET_COUNT frame counts
+	const float *	GetHistory() const;				// FRAME_HISTORY_SIZE frame times in ms (see GetHistoryOffset)
+	UINT			GetHistoryOffset() const;		// oldest frame of the history
+	UINT64			GetFrameCount() const;
+	UINT64			GetMissedFrameCount() const;	// deadlines passed before the wait
+	float			GetSleepMargin() const;			// ms
+
+	// system
+	static void		SleepFor(const Time & i_Time);	// coarse sleep (can be longer)
+	static void		YieldThread();
+
+private:
+	// pacing
+	UINT		m_FramePerSecondTarget;
+	Time		m_Interval;
+	Time		m_Deadline;
+	Time		m_SleepMargin;
+	Time		m_LastFrame;
+
+	// statistics
+	float		m_DeltaTime;
+	float		m_SmoothedDeltaTime;
+	UINT		m_Histogram[FRAME_HISTOGRAM_BUCKET_COUNT];
+	float		m_History[FRAME_HISTORY_SIZE];
+	UINT		m_HistoryHead;
+	UINT64		m_FrameCount;
+	UINT64		m_MissedFrameCount;
+};
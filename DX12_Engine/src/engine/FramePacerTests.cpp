@@ -0,0 +1,74 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <algorithm>
+#include <math.h>
+
+#include "engine/Utils.h"
+#include "engine/FramePacer.h"
+
+CFPacingCheck::CFPacingCheck()
+	:Console::Function("pacing_check", "[frame count] [fps]", "measure the accuracy of the frame pacer on empty frames (blocks the main thread)")
+{
+}
+
+bool CFPacingCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT frameCount = 144;
+	UINT target = 144;
+
+	for (size_t i = 0; i < i_CommandLine.m_Parameters.size() && i < 2; ++i)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[i]))
+			return false;
+	}
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+		frameCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	if (i_CommandLine.m_Parameters.size() > 1)
+		target = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[1]), 1);
+
+	const float interval = 1000.f / (float)target;
+	std::vector<float> errors;
+	FramePacer pacer(target);
+
+	// the first frame starts from the reset (not paced)
+	pacer.BeginFrame();
+	pacer.WaitForNextFrame();
+
+	for (UINT i = 0; i < frameCount; ++i)
+	{
+		pacer.BeginFrame();
+		errors.push_back(fabsf(pacer.GetDeltaTime() * 1000.f - interval));
+		pacer.WaitForNextFrame();
+	}
+
+	// error statistics (ms)
+	std::sort(errors.begin(), errors.end());
+	float sum = 0.f;
+
+	for (size_t i = 0; i < errors.size(); ++i)
+	{
+		sum += errors[i];
+	}
+
+	const float average		= sum / (float)errors.size();
+	const float percentile	= errors[Math::Min((size_t)((float)errors.size() * 0.99f), errors.size() - 1)];
+
+	// every frame is in the histogram
+	UINT64 histogramCount = 0;
+
+	for (UINT i = 0; i < FRAME_HISTOGRAM_BUCKET_COUNT; ++i)
+	{
+		histogramCount += pacer.GetHistogram()[i];
+	}
+
+	const bool valid = (histogramCount == pacer.GetFrameCount()) && (average < 0.25f);
+
+	GetConsole()->Print("pacing check : %u frames at %u FPS, error %.3f ms average, %.3f ms 99th, %.3f ms max, %llu missed, margin %.2f ms",
+		frameCount, target, average, percentile, errors.back(), pacer.GetMissedFrameCount(), pacer.GetSleepMargin());
+	return valid;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
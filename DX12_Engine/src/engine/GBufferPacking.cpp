@@ -0,0 +1,111 @@
+#include "GBufferPacking.h"
+
+#include "engine/Debug.h"
+#include <math.h>
+
+// helpers (HLSL intrinsics)
+static FORCEINLINE float Saturate(float i_Value)
+{
+	return (i_Value < 0.f) ? 0.f : ((i_Value > 1.f) ? 1.f : i_Value);
+}
+
+static FORCEINLINE float SignNotZero(float i_Value)
+{
+	return (i_Value >= 0.f) ? 1.f : -1.f;
+}
+
+XMFLOAT2 GBufferPacking::EncodeOctahedralNormal(const XMFLOAT3 & i_Normal)
+{
+	// project on the octahedron
+	const float l1 = fabsf(i_Normal.x) + fabsf(i_Normal.y) + fabsf(i_Normal.z);
+	float x = i_Normal.x / l1;
+	float y = i_Normal.y / l1;
+
+	// fold the lower hemisphere
+	if (i_Normal.z < 0.f)
+	{
+		const float wrapX = (1.f - fabsf(y)) * SignNotZero(x);
+		const float wrapY = (1.f - fabsf(x)) * SignNotZero(y);
+		x = wrapX;
+		y = wrapY;
+	}
+
+	return XMFLOAT2(x, y);
+}
+
+XMFLOAT3 GBufferPacking::DecodeOctahedralNormal(const XMFLOAT2 & i_Encoded)
+{
+	const float x = i_Encoded.x;
+	const float y = i_Encoded.y;
+
+	XMFLOAT3 n(x, y, 1.f - fabsf(x) - fabsf(y));
+
+	// unfold the lower hemisphere
+	const float t = Saturate(-n.z);
+	n.x += (n.x >= 0.f) ? -t : t;
+	n.y += (n.y >= 0.f) ? -t : t;
+
+	const float invLength = 1.f / sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+	return XMFLOAT3(n.x * invLength, n.y * invLength, n.z * invLength);
+}
+
+float GBufferPacking::EncodeSpecularIntensity(const XMFLOAT3 & i_Specular)
+{
+	const float intensity = (i_Specular.x > i_Specular.y) ? i_Specular.x : i_Specular.y;
+	return Saturate((intensity > i_Specular.z) ? intensity : i_Specular.z);
+}
+
+float GBufferPacking::SpecularPowerToRoughness(float i_Power)
+{
+	// blinn phong exponent to roughness : power = 2 / roughness^2 - 2
+	return sqrtf(2.f / (i_Power + 2.f));
+}
+
+float GBufferPacking::RoughnessToSpecularPower(float i_Roughness)
+{
+	const float r2 = i_Roughness * i_Roughness;
+	return 2.f / ((r2 > 1e-4f) ? r2 : 1e-4f) - 2.f;
+}
+
+float GBufferPacking::PackMaterial(float i_Roughness, UINT i_Flags)
+{
+	ASSERT(i_Flags <= 0xff);
+
+	const float roughness = floorf(Saturate(i_Roughness) * 255.f + 0.5f);
+	return (roughness + (float)(i_Flags * 256)) / 65535.f;
+}
+
+void GBufferPacking::UnpackMaterial(float i_Packed, float & o_Roughness, UINT & o_Flags)
+{
+	const UINT code = (UINT)(i_Packed * 65535.f + 0.5f);
+
+	o_Roughness = (float)(code & 0xff) / 255.f;
+	o_Flags = code >> 8;
+}
+
+UINT GBufferPacking::FloatToUnorm(float i_Value, UINT i_Bits)
+{
+	const float scale = (float)((1 << i_Bits) - 1);
+	return (UINT)floorf(Saturate(i_Value) * scale + 0.5f);
+}
+
+float GBufferPacking::UnormToFloat(UINT i_Value, UINT i_Bits)
+{
+	return (float)i_Value / (float)((1 << i_Bits) - 1);
+}
+
+INT GBufferPacking::FloatToSnorm(float i_Value, UINT i_Bits)
+{
+	const float scale = (float)((1 << (i_Bits - 1)) - 1);
+	const float value = (i_Value < -1.f) ? -1.f : ((i_Value > 1.f) ? 1.f : i_Value);
+	const float scaled = value * scale;
+
+	return (INT)((scaled >= 0.f) ? floorf(scaled + 0.5f) : -floorf(-scaled + 0.5f));
+}
+
+float GBufferPacking::SnormToFloat(INT i_Value, UINT i_Bits)
+{
+	// the smallest value is also -1
+	const float value = (float)i_Value / (float)((1 << (i_Bits - 1)) - 1);
+	return (value < -1.f) ? -1.f : value;
+}
@@ -0,0 +1,36 @@
+// packed GBuffer encoding
+// C++ mirror of the packing functions of the shaders (see Math.hlsli) : same operations in the same order
+// this is used to validate the encoding and to read back GBuffer values on the CPU
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// define
+#define			GBUFFER_FLAG_GEOMETRY		0x1		// the pixel contains geometry (must match Math.hlsli)
+
+class GBufferPacking
+{
+public:
+	// octahedral normal : unit normal to coordinates in [-1, 1] (written in a RG16 snorm target : axis are exactly stored)
+	static XMFLOAT2		EncodeOctahedralNormal(const XMFLOAT3 & i_Normal);
+	static XMFLOAT3		DecodeOctahedralNormal(const XMFLOAT2 & i_Encoded);
+
+	// specular : the color is reduced to an intensity (albedo alpha) and the exponent to a roughness
+	static float		EncodeSpecularIntensity(const XMFLOAT3 & i_Specular);
+	static float		SpecularPowerToRoughness(float i_Power);
+	static float		RoughnessToSpecularPower(float i_Roughness);
+
+	// roughness (8 bits) and flags (8 bits) shared in one R16 unorm channel
+	static float		PackMaterial(float i_Roughness, UINT i_Flags);
+	static void			UnpackMaterial(float i_Packed, float & o_Roughness, UINT & o_Flags);
+
+	// render target conversion (round to nearest as the output merger does)
+	static UINT			FloatToUnorm(float i_Value, UINT i_Bits);
+	static float		UnormToFloat(UINT i_Value, UINT i_Bits);
+	static INT			FloatToSnorm(float i_Value, UINT i_Bits);
+	static float		SnormToFloat(INT i_Value, UINT i_Bits);
+};
@@ -0,0 +1,112 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <math.h>
+
+#include "engine/Utils.h"
+#include "engine/GBufferPacking.h"
+#include "engine/TestUtils.h"
+
+CFGBufferCheck::CFGBufferCheck()
+	:Console::Function("gbuffer_check", "[sample count]", "validate the packed GBuffer encoding (normals, roughness and flags)")
+{
+}
+
+bool CFGBufferCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT sampleCount = 100000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		sampleCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	UINT errors = 0;
+
+	// -- octahedral normals : axis are exact, random normals are in the RG16 precision -- //
+	static const XMFLOAT3 axis[6] =
+	{
+		XMFLOAT3(1.f, 0.f, 0.f), XMFLOAT3(-1.f, 0.f, 0.f),
+		XMFLOAT3(0.f, 1.f, 0.f), XMFLOAT3(0.f, -1.f, 0.f),
+		XMFLOAT3(0.f, 0.f, 1.f), XMFLOAT3(0.f, 0.f, -1.f),
+	};
+
+	TestRandom random(0x1234567);
+
+	const float maxAngle = 0.1f * DegToRad;
+	float maxError = 0.f;
+
+	for (UINT i = 0; i < sampleCount + 6; ++i)
+	{
+		XMFLOAT3 normal;
+
+		if (i < 6)
+		{
+			normal = axis[i];
+		}
+		else
+		{
+			const XMVECTOR v = XMVectorSet(random.Unit() * 2.f - 1.f, random.Unit() * 2.f - 1.f, random.Unit() * 2.f - 1.f, 0.f);
+			if (XMVectorGetX(XMVector3LengthSq(v)) < 1e-6f)
+				continue;
+			XMStoreFloat3(&normal, XMVector3Normalize(v));
+		}
+
+		// write in the render target then read it back
+		const XMFLOAT2 encoded = GBufferPacking::EncodeOctahedralNormal(normal);
+		const XMFLOAT2 stored(
+			GBufferPacking::SnormToFloat(GBufferPacking::FloatToSnorm(encoded.x, 16), 16),
+			GBufferPacking::SnormToFloat(GBufferPacking::FloatToSnorm(encoded.y, 16), 16));
+		const XMFLOAT3 decoded = GBufferPacking::DecodeOctahedralNormal(stored);
+
+		if (i < 6)
+		{
+			if (decoded.x != normal.x || decoded.y != normal.y || decoded.z != normal.z)
+				++errors;
+			continue;
+		}
+
+		const float cosAngle = normal.x * decoded.x + normal.y * decoded.y + normal.z * decoded.z;
+		const float angle = acosf((cosAngle > 1.f) ? 1.f : cosAngle);
+
+		if (angle > maxAngle)
+			++errors;
+		if (angle > maxError)
+			maxError = angle;
+	}
+
+	GetConsole()->Print("normals : %u samples, max error %.4f degrees", sampleCount, maxError / DegToRad);
+
+	// -- roughness and flags : every codes are stored and read back exactly -- //
+	for (UINT roughness = 0; roughness < 256; ++roughness)
+	{
+		for (UINT flags = 0; flags < 256; ++flags)
+		{
+			const UINT code = GBufferPacking::FloatToUnorm(GBufferPacking::PackMaterial((float)roughness / 255.f, flags), 16);
+
+			float unpackedRoughness;
+			UINT unpackedFlags;
+			GBufferPacking::UnpackMaterial(GBufferPacking::UnormToFloat(code, 16), unpackedRoughness, unpackedFlags);
+
+			if (code != roughness + (flags << 8) || unpackedFlags != flags || unpackedRoughness != (float)roughness / 255.f)
+				++errors;
+		}
+	}
+
+	// -- specular power : the conversion to roughness is reversible -- //
+	for (float power = 1.f; power < 2048.f; power *= 1.1f)
+	{
+		const float roughness = GBufferPacking::SpecularPowerToRoughness(power);
+
+		if (fabsf(GBufferPacking::RoughnessToSpecularPower(roughness) - power) > power * 1e-3f)
+			++errors;
+	}
+
+	GetConsole()->Print("gbuffer check : %u errors", errors);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -0,0 +1,216 @@
+#include "GPUCulling.h"
+
+#include "engine/Utils.h"
+
+#include <math.h>
+
+void GPUCulling::ComputeWorldBounds(const XMMATRIX & i_World, const XMFLOAT4 & i_LocalSphere, XMFLOAT3 & o_Center, XMFLOAT3 & o_Extents)
+{
+	// the box of the sphere is transformed with the absolute matrix : the world box contains the transformed box
+	const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat4(&i_LocalSphere), i_World);
+	const XMVECTOR radius = XMVectorReplicate(i_LocalSphere.w);
+
+	XMVECTOR extents = XMVectorMultiply(XMVectorAbs(i_World.r[0]), radius);
+	extents = XMVectorMultiplyAdd(XMVectorAbs(i_World.r[1]), radius, extents);
+	extents = XMVectorMultiplyAdd(XMVectorAbs(i_World.r[2]), radius, extents);
+
+	XMStoreFloat3(&o_Center, center);
+	XMStoreFloat3(&o_Extents, extents);
+}
+
+void GPUCulling::SetupFrustum(CullConstants & o_Constants, const XMMATRIX & i_ViewProjection)
+{
+	// planes are extracted from the columns of the matrix (same as ShadowCascade::ExtractFrustumPlanes)
+	const XMMATRIX m = XMMatrixTranspose(i_ViewProjection);
+
+	XMVECTOR planes[6];
+	planes[0] = XMVectorAdd(m.r[3], m.r[0]);		// left
+	planes[1] = XMVectorSubtract(m.r[3], m.r[0]);	// right
+	planes[2] = XMVectorAdd(m.r[3], m.r[1]);		// bottom
+	planes[3] = XMVectorSubtract(m.r[3], m.r[1]);	// top
+	planes[4] = m.r[2];								// near (z in [0, 1])
+	planes[5] = XMVectorSubtract(m.r[3], m.r[2]);	// far
+
+	for (UINT i = 0; i < 6; ++i)
+	{
+		XMStoreFloat4(&o_Constants.Planes[i], XMPlaneNormalize(planes[i]));
+	}
+}
+
+bool GPUCulling::IsInFrustum(const CullConstants & i_Constants, const XMFLOAT3 & i_Center, const XMFLOAT3 & i_Extents)
+{
+	// the box is outside when its nearest corner to the plane is behind the plane
+	for (UINT i = 0; i < 6; ++i)
+	{
+		const XMFLOAT4 & plane = i_Constants.Planes[i];
+		const float distance = plane.x * i_Center.x + plane.y * i_Center.y + plane.z * i_Center.z + plane.w;
+		const float radius = fabsf(plane.x) * i_Extents.x + fabsf(plane.y) * i_Extents.y + fabsf(plane.z) * i_Extents.z;
+
+		if (distance + radius < 0.f)
+			return false;
+	}
+
+	return true;
+}
+
+bool GPUCulling::IsOccluded(const CullConstants & i_Constants, const HiZPyramid & i_HiZ, const XMFLOAT3 & i_Center, const XMFLOAT3 & i_Extents)
+{
+	const XMMATRIX viewProjection = XMMatrixTranspose(XMLoadFloat4x4(&i_Constants.HiZViewProjection));
+
+	// screen rectangle and nearest depth of the box corners
+	float minU = 1.f, minV = 1.f, maxU = 0.f, maxV = 0.f;
+	float minDepth = 1.f;
+
+	for (UINT i = 0; i < 8; ++i)
+	{
+		const XMFLOAT4 corner(
+			i_Center.x + ((i & 1) ? i_Extents.x : -i_Extents.x),
+			i_Center.y + ((i & 2) ? i_Extents.y : -i_Extents.y),
+			i_Center.z + ((i & 4) ? i_Extents.z : -i_Extents.z),
+			1.f);
+
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector4Transform(XMLoadFloat4(&corner), viewProjection));
+
+		// a corner behind the camera : the box cross the near plane
+		if (clip.w <= 0.f)
+			return false;
+
+		const float u = clip.x / clip.w * 0.5f + 0.5f;
+		const float v = clip.y / clip.w * -0.5f + 0.5f;
+
+		minU = Math::Min(minU, u);
+		minV = Math::Min(minV, v);
+		maxU = Math::Max(maxU, u);
+		maxV = Math::Max(maxV, v);
+		minDepth = Math::Min(minDepth, clip.z / clip.w);
+	}
+
+	// pixels of the rectangle in the mip 0
+	minU = Math::Min(Math::Max(minU, 0.f), 1.f);
+	minV = Math::Min(Math::Max(minV, 0.f), 1.f);
+	maxU = Math::Min(Math::Max(maxU, 0.f), 1.f);
+	maxV = Math::Min(Math::Max(maxV, 0.f), 1.f);
+
+	const UINT width = (UINT)i_Constants.HiZSize.x;
+	const UINT height = (UINT)i_Constants.HiZSize.y;
+	const UINT x0 = Math::Min((UINT)(minU * (float)width), width - 1);
+	const UINT y0 = Math::Min((UINT)(minV * (float)height), height - 1);
+	const UINT x1 = Math::Min((UINT)(maxU * (float)width), width - 1);
+	const UINT y1 = Math::Min((UINT)(maxV * (float)height), height - 1);
+
+	// the first mip where the rectangle covers 2x2 texels (the texels of the last row and column cover the remaining pixels)
+	UINT mip = 0;
+	UINT mipWidth = width, mipHeight = height;
+	UINT tx0 = x0, ty0 = y0, tx1 = x1, ty1 = y1;
+
+	while (mip + 1 < i_Constants.HiZMipCount && (tx1 - tx0 > 1 || ty1 - ty0 > 1))
+	{
+		++mip;
+		mipWidth = GetMipSize(width, mip);
+		mipHeight = GetMipSize(height, mip);
+		tx0 = Math::Min(x0 >> mip, mipWidth - 1);
+		ty0 = Math::Min(y0 >> mip, mipHeight - 1);
+		tx1 = Math::Min(x1 >> mip, mipWidth - 1);
+		ty1 = Math::Min(y1 >> mip, mipHeight - 1);
+	}
+
+	const std::vector<float> & texels = i_HiZ.Mips[mip];
+	const float hiz = Math::Max(
+		Math::Max(texels[ty0 * mipWidth + tx0], texels[ty0 * mipWidth + tx1]),
+		Math::Max(texels[ty1 * mipWidth + tx0], texels[ty1 * mipWidth + tx1]));
+
+	// the nearest point of the box is behind the farthest occluder of the rectangle
+	return minDepth > hiz;
+}
+
+UINT GPUCulling::CullInstances(const CullConstants & i_Constants, const HiZPyramid * i_HiZ, const InstanceRecord * i_Instances, DrawArguments * io_Arguments, UINT * o_Visible)
+{
+	// one thread per instance : the instance count is incremented with an atomic on the GPU
+	UINT visibleCount = 0;
+
+	for (UINT i = 0; i < i_Constants.InstanceCount; ++i)
+	{
+		const InstanceRecord & instance = i_Instances[i];
+
+		if (!IsInFrustum(i_Constants, instance.Center, instance.Extents))
+			continue;
+
+		if (i_Constants.OcclusionEnabled != 0 && i_HiZ != nullptr && IsOccluded(i_Constants, *i_HiZ, instance.Center, instance.Extents))
+			continue;
+
+		DrawArguments & arguments = io_Arguments[instance.Batch];
+		const UINT slot = arguments.InstanceCount++;
+
+		o_Visible[arguments.FirstInstance + slot] = i;
+		++visibleCount;
+	}
+
+	return visibleCount;
+}
+
+UINT GPUCulling::GetMipCount(UINT i_Width, UINT i_Height)
+{
+	UINT count = 1;
+	UINT size = Math::Max(i_Width, i_Height);
+
+	while (size > 1)
+	{
+		size >>= 1;
+		++count;
+	}
+
+	return count;
+}
+
+UINT GPUCulling::GetMipSize(UINT i_Size, UINT i_Mip)
+{
+	return Math::Max(i_Size >> i_Mip, 1u);
+}
+
+void GPUCulling::BuildHiZMip(const float * i_Source, UINT i_SourceWidth, UINT i_SourceHeight, float * o_Destination, UINT i_Width, UINT i_Height)
+{
+	for (UINT y = 0; y < i_Height; ++y)
+	{
+		for (UINT x = 0; x < i_Width; ++x)
+		{
+			// 2x2 texels, the last texel of a row or column also reduce the remaining texel of an odd size
+			const UINT sx0 = x * 2, sy0 = y * 2;
+			const UINT sx1 = (x == i_Width - 1) ? i_SourceWidth - 1 : sx0 + 1;
+			const UINT sy1 = (y == i_Height - 1) ? i_SourceHeight - 1 : sy0 + 1;
+
+			float depth = 0.f;
+
+			for (UINT sy = Math::Min(sy0, i_SourceHeight - 1); sy <= sy1; ++sy)
+			{
+				for (UINT sx = Math::Min(sx0, i_SourceWidth - 1); sx <= sx1; ++sx)
+				{
+					depth = Math::Max(depth, i_Source[sy * i_SourceWidth + sx]);
+				}
+			}
+
+			o_Destination[y * i_Width + x] = depth;
+		}
+	}
+}
+
+void GPUCulling::BuildHiZ(const float * i_Depth, UINT i_Width, UINT i_Height, HiZPyramid & o_HiZ)
+{
+	const UINT mipCount = GetMipCount(i_Width, i_Height);
+
+	o_HiZ.Width = i_Width;
+	o_HiZ.Height = i_Height;
+	o_HiZ.Mips.resize(mipCount);
+
+	// mip 0 is a copy of the depth buffer
+	o_HiZ.Mips[0].assign(i_Depth, i_Depth + i_Width * i_Height);
+
+	for (UINT mip = 1; mip < mipCount; ++mip)
+	{
+		const UINT sourceWidth = GetMipSize(i_Width, mip - 1), sourceHeight = GetMipSize(i_Height, mip - 1);
+		const UINT width = GetMipSize(i_Width, mip), height = GetMipSize(i_Height, mip);
+
+		o_HiZ.Mips[mip].resize(width * height);
+		BuildHiZMip(o_HiZ.Mips[mip - 1].data(), sourceWidth, sourceHeight, o_HiZ.Mips[mip].data(), width, height);
+	}
+}
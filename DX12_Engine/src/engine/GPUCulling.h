@@ -0,0 +1,82 @@
+// GPU driven culling
+// C++ mirror of the culling kernels of the shaders (see Culling.hlsli) : same operations in the same order
+// the instances of the frame are records of one buffer, each record belongs to a batch (one indirect draw : mesh and pipeline state)
+// the culling kernel tests the world box of each instance against the view frustum and the Hi-Z pyramid of the previous frame
+// then compacts the visible instances : the instance count of the batch is incremented and the instance is written in the range of the batch
+// the Hi-Z pyramid is the max depth of the depth buffer (depth 1 is far), each mip reduce 2x2 texels (and the last row/column of odd sizes)
+// this is used to validate the kernels on the CPU (see gpu_culling_check), the GPU side is DX12GPUCulling
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+#include <vector>
+
+using namespace DirectX;
+
+// define
+#define			GPU_CULLING_GROUP_SIZE			64		// instances culled by a thread group (must match CullInstancesCS.hlsl)
+#define			GPU_CULLING_HIZ_GROUP_SIZE		8		// texels per axis reduced by a thread group (must match BuildHiZCS.hlsl)
+
+class GPUCulling
+{
+public:
+	// instance of the frame (same layout in Culling.hlsli)
+	struct InstanceRecord
+	{
+		XMFLOAT4X4		World;			// transposed world matrix
+		XMFLOAT3		Center;			// world bounding box
+		UINT			Batch;
+		XMFLOAT3		Extents;
+		UINT			MaterialBlock;	// parameter block of the material (see DX12MaterialParameterBuffer)
+		UINT			FirstBone;		// skinning palette of the animator (skinned meshes only)
+		UINT			Padding[3];
+	};
+
+	// indirect draw arguments of a batch : read as indexed or non indexed draw arguments (see DX12GPUCulling)
+	struct DrawArguments
+	{
+		UINT			CountPerInstance;	// index or vertex count
+		UINT			InstanceCount;		// visible instances, incremented by the culling
+		UINT			StartLocation;
+		INT				BaseVertex;			// start instance of a non indexed draw (0)
+		UINT			StartInstance;
+		UINT			FirstInstance;		// range of the batch in the visible instance list (not read by the draw)
+	};
+
+	// culling constants (same layout in Culling.hlsli)
+	struct CullConstants
+	{
+		XMFLOAT4		Planes[6];			// normalized view frustum planes (inside is positive)
+		XMFLOAT4X4		HiZViewProjection;	// transposed view projection of the Hi-Z pyramid (previous frame)
+		XMFLOAT2		HiZSize;			// mip 0 size
+		UINT			HiZMipCount;
+		UINT			HiZIndex;			// bindless index of the pyramid
+		UINT			InstanceCount;
+		UINT			OcclusionEnabled;	// no pyramid for the first frame
+		UINT			Padding[2];
+	};
+
+	// Hi-Z pyramid on the CPU
+	struct HiZPyramid
+	{
+		UINT								Width = 0;
+		UINT								Height = 0;
+		std::vector<std::vector<float>>		Mips;	// max depth, mip 0 is the depth buffer
+	};
+
+	// bounds
+	static void		ComputeWorldBounds(const XMMATRIX & i_World, const XMFLOAT4 & i_LocalSphere, XMFLOAT3 & o_Center, XMFLOAT3 & o_Extents);	// world box of the local bounding sphere box
+	static void		SetupFrustum(CullConstants & o_Constants, const XMMATRIX & i_ViewProjection);
+
+	// kernels
+	static bool		IsInFrustum(const CullConstants & i_Constants, const XMFLOAT3 & i_Center, const XMFLOAT3 & i_Extents);
+	static bool		IsOccluded(const CullConstants & i_Constants, const HiZPyramid & i_HiZ, const XMFLOAT3 & i_Center, const XMFLOAT3 & i_Extents);
+	static UINT		CullInstances(const CullConstants & i_Constants, const HiZPyramid * i_HiZ, const InstanceRecord * i_Instances, DrawArguments * io_Arguments, UINT * o_Visible);	// return the visible instance count
+
+	// Hi-Z pyramid
+	static UINT		GetMipCount(UINT i_Width, UINT i_Height);
+	static UINT		GetMipSize(UINT i_Size, UINT i_Mip);
+	static void		BuildHiZMip(const float * i_Source, UINT i_SourceWidth, UINT i_SourceHeight, float * o_Destination, UINT i_Width, UINT i_Height);
+	static void		BuildHiZ(const float * i_Depth, UINT i_Width, UINT i_Height, HiZPyramid & o_HiZ);
+};
@@ -0,0 +1,250 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <algorithm>
+#include <float.h>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/Engine.h"
+#include "engine/RenderList.h"
+#include "engine/GPUCulling.h"
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12GPUCulling.h"
+#include "engine/TestUtils.h"
+
+CFGPUCullingCheck::CFGPUCullingCheck()
+	:Console::Function("gpu_culling_check", "[instance count]", "check the GPU culling kernels on the CPU (frustum, Hi-Z and compaction) and measure the culling")
+{
+}
+
+bool CFGPUCullingCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT instanceCount = 16384;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		instanceCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	const UINT batchCount = 64;
+	const UINT width = 250, height = 141;	// odd sizes : the last texels of the mips reduce 3 texels
+	UINT errors = 0;
+	TestRandom random(1);
+
+	// view of the culling
+	const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.f, 0.f, -60.f, 1.f), XMVectorZero(), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	const XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)width / (float)height, 0.1f, 200.f);
+	const XMMATRIX viewProjection = view * projection;
+
+	GPUCulling::CullConstants constants = {};
+	GPUCulling::SetupFrustum(constants, viewProjection);
+	XMStoreFloat4x4(&constants.HiZViewProjection, XMMatrixTranspose(viewProjection));
+	constants.HiZSize			= XMFLOAT2((float)width, (float)height);
+	constants.HiZMipCount		= GPUCulling::GetMipCount(width, height);
+	constants.InstanceCount		= instanceCount;
+	constants.OcclusionEnabled	= 1;
+
+	// depth buffer : far background and random occluders
+	std::vector<float> depth(width * height, 1.f);
+
+	for (UINT i = 0; i < 24; ++i)
+	{
+		const UINT x0 = (UINT)random.Range(0.f, (float)width), y0 = (UINT)random.Range(0.f, (float)height);
+		const UINT x1 = Math::Min(x0 + (UINT)random.Range(4.f, 80.f), width), y1 = Math::Min(y0 + (UINT)random.Range(4.f, 60.f), height);
+		const float occluderDepth = random.Range(0.9f, 0.999f);
+
+		for (UINT y = y0; y < y1; ++y)
+		{
+			for (UINT x = x0; x < x1; ++x)
+			{
+				depth[y * width + x] = Math::Min(depth[y * width + x], occluderDepth);
+			}
+		}
+	}
+
+	GPUCulling::HiZPyramid hiz;
+	GPUCulling::BuildHiZ(depth.data(), width, height, hiz);
+
+	// the texels of each mip are the max of the pixels they cover
+	for (UINT mip = 0; mip < constants.HiZMipCount; ++mip)
+	{
+		const UINT mipWidth = GPUCulling::GetMipSize(width, mip), mipHeight = GPUCulling::GetMipSize(height, mip);
+
+		for (UINT y = 0; y < height; ++y)
+		{
+			for (UINT x = 0; x < width; ++x)
+			{
+				const UINT texel = Math::Min(y >> mip, mipHeight - 1) * mipWidth + Math::Min(x >> mip, mipWidth - 1);
+
+				if (hiz.Mips[mip][texel] < depth[y * width + x])
+					++errors;
+			}
+		}
+	}
+
+	if (hiz.Mips.back().size() != 1 || hiz.Mips.back()[0] != 1.f)
+		++errors;
+
+	// random instances in batches
+	std::vector<GPUCulling::InstanceRecord> instances(instanceCount);
+	std::vector<GPUCulling::DrawArguments> templates(batchCount);
+	std::vector<UINT> batchSizes(batchCount, 0);
+
+	for (UINT i = 0; i < instanceCount; ++i)
+	{
+		const XMMATRIX world = XMMatrixScaling(random.Range(0.5f, 2.f), random.Range(0.5f, 2.f), random.Range(0.5f, 2.f))
+			* XMMatrixRotationRollPitchYaw(random.Range(0.f, XM_2PI), random.Range(0.f, XM_2PI), 0.f)
+			* XMMatrixTranslation(random.Range(-120.f, 120.f), random.Range(-80.f, 80.f), random.Range(-40.f, 160.f));
+		const XMFLOAT4 sphere(random.Range(-0.5f, 0.5f), random.Range(-0.5f, 0.5f), random.Range(-0.5f, 0.5f), random.Range(0.2f, 4.f));
+
+		GPUCulling::InstanceRecord & instance = instances[i];
+		XMStoreFloat4x4(&instance.World, XMMatrixTranspose(world));
+		GPUCulling::ComputeWorldBounds(world, sphere, instance.Center, instance.Extents);
+		instance.Batch			= (UINT)random.Range(0.f, (float)batchCount) % batchCount;
+		instance.MaterialBlock	= 0;
+		instance.FirstBone		= 0;
+
+		++batchSizes[instance.Batch];
+	}
+
+	for (UINT i = 0, first = 0; i < batchCount; ++i)
+	{
+		templates[i] = { 36, 0, 0, 0, 0, first };
+		first += batchSizes[i];
+	}
+
+	// reference : brute force tests on the box corners and the depth pixels
+	std::vector<std::vector<UINT>> expected(batchCount);
+	UINT frustumCulled = 0, occlusionCulled = 0;
+
+	for (UINT i = 0; i < instanceCount; ++i)
+	{
+		const GPUCulling::InstanceRecord & instance = instances[i];
+
+		XMFLOAT3 corners[8];
+		for (UINT c = 0; c < 8; ++c)
+		{
+			corners[c] = XMFLOAT3(instance.Center.x + ((c & 1) ? instance.Extents.x : -instance.Extents.x),
+				instance.Center.y + ((c & 2) ? instance.Extents.y : -instance.Extents.y),
+				instance.Center.z + ((c & 4) ? instance.Extents.z : -instance.Extents.z));
+		}
+
+		// outside when all the corners are behind a plane (a tolerance for the rounding of the boundary cases)
+		bool outside = false, inside = true;
+
+		for (UINT p = 0; p < 6; ++p)
+		{
+			const XMFLOAT4 & plane = constants.Planes[p];
+			float maxDistance = -FLT_MAX;
+
+			for (UINT c = 0; c < 8; ++c)
+			{
+				maxDistance = Math::Max(maxDistance, plane.x * corners[c].x + plane.y * corners[c].y + plane.z * corners[c].z + plane.w);
+			}
+
+			outside |= (maxDistance < -1e-3f);
+			inside &= (maxDistance > 1e-3f);
+		}
+
+		const bool inFrustum = GPUCulling::IsInFrustum(constants, instance.Center, instance.Extents);
+
+		if ((inFrustum && outside) || (!inFrustum && inside))
+			++errors;
+
+		if (!inFrustum)
+		{
+			++frustumCulled;
+			continue;
+		}
+
+		// an occluded box is behind all the pixels of its screen rectangle
+		if (GPUCulling::IsOccluded(constants, hiz, instance.Center, instance.Extents))
+		{
+			float minU = 1.f, minV = 1.f, maxU = 0.f, maxV = 0.f, minDepth = 1.f;
+
+			for (UINT c = 0; c < 8; ++c)
+			{
+				XMFLOAT4 clip;
+				XMStoreFloat4(&clip, XMVector4Transform(XMVectorSet(corners[c].x, corners[c].y, corners[c].z, 1.f), viewProjection));
+
+				minU = Math::Min(minU, clip.x / clip.w * 0.5f + 0.5f);
+				maxU = Math::Max(maxU, clip.x / clip.w * 0.5f + 0.5f);
+				minV = Math::Min(minV, clip.y / clip.w * -0.5f + 0.5f);
+				maxV = Math::Max(maxV, clip.y / clip.w * -0.5f + 0.5f);
+				minDepth = Math::Min(minDepth, clip.z / clip.w);
+			}
+
+			const UINT x0 = Math::Min((UINT)(Math::Min(Math::Max(minU, 0.f), 1.f) * width), width - 1);
+			const UINT x1 = Math::Min((UINT)(Math::Min(Math::Max(maxU, 0.f), 1.f) * width), width - 1);
+			const UINT y0 = Math::Min((UINT)(Math::Min(Math::Max(minV, 0.f), 1.f) * height), height - 1);
+			const UINT y1 = Math::Min((UINT)(Math::Min(Math::Max(maxV, 0.f), 1.f) * height), height - 1);
+
+			for (UINT y = y0; y <= y1; ++y)
+			{
+				for (UINT x = x0; x <= x1; ++x)
+				{
+					if (depth[y * width + x] >= minDepth)
+						++errors;
+				}
+			}
+
+			++occlusionCulled;
+			continue;
+		}
+
+		expected[instance.Batch].push_back(i);
+	}
+
+	// compaction : each batch contains its visible instances (any order on the GPU)
+	std::vector<GPUCulling::DrawArguments> arguments(templates);
+	std::vector<UINT> visible(instanceCount, 0);
+	const UINT visibleCount = GPUCulling::CullInstances(constants, &hiz, instances.data(), arguments.data(), visible.data());
+
+	if (visibleCount != instanceCount - frustumCulled - occlusionCulled)
+		++errors;
+
+	for (UINT i = 0; i < batchCount; ++i)
+	{
+		std::vector<UINT> batch(visible.begin() + arguments[i].FirstInstance, visible.begin() + arguments[i].FirstInstance + arguments[i].InstanceCount);
+		std::sort(batch.begin(), batch.end());
+
+		if (batch != expected[i] || arguments[i].InstanceCount > batchSizes[i])
+			++errors;
+	}
+
+	// benchmark of the kernel (one thread on the CPU)
+	const UINT iterationCount = 16;
+	Clock clock;
+
+	for (UINT i = 0; i < iterationCount; ++i)
+	{
+		arguments = templates;
+		GPUCulling::CullInstances(constants, &hiz, instances.data(), arguments.data(), visible.data());
+	}
+
+	const UINT64 elapsed = clock.GetElaspedTime().ToMicroseconds();
+
+	GetConsole()->Print("gpu culling check : %u instances in %u batches, %u visible, %u frustum culled, %u occluded, %u errors",
+		instanceCount, batchCount, visibleCount, frustumCulled, occlusionCulled, errors);
+	GetConsole()->Print("gpu culling check : %llu us per culling on the CPU (%.1f ns per instance), Hi-Z %ux%u with %u mips",
+		elapsed / iterationCount, (float)elapsed * 1000.f / (float)(iterationCount * instanceCount), width, height, constants.HiZMipCount);
+
+	// culling of the renderer
+	const DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	const DX12GPUCulling * culling = render.GetGPUCulling();
+
+	if (culling != nullptr)
+	{
+		GetConsole()->Print("gpu culling : %s, occlusion %s, %u instances, %u batches max, %u batches the last frame",
+			render.GPUCullingIsEnabled() ? "enabled" : "disabled", culling->OcclusionIsEnabled() ? "enabled" : "disabled",
+			culling->GetMaxInstanceCount(), culling->GetMaxBatchCount(), Engine::GetInstance().GetRenderList()->GetIndirectBatchCount());
+	}
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -0,0 +1,278 @@
+#include "GPUProfiler.h"
+
+#include "engine/Debug.h"
+
+GPUProfiler::GPUProfiler(UINT i_FrameCount, UINT i_MaxScope, UINT i_HistorySize)
+	:m_FrameCount(i_FrameCount > 0 ? i_FrameCount : 1)
+	,m_MaxScope(i_MaxScope > 0 ? i_MaxScope : 1)
+	,m_HistorySize(i_HistorySize > 0 ? i_HistorySize : 1)
+	,m_CurrentSlot(0)
+	,m_IsRecording(false)
+	,m_ResolvedFrameCount(0)
+	,m_DroppedFrameCount(0)
+	,m_OverflowCount(0)
+{
+	m_Slots.resize(m_FrameCount);
+
+	for (size_t i = 0; i < m_Slots.size(); ++i)
+	{
+		m_Slots[i].QueryCount	= 0;
+		m_Slots[i].IsPending	= false;
+	}
+}
+
+GPUProfiler::~GPUProfiler()
+{
+}
+
+void GPUProfiler::BeginFrame(UINT i_Slot)
+{
+	ASSERT(i_Slot < m_FrameCount);
+
+	if (m_IsRecording)
+	{
+		PRINT_DEBUG("[GPUProfiler] the previous frame was not ended");
+		DEBUG_BREAK;
+	}
+
+	Slot & slot = m_Slots[i_Slot];
+
+	// the results of the slot were never read : the frame is lost
+	if (slot.IsPending)
+		++m_DroppedFrameCount;
+
+	slot.Scopes.clear();
+	slot.QueryCount	= 0;
+	slot.IsPending	= false;
+
+	m_ScopeStack.clear();
+	m_CurrentSlot	= i_Slot;
+	m_IsRecording	= true;
+}
+
+void GPUProfiler::EndFrame()
+{
+	if (!m_IsRecording)
+	{
+		PRINT_DEBUG("[GPUProfiler] end of a frame that was not began");
+		DEBUG_BREAK;
+		return;
+	}
+
+	Slot & slot = m_Slots[m_CurrentSlot];
+
+	// scopes that are not closed have no end query : they are ignored by the resolve
+	if (!m_ScopeStack.empty())
+	{
+		PRINT_DEBUG("[GPUProfiler] %u scopes are not closed at the end of the frame", (UINT)m_ScopeStack.size());
+		m_ScopeStack.clear();
+	}
+
+	slot.IsPending	= (slot.QueryCount > 0);
+	m_IsRecording	= false;
+}
+
+UINT GPUProfiler::BeginScope(const char * i_Name)
+{
+	if (!m_IsRecording)
+	{
+		PRINT_DEBUG("[GPUProfiler] scope %s is out of a frame", i_Name);
+		DEBUG_BREAK;
+		return InvalidQuery;
+	}
+
+	Slot & slot = m_Slots[m_CurrentSlot];
+
+	// the slot is full : the scope is ignored (but still has to be closed)
+	if (slot.Scopes.size() >= m_MaxScope)
+	{
+		++m_OverflowCount;
+		m_ScopeStack.push_back((UINT)InvalidQuery);
+		return InvalidQuery;
+	}
+
+	Scope scope;
+	scope.Name			= i_Name;
+	scope.Depth			= (UINT)m_ScopeStack.size();
+	scope.BeginQuery	= GetFirstQuery(m_CurrentSlot) + slot.QueryCount++;
+	scope.EndQuery		= InvalidQuery;
+
+	m_ScopeStack.push_back((UINT)slot.Scopes.size());
+	slot.Scopes.push_back(scope);
+
+	return scope.BeginQuery;
+}
+
+UINT GPUProfiler::EndScope()
+{
+	if (!m_IsRecording || m_ScopeStack.empty())
+	{
+		PRINT_DEBUG("[GPUProfiler] end of a scope that was not began");
+		DEBUG_BREAK;
+		return InvalidQuery;
+	}
+
+	const UINT scopeIndex = m_ScopeStack.back();
+	m_ScopeStack.pop_back();
+
+	if (scopeIndex == InvalidQuery)
+		return InvalidQuery;
+
+	Slot & slot = m_Slots[m_CurrentSlot];
+	Scope & scope = slot.Scopes[scopeIndex];
+	scope.EndQuery = GetFirstQuery(m_CurrentSlot) + slot.QueryCount++;
+
+	return scope.EndQuery;
+}
+
+bool GPUProfiler::IsPending(UINT i_Slot) const
+{
+	ASSERT(i_Slot < m_FrameCount);
+	return m_Slots[i_Slot].IsPending;
+}
+
+UINT GPUProfiler::GetQueryCount(UINT i_Slot) const
+{
+	ASSERT(i_Slot < m_FrameCount);
+	return m_Slots[i_Slot].QueryCount;
+}
+
+UINT GPUProfiler::GetFirstQuery(UINT i_Slot) const
+{
+	// a scope is two queries
+	return i_Slot * m_MaxScope * 2;
+}
+
+void GPUProfiler::Resolve(UINT i_Slot, const UINT64 * i_Timestamps, UINT64 i_Frequency)
+{
+	ASSERT(i_Slot < m_FrameCount);
+	Slot & slot = m_Slots[i_Slot];
+
+	if (!slot.IsPending)
+		return;
+
+	slot.IsPending = false;
+
+	if (i_Frequency == 0)
+		return;
+
+	const UINT firstQuery	= GetFirstQuery(i_Slot);
+	const double toMs		= 1000.0 / (double)i_Frequency;
+
+	// timeline starts with the first timestamp of the frame (scopes can be on different command lists)
+	UINT64 frameStart = (UINT64)-1;
+
+	for (size_t i = 0; i < slot.Scopes.size(); ++i)
+	{
+		const UINT64 begin = i_Timestamps[slot.Scopes[i].BeginQuery - firstQuery];
+		frameStart = (begin < frameStart) ? begin : frameStart;
+	}
+
+	m_Timings.clear();
+
+	for (size_t i = 0; i < slot.Scopes.size(); ++i)
+	{
+		const Scope & scope = slot.Scopes[i];
+
+		if (scope.EndQuery == InvalidQuery)
+			continue;
+
+		const UINT64 begin	= i_Timestamps[scope.BeginQuery - firstQuery];
+		const UINT64 end	= i_Timestamps[scope.EndQuery - firstQuery];
+
+		Timing timing;
+		timing.Name		= scope.Name;
+		timing.Depth	= scope.Depth;
+		timing.Start	= (float)((double)(begin - frameStart) * toMs);
+		timing.Duration	= (end > begin) ? (float)((double)(end - begin) * toMs) : 0.f;
+
+		m_Timings.push_back(timing);
+		PushStatistic(timing.Name, timing.Depth, timing.Duration);
+	}
+
+	++m_ResolvedFrameCount;
+}
+
+UINT GPUProfiler::GetFrameCount() const
+{
+	return m_FrameCount;
+}
+
+UINT GPUProfiler::GetMaxQueryCount() const
+{
+	return m_FrameCount * m_MaxScope * 2;
+}
+
+const std::vector<GPUProfiler::Timing> & GPUProfiler::GetTimings() const
+{
+	return m_Timings;
+}
+
+const std::vector<GPUProfiler::Statistic> & GPUProfiler::GetStatistics() const
+{
+	return m_Statistics;
+}
+
+const GPUProfiler::Statistic * GPUProfiler::GetStatistic(const char * i_Name) const
+{
+	for (size_t i = 0; i < m_Statistics.size(); ++i)
+	{
+		if (m_Statistics[i].Name == i_Name)
+			return &m_Statistics[i];
+	}
+
+	return nullptr;
+}
+
+UINT64 GPUProfiler::GetResolvedFrameCount() const
+{
+	return m_ResolvedFrameCount;
+}
+
+UINT64 GPUProfiler::GetDroppedFrameCount() const
+{
+	return m_DroppedFrameCount;
+}
+
+UINT64 GPUProfiler::GetOverflowCount() const
+{
+	return m_OverflowCount;
+}
+
+void GPUProfiler::PushStatistic(const std::string & i_Name, UINT i_Depth, float i_Duration)
+{
+	Statistic * statistic = const_cast<Statistic *>(GetStatistic(i_Name.c_str()));
+
+	// new scope
+	if (statistic == nullptr)
+	{
+		m_Statistics.push_back(Statistic());
+		statistic = &m_Statistics.back();
+
+		statistic->Name		= i_Name;
+		statistic->Depth	= i_Depth;
+		statistic->History.resize(m_HistorySize, 0.f);
+		statistic->Head		= 0;
+		statistic->Count	= 0;
+	}
+
+	statistic->History[statistic->Head] = i_Duration;
+	statistic->Head		= (statistic->Head + 1) % m_HistorySize;
+	statistic->Count	= (statistic->Count < m_HistorySize) ? statistic->Count + 1 : m_HistorySize;
+	statistic->Last		= i_Duration;
+
+	// the ring is filled from the first sample : the valid samples are the first ones until it is full
+	float sum = 0.f;
+	statistic->Min = statistic->Max = i_Duration;
+
+	for (UINT i = 0; i < statistic->Count; ++i)
+	{
+		const float sample = statistic->History[i];
+
+		sum += sample;
+		statistic->Min = (sample < statistic->Min) ? sample : statistic->Min;
+		statistic->Max = (sample > statistic->Max) ? sample : statistic->Max;
+	}
+
+	statistic->Average = sum / (float)statistic->Count;
+}
@@ -0,0 +1,108 @@
+// GPU profiler
+// scopes of a frame are two timestamp queries (begin and end) in the slot of the frame in flight
+// a slot is resolved when the GPU finished the frame (the frame index is reused) : the CPU never waits for the queries
+// durations of the scopes are accumulated in rolling statistics (per scope name)
+// this is the logic only : queries are written and read back by DX12GPUProfiler
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+
+#define		MAX_PROFILER_SCOPE		32		// scopes per frame
+#define		PROFILER_HISTORY		128		// frames kept by the rolling statistics
+
+class GPUProfiler
+{
+public:
+	static const UINT	InvalidQuery = (UINT)-1;
+
+	// timing of a scope in a resolved frame
+	struct Timing
+	{
+		std::string		Name;
+		UINT			Depth;		// nested level (0 is the root scope)
+		float			Start;		// in ms from the first timestamp of the frame
+		float			Duration;	// in ms
+	};
+
+	// rolling statistics of a scope
+	struct Statistic
+	{
+		std::string			Name;
+		UINT				Depth;
+		float				Last;		// in ms
+		float				Average;
+		float				Min;
+		float				Max;
+		std::vector<float>	History;	// ring of the last durations
+		UINT				Head;		// next sample of the ring
+		UINT				Count;		// samples in the ring
+	};
+
+	GPUProfiler(UINT i_FrameCount, UINT i_MaxScope = MAX_PROFILER_SCOPE, UINT i_HistorySize = PROFILER_HISTORY);
+	~GPUProfiler();
+
+	// frame management : the slot is the frame index (only one frame is recorded at a time)
+	void		BeginFrame(UINT i_Slot);	// a pending slot is dropped (its queries are overwritten)
+	void		EndFrame();
+
+	// scopes return the query to write (InvalidQuery when the slot is full)
+	UINT		BeginScope(const char * i_Name);
+	UINT		EndScope();
+
+	// resolve
+	bool		IsPending(UINT i_Slot) const;	// the slot has recorded queries that are not resolved
+	UINT		GetQueryCount(UINT i_Slot) const;	// queries used by the slot (from the first query of the slot)
+	UINT		GetFirstQuery(UINT i_Slot) const;
+	void		Resolve(UINT i_Slot, const UINT64 * i_Timestamps, UINT64 i_Frequency);	// timestamps of the queries of the slot (GetQueryCount)
+
+	// information
+	UINT		GetFrameCount() const;
+	UINT		GetMaxQueryCount() const;	// for all the slots
+	const std::vector<Timing> &		GetTimings() const;	// scopes of the last resolved frame
+	const std::vector<Statistic> &	GetStatistics() const;
+	const Statistic *				GetStatistic(const char * i_Name) const;
+	UINT64		GetResolvedFrameCount() const;
+	UINT64		GetDroppedFrameCount() const;	// frames overwritten before their resolve
+	UINT64		GetOverflowCount() const;		// scopes ignored because the slot was full
+
+private:
+	// scope recorded in a slot
+	struct Scope
+	{
+		std::string		Name;
+		UINT			Depth;
+		UINT			BeginQuery;
+		UINT			EndQuery;
+	};
+
+	struct Slot
+	{
+		std::vector<Scope>		Scopes;
+		UINT					QueryCount;
+		bool					IsPending;
+	};
+
+	// helpers
+	void		PushStatistic(const std::string & i_Name, UINT i_Depth, float i_Duration);
+
+	// desc
+	const UINT				m_FrameCount;
+	const UINT				m_MaxScope;
+	const UINT				m_HistorySize;
+
+	// recording
+	std::vector<Slot>		m_Slots;
+	std::vector<UINT>		m_ScopeStack;		// opened scopes of the current slot
+	UINT					m_CurrentSlot;
+	bool					m_IsRecording;
+
+	// results
+	std::vector<Timing>		m_Timings;
+	std::vector<Statistic>	m_Statistics;
+	UINT64					m_ResolvedFrameCount;
+	UINT64					m_DroppedFrameCount;
+	UINT64					m_OverflowCount;
+};
@@ -0,0 +1,151 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <math.h>
+
+#include "engine/Utils.h"
+#include "engine/GPUProfiler.h"
+#include "engine/TestUtils.h"
+
+CFGPUProfilerCheck::CFGPUProfilerCheck()
+	:Console::Function("gpu_profiler_check", "[frame count]", "validate the query ring and the statistics of the GPU profiler with simulated timestamps")
+{
+}
+
+bool CFGPUProfilerCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT frameCount = 100;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		frameCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	static const UINT slotCount		= 3;
+	static const UINT maxScope		= 8;
+	static const UINT historySize	= 16;
+	static const UINT64 frequency	= 1000000;	// 1 tick is 1 us
+	static const char * passNames[] = { "Depth", "GBuffer", "Shadows", "Lights" };
+	static const UINT passCount = _countof(passNames);
+
+	GPUProfiler profiler(slotCount, maxScope, historySize);
+	std::vector<UINT64> timestamps(profiler.GetMaxQueryCount(), 0);
+	std::vector<UINT64> expected[slotCount];	// pass durations in ticks of the frame in each slot
+	std::vector<float> gbufferDurations;		// resolved GBuffer durations (in ms)
+	TestRandom random(0x1234567);
+	UINT errors = 0;
+	UINT64 gpuTime = 1000;
+
+	for (UINT frame = 0; frame < frameCount; ++frame)
+	{
+		const UINT slot = frame % slotCount;
+		const UINT firstQuery = profiler.GetFirstQuery(slot);
+
+		// the GPU finished the frame of this slot : results are read before the slot is reused
+		if (profiler.IsPending(slot))
+		{
+			profiler.Resolve(slot, &timestamps[firstQuery], frequency);
+
+			const std::vector<GPUProfiler::Timing> & timings = profiler.GetTimings();
+			UINT64 frameTicks = 0;
+
+			if (timings.size() != passCount + 1 || timings[0].Name != "Frame" || timings[0].Depth != 0 || timings[0].Start != 0.f)
+				++errors;
+
+			for (UINT pass = 0; pass < passCount && pass + 1 < timings.size(); ++pass)
+			{
+				const GPUProfiler::Timing & timing = timings[pass + 1];
+
+				if (timing.Name != passNames[pass] || timing.Depth != 1 || fabsf(timing.Duration - (float)expected[slot][pass] / 1000.f) > 1e-4f)
+					++errors;
+
+				frameTicks += expected[slot][pass];
+			}
+
+			if (!timings.empty() && fabsf(timings[0].Duration - (float)frameTicks / 1000.f) > 1e-4f)
+				++errors;
+
+			gbufferDurations.push_back((float)expected[slot][1] / 1000.f);
+		}
+
+		// record the frame : each pass is written by the simulated GPU when its query is returned
+		profiler.BeginFrame(slot);
+		expected[slot].clear();
+
+		timestamps[profiler.BeginScope("Frame")] = gpuTime;
+
+		for (UINT pass = 0; pass < passCount; ++pass)
+		{
+			const UINT64 duration = 1 + (random.Next() >> 16) % 5000;
+
+			timestamps[profiler.BeginScope(passNames[pass])] = gpuTime;
+			gpuTime += duration;
+			timestamps[profiler.EndScope()] = gpuTime;
+
+			expected[slot].push_back(duration);
+		}
+
+		timestamps[profiler.EndScope()] = gpuTime;
+		profiler.EndFrame();
+
+		gpuTime += 100;	// idle between frames
+	}
+
+	// rolling statistics of the last resolved frames
+	const GPUProfiler::Statistic * statistic = profiler.GetStatistic("GBuffer");
+
+	if (!gbufferDurations.empty())
+	{
+		const size_t first = (gbufferDurations.size() > historySize) ? gbufferDurations.size() - historySize : 0;
+		float sum = 0.f, minimum = gbufferDurations[first], maximum = gbufferDurations[first];
+
+		for (size_t i = first; i < gbufferDurations.size(); ++i)
+		{
+			sum += gbufferDurations[i];
+			minimum = Math::Min(minimum, gbufferDurations[i]);
+			maximum = Math::Max(maximum, gbufferDurations[i]);
+		}
+
+		const float average = sum / (float)(gbufferDurations.size() - first);
+
+		if (statistic == nullptr || statistic->Count != (UINT)(gbufferDurations.size() - first) || fabsf(statistic->Average - average) > 1e-3f
+			|| fabsf(statistic->Min - minimum) > 1e-4f || fabsf(statistic->Max - maximum) > 1e-4f || fabsf(statistic->Last - gbufferDurations.back()) > 1e-4f)
+			++errors;
+	}
+
+	if (profiler.GetResolvedFrameCount() != gbufferDurations.size() || profiler.GetDroppedFrameCount() != 0)
+		++errors;
+
+	// a pending slot reused without resolve is dropped
+	const UINT slot = frameCount % slotCount;
+	const bool pending = profiler.IsPending(slot);
+	profiler.BeginFrame(slot);
+
+	// scopes over the slot capacity are ignored but stay balanced
+	UINT validQueries = 0;
+
+	for (UINT i = 0; i < maxScope + 2; ++i)
+	{
+		if (profiler.BeginScope("Overflow") != GPUProfiler::InvalidQuery)
+			++validQueries;
+	}
+
+	for (UINT i = 0; i < maxScope + 2; ++i)
+	{
+		if (profiler.EndScope() != GPUProfiler::InvalidQuery)
+			++validQueries;
+	}
+
+	profiler.EndFrame();
+
+	if (profiler.GetDroppedFrameCount() != (pending ? 1u : 0u) || profiler.GetOverflowCount() != 2 || validQueries != maxScope * 2 || profiler.GetQueryCount(slot) != maxScope * 2)
+		++errors;
+
+	GetConsole()->Print("gpu profiler check : %u frames, %llu resolved, %u errors", frameCount, profiler.GetResolvedFrameCount(), errors);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -0,0 +1,517 @@
+#include "LevelStreamer.h"
+
+#include "engine/SceneFile.h"
+#include "engine/Clock.h"
+#include "engine/Debug.h"
+#include "engine/Engine.h"
+#include "engine/CPUProfiler.h"
+#include "engine/Utils.h"
+#include "resource/ResourceManager.h"
+#include "resource/Mesh.h"
+#include "resource/Material.h"
+
+#include <algorithm>
+#include <cfloat>
+
+// smallest measured time to delete an actor (milliseconds)
+#define STREAMING_MIN_DELETE_TIME	0.0001f
+// frames before the release of a resource (frames that can be in flight on the GPU)
+#define STREAMING_RELEASE_DELAY		3
+
+LevelStreamer::LevelStreamer(World * i_World)
+	:m_World(i_World)
+	,m_Frame(0)
+	,m_DeleteTime(0.01f)
+	,m_Reading(nullptr)
+	,m_Exit(false)
+{
+	m_Thread = std::thread(&LevelStreamer::LoaderLoop, this);
+}
+
+LevelStreamer::~LevelStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Exit = true;
+	}
+
+	m_Condition.notify_all();
+	m_Thread.join();
+
+	// the actors are deleted with the world
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+	{
+		DeleteFiles(m_Cells[i]);
+		delete m_Cells[i]->Scene;
+		delete m_Cells[i];
+	}
+}
+
+UINT LevelStreamer::AddCell(const CellDesc & i_Desc)
+{
+	Cell * cell = new Cell;
+	cell->Desc = i_Desc;
+	cell->Desc.UnloadRadius = Math::Max(i_Desc.UnloadRadius, i_Desc.LoadRadius);
+
+	m_Cells.push_back(cell);
+	return (UINT)m_Cells.size() - 1;
+}
+
+void LevelStreamer::Clear()
+{
+	// wait for the cell on the loader thread
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		m_ReadQueue.clear();
+		m_Condition.wait(lock, [this] { return m_Reading == nullptr; });
+		m_ReadDone.clear();
+	}
+
+	// the cells are deleted after the unload of all cells (the unload looks for the resources used by the other cells)
+	Clock clock;
+
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+	{
+		Cell * cell = m_Cells[i];
+
+		if (cell->State == eResolving || cell->State == eSpawning || cell->State == eLoaded)
+			BeginUnload(cell);
+		if (cell->State == eUnloading)
+			UnloadActors(cell, clock, FLT_MAX);
+	}
+
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+	{
+		DeleteFiles(m_Cells[i]);
+		delete m_Cells[i]->Scene;
+		delete m_Cells[i];
+	}
+
+	m_Cells.clear();
+}
+
+void LevelStreamer::Update(const XMFLOAT3 & i_ViewPosition, float i_Budget)
+{
+	CPU_ZONE("Level Streaming");
+
+	Clock clock;
+	++m_Frame;
+
+	m_Stats.SpawnedActors		= 0;
+	m_Stats.DeletedActors		= 0;
+	m_Stats.ReleasedResources	= 0;
+
+	// cells read by the loader thread
+	std::vector<Cell *> readCells;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		readCells.swap(m_ReadDone);
+	}
+
+	for (size_t i = 0; i < readCells.size(); ++i)
+	{
+		Cell * cell = readCells[i];
+
+		if (cell->ReadFailed)
+		{
+			// the cell is not requested again
+			PRINT_DEBUG("Error, unable to read the cell %s", cell->Desc.File.c_str());
+			DeleteFiles(cell);
+			delete cell->Scene;
+			cell->Scene = nullptr;
+			cell->State = eUnloaded;
+			continue;
+		}
+
+		// the spawn does not load resources : they are created from the files read by the loader thread
+		m_World->BeginSceneLoad(*cell->Scene, cell->Load);
+		cell->Load.Resolved = true;
+		cell->NextFile = 0;
+		cell->State = eResolving;
+	}
+
+	// load and unload requests (the cells read out of the range are unloaded when they are read)
+	const XMVECTOR view = XMLoadFloat3(&i_ViewPosition);
+
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+	{
+		Cell * cell = m_Cells[i];
+		const float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&cell->Desc.Center), view)));
+
+		if (cell->State == eUnloaded && !cell->ReadFailed && distance <= cell->Desc.LoadRadius)
+		{
+			cell->State = eReading;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_ReadQueue.push_back(cell);
+			}
+
+			m_Condition.notify_all();
+		}
+		else if ((cell->State == eResolving || cell->State == eSpawning || cell->State == eLoaded) && distance > cell->Desc.UnloadRadius)
+		{
+			BeginUnload(cell);
+		}
+	}
+
+	// delete the actors of the unloaded cells for the budget
+	for (size_t i = 0; i < m_Cells.size() && clock.GetElaspedTime().ToMilliseconds() < i_Budget; ++i)
+	{
+		if (m_Cells[i]->State == eUnloading)
+			UnloadActors(m_Cells[i], clock, i_Budget);
+	}
+
+	// create the resources then spawn the actors of the cells for the budget (checked after each resource and actor)
+	for (size_t i = 0; i < m_Cells.size() && clock.GetElaspedTime().ToMilliseconds() < i_Budget; ++i)
+	{
+		Cell * cell = m_Cells[i];
+
+		if (cell->State == eResolving)
+		{
+			while (cell->NextFile < cell->Files.size() && clock.GetElaspedTime().ToMilliseconds() < i_Budget)
+			{
+				ResolveFile(cell, cell->Files[cell->NextFile]);
+				++cell->NextFile;
+			}
+
+			if (cell->NextFile < cell->Files.size())
+				continue;
+
+			DeleteFiles(cell);
+			cell->State = eSpawning;
+		}
+
+		if (cell->State != eSpawning)
+			continue;
+
+		const UINT actorCount = (UINT)cell->Scene->GetActors().size();
+
+		while (cell->Load.NextActor < actorCount && clock.GetElaspedTime().ToMilliseconds() < i_Budget)
+		{
+			m_Stats.SpawnedActors += m_World->SpawnSceneActors(cell->Load, 1);
+		}
+
+		// the records are not needed anymore
+		if (cell->Load.NextActor == actorCount)
+		{
+			cell->State = eLoaded;
+			cell->Load.Scene = nullptr;
+			delete cell->Scene;
+			cell->Scene = nullptr;
+		}
+	}
+
+	ReleaseResources();
+
+	// stats
+	m_Stats.LoadedCells		= 0;
+	m_Stats.PendingCells	= 0;
+
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+	{
+		if (m_Cells[i]->State == eLoaded)
+			++m_Stats.LoadedCells;
+		else if (m_Cells[i]->State != eUnloaded)
+			++m_Stats.PendingCells;
+	}
+
+	m_Stats.UpdateTime = clock.GetElaspedTime().ToMilliseconds();
+}
+
+bool LevelStreamer::IsIdle() const
+{
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+	{
+		if (m_Cells[i]->State != eUnloaded && m_Cells[i]->State != eLoaded)
+			return false;
+	}
+
+	return true;
+}
+
+UINT LevelStreamer::GetCellCount() const
+{
+	return (UINT)m_Cells.size();
+}
+
+LevelStreamer::ECellState LevelStreamer::GetCellState(UINT i_Cell) const
+{
+	return m_Cells[i_Cell]->State;
+}
+
+UINT LevelStreamer::GetCellActorCount(UINT i_Cell) const
+{
+	const World::SceneLoad & load = m_Cells[i_Cell]->Load;
+	return (UINT)(load.Actors.size() - std::count(load.Actors.begin(), load.Actors.end(), nullptr));
+}
+
+const LevelStreamer::Stats & LevelStreamer::GetStats() const
+{
+	return m_Stats;
+}
+
+void LevelStreamer::LoaderLoop()
+{
+	CPUProfiler::SetThreadName("Streaming Loader");
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	while (true)
+	{
+		m_Condition.wait(lock, [this] { return m_Exit || !m_ReadQueue.empty(); });
+
+		if (m_Exit)
+			return;
+
+		Cell * cell = m_ReadQueue.front();
+		m_ReadQueue.pop_front();
+		m_Reading = cell;
+
+		const std::string file = cell->Desc.File;
+		lock.unlock();
+
+		// read and validate the file out of the lock, then the files of its resources
+		SceneFile * scene = new SceneFile;
+		std::vector<ResourceFile *> files;
+		bool read = false;
+		{
+			CPU_ZONE("Read Cell");
+			read = scene->Read(file);
+
+			if (read)
+				ReadResourceFiles(*scene, files);
+		}
+
+		lock.lock();
+		cell->Scene			= scene;
+		cell->Files.swap(files);
+		cell->ReadFailed	= !read;
+		m_Reading			= nullptr;
+		m_ReadDone.push_back(cell);
+		m_Condition.notify_all();
+	}
+}
+
+void LevelStreamer::ReadResourceFiles(const SceneFile & i_Scene, std::vector<ResourceFile *> & o_Files)
+{
+	const std::vector<SceneFile::ActorRecord> & records = i_Scene.GetActors();
+	const UINT stringCount = i_Scene.GetStringCount();
+
+	// one file per path (string index), the materials are used with a mesh only
+	std::vector<bool> added(stringCount * 2, false);
+	std::vector<ResourceFile *> materials;
+
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		const SceneFile::ActorRecord & record = records[i];
+
+		if (record.Mesh == SceneFile::InvalidIndex)
+			continue;
+
+		if (!added[record.Mesh])
+		{
+			added[record.Mesh] = true;
+
+			ResourceFile * mesh = new ResourceFile;
+			mesh->Path		= record.Mesh;
+			mesh->IsMesh	= true;
+			o_Files.push_back(mesh);
+		}
+
+		if (record.Material != SceneFile::InvalidIndex && !added[stringCount + record.Material])
+		{
+			added[stringCount + record.Material] = true;
+
+			ResourceFile * material = new ResourceFile;
+			material->Path		= record.Material;
+			material->IsMesh	= false;
+			materials.push_back(material);
+		}
+	}
+
+	o_Files.insert(o_Files.end(), materials.begin(), materials.end());
+
+	// the files of already loaded resources are read too (the resource managers can not be used here) : their data is dropped
+	for (size_t i = 0; i < o_Files.size(); ++i)
+	{
+		ResourceFile * resourceFile = o_Files[i];
+		const char * path = i_Scene.GetString(resourceFile->Path);
+
+		if (resourceFile->IsMesh && !String::StartWith(path, "Primitive:"))
+			resourceFile->Read = Mesh::ReadMeshFile(path, resourceFile->MeshData, resourceFile->Error);
+		else if (!resourceFile->IsMesh && !String::StartWith(path, "Generated:"))
+			resourceFile->Read = Material::ReadMaterialFile(path, resourceFile->Materials, resourceFile->Error);
+	}
+}
+
+void LevelStreamer::ResolveFile(Cell * i_Cell, ResourceFile * i_File)
+{
+	CPU_ZONE("Resolve Resource");
+
+	ResourceManager * manager = Engine::GetInstance().GetResourceManager();
+	World::SceneLoad & load = i_Cell->Load;
+	const char * path = i_Cell->Scene->GetString(i_File->Path);
+	Resource * resolved = nullptr;
+	bool created = false;
+
+	if (i_File->IsMesh)
+	{
+		Mesh * mesh = manager->GetMeshByFilename(path);
+
+		// the primitives are generated, the files are loaded with the data read by the loader thread
+		if (mesh == nullptr && (i_File->Read || String::StartWith(path, "Primitive:")))
+		{
+			mesh = i_File->Read ? manager->LoadMesh(path, &i_File->MeshData) : manager->LoadMesh(path);
+			created = true;
+		}
+
+		load.Meshes[i_File->Path] = mesh;
+		resolved = mesh;
+	}
+	else
+	{
+		// generated materials are loaded with their mesh
+		Material * material = manager->GetMaterialByFilename(path);
+		if (material == nullptr)
+			material = manager->GetGeneratedMaterialByFilename(path);
+		if (material == nullptr && i_File->Read)
+		{
+			material = manager->LoadMaterial(path, &i_File->Materials);
+			created = true;
+		}
+
+		load.Materials[i_File->Path] = material;
+		resolved = material;
+	}
+
+	if (resolved == nullptr && !i_File->Error.empty())
+		PRINT_DEBUG("Error, unable to read %s : %s", path, i_File->Error.c_str());
+	else if (resolved != nullptr && created)
+		m_OwnedResources.push_back(resolved);
+}
+
+void LevelStreamer::BeginUnload(Cell * i_Cell)
+{
+	// the records and the files not resolved are not needed anymore
+	DeleteFiles(i_Cell);
+
+	i_Cell->Load.Scene = nullptr;
+	delete i_Cell->Scene;
+	i_Cell->Scene = nullptr;
+	i_Cell->State = eUnloading;
+}
+
+bool LevelStreamer::UnloadActors(Cell * i_Cell, const Clock & i_Clock, float i_Budget)
+{
+	CPU_ZONE("Unload Cell");
+
+	World::SceneLoad & load = i_Cell->Load;
+	std::vector<Actor *> actors;
+
+	// the last records are deleted first : the children of an actor are deleted before it (records are parents first)
+	// a slice is deleted with one pass over the world lists, its size is the remaining budget over the measured time per actor
+	while (!load.Actors.empty())
+	{
+		const float start = i_Clock.GetElaspedTime().ToMilliseconds();
+
+		if (start >= i_Budget)
+			return false;
+
+		const float sliceTime = (i_Budget - start) / m_DeleteTime;
+		const size_t sliceSize = (sliceTime < (float)load.Actors.size()) ? Math::Max<size_t>((size_t)sliceTime, 1) : load.Actors.size();
+		const size_t first = load.Actors.size() - sliceSize;
+
+		actors.clear();
+
+		for (size_t i = first; i < load.Actors.size(); ++i)
+		{
+			if (load.Actors[i] != nullptr)
+				actors.push_back(load.Actors[i]);
+		}
+
+		const UINT deletedCount = m_World->DeleteActors(actors);
+		load.Actors.resize(first);
+		m_Stats.DeletedActors += deletedCount;
+
+		if (deletedCount != 0)
+			m_DeleteTime = Math::Max((i_Clock.GetElaspedTime().ToMilliseconds() - start) / (float)deletedCount, STREAMING_MIN_DELETE_TIME);
+	}
+
+	// resources used by the cell
+	std::vector<Resource *> resources(load.Meshes.begin(), load.Meshes.end());
+	resources.insert(resources.end(), load.Materials.begin(), load.Materials.end());
+
+	load = World::SceneLoad();
+	i_Cell->State = eUnloaded;
+
+	// the resources loaded by the cells are released when no other cell use them
+	for (size_t i = 0; i < resources.size(); ++i)
+	{
+		Resource * resource = resources[i];
+
+		if (resource == nullptr || std::find(m_OwnedResources.begin(), m_OwnedResources.end(), resource) == m_OwnedResources.end())
+			continue;
+
+		auto pending = std::find_if(m_PendingReleases.begin(), m_PendingReleases.end(),
+			[resource](const std::pair<Resource *, UINT64> & i_Pending) { return i_Pending.first == resource; });
+
+		if (pending == m_PendingReleases.end() && !IsResourceUsed(resource))
+			m_PendingReleases.push_back(std::make_pair(resource, m_Frame));
+	}
+
+	return true;
+}
+
+void LevelStreamer::DeleteFiles(Cell * i_Cell)
+{
+	for (size_t i = 0; i < i_Cell->Files.size(); ++i)
+	{
+		delete i_Cell->Files[i];
+	}
+
+	i_Cell->Files.clear();
+	i_Cell->NextFile = 0;
+}
+
+bool LevelStreamer::IsResourceUsed(const Resource * i_Resource) const
+{
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+	{
+		const World::SceneLoad & load = m_Cells[i]->Load;
+
+		if (std::find(load.Meshes.begin(), load.Meshes.end(), i_Resource) != load.Meshes.end()
+			|| std::find(load.Materials.begin(), load.Materials.end(), i_Resource) != load.Materials.end())
+			return true;
+	}
+
+	return false;
+}
+
+void LevelStreamer::ReleaseResources()
+{
+	ResourceManager * manager = Engine::GetInstance().GetResourceManager();
+	auto itr = m_PendingReleases.begin();
+
+	while (itr != m_PendingReleases.end())
+	{
+		if (m_Frame < (*itr).second + STREAMING_RELEASE_DELAY)
+		{
+			++itr;
+			continue;
+		}
+
+		// a cell loaded since the request can use the resource again
+		Resource * resource = (*itr).first;
+
+		if (!IsResourceUsed(resource))
+		{
+			manager->ReleaseResource(resource->GetId());
+			m_OwnedResources.erase(std::find(m_OwnedResources.begin(), m_OwnedResources.end(), resource));
+			++m_Stats.ReleasedResources;
+		}
+
+		itr = m_PendingReleases.erase(itr);
+	}
+}
@@ -0,0 +1,131 @@
+// Level streaming
+// the world is split in cells (scene files) loaded when the view enter their load radius and unloaded when it leave their unload radius
+// the files and the resource files they reference are read and validated on a loader thread
+// on the main thread (the resource managers are not thread safe), the resources are created then the actors spawned with a time budget per frame
+// the budget is checked after each resource and each actor, the actors of an unloaded cell are deleted by slices within the budget
+// the resources loaded by the cells are released when no cell use them anymore (a few frames later : the GPU can still use them)
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "engine/World.h"
+#include "resource/Mesh.h"
+#include "resource/Material.h"
+
+using namespace DirectX;
+
+class SceneFile;
+class Resource;
+class Clock;
+
+class LevelStreamer
+{
+public:
+	enum ECellState
+	{
+		eUnloaded,
+		eReading,		// on the loader thread
+		eResolving,		// resources created each frame
+		eSpawning,		// actors spawned each frame
+		eLoaded,
+		eUnloading,		// actors deleted each frame
+	};
+
+	struct CellDesc
+	{
+		std::string		File;
+		XMFLOAT3		Center			= XMFLOAT3(0.f, 0.f, 0.f);
+		float			LoadRadius		= 100.f;
+		float			UnloadRadius	= 120.f;	// greater than the load radius : no load / unload each frame on the border
+	};
+
+	// information of the last update
+	struct Stats
+	{
+		float		UpdateTime			= 0.f;	// milliseconds
+		UINT		SpawnedActors		= 0;
+		UINT		DeletedActors		= 0;
+		UINT		ReleasedResources	= 0;
+		UINT		LoadedCells			= 0;
+		UINT		PendingCells		= 0;	// reading, resolving, spawning or unloading
+	};
+
+	LevelStreamer(World * i_World);
+	~LevelStreamer();
+
+	// cells (the actors of the cells are owned by the streaming : they must not be deleted)
+	UINT			AddCell(const CellDesc & i_Desc);
+	void			Clear();	// unload and remove all cells
+
+	// load and unload the cells around the view, spawn actors for the budget (milliseconds)
+	void			Update(const XMFLOAT3 & i_ViewPosition, float i_Budget);
+
+	// information
+	bool			IsIdle() const;		// all cells are loaded or unloaded
+	UINT			GetCellCount() const;
+	ECellState		GetCellState(UINT i_Cell) const;
+	UINT			GetCellActorCount(UINT i_Cell) const;
+	const Stats &	GetStats() const;
+
+private:
+	// resource referenced by a cell (mesh or material), the file is read by the loader thread
+	struct ResourceFile
+	{
+		UINT									Path;			// string index in the scene
+		bool									IsMesh;
+		bool									Read = false;	// primitives and generated materials have no file
+		Mesh::MeshFileData						MeshData;
+		std::vector<Material::MaterialSpec>		Materials;
+		std::string								Error;
+	};
+
+	struct Cell
+	{
+		CellDesc						Desc;
+		ECellState						State = eUnloaded;
+		SceneFile *						Scene = nullptr;	// written by the loader thread while the cell is reading
+		std::vector<ResourceFile *>		Files;				// meshes first : generated materials are loaded with their mesh
+		UINT							NextFile = 0;		// next file to resolve
+		bool							ReadFailed = false;
+		World::SceneLoad				Load;
+	};
+
+	// loader thread
+	void			LoaderLoop();
+	static void		ReadResourceFiles(const SceneFile & i_Scene, std::vector<ResourceFile *> & o_Files);
+
+	// main thread
+	void			ResolveFile(Cell * i_Cell, ResourceFile * i_File);	// the mesh takes the vertex buffers of the file
+	void			BeginUnload(Cell * i_Cell);
+	bool			UnloadActors(Cell * i_Cell, const Clock & i_Clock, float i_Budget);	// return true when the cell is unloaded
+	void			DeleteFiles(Cell * i_Cell);
+	bool			IsResourceUsed(const Resource * i_Resource) const;
+	void			ReleaseResources();
+
+	World *					m_World;
+	std::vector<Cell *>		m_Cells;
+	Stats					m_Stats;
+	UINT64					m_Frame;
+	float					m_DeleteTime;	// measured time to delete an actor (milliseconds) : size of the next slice
+
+	// resources loaded by the cells and resources to release (frame of the release request)
+	std::vector<Resource *>							m_OwnedResources;
+	std::vector<std::pair<Resource *, UINT64>>		m_PendingReleases;
+
+	// loader thread
+	std::thread					m_Thread;
+	std::mutex					m_Mutex;
+	std::condition_variable		m_Condition;
+	std::deque<Cell *>			m_ReadQueue;
+	std::vector<Cell *>			m_ReadDone;
+	Cell *						m_Reading;
+	bool						m_Exit;
+};
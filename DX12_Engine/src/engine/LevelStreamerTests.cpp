@@ -0,0 +1,224 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/Engine.h"
+#include "engine/World.h"
+#include "engine/Light.h"
+#include "engine/SceneFile.h"
+#include "engine/LevelStreamer.h"
+#include "resource/ResourceManager.h"
+#include "engine/TestUtils.h"
+
+CFStreamCheck::CFStreamCheck()
+	:Console::Function("stream_check", "[grid size] [actors per cell] [budget ms]", "fly a camera over a grid of generated cells and record the streaming hitches")
+{
+}
+
+bool CFStreamCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT gridSize = 8;
+	UINT actorsPerCell = 2000;
+	float budget = 2.f;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		gridSize = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	if (i_CommandLine.m_Parameters.size() > 1)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[1]))
+			return false;
+		actorsPerCell = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[1]), 1);
+	}
+
+	if (i_CommandLine.m_Parameters.size() > 2)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[2]))
+			return false;
+		budget = Math::Max(i_CommandLine.ToFloat(i_CommandLine.m_Parameters[2]), 0.1f);
+	}
+
+	// generated cells : small hierarchies of actors and lights, some actors render meshes of the resource files
+	// each cell uses two meshes of the list : the resources are shared with the next cells and released when none use them
+	static const char * meshes[] = { "resources/obj/cube.obj", "resources/obj/sphere.obj", "resources/obj/lowpolytree.obj", "Primitive:Cube" };
+	static const char * materials[] = { "resources/obj/cube.mtl", "resources/obj/sphere.mtl", "Generated:resources/obj/lowpolytree.obj_lowpolytree", nullptr };
+	static const float cellSize = 100.f;
+	static const float frameTime = 1.f / 60.f;
+	static const float speed = 300.f;		// units per second
+	static const float hitchTime = 1.f;		// milliseconds over the budget
+	ResourceManager * manager = Engine::GetInstance().GetResourceManager();
+	const size_t resourceCount = manager->GetResourceCount(ResourceManager::eAll);
+	std::vector<std::string> files;
+	TestRandom random(0x1B873593);
+	UINT errors = 0;
+
+	for (UINT cell = 0; cell < gridSize * gridSize; ++cell)
+	{
+		SceneFile scene;
+		const float cellX = (float)(cell % gridSize) * cellSize;
+		const float cellZ = (float)(cell / gridSize) * cellSize;
+
+		for (UINT i = 0; i < actorsPerCell; ++i)
+		{
+			const UINT seed = random.Next();
+
+			SceneFile::ActorRecord record;
+			record.Id			= (UINT64)cell * actorsPerCell + i;
+			record.Parent		= (i % 8 != 0) ? i - i % 8 : SceneFile::InvalidIndex;
+			record.Name			= scene.AddString("Streamed Actor");
+			record.Flags		= 0;
+			record.Mesh			= SceneFile::InvalidIndex;
+			record.SubMesh		= 0;
+			record.Material		= SceneFile::InvalidIndex;
+			record.SubMaterial	= 0;
+			record.Light		= SceneFile::InvalidIndex;
+			record.Position[0]	= cellX + (float)((seed >> 8) % 100);
+			record.Position[1]	= 0.f;
+			record.Position[2]	= cellZ + (float)((seed >> 16) % 100);
+
+			for (UINT axis = 0; axis < 3; ++axis)
+			{
+				record.Rotation[axis]	= 0.f;
+				record.Scale[axis]		= 1.f;
+			}
+
+			if (i % 4 == 1)
+			{
+				const UINT resource = (cell + (seed >> 24) % 2) % _countof(meshes);
+				record.Mesh = scene.AddString(meshes[resource]);
+
+				if (materials[resource] != nullptr)
+					record.Material = scene.AddString(materials[resource]);
+			}
+
+			if (i % 32 == 0)
+			{
+				SceneFile::LightRecord light = { (UINT)Light::ePointLight, { 1.f, 1.f, 1.f, 1.f }, 1.f, 10.f, 1.f, 0.2f, 0.01f, 0.f, 0.f, 0 };
+				record.Light = scene.AddLight(light);
+			}
+
+			scene.AddActor(record);
+		}
+
+		char filename[64];
+		sprintf_s(filename, "stream_check_%u.dxscene", cell);
+		files.push_back(filename);
+
+		if (!scene.Write(filename))
+		{
+			GetConsole()->Print("stream check : unable to write %s", filename);
+			return false;
+		}
+	}
+
+	// temporary world streamed along a line over the middle row of the grid
+	World::WorldDesc worldDesc;
+	World world(worldDesc);
+	LevelStreamer streamer(&world);
+
+	for (UINT cell = 0; cell < gridSize * gridSize; ++cell)
+	{
+		LevelStreamer::CellDesc desc;
+		desc.File			= files[cell];
+		desc.Center			= XMFLOAT3((float)(cell % gridSize) * cellSize + cellSize * 0.5f, 0.f, (float)(cell / gridSize) * cellSize + cellSize * 0.5f);
+		desc.LoadRadius		= cellSize * 1.5f;
+		desc.UnloadRadius	= cellSize * 1.8f;
+		streamer.AddCell(desc);
+	}
+
+	const XMFLOAT3 start(-cellSize * 2.f, 0.f, (float)gridSize * cellSize * 0.5f);
+	const float length = ((float)gridSize + 4.f) * cellSize;
+	const UINT pathFrames = (UINT)(length / (speed * frameTime));
+
+	std::vector<float> updateTimes;
+	UINT hitchCount = 0, peakActors = 0, spawned = 0, deleted = 0, peakResources = 0;
+	XMFLOAT3 position = start;
+
+	// the frames after the path : the last requested cells finish their load
+	for (UINT frame = 0; frame < pathFrames + 600 && (frame < pathFrames || !streamer.IsIdle()); ++frame)
+	{
+		Clock frameClock;
+
+		position.x = start.x + Math::Min(frame, pathFrames) * speed * frameTime;
+		streamer.Update(position, budget);
+
+		const LevelStreamer::Stats & stats = streamer.GetStats();
+		updateTimes.push_back(stats.UpdateTime);
+		spawned += stats.SpawnedActors;
+		deleted += stats.DeletedActors;
+		peakActors = Math::Max(peakActors, world.GetActorCount());
+		peakResources = Math::Max(peakResources, (UINT)(manager->GetResourceCount(ResourceManager::eAll) - resourceCount));
+
+		if (stats.UpdateTime > budget + hitchTime)
+		{
+			++hitchCount;
+			GetConsole()->Print("stream check : hitch at frame %u, %.2f ms (%u spawned, %u deleted)", frame, stats.UpdateTime, stats.SpawnedActors, stats.DeletedActors);
+		}
+
+		// the loader thread runs at the frame rate
+		const float remaining = frameTime - frameClock.GetElaspedTime().ToSeconds();
+		if (remaining > 0.f)
+			std::this_thread::sleep_for(std::chrono::microseconds((long long)(remaining * 1'000'000.f)));
+	}
+
+	// the cells near the end of the path are loaded, the far ones unloaded
+	UINT streamedActors = 0;
+
+	for (UINT cell = 0; cell < streamer.GetCellCount(); ++cell)
+	{
+		const float dx = (float)(cell % gridSize) * cellSize + cellSize * 0.5f - position.x;
+		const float dz = (float)(cell / gridSize) * cellSize + cellSize * 0.5f - position.z;
+		const float distance = sqrtf(dx * dx + dz * dz);
+		const LevelStreamer::ECellState state = streamer.GetCellState(cell);
+
+		if ((distance <= cellSize * 1.5f && state != LevelStreamer::eLoaded) || (distance > cellSize * 1.8f && state != LevelStreamer::eUnloaded))
+			++errors;
+
+		streamedActors += streamer.GetCellActorCount(cell);
+	}
+
+	if (!streamer.IsIdle() || streamedActors != world.GetActorCount())
+		++errors;
+
+	// the streaming remove all its actors, its resources are released after the frames in flight
+	streamer.Clear();
+
+	for (UINT frame = 0; frame < 8; ++frame)
+	{
+		streamer.Update(position, budget);
+	}
+
+	if (world.GetActorCount() != 0 || manager->GetResourceCount(ResourceManager::eAll) != resourceCount)
+		++errors;
+
+	// the cells used the resource files
+	if (peakResources == 0)
+		++errors;
+
+	world.Clear();
+
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		remove(files[i].c_str());
+	}
+
+	std::sort(updateTimes.begin(), updateTimes.end());
+	const float p99 = updateTimes[(updateTimes.size() * 99) / 100];
+
+	GetConsole()->Print("stream check : %u cells, %u frames, %u spawned, %u deleted, %u actors and %u resources at most", gridSize * gridSize, (UINT)updateTimes.size(), spawned, deleted, peakActors, peakResources);
+	GetConsole()->Print("stream check : update p99 %.2f ms, max %.2f ms, %u hitches (budget %.1f ms), %u errors", p99, updateTimes.back(), hitchCount, budget, errors);
+	return errors == 0 && hitchCount == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
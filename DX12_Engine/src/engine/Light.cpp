@@ -4,8 +4,21 @@
 #include "engine/Utils.h"
 
 Light::Light()
-	:m_LightType(eLightTypeCount)	// uninitialized
-{
+	:m_DiffuseColor(0.f, 0.f, 0.f, 0.f)
+	,m_LightType(eLightTypeCount)	// uninitialized
+	,m_Intensity(1.f)
+	,m_Range(0.f)
+	,m_SpotAngle(0.f)
+	,m_OuterCutoff(0.f)
+	,m_CastShadows(true)
+	,m_Constant(1.f)
+	,m_Quadratic(0.f)
+	,m_Linear(0.f)
+	,m_Position(0.f, 0.f, 0.f)
+	,m_Direction(0.f, 0.f, 1.f)
+	,m_DirtyFrames(0xffffffff)
+{
+	memset(&m_LightData, 0, sizeof(LightData));
 }
 
 Light::~Light()
@@ -63,49 +76,79 @@ float Light::GetSpotAngleInDegree() const
 	return m_SpotAngle * RadToDeg;
 }
 
+const XMFLOAT3 & Light::GetPosition() const
+{
+	return m_Position;
+}
+
+const XMFLOAT3 & Light::GetDirection() const
+{
+	return m_Direction;
+}
+
+bool Light::IsCastingShadows() const
+{
+	return m_CastShadows && (m_LightType == eSpotLight || m_LightType == eDirectionalLight);
+}
+
 void Light::SetType(const ELightType & i_Type)
 {
 	m_LightType = i_Type;
+	ComputeLightData();
 }
 
 void Light::SetColor(const XMFLOAT4 & i_Color)
 {
 	m_DiffuseColor = i_Color;
+	ComputeLightData();
 }
 
 void Light::SetIntensity(float i_Intensity)
 {
 	m_Intensity = i_Intensity;
+	ComputeLightData();
 }
 
 void Light::SetSpotAngleInDegree(float i_Angle)
 {
 	m_SpotAngle = cos((i_Angle / 2.f) * DegToRad);
+	ComputeLightData();
 }
 
 void Light::SetSpotAngle(float i_Angle)
 {
 	m_SpotAngle = i_Angle;
+	ComputeLightData();
 }
 
 void Light::SetSoftEdges(float i_SoftEdges)
 {
 	m_OuterCutoff = i_SoftEdges;
+	ComputeLightData();
+}
+
+void Light::SetCastShadows(bool i_CastShadows)
+{
+	// not part of the GPU light data : shadow views are rebuilt each frame
+	m_CastShadows = i_CastShadows;
 }
 
 void Light::SetConstant(float i_Constant)
 {
 	m_Constant = i_Constant;
+	ComputeLightData();
 }
 
 void Light::SetLinear(float i_Linear)
 {
 	m_Linear = i_Linear;
+	ComputeLightData();
 }
 
 void Light::SetQuadratic(float i_Quadratic)
 {
 	m_Quadratic = i_Quadratic;
+	ComputeLightData();
 }
 
 void Light::SetRange(float i_Range)
@@ -117,9 +160,94 @@ void Light::SetRange(float i_Range)
 	m_Constant = 1.f;
 	m_Linear = 2.f / m_Range;
 	m_Quadratic = 1.f / (m_Range * m_Range);
+	ComputeLightData();
+}
+
+void Light::SetWorldTransform(const XMFLOAT4X4 & i_World)
+{
+	const XMFLOAT3 position(i_World._41, i_World._42, i_World._43);
+	const XMFLOAT3 direction(i_World._31, i_World._32, i_World._33);
+
+	// the light did not move
+	if (memcmp(&position, &m_Position, sizeof(XMFLOAT3)) == 0 && memcmp(&direction, &m_Direction, sizeof(XMFLOAT3)) == 0)
+		return;
+
+	m_Position = position;
+	m_Direction = direction;
+	ComputeLightData();
+}
+
+const void * Light::GetLightData() const
+{
+	return &m_LightData;
+}
+
+size_t Light::GetLightDataSize() const
+{
+	return GetLightDataSize(m_LightType);
+}
+
+size_t Light::GetLightDataSize(ELightType i_Type)
+{
+	switch (i_Type)
+	{
+	case ePointLight:			return sizeof(PointLightData);
+	case eSpotLight:			return sizeof(SpotLightData);
+	case eDirectionalLight:		return sizeof(DirectionalLightData);
+	default:					return 0;
+	}
+}
+
+bool Light::IsDirty(UINT i_FrameIndex) const
+{
+	return (m_DirtyFrames & (1 << i_FrameIndex)) != 0;
+}
+
+void Light::ClearDirty(UINT i_FrameIndex)
+{
+	m_DirtyFrames &= ~(1 << i_FrameIndex);
 }
 
 FORCEINLINE void Light::ComputeLightData()
 {
-	TO_DO;
+	LightData data;
+	memset(&data, 0, sizeof(LightData));
+
+	const XMFLOAT3 color(m_DiffuseColor.x, m_DiffuseColor.y, m_DiffuseColor.z);
+
+	switch (m_LightType)
+	{
+	case ePointLight:
+		data.Point.Position		= m_Position;
+		data.Point.Range		= m_Range;
+		data.Point.Color		= color;
+		data.Point.Constant		= m_Constant;
+		data.Point.Linear		= m_Linear;
+		data.Point.Quadratic	= m_Quadratic;
+		break;
+	case eSpotLight:
+		data.Spot.Position		= m_Position;
+		data.Spot.Range			= m_Range;
+		data.Spot.Color			= color;
+		data.Spot.Constant		= m_Constant;
+		data.Spot.Linear		= m_Linear;
+		data.Spot.Quadratic		= m_Quadratic;
+		data.Spot.Direction		= m_Direction;
+		data.Spot.SpotAngle		= m_SpotAngle;
+		data.Spot.OuterCutoff	= m_OuterCutoff;
+		break;
+	case eDirectionalLight:
+		data.Directional.Direction	= m_Direction;
+		data.Directional.Color		= color;
+		break;
+	default:
+		break;
+	}
+
+	// the data need to be uploaded again for each frames
+	if (memcmp(&data, &m_LightData, sizeof(LightData)) != 0)
+	{
+		m_LightData = data;
+		m_DirtyFrames = 0xffffffff;
+	}
 }
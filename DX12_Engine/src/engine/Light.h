@@ -2,11 +2,12 @@
 
 #pragma once
 
+#include <Windows.h>
 #include <DirectXMath.h>
 using namespace DirectX;
 
 // define
-#define			MAX_LIGHT		64
+#define			MAX_LIGHT		4096	// lights are culled per cluster (see LightCluster)
 
 // default light
 class Light
@@ -22,6 +23,36 @@ public:
 		eLightTypeCount,
 	};
 
+	// GPU-ready light data (tightly packed, structures must match DeferredLightPS.hlsl)
+	struct PointLightData
+	{
+		XMFLOAT3		Position;
+		float			Range;
+		XMFLOAT3		Color;
+		float			Constant;
+		float			Linear;
+		float			Quadratic;
+	};
+
+	struct SpotLightData
+	{
+		XMFLOAT3		Position;
+		float			Range;
+		XMFLOAT3		Color;
+		float			Constant;
+		float			Linear;
+		float			Quadratic;
+		XMFLOAT3		Direction;
+		float			SpotAngle;
+		float			OuterCutoff;
+	};
+
+	struct DirectionalLightData
+	{
+		XMFLOAT3		Direction;
+		XMFLOAT3		Color;
+	};
+
 	// destructor
 	Light();	// called by children
 	~Light();
@@ -39,6 +70,9 @@ public:
 	float				GetLinear() const;
 	float				GetConstant() const;
 	float				GetSpotAngleInDegree() const;
+	const XMFLOAT3 &	GetPosition() const;	// world space
+	const XMFLOAT3 &	GetDirection() const;	// world space
+	bool				IsCastingShadows() const;	// spot and directional lights only
 
 	// light management
 	void				SetType(const ELightType & i_Type);
@@ -49,13 +83,21 @@ public:
 	void				SetSpotAngleInDegree(float i_Angle);
 	void				SetSpotAngle(float i_Angle);
 	void				SetSoftEdges(float i_SoftEdges);
+	// shadows
+	void				SetCastShadows(bool i_CastShadows);
 	// attenuation 
 	void				SetConstant(float i_Constant);	// compute attenuation based on these params
 	void				SetLinear(float i_Linear);
 	void				SetQuadratic(float i_Quadratic);
-	
+	// transform (retreived from the actor)
+	void				SetWorldTransform(const XMFLOAT4X4 & i_World);
 
-	// To do: compute data to already created data (and just copy them into the list)
+	// GPU data management
+	const void *		GetLightData() const;		// GPU-ready data for the current type
+	size_t				GetLightDataSize() const;
+	static size_t		GetLightDataSize(ELightType i_Type);
+	bool				IsDirty(UINT i_FrameIndex) const;	// the light data changed since the last upload for this frame
+	void				ClearDirty(UINT i_FrameIndex);
 
 private:
 	// global data for lights (each lights have these values)
@@ -67,12 +109,27 @@ private:
 	// spotlight data
 	float					m_SpotAngle;
 	float					m_OuterCutoff;	// for soft edges
+	// shadows
+	bool					m_CastShadows;
 	// attenuation data
 	float					m_Constant;
 	float					m_Quadratic;
 	float					m_Linear;
+	// transform
+	XMFLOAT3				m_Position;
+	XMFLOAT3				m_Direction;
 
-	// internal helpers
+	// GPU-ready data
+	union LightData
+	{
+		PointLightData			Point;
+		SpotLightData			Spot;
+		DirectionalLightData	Directional;
+	};
+
+	LightData				m_LightData;
+	UINT					m_DirtyFrames;	// one bit for each frame buffer
 
+	// internal helpers
 	void		ComputeLightData();	// this compute light data and save it to a pointer (fast retreive for render list)
 };
\ No newline at end of file
@@ -0,0 +1,479 @@
+#include "LightCluster.h"
+
+#include "engine/Debug.h"
+#include "engine/Light.h"
+#include <math.h>
+
+// load 4 consecutive clusters data (arrays are padded)
+static FORCEINLINE XMVECTOR LoadClusterData(const std::vector<float> & i_Data, UINT i_Index)
+{
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&i_Data[i_Index]));
+}
+
+LightCluster::LightCluster()
+	:LightCluster(LightClusterDesc())
+{
+}
+
+LightCluster::LightCluster(const LightClusterDesc & i_Desc)
+	:m_Desc(i_Desc)
+	,m_ClusterCount(i_Desc.TileCountX * i_Desc.TileCountY * i_Desc.SliceCount)
+	,m_RenderSize(0, 0)
+	,m_Near(0.f)
+	,m_Far(0.f)
+	,m_SliceScale(0.f)
+	,m_SliceBias(0.f)
+	,m_GlobalLightCount(0)
+{
+	ASSERT(m_ClusterCount > 0);
+
+	// 3 more elements : clusters are read 4 by 4
+	const size_t paddedSize = m_ClusterCount + 3;
+
+	m_MinX.resize(paddedSize, 0.f);		m_MaxX.resize(paddedSize, 0.f);
+	m_MinY.resize(paddedSize, 0.f);		m_MaxY.resize(paddedSize, 0.f);
+	m_MinZ.resize(paddedSize, 0.f);		m_MaxZ.resize(paddedSize, 0.f);
+	m_CenterX.resize(paddedSize, 0.f);	m_CenterY.resize(paddedSize, 0.f);
+	m_CenterZ.resize(paddedSize, 0.f);	m_Radius.resize(paddedSize, 0.f);
+
+	m_SliceDepth.resize(m_Desc.SliceCount + 1, 0.f);
+	m_Clusters.resize(m_ClusterCount);
+	m_LightIndices.reserve(m_Desc.MaxLightIndex);
+
+	XMStoreFloat4x4(&m_Projection, XMMatrixIdentity());
+}
+
+LightCluster::~LightCluster()
+{
+}
+
+void LightCluster::SetupView(const XMMATRIX & i_Projection, const IntVec2 & i_RenderSize)
+{
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, i_Projection);
+
+	// clusters bounds only depend on the projection and the render size
+	if (memcmp(&projection, &m_Projection, sizeof(XMFLOAT4X4)) == 0
+		&& i_RenderSize.x == m_RenderSize.x && i_RenderSize.y == m_RenderSize.y)
+	{
+		return;
+	}
+
+	m_Projection = projection;
+	m_RenderSize = i_RenderSize;
+
+	// retreive near and far from the perspective projection (left handed)
+	m_Near	= -m_Projection._43 / m_Projection._33;
+	m_Far	= (m_Projection._33 * m_Near) / (m_Projection._33 - 1.f);
+
+	// exponential slices : slice = log(z) * scale + bias
+	const float logRatio = logf(m_Far / m_Near);
+	m_SliceScale	= (float)m_Desc.SliceCount / logRatio;
+	m_SliceBias		= -((float)m_Desc.SliceCount * logf(m_Near)) / logRatio;
+
+	ComputeClusterBounds();
+}
+
+void LightCluster::BuildClusters(const LightBound * i_Lights, UINT i_LightCount)
+{
+	m_Pairs.clear();
+	m_LightIndices.clear();
+
+	// global lights are always computed
+	for (UINT i = 0; i < i_LightCount; ++i)
+	{
+		if (i_Lights[i].Type == Light::eDirectionalLight)
+			m_LightIndices.push_back(i);
+	}
+
+	m_GlobalLightCount = (UINT)m_LightIndices.size();
+
+	// bin local lights
+	for (UINT i = 0; i < i_LightCount; ++i)
+	{
+		if (i_Lights[i].Type != Light::eDirectionalLight)
+			AssignLight(i, i_Lights[i]);
+	}
+
+	ResolveClusters((UINT)m_Pairs.size());
+}
+
+void LightCluster::BuildClustersReference(const LightBound * i_Lights, UINT i_LightCount)
+{
+	m_Pairs.clear();
+	m_LightIndices.clear();
+
+	for (UINT i = 0; i < i_LightCount; ++i)
+	{
+		if (i_Lights[i].Type == Light::eDirectionalLight)
+			m_LightIndices.push_back(i);
+	}
+
+	m_GlobalLightCount = (UINT)m_LightIndices.size();
+
+	// test each lights against each clusters
+	for (UINT c = 0; c < m_ClusterCount; ++c)
+	{
+		for (UINT i = 0; i < i_LightCount; ++i)
+		{
+			if (i_Lights[i].Type == Light::eDirectionalLight)
+				continue;
+
+			if (TestCluster(c, i_Lights[i]))
+				m_Pairs.push_back({ c, i });
+		}
+	}
+
+	ResolveClusters((UINT)m_Pairs.size());
+}
+
+const std::vector<LightCluster::ClusterData> & LightCluster::GetClusters() const
+{
+	return m_Clusters;
+}
+
+const std::vector<UINT> & LightCluster::GetLightIndices() const
+{
+	return m_LightIndices;
+}
+
+LightCluster::ClusterConstants LightCluster::GetConstants() const
+{
+	ClusterConstants constants;
+
+	constants.ClusterCount[0]	= m_Desc.TileCountX;
+	constants.ClusterCount[1]	= m_Desc.TileCountY;
+	constants.ClusterCount[2]	= m_Desc.SliceCount;
+	constants.GlobalLightCount	= m_GlobalLightCount;
+	constants.TileSize			= XMFLOAT2((float)m_RenderSize.x / (float)m_Desc.TileCountX, (float)m_RenderSize.y / (float)m_Desc.TileCountY);
+	constants.SliceScale		= m_SliceScale;
+	constants.SliceBias			= m_SliceBias;
+
+	return constants;
+}
+
+UINT LightCluster::GetGlobalLightCount() const
+{
+	return m_GlobalLightCount;
+}
+
+const LightCluster::LightClusterDesc & LightCluster::GetDesc() const
+{
+	return m_Desc;
+}
+
+UINT LightCluster::GetClusterCount() const
+{
+	return m_ClusterCount;
+}
+
+UINT LightCluster::GetClusterIndex(UINT i_X, UINT i_Y, UINT i_Z) const
+{
+	return i_X + m_Desc.TileCountX * (i_Y + m_Desc.TileCountY * i_Z);
+}
+
+UINT LightCluster::GetSlice(float i_ViewDepth) const
+{
+	if (i_ViewDepth <= m_Near)
+		return 0;
+
+	const float slice = logf(i_ViewDepth) * m_SliceScale + m_SliceBias;
+	return Math::Min((UINT)Math::Max(slice, 0.f), m_Desc.SliceCount - 1);
+}
+
+UINT LightCluster::CountMismatch(const LightCluster & i_Other) const
+{
+	UINT mismatch = 0;
+
+	if (m_ClusterCount != i_Other.m_ClusterCount)
+		return m_ClusterCount;
+
+	// global lights
+	if (m_GlobalLightCount != i_Other.m_GlobalLightCount
+		|| memcmp(m_LightIndices.data(), i_Other.m_LightIndices.data(), m_GlobalLightCount * sizeof(UINT)) != 0)
+	{
+		++mismatch;
+	}
+
+	// lights are sorted by index in each cluster
+	for (UINT c = 0; c < m_ClusterCount; ++c)
+	{
+		const ClusterData & cluster = m_Clusters[c];
+		const ClusterData & other = i_Other.m_Clusters[c];
+
+		if (cluster.Count != other.Count
+			|| memcmp(&m_LightIndices[cluster.Offset], &i_Other.m_LightIndices[other.Offset], cluster.Count * sizeof(UINT)) != 0)
+		{
+			++mismatch;
+		}
+	}
+
+	return mismatch;
+}
+
+FORCEINLINE void LightCluster::ComputeClusterBounds()
+{
+	// slices depth
+	for (UINT z = 0; z <= m_Desc.SliceCount; ++z)
+	{
+		m_SliceDepth[z] = m_Near * powf(m_Far / m_Near, (float)z / (float)m_Desc.SliceCount);
+	}
+
+	for (UINT z = 0; z < m_Desc.SliceCount; ++z)
+	{
+		const float nearZ	= m_SliceDepth[z];
+		const float farZ	= m_SliceDepth[z + 1];
+
+		for (UINT y = 0; y < m_Desc.TileCountY; ++y)
+		{
+			// tiles start on the top of the screen
+			const float ndcTop		= 1.f - 2.f * (float)y / (float)m_Desc.TileCountY;
+			const float ndcBottom	= 1.f - 2.f * (float)(y + 1) / (float)m_Desc.TileCountY;
+
+			for (UINT x = 0; x < m_Desc.TileCountX; ++x)
+			{
+				const float ndcLeft		= -1.f + 2.f * (float)x / (float)m_Desc.TileCountX;
+				const float ndcRight	= -1.f + 2.f * (float)(x + 1) / (float)m_Desc.TileCountX;
+
+				// view space position of the tile corners on near and far planes of the slice
+				const float x0 = ndcLeft * nearZ / m_Projection._11,	x1 = ndcLeft * farZ / m_Projection._11;
+				const float x2 = ndcRight * nearZ / m_Projection._11,	x3 = ndcRight * farZ / m_Projection._11;
+				const float y0 = ndcBottom * nearZ / m_Projection._22,	y1 = ndcBottom * farZ / m_Projection._22;
+				const float y2 = ndcTop * nearZ / m_Projection._22,		y3 = ndcTop * farZ / m_Projection._22;
+
+				const UINT c = GetClusterIndex(x, y, z);
+
+				m_MinX[c] = Math::Min(Math::Min(x0, x1), Math::Min(x2, x3));
+				m_MaxX[c] = Math::Max(Math::Max(x0, x1), Math::Max(x2, x3));
+				m_MinY[c] = Math::Min(Math::Min(y0, y1), Math::Min(y2, y3));
+				m_MaxY[c] = Math::Max(Math::Max(y0, y1), Math::Max(y2, y3));
+				m_MinZ[c] = nearZ;
+				m_MaxZ[c] = farZ;
+
+				// bounding sphere of the box
+				const float hx = (m_MaxX[c] - m_MinX[c]) * 0.5f;
+				const float hy = (m_MaxY[c] - m_MinY[c]) * 0.5f;
+				const float hz = (m_MaxZ[c] - m_MinZ[c]) * 0.5f;
+
+				m_CenterX[c]	= m_MinX[c] + hx;
+				m_CenterY[c]	= m_MinY[c] + hy;
+				m_CenterZ[c]	= m_MinZ[c] + hz;
+				m_Radius[c]		= sqrtf(hx * hx + hy * hy + hz * hz);
+			}
+		}
+	}
+}
+
+FORCEINLINE void LightCluster::AssignLight(UINT i_LightIndex, const LightBound & i_Light)
+{
+	const XMFLOAT3 & pos = i_Light.Position;
+	const float range = i_Light.Range;
+
+	// depth range of the light
+	const float minZ = Math::Max(pos.z - range, m_Near);
+	const float maxZ = Math::Min(pos.z + range, m_Far);
+
+	if (minZ > maxZ)
+		return;
+
+	// extend the slices by one : precision issues on the limits
+	UINT firstZ = GetSlice(minZ);
+	UINT lastZ = GetSlice(maxZ);
+	firstZ = (firstZ > 0) ? firstZ - 1 : 0;
+	lastZ = Math::Min(lastZ + 1, m_Desc.SliceCount - 1);
+
+	// sphere data
+	const XMVECTOR zero			= XMVectorZero();
+	const XMVECTOR centerX		= XMVectorReplicate(pos.x);
+	const XMVECTOR centerY		= XMVectorReplicate(pos.y);
+	const XMVECTOR centerZ		= XMVectorReplicate(pos.z);
+	const XMVECTOR radiusSq		= XMVectorReplicate(range * range);
+
+	// cone data
+	const bool isSpot			= (i_Light.Type == Light::eSpotLight);
+	const float cosAngle		= i_Light.CosAngle;
+	const float sinAngle		= sqrtf(Math::Max(1.f - cosAngle * cosAngle, 0.f));
+	const XMVECTOR dirX			= XMVectorReplicate(i_Light.Direction.x);
+	const XMVECTOR dirY			= XMVectorReplicate(i_Light.Direction.y);
+	const XMVECTOR dirZ			= XMVectorReplicate(i_Light.Direction.z);
+	const XMVECTOR cosA			= XMVectorReplicate(cosAngle);
+	const XMVECTOR sinA			= XMVectorReplicate(sinAngle);
+	const XMVECTOR rangeV		= XMVectorReplicate(range);
+
+	uint32_t mask[4];
+
+	for (UINT z = firstZ; z <= lastZ; ++z)
+	{
+		// retreive candidate tiles for this slice (conservative : cluster bounds are boxes around the froxels)
+		UINT firstX, lastX, firstY, lastY;
+		ComputeTileRange(pos.x - range, pos.x + range, m_SliceDepth[z], m_SliceDepth[z + 1], m_Projection._11, m_Desc.TileCountX, false, firstX, lastX);
+		ComputeTileRange(pos.y - range, pos.y + range, m_SliceDepth[z], m_SliceDepth[z + 1], m_Projection._22, m_Desc.TileCountY, true, firstY, lastY);
+
+		if (firstX > lastX || firstY > lastY)
+			continue;
+
+		for (UINT y = firstY; y <= lastY; ++y)
+		{
+			const UINT row = GetClusterIndex(0, y, z);
+
+			// test 4 clusters at once
+			for (UINT x = firstX; x <= lastX; x += 4)
+			{
+				const UINT c = row + x;
+
+				// sphere/box : distance between the sphere center and the box
+				const XMVECTOR ex = XMVectorAdd(XMVectorMax(XMVectorSubtract(LoadClusterData(m_MinX, c), centerX), zero), XMVectorMax(XMVectorSubtract(centerX, LoadClusterData(m_MaxX, c)), zero));
+				const XMVECTOR ey = XMVectorAdd(XMVectorMax(XMVectorSubtract(LoadClusterData(m_MinY, c), centerY), zero), XMVectorMax(XMVectorSubtract(centerY, LoadClusterData(m_MaxY, c)), zero));
+				const XMVECTOR ez = XMVectorAdd(XMVectorMax(XMVectorSubtract(LoadClusterData(m_MinZ, c), centerZ), zero), XMVectorMax(XMVectorSubtract(centerZ, LoadClusterData(m_MaxZ, c)), zero));
+				const XMVECTOR distSq = XMVectorAdd(XMVectorMultiply(ex, ex), XMVectorAdd(XMVectorMultiply(ey, ey), XMVectorMultiply(ez, ez)));
+
+				XMVECTOR inside = XMVectorLessOrEqual(distSq, radiusSq);
+
+				if (isSpot)
+				{
+					// cone/sphere : test against the bounding sphere of the cluster
+					const XMVECTOR radius	= LoadClusterData(m_Radius, c);
+					const XMVECTOR vx		= XMVectorSubtract(LoadClusterData(m_CenterX, c), centerX);
+					const XMVECTOR vy		= XMVectorSubtract(LoadClusterData(m_CenterY, c), centerY);
+					const XMVECTOR vz		= XMVectorSubtract(LoadClusterData(m_CenterZ, c), centerZ);
+					const XMVECTOR lenSq	= XMVectorAdd(XMVectorMultiply(vx, vx), XMVectorAdd(XMVectorMultiply(vy, vy), XMVectorMultiply(vz, vz)));
+					const XMVECTOR v1Len	= XMVectorAdd(XMVectorMultiply(vx, dirX), XMVectorAdd(XMVectorMultiply(vy, dirY), XMVectorMultiply(vz, dirZ)));
+					const XMVECTOR closest	= XMVectorSubtract(
+						XMVectorMultiply(cosA, XMVectorSqrt(XMVectorMax(XMVectorSubtract(lenSq, XMVectorMultiply(v1Len, v1Len)), zero))),
+						XMVectorMultiply(v1Len, sinA));
+
+					const XMVECTOR cull = XMVectorOrInt(
+						XMVectorGreater(closest, radius),
+						XMVectorOrInt(XMVectorGreater(v1Len, XMVectorAdd(radius, rangeV)), XMVectorLess(v1Len, XMVectorNegate(radius))));
+
+					inside = XMVectorAndCInt(inside, cull);
+				}
+
+				XMStoreInt4(mask, inside);
+
+				const UINT laneCount = Math::Min(4u, lastX - x + 1);
+				for (UINT lane = 0; lane < laneCount; ++lane)
+				{
+					if (mask[lane] != 0)
+						m_Pairs.push_back({ c + lane, i_LightIndex });
+				}
+			}
+		}
+	}
+}
+
+FORCEINLINE bool LightCluster::TestCluster(UINT i_Cluster, const LightBound & i_Light) const
+{
+	// same computation as AssignLight, one cluster at a time
+	const XMFLOAT3 & pos = i_Light.Position;
+	const float range = i_Light.Range;
+	const UINT c = i_Cluster;
+
+	const float ex = Math::Max(m_MinX[c] - pos.x, 0.f) + Math::Max(pos.x - m_MaxX[c], 0.f);
+	const float ey = Math::Max(m_MinY[c] - pos.y, 0.f) + Math::Max(pos.y - m_MaxY[c], 0.f);
+	const float ez = Math::Max(m_MinZ[c] - pos.z, 0.f) + Math::Max(pos.z - m_MaxZ[c], 0.f);
+	const float distSq = ex * ex + (ey * ey + ez * ez);
+
+	if (!(distSq <= range * range))
+		return false;
+
+	if (i_Light.Type == Light::eSpotLight)
+	{
+		const float cosAngle = i_Light.CosAngle;
+		const float sinAngle = sqrtf(Math::Max(1.f - cosAngle * cosAngle, 0.f));
+		const XMFLOAT3 & dir = i_Light.Direction;
+
+		const float vx = m_CenterX[c] - pos.x;
+		const float vy = m_CenterY[c] - pos.y;
+		const float vz = m_CenterZ[c] - pos.z;
+		const float lenSq = vx * vx + (vy * vy + vz * vz);
+		const float v1Len = vx * dir.x + (vy * dir.y + vz * dir.z);
+		const float closest = cosAngle * sqrtf(Math::Max(lenSq - v1Len * v1Len, 0.f)) - v1Len * sinAngle;
+
+		if (closest > m_Radius[c] || v1Len > m_Radius[c] + range || v1Len < -m_Radius[c])
+			return false;
+	}
+
+	return true;
+}
+
+FORCEINLINE void LightCluster::ResolveClusters(UINT i_TotalCount)
+{
+	UINT pairCount = i_TotalCount;
+
+	// light index list overflow : last pairs are dropped
+	if (m_GlobalLightCount + pairCount > m_Desc.MaxLightIndex)
+	{
+		PRINT_DEBUG("[LightCluster] Warning, light index list overflow (%u indices needed)", m_GlobalLightCount + pairCount);
+		m_GlobalLightCount = Math::Min(m_GlobalLightCount, m_Desc.MaxLightIndex);
+		pairCount = m_Desc.MaxLightIndex - m_GlobalLightCount;
+		m_LightIndices.resize(m_GlobalLightCount);
+	}
+
+	// count lights per cluster
+	for (UINT c = 0; c < m_ClusterCount; ++c)
+	{
+		m_Clusters[c].Count = 0;
+	}
+
+	for (UINT i = 0; i < pairCount; ++i)
+	{
+		++m_Clusters[m_Pairs[i].Cluster].Count;
+	}
+
+	// compute offsets (after global lights)
+	UINT offset = m_GlobalLightCount;
+	for (UINT c = 0; c < m_ClusterCount; ++c)
+	{
+		m_Clusters[c].Offset = offset;
+		offset += m_Clusters[c].Count;
+		m_Clusters[c].Count = 0;
+	}
+
+	// fill the index list (lights stay sorted in each cluster)
+	m_LightIndices.resize(offset);
+	for (UINT i = 0; i < pairCount; ++i)
+	{
+		ClusterData & cluster = m_Clusters[m_Pairs[i].Cluster];
+		m_LightIndices[cluster.Offset + cluster.Count++] = m_Pairs[i].Light;
+	}
+}
+
+FORCEINLINE void LightCluster::ComputeTileRange(float i_Min, float i_Max, float i_MinZ, float i_MaxZ, float i_Proj, UINT i_TileCount, bool i_Invert, UINT & o_First, UINT & o_Last) const
+{
+	// projected extents of the box (z is always positive)
+	const float p0 = i_Proj * i_Min / i_MinZ, p1 = i_Proj * i_Min / i_MaxZ;
+	const float p2 = i_Proj * i_Max / i_MinZ, p3 = i_Proj * i_Max / i_MaxZ;
+
+	float ndcMin = Math::Min(Math::Min(p0, p1), Math::Min(p2, p3));
+	float ndcMax = Math::Max(Math::Max(p0, p1), Math::Max(p2, p3));
+
+	// outside of the screen
+	if (ndcMax < -1.f || ndcMin > 1.f)
+	{
+		o_First = 1;
+		o_Last = 0;
+		return;
+	}
+
+	ndcMin = Math::Max(ndcMin, -1.f);
+	ndcMax = Math::Min(ndcMax, 1.f);
+
+	// ndc to tile coordinates (y tiles start on the top of the screen)
+	float first = (ndcMin + 1.f) * 0.5f;
+	float last = (ndcMax + 1.f) * 0.5f;
+
+	if (i_Invert)
+	{
+		const float tmp = first;
+		first = 1.f - last;
+		last = 1.f - tmp;
+	}
+
+	// extend by one tile : precision issues on the limits
+	const int firstTile = (int)(first * (float)i_TileCount) - 1;
+	const int lastTile = (int)(last * (float)i_TileCount) + 1;
+
+	o_First = (UINT)Math::Max(firstTile, 0);
+	o_Last = (UINT)Math::Min(lastTile, (int)i_TileCount - 1);
+}
@@ -0,0 +1,110 @@
+// clustered light assignment
+// the view frustum is split in froxels (screen tiles x exponential depth slices)
+// each local light is binned into the clusters it touches, the light shader only loops on the lights of its cluster
+// directional lights affect every clusters : they are stored once at the beginning of the index list
+
+#pragma once
+
+#include <Windows.h>
+#include "engine/Utils.h"
+#include <DirectXMath.h>
+#include <vector>
+
+using namespace DirectX;
+
+class LightCluster
+{
+public:
+	struct LightClusterDesc
+	{
+		UINT		TileCountX		= 16;		// screen tiles
+		UINT		TileCountY		= 9;
+		UINT		SliceCount		= 24;		// depth slices (exponential distribution)
+		UINT		MaxLightIndex	= 0x40000;	// size of the light index list for all clusters
+	};
+
+	// light bound in view space used to assign lights to clusters
+	struct LightBound
+	{
+		XMFLOAT3		Position;	// view space position
+		float			Range;
+		XMFLOAT3		Direction;	// view space direction (spot light only)
+		float			CosAngle;	// cos of the half angle (spot light only)
+		UINT			Type;		// Light::ELightType
+	};
+
+	// cluster data pushed to the GPU
+	struct ClusterData
+	{
+		UINT			Offset;		// offset in the light index list
+		UINT			Count;		// light count
+	};
+
+	// data needed by shaders to retreive the cluster of a pixel
+	struct ClusterConstants
+	{
+		UINT			ClusterCount[3];
+		UINT			GlobalLightCount;
+		XMFLOAT2		TileSize;	// tile size in pixels
+		float			SliceScale;	// slice = log(z) * scale + bias
+		float			SliceBias;
+	};
+
+	LightCluster();		// default desc
+	LightCluster(const LightClusterDesc & i_Desc);
+	~LightCluster();
+
+	// cluster management
+	void		SetupView(const XMMATRIX & i_Projection, const IntVec2 & i_RenderSize);	// compute clusters bounds (only if the view changed)
+	void		BuildClusters(const LightBound * i_Lights, UINT i_LightCount);				// assign lights to clusters (SIMD)
+	void		BuildClustersReference(const LightBound * i_Lights, UINT i_LightCount);	// brute force assignment (used for validation)
+
+	// results
+	const std::vector<ClusterData> &	GetClusters() const;
+	const std::vector<UINT> &			GetLightIndices() const;	// global lights first then clusters light lists
+	ClusterConstants					GetConstants() const;
+	UINT								GetGlobalLightCount() const;
+
+	// information
+	const LightClusterDesc &	GetDesc() const;
+	UINT						GetClusterCount() const;
+	UINT						GetClusterIndex(UINT i_X, UINT i_Y, UINT i_Z) const;
+	UINT						GetSlice(float i_ViewDepth) const;
+	UINT						CountMismatch(const LightCluster & i_Other) const;	// compare assignment results (0 if identical)
+
+private:
+	// internal helpers
+	void		ComputeClusterBounds();
+	void		AssignLight(UINT i_LightIndex, const LightBound & i_Light);
+	bool		TestCluster(UINT i_Cluster, const LightBound & i_Light) const;	// scalar test (reference)
+	void		ResolveClusters(UINT i_TotalCount);	// compute offsets and fill the light index list from the pairs
+	void		ComputeTileRange(float i_Min, float i_Max, float i_MinZ, float i_MaxZ, float i_Proj, UINT i_TileCount, bool i_Invert, UINT & o_First, UINT & o_Last) const;
+
+	// desc
+	const LightClusterDesc		m_Desc;
+	const UINT					m_ClusterCount;
+
+	// view
+	XMFLOAT4X4					m_Projection;
+	IntVec2						m_RenderSize;
+	float						m_Near, m_Far;
+	float						m_SliceScale, m_SliceBias;
+	std::vector<float>			m_SliceDepth;	// depth of each slice limits
+
+	// cluster bounds (SoA, padded to be read 4 by 4)
+	std::vector<float>			m_MinX, m_MinY, m_MinZ;
+	std::vector<float>			m_MaxX, m_MaxY, m_MaxZ;
+	std::vector<float>			m_CenterX, m_CenterY, m_CenterZ, m_Radius;	// bounding sphere (spot light cone test)
+
+	// results
+	struct ClusterLightPair
+	{
+		UINT		Cluster;
+		UINT		Light;
+	};
+
+	std::vector<ClusterLightPair>	m_Pairs;
+	std::vector<ClusterData>		m_Clusters;
+	std::vector<UINT>				m_LightIndices;
+	UINT							m_GlobalLightCount;
+};
@@ -0,0 +1,85 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <math.h>
+
+#include "engine/Clock.h"
+#include "engine/Light.h"
+#include "engine/LightCluster.h"
+#include "engine/TestUtils.h"
+
+CFLightCluster::CFLightCluster()
+	:Console::Function("light_cluster", "[check|bench] [int]", "validate or benchmark the clustered light assignment on random lights")
+{
+}
+
+bool CFLightCluster::Execute(const Console::CommandLine & i_CommandLine)
+{
+	if (i_CommandLine.m_Parameters.size() < 1)
+		return false;
+
+	const std::string mode = i_CommandLine.ToString(i_CommandLine.m_Parameters[0]);
+	UINT lightCount = 1024;
+
+	if (i_CommandLine.m_Parameters.size() > 1)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[1]))
+			return false;
+		lightCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[1]), 1);
+	}
+
+	// generate random lights in the view frustum (deterministic)
+	const float fov = 45.f * DegToRad;
+	const float ratio = 16.f / 9.f;
+	TestRandom random(0x1234567);
+
+	std::vector<LightCluster::LightBound> lights(lightCount);
+	for (UINT i = 0; i < lightCount; ++i)
+	{
+		LightCluster::LightBound & light = lights[i];
+		const float z = 0.5f + random.Unit() * 200.f;
+		const float halfHeight = z * tanf(fov * 0.5f);
+
+		light.Position	= XMFLOAT3((random.Unit() * 2.f - 1.f) * halfHeight * ratio, (random.Unit() * 2.f - 1.f) * halfHeight, z);
+		light.Range		= 0.5f + random.Unit() * 10.f;
+		light.Type		= (random.Unit() < 0.3f) ? Light::eSpotLight : Light::ePointLight;
+		light.CosAngle	= cosf((10.f + random.Unit() * 50.f) * DegToRad);
+		XMStoreFloat3(&light.Direction, XMVector3Normalize(XMVectorSet(random.Unit() * 2.f - 1.f, random.Unit() * 2.f - 1.f, random.Unit() * 2.f - 1.f, 0.f)));
+	}
+
+	LightCluster cluster;
+	cluster.SetupView(XMMatrixPerspectiveFovLH(fov, ratio, 0.1f, 1000.f), IntVec2(1920, 1080));
+
+	if (mode == "check")
+	{
+		// compare with the brute force assignment
+		LightCluster reference;
+		reference.SetupView(XMMatrixPerspectiveFovLH(fov, ratio, 0.1f, 1000.f), IntVec2(1920, 1080));
+
+		cluster.BuildClusters(lights.data(), lightCount);
+		reference.BuildClustersReference(lights.data(), lightCount);
+
+		const UINT mismatch = cluster.CountMismatch(reference);
+		GetConsole()->Print("%u lights : %u indices, %u mismatching clusters", lightCount, (UINT)cluster.GetLightIndices().size(), mismatch);
+		return mismatch == 0;
+	}
+	else if (mode == "bench")
+	{
+		const UINT iterationCount = 100;
+		const Time start = Clock::GetSystemTime();
+
+		for (UINT i = 0; i < iterationCount; ++i)
+		{
+			cluster.BuildClusters(lights.data(), lightCount);
+		}
+
+		const UINT64 elapsed = (Clock::GetSystemTime() - start).ToMicroseconds();
+		GetConsole()->Print("%u lights : %.1f us per build (%u indices)", lightCount, (float)elapsed / (float)iterationCount, (UINT)cluster.GetLightIndices().size());
+		return true;
+	}
+
+	return false;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
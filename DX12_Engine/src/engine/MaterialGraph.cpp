@@ -0,0 +1,775 @@
+#include "MaterialGraph.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+// operation definitions (same order as EOperation)
+struct OperationDesc
+{
+	const char *	Name;
+	UINT			InputCount;
+	const char *	Inputs[MATERIAL_GRAPH_MAX_INPUT];
+	float			Defaults[MATERIAL_GRAPH_MAX_INPUT];
+};
+
+static const OperationDesc s_Operations[MaterialGraph::eOperationCount] =
+{
+	{ "Constant",		0, {}, {} },
+	{ "Parameter",		0, {}, {} },
+	{ "Texcoord",		0, {}, {} },
+	{ "Normal",			0, {}, {} },
+	{ "World position",	0, {}, {} },
+	{ "Time",			0, {}, {} },
+	{ "Texture",		0, {}, {} },
+	{ "Sample",			2, { "Texture", "UV" }, { 0.f, 0.f } },
+	{ "Add",			2, { "A", "B" }, { 0.f, 0.f } },
+	{ "Subtract",		2, { "A", "B" }, { 0.f, 0.f } },
+	{ "Multiply",		2, { "A", "B" }, { 1.f, 1.f } },
+	{ "Divide",			2, { "A", "B" }, { 1.f, 1.f } },
+	{ "Min",			2, { "A", "B" }, { 0.f, 0.f } },
+	{ "Max",			2, { "A", "B" }, { 0.f, 0.f } },
+	{ "Lerp",			3, { "A", "B", "Alpha" }, { 0.f, 1.f, 0.5f } },
+	{ "Power",			2, { "Base", "Exponent" }, { 1.f, 1.f } },
+	{ "Saturate",		1, { "X" }, { 0.f } },
+	{ "One minus",		1, { "X" }, { 0.f } },
+	{ "Abs",			1, { "X" }, { 0.f } },
+	{ "Sin",			1, { "X" }, { 0.f } },
+	{ "Cos",			1, { "X" }, { 0.f } },
+	{ "Dot",			2, { "A", "B" }, { 0.f, 0.f } },
+	{ "Normalize",		1, { "X" }, { 0.f } },
+	{ "Length",			1, { "X" }, { 0.f } },
+	{ "Component",		1, { "Vector" }, { 0.f } },
+	{ "Append",			2, { "Vector", "Scalar" }, { 0.f, 0.f } },
+	{ "Output",			4, { "Diffuse", "Specular", "Normal", "Specular power" }, { 0.f, 0.f, 0.f, 0.f } },
+};
+
+static const char * s_ParameterCode[MaterialGraph::eParameterCount]		= { "ka", "kd", "ks", "ke", "ns" };
+static const char * s_ParameterNames[MaterialGraph::eParameterCount]	= { "Ambient color", "Diffuse color", "Specular color", "Emissive color", "Specular power" };
+static const char * s_TextureMapNames[MaterialGraph::eTextureMapCount]	= { "Ambient", "Diffuse", "Specular" };
+static const char * s_OutputCode[MaterialGraph::eOutputSlotCount]		= { "diffuse", "specular", "normal", "specular_power" };
+
+// helpers
+static UINT GetWidth(MaterialGraph::ENodeSlotType i_Type)
+{
+	switch (i_Type)
+	{
+	case MaterialGraph::eInt:
+	case MaterialGraph::eFloat:		return 1;
+	case MaterialGraph::eVector2:	return 2;
+	case MaterialGraph::eVector3:	return 3;
+	case MaterialGraph::eVector4:	return 4;
+	default:						return 0;
+	}
+}
+
+static MaterialGraph::ENodeSlotType GetVectorType(UINT i_Width)
+{
+	static const MaterialGraph::ENodeSlotType s_Types[] = { MaterialGraph::eNone, MaterialGraph::eFloat, MaterialGraph::eVector2, MaterialGraph::eVector3, MaterialGraph::eVector4 };
+	return i_Width <= 4 ? s_Types[i_Width] : MaterialGraph::eNone;
+}
+
+static std::string FloatToCode(float i_Value)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.9g", i_Value);
+
+	// always a float literal
+	std::string code = buffer;
+	if (code.find_first_of(".e") == std::string::npos)
+		code += ".0";
+
+	return code;
+}
+
+static std::string FormatError(UINT i_Node, MaterialGraph::EOperation i_Operation, const char * i_Message)
+{
+	char buffer[256];
+	snprintf(buffer, sizeof(buffer), "node %u (%s) : %s", i_Node, MaterialGraph::GetOperationName(i_Operation), i_Message);
+	return buffer;
+}
+
+MaterialGraph::MaterialGraph()
+{
+}
+
+MaterialGraph::~MaterialGraph()
+{
+}
+
+UINT MaterialGraph::AddNode(EOperation i_Operation, UINT i_Parameter)
+{
+	GraphNode node;
+	node.Operation	= i_Operation;
+	node.Parameter	= i_Parameter;
+	node.Type		= eNone;
+
+	for (UINT i = 0; i < 4; ++i)
+	{
+		node.Value[i] = 0.f;
+	}
+
+	for (UINT i = 0; i < MATERIAL_GRAPH_MAX_INPUT; ++i)
+	{
+		node.Inputs[i].Default = s_Operations[i_Operation].Defaults[i];
+	}
+
+	m_Nodes.push_back(node);
+	return (UINT)m_Nodes.size() - 1;
+}
+
+UINT MaterialGraph::AddConstant(ENodeSlotType i_Type, float i_X, float i_Y, float i_Z, float i_W)
+{
+	const UINT index = AddNode(eConstant);
+	GraphNode & node = m_Nodes[index];
+
+	node.Type		= i_Type;
+	node.Value[0]	= i_X;
+	node.Value[1]	= i_Y;
+	node.Value[2]	= i_Z;
+	node.Value[3]	= i_W;
+
+	return index;
+}
+
+bool MaterialGraph::Link(UINT i_From, UINT i_To, UINT i_Slot)
+{
+	if (i_From >= m_Nodes.size() || i_To >= m_Nodes.size() || i_From == i_To)
+		return false;
+
+	// the output node has no output
+	if (m_Nodes[i_From].Operation == eOutput || i_Slot >= GetInputCount(m_Nodes[i_To].Operation))
+		return false;
+
+	m_Nodes[i_To].Inputs[i_Slot].Node = i_From;
+	return true;
+}
+
+void MaterialGraph::SetDefaultValue(UINT i_Node, UINT i_Slot, float i_Value)
+{
+	if (i_Node < m_Nodes.size() && i_Slot < MATERIAL_GRAPH_MAX_INPUT)
+		m_Nodes[i_Node].Inputs[i_Slot].Default = i_Value;
+}
+
+void MaterialGraph::Clear()
+{
+	m_Nodes.clear();
+}
+
+UINT MaterialGraph::GetNodeCount() const
+{
+	return (UINT)m_Nodes.size();
+}
+
+MaterialGraph::EOperation MaterialGraph::GetOperation(UINT i_Node) const
+{
+	return m_Nodes[i_Node].Operation;
+}
+
+bool MaterialGraph::Compile(CompileResult & o_Result) const
+{
+	o_Result = CompileResult();
+	o_Result.NodeCount = (UINT)m_Nodes.size();
+
+	// the output node
+	UINT output = InvalidNode;
+
+	for (UINT i = 0; i < (UINT)m_Nodes.size(); ++i)
+	{
+		if (m_Nodes[i].Operation != eOutput)
+			continue;
+
+		if (output != InvalidNode)
+		{
+			o_Result.Error = "the graph has several output nodes";
+			return false;
+		}
+
+		output = i;
+	}
+
+	if (output == InvalidNode)
+	{
+		o_Result.Error = "the graph has no output node";
+		return false;
+	}
+
+	// live nodes in dependency order (the output is the last one)
+	std::vector<UINT> order;
+	if (!SortLiveNodes(output, order, o_Result.Error))
+		return false;
+
+	o_Result.LiveNodeCount = (UINT)order.size();
+
+	// evaluate the nodes : constants are folded, the other expressions are assigned once to a variable
+	std::vector<Value> values(m_Nodes.size());
+	std::map<std::string, std::string> expressions;	// expression to variable
+	std::string body;
+
+	for (size_t i = 0; i + 1 < order.size(); ++i)
+	{
+		const UINT index = order[i];
+		const EOperation operation = m_Nodes[index].Operation;
+		Value & value = values[index];
+
+		if (!EvaluateNode(index, values, value, o_Result.Error))
+			return false;
+
+		if (value.Constant)
+		{
+			if (operation != eConstant)
+				++o_Result.FoldedNodeCount;
+			continue;
+		}
+
+		if (value.Type == eTexture)
+			continue;
+
+		// sources are used in place
+		const bool source = (operation >= eParameter && operation <= eTime);
+		auto itr = expressions.find(value.Code);
+
+		if (itr != expressions.end())
+		{
+			++o_Result.MergedNodeCount;
+			value.Code = itr->second;
+			continue;
+		}
+
+		if (source)
+		{
+			expressions[value.Code] = value.Code;
+			continue;
+		}
+
+		char variable[16];
+		snprintf(variable, sizeof(variable), "v%u", o_Result.InstructionCount++);
+
+		body += std::string("\tconst ") + GetTypeName(value.Type) + " " + variable + " = " + value.Code + ";\n";
+		expressions[value.Code] = variable;
+		value.Code = variable;
+	}
+
+	// material outputs
+	static const ENodeSlotType s_OutputTypes[eOutputSlotCount] = { eVector4, eVector4, eVector3, eFloat };
+
+	for (UINT slot = 0; slot < eOutputSlotCount; ++slot)
+	{
+		const UINT source = m_Nodes[output].Inputs[slot].Node;
+
+		if (source == InvalidNode)
+			continue;
+
+		const Value & value = values[source];
+		const UINT width = GetWidth(value.Type);
+		bool valid = false;
+
+		switch (slot)
+		{
+		case eOutputDiffuse:
+		case eOutputSpecular:		valid = (width == 1 || width == 3 || width == 4);	break;
+		case eOutputNormal:			valid = (width == 3);								break;
+		case eOutputSpecularPower:	valid = (width == 1);								break;
+		}
+
+		if (!valid)
+		{
+			o_Result.Error = FormatError(output, eOutput, (std::string("invalid type for the ") + s_Operations[eOutput].Inputs[slot] + " input").c_str());
+			return false;
+		}
+
+		body += std::string("\tio_Output.") + s_OutputCode[slot] + " = " + ToCode(value, s_OutputTypes[slot]) + ";\n";
+	}
+
+	// shader file
+	char statistics[128];
+	snprintf(statistics, sizeof(statistics), "// nodes : %u, live : %u, folded : %u, merged : %u, instructions : %u\n",
+		o_Result.NodeCount, o_Result.LiveNodeCount, o_Result.FoldedNodeCount, o_Result.MergedNodeCount, o_Result.InstructionCount);
+
+	o_Result.Code =
+		"// generated by the material graph compiler (see MaterialGraph) : do not edit\n"
+		+ std::string(statistics)
+		+ "\n"
+		"#include \"../lib/MaterialGraph.hlsli\"\n"
+		"\n"
+		"void EvaluateMaterial(const MaterialInput i_Input, inout MaterialOutput io_Output)\n"
+		"{\n"
+		+ body
+		+ "}\n"
+		"\n"
+		"#include \"../rendering/GBufferPS.hlsl\"\n";
+
+	o_Result.Success = true;
+	return true;
+}
+
+const char * MaterialGraph::GetOperationName(EOperation i_Operation)
+{
+	return i_Operation < eOperationCount ? s_Operations[i_Operation].Name : "Unknown";
+}
+
+const char * MaterialGraph::GetInputName(EOperation i_Operation, UINT i_Slot)
+{
+	return i_Slot < GetInputCount(i_Operation) ? s_Operations[i_Operation].Inputs[i_Slot] : "";
+}
+
+UINT MaterialGraph::GetInputCount(EOperation i_Operation)
+{
+	return i_Operation < eOperationCount ? s_Operations[i_Operation].InputCount : 0;
+}
+
+const char * MaterialGraph::GetParameterName(EParameter i_Parameter)
+{
+	return i_Parameter < eParameterCount ? s_ParameterNames[i_Parameter] : "Unknown";
+}
+
+const char * MaterialGraph::GetTextureMapName(ETextureMap i_Map)
+{
+	return i_Map < eTextureMapCount ? s_TextureMapNames[i_Map] : "Unknown";
+}
+
+bool MaterialGraph::WriteShader(const std::string & i_Filename, const CompileResult & i_Result)
+{
+	if (!i_Result.Success)
+		return false;
+
+	std::ofstream file(i_Filename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	file.write(i_Result.Code.c_str(), i_Result.Code.size());
+	return file.good();
+}
+
+bool MaterialGraph::SortLiveNodes(UINT i_Output, std::vector<UINT> & o_Order, std::string & o_Error) const
+{
+	// depth first from the output, the nodes are added when their inputs are sorted
+	enum EVisit { eUnvisited, eVisiting, eSorted };
+	std::vector<EVisit> visits(m_Nodes.size(), eUnvisited);
+	std::vector<std::pair<UINT, UINT>> stack;	// node, next input
+
+	stack.push_back(std::make_pair(i_Output, 0u));
+	visits[i_Output] = eVisiting;
+
+	while (!stack.empty())
+	{
+		const UINT index = stack.back().first;
+		const UINT slot = stack.back().second;
+		const GraphNode & node = m_Nodes[index];
+
+		if (slot == GetInputCount(node.Operation))
+		{
+			visits[index] = eSorted;
+			o_Order.push_back(index);
+			stack.pop_back();
+			continue;
+		}
+
+		++stack.back().second;
+		const UINT input = node.Inputs[slot].Node;
+
+		if (input == InvalidNode || visits[input] == eSorted)
+			continue;
+
+		if (visits[input] == eVisiting)
+		{
+			o_Error = FormatError(input, m_Nodes[input].Operation, "the node is in a cycle");
+			return false;
+		}
+
+		visits[input] = eVisiting;
+		stack.push_back(std::make_pair(input, 0u));
+	}
+
+	return true;
+}
+
+MaterialGraph::Value MaterialGraph::GetInputValue(UINT i_Node, UINT i_Slot, const std::vector<Value> & i_Values) const
+{
+	const Input & input = m_Nodes[i_Node].Inputs[i_Slot];
+
+	if (input.Node != InvalidNode)
+		return i_Values[input.Node];
+
+	// unlinked input : scalar constant
+	Value value;
+	value.Type		= eFloat;
+	value.Constant	= true;
+	value.Lanes[0]	= input.Default;
+
+	return value;
+}
+
+bool MaterialGraph::EvaluateNode(UINT i_Node, const std::vector<Value> & i_Values, Value & o_Value, std::string & o_Error) const
+{
+	const GraphNode & node = m_Nodes[i_Node];
+	const UINT inputCount = GetInputCount(node.Operation);
+
+	Value inputs[MATERIAL_GRAPH_MAX_INPUT];
+	bool constant = true;
+	UINT width = 0;
+
+	for (UINT i = 0; i < inputCount; ++i)
+	{
+		inputs[i] = GetInputValue(i_Node, i, i_Values);
+		constant &= inputs[i].Constant;
+		width = (GetWidth(inputs[i].Type) > width) ? GetWidth(inputs[i].Type) : width;
+	}
+
+	const Value & a = inputs[0];
+	const Value & b = inputs[1];
+	const Value & c = inputs[2];
+
+	#define GRAPH_ERROR(message)	{ o_Error = FormatError(i_Node, node.Operation, message); return false; }
+	#define LANE(value, lane)		((value).Lanes[GetWidth((value).Type) == 1 ? 0 : (lane)])
+
+	o_Value = Value();
+
+	switch (node.Operation)
+	{
+	// sources
+	case eConstant:
+		if (GetWidth(node.Type) == 0)
+			GRAPH_ERROR("invalid constant type");
+
+		o_Value.Type = node.Type;
+		o_Value.Constant = true;
+		for (UINT i = 0; i < 4; ++i)
+		{
+			o_Value.Lanes[i] = (node.Type == eInt) ? (float)(int)node.Value[i] : node.Value[i];
+		}
+		return true;
+
+	case eParameter:
+		if (node.Parameter >= eParameterCount)
+			GRAPH_ERROR("invalid parameter");
+
+		o_Value.Type = (node.Parameter == eSpecularPower) ? eFloat : eVector4;
+		o_Value.Code = s_ParameterCode[node.Parameter];
+		return true;
+
+	case eTexcoord:			o_Value.Type = eVector2;	o_Value.Code = "i_Input.uv";		return true;
+	case eNormal:			o_Value.Type = eVector3;	o_Value.Code = "i_Input.normal";	return true;
+	case eWorldPosition:	o_Value.Type = eVector3;	o_Value.Code = "i_Input.position";	return true;
+	case eTime:				o_Value.Type = eFloat;		o_Value.Code = "app_time";			return true;
+
+	case eTextureMap:
+		if (node.Parameter >= eTextureMapCount)
+			GRAPH_ERROR("invalid texture map");
+
+		o_Value.Type = eTexture;
+		o_Value.Code = s_TextureMapNames[node.Parameter];
+		return true;
+
+	case eSample:
+	{
+		if (a.Type != eTexture)
+			GRAPH_ERROR("the texture input needs a texture");
+
+		const bool uvLinked = (node.Inputs[1].Node != InvalidNode);
+		if (uvLinked && b.Type != eVector2)
+			GRAPH_ERROR("the uv input needs a vector2");
+
+		o_Value.Type = eVector4;
+		o_Value.Code = "Sample" + a.Code + "Map(" + (uvLinked ? ToCode(b) : std::string("i_Input.uv")) + ")";
+		return true;
+	}
+
+	default:
+		break;
+	}
+
+	// the remaining operations take numeric inputs
+	for (UINT i = 0; i < inputCount; ++i)
+	{
+		if (GetWidth(inputs[i].Type) == 0)
+			GRAPH_ERROR("the inputs need numeric values");
+	}
+
+	ENodeSlotType type = eNone;
+
+	switch (node.Operation)
+	{
+	// component wise
+	case eAdd:
+	case eSubtract:
+	case eMultiply:
+	case eDivide:
+	case eMin:
+	case eMax:
+	case ePower:
+	case eLerp:
+	{
+		for (UINT i = 0; i < inputCount; ++i)
+		{
+			const UINT inputWidth = GetWidth(inputs[i].Type);
+			if (inputWidth != 1 && inputWidth != width)
+				GRAPH_ERROR("the vector inputs need the same size");
+		}
+
+		// integers only for the basic operations
+		const bool integer = (a.Type == eInt && b.Type == eInt && node.Operation <= eMax);
+		type = (integer && width == 1) ? eInt : GetVectorType(width);
+
+		if (integer && node.Operation == eDivide && constant && b.Lanes[0] == 0.f)
+			constant = false;	// division by zero : left to the GPU
+
+		if (constant)
+		{
+			for (UINT i = 0; i < width; ++i)
+			{
+				const float x = LANE(a, i), y = LANE(b, i);
+				float & result = o_Value.Lanes[i];
+
+				switch (node.Operation)
+				{
+				case eAdd:		result = x + y;						break;
+				case eSubtract:	result = x - y;						break;
+				case eMultiply:	result = x * y;						break;
+				case eDivide:	result = x / y;						break;
+				case eMin:		result = (x < y) ? x : y;			break;
+				case eMax:		result = (x > y) ? x : y;			break;
+				case ePower:	result = powf(x, y);				break;
+				case eLerp:		result = x + (y - x) * LANE(c, i);	break;
+				default:		break;
+				}
+
+				if (type == eInt)
+					result = (float)(int)result;
+			}
+			break;
+		}
+
+		// intrinsics take inputs of the same size
+		switch (node.Operation)
+		{
+		case eAdd:		o_Value.Code = ToCode(a) + " + " + ToCode(b);	break;
+		case eSubtract:	o_Value.Code = ToCode(a) + " - " + ToCode(b);	break;
+		case eMultiply:	o_Value.Code = ToCode(a) + " * " + ToCode(b);	break;
+		case eDivide:	o_Value.Code = ToCode(a) + " / " + ToCode(b);	break;
+		case eMin:		o_Value.Code = "min(" + ToCode(a, type) + ", " + ToCode(b, type) + ")";	break;
+		case eMax:		o_Value.Code = "max(" + ToCode(a, type) + ", " + ToCode(b, type) + ")";	break;
+		case ePower:	o_Value.Code = "pow(" + ToCode(a, type) + ", " + ToCode(b, type) + ")";	break;
+		case eLerp:		o_Value.Code = "lerp(" + ToCode(a, type) + ", " + ToCode(b, type) + ", " + ToCode(c, type) + ")";	break;
+		default:		break;
+		}
+		break;
+	}
+
+	case eSaturate:
+	case eOneMinus:
+	case eAbs:
+	case eSin:
+	case eCos:
+		type = GetVectorType(width);
+
+		if (constant)
+		{
+			for (UINT i = 0; i < width; ++i)
+			{
+				const float x = a.Lanes[i];
+				float & result = o_Value.Lanes[i];
+
+				switch (node.Operation)
+				{
+				case eSaturate:	result = (x < 0.f) ? 0.f : ((x > 1.f) ? 1.f : x);	break;
+				case eOneMinus:	result = 1.f - x;	break;
+				case eAbs:		result = fabsf(x);	break;
+				case eSin:		result = sinf(x);	break;
+				case eCos:		result = cosf(x);	break;
+				default:		break;
+				}
+			}
+			break;
+		}
+
+		switch (node.Operation)
+		{
+		case eSaturate:	o_Value.Code = "saturate(" + ToCode(a, type) + ")";	break;
+		case eOneMinus:	o_Value.Code = "1.0 - " + ToCode(a, type);			break;
+		case eAbs:		o_Value.Code = "abs(" + ToCode(a, type) + ")";		break;
+		case eSin:		o_Value.Code = "sin(" + ToCode(a, type) + ")";		break;
+		case eCos:		o_Value.Code = "cos(" + ToCode(a, type) + ")";		break;
+		default:		break;
+		}
+		break;
+
+	case eDot:
+		if (GetWidth(a.Type) != GetWidth(b.Type))
+			GRAPH_ERROR("the vector inputs need the same size");
+
+		type = eFloat;
+
+		if (constant)
+		{
+			for (UINT i = 0; i < width; ++i)
+			{
+				o_Value.Lanes[0] += a.Lanes[i] * b.Lanes[i];
+			}
+			break;
+		}
+
+		o_Value.Code = "dot(" + ToCode(a, GetVectorType(width)) + ", " + ToCode(b, GetVectorType(width)) + ")";
+		break;
+
+	case eNormalize:
+	case eLength:
+	{
+		if (node.Operation == eNormalize && width < 2)
+			GRAPH_ERROR("the input needs a vector");
+
+		type = (node.Operation == eNormalize) ? GetVectorType(width) : eFloat;
+
+		if (constant)
+		{
+			float length = 0.f;
+			for (UINT i = 0; i < width; ++i)
+			{
+				length += a.Lanes[i] * a.Lanes[i];
+			}
+			length = sqrtf(length);
+
+			if (node.Operation == eLength)
+			{
+				o_Value.Lanes[0] = length;
+				break;
+			}
+
+			if (length == 0.f)
+				GRAPH_ERROR("the vector is null");
+
+			for (UINT i = 0; i < width; ++i)
+			{
+				o_Value.Lanes[i] = a.Lanes[i] / length;
+			}
+			break;
+		}
+
+		o_Value.Code = std::string(node.Operation == eNormalize ? "normalize(" : "length(") + ToCode(a, GetVectorType(width)) + ")";
+		break;
+	}
+
+	case eComponent:
+		if (node.Parameter >= width)
+			GRAPH_ERROR("invalid component");
+
+		type = (a.Type == eInt) ? eInt : eFloat;
+
+		if (constant)
+		{
+			o_Value.Lanes[0] = a.Lanes[node.Parameter];
+			break;
+		}
+
+		o_Value.Code = ToCode(a) + "." + "xyzw"[node.Parameter];
+		break;
+
+	case eAppend:
+		if (GetWidth(a.Type) > 3 || GetWidth(b.Type) != 1)
+			GRAPH_ERROR("the inputs need a vector (up to 3 components) and a scalar");
+
+		type = GetVectorType(GetWidth(a.Type) + 1);
+
+		if (constant)
+		{
+			for (UINT i = 0; i < GetWidth(a.Type); ++i)
+			{
+				o_Value.Lanes[i] = a.Lanes[i];
+			}
+			o_Value.Lanes[GetWidth(a.Type)] = b.Lanes[0];
+			break;
+		}
+
+		o_Value.Code = std::string(GetTypeName(type)) + "(" + ToCode(a, GetVectorType(GetWidth(a.Type))) + ", " + ToCode(b, eFloat) + ")";
+		break;
+
+	default:
+		GRAPH_ERROR("invalid operation");
+	}
+
+	o_Value.Type = type;
+	o_Value.Constant = constant;
+
+	// folded values are written as literals
+	if (constant)
+	{
+		for (UINT i = 0; i < GetWidth(type); ++i)
+		{
+			if (!std::isfinite(o_Value.Lanes[i]))
+				GRAPH_ERROR("the constant value is not a finite number");
+		}
+	}
+
+	#undef LANE
+	#undef GRAPH_ERROR
+
+	return true;
+}
+
+std::string MaterialGraph::ToCode(const Value & i_Value)
+{
+	if (!i_Value.Constant)
+		return i_Value.Code;
+
+	const UINT width = GetWidth(i_Value.Type);
+
+	if (i_Value.Type == eInt)
+		return std::to_string((int)i_Value.Lanes[0]);
+
+	if (width == 1)
+		return FloatToCode(i_Value.Lanes[0]);
+
+	std::string code = std::string(GetTypeName(i_Value.Type)) + "(";
+	for (UINT i = 0; i < width; ++i)
+	{
+		code += (i > 0 ? ", " : "") + FloatToCode(i_Value.Lanes[i]);
+	}
+
+	return code + ")";
+}
+
+std::string MaterialGraph::ToCode(const Value & i_Value, ENodeSlotType i_Type)
+{
+	const UINT width = GetWidth(i_Value.Type);
+	const UINT targetWidth = GetWidth(i_Type);
+
+	if (i_Value.Type == i_Type)
+		return ToCode(i_Value);
+
+	if (i_Value.Constant)
+	{
+		// scalars are broadcasted, the alpha of a color is 1
+		Value value = i_Value;
+		value.Type = i_Type;
+
+		for (UINT i = width; i < targetWidth; ++i)
+		{
+			value.Lanes[i] = (width == 1) ? i_Value.Lanes[0] : 1.f;
+		}
+
+		return ToCode(value);
+	}
+
+	if (width == 1 && targetWidth > 1)
+		return std::string("(") + GetTypeName(i_Type) + ")" + i_Value.Code;
+
+	if (width == 3 && targetWidth == 4)
+		return "float4(" + i_Value.Code + ", 1.0)";
+
+	return i_Value.Code;
+}
+
+const char * MaterialGraph::GetTypeName(ENodeSlotType i_Type)
+{
+	switch (i_Type)
+	{
+	case eInt:		return "int";
+	case eFloat:	return "float";
+	case eVector2:	return "float2";
+	case eVector3:	return "float3";
+	case eVector4:	return "float4";
+	default:		return "void";
+	}
+}
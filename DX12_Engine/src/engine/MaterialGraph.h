@@ -0,0 +1,165 @@
+// Material graph
+// intermediate representation of a material node graph (see UIMaterialBuilder) and its compiler to HLSL
+// nodes are operations with typed inputs (see NodeSlot) and one output, links connect the output of a node to an input
+// unlinked inputs use the default value of the input, the output node override the values of the material (see MaterialGraph.hlsli)
+// the compiler sorts the nodes from the output, removes the dead nodes, folds the constant subgraphs, merges the common subexpressions
+// and emits a pixel shader that includes GBufferPS.hlsl : the material permutations (mesh layout, maps, GBuffer layout) are compiled by the shader cache
+// the compiler only uses the standard library : the emitted code is deterministic (see material_graph_check)
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+
+#include "editor/Node/NodeSlot.h"
+
+#define MATERIAL_GRAPH_MAX_INPUT		4
+
+class MaterialGraph : public NodeSlot	// value types of the nodes
+{
+public:
+	static const UINT InvalidNode = (UINT)-1;
+
+	enum EOperation
+	{
+		// sources
+		eConstant,			// value of the node
+		eParameter,			// material constant (EParameter)
+		eTexcoord,
+		eNormal,			// world space
+		eWorldPosition,
+		eTime,				// application time
+		eTextureMap,		// material map (ETextureMap)
+		eSample,			// texture, uv (mesh uv when unlinked)
+		// math : component wise, scalars are broadcasted
+		eAdd,
+		eSubtract,
+		eMultiply,
+		eDivide,
+		eMin,
+		eMax,
+		eLerp,
+		ePower,
+		eSaturate,
+		eOneMinus,
+		eAbs,
+		eSin,
+		eCos,
+		eDot,
+		eNormalize,
+		eLength,
+		// vectors
+		eComponent,			// component of a vector (parameter : 0 to 3)
+		eAppend,			// vector and scalar : one more component
+		// material
+		eOutput,			// EOutputSlot : the unlinked outputs keep the material values
+
+		eOperationCount,
+	};
+
+	enum EParameter
+	{
+		eAmbientColor,
+		eDiffuseColor,
+		eSpecularColor,
+		eEmissiveColor,
+		eSpecularPower,
+
+		eParameterCount,
+	};
+
+	enum ETextureMap
+	{
+		eAmbientMap,
+		eDiffuseMap,
+		eSpecularMap,
+
+		eTextureMapCount,
+	};
+
+	enum EOutputSlot
+	{
+		eOutputDiffuse,
+		eOutputSpecular,
+		eOutputNormal,
+		eOutputSpecularPower,
+
+		eOutputSlotCount,
+	};
+
+	struct CompileResult
+	{
+		bool			Success = false;
+		std::string		Error;
+		std::string		Code;	// pixel shader file
+
+		// statistics
+		UINT			NodeCount = 0;
+		UINT			LiveNodeCount = 0;		// nodes used by the output
+		UINT			FoldedNodeCount = 0;	// operations computed by the compiler
+		UINT			MergedNodeCount = 0;	// common subexpressions
+		UINT			InstructionCount = 0;	// values computed by the shader
+	};
+
+	MaterialGraph();
+	~MaterialGraph();
+
+	// graph
+	UINT			AddNode(EOperation i_Operation, UINT i_Parameter = 0);
+	UINT			AddConstant(ENodeSlotType i_Type, float i_X, float i_Y = 0.f, float i_Z = 0.f, float i_W = 0.f);
+	bool			Link(UINT i_From, UINT i_To, UINT i_Slot);		// output of i_From to the input slot of i_To (replace the previous link)
+	void			SetDefaultValue(UINT i_Node, UINT i_Slot, float i_Value);	// value of the input when not linked
+	void			Clear();
+
+	UINT			GetNodeCount() const;
+	EOperation		GetOperation(UINT i_Node) const;
+
+	// compile the graph to a pixel shader, errors are reported in the result
+	bool			Compile(CompileResult & o_Result) const;
+
+	// helpers
+	static const char *		GetOperationName(EOperation i_Operation);
+	static const char *		GetInputName(EOperation i_Operation, UINT i_Slot);
+	static UINT				GetInputCount(EOperation i_Operation);
+	static const char *		GetParameterName(EParameter i_Parameter);
+	static const char *		GetTextureMapName(ETextureMap i_Map);
+	static bool				WriteShader(const std::string & i_Filename, const CompileResult & i_Result);
+
+private:
+	struct Input
+	{
+		UINT		Node = InvalidNode;		// linked node
+		float		Default = 0.f;
+	};
+
+	struct GraphNode
+	{
+		EOperation		Operation;
+		UINT			Parameter;
+		ENodeSlotType		Type;		// constant
+		float			Value[4];	// constant
+		Input			Inputs[MATERIAL_GRAPH_MAX_INPUT];
+	};
+
+	// value of a node or an input while compiling
+	struct Value
+	{
+		ENodeSlotType		Type = eNone;
+		bool			Constant = false;
+		float			Lanes[4] = {};
+		std::string		Code;		// expression (variables and sources)
+	};
+
+	// compiler passes
+	bool			SortLiveNodes(UINT i_Output, std::vector<UINT> & o_Order, std::string & o_Error) const;
+	bool			EvaluateNode(UINT i_Node, const std::vector<Value> & i_Values, Value & o_Value, std::string & o_Error) const;
+	Value			GetInputValue(UINT i_Node, UINT i_Slot, const std::vector<Value> & i_Values) const;
+
+	// code helpers
+	static std::string		ToCode(const Value & i_Value);
+	static std::string		ToCode(const Value & i_Value, ENodeSlotType i_Type);	// converted value
+	static const char *		GetTypeName(ENodeSlotType i_Type);
+
+	std::vector<GraphNode>	m_Nodes;
+};
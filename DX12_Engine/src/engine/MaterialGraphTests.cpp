@@ -0,0 +1,243 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <string>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/MaterialGraph.h"
+
+CFMaterialGraphCheck::CFMaterialGraphCheck()
+	:Console::Function("material_graph_check", "[chain length]", "compile material graphs and compare the generated shaders to the expected ones, time the compilation of a long chain")
+{
+}
+
+bool CFMaterialGraphCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT chainLength = 1000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		chainLength = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	// expected shaders (the code of the graphs is deterministic)
+	#define GRAPH_SHADER_HEADER(stats)		"// generated by the material graph compiler (see MaterialGraph) : do not edit\n" \
+											"// " stats "\n" \
+											"\n" \
+											"#include \"../lib/MaterialGraph.hlsli\"\n" \
+											"\n" \
+											"void EvaluateMaterial(const MaterialInput i_Input, inout MaterialOutput io_Output)\n" \
+											"{\n"
+	#define GRAPH_SHADER_FOOTER				"}\n" \
+											"\n" \
+											"#include \"../rendering/GBufferPS.hlsl\"\n"
+
+	struct GraphCase
+	{
+		const char *	Name;
+		const char *	Expected;	// shader or error
+		MaterialGraph	Graph;
+	};
+
+	GraphCase cases[6];
+	UINT errors = 0;
+
+	// diffuse map modulated by the diffuse color
+	{
+		GraphCase & graphCase = cases[0];
+		MaterialGraph & graph = graphCase.Graph;
+		graphCase.Name = "diffuse map";
+		graphCase.Expected =
+			GRAPH_SHADER_HEADER("nodes : 5, live : 5, folded : 0, merged : 0, instructions : 2")
+			"\tconst float4 v0 = SampleDiffuseMap(i_Input.uv);\n"
+			"\tconst float4 v1 = v0 * kd;\n"
+			"\tio_Output.diffuse = v1;\n"
+			GRAPH_SHADER_FOOTER;
+
+		const UINT texture = graph.AddNode(MaterialGraph::eTextureMap, MaterialGraph::eDiffuseMap);
+		const UINT sample = graph.AddNode(MaterialGraph::eSample);
+		const UINT color = graph.AddNode(MaterialGraph::eParameter, MaterialGraph::eDiffuseColor);
+		const UINT multiply = graph.AddNode(MaterialGraph::eMultiply);
+		const UINT output = graph.AddNode(MaterialGraph::eOutput);
+
+		graph.Link(texture, sample, 0);
+		graph.Link(sample, multiply, 0);
+		graph.Link(color, multiply, 1);
+		graph.Link(multiply, output, MaterialGraph::eOutputDiffuse);
+	}
+
+	// constant subgraphs are folded, the unused nodes are removed
+	{
+		GraphCase & graphCase = cases[1];
+		MaterialGraph & graph = graphCase.Graph;
+		graphCase.Name = "constant folding";
+		graphCase.Expected =
+			GRAPH_SHADER_HEADER("nodes : 10, live : 8, folded : 3, merged : 0, instructions : 0")
+			"\tio_Output.diffuse = float4(1.0, 0.5, 1.0, 1.0);\n"
+			"\tio_Output.specular_power = 8.0;\n"
+			GRAPH_SHADER_FOOTER;
+
+		const UINT color = graph.AddConstant(MaterialGraph::eVector3, 0.5f, 0.25f, 1.f);
+		const UINT scale = graph.AddConstant(MaterialGraph::eFloat, 2.f);
+		const UINT multiply = graph.AddNode(MaterialGraph::eMultiply);
+		const UINT saturate = graph.AddNode(MaterialGraph::eSaturate);
+		const UINT time = graph.AddNode(MaterialGraph::eTime);
+		const UINT wave = graph.AddNode(MaterialGraph::eSin);
+		const UINT output = graph.AddNode(MaterialGraph::eOutput);
+		const UINT base = graph.AddConstant(MaterialGraph::eInt, 2.f);
+		const UINT exponent = graph.AddConstant(MaterialGraph::eFloat, 3.f);
+		const UINT power = graph.AddNode(MaterialGraph::ePower);
+
+		graph.Link(color, multiply, 0);
+		graph.Link(scale, multiply, 1);
+		graph.Link(multiply, saturate, 0);
+		graph.Link(saturate, output, MaterialGraph::eOutputDiffuse);
+		graph.Link(time, wave, 0);
+		graph.Link(base, power, 0);
+		graph.Link(exponent, power, 1);
+		graph.Link(power, output, MaterialGraph::eOutputSpecularPower);
+	}
+
+	// common subexpressions are computed once
+	{
+		GraphCase & graphCase = cases[2];
+		MaterialGraph & graph = graphCase.Graph;
+		graphCase.Name = "common subexpressions";
+		graphCase.Expected =
+			GRAPH_SHADER_HEADER("nodes : 12, live : 12, folded : 0, merged : 2, instructions : 4")
+			"\tconst float4 v0 = SampleDiffuseMap(i_Input.uv);\n"
+			"\tconst float4 v1 = v0 + v0;\n"
+			"\tconst float4 v2 = lerp(ka, ks, float4(0.5, 0.5, 0.5, 0.5));\n"
+			"\tconst float3 v3 = normalize(i_Input.normal);\n"
+			"\tio_Output.diffuse = v1;\n"
+			"\tio_Output.specular = v2;\n"
+			"\tio_Output.normal = v3;\n"
+			GRAPH_SHADER_FOOTER;
+
+		const UINT uv0 = graph.AddNode(MaterialGraph::eTexcoord);
+		const UINT uv1 = graph.AddNode(MaterialGraph::eTexcoord);
+		const UINT texture = graph.AddNode(MaterialGraph::eTextureMap, MaterialGraph::eDiffuseMap);
+		const UINT sample0 = graph.AddNode(MaterialGraph::eSample);
+		const UINT sample1 = graph.AddNode(MaterialGraph::eSample);
+		const UINT add = graph.AddNode(MaterialGraph::eAdd);
+		const UINT normal = graph.AddNode(MaterialGraph::eNormal);
+		const UINT unit = graph.AddNode(MaterialGraph::eNormalize);
+		const UINT ambient = graph.AddNode(MaterialGraph::eParameter, MaterialGraph::eAmbientColor);
+		const UINT specular = graph.AddNode(MaterialGraph::eParameter, MaterialGraph::eSpecularColor);
+		const UINT blend = graph.AddNode(MaterialGraph::eLerp);
+		const UINT output = graph.AddNode(MaterialGraph::eOutput);
+
+		graph.Link(texture, sample0, 0);
+		graph.Link(uv0, sample0, 1);
+		graph.Link(texture, sample1, 0);
+		graph.Link(uv1, sample1, 1);
+		graph.Link(sample0, add, 0);
+		graph.Link(sample1, add, 1);
+		graph.Link(normal, unit, 0);
+		graph.Link(ambient, blend, 0);
+		graph.Link(specular, blend, 1);
+		graph.Link(add, output, MaterialGraph::eOutputDiffuse);
+		graph.Link(blend, output, MaterialGraph::eOutputSpecular);
+		graph.Link(unit, output, MaterialGraph::eOutputNormal);
+	}
+
+	// errors
+	{
+		GraphCase & graphCase = cases[3];
+		MaterialGraph & graph = graphCase.Graph;
+		graphCase.Name = "cycle";
+		graphCase.Expected = "node 1 (Add) : the node is in a cycle";
+
+		const UINT add0 = graph.AddNode(MaterialGraph::eAdd);
+		const UINT add1 = graph.AddNode(MaterialGraph::eAdd);
+		const UINT output = graph.AddNode(MaterialGraph::eOutput);
+
+		graph.Link(add0, add1, 0);
+		graph.Link(add1, add0, 0);
+		graph.Link(add1, output, MaterialGraph::eOutputSpecularPower);
+	}
+
+	{
+		GraphCase & graphCase = cases[4];
+		MaterialGraph & graph = graphCase.Graph;
+		graphCase.Name = "type mismatch";
+		graphCase.Expected = "node 2 (Add) : the vector inputs need the same size";
+
+		const UINT uv = graph.AddNode(MaterialGraph::eTexcoord);
+		const UINT normal = graph.AddNode(MaterialGraph::eNormal);
+		const UINT add = graph.AddNode(MaterialGraph::eAdd);
+		const UINT output = graph.AddNode(MaterialGraph::eOutput);
+
+		graph.Link(uv, add, 0);
+		graph.Link(normal, add, 1);
+		graph.Link(add, output, MaterialGraph::eOutputNormal);
+	}
+
+	{
+		GraphCase & graphCase = cases[5];
+		graphCase.Name = "no output";
+		graphCase.Expected = "the graph has no output node";
+
+		graphCase.Graph.AddNode(MaterialGraph::eTime);
+	}
+
+	#undef GRAPH_SHADER_HEADER
+	#undef GRAPH_SHADER_FOOTER
+
+	for (UINT i = 0; i < _countof(cases); ++i)
+	{
+		MaterialGraph::CompileResult result;
+		cases[i].Graph.Compile(result);
+
+		const std::string & code = result.Success ? result.Code : result.Error;
+
+		if (code == cases[i].Expected)
+			continue;
+
+		++errors;
+		GetConsole()->Print("material graph check : \"%s\" failed, output :", cases[i].Name);
+
+		// one line at a time
+		size_t begin = 0;
+		while (begin < code.size())
+		{
+			const size_t end = code.find('\n', begin);
+			GetConsole()->Print("%s", code.substr(begin, end - begin).c_str());
+			begin = (end == std::string::npos) ? code.size() : end + 1;
+		}
+	}
+
+	// long chain : the value is accumulated with the time, every other step is constant
+	MaterialGraph chain;
+	UINT previous = chain.AddNode(MaterialGraph::eTime);
+
+	for (UINT i = 0; i < chainLength; ++i)
+	{
+		const UINT step = chain.AddNode((i & 1) ? MaterialGraph::eMultiply : MaterialGraph::eAdd);
+		chain.Link(previous, step, 0);
+		chain.SetDefaultValue(step, 1, 1.f + (float)(i % 7));
+		previous = step;
+	}
+
+	const UINT output = chain.AddNode(MaterialGraph::eOutput);
+	chain.Link(previous, output, MaterialGraph::eOutputSpecularPower);
+
+	Clock clock;
+	MaterialGraph::CompileResult result;
+	const bool compiled = chain.Compile(result);
+	const float compileTime = clock.GetElaspedTime().ToMilliseconds();
+
+	if (!compiled || result.InstructionCount != chainLength)
+		++errors;
+
+	GetConsole()->Print("material graph check : chain of %u nodes compiled in %.2f ms (%u bytes of code)", result.NodeCount, compileTime, (UINT)result.Code.size());
+	GetConsole()->Print("material graph check : %u cases, %u errors", (UINT)_countof(cases), errors);
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
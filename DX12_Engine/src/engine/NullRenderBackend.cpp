@@ -0,0 +1,291 @@
+#include "NullRenderBackend.h"
+
+#include "engine/Debug.h"
+#include "engine/DebugDraw.h"
+#include "engine/TransparentSort.h"
+#include "dx12/DX12PipelineState.h"
+#include "components/ParticleComponent.h"
+#include <stdio.h>
+
+// FNV-1a
+static FORCEINLINE void HashValue(UINT64 & io_Hash, UINT64 i_Value)
+{
+	for (UINT i = 0; i < 8; ++i)
+	{
+		io_Hash ^= (i_Value >> (i * 8)) & 0xff;
+		io_Hash *= 0x100000001b3ull;
+	}
+}
+
+NullRenderBackend::NullRenderBackend(UINT i_StreamCount)
+	:RenderBackend(eNullBackend)
+	,m_StreamHash(0xcbf29ce484222325ull)
+	,m_IsRecording(false)
+{
+	m_Streams.resize(i_StreamCount > 0 ? i_StreamCount : 1);
+
+	for (UINT i = 0; i < ePassCount; ++i)
+	{
+		m_DrawCount[i]		= 0;
+		m_InstanceCount[i]	= 0;
+	}
+}
+
+NullRenderBackend::~NullRenderBackend()
+{
+}
+
+HRESULT NullRenderBackend::BeginFrame()
+{
+	if (m_IsRecording)
+	{
+		PRINT_DEBUG("[NullRenderBackend] the previous frame was not ended");
+		DEBUG_BREAK;
+	}
+
+	for (size_t i = 0; i < m_Streams.size(); ++i)
+	{
+		m_Streams[i].clear();
+	}
+
+	m_IsRecording = true;
+	return S_OK;
+}
+
+HRESULT NullRenderBackend::EndFrame()
+{
+	if (!m_IsRecording)
+	{
+		PRINT_DEBUG("[NullRenderBackend] end of a frame that was not began");
+		DEBUG_BREAK;
+		return E_FAIL;
+	}
+
+	m_DrawCalls.clear();
+
+	for (UINT i = 0; i < ePassCount; ++i)
+	{
+		m_DrawCount[i]		= 0;
+		m_InstanceCount[i]	= 0;
+	}
+
+	// same order as the submission of DX12RenderEngine::Render : passes, then workers, then record order
+	for (UINT pass = 0; pass < ePassCount; ++pass)
+	{
+		for (size_t stream = 0; stream < m_Streams.size(); ++stream)
+		{
+			const std::vector<DrawCall> & draws = m_Streams[stream];
+
+			for (size_t i = 0; i < draws.size(); ++i)
+			{
+				if (draws[i].Pass != pass)
+					continue;
+
+				m_DrawCalls.push_back(draws[i]);
+				++m_DrawCount[pass];
+				m_InstanceCount[pass] += draws[i].InstanceCount;
+			}
+		}
+	}
+
+	// pointers change between runs : they are not part of the hash
+	HashValue(m_StreamHash, m_DrawCalls.size());
+
+	for (size_t i = 0; i < m_DrawCalls.size(); ++i)
+	{
+		const DrawCall & draw = m_DrawCalls[i];
+
+		HashValue(m_StreamHash, draw.Pass);
+		HashValue(m_StreamHash, draw.ElementFlags);
+		HashValue(m_StreamHash, draw.InstanceCount);
+	}
+
+	m_IsRecording = false;
+	++m_FrameCount;
+
+	return S_OK;
+}
+
+HRESULT NullRenderBackend::Close()
+{
+	// nothing is pending
+	return S_OK;
+}
+
+bool NullRenderBackend::CreateUploadMemory(UINT64 i_Size, const wchar_t * i_Name, UploadMemory & o_Memory)
+{
+	// the buffers are only read by the CPU
+	o_Memory.Resource	= nullptr;
+	o_Memory.CPUAddress	= new UINT8[(size_t)i_Size];
+	o_Memory.GPUAddress	= 0;
+
+	return true;
+}
+
+void NullRenderBackend::ReleaseUploadMemory(UploadMemory & io_Memory)
+{
+	delete[] io_Memory.CPUAddress;
+	io_Memory.CPUAddress = nullptr;
+}
+
+bool NullRenderBackend::PreparePipelineState(const DX12Material * i_Material, UINT64 i_ElementFlags, bool i_IndirectDraw)
+{
+	// no pipeline state
+	return true;
+}
+
+void NullRenderBackend::RecordLightPass(ID3D12GraphicsCommandList * i_CommandList, const Lighting & i_Lighting, const DX12Mesh * i_RectMesh)
+{
+	// one full frame draw
+	RecordDraw(0, { eLightPass, 0, nullptr, i_RectMesh, 1 });
+}
+
+void NullRenderBackend::RecordGBufferRange(UINT i_Worker, const MeshDraw * i_Draws, UINT i_Count, bool i_DepthPrePass)
+{
+	// skinned meshes are not in the depth pre pass
+	for (UINT i = 0; i < i_Count && i_DepthPrePass; ++i)
+	{
+		if (i_Draws[i].ElementFlags & DX12PipelineState::eHaveSkinning)
+			continue;
+
+		RecordDraw(i_Worker, { eDepthPass, i_Draws[i].ElementFlags, nullptr, i_Draws[i].Mesh, 1 });
+	}
+
+	for (UINT i = 0; i < i_Count; ++i)
+	{
+		RecordDraw(i_Worker, { eGBufferPass, i_Draws[i].ElementFlags, i_Draws[i].Material, i_Draws[i].Mesh, 1 });
+	}
+}
+
+void NullRenderBackend::RecordIndirectRange(UINT i_Worker, const IndirectBatch * i_Batches, UINT i_FirstBatch, UINT i_Count, ADDRESS_ID i_Transform)
+{
+	// the instances of a batch are only known by the GPU culling (the render list does not draw indirectly without device)
+	for (UINT i = 0; i < i_Count; ++i)
+	{
+		RecordDraw(i_Worker, { eGBufferPass, i_Batches[i].ElementFlags, i_Batches[i].Parent, i_Batches[i].Mesh, 0 });
+	}
+}
+
+UINT NullRenderBackend::RecordShadowPass(const ShadowPass & i_Pass)
+{
+	UINT drawCount = 0;
+
+	for (UINT view = 0; view < i_Pass.ViewCount; ++view)
+	{
+		const ShadowBatch * batches = i_Pass.Batches + i_Pass.Views[view].FirstBatch;
+
+		for (UINT i = 0; i < i_Pass.Views[view].BatchCount; ++i)
+		{
+			RecordDraw(0, { eShadowPass, batches[i].ElementFlags, nullptr, batches[i].Mesh, batches[i].InstanceCount });
+			++drawCount;
+		}
+	}
+
+	return drawCount;
+}
+
+UINT NullRenderBackend::RecordTransparentPass(const TransparentPass & i_Pass)
+{
+	const UINT drawCount = i_Pass.MeshCount + i_Pass.EmitterCount;
+	UINT recorded = 0;
+
+	for (UINT i = 0; i < drawCount; ++i)
+	{
+		const UINT index = TransparentSort::GetDrawIndex(i_Pass.Keys[i]);
+
+		if (index < i_Pass.MeshCount)
+		{
+			const MeshDraw & draw = i_Pass.Meshes[index];
+			RecordDraw(0, { eTransparentPass, draw.ElementFlags, draw.Material, draw.Mesh, 1 });
+			++recorded;
+			continue;
+		}
+
+		// particle emitter : one instanced draw
+		const ParticleComponent * component = i_Pass.Emitters[index - i_Pass.MeshCount];
+		const UINT instanceCount = component->GetVisibleCount();
+
+		if (instanceCount == 0)
+			continue;
+
+		RecordDraw(0, { eTransparentPass, (UINT64)component->GetEmitterDesc().BlendMode, nullptr, component, instanceCount });
+		++recorded;
+	}
+
+	return recorded;
+}
+
+UINT NullRenderBackend::RecordDebugPass(const DebugPass & i_Pass)
+{
+	UINT drawCount = 0;
+
+	// one instanced draw per primitive type and depth mode (depth tested instances first)
+	for (UINT pass = 0; pass < 2; ++pass)
+	{
+		for (UINT i = 0; i < DebugDraw::ePrimitiveCount; ++i)
+		{
+			const DebugDraw::EPrimitive primitive = (DebugDraw::EPrimitive)i;
+			const UINT depthTestedCount = DebugDraw::GetDepthTestedCount(primitive);
+			const UINT count = (pass == 0) ? depthTestedCount : i_Pass.InstanceCount[i] - depthTestedCount;
+
+			if (count == 0)
+				continue;
+
+			RecordDraw(0, { eDebugPass, (UINT64)primitive, nullptr, nullptr, count });
+			++drawCount;
+		}
+	}
+
+	return drawCount;
+}
+
+void NullRenderBackend::RecordDraw(UINT i_Stream, const DrawCall & i_Draw)
+{
+	ASSERT(i_Stream < m_Streams.size());
+	ASSERT(i_Draw.Pass < ePassCount);
+	m_Streams[i_Stream].push_back(i_Draw);
+}
+
+const std::vector<RenderBackend::DrawCall> & NullRenderBackend::GetDrawCalls() const
+{
+	return m_DrawCalls;
+}
+
+UINT NullRenderBackend::GetDrawCount(EPass i_Pass) const
+{
+	ASSERT(i_Pass < ePassCount);
+	return m_DrawCount[i_Pass];
+}
+
+UINT NullRenderBackend::GetInstanceCount(EPass i_Pass) const
+{
+	ASSERT(i_Pass < ePassCount);
+	return m_InstanceCount[i_Pass];
+}
+
+UINT64 NullRenderBackend::GetStreamHash() const
+{
+	return m_StreamHash;
+}
+
+void NullRenderBackend::DumpFrame(std::string & o_Text) const
+{
+	char line[256];
+
+	sprintf_s(line, "frame %llu : %u draws, %u allocations (%llu bytes)\n", m_FrameCount, (UINT)m_DrawCalls.size(), GetAllocationCount(), GetAllocatedSize());
+	o_Text += line;
+
+	for (size_t i = 0; i < m_DrawCalls.size(); ++i)
+	{
+		const DrawCall & draw = m_DrawCalls[i];
+
+		sprintf_s(line, "%s layout=0x%llx material=%p mesh=%p instances=%u\n", GetPassName(draw.Pass), draw.ElementFlags, draw.Material, draw.Mesh, draw.InstanceCount);
+		o_Text += line;
+	}
+}
+
+const char * NullRenderBackend::GetPassName(EPass i_Pass)
+{
+	static const char * s_PassName[ePassCount] = { "Depth", "GBuffer", "Shadow", "Light", "Transparent", "Debug" };
+	return (i_Pass < ePassCount) ? s_PassName[i_Pass] : "Unknown";
+}
@@ -0,0 +1,52 @@
+// null render backend : headless rendering for automated runs on Windows machines without GPU
+// still a Windows build : the DX12 headers are included and the textures are decoded with WIC (no other platform target)
+// nothing is submitted to a GPU : buffers are in system memory and the draws of the passes are recorded in one stream per worker
+// streams are merged at the end of the frame in submission order (pass then worker) to be inspected
+
+#pragma once
+
+#include "engine/RenderBackend.h"
+
+#define		MAX_DRAW_STREAM		16		// recording workers (see MAX_RECORD_WORKER)
+
+class NullRenderBackend : public RenderBackend
+{
+public:
+	NullRenderBackend(UINT i_StreamCount = MAX_DRAW_STREAM);
+	~NullRenderBackend();
+
+	// RenderBackend
+	virtual HRESULT		BeginFrame() override;
+	virtual HRESULT		EndFrame() override;
+	virtual HRESULT		Close() override;
+	virtual bool		CreateUploadMemory(UINT64 i_Size, const wchar_t * i_Name, UploadMemory & o_Memory) override;
+	virtual void		ReleaseUploadMemory(UploadMemory & io_Memory) override;
+	virtual bool		PreparePipelineState(const DX12Material * i_Material, UINT64 i_ElementFlags, bool i_IndirectDraw) override;
+	virtual void		RecordLightPass(ID3D12GraphicsCommandList * i_CommandList, const Lighting & i_Lighting, const DX12Mesh * i_RectMesh) override;
+	virtual void		RecordGBufferRange(UINT i_Worker, const MeshDraw * i_Draws, UINT i_Count, bool i_DepthPrePass) override;
+	virtual void		RecordIndirectRange(UINT i_Worker, const IndirectBatch * i_Batches, UINT i_FirstBatch, UINT i_Count, ADDRESS_ID i_Transform) override;
+	virtual UINT		RecordShadowPass(const ShadowPass & i_Pass) override;
+	virtual UINT		RecordTransparentPass(const TransparentPass & i_Pass) override;
+	virtual UINT		RecordDebugPass(const DebugPass & i_Pass) override;
+
+	// draws : one stream per recording worker (streams can be recorded in parallel)
+	void				RecordDraw(UINT i_Stream, const DrawCall & i_Draw);
+
+	// recorded frame
+	const std::vector<DrawCall> &	GetDrawCalls() const;	// draws of the last ended frame
+	UINT			GetDrawCount(EPass i_Pass) const;
+	UINT			GetInstanceCount(EPass i_Pass) const;
+	UINT64			GetStreamHash() const;	// hash of every recorded frame (pass, layout and instances) : identical for deterministic runs
+
+	// debug
+	void					DumpFrame(std::string & o_Text) const;
+	static const char *		GetPassName(EPass i_Pass);
+
+private:
+	std::vector<std::vector<DrawCall>>	m_Streams;		// draws of the current frame per worker
+	std::vector<DrawCall>				m_DrawCalls;	// merged draws of the last frame
+	UINT								m_DrawCount[ePassCount];
+	UINT								m_InstanceCount[ePassCount];
+	UINT64								m_StreamHash;
+	bool								m_IsRecording;
+};
@@ -0,0 +1,133 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include "engine/Utils.h"
+#include "engine/NullRenderBackend.h"
+#include "engine/RenderList.h"
+#include "dx12/DX12RenderEngine.h"
+#include "engine/TestUtils.h"
+
+CFBackendCheck::CFBackendCheck()
+	:Console::Function("backend_check", "[frame count]", "validate the draw stream and the allocation tracking of the null render backend, and the release of the render list buffers")
+{
+}
+
+bool CFBackendCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT frameCount = 64;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		frameCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	static const UINT streamCount = 4;
+	NullRenderBackend first(streamCount), second(streamCount);
+	NullRenderBackend * backends[2] = { &first, &second };
+	UINT errors = 0;
+	UINT drawCount = 0;
+
+	// the same frames are recorded by both backends with different pointers : the hash must be the same
+	for (UINT b = 0; b < 2; ++b)
+	{
+		NullRenderBackend & backend = *backends[b];
+		TestRandom random(0x1234567);
+		int dummy[2];
+
+		for (UINT frame = 0; frame < frameCount; ++frame)
+		{
+			std::vector<RenderBackend::DrawCall> expected[RenderBackend::ePassCount][streamCount];
+			backend.BeginFrame();
+
+			const UINT draws = random.Next() % 200;
+
+			// streams are recorded in any order (as parallel workers)
+			for (UINT i = 0; i < draws; ++i)
+			{
+				RenderBackend::DrawCall draw;
+				const UINT stream	= random.Next() >> 30;
+				draw.Pass			= (RenderBackend::EPass)((random.Next() >> 16) % RenderBackend::ePassCount);
+				draw.ElementFlags	= (random.Next() >> 16) % 4;
+				draw.InstanceCount	= 1 + (random.Next() >> 16) % 8;
+				draw.Material		= &dummy[b];
+				draw.Mesh			= &dummy[b];
+
+				backend.RecordDraw(stream, draw);
+				expected[draw.Pass][stream].push_back(draw);
+			}
+
+			backend.EndFrame();
+
+			// submission order : passes, then streams, then record order
+			const std::vector<RenderBackend::DrawCall> & recorded = backend.GetDrawCalls();
+			size_t index = 0;
+
+			for (UINT pass = 0; pass < RenderBackend::ePassCount; ++pass)
+			{
+				UINT passDraws = 0, passInstances = 0;
+
+				for (UINT stream = 0; stream < streamCount; ++stream)
+				{
+					for (size_t i = 0; i < expected[pass][stream].size(); ++i, ++index)
+					{
+						const RenderBackend::DrawCall & draw = expected[pass][stream][i];
+
+						if (index >= recorded.size() || recorded[index].Pass != draw.Pass || recorded[index].ElementFlags != draw.ElementFlags || recorded[index].InstanceCount != draw.InstanceCount)
+							++errors;
+
+						++passDraws;
+						passInstances += draw.InstanceCount;
+					}
+				}
+
+				if (backend.GetDrawCount((RenderBackend::EPass)pass) != passDraws || backend.GetInstanceCount((RenderBackend::EPass)pass) != passInstances)
+					++errors;
+			}
+
+			if (index != recorded.size() || backend.GetFrameCount() != frame + 1)
+				++errors;
+
+			drawCount += draws;
+		}
+	}
+
+	if (first.GetStreamHash() != second.GetStreamHash())
+		++errors;
+
+	// allocations
+	NullRenderBackend & backend = first;
+	const UINT a = backend.TrackAllocation(L"A", 256);
+	const UINT b = backend.TrackAllocation(L"B", 1024);
+	backend.ReleaseAllocation(a);
+	const UINT c = backend.TrackAllocation(L"C", 512);
+
+	if (backend.GetAllocationCount() != 2 || backend.GetAllocatedSize() != 1536 || backend.GetPeakAllocatedSize() != 1536)
+		++errors;
+
+	backend.ReleaseAllocation(b);
+	backend.ReleaseAllocation(c);
+
+	if (backend.GetAllocationCount() != 0 || backend.GetAllocatedSize() != 0 || backend.GetPeakAllocatedSize() != 1536)
+		++errors;
+
+	// render list : the buffers are tracked by the backend of the engine and released with the list
+	RenderBackend * engineBackend = DX12RenderEngine::GetInstance().GetBackend();
+	const UINT aliveCount = engineBackend->GetAllocationCount();
+
+	RenderList * renderList = new RenderList;
+	const UINT listAllocationCount = engineBackend->GetAllocationCount() - aliveCount;
+	delete renderList;
+
+	const UINT leakCount = engineBackend->GetAllocationCount() - aliveCount;
+
+	if (listAllocationCount == 0 || leakCount != 0)
+		++errors;
+
+	GetConsole()->Print("backend check : %u frames, %u draws, %u render list allocations (%u alive after the delete), %u errors", frameCount, drawCount, listAllocationCount, leakCount, errors);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
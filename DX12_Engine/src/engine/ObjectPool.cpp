@@ -0,0 +1,88 @@
+#include "ObjectPool.h"
+
+#include "engine/Debug.h"
+
+ObjectPool::ObjectPool(size_t i_SlotSize, UINT i_BlockSlotCount)
+	// slots are aligned as the allocations of the global heap
+	:m_SlotSize((i_SlotSize + MEMORY_ALLOCATION_ALIGNMENT - 1) & ~(size_t)(MEMORY_ALLOCATION_ALIGNMENT - 1))
+	,m_BlockSlotCount(i_BlockSlotCount > 0 ? i_BlockSlotCount : 1)
+{
+}
+
+ObjectPool::~ObjectPool()
+{
+	for (auto itr = m_Blocks.begin(); itr != m_Blocks.end(); ++itr)
+	{
+		::operator delete(const_cast<BYTE *>(itr->first));
+	}
+}
+
+void ObjectPool::Reserve(UINT i_Count)
+{
+	if (i_Count > m_FreeSlots.size())
+		AllocateBlock(i_Count - (UINT)m_FreeSlots.size());
+}
+
+void * ObjectPool::Allocate()
+{
+	if (m_FreeSlots.empty())
+		AllocateBlock(m_BlockSlotCount);
+
+	void * slot = m_FreeSlots.back();
+	m_FreeSlots.pop_back();
+
+	return slot;
+}
+
+void ObjectPool::Free(void * i_Slot)
+{
+	if (i_Slot == nullptr)
+		return;
+
+	ASSERT(Owns(i_Slot));
+	m_FreeSlots.push_back(i_Slot);
+}
+
+bool ObjectPool::Owns(const void * i_Address) const
+{
+	const BYTE * address = reinterpret_cast<const BYTE *>(i_Address);
+
+	// the last block that starts before the address
+	auto itr = m_Blocks.upper_bound(address);
+
+	if (itr == m_Blocks.begin())
+		return false;
+
+	--itr;
+	return address < itr->first + itr->second;
+}
+
+size_t ObjectPool::GetSlotSize() const
+{
+	return m_SlotSize;
+}
+
+UINT ObjectPool::GetFreeCount() const
+{
+	return (UINT)m_FreeSlots.size();
+}
+
+UINT ObjectPool::GetBlockCount() const
+{
+	return (UINT)m_Blocks.size();
+}
+
+void ObjectPool::AllocateBlock(UINT i_SlotCount)
+{
+	const size_t size = m_SlotSize * i_SlotCount;
+	BYTE * block = static_cast<BYTE *>(::operator new(size));
+
+	m_Blocks[block] = size;
+	m_FreeSlots.reserve(m_FreeSlots.size() + i_SlotCount);
+
+	// the first slots of the block are allocated first (reversed free list)
+	for (UINT i = i_SlotCount; i > 0; --i)
+	{
+		m_FreeSlots.push_back(block + (i - 1) * m_SlotSize);
+	}
+}
@@ -0,0 +1,71 @@
+// object pool
+// fixed size slots allocated by blocks : objects created in bulk (scene loads) share one allocation
+// freed slots are reused by the next objects, the blocks are kept until the pool is destroyed
+// not thread safe : the pooled objects are created and deleted on the main thread
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <map>
+
+class ObjectPool
+{
+public:
+	ObjectPool(size_t i_SlotSize, UINT i_BlockSlotCount);
+	~ObjectPool();
+
+	// allocation management
+	void		Reserve(UINT i_Count);	// free slots for i_Count objects (the missing slots are allocated in one block)
+	void *		Allocate();
+	void		Free(void * i_Slot);
+	bool		Owns(const void * i_Address) const;
+
+	// information
+	size_t		GetSlotSize() const;
+	UINT		GetFreeCount() const;
+	UINT		GetBlockCount() const;
+
+private:
+	const size_t		m_SlotSize;
+	const UINT			m_BlockSlotCount;	// slots of the blocks allocated when no slot is free
+
+	std::map<const BYTE *, size_t>	m_Blocks;		// start and size of the blocks
+	std::vector<void *>				m_FreeSlots;
+
+	void		AllocateBlock(UINT i_SlotCount);
+};
+
+// class allocation from a pool (the derived classes of other sizes use the global heap)
+// the pool is never destroyed : objects deleted at exit (after the static destructors) are still released
+#define DECLARE_POOLED_ALLOCATION()							\
+	static void *	operator new(size_t i_Size);			\
+	static void		operator delete(void * i_Object);		\
+	static void		ReservePool(UINT i_Count);				\
+	static const ObjectPool & GetPool();
+
+#define IMPLEMENT_POOLED_ALLOCATION(_Class, _BlockSlotCount)								\
+	static ObjectPool & Get##_Class##Pool()													\
+	{																						\
+		static ObjectPool * pool = new ObjectPool(sizeof(_Class), _BlockSlotCount);		\
+		return *pool;																		\
+	}																						\
+	void * _Class::operator new(size_t i_Size)												\
+	{																						\
+		return (i_Size == sizeof(_Class)) ? Get##_Class##Pool().Allocate() : ::operator new(i_Size);	\
+	}																						\
+	void _Class::operator delete(void * i_Object)											\
+	{																						\
+		if (Get##_Class##Pool().Owns(i_Object))												\
+			Get##_Class##Pool().Free(i_Object);												\
+		else																				\
+			::operator delete(i_Object);													\
+	}																						\
+	void _Class::ReservePool(UINT i_Count)													\
+	{																						\
+		Get##_Class##Pool().Reserve(i_Count);												\
+	}																						\
+	const ObjectPool & _Class::GetPool()													\
+	{																						\
+		return Get##_Class##Pool();															\
+	}
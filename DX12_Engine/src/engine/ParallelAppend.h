@@ -0,0 +1,183 @@
+// append buffers of parallel workers
+// each worker appends to its own buffer : no lock and no atomic while the workers run
+// the buffers are merged in worker order, each worker copies its values at the offset of its buffer (prefix of the previous buffers)
+// when the workers take contiguous ranges of the input in order (see CommandRecorder::Partition), the merged order is the serial order
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <algorithm>
+#include "engine/CommandRecorder.h"
+#include "engine/Debug.h"
+
+template <class T>
+class ParallelAppend
+{
+public:
+	ParallelAppend();
+
+	// workers management
+	void	Reset(UINT i_WorkerCount);	// clear the buffers (the memory is kept for the next frames)
+	void	Push(UINT i_Worker, const T & i_Value);
+
+	// merge : the values are appended to the output, the output is truncated to the max count
+	void	Merge(std::vector<T> & io_Output, size_t i_MaxCount = (size_t)-1);	// calling thread
+	void	Merge(CommandRecorder * i_Recorder, std::vector<T> & io_Output, size_t i_MaxCount = (size_t)-1);	// workers of the recorder (same worker count)
+
+	// information
+	UINT	GetWorkerCount() const;
+	size_t	GetCount(UINT i_Worker) const;
+	size_t	GetCount() const;
+
+private:
+	struct Buffer
+	{
+		std::vector<T>		Values;
+		size_t				Offset;		// in the output of the merge
+		size_t				Count;		// values copied by the merge
+		BYTE				Padding[64];	// the workers don't write on the same cache lines
+	};
+
+	// copy the buffers of the workers
+	class MergeRecorder : public CommandRecorder::Recorder
+	{
+	public:
+		MergeRecorder(const ParallelAppend * i_Append, std::vector<T> & io_Output);
+		virtual void	RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range) override;
+
+	private:
+		const ParallelAppend *	m_Append;
+		std::vector<T> &		m_Output;
+	};
+
+	void	Prepare(std::vector<T> & io_Output, size_t i_MaxCount);	// compute the offsets and resize the output
+	void	Copy(UINT i_Worker, std::vector<T> & io_Output) const;
+
+	std::vector<Buffer>							m_Buffers;
+	std::vector<CommandRecorder::DrawRange>		m_MergeRanges;
+};
+
+template <class T>
+ParallelAppend<T>::ParallelAppend()
+{
+	Reset(1);
+}
+
+template <class T>
+void ParallelAppend<T>::Reset(UINT i_WorkerCount)
+{
+	ASSERT(i_WorkerCount > 0);
+
+	if (m_Buffers.size() != i_WorkerCount)
+		m_Buffers.resize(i_WorkerCount);
+
+	for (size_t i = 0; i < m_Buffers.size(); ++i)
+	{
+		m_Buffers[i].Values.clear();
+		m_Buffers[i].Offset = 0;
+		m_Buffers[i].Count = 0;
+	}
+}
+
+template <class T>
+FORCEINLINE void ParallelAppend<T>::Push(UINT i_Worker, const T & i_Value)
+{
+	m_Buffers[i_Worker].Values.push_back(i_Value);
+}
+
+template <class T>
+void ParallelAppend<T>::Merge(std::vector<T> & io_Output, size_t i_MaxCount)
+{
+	Prepare(io_Output, i_MaxCount);
+
+	for (UINT i = 0; i < (UINT)m_Buffers.size(); ++i)
+	{
+		Copy(i, io_Output);
+	}
+}
+
+template <class T>
+void ParallelAppend<T>::Merge(CommandRecorder * i_Recorder, std::vector<T> & io_Output, size_t i_MaxCount)
+{
+	ASSERT(i_Recorder->GetWorkerCount() == m_Buffers.size());
+
+	Prepare(io_Output, i_MaxCount);
+
+	// one range per worker : the worker copies its own buffer
+	m_MergeRanges.resize(m_Buffers.size());
+
+	for (size_t i = 0; i < m_Buffers.size(); ++i)
+	{
+		m_MergeRanges[i].First	= (UINT)i;
+		m_MergeRanges[i].Count	= (m_Buffers[i].Count > 0) ? 1 : 0;
+	}
+
+	MergeRecorder recorder(this, io_Output);
+	i_Recorder->Record(m_MergeRanges, &recorder);
+}
+
+template <class T>
+UINT ParallelAppend<T>::GetWorkerCount() const
+{
+	return (UINT)m_Buffers.size();
+}
+
+template <class T>
+size_t ParallelAppend<T>::GetCount(UINT i_Worker) const
+{
+	return m_Buffers[i_Worker].Values.size();
+}
+
+template <class T>
+size_t ParallelAppend<T>::GetCount() const
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < m_Buffers.size(); ++i)
+	{
+		count += m_Buffers[i].Values.size();
+	}
+
+	return count;
+}
+
+template <class T>
+void ParallelAppend<T>::Prepare(std::vector<T> & io_Output, size_t i_MaxCount)
+{
+	// prefix of the buffer sizes, the last values are dropped when the output is full
+	size_t offset = io_Output.size();
+
+	for (size_t i = 0; i < m_Buffers.size(); ++i)
+	{
+		const size_t available = (i_MaxCount > offset) ? i_MaxCount - offset : 0;
+
+		m_Buffers[i].Offset	= offset;
+		m_Buffers[i].Count	= (m_Buffers[i].Values.size() < available) ? m_Buffers[i].Values.size() : available;
+		offset += m_Buffers[i].Count;
+	}
+
+	io_Output.resize(offset);
+}
+
+template <class T>
+FORCEINLINE void ParallelAppend<T>::Copy(UINT i_Worker, std::vector<T> & io_Output) const
+{
+	const Buffer & buffer = m_Buffers[i_Worker];
+
+	if (buffer.Count > 0)
+		std::copy(buffer.Values.begin(), buffer.Values.begin() + buffer.Count, io_Output.begin() + buffer.Offset);
+}
+
+template <class T>
+ParallelAppend<T>::MergeRecorder::MergeRecorder(const ParallelAppend * i_Append, std::vector<T> & io_Output)
+	:m_Append(i_Append)
+	,m_Output(io_Output)
+{
+}
+
+template <class T>
+void ParallelAppend<T>::MergeRecorder::RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range)
+{
+	m_Append->Copy(i_Range.First, m_Output);
+}
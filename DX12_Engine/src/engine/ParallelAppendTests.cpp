@@ -0,0 +1,197 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <thread>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/CommandRecorder.h"
+#include "engine/ParallelAppend.h"
+#include "engine/TestUtils.h"
+
+CFRenderSubmitBench::CFRenderSubmitBench()
+	:Console::Function("render_submit_bench", "[actor count]", "traverse a synthetic world in parallel (per worker append buffers), check the order against the serial traversal and measure the scaling")
+{
+}
+
+bool CFRenderSubmitBench::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT actorCount = 500000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		actorCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	// synthetic actor : the traversal of World::RenderActor (the pushed values are the nodes instead of the components)
+	struct Node
+	{
+		std::vector<Node *>		Children;
+		bool					Hidden;
+		bool					Rendered;
+		bool					Light;
+
+		static void Traverse(const Node * i_Node, UINT i_Worker, ParallelAppend<const Node *> & io_Components, ParallelAppend<const Node *> & io_Lights)
+		{
+			if (i_Node->Hidden)
+				return;
+
+			if (i_Node->Rendered)
+				io_Components.Push(i_Worker, i_Node);
+
+			if (i_Node->Light)
+				io_Lights.Push(i_Worker, i_Node);
+
+			for (size_t i = 0; i < i_Node->Children.size(); ++i)
+			{
+				Traverse(i_Node->Children[i], i_Worker, io_Components, io_Lights);
+			}
+		}
+
+		// previous submission : one thread, push back in the lists of the render list
+		static void TraverseSerial(const Node * i_Node, std::vector<const Node *> & io_Components, std::vector<const Node *> & io_Lights, size_t i_MaxLight)
+		{
+			if (i_Node->Hidden)
+				return;
+
+			if (i_Node->Rendered)
+				io_Components.push_back(i_Node);
+
+			if (i_Node->Light && io_Lights.size() < i_MaxLight)
+				io_Lights.push_back(i_Node);
+
+			for (size_t i = 0; i < i_Node->Children.size(); ++i)
+			{
+				TraverseSerial(i_Node->Children[i], io_Components, io_Lights, i_MaxLight);
+			}
+		}
+	};
+
+	class TraverseRecorder : public CommandRecorder::Recorder
+	{
+	public:
+		TraverseRecorder(const std::vector<Node *> & i_Roots, ParallelAppend<const Node *> & io_Components, ParallelAppend<const Node *> & io_Lights)
+			:m_Roots(i_Roots), m_Components(io_Components), m_Lights(io_Lights) {}
+
+		virtual void RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range) override
+		{
+			for (UINT i = i_Range.First; i < i_Range.First + i_Range.Count; ++i)
+			{
+				Node::Traverse(m_Roots[i], i_Worker, m_Components, m_Lights);
+			}
+		}
+
+	private:
+		const std::vector<Node *> &		m_Roots;
+		ParallelAppend<const Node *> &	m_Components;
+		ParallelAppend<const Node *> &	m_Lights;
+	};
+
+	TestRandom random(1);
+
+	// world : subtrees of 1 to 32 actors, a few hidden actors (with their children), lights and actors without component
+	std::vector<Node *> nodes, roots;
+	nodes.reserve(actorCount);
+
+	for (UINT i = 0, subtreeFirst = 0; i < actorCount; ++i)
+	{
+		Node * node = new Node;
+		node->Hidden	= (random.Index(100) < 2);
+		node->Rendered	= (random.Index(100) < 80);
+		node->Light		= (random.Index(1000) < 5);
+
+		if (i == subtreeFirst || random.Index(32) == 0)
+		{
+			subtreeFirst = i;
+			roots.push_back(node);
+		}
+		else
+		{
+			nodes[subtreeFirst + random.Index(i - subtreeFirst)]->Children.push_back(node);
+		}
+
+		nodes.push_back(node);
+	}
+
+	// serial reference
+	const UINT iterationCount = 8;
+	const size_t maxLight = 1024;
+	std::vector<const Node *> serialComponents, serialLights;
+	UINT errors = 0;
+	Clock serialClock;
+
+	for (UINT iteration = 0; iteration < iterationCount; ++iteration)
+	{
+		serialComponents.clear();
+		serialLights.clear();
+
+		for (size_t i = 0; i < roots.size(); ++i)
+		{
+			Node::TraverseSerial(roots[i], serialComponents, serialLights, maxLight);
+		}
+	}
+
+	const UINT64 serialTime = serialClock.GetElaspedTime().ToMicroseconds() / iterationCount;
+
+	GetConsole()->Print("render submit bench : %u actors, %u roots, %u components, %u lights, serial %llu us",
+		actorCount, (UINT)roots.size(), (UINT)serialComponents.size(), (UINT)serialLights.size(), serialTime);
+
+	// parallel submission : 1, 2, 4... workers and the hardware thread count
+	const UINT maxWorker = Math::Max(std::thread::hardware_concurrency(), 1u);
+	std::vector<UINT> workerCounts;
+
+	for (UINT workerCount = 1; workerCount < maxWorker; workerCount *= 2)
+	{
+		workerCounts.push_back(workerCount);
+	}
+	workerCounts.push_back(maxWorker);
+
+	for (size_t w = 0; w < workerCounts.size(); ++w)
+	{
+		const UINT workerCount = workerCounts[w];
+		CommandRecorder recorder(workerCount);
+		ParallelAppend<const Node *> components, lights;
+		std::vector<const Node *> parallelComponents, parallelLights;
+		std::vector<CommandRecorder::DrawRange> ranges;
+		TraverseRecorder traverse(roots, components, lights);
+		Clock clock;
+
+		for (UINT iteration = 0; iteration < iterationCount; ++iteration)
+		{
+			parallelComponents.clear();
+			parallelLights.clear();
+
+			CommandRecorder::Partition((UINT)roots.size(), workerCount, MIN_SUBMIT_ROOT, ranges);
+			components.Reset(workerCount);
+			lights.Reset(workerCount);
+
+			recorder.Record(ranges, &traverse);
+
+			components.Merge(&recorder, parallelComponents);
+			lights.Merge(parallelLights, maxLight);
+		}
+
+		const UINT64 parallelTime = clock.GetElaspedTime().ToMicroseconds() / iterationCount;
+
+		// same order as the serial traversal (no sort needed)
+		if (parallelComponents != serialComponents || parallelLights != serialLights)
+			++errors;
+
+		GetConsole()->Print("render submit bench : %u workers, %llu us (x%.2f)",
+			workerCount, parallelTime, (float)serialTime / (float)Math::Max(parallelTime, (UINT64)1));
+	}
+
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		delete nodes[i];
+	}
+
+	GetConsole()->Print("render submit bench : %u errors", errors);
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
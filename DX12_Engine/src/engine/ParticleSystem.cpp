@@ -0,0 +1,171 @@
+#include "ParticleSystem.h"
+
+#include "components/ParticleComponent.h"
+#include "dx12/DX12UploadBuffer.h"
+#include "engine/Actor.h"
+#include "engine/RadixSort.h"
+#include "engine/CPUProfiler.h"
+#include "engine/Utils.h"
+#include "engine/Debug.h"
+#include <algorithm>
+
+ParticleSystem::ParticleSystem()
+	:m_BlockCount(0)
+	,m_ParticleCount(0)
+	,m_WorkerUsed(0)
+{
+}
+
+ParticleSystem::~ParticleSystem()
+{
+}
+
+void ParticleSystem::Simulate(float i_Elapsed, const std::vector<ParticleComponent *> & i_Emitters, const XMMATRIX & i_View, CommandRecorder * i_Recorder)
+{
+	CPU_ZONE("Simulate Particles");
+
+	m_Emitters.clear();
+	m_BlockCount = 0;
+	m_ParticleCount = 0;
+
+	// constants of the frame : the particles are spawned at the position of the actor
+	for (size_t i = 0; i < i_Emitters.size(); ++i)
+	{
+		ParticleComponent * component = i_Emitters[i];
+		XMFLOAT3 origin;
+		XMStoreFloat3(&origin, component->GetActor()->GetWorldTransform().r[3]);
+
+		Particles::SetupSimulation(component->m_Desc, origin, i_Elapsed, component->m_State, component->m_SimulateConstants);
+		Particles::SetupSort(i_View, component->GetCapacity(), component->m_SortConstants);
+
+		if (component->m_Buffers != nullptr)
+			continue;
+
+		Emitter emitter;
+		emitter.Component	= component;
+		emitter.Constants	= &component->m_SimulateConstants;
+		emitter.Storage		= &component->m_Storage;
+		emitter.FirstBlock	= m_BlockCount;
+
+		m_Emitters.push_back(emitter);
+		m_BlockCount += component->m_Storage.Capacity / 4;
+	}
+
+	if (m_Emitters.empty())
+	{
+		m_WorkerUsed = 0;
+		return;
+	}
+
+	SimulateEmitters(i_Recorder);
+
+	// sort and upload : one emitter per worker at least
+	CommandRecorder::Partition((UINT)m_Emitters.size(), i_Recorder->GetWorkerCount(), 1, m_Ranges);
+
+	SortRecorder sortRecorder(this);
+	i_Recorder->Record(m_Ranges, &sortRecorder);
+
+	for (size_t i = 0; i < m_Emitters.size(); ++i)
+	{
+		m_ParticleCount += m_Emitters[i].Component->m_VisibleCount;
+	}
+}
+
+void ParticleSystem::SimulateStorage(const Particles::SimulateConstants & i_Constants, Particles::Storage & io_Storage, CommandRecorder * i_Recorder)
+{
+	ASSERT(i_Constants.Capacity == io_Storage.Capacity);
+
+	Emitter emitter;
+	emitter.Component	= nullptr;
+	emitter.Constants	= &i_Constants;
+	emitter.Storage		= &io_Storage;
+	emitter.FirstBlock	= 0;
+
+	m_Emitters.assign(1, emitter);
+	m_BlockCount = io_Storage.Capacity / 4;
+
+	SimulateEmitters(i_Recorder);
+	m_Emitters.clear();
+}
+
+UINT ParticleSystem::GetParticleCount() const
+{
+	return m_ParticleCount;
+}
+
+UINT ParticleSystem::GetSimulateWorkerUsed() const
+{
+	return m_WorkerUsed;
+}
+
+void ParticleSystem::SimulateEmitters(CommandRecorder * i_Recorder)
+{
+	CommandRecorder::Partition(m_BlockCount, i_Recorder->GetWorkerCount(), MIN_SIMULATE_BLOCK, m_Ranges);
+
+	m_WorkerUsed = 0;
+	for (size_t i = 0; i < m_Ranges.size(); ++i)
+	{
+		if (m_Ranges[i].Count > 0)
+			++m_WorkerUsed;
+	}
+
+	SimulateRecorder recorder(this);
+	i_Recorder->Record(m_Ranges, &recorder);
+}
+
+ParticleSystem::SimulateRecorder::SimulateRecorder(ParticleSystem * i_System)
+	:m_System(i_System)
+{
+}
+
+void ParticleSystem::SimulateRecorder::RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range)
+{
+	if (i_Range.Count == 0)
+		return;
+
+	const std::vector<Emitter> & emitters = m_System->m_Emitters;
+
+	// first emitter of the range
+	auto itr = std::upper_bound(emitters.begin(), emitters.end(), i_Range.First, [](UINT i_Block, const Emitter & i_Emitter) { return i_Block < i_Emitter.FirstBlock; });
+	size_t index = (size_t)(itr - emitters.begin()) - 1;
+
+	UINT block = i_Range.First;
+	const UINT end = i_Range.First + i_Range.Count;
+
+	// the range can cover the end of an emitter and the beginning of the next ones
+	while (block < end)
+	{
+		const Emitter & emitter = emitters[index];
+		const UINT emitterEnd = emitter.FirstBlock + emitter.Storage->Capacity / 4;
+		const UINT last = Math::Min(end, emitterEnd);
+
+		Particles::Simulate(*emitter.Constants, *emitter.Storage, (block - emitter.FirstBlock) * 4, (last - block) * 4);
+
+		block = last;
+		++index;
+	}
+}
+
+ParticleSystem::SortRecorder::SortRecorder(ParticleSystem * i_System)
+	:m_System(i_System)
+{
+}
+
+void ParticleSystem::SortRecorder::RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range)
+{
+	for (UINT i = i_Range.First; i < i_Range.First + i_Range.Count; ++i)
+	{
+		ParticleComponent * component = m_System->m_Emitters[i].Component;
+		const Particles::Storage & storage = component->m_Storage;
+
+		// back to front : the slots are in ascending order, the depth keys are enough
+		const UINT count = Particles::BuildSortKeys(component->m_SortConstants, storage, component->m_Keys.data());
+		RadixSort::Sort(component->m_Keys.data(), component->m_SortScratch.data(), count, 32, 32);
+
+		component->m_VisibleCount = count;
+
+		// the render streams are contiguous in the storage
+		component->m_StreamBuffer->Update(storage.Streams[0], (UINT64)storage.Capacity * Particles::eRenderStreamCount * sizeof(float));
+		component->m_KeyBuffer->Update(component->m_Keys.data(), (UINT64)count * sizeof(UINT64));
+	}
+}
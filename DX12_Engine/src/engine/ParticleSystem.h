@@ -0,0 +1,73 @@
+// particle system
+// simulates the particle emitters submitted to the render list each frame (see RenderList::GetParticleComponents)
+// the CPU emitters are split in blocks of 4 slots : the blocks of all emitters are partitioned on the workers of the command recorder
+// then each worker builds and sorts the keys of its emitters, and uploads their render streams and their keys
+// the GPU emitters only get the constants of the frame : they are simulated and sorted on the GPU (see DX12Particles)
+
+#pragma once
+
+#include "engine/Particles.h"
+#include "engine/CommandRecorder.h"
+#include <vector>
+
+class ParticleComponent;
+
+// define
+#define			MIN_SIMULATE_BLOCK			1024	// blocks of 4 slots simulated by a worker before using another worker
+
+class ParticleSystem
+{
+public:
+	ParticleSystem();
+	~ParticleSystem();
+
+	// simulate and sort the emitters of the frame
+	void			Simulate(float i_Elapsed, const std::vector<ParticleComponent *> & i_Emitters, const XMMATRIX & i_View, CommandRecorder * i_Recorder);
+
+	// simulate a storage on the workers (CPU path without component, see particle_bench)
+	void			SimulateStorage(const Particles::SimulateConstants & i_Constants, Particles::Storage & io_Storage, CommandRecorder * i_Recorder);
+
+	// information
+	UINT			GetParticleCount() const;			// visible particles of the CPU emitters the last frame
+	UINT			GetSimulateWorkerUsed() const;		// workers that simulated particles the last frame
+
+private:
+	// CPU emitter of the frame
+	struct Emitter
+	{
+		ParticleComponent *						Component;		// nullptr for SimulateStorage
+		const Particles::SimulateConstants *	Constants;
+		Particles::Storage *					Storage;
+		UINT									FirstBlock;		// prefix of the block counts
+	};
+
+	// simulate a range of blocks
+	class SimulateRecorder : public CommandRecorder::Recorder
+	{
+	public:
+		SimulateRecorder(ParticleSystem * i_System);
+		virtual void	RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range) override;
+
+	private:
+		ParticleSystem *	m_System;
+	};
+
+	// sort and upload a range of emitters
+	class SortRecorder : public CommandRecorder::Recorder
+	{
+	public:
+		SortRecorder(ParticleSystem * i_System);
+		virtual void	RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range) override;
+
+	private:
+		ParticleSystem *	m_System;
+	};
+
+	void			SimulateEmitters(CommandRecorder * i_Recorder);
+
+	std::vector<Emitter>						m_Emitters;
+	std::vector<CommandRecorder::DrawRange>		m_Ranges;
+	UINT										m_BlockCount;
+	UINT										m_ParticleCount;
+	UINT										m_WorkerUsed;
+};
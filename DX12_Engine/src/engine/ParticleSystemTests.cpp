@@ -0,0 +1,201 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <thread>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/CommandRecorder.h"
+#include "engine/Particles.h"
+#include "engine/ParticleSystem.h"
+#include "engine/RadixSort.h"
+
+CFParticleBench::CFParticleBench()
+	:Console::Function("particle_bench", "[particle count]", "simulate and sort an emitter on the workers, check the SIMD path against the scalar kernel and the radix sort against std::sort, and measure the scaling")
+{
+}
+
+bool CFParticleBench::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT particleCount = 1 << 20;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		particleCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	const UINT frameCount = 16;
+	const float elapsed = 1.f / 60.f;
+	const float tolerance = 1e-5f;	// relative error between the SIMD path and the scalar kernel
+
+	// emitter : some particles die during the frames, the ring is replaced twice per second
+	Particles::EmitterDesc desc;
+	desc.Name			= "particle_bench";
+	desc.MaxParticles	= particleCount;
+	desc.LifetimeMin	= 0.1f;
+	desc.LifetimeMax	= 2.f;
+	desc.SpawnExtents	= XMFLOAT3(2.f, 1.f, 2.f);
+	desc.VelocityMin	= XMFLOAT3(-2.f, 1.f, -2.f);
+	desc.VelocityMax	= XMFLOAT3(2.f, 5.f, 2.f);
+	desc.Gravity		= XMFLOAT3(0.f, -9.81f, 0.f);
+	desc.Drag			= 0.5f;
+	desc.Seed			= 7;
+
+	const UINT capacity = Particles::GetCapacity(desc.MaxParticles);
+	const size_t storageSize = (size_t)capacity * Particles::eStreamCount * sizeof(float);
+	desc.SpawnRate = 2.f * (float)capacity;
+
+	// the first frame spawns all the slots
+	Particles::Storage initial, storage, reference;
+	Particles::AllocateStorage(initial, capacity);
+	Particles::AllocateStorage(storage, capacity);
+	Particles::AllocateStorage(reference, capacity);
+
+	Particles::EmitterState initialState;
+	Particles::SimulateConstants constants;
+	const XMFLOAT3 origin(0.f, 1.f, 10.f);
+
+	Particles::SetupSimulation(desc, origin, 0.5f, initialState, constants);
+	Particles::Simulate(constants, initial, 0, capacity);
+
+	// constants of the frames
+	std::vector<Particles::SimulateConstants> frames(frameCount);
+	Particles::EmitterState state = initialState;
+
+	for (UINT f = 0; f < frameCount; ++f)
+	{
+		Particles::SetupSimulation(desc, origin, elapsed, state, frames[f]);
+	}
+
+	// SIMD path against the scalar kernel
+	memcpy(storage.Streams[0], initial.Streams[0], storageSize);
+	memcpy(reference.Streams[0], initial.Streams[0], storageSize);
+
+	for (UINT f = 0; f < frameCount; ++f)
+	{
+		Particles::Simulate(frames[f], storage, 0, capacity);
+		Particles::SimulateReference(frames[f], reference, 0, capacity);
+	}
+
+	UINT errors = 0;
+	UINT aliveMismatch = 0;
+	UINT aliveCount = 0;
+	float simulateError = 0.f;
+
+	for (UINT i = 0; i < capacity; ++i)
+	{
+		const bool alive = storage.Streams[Particles::eAge][i] < storage.Streams[Particles::eLifetime][i];
+		const bool referenceAlive = reference.Streams[Particles::eAge][i] < reference.Streams[Particles::eLifetime][i];
+
+		aliveMismatch += (alive != referenceAlive) ? 1 : 0;
+		aliveCount += alive ? 1 : 0;
+
+		for (UINT stream = 0; stream < Particles::eStreamCount; ++stream)
+		{
+			const float value = storage.Streams[stream][i], referenceValue = reference.Streams[stream][i];
+			simulateError = Math::Max(simulateError, fabsf(value - referenceValue) / Math::Max(fabsf(referenceValue), 1.f));
+		}
+	}
+
+	if (simulateError > tolerance || aliveMismatch > 0)
+		++errors;
+
+	GetConsole()->Print("particle bench : %u slots, %u alive after %u frames, max error against the scalar kernel %g, %u alive mismatches",
+		capacity, aliveCount, frameCount, simulateError, aliveMismatch);
+
+	// simulation : 1, 2, 4... workers and the hardware thread count
+	const UINT maxWorker = Math::Max(std::thread::hardware_concurrency(), 1u);
+	std::vector<UINT> workerCounts;
+
+	for (UINT workerCount = 1; workerCount < maxWorker; workerCount *= 2)
+	{
+		workerCounts.push_back(workerCount);
+	}
+	workerCounts.push_back(maxWorker);
+
+	ParticleSystem particleSystem;
+	UINT64 serialTime = 0;
+
+	for (size_t w = 0; w < workerCounts.size(); ++w)
+	{
+		const UINT workerCount = workerCounts[w];
+		CommandRecorder recorder(workerCount);
+
+		memcpy(storage.Streams[0], initial.Streams[0], storageSize);
+		Clock clock;
+
+		for (UINT f = 0; f < frameCount; ++f)
+		{
+			particleSystem.SimulateStorage(frames[f], storage, &recorder);
+		}
+
+		const UINT64 time = clock.GetElaspedTime().ToMicroseconds() / frameCount;
+		serialTime = (w == 0) ? time : serialTime;
+
+		// same particles for any worker count
+		if (w == 0)
+			memcpy(reference.Streams[0], storage.Streams[0], storageSize);
+		else if (memcmp(storage.Streams[0], reference.Streams[0], storageSize) != 0)
+			++errors;
+
+		GetConsole()->Print("particle bench : simulation, %u workers (%u used), %llu us per frame (x%.2f)",
+			workerCount, particleSystem.GetSimulateWorkerUsed(), time, (float)serialTime / (float)Math::Max(time, (UINT64)1));
+	}
+
+	// sort : the camera looks at the emitter from the origin
+	const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.f, 2.f, 0.f, 1.f), XMLoadFloat3(&origin), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	Particles::SortConstants sortConstants;
+	Particles::SetupSort(view, capacity, sortConstants);
+
+	std::vector<UINT64> keys(capacity), scratch(capacity), sortedKeys;
+	Clock keyClock;
+	const UINT visibleCount = Particles::BuildSortKeys(sortConstants, storage, keys.data());
+	const UINT64 keyTime = keyClock.GetElaspedTime().ToMicroseconds();
+
+	sortedKeys.assign(keys.begin(), keys.begin() + visibleCount);
+	std::sort(sortedKeys.begin(), sortedKeys.end());
+
+	Clock sortClock;
+	RadixSort::Sort(keys.data(), scratch.data(), visibleCount, 32, 32);
+	const UINT64 sortTime = sortClock.GetElaspedTime().ToMicroseconds();
+
+	if (!std::equal(sortedKeys.begin(), sortedKeys.end(), keys.begin()))
+		++errors;
+
+	// back to front : the depths of the sorted particles decrease
+	UINT orderErrors = 0;
+	float previousDepth = FLT_MAX;
+
+	for (UINT i = 0; i < visibleCount; ++i)
+	{
+		const UINT slot = (UINT)(keys[i] & 0xFFFFFFFF);
+		const XMFLOAT4 & viewDepth = sortConstants.ViewDepth;
+		const float depth = storage.Streams[Particles::ePositionX][slot] * viewDepth.x + viewDepth.w + storage.Streams[Particles::ePositionY][slot] * viewDepth.y +
+			storage.Streams[Particles::ePositionZ][slot] * viewDepth.z;
+
+		orderErrors += (depth > previousDepth + tolerance * fabsf(previousDepth)) ? 1 : 0;
+		previousDepth = depth;
+	}
+
+	errors += (orderErrors > 0) ? 1 : 0;
+
+	GetConsole()->Print("particle bench : sort, %u visible particles, keys %llu us, radix sort %llu us, %u order errors",
+		visibleCount, keyTime, sortTime, orderErrors);
+
+	Particles::FreeStorage(initial);
+	Particles::FreeStorage(storage);
+	Particles::FreeStorage(reference);
+
+	GetConsole()->Print("particle bench : %u errors", errors);
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -0,0 +1,355 @@
+#include "Particles.h"
+
+#include "engine/RadixSort.h"
+#include "engine/Utils.h"
+#include "engine/Debug.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <malloc.h>
+
+UINT Particles::GetCapacity(UINT i_MaxParticles)
+{
+	const UINT count = Math::Min(Math::Max(i_MaxParticles, 1u), (UINT)PARTICLE_MAX_COUNT);
+	return (count + 3) & ~3u;
+}
+
+UINT Particles::GetSortCapacity(UINT i_Capacity)
+{
+	UINT capacity = PARTICLE_GROUP_SIZE;
+
+	while (capacity < i_Capacity)
+		capacity <<= 1;
+
+	return capacity;
+}
+
+void Particles::AllocateStorage(Storage & o_Storage, UINT i_MaxParticles)
+{
+	o_Storage.Capacity = GetCapacity(i_MaxParticles);
+
+	// the streams are aligned for the SIMD loads (the capacity is a multiple of 4)
+	float * data = (float *)_aligned_malloc(o_Storage.Capacity * eStreamCount * sizeof(float), 16);
+	memset(data, 0, o_Storage.Capacity * eStreamCount * sizeof(float));
+
+	for (UINT i = 0; i < eStreamCount; ++i)
+	{
+		o_Storage.Streams[i] = data + i * o_Storage.Capacity;
+	}
+}
+
+void Particles::FreeStorage(Storage & io_Storage)
+{
+	if (io_Storage.Capacity > 0)
+		_aligned_free(io_Storage.Streams[0]);
+
+	io_Storage.Capacity = 0;
+}
+
+void Particles::SetupSimulation(const EmitterDesc & i_Desc, const XMFLOAT3 & i_Origin, float i_Elapsed, EmitterState & io_State, SimulateConstants & o_Constants)
+{
+	const UINT capacity = GetCapacity(i_Desc.MaxParticles);
+
+	// particles of the frame (the fraction is spawned the next frames)
+	io_State.SpawnAccumulator += i_Elapsed * i_Desc.SpawnRate;
+
+	const UINT spawnCount = (UINT)Math::Min(io_State.SpawnAccumulator, (float)capacity);
+	io_State.SpawnAccumulator -= (float)spawnCount;
+	io_State.SpawnAccumulator = Math::Min(io_State.SpawnAccumulator, 1.f);
+
+	o_Constants.Origin			= i_Origin;
+	o_Constants.Elapsed			= i_Elapsed;
+	o_Constants.Gravity			= i_Desc.Gravity;
+	o_Constants.Damping			= Math::Max(1.f - i_Desc.Drag * i_Elapsed, 0.f);
+	o_Constants.VelocityMin		= i_Desc.VelocityMin;
+	o_Constants.LifetimeMin		= i_Desc.LifetimeMin;
+	o_Constants.VelocityMax		= i_Desc.VelocityMax;
+	o_Constants.LifetimeMax		= i_Desc.LifetimeMax;
+	o_Constants.SpawnExtents	= i_Desc.SpawnExtents;
+	o_Constants.Capacity		= capacity;
+	o_Constants.SpawnFirst		= (UINT)(io_State.Spawned % capacity);
+	o_Constants.SpawnCount		= spawnCount;
+	o_Constants.SpawnIndex		= (UINT)io_State.Spawned;
+	o_Constants.Seed			= i_Desc.Seed;
+
+	io_State.Spawned += spawnCount;
+}
+
+void Particles::Simulate(const SimulateConstants & i_Constants, Storage & io_Storage, UINT i_First, UINT i_Count)
+{
+	ASSERT((i_First & 3) == 0 && (i_Count & 3) == 0 && i_First + i_Count <= io_Storage.Capacity);
+
+	float * const * streams = io_Storage.Streams;
+	const UINT end = i_First + i_Count;
+
+	const XMVECTOR elapsed	= XMVectorReplicate(i_Constants.Elapsed);
+	const XMVECTOR damping	= XMVectorReplicate(i_Constants.Damping);
+	const XMVECTOR gravity[3] =
+	{
+		XMVectorReplicate(i_Constants.Gravity.x),
+		XMVectorReplicate(i_Constants.Gravity.y),
+		XMVectorReplicate(i_Constants.Gravity.z),
+	};
+
+	// integrate the alive particles, 4 slots at a time
+	for (UINT i = i_First; i < end; i += 4)
+	{
+		XMFLOAT4A * ageSlot = reinterpret_cast<XMFLOAT4A *>(streams[eAge] + i);
+		const XMVECTOR age		= XMLoadFloat4A(ageSlot);
+		const XMVECTOR lifetime	= XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A *>(streams[eLifetime] + i));
+		const XMVECTOR alive	= XMVectorLess(age, lifetime);
+
+		// the dead slots are not modified
+		if (XMVector4EqualInt(alive, XMVectorFalseInt()))
+			continue;
+
+		for (UINT axis = 0; axis < 3; ++axis)
+		{
+			XMFLOAT4A * velocitySlot = reinterpret_cast<XMFLOAT4A *>(streams[eVelocityX + axis] + i);
+			XMFLOAT4A * positionSlot = reinterpret_cast<XMFLOAT4A *>(streams[ePositionX + axis] + i);
+
+			const XMVECTOR velocity = XMLoadFloat4A(velocitySlot);
+			const XMVECTOR position = XMLoadFloat4A(positionSlot);
+			const XMVECTOR newVelocity = XMVectorMultiply(XMVectorMultiplyAdd(gravity[axis], elapsed, velocity), damping);
+
+			XMStoreFloat4A(velocitySlot, XMVectorSelect(velocity, newVelocity, alive));
+			XMStoreFloat4A(positionSlot, XMVectorSelect(position, XMVectorMultiplyAdd(newVelocity, elapsed, position), alive));
+		}
+
+		XMStoreFloat4A(ageSlot, XMVectorSelect(age, XMVectorAdd(age, elapsed), alive));
+	}
+
+	// spawned slots : the ring range [first, first + count) is split in two ranges when it wraps
+	const UINT spawnEnd = i_Constants.SpawnFirst + i_Constants.SpawnCount;
+	const UINT ranges[2][2] =
+	{
+		{ i_Constants.SpawnFirst, Math::Min(spawnEnd, i_Constants.Capacity) },
+		{ 0, (spawnEnd > i_Constants.Capacity) ? spawnEnd - i_Constants.Capacity : 0 },
+	};
+
+	for (UINT range = 0; range < 2; ++range)
+	{
+		const UINT first = Math::Max(ranges[range][0], i_First);
+		const UINT last = Math::Min(ranges[range][1], end);
+
+		for (UINT slot = first; slot < last; ++slot)
+		{
+			SpawnParticle(i_Constants, io_Storage, slot);
+		}
+	}
+}
+
+void Particles::SimulateReference(const SimulateConstants & i_Constants, Storage & io_Storage, UINT i_First, UINT i_Count)
+{
+	float * const * streams = io_Storage.Streams;
+	const float elapsed = i_Constants.Elapsed;
+	const float gravity[3] = { i_Constants.Gravity.x, i_Constants.Gravity.y, i_Constants.Gravity.z };
+
+	for (UINT slot = i_First; slot < i_First + i_Count; ++slot)
+	{
+		const UINT offset = (slot + i_Constants.Capacity - i_Constants.SpawnFirst) % i_Constants.Capacity;
+
+		if (offset < i_Constants.SpawnCount)
+		{
+			SpawnParticle(i_Constants, io_Storage, slot);
+			continue;
+		}
+
+		if (streams[eAge][slot] >= streams[eLifetime][slot])
+			continue;
+
+		for (UINT axis = 0; axis < 3; ++axis)
+		{
+			const float velocity = (streams[eVelocityX + axis][slot] + gravity[axis] * elapsed) * i_Constants.Damping;
+
+			streams[eVelocityX + axis][slot] = velocity;
+			streams[ePositionX + axis][slot] = streams[ePositionX + axis][slot] + velocity * elapsed;
+		}
+
+		streams[eAge][slot] = streams[eAge][slot] + elapsed;
+	}
+}
+
+void Particles::SetupSort(const XMMATRIX & i_View, UINT i_Capacity, SortConstants & o_Constants)
+{
+	XMFLOAT4X4 view;
+	XMStoreFloat4x4(&view, i_View);
+
+	// z column of the view matrix
+	o_Constants.ViewDepth		= XMFLOAT4(view._13, view._23, view._33, view._43);
+	o_Constants.Capacity		= i_Capacity;
+	o_Constants.SortCapacity	= GetSortCapacity(i_Capacity);
+	o_Constants.MergeSize		= 0;
+	o_Constants.CompareDistance	= 0;
+}
+
+UINT Particles::BuildSortKeys(const SortConstants & i_Constants, const Storage & i_Storage, UINT64 * o_Keys)
+{
+	ASSERT(i_Constants.Capacity == i_Storage.Capacity);
+
+	float * const * streams = i_Storage.Streams;
+	const XMVECTOR viewDepth[4] =
+	{
+		XMVectorReplicate(i_Constants.ViewDepth.x),
+		XMVectorReplicate(i_Constants.ViewDepth.y),
+		XMVectorReplicate(i_Constants.ViewDepth.z),
+		XMVectorReplicate(i_Constants.ViewDepth.w),
+	};
+
+	UINT count = 0;
+
+	// the slots are visited in ascending order : the keys with the same depth stay in slot order (see RadixSort)
+	for (UINT i = 0; i < i_Storage.Capacity; i += 4)
+	{
+		const XMVECTOR age		= XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A *>(streams[eAge] + i));
+		const XMVECTOR lifetime	= XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A *>(streams[eLifetime] + i));
+		const XMVECTOR alive	= XMVectorLess(age, lifetime);
+
+		if (XMVector4EqualInt(alive, XMVectorFalseInt()))
+			continue;
+
+		XMVECTOR depth = XMVectorMultiplyAdd(XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A *>(streams[ePositionX] + i)), viewDepth[0], viewDepth[3]);
+		depth = XMVectorMultiplyAdd(XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A *>(streams[ePositionY] + i)), viewDepth[1], depth);
+		depth = XMVectorMultiplyAdd(XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A *>(streams[ePositionZ] + i)), viewDepth[2], depth);
+
+		const XMVECTOR visible = XMVectorAndInt(alive, XMVectorGreater(depth, XMVectorZero()));
+
+		XMFLOAT4A depths;
+		XMUINT4 masks;
+		XMStoreFloat4A(&depths, depth);
+		XMStoreUInt4(&masks, visible);
+
+		const float * lanes = &depths.x;
+		const UINT * laneMasks = &masks.x;
+
+		for (UINT lane = 0; lane < 4; ++lane)
+		{
+			if (laneMasks[lane] != 0)
+				o_Keys[count++] = ((UINT64)RadixSort::BackToFrontKey(lanes[lane]) << 32) | (i + lane);
+		}
+	}
+
+	return count;
+}
+
+void Particles::SetupDraw(const EmitterDesc & i_Desc, const XMMATRIX & i_View, const XMMATRIX & i_Projection, UINT i_Capacity, DrawConstants & o_Constants)
+{
+	XMFLOAT4X4 view;
+	XMStoreFloat4x4(&view, i_View);
+	XMStoreFloat4x4(&o_Constants.ViewProjection, XMMatrixTranspose(XMMatrixMultiply(i_View, i_Projection)));
+
+	// the quads face the camera : x and y columns of the view matrix
+	o_Constants.CameraRight	= XMFLOAT3(view._11, view._21, view._31);
+	o_Constants.CameraUp	= XMFLOAT3(view._12, view._22, view._32);
+	o_Constants.SizeStart	= i_Desc.SizeStart;
+	o_Constants.SizeEnd		= i_Desc.SizeEnd;
+	o_Constants.ColorStart	= i_Desc.ColorStart;
+	o_Constants.ColorEnd	= i_Desc.ColorEnd;
+	o_Constants.Capacity	= i_Capacity;
+	o_Constants.Padding[0]	= o_Constants.Padding[1] = o_Constants.Padding[2] = 0;
+}
+
+UINT Particles::Hash(UINT i_Value)
+{
+	// pcg hash
+	const UINT state = i_Value * 747796405u + 2891336453u;
+	const UINT word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+
+	return (word >> 22u) ^ word;
+}
+
+float Particles::Random(UINT & io_State)
+{
+	// 24 bits : exact in a float
+	io_State = Hash(io_State);
+	return (float)(io_State >> 8) * (1.f / 16777216.f);
+}
+
+bool Particles::LoadEmitter(const std::string & i_Filepath, EmitterDesc & o_Desc)
+{
+	FILE * file = nullptr;
+
+	if (fopen_s(&file, i_Filepath.c_str(), "r") != 0 || file == nullptr)
+	{
+		PRINT_DEBUG("[Particles] unable to open the emitter %s", i_Filepath.c_str());
+		return false;
+	}
+
+	char line[256];
+	UINT lineIndex = 0;
+	bool valid = true;
+
+	while (fgets(line, sizeof(line), file) != nullptr)
+	{
+		++lineIndex;
+
+		char key[64] = {};
+		char value[64] = {};
+		XMFLOAT4 v(0.f, 0.f, 0.f, 1.f);
+
+		// empty lines and comments
+		if (sscanf_s(line, "%63s", key, (unsigned)sizeof(key)) != 1 || key[0] == '#')
+			continue;
+
+		const char * values = line + strspn(line, " \t") + strlen(key);
+		const int count = sscanf_s(values, "%f %f %f %f", &v.x, &v.y, &v.z, &v.w);
+
+		if (strcmp(key, "name") == 0 && sscanf_s(values, "%63s", value, (unsigned)sizeof(value)) == 1)	o_Desc.Name = value;
+		else if (strcmp(key, "max_particles") == 0 && count >= 1)	o_Desc.MaxParticles = (UINT)v.x;
+		else if (strcmp(key, "spawn_rate") == 0 && count >= 1)		o_Desc.SpawnRate = v.x;
+		else if (strcmp(key, "lifetime") == 0 && count >= 2)		{ o_Desc.LifetimeMin = v.x; o_Desc.LifetimeMax = v.y; }
+		else if (strcmp(key, "spawn_extents") == 0 && count >= 3)	o_Desc.SpawnExtents = XMFLOAT3(v.x, v.y, v.z);
+		else if (strcmp(key, "velocity_min") == 0 && count >= 3)	o_Desc.VelocityMin = XMFLOAT3(v.x, v.y, v.z);
+		else if (strcmp(key, "velocity_max") == 0 && count >= 3)	o_Desc.VelocityMax = XMFLOAT3(v.x, v.y, v.z);
+		else if (strcmp(key, "gravity") == 0 && count >= 3)			o_Desc.Gravity = XMFLOAT3(v.x, v.y, v.z);
+		else if (strcmp(key, "drag") == 0 && count >= 1)			o_Desc.Drag = v.x;
+		else if (strcmp(key, "size") == 0 && count >= 2)			{ o_Desc.SizeStart = v.x; o_Desc.SizeEnd = v.y; }
+		else if (strcmp(key, "color_start") == 0 && count >= 3)		o_Desc.ColorStart = v;
+		else if (strcmp(key, "color_end") == 0 && count >= 3)		o_Desc.ColorEnd = v;
+		else if (strcmp(key, "seed") == 0 && count >= 1)			o_Desc.Seed = (UINT)v.x;
+		else if (strcmp(key, "blend") == 0 && sscanf_s(values, "%63s", value, (unsigned)sizeof(value)) == 1 &&
+			(strcmp(value, "alpha") == 0 || strcmp(value, "additive") == 0))
+		{
+			o_Desc.BlendMode = (strcmp(value, "additive") == 0) ? eAdditive : eAlphaBlend;
+		}
+		else
+		{
+			PRINT_DEBUG("[Particles] %s(%u) : invalid line %s", i_Filepath.c_str(), lineIndex, key);
+			valid = false;
+		}
+	}
+
+	fclose(file);
+
+	o_Desc.MaxParticles = GetCapacity(o_Desc.MaxParticles);
+	o_Desc.LifetimeMax = Math::Max(o_Desc.LifetimeMax, o_Desc.LifetimeMin);
+
+	return valid;
+}
+
+FORCEINLINE void Particles::SpawnParticle(const SimulateConstants & i_Constants, Storage & io_Storage, UINT i_Slot)
+{
+	float * const * streams = io_Storage.Streams;
+
+	// random values of the spawn index : the same particle on both paths
+	const UINT offset = (i_Slot + i_Constants.Capacity - i_Constants.SpawnFirst) % i_Constants.Capacity;
+	UINT state = Hash(i_Constants.Seed ^ Hash(i_Constants.SpawnIndex + offset));
+
+	const float * origin	= &i_Constants.Origin.x;
+	const float * extents	= &i_Constants.SpawnExtents.x;
+	const float * minimum	= &i_Constants.VelocityMin.x;
+	const float * maximum	= &i_Constants.VelocityMax.x;
+
+	for (UINT axis = 0; axis < 3; ++axis)
+	{
+		streams[ePositionX + axis][i_Slot] = origin[axis] + (Random(state) * 2.f - 1.f) * extents[axis];
+	}
+
+	for (UINT axis = 0; axis < 3; ++axis)
+	{
+		streams[eVelocityX + axis][i_Slot] = minimum[axis] + (maximum[axis] - minimum[axis]) * Random(state);
+	}
+
+	streams[eAge][i_Slot]		= 0.f;
+	streams[eLifetime][i_Slot]	= i_Constants.LifetimeMin + (i_Constants.LifetimeMax - i_Constants.LifetimeMin) * Random(state);
+}
@@ -0,0 +1,153 @@
+// particle simulation
+// C++ side of the particle kernels (see Particles.hlsli) : the CPU path and the compute shaders have the same semantics
+// an emitter has a fixed number of slots : the particles are stored as one array per stream (structure of arrays)
+// the spawned particles of a frame take the next slots of a ring : the oldest particles are replaced when the emitter is full
+// a slot is alive while its age is lower than its lifetime, the random values of a particle are a hash of its spawn index
+// the CPU path simulates 4 slots per SIMD operation, the scalar kernel is the reference of both paths (see particle_bench)
+// the particles are drawn back to front : the sort keys are a depth key in the high bits and the slot in the low bits
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+#include <string>
+
+using namespace DirectX;
+
+// define
+#define			PARTICLE_GROUP_SIZE			256			// slots simulated by a thread group (must match the particle compute shaders)
+#define			PARTICLE_MAX_COUNT			(1 << 21)	// slots of an emitter
+#define			PARTICLE_INVALID_KEY		0xFFFFFFFFFFFFFFFFull	// sort key of the dead particles (sorted last)
+
+class Particles
+{
+public:
+	// streams of the storage (the render streams are the first ones : they are uploaded in one copy)
+	enum EStream
+	{
+		ePositionX = 0,
+		ePositionY,
+		ePositionZ,
+		eAge,
+		eLifetime,
+		eVelocityX,
+		eVelocityY,
+		eVelocityZ,
+		eStreamCount,
+
+		eRenderStreamCount = eVelocityX,	// read by the vertex shader
+	};
+
+	enum EBlendMode
+	{
+		eAlphaBlend = 0,	// smoke, dust
+		eAdditive,			// sparks
+		eBlendModeCount,
+	};
+
+	// emitter description (data : see LoadEmitter)
+	struct EmitterDesc
+	{
+		std::string		Name			= "Emitter";
+		UINT			MaxParticles	= 1024;
+		float			SpawnRate		= 64.f;		// particles per second
+		float			LifetimeMin		= 1.f;		// seconds
+		float			LifetimeMax		= 2.f;
+		XMFLOAT3		SpawnExtents	= XMFLOAT3(0.f, 0.f, 0.f);	// half size of the spawn box around the emitter (0 : point)
+		XMFLOAT3		VelocityMin		= XMFLOAT3(-0.5f, 1.f, -0.5f);
+		XMFLOAT3		VelocityMax		= XMFLOAT3(0.5f, 2.f, 0.5f);
+		XMFLOAT3		Gravity			= XMFLOAT3(0.f, 0.f, 0.f);
+		float			Drag			= 0.f;		// velocity lost per second
+		float			SizeStart		= 0.1f;		// half size of the quad
+		float			SizeEnd			= 0.1f;
+		XMFLOAT4		ColorStart		= XMFLOAT4(1.f, 1.f, 1.f, 1.f);
+		XMFLOAT4		ColorEnd		= XMFLOAT4(1.f, 1.f, 1.f, 0.f);
+		EBlendMode		BlendMode		= eAlphaBlend;
+		UINT			Seed			= 0;
+	};
+
+	// particles of an emitter
+	struct Storage
+	{
+		float *			Streams[eStreamCount];	// one allocation, the stream i is at i * capacity
+		UINT			Capacity = 0;			// multiple of 4
+	};
+
+	// spawn state of an emitter
+	struct EmitterState
+	{
+		UINT64			Spawned = 0;			// particles spawned since the creation
+		float			SpawnAccumulator = 0.f;	// fraction of particle to spawn
+	};
+
+	// simulation constants of a frame (same layout in Particles.hlsli)
+	struct SimulateConstants
+	{
+		XMFLOAT3		Origin;
+		float			Elapsed;
+		XMFLOAT3		Gravity;
+		float			Damping;		// velocity factor of the frame
+		XMFLOAT3		VelocityMin;
+		float			LifetimeMin;
+		XMFLOAT3		VelocityMax;
+		float			LifetimeMax;
+		XMFLOAT3		SpawnExtents;
+		UINT			Capacity;
+		UINT			SpawnFirst;		// first slot of the spawned particles
+		UINT			SpawnCount;
+		UINT			SpawnIndex;		// spawn index of the first spawned particle (random seed)
+		UINT			Seed;
+	};
+
+	// sort constants (same layout in Particles.hlsli)
+	struct SortConstants
+	{
+		XMFLOAT4		ViewDepth;		// view depth = dot(position, xyz) + w
+		UINT			Capacity;
+		UINT			SortCapacity;	// power of 2 (bitonic sort of the GPU path)
+		UINT			MergeSize;		// bitonic sort step (GPU only)
+		UINT			CompareDistance;
+	};
+
+	// draw constants (same layout in ParticleVS.hlsl)
+	struct DrawConstants
+	{
+		XMFLOAT4X4		ViewProjection;	// transposed
+		XMFLOAT3		CameraRight;
+		float			SizeStart;
+		XMFLOAT3		CameraUp;
+		float			SizeEnd;
+		XMFLOAT4		ColorStart;
+		XMFLOAT4		ColorEnd;
+		UINT			Capacity;
+		UINT			Padding[3];
+	};
+
+	// storage
+	static UINT		GetCapacity(UINT i_MaxParticles);
+	static UINT		GetSortCapacity(UINT i_Capacity);
+	static void		AllocateStorage(Storage & o_Storage, UINT i_MaxParticles);	// all particles are dead
+	static void		FreeStorage(Storage & io_Storage);
+
+	// simulation
+	static void		SetupSimulation(const EmitterDesc & i_Desc, const XMFLOAT3 & i_Origin, float i_Elapsed, EmitterState & io_State, SimulateConstants & o_Constants);
+	static void		Simulate(const SimulateConstants & i_Constants, Storage & io_Storage, UINT i_First, UINT i_Count);			// SIMD : first and count are multiple of 4
+	static void		SimulateReference(const SimulateConstants & i_Constants, Storage & io_Storage, UINT i_First, UINT i_Count);	// scalar kernel (same as SimulateParticlesCS.hlsl)
+
+	// sort
+	static void		SetupSort(const XMMATRIX & i_View, UINT i_Capacity, SortConstants & o_Constants);
+	static UINT		BuildSortKeys(const SortConstants & i_Constants, const Storage & i_Storage, UINT64 * o_Keys);	// keys of the visible particles (alive and in front of the camera), return the count
+
+	// draw
+	static void		SetupDraw(const EmitterDesc & i_Desc, const XMMATRIX & i_View, const XMMATRIX & i_Projection, UINT i_Capacity, DrawConstants & o_Constants);
+
+	// random (same as Particles.hlsli)
+	static UINT		Hash(UINT i_Value);
+	static float	Random(UINT & io_State);	// [0, 1)
+
+	// emitter file : one "key values" line per parameter of the description (see resources/particles)
+	static bool		LoadEmitter(const std::string & i_Filepath, EmitterDesc & o_Desc);
+
+private:
+	static void		SpawnParticle(const SimulateConstants & i_Constants, Storage & io_Storage, UINT i_Slot);
+};
@@ -0,0 +1,63 @@
+#include "RadixSort.h"
+
+#include "engine/Debug.h"
+#include <string.h>
+
+void RadixSort::Sort(UINT64 * io_Keys, UINT64 * io_Scratch, size_t i_Count, UINT i_FirstBit, UINT i_BitCount)
+{
+	ASSERT(i_FirstBit + i_BitCount <= 64);
+
+	if (i_Count < 2)
+		return;
+
+	UINT64 * source = io_Keys;
+	UINT64 * destination = io_Scratch;
+	size_t counts[RADIX_SORT_BUCKETS];
+
+	for (UINT shift = i_FirstBit; shift < i_FirstBit + i_BitCount; shift += RADIX_SORT_BITS)
+	{
+		// histogram of the digit
+		memset(counts, 0, sizeof(counts));
+
+		for (size_t i = 0; i < i_Count; ++i)
+		{
+			++counts[(source[i] >> shift) & (RADIX_SORT_BUCKETS - 1)];
+		}
+
+		// all keys in one bucket : the pass doesn't change the order
+		if (counts[(source[0] >> shift) & (RADIX_SORT_BUCKETS - 1)] == i_Count)
+			continue;
+
+		// offsets of the buckets
+		size_t offset = 0;
+		for (UINT bucket = 0; bucket < RADIX_SORT_BUCKETS; ++bucket)
+		{
+			const size_t count = counts[bucket];
+			counts[bucket] = offset;
+			offset += count;
+		}
+
+		// scatter (stable)
+		for (size_t i = 0; i < i_Count; ++i)
+		{
+			const UINT64 key = source[i];
+			destination[counts[(key >> shift) & (RADIX_SORT_BUCKETS - 1)]++] = key;
+		}
+
+		UINT64 * swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	if (source != io_Keys)
+		memcpy(io_Keys, source, i_Count * sizeof(UINT64));
+}
+
+UINT RadixSort::BackToFrontKey(float i_Depth)
+{
+	// the bits of positive floats are ordered as the floats : the complement reverses the order
+	UINT bits;
+	memcpy(&bits, &i_Depth, sizeof(UINT));
+
+	return ~bits;
+}
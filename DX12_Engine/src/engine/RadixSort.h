@@ -0,0 +1,23 @@
+// radix sort of 64 bits keys
+// least significant digit first, 8 bits per pass : each pass is stable, the keys are sorted in ascending order
+// the passes where all keys have the same digit are skipped (the keys of a frame often share their high bits)
+// the sort keys of the renderer are a depth key in the high bits and an index in the low bits :
+// when the indices are written in ascending order, sorting the high 32 bits only gives the order of a full sort
+
+#pragma once
+
+#include <Windows.h>
+
+// define
+#define			RADIX_SORT_BITS			8
+#define			RADIX_SORT_BUCKETS		(1 << RADIX_SORT_BITS)
+
+namespace RadixSort
+{
+	// sort the bits [i_FirstBit, i_FirstBit + i_BitCount) of the keys, io_Scratch is a buffer of the same size as io_Keys
+	// the result is in io_Keys
+	void		Sort(UINT64 * io_Keys, UINT64 * io_Scratch, size_t i_Count, UINT i_FirstBit = 0, UINT i_BitCount = 64);
+
+	// depth key : ascending keys are back to front (far first), the key of the depth 0 is the highest key
+	UINT		BackToFrontKey(float i_Depth);	// i_Depth > 0
+}
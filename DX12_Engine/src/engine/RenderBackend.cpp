@@ -0,0 +1,82 @@
+#include "RenderBackend.h"
+
+#include "engine/Debug.h"
+
+RenderBackend::RenderBackend(EBackendType i_Type)
+	:m_FrameCount(0)
+	,m_Type(i_Type)
+	,m_AllocatedSize(0)
+	,m_PeakAllocatedSize(0)
+	,m_AllocationCount(0)
+{
+}
+
+RenderBackend::~RenderBackend()
+{
+	if (m_AllocationCount != 0)
+	{
+		PRINT_DEBUG("[RenderBackend] %u allocations are still alive (%llu bytes)", m_AllocationCount, m_AllocatedSize);
+	}
+}
+
+RenderBackend::EBackendType RenderBackend::GetType() const
+{
+	return m_Type;
+}
+
+bool RenderBackend::IsHeadless() const
+{
+	return m_Type == eNullBackend;
+}
+
+UINT64 RenderBackend::GetFrameCount() const
+{
+	return m_FrameCount;
+}
+
+UINT RenderBackend::TrackAllocation(const wchar_t * i_Name, UINT64 i_Size)
+{
+	Allocation allocation;
+	allocation.Name		= i_Name;
+	allocation.Size		= i_Size;
+	allocation.IsAlive	= true;
+
+	m_Allocations.push_back(allocation);
+
+	m_AllocatedSize += i_Size;
+	m_PeakAllocatedSize = (m_AllocatedSize > m_PeakAllocatedSize) ? m_AllocatedSize : m_PeakAllocatedSize;
+	++m_AllocationCount;
+
+	return (UINT)m_Allocations.size() - 1;
+}
+
+void RenderBackend::ReleaseAllocation(UINT i_Allocation)
+{
+	if (i_Allocation >= m_Allocations.size() || !m_Allocations[i_Allocation].IsAlive)
+	{
+		PRINT_DEBUG("[RenderBackend] release of an unknown allocation");
+		DEBUG_BREAK;
+		return;
+	}
+
+	Allocation & allocation = m_Allocations[i_Allocation];
+	allocation.IsAlive = false;
+
+	m_AllocatedSize -= allocation.Size;
+	--m_AllocationCount;
+}
+
+UINT64 RenderBackend::GetAllocatedSize() const
+{
+	return m_AllocatedSize;
+}
+
+UINT64 RenderBackend::GetPeakAllocatedSize() const
+{
+	return m_PeakAllocatedSize;
+}
+
+UINT RenderBackend::GetAllocationCount() const
+{
+	return m_AllocationCount;
+}
@@ -0,0 +1,195 @@
+// render backend : frame submission, memory and pass recording
+// the DX12 backend submits the contexts of DX12RenderEngine and pushes the passes on their command lists (see DX12RenderBackend)
+// the null backend runs without device or window and records draws in an inspectable stream (see NullRenderBackend)
+// the render list does the CPU work of its passes (culling, sorting, uploads) then records them with the backend (see RenderList)
+
+#pragma once
+
+#include "dx12/DX12Utils.h"
+#include <string>
+#include <vector>
+
+// class predef
+class DX12Material;
+class DX12Mesh;
+class DX12UploadBuffer;
+class RenderComponent;
+class ParticleComponent;
+
+class RenderBackend
+{
+public:
+	enum EBackendType
+	{
+		eDX12Backend,
+		eNullBackend,	// headless : no device, no window
+
+		eBackendTypeCount,
+	};
+
+	// passes of the draw calls (submission order)
+	enum EPass
+	{
+		eDepthPass,
+		eGBufferPass,
+		eShadowPass,
+		eLightPass,
+		eTransparentPass,	// particles (element flags : Particles::EBlendMode)
+		eDebugPass,		// debug draw (element flags : DebugDraw::EPrimitive)
+
+		ePassCount,
+	};
+
+	// draw call recorded by the null backend
+	struct DrawCall
+	{
+		EPass			Pass;
+		UINT64			ElementFlags;	// mesh layout (see DX12PipelineState::EElementFlags)
+		const void *	Material;		// nullptr for depth only passes
+		const void *	Mesh;
+		UINT			InstanceCount;
+	};
+
+	// CPU visible memory of the constant and upload buffers
+	// DX12 : mapped buffer in the upload heap, headless : system memory (no resource and no GPU address)
+	struct UploadMemory
+	{
+		ID3D12Resource *			Resource	= nullptr;
+		UINT8 *						CPUAddress	= nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS	GPUAddress	= 0;
+	};
+
+	// mesh draw of the depth, GBuffer and transparent passes
+	struct MeshDraw
+	{
+		UINT64						ElementFlags;
+		const DX12Material *		Parent;		// owner of the pipeline state (the material or the parent of the instance)
+		const DX12Material *		Material;
+		const DX12Mesh *			Mesh;
+		const RenderComponent *		Component;	// transform constant buffer
+		UINT						FirstBone;	// skinned meshes : palette of the animator
+	};
+
+	// GPU driven GBuffer : the draws sharing a pipeline state and a mesh are one batch, culled on the GPU and drawn indirectly (see DX12GPUCulling)
+	struct IndirectBatch
+	{
+		UINT64						ElementFlags;
+		const DX12Material *		Parent;
+		const DX12Mesh *			Mesh;
+		UINT						FirstInstance;	// range of the batch in the visible instances (first draw of the batch in the queue)
+	};
+
+	// clustered lights of the frame : read by the light pass and the forward pass
+	struct Lighting
+	{
+		ADDRESS_ID					SceneData;	// camera and clusters (global constant buffer)
+		const DX12UploadBuffer *	PointLights;
+		const DX12UploadBuffer *	SpotLights;
+		const DX12UploadBuffer *	DirectionalLights;
+		const DX12UploadBuffer *	Clusters;
+		const DX12UploadBuffer *	LightIndices;
+		const DX12UploadBuffer *	ShadowViews;
+		const DX12UploadBuffer *	LightShadows;
+	};
+
+	// semi transparent pass : the draws are sorted by the render list (see TransparentSort)
+	struct TransparentPass
+	{
+		ID3D12GraphicsCommandList *			CommandList;
+		Lighting							Lights;
+		DirectX::XMMATRIX					View;
+		DirectX::XMMATRIX					Projection;
+		const MeshDraw *					Meshes;
+		ParticleComponent * const *			Emitters;
+		const UINT64 *						Keys;		// sorted draws : a draw index is a mesh index or the mesh count + an emitter index
+		UINT								MeshCount;
+		UINT								EmitterCount;
+		bool								OrderIndependent;	// the meshes are composited before the emitters
+	};
+
+	// debug primitives of the frame (see DebugDraw)
+	struct DebugPass
+	{
+		ID3D12GraphicsCommandList *			CommandList;
+		DirectX::XMMATRIX					ViewProjection;
+		const DX12UploadBuffer * const *	Instances;		// instances per primitive type
+		const UINT *						InstanceCount;	// per primitive type (depth tested instances first)
+	};
+
+	// shadow casters of the atlas : one instanced draw per batch
+	struct ShadowBatch
+	{
+		UINT64						ElementFlags;
+		const DX12Mesh *			Mesh;
+		UINT						FirstInstance;	// offset in the instance buffer
+		UINT						InstanceCount;
+	};
+
+	struct ShadowView
+	{
+		DirectX::XMFLOAT4X4			ViewProjection;	// transposed
+		UINT						X, Y, Size;		// atlas tile
+		UINT						FirstBatch;
+		UINT						BatchCount;
+	};
+
+	struct ShadowPass
+	{
+		ID3D12GraphicsCommandList *		CommandList;
+		const DX12UploadBuffer *		Instances;	// transforms of the batches
+		const ShadowView *				Views;
+		UINT							ViewCount;
+		const ShadowBatch *				Batches;
+	};
+
+	virtual ~RenderBackend();
+
+	EBackendType	GetType() const;
+	bool			IsHeadless() const;
+
+	// frame
+	virtual HRESULT		BeginFrame() = 0;	// wait for the frame resources and reset the contexts
+	virtual HRESULT		EndFrame() = 0;		// submit and present
+	virtual HRESULT		Close() = 0;		// wait for the pending frames
+	UINT64				GetFrameCount() const;	// frames ended since the creation
+
+	// memory : buffers are tracked by both backends
+	UINT			TrackAllocation(const wchar_t * i_Name, UINT64 i_Size);	// return the allocation id
+	void			ReleaseAllocation(UINT i_Allocation);
+	UINT64			GetAllocatedSize() const;
+	UINT64			GetPeakAllocatedSize() const;
+	UINT			GetAllocationCount() const;	// allocations alive
+
+	// resources
+	virtual bool	CreateUploadMemory(UINT64 i_Size, const wchar_t * i_Name, UploadMemory & o_Memory) = 0;
+	virtual void	ReleaseUploadMemory(UploadMemory & io_Memory) = 0;
+	virtual bool	PreparePipelineState(const DX12Material * i_Material, UINT64 i_ElementFlags, bool i_IndirectDraw) = 0;	// false if the material can't be drawn with this layout
+
+	// passes : the ranges of the GBuffer are recorded in parallel (one stream per worker), the other passes on the calling thread
+	// the draw count of the pass is returned (instanced draw calls)
+	virtual void	RecordLightPass(ID3D12GraphicsCommandList * i_CommandList, const Lighting & i_Lighting, const DX12Mesh * i_RectMesh) = 0;
+	virtual void	RecordGBufferRange(UINT i_Worker, const MeshDraw * i_Draws, UINT i_Count, bool i_DepthPrePass) = 0;
+	virtual void	RecordIndirectRange(UINT i_Worker, const IndirectBatch * i_Batches, UINT i_FirstBatch, UINT i_Count, ADDRESS_ID i_Transform) = 0;
+	virtual UINT	RecordShadowPass(const ShadowPass & i_Pass) = 0;
+	virtual UINT	RecordTransparentPass(const TransparentPass & i_Pass) = 0;
+	virtual UINT	RecordDebugPass(const DebugPass & i_Pass) = 0;
+
+protected:
+	RenderBackend(EBackendType i_Type);
+
+	UINT64				m_FrameCount;
+
+private:
+	struct Allocation
+	{
+		std::wstring	Name;
+		UINT64			Size;
+		bool			IsAlive;
+	};
+
+	const EBackendType			m_Type;
+	std::vector<Allocation>		m_Allocations;
+	UINT64						m_AllocatedSize;
+	UINT64						m_PeakAllocatedSize;
+	UINT						m_AllocationCount;
+};
@@ -2,33 +2,96 @@
 
 #include "dx12/DX12Utils.h"
 #include "dx12/DX12RenderEngine.h"
-#include "dx12/DX12RootSignature.h"
 #include "dx12/DX12PipelineState.h"
 #include "dx12/DX12ConstantBuffer.h"
-#include "dx12/DX12RenderTarget.h"
+#include "dx12/DX12UploadBuffer.h"
+#include "dx12/DX12MaterialParameterBuffer.h"
+#include "dx12/DX12ShadowMap.h"
+#include "dx12/DX12Context.h"
+#include "dx12/DX12GPUProfiler.h"
+#include "dx12/DX12GPUCulling.h"
 #include "components/RenderComponent.h"
+#include "components/ParticleComponent.h"
 #include "resource/DX12Mesh.h"
+#include "resource/DX12Material.h"
 #include "engine/Actor.h"
+#include "engine/Animation.h"
+#include "engine/RenderBackend.h"
+#include "engine/CPUProfiler.h"
+#include "engine/RadixSort.h"
+#include "engine/TransparentSort.h"
+
+#include <algorithm>
+#include <float.h>
 
 RenderList::RenderList()
-	:m_MaxLight(MAX_LIGHT)
+	:m_Backend(DX12RenderEngine::GetInstance().GetBackend())
+	,m_IsSetup(false)
+	,m_MaxLight(MAX_LIGHT)
+	,m_LightUploadSize(0)
+	,m_ShadowDistance(150.f)
+	,m_ShadowDrawCount(0)
+	,m_DebugDrawCount(0)
+	,m_TransparentDrawCount(0)
+	,m_LightsPrepared(false)
+	,m_LightsRendered(false)
+	,m_ShadowsRendered(false)
+	,m_InterpolationAlpha(1.f)
 {
-	// compilation assert
-	static_assert(sizeof(RenderList::LightData) == sizeof(PointLightData), "The point light data structures need to be the same size (until some errors during lights computation will comes)");
-	static_assert(sizeof(RenderList::LightData) == sizeof(SpotLightData), "The spot light data structures need to be the same size (until some errors during lights computation will comes)");
-	static_assert(sizeof(RenderList::LightData) == sizeof(DirectionnalLightData), "The spot light data structures need to be the same size (until some errors during lights computation will comes)");
-
 	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
 
 	m_RenderComponents.reserve(0x100);
 	m_LightComponents.reserve(m_MaxLight);
 	m_RectMesh = render.GetRectMesh();	// retreive the mesh for draw full frame
 
-	m_LightConstantAddress		= render.GetConstantBuffer(DX12RenderEngine::eLight)->ReserveVirtualAddress();
 	m_LightCameraConstAddress	= render.GetConstantBuffer(DX12RenderEngine::eGlobal)->ReserveVirtualAddress();
+	m_IndirectTransformAddress	= render.GetConstantBuffer(DX12RenderEngine::eTransform)->ReserveVirtualAddress();
+
+	// create light data storage (packed per type)
+	static const wchar_t * lightBufferNames[Light::eLightTypeCount] = { L"PointLights", L"SpotLights", L"DirectionalLights" };
+
+	for (UINT i = 0; i < Light::eLightTypeCount; ++i)
+	{
+		m_Lights[i].reserve(m_MaxLight);
+		m_LightBuffer[i] = new DX12UploadBuffer(m_MaxLight * Light::GetLightDataSize((Light::ELightType)i), lightBufferNames[i]);
+	}
+
+	m_LightSlots.resize(render.GetFrameBufferCount() * Light::eLightTypeCount);
+	m_LightBounds.reserve(m_MaxLight);
 
-	// create light data storage
-	m_LightsData = new LightDesc;
+	// clustered lighting : buffers are read as structured buffers by the light shader
+	m_LightCluster		= new LightCluster;
+	m_ClusterBuffer		= new DX12UploadBuffer(m_LightCluster->GetClusterCount() * sizeof(LightCluster::ClusterData), L"LightClusters");
+	m_LightIndexBuffer	= new DX12UploadBuffer(m_LightCluster->GetDesc().MaxLightIndex * sizeof(UINT), L"LightIndices");
+
+	// shadows
+	m_ShadowAtlas			= new ShadowAtlas((render.GetShadowMap() != nullptr) ? render.GetShadowMap()->GetSize() : DX12ShadowMap::ShadowMapDesc().Size);
+	m_ShadowViewBuffer		= new DX12UploadBuffer(MAX_SHADOW_VIEW * sizeof(ShadowViewData), L"ShadowViews");
+	m_LightShadowBuffer		= new DX12UploadBuffer(m_MaxLight * sizeof(UINT), L"LightShadows");
+	m_ShadowInstanceBuffer	= new DX12UploadBuffer(MAX_SHADOW_INSTANCE * sizeof(XMFLOAT4X4), L"ShadowInstances");
+
+	m_ShadowViews.reserve(MAX_SHADOW_VIEW);
+	m_ShadowViewProj.reserve(MAX_SHADOW_VIEW);
+	m_ShadowTiles.reserve(MAX_SHADOW_VIEW);
+	m_LightShadows.reserve(m_MaxLight);
+	m_ShadowCasters.reserve(0x100);
+	m_ShadowInstances.reserve(MAX_SHADOW_INSTANCE);
+	m_ShadowPassViews.reserve(MAX_SHADOW_VIEW);
+	m_ShadowBatches.reserve(0x100);
+
+	// debug draw
+	static const wchar_t * debugDrawBufferNames[DebugDraw::ePrimitiveCount] = { L"DebugLines", L"DebugBoxes", L"DebugSpheres" };
+
+	for (UINT i = 0; i < DebugDraw::ePrimitiveCount; ++i)
+	{
+		const UINT64 size = (UINT64)Math::Max(DebugDraw::GetCapacity(), 1u) * DebugDraw::GetInstanceSize((DebugDraw::EPrimitive)i);
+		m_DebugDrawBuffer[i] = new DX12UploadBuffer(size, debugDrawBufferNames[i]);
+	}
+
+	// GBuffer recording
+	m_CommandRecorder = new CommandRecorder(render.GetRecordWorkerCount());
+	m_DrawQueue.reserve(0x100);
+	m_IndirectBatches.reserve(0x100);
 
 	// create default variable
 	Reset();
@@ -45,11 +108,30 @@ RenderList::~RenderList()
 	
 	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
 
-	render.GetConstantBuffer(DX12RenderEngine::eLight)->ReleaseVirtualAddress(m_LightConstantAddress);
 	render.GetConstantBuffer(DX12RenderEngine::eGlobal)->ReleaseVirtualAddress(m_LightCameraConstAddress);
+	render.GetConstantBuffer(DX12RenderEngine::eTransform)->ReleaseVirtualAddress(m_IndirectTransformAddress);
 
 	// clean resources
-	delete m_LightsData;	// delete the array
+	for (UINT i = 0; i < Light::eLightTypeCount; ++i)
+	{
+		delete m_LightBuffer[i];
+	}
+
+	delete m_LightCluster;
+	delete m_ClusterBuffer;
+	delete m_LightIndexBuffer;
+
+	delete m_ShadowAtlas;
+	delete m_ShadowViewBuffer;
+	delete m_LightShadowBuffer;
+	delete m_ShadowInstanceBuffer;
+
+	for (UINT i = 0; i < DebugDraw::ePrimitiveCount; ++i)
+	{
+		delete m_DebugDrawBuffer[i];
+	}
+
+	delete m_CommandRecorder;
 }
 
 void RenderList::SetupRenderList(const RenderListSetup & i_Setup)
@@ -60,6 +142,8 @@ void RenderList::SetupRenderList(const RenderListSetup & i_Setup)
 	m_Projection			= i_Setup.ProjectionMatrix;
 	m_CameraPosition		= i_Setup.CameraPosition;
 	m_View					= i_Setup.ViewMatrix;
+	m_InterpolationAlpha	= i_Setup.InterpolationAlpha;
+	m_IsSetup				= true;
 }
 
 size_t RenderList::RenderComponentCount() const
@@ -69,7 +153,9 @@ size_t RenderList::RenderComponentCount() const
 
 void RenderList::RenderLight() const
 {
-	if (m_ImmediateCommandList == nullptr)
+	CPU_ZONE("Render Light");
+
+	if (!m_IsSetup)
 	{
 		PRINT_DEBUG("[RenderList] call RenderLight before a setup call");
 		DEBUG_BREAK;
@@ -79,138 +165,229 @@ void RenderList::RenderLight() const
 	// -- Render Lights -- //
 	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
 
-	for (size_t i = 0; i < m_LightComponents.size(); ++i)
-	{
-		const LightComponent * lightComponent = m_LightComponents[i];
-		Light * light				= lightComponent->GetLight();
-		Actor * actor				= lightComponent->GetActor();
-
-		switch (lightComponent->GetLightType())
-		{
-			// fill data for the point light
-		case Light::ELightType::ePointLight:
-		{
-			PointLightData * desc = (PointLightData *)&m_LightsData->Data[i];
-
-			// position transform
-			XMMATRIX actorWorldTransform = actor->GetWorldTransform();
-			XMFLOAT4X4 worldTransform;
-			XMStoreFloat4x4(&worldTransform, actorWorldTransform);
-
-			// fill light description
-			desc->Position		= XMFLOAT3(&worldTransform._41);
-			desc->Color			= light->GetColor();
-			desc->Constant		= light->GetConstant();
-			desc->Linear		= light->GetLinear();
-			desc->Quadratic		= light->GetQuadratic();
-			desc->Range			= light->GetRange();
-			desc->Type			= light->GetType();
-		}
-		break;
-			// fill data for the spot light
-		case Light::ELightType::eSpotLight:
-		{
-			SpotLightData * desc = (SpotLightData *)&m_LightsData->Data[i];
-
-			// position transform
-			XMMATRIX actorWorldTransform = actor->GetWorldTransform();
-			XMFLOAT4X4 worldTransform;
-			XMStoreFloat4x4(&worldTransform, actorWorldTransform);
-
-			// fill light description
-			desc->Position		= XMFLOAT3(&worldTransform._41);
-			desc->Color			= light->GetColor();
-			desc->Constant		= light->GetConstant();
-			desc->Linear		= light->GetLinear();
-			desc->Quadratic		= light->GetQuadratic();
-			desc->Range			= light->GetRange();
-
-			desc->Direction		= XMFLOAT3(&worldTransform._31);
-			desc->SpotAngle		= light->GetSpotAngle();
-			desc->OuterCutoff	= light->GetEdgeCutoff();
-			desc->Type			= light->GetType();
-		}
-		break;
-			// fill data for directionnal lights
-		case Light::ELightType::eDirectionalLight:
-		{
-			DirectionnalLightData * desc = (DirectionnalLightData *)&m_LightsData->Data[i];
+	PrepareLights();
 
-			// position transform
-			XMMATRIX actorWorldTransform = actor->GetWorldTransform();
-			XMFLOAT4X4 worldTransform;
-			XMStoreFloat4x4(&worldTransform, actorWorldTransform);
+	// no shadow pass this frame : lights are not shadowed
+	if (!m_ShadowsRendered)
+	{
+		m_LightShadows.assign(m_LightBounds.size(), NO_SHADOW);
+		m_LightShadowBuffer->Update(m_LightShadows.data(), m_LightShadows.size() * sizeof(UINT));
+	}
 
-			desc->Position		= XMFLOAT3(&worldTransform._41);
-			desc->Color			= light->GetColor();
+	// assign lights to clusters
+	m_LightCluster->SetupView(m_Projection, render.GetRenderSize());
+	m_LightCluster->BuildClusters(m_LightBounds.data(), (UINT)m_LightBounds.size());
 
-			desc->Direction		= XMFLOAT3(&worldTransform._31);
-			desc->Type			= light->GetType();
-		}
-		break;
-			// error if fall in that case
-		default:
-			ASSERT_ERROR("Error on light type");
-			break;
-		}
-	}
+	const LightCluster::ClusterConstants clusterConstants = m_LightCluster->GetConstants();
+	const std::vector<LightCluster::ClusterData> & clusters = m_LightCluster->GetClusters();
+	const std::vector<UINT> & lightIndices = m_LightCluster->GetLightIndices();
 
 	// update constant buffer
 	// transform buffer
 	__declspec(align(16)) struct SceneDataBuffer
 	{
 		// data for light computation
+		DirectX::XMFLOAT4X4		m_View;
+		DirectX::XMFLOAT4X4		m_InvView;
+		DirectX::XMFLOAT4X4		m_InvProjection;	// position reconstruction from the depth
 		DirectX::XMFLOAT3		m_CameraPos;
 		int						m_LightCount;
+		// clusters
+		UINT					m_ClusterCount[3];
+		UINT					m_GlobalLightCount;
+		DirectX::XMFLOAT2		m_TileSize;
+		float					m_SliceScale;
+		float					m_SliceBias;
+		// light buffers
+		UINT					m_PointLightCount;
+		UINT					m_SpotLightCount;
 	};
 
 	SceneDataBuffer buffer;
-	//XMStoreFloat4x4(&buffer.m_View, XMMatrixTranspose(m_View));
-	//XMStoreFloat4x4(&buffer.m_Projection, XMMatrixTranspose(m_Projection));
-	buffer.m_CameraPos = m_CameraPosition;
-	buffer.m_LightCount = (int)m_LightComponents.size();
+	XMStoreFloat4x4(&buffer.m_View, XMMatrixTranspose(m_View));
+	XMStoreFloat4x4(&buffer.m_InvView, XMMatrixTranspose(XMMatrixInverse(nullptr, m_View)));
+	XMStoreFloat4x4(&buffer.m_InvProjection, XMMatrixTranspose(XMMatrixInverse(nullptr, m_Projection)));
+	buffer.m_CameraPos			= m_CameraPosition;
+	buffer.m_LightCount			= (int)m_LightComponents.size();
+	buffer.m_ClusterCount[0]	= clusterConstants.ClusterCount[0];
+	buffer.m_ClusterCount[1]	= clusterConstants.ClusterCount[1];
+	buffer.m_ClusterCount[2]	= clusterConstants.ClusterCount[2];
+	buffer.m_GlobalLightCount	= clusterConstants.GlobalLightCount;
+	buffer.m_TileSize			= clusterConstants.TileSize;
+	buffer.m_SliceScale			= clusterConstants.SliceScale;
+	buffer.m_SliceBias			= clusterConstants.SliceBias;
+	buffer.m_PointLightCount	= (UINT)m_Lights[Light::ePointLight].size();
+	buffer.m_SpotLightCount		= (UINT)m_Lights[Light::eSpotLight].size();
 
 	render.GetConstantBuffer(DX12RenderEngine::eGlobal)->UpdateConstantBuffer(m_LightCameraConstAddress, &buffer, sizeof(SceneDataBuffer));
-	render.GetConstantBuffer(DX12RenderEngine::eLight)->UpdateConstantBuffer(m_LightConstantAddress, m_LightsData, ((int)m_LightComponents.size()) * sizeof(LightData));
 
-	// setup pipeline state objects
-	DX12RootSignature * rootSignature = render.GetLightRootSignature();
-	DX12PipelineState * pipelineState = render.GetLightPipelineState();
+	// update structured buffers
+	m_ClusterBuffer->Update(clusters.data(), clusters.size() * sizeof(LightCluster::ClusterData));
+	m_LightIndexBuffer->Update(lightIndices.data(), lightIndices.size() * sizeof(UINT));
+
+	// the forward pass reads the same lights and clusters
+	m_LightsRendered = true;
+
+	m_Backend->RecordLightPass(m_ImmediateCommandList, GetLighting(), m_RectMesh);
+}
+
+void RenderList::BuildHiZ() const
+{
+	CPU_ZONE("Build Hi-Z");
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+
+	// the pyramid is only read by the culling of the next frame (no GPU culling when headless)
+	if (!render.GPUCullingIsEnabled())
+		return;
 
-	// setup rendering pipeline for lights
-	m_ImmediateCommandList->SetGraphicsRootSignature(rootSignature->GetRootSignature());
-	m_ImmediateCommandList->SetPipelineState(pipelineState->GetPipelineState());
+	if (m_ImmediateCommandList == nullptr)
+	{
+		PRINT_DEBUG("[RenderList] call BuildHiZ before a setup call");
+		DEBUG_BREAK;
+		return;
+	}
 
-	DX12RenderTarget * rt[DX12RenderEngine::eRenderTargetCount]
+	DX12GPUProfiler::Scope gpuScope(m_ImmediateCommandList, "Hi-Z");
+	render.GetGPUCulling()->BuildHiZ(m_ImmediateCommandList, m_View * m_Projection);
+}
+
+void RenderList::RenderTransparent() const
+{
+	CPU_ZONE("Render Transparent");
+
+	if (!m_IsSetup)
 	{
-		render.GetRenderTarget(DX12RenderEngine::eNormal),
-		render.GetRenderTarget(DX12RenderEngine::eDiffuse),
-		render.GetRenderTarget(DX12RenderEngine::eSpecular),
-		render.GetRenderTarget(DX12RenderEngine::ePosition)
-	};
+		PRINT_DEBUG("[RenderList] call RenderTransparent before a setup call");
+		DEBUG_BREAK;
+		return;
+	}
+
+	m_TransparentDrawCount = 0;
+
+	// the meshes are lit with the clustered lights of the frame (no mesh without the light pass)
+	const size_t meshCount = m_LightsRendered ? m_TransparentQueue.size() : 0;
+	const size_t emitterCount = m_ParticleComponents.size();
+	const size_t drawCount = meshCount + emitterCount;
+
+	if (drawCount == 0)
+		return;
 
-	ID3D12DescriptorHeap * descriptors = nullptr;
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+
+	// order independent : the meshes are accumulated then composited before the emitters (the particles are always sorted)
+	const bool orderIndependent = render.OITIsEnabled() && meshCount > 0;
+
+	// -- Sort -- //
+	// the draws are the meshes then the emitters : a draw index is an index in the mesh queue or the mesh count + an emitter index
+	m_TransparentDraws.resize(drawCount);
+	m_TransparentStates.clear();
 
-	for (UINT i = 0; i < DX12RenderEngine::eRenderTargetCount; ++i)
+	for (size_t i = 0; i < meshCount; ++i)
 	{
-		// bind render targets as textures
-		descriptors = rt[i]->GetShaderResourceDescriptorHeap()->GetDescriptorHeap();
-		// update the descriptor for the resources
-		m_ImmediateCommandList->SetDescriptorHeaps(1, &descriptors);
-		m_ImmediateCommandList->SetGraphicsRootDescriptorTable(i, rt[i]->GetShaderResourceDescriptorHeap()->GetGPUDescriptorHandle(render.GetFrameIndex()));
+		const DrawCommand & draw = m_TransparentQueue[i];
+		const XMFLOAT4 & sphere = draw.Mesh->GetBoundingSphere();
+		TransparentSort::Draw & transparentDraw = m_TransparentDraws[i];
+
+		XMStoreFloat3(&transparentDraw.Center, XMVector3TransformCoord(XMLoadFloat4(&sphere), GetWorldTransform(draw.Component->GetActor())));
+
+		// pipeline state of the draw : rank of its material and mesh layout in the frame
+		const std::pair<const DX12Material *, UINT64> state(draw.Parent, draw.ElementFlags);
+		const auto itr = std::find(m_TransparentStates.begin(), m_TransparentStates.end(), state);
+
+		transparentDraw.State = (UINT)(itr - m_TransparentStates.begin());
+
+		if (itr == m_TransparentStates.end())
+			m_TransparentStates.push_back(state);
+	}
+
+	for (size_t i = 0; i < emitterCount; ++i)
+	{
+		m_TransparentDraws[meshCount + i].Center = m_ParticleComponents[i]->GetOrigin();
+		m_TransparentDraws[meshCount + i].State = 0;
+	}
+
+	m_TransparentKeys.resize(drawCount);
+	m_TransparentScratch.resize(drawCount);
+
+	if (orderIndependent)
+	{
+		TransparentSort::BuildKeys(TransparentSort::eOrderIndependent, m_View, m_TransparentDraws.data(), (UINT)meshCount, m_TransparentKeys.data());
+		TransparentSort::BuildKeys(TransparentSort::eSortedBlend, m_View, m_TransparentDraws.data() + meshCount, (UINT)emitterCount, m_TransparentKeys.data() + meshCount, (UINT)meshCount);
+		TransparentSort::SortKeys(m_TransparentKeys.data(), m_TransparentScratch.data(), (UINT)meshCount);
+		TransparentSort::SortKeys(m_TransparentKeys.data() + meshCount, m_TransparentScratch.data() + meshCount, (UINT)emitterCount);
+	}
+	else
+	{
+		TransparentSort::BuildKeys(TransparentSort::eSortedBlend, m_View, m_TransparentDraws.data(), (UINT)drawCount, m_TransparentKeys.data());
+		TransparentSort::SortKeys(m_TransparentKeys.data(), m_TransparentScratch.data(), (UINT)drawCount);
 	}
 
-	// bind buffers
-	m_ImmediateCommandList->SetGraphicsRootConstantBufferView(4, render.GetConstantBuffer(DX12RenderEngine::eGlobal)->GetUploadVirtualAddress(m_LightCameraConstAddress));
-	m_ImmediateCommandList->SetGraphicsRootConstantBufferView(5, render.GetConstantBuffer(DX12RenderEngine::eLight)->GetUploadVirtualAddress(m_LightConstantAddress));
+	// -- Draws -- //
+	RenderBackend::TransparentPass pass;
+	pass.CommandList		= m_ImmediateCommandList;
+	pass.Lights				= GetLighting();
+	pass.View				= m_View;
+	pass.Projection			= m_Projection;
+	pass.Meshes				= m_TransparentQueue.data();
+	pass.Emitters			= m_ParticleComponents.data();
+	pass.Keys				= m_TransparentKeys.data();
+	pass.MeshCount			= (UINT)meshCount;
+	pass.EmitterCount		= (UINT)emitterCount;
+	pass.OrderIndependent	= orderIndependent;
 
-	// draw rect mesh
-	m_RectMesh->PushOnCommandList(m_ImmediateCommandList);
+	m_TransparentDrawCount = m_Backend->RecordTransparentPass(pass);
+}
+
+void RenderList::RenderDebugDraw() const
+{
+	CPU_ZONE("Render Debug Draw");
+
+	if (!m_IsSetup)
+	{
+		PRINT_DEBUG("[RenderList] call RenderDebugDraw before a setup call");
+		DEBUG_BREAK;
+		return;
+	}
+
+	m_DebugDrawCount = 0;
+
+	UINT instanceCount[DebugDraw::ePrimitiveCount];
+	bool empty = true;
+
+	for (UINT i = 0; i < DebugDraw::ePrimitiveCount; ++i)
+	{
+		instanceCount[i] = DebugDraw::GetInstanceCount((DebugDraw::EPrimitive)i);
+		empty &= (instanceCount[i] == 0);
+	}
+
+	if (empty)
+		return;
+
+	// upload the instances of the frame
+	for (UINT i = 0; i < DebugDraw::ePrimitiveCount; ++i)
+	{
+		const DebugDraw::EPrimitive primitive = (DebugDraw::EPrimitive)i;
+
+		if (instanceCount[i] > 0)
+			m_DebugDrawBuffer[i]->Update(DebugDraw::GetInstances(primitive), instanceCount[i] * DebugDraw::GetInstanceSize(primitive));
+	}
+
+	// one instanced draw per primitive type and depth mode
+	RenderBackend::DebugPass pass;
+	pass.CommandList	= m_ImmediateCommandList;
+	pass.ViewProjection	= XMMatrixMultiply(m_View, m_Projection);
+	pass.Instances		= m_DebugDrawBuffer;
+	pass.InstanceCount	= instanceCount;
+
+	m_DebugDrawCount = m_Backend->RecordDebugPass(pass);
 }
 
 void RenderList::RenderGBuffer() const
 {
-	if (m_DeferredCommandList == nullptr)
+	CPU_ZONE("Render GBuffer");
+
+	if (!m_IsSetup)
 	{
 		PRINT_DEBUG("[RenderList] call RenderGBuffer list before a setup call");
 		DEBUG_BREAK;
@@ -227,40 +404,354 @@ void RenderList::RenderGBuffer() const
 	XMStoreFloat4x4(&constantBuffer.m_View, XMMatrixTranspose(m_View));
 	XMStoreFloat4x4(&constantBuffer.m_Projection, XMMatrixTranspose(m_Projection));
 
-	// rendering opaque geometry
-	for (size_t i = 0; i < m_RenderComponents.size(); ++i)
+	m_DrawQueue.clear();
+	m_IndirectBatches.clear();
+	m_TransparentQueue.clear();
+
+	// the semi transparent components are drawn by the forward pass (see RenderTransparent)
+	TransparentSort::Partition(m_RenderComponents, [](const RenderComponent * i_Component) { return i_Component->GetRenderPass() == RenderComponent::eSemiTransparent; },
+		m_OpaqueComponents, m_TransparentComponents);
+
+	// the GPU culling draws the GBuffer when the instances fit in its buffers (the CPU path is used otherwise)
+	DX12GPUCulling * culling = render.GetGPUCulling();
+	bool indirectDraw = render.GPUCullingIsEnabled() && m_OpaqueComponents.size() <= culling->GetMaxInstanceCount();
+
+	// update buffers and build the draw queue (main thread)
+	for (size_t i = 0; i < m_OpaqueComponents.size(); ++i)
 	{
-		// retreive component data
-		const RenderComponent * component = m_RenderComponents[i];
+		DrawCommand draw;
+
+		if (!PrepareDraw(m_OpaqueComponents[i], constantBuffer, draw))
+			continue;
+
+		// the permutation is created here : workers only read the pipeline states
+		if (!m_Backend->PreparePipelineState(draw.Material, draw.ElementFlags, indirectDraw))
+			continue;
+
+		m_DrawQueue.push_back(draw);
+	}
+
+	// the transforms of the semi transparent meshes are updated with the opaque ones
+	for (size_t i = 0; i < m_TransparentComponents.size(); ++i)
+	{
+		DrawCommand draw;
+
+		if (PrepareDraw(m_TransparentComponents[i], constantBuffer, draw))
+			m_TransparentQueue.push_back(draw);
+	}
+
+	// parameter blocks changed since the last frame
+	render.GetMaterialParameterBuffer()->Upload();
+
+	// sort draws to limit pipeline state changes in each range (the instances of a material share its pipeline state)
+	// indirect : the material instances of a mesh are in the same batch, their parameter block is in the instance record
+	std::sort(m_DrawQueue.begin(), m_DrawQueue.end(), [indirectDraw](const DrawCommand & i_A, const DrawCommand & i_B)
+	{
+		if (i_A.ElementFlags != i_B.ElementFlags)	return i_A.ElementFlags < i_B.ElementFlags;
+		if (i_A.Parent != i_B.Parent)				return i_A.Parent < i_B.Parent;
+		if (indirectDraw && i_A.Mesh != i_B.Mesh)	return i_A.Mesh < i_B.Mesh;
+		if (i_A.Material != i_B.Material)			return i_A.Material < i_B.Material;
+		return i_A.Mesh < i_B.Mesh;
+	});
 
-		// may some components are not renderable
-		if (!component->IsRenderable())	
+	// -- Culling -- //
+	// the visible instances of each batch are compacted on the deferred context (submitted before the record contexts)
+	if (indirectDraw && !PrepareIndirectDraws())
+	{
+		// too many batches : the queue is drawn by the CPU
+		m_IndirectBatches.clear();
+		indirectDraw = false;
+
+		for (size_t i = 0; i < m_DrawQueue.size(); ++i)
+		{
+			m_Backend->PreparePipelineState(m_DrawQueue[i].Parent, m_DrawQueue[i].ElementFlags, false);
+		}
+	}
+
+	if (indirectDraw)
+	{
+		DX12GPUProfiler::Scope gpuScope(m_DeferredCommandList, "Culling");
+
+		// the vertex shader reads the model matrix in the instance records
+		constantBuffer.m_Model = XMFLOAT4X4(1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+		render.GetConstantBuffer(DX12RenderEngine::eTransform)->UpdateConstantBuffer(m_IndirectTransformAddress, &constantBuffer, sizeof(TransformConstantBuffer));
+
+		culling->Cull(m_DeferredCommandList, m_View * m_Projection, (UINT)m_DrawQueue.size(), (UINT)m_IndirectBatches.size());
+	}
+
+	// -- Record -- //
+	// each worker record the depth pre pass and the GBuffer of its range
+	// the depth pre pass lists are submitted before the GBuffer lists (see DX12RenderEngine::Render)
+	// indirect : the ranges are batches, the depth pre pass is skipped (the instances are only known by the GPU)
+	const bool depthPrePass = render.DepthPrePassIsEnabled() && !indirectDraw;
+
+	if (indirectDraw)
+		CommandRecorder::Partition((UINT)m_IndirectBatches.size(), m_CommandRecorder->GetWorkerCount(), 1, m_DrawRanges);
+	else
+		CommandRecorder::Partition((UINT)m_DrawQueue.size(), m_CommandRecorder->GetWorkerCount(), MIN_RECORD_DRAW, m_DrawRanges);
+
+	// GPU timings : the passes begin on the lists of the first worker (submitted first) and the GBuffer ends on the resolve context
+	// no profiler when headless
+	DX12GPUProfiler * profiler = render.GetGPUProfiler();
+
+	if (profiler != nullptr)
+	{
+		ID3D12GraphicsCommandList * gbufferCommandList = render.GetRecordContext(DX12RenderEngine::eRecordGBuffer, 0)->GetCommandList();
+
+		if (depthPrePass)
 		{
-			// if editor : some objects are currently under edition
+			profiler->BeginScope(render.GetRecordContext(DX12RenderEngine::eRecordDepth, 0)->GetCommandList(), "Depth");
+			profiler->EndScope(gbufferCommandList);
+		}
+
+		profiler->BeginScope(gbufferCommandList, "GBuffer");
+	}
+
+	GBufferRecorder recorder(this, depthPrePass, indirectDraw);
+	m_CommandRecorder->Record(m_DrawRanges, &recorder);
+
+	if (profiler != nullptr)
+		profiler->EndScope(render.GetContext(DX12RenderEngine::eResolve)->GetCommandList());
+}
+
+bool RenderList::PrepareDraw(const RenderComponent * i_Component, TransformConstantBuffer & io_ConstantBuffer, DrawCommand & o_Draw) const
+{
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+
+	// may some components are not renderable
+	if (!i_Component->IsRenderable())
+	{
+		// if editor : some objects are currently under edition
 #ifndef WITH_EDITOR
-			PRINT_DEBUG("The component is not renderable");
-			DEBUG_BREAK;
+		PRINT_DEBUG("The component is not renderable");
+		DEBUG_BREAK;
 #endif
-			continue;
-		}
+		return false;
+	}
+
+	// get component data to prepare for rendering
+	Actor * actor			= i_Component->GetActor();
+	ADDRESS_ID cbvAddress	= i_Component->GetConstBufferAddress();
+
+	if (cbvAddress == UnavailableAdressId)
+	{
+		PRINT_DEBUG("Error : the actor %S have no CBV registered", actor->GetName().c_str());
+		return false;
+	}
+
+	// retreive the model matrix
+	XMStoreFloat4x4(&io_ConstantBuffer.m_Model, XMMatrixTranspose(GetWorldTransform(actor)));
+
+	// update the constant buffer on GPU
+	render.GetConstantBuffer(DX12RenderEngine::eTransform)->UpdateConstantBuffer(cbvAddress, &io_ConstantBuffer, sizeof(TransformConstantBuffer));
+
+	const DX12Mesh * mesh			= i_Component->GetMeshBuffer();
+	const DX12Material * material	= i_Component->GetMaterial();
+
+	if (mesh == nullptr || material == nullptr || !mesh->IsValid() || !material->IsValid())
+		return false;
+
+	// skinned meshes : the palette of the animator is evaluated for this frame (see AnimationSystem)
+	UINT firstBone = 0;
+
+	if (mesh->GetElementFlags() & DX12PipelineState::eHaveSkinning)
+	{
+		if (i_Component->GetAnimator() == nullptr || i_Component->GetAnimator()->GetFirstBone() == Animator::InvalidBone)
+			return false;
+
+		firstBone = i_Component->GetAnimator()->GetFirstBone();
+	}
+
+	o_Draw = { mesh->GetElementFlags(), material->GetParentMaterial(), material, mesh, i_Component, firstBone };
+	return true;
+}
+
+bool RenderList::PrepareIndirectDraws() const
+{
+	DX12GPUCulling * culling = DX12RenderEngine::GetInstance().GetGPUCulling();
+	GPUCulling::InstanceRecord * records = culling->GetInstanceRecords();
+	GPUCulling::DrawArguments * arguments = culling->GetArgumentTemplates();
 
-		// get component data to prepare for rendering
-		Actor * actor			= component->GetActor();
-		ADDRESS_ID cbvAddress	= component->GetConstBufferAddress();
+	// the queue is sorted : the draws of a batch are contiguous
+	for (size_t i = 0; i < m_DrawQueue.size(); ++i)
+	{
+		const DrawCommand & draw = m_DrawQueue[i];
 
-		if (cbvAddress == UnavailableAdressId)
+		if (m_IndirectBatches.empty() || m_IndirectBatches.back().ElementFlags != draw.ElementFlags
+			|| m_IndirectBatches.back().Parent != draw.Parent || m_IndirectBatches.back().Mesh != draw.Mesh)
 		{
-			PRINT_DEBUG("Error : the actor %S have no CBV registered", actor->GetName().c_str());
+			if (m_IndirectBatches.size() == culling->GetMaxBatchCount())
+				return false;
+
+			// arguments of the batch : the instance count is incremented by the culling
+			GPUCulling::DrawArguments & batch = arguments[m_IndirectBatches.size()];
+			batch.CountPerInstance	= draw.Mesh->HaveIndexBuffer() ? draw.Mesh->GetIndexCount() : draw.Mesh->GetVerticeCount();
+			batch.InstanceCount		= 0;
+			batch.StartLocation		= 0;
+			batch.BaseVertex		= 0;
+			batch.StartInstance		= 0;
+			batch.FirstInstance		= (UINT)i;
+
+			m_IndirectBatches.push_back({ draw.ElementFlags, draw.Parent, draw.Mesh, (UINT)i });
+		}
+
+		// instance record : world bounds of the mesh and parameter block of the material
+		const XMMATRIX world = GetWorldTransform(draw.Component->GetActor());
+		GPUCulling::InstanceRecord & record = records[i];
+
+		XMStoreFloat4x4(&record.World, XMMatrixTranspose(world));
+		GPUCulling::ComputeWorldBounds(world, draw.Mesh->GetBoundingSphere(), record.Center, record.Extents);
+		record.Batch			= (UINT)m_IndirectBatches.size() - 1;
+		record.MaterialBlock	= draw.Material->GetParameterBlock();
+		record.FirstBone		= draw.FirstBone;
+	}
+
+	return true;
+}
+
+RenderList::GBufferRecorder::GBufferRecorder(const RenderList * i_RenderList, bool i_DepthPrePass, bool i_IndirectDraw)
+	:m_RenderList(i_RenderList)
+	,m_DepthPrePass(i_DepthPrePass)
+	,m_IndirectDraw(i_IndirectDraw)
+{
+}
+
+void RenderList::GBufferRecorder::RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range)
+{
+	CPU_ZONE("Record Range");
+
+	RenderBackend * backend = m_RenderList->m_Backend;
+
+	if (m_IndirectDraw)
+		backend->RecordIndirectRange(i_Worker, m_RenderList->m_IndirectBatches.data() + i_Range.First, i_Range.First, i_Range.Count, m_RenderList->m_IndirectTransformAddress);
+	else
+		backend->RecordGBufferRange(i_Worker, m_RenderList->m_DrawQueue.data() + i_Range.First, i_Range.Count, m_DepthPrePass);
+}
+
+void RenderList::RenderShadows() const
+{
+	CPU_ZONE("Render Shadows");
+
+	if (!m_IsSetup)
+	{
+		PRINT_DEBUG("[RenderList] call RenderShadows before a setup call");
+		DEBUG_BREAK;
+		return;
+	}
+
+	// -- Shadow views -- //
+	PrepareLights();
+	ComputeShadowViews();
+
+	m_ShadowViewBuffer->Update(m_ShadowViews.data(), m_ShadowViews.size() * sizeof(ShadowViewData));
+	m_LightShadowBuffer->Update(m_LightShadows.data(), m_LightShadows.size() * sizeof(UINT));
+	m_ShadowsRendered = true;
+
+	// -- Shadow casters -- //
+	m_ShadowCasters.clear();
+
+	for (size_t i = 0; i < m_RenderComponents.size() && !m_ShadowViews.empty(); ++i)
+	{
+		const RenderComponent * component = m_RenderComponents[i];
+		const DX12Mesh * mesh = component->GetMeshBuffer();
+
+		// skinned meshes are not shadow casters : the depth only shaders do not skin the vertices
+		if (!component->IsRenderable() || !mesh->IsValid() || (mesh->GetElementFlags() & DX12PipelineState::eHaveSkinning))
 			continue;
+
+		const XMMATRIX world = GetWorldTransform(component->GetActor());
+
+		// world bounding sphere (the radius is scaled by the biggest axis scale)
+		const XMFLOAT4 & localSphere = mesh->GetBoundingSphere();
+		const XMVECTOR scale = XMVectorMax(XMVector3LengthSq(world.r[0]), XMVectorMax(XMVector3LengthSq(world.r[1]), XMVector3LengthSq(world.r[2])));
+		const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat4(&localSphere), world);
+
+		ShadowCaster caster;
+		XMStoreFloat4x4(&caster.World, XMMatrixTranspose(world));
+		XMStoreFloat4(&caster.Sphere, XMVectorSetW(center, localSphere.w * XMVectorGetX(XMVectorSqrt(scale))));
+		caster.Mesh			= mesh;
+		caster.ElementFlags	= mesh->GetElementFlags();
+
+		m_ShadowCasters.push_back(caster);
+	}
+
+	// -- Batches -- //
+	XMFLOAT4X4 * instances = reinterpret_cast<XMFLOAT4X4*>(m_ShadowInstanceBuffer->GetCPUAddress());
+	UINT instanceCount = 0;
+
+	m_ShadowPassViews.clear();
+	m_ShadowBatches.clear();
+
+	for (size_t view = 0; view < m_ShadowViews.size(); ++view)
+	{
+		// cull casters for this view
+		const XMMATRIX viewProj = XMMatrixTranspose(XMLoadFloat4x4(&m_ShadowViewProj[view]));
+		XMVECTOR planes[6];
+		ShadowCascade::ExtractFrustumPlanes(viewProj, planes);
+
+		m_ShadowInstances.clear();
+
+		for (UINT i = 0; i < (UINT)m_ShadowCasters.size(); ++i)
+		{
+			const ShadowCaster & caster = m_ShadowCasters[i];
+
+			if (ShadowCascade::SphereInFrustum(planes, XMLoadFloat4(&caster.Sphere)))
+			{
+				m_ShadowInstances.push_back({ caster.ElementFlags, caster.Mesh, i });
+			}
 		}
 
-		// retreive the model matrix
-		XMStoreFloat4x4(&constantBuffer.m_Model, XMMatrixTranspose(actor->GetWorldTransform()));
+		if (m_ShadowInstances.empty())
+			continue;
+
+		// sort casters per pipeline state and mesh : one instanced draw for each mesh
+		std::sort(m_ShadowInstances.begin(), m_ShadowInstances.end(), [](const ShadowInstance & i_A, const ShadowInstance & i_B)
+		{
+			if (i_A.ElementFlags != i_B.ElementFlags)	return i_A.ElementFlags < i_B.ElementFlags;
+			return i_A.Mesh < i_B.Mesh;
+		});
+
+		// setup the view
+		const ShadowAtlas::Tile & tile = m_ShadowTiles[view];
+		RenderBackend::ShadowView shadowView;
+		shadowView.ViewProjection	= m_ShadowViewProj[view];
+		shadowView.X				= tile.X;
+		shadowView.Y				= tile.Y;
+		shadowView.Size				= tile.Size;
+		shadowView.FirstBatch		= (UINT)m_ShadowBatches.size();
 
-		// update the constant buffer on GPU
-		render.GetConstantBuffer(DX12RenderEngine::eTransform)->UpdateConstantBuffer(cbvAddress, &constantBuffer, sizeof(TransformConstantBuffer));
-		component->PushOnCommandList(m_DeferredCommandList);
+		// build batches
+		size_t first = 0;
+		while (first < m_ShadowInstances.size() && instanceCount < MAX_SHADOW_INSTANCE)
+		{
+			const ShadowInstance & batch = m_ShadowInstances[first];
+			const UINT batchOffset = instanceCount;
+			size_t last = first;
+
+			while (last < m_ShadowInstances.size() && instanceCount < MAX_SHADOW_INSTANCE
+				&& m_ShadowInstances[last].Mesh == batch.Mesh && m_ShadowInstances[last].ElementFlags == batch.ElementFlags)
+			{
+				instances[instanceCount++] = m_ShadowCasters[m_ShadowInstances[last].Caster].World;
+				++last;
+			}
+
+			m_ShadowBatches.push_back({ batch.ElementFlags, batch.Mesh, batchOffset, (UINT)(last - first) });
+			first = last;
+		}
+
+		shadowView.BatchCount = (UINT)m_ShadowBatches.size() - shadowView.FirstBatch;
+		m_ShadowPassViews.push_back(shadowView);
 	}
+
+	// -- Render -- //
+	RenderBackend::ShadowPass pass;
+	pass.CommandList	= m_DeferredCommandList;
+	pass.Instances		= m_ShadowInstanceBuffer;
+	pass.Views			= m_ShadowPassViews.data();
+	pass.ViewCount		= (UINT)m_ShadowPassViews.size();
+	pass.Batches		= m_ShadowBatches.data();
+
+	m_ShadowDrawCount = m_Backend->RecordShadowPass(pass);
 }
 
 void RenderList::PushRenderComponent(const RenderComponent * i_RenderComponent)
@@ -279,7 +770,7 @@ void RenderList::PushRenderComponent(const RenderComponent * i_RenderComponent)
 void RenderList::PushLightComponent(const LightComponent * i_LightComponent)
 {
 	// max lights
-	if (m_LightComponents.size() > m_MaxLight)		return;
+	if (m_LightComponents.size() >= m_MaxLight)		return;
 
 	if (!i_LightComponent->IsValid())
 	{
@@ -292,13 +783,349 @@ void RenderList::PushLightComponent(const LightComponent * i_LightComponent)
 	m_LightComponents.push_back(i_LightComponent);
 }
 
+void RenderList::PushParticleComponent(ParticleComponent * i_ParticleComponent)
+{
+	if (!i_ParticleComponent->IsValid())
+	{
+		PRINT_DEBUG("Error : particle component unavailable");
+		DEBUG_BREAK;
+		return;
+	}
+
+	m_ParticleComponents.push_back(i_ParticleComponent);
+}
+
+void RenderList::BeginSubmit(UINT i_WorkerCount)
+{
+	m_SubmitRenderComponents.Reset(i_WorkerCount);
+	m_SubmitLightComponents.Reset(i_WorkerCount);
+	m_SubmitParticleComponents.Reset(i_WorkerCount);
+}
+
+void RenderList::PushRenderComponent(UINT i_Worker, const RenderComponent * i_RenderComponent)
+{
+	// the component is not valid
+	if (!i_RenderComponent->IsValid())
+	{
+		PRINT_DEBUG("Error : component is not valid");
+		DEBUG_BREAK;
+		return;
+	}
+
+	m_SubmitRenderComponents.Push(i_Worker, i_RenderComponent);
+}
+
+void RenderList::PushLightComponent(UINT i_Worker, const LightComponent * i_LightComponent)
+{
+	// max lights : the lights of the next workers are dropped by the merge
+	if (m_SubmitLightComponents.GetCount(i_Worker) >= m_MaxLight)		return;
+
+	if (!i_LightComponent->IsValid())
+	{
+		PRINT_DEBUG("Error : light component unavailable");
+		DEBUG_BREAK;
+		return;
+	}
+
+	m_SubmitLightComponents.Push(i_Worker, i_LightComponent);
+}
+
+void RenderList::PushParticleComponent(UINT i_Worker, ParticleComponent * i_ParticleComponent)
+{
+	if (!i_ParticleComponent->IsValid())
+	{
+		PRINT_DEBUG("Error : particle component unavailable");
+		DEBUG_BREAK;
+		return;
+	}
+
+	m_SubmitParticleComponents.Push(i_Worker, i_ParticleComponent);
+}
+
+void RenderList::EndSubmit()
+{
+	// a few lights : merged on the calling thread
+	m_SubmitLightComponents.Merge(m_LightComponents, m_MaxLight);
+	m_SubmitParticleComponents.Merge(m_ParticleComponents);
+
+	// each worker copies its components (the workers are idle until the GBuffer recording)
+	if (m_SubmitRenderComponents.GetCount() < MIN_SUBMIT_MERGE || m_CommandRecorder->GetWorkerCount() != m_SubmitRenderComponents.GetWorkerCount())
+		m_SubmitRenderComponents.Merge(m_RenderComponents);
+	else
+		m_SubmitRenderComponents.Merge(m_CommandRecorder, m_RenderComponents);
+}
+
+CommandRecorder * RenderList::GetCommandRecorder() const
+{
+	return m_CommandRecorder;
+}
+
+const std::vector<ParticleComponent *> & RenderList::GetParticleComponents() const
+{
+	return m_ParticleComponents;
+}
+
+UINT64 RenderList::GetLightUploadSize() const
+{
+	return m_LightUploadSize;
+}
+
+UINT RenderList::GetShadowViewCount() const
+{
+	return (UINT)m_ShadowViews.size();
+}
+
+UINT RenderList::GetShadowDrawCount() const
+{
+	return m_ShadowDrawCount;
+}
+
+UINT RenderList::GetDebugDrawCount() const
+{
+	return m_DebugDrawCount;
+}
+
+UINT RenderList::GetIndirectBatchCount() const
+{
+	return (UINT)m_IndirectBatches.size();
+}
+
+UINT RenderList::GetTransparentDrawCount() const
+{
+	return m_TransparentDrawCount;
+}
+
+UINT RenderList::GetRecordWorkerUsed() const
+{
+	UINT workerUsed = 0;
+
+	for (size_t i = 0; i < m_DrawRanges.size(); ++i)
+	{
+		if (m_DrawRanges[i].Count > 0)
+			++workerUsed;
+	}
+
+	return workerUsed;
+}
+
 void RenderList::Reset()
 {
 	// reset variable, and allow to resetup and call the render list
 	m_DeferredCommandList	= nullptr;
 	m_ImmediateCommandList	= nullptr;
+	m_IsSetup				= false;
+	m_LightsPrepared		= false;
+	m_LightsRendered		= false;
+	m_ShadowsRendered		= false;
 
 	// clear list of components
 	m_RenderComponents.clear();
 	m_LightComponents.clear();
-}
\ No newline at end of file
+	m_ParticleComponents.clear();
+}
+
+RenderBackend::Lighting RenderList::GetLighting() const
+{
+	RenderBackend::Lighting lighting;
+	lighting.SceneData			= m_LightCameraConstAddress;
+	lighting.PointLights		= m_LightBuffer[Light::ePointLight];
+	lighting.SpotLights			= m_LightBuffer[Light::eSpotLight];
+	lighting.DirectionalLights	= m_LightBuffer[Light::eDirectionalLight];
+	lighting.Clusters			= m_ClusterBuffer;
+	lighting.LightIndices		= m_LightIndexBuffer;
+	lighting.ShadowViews		= m_ShadowViewBuffer;
+	lighting.LightShadows		= m_LightShadowBuffer;
+
+	return lighting;
+}
+
+XMMATRIX RenderList::GetWorldTransform(Actor * i_Actor) const
+{
+	// the current transform is cached by the actor
+	if (m_InterpolationAlpha >= 1.f)
+		return i_Actor->GetWorldTransform();
+
+	return i_Actor->GetInterpolatedWorldTransform(m_InterpolationAlpha);
+}
+
+void RenderList::PrepareLights() const
+{
+	if (m_LightsPrepared)
+		return;
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+
+	// sort lights per type and update their transform
+	for (UINT i = 0; i < Light::eLightTypeCount; ++i)
+	{
+		m_Lights[i].clear();
+	}
+
+	for (size_t i = 0; i < m_LightComponents.size(); ++i)
+	{
+		const LightComponent * lightComponent = m_LightComponents[i];
+		Light * light				= lightComponent->GetLight();
+		Actor * actor				= lightComponent->GetActor();
+
+		if (light->GetType() >= Light::eLightTypeCount)
+		{
+			ASSERT_ERROR("Error on light type");
+			continue;
+		}
+
+		XMFLOAT4X4 worldTransform;
+		XMStoreFloat4x4(&worldTransform, GetWorldTransform(actor));
+		light->SetWorldTransform(worldTransform);	// light data is recomputed only if the light moved
+
+		m_Lights[light->GetType()].push_back(light);
+	}
+
+	// upload light data : only lights that changed since the last use of the buffer
+	const UINT frameIndex = (UINT)render.GetFrameIndex();
+	m_LightUploadSize = 0;
+	m_LightBounds.clear();
+
+	for (UINT type = 0; type < Light::eLightTypeCount; ++type)
+	{
+		const std::vector<Light *> & lights = m_Lights[type];
+		std::vector<const Light *> & slots = m_LightSlots[frameIndex * Light::eLightTypeCount + type];
+		const size_t dataSize = Light::GetLightDataSize((Light::ELightType)type);
+		UINT8 * lightBuffer = m_LightBuffer[type]->GetCPUAddress();
+
+		if (slots.size() < lights.size())
+			slots.resize(lights.size(), nullptr);
+
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			Light * light = lights[i];
+
+			if (slots[i] != light || light->IsDirty(frameIndex))
+			{
+				memcpy(lightBuffer + i * dataSize, light->GetLightData(), dataSize);
+				m_LightUploadSize += dataSize;
+				slots[i] = light;
+				light->ClearDirty(frameIndex);
+			}
+
+			// compute the view space bound of the light for clusters assignment
+			LightCluster::LightBound bound;
+			XMStoreFloat3(&bound.Position, XMVector3TransformCoord(XMLoadFloat3(&light->GetPosition()), m_View));
+			XMStoreFloat3(&bound.Direction, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&light->GetDirection()), m_View)));
+			bound.Type		= type;
+			bound.Range		= (type != Light::eDirectionalLight) ? light->GetRange() : 0.f;
+			bound.CosAngle	= (type == Light::eSpotLight) ? light->GetSpotAngle() : 0.f;
+
+			m_LightBounds.push_back(bound);
+		}
+	}
+
+	m_LightsPrepared = true;
+}
+
+void RenderList::ComputeShadowViews() const
+{
+	m_ShadowAtlas->Reset();
+	m_ShadowViews.clear();
+	m_ShadowViewProj.clear();
+	m_ShadowTiles.clear();
+	m_LightShadows.assign(m_LightBounds.size(), NO_SHADOW);
+
+	// camera data for cascades
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, m_Projection);
+
+	const float cameraNear	= -projection._43 / projection._33;
+	const float cameraFar	= projection._43 / (1.f - projection._33);
+	const float shadowFar	= (m_ShadowDistance < cameraFar) ? m_ShadowDistance : cameraFar;
+	const XMMATRIX invView	= XMMatrixInverse(nullptr, m_View);
+
+	float splits[SHADOW_CASCADE_COUNT + 1];
+	ShadowCascade::ComputeSplits(cameraNear, shadowFar, SHADOW_CASCADE_COUNT, 0.8f, splits);
+
+	// light index is points, then spots, then directionals (see PrepareLights)
+	const UINT spotOffset			= (UINT)m_Lights[Light::ePointLight].size();
+	const UINT directionalOffset	= spotOffset + (UINT)m_Lights[Light::eSpotLight].size();
+
+	// directional lights first : they need the biggest tiles
+	const std::vector<Light *> & directionals = m_Lights[Light::eDirectionalLight];
+
+	for (size_t i = 0; i < directionals.size(); ++i)
+	{
+		const Light * light = directionals[i];
+
+		if (!light->IsCastingShadows() || m_ShadowViews.size() + SHADOW_CASCADE_COUNT > MAX_SHADOW_VIEW)
+			continue;
+
+		ShadowAtlas::Tile tiles[SHADOW_CASCADE_COUNT];
+		UINT allocated = 0;
+
+		while (allocated < SHADOW_CASCADE_COUNT && m_ShadowAtlas->Allocate(1024, tiles[allocated]))
+		{
+			++allocated;
+		}
+
+		// not enough space in the atlas
+		if (allocated != SHADOW_CASCADE_COUNT)
+		{
+			for (UINT c = 0; c < allocated; ++c)
+			{
+				m_ShadowAtlas->Free(tiles[c]);
+			}
+
+			continue;
+		}
+
+		m_LightShadows[directionalOffset + i] = (UINT)m_ShadowViews.size();
+
+		const XMVECTOR direction = XMLoadFloat3(&light->GetDirection());
+
+		for (UINT c = 0; c < SHADOW_CASCADE_COUNT; ++c)
+		{
+			XMVECTOR corners[8];
+			ShadowCascade::ComputeFrustumCorners(invView, projection._11, projection._22, splits[c], splits[c + 1], corners);
+
+			const XMMATRIX viewProj = ShadowCascade::ComputeCascadeMatrix(corners, direction, tiles[c].Size, m_ShadowDistance);
+			PushShadowView(viewProj, tiles[c], splits[c + 1], 0.0005f);
+		}
+	}
+
+	// spot lights
+	const std::vector<Light *> & spots = m_Lights[Light::eSpotLight];
+
+	for (size_t i = 0; i < spots.size(); ++i)
+	{
+		const Light * light = spots[i];
+		ShadowAtlas::Tile tile;
+
+		if (!light->IsCastingShadows() || m_ShadowViews.size() >= MAX_SHADOW_VIEW || !m_ShadowAtlas->Allocate(512, tile))
+			continue;
+
+		m_LightShadows[spotOffset + i] = (UINT)m_ShadowViews.size();
+
+		const XMMATRIX viewProj = ShadowCascade::ComputeSpotMatrix(
+			XMLoadFloat3(&light->GetPosition()),
+			XMLoadFloat3(&light->GetDirection()),
+			light->GetSpotAngle(),
+			light->GetRange());
+
+		PushShadowView(viewProj, tile, 0.f, 0.00005f);
+	}
+}
+
+void RenderList::PushShadowView(const XMMATRIX & i_ViewProjection, const ShadowAtlas::Tile & i_Tile, float i_SplitDepth, float i_Bias) const
+{
+	ShadowViewData data;
+	const XMMATRIX shadowMatrix = XMMatrixMultiply(i_ViewProjection, ShadowCascade::ComputeAtlasMatrix(i_Tile, m_ShadowAtlas->GetSize()));
+
+	XMStoreFloat4x4(&data.ShadowMatrix, XMMatrixTranspose(shadowMatrix));
+	data.SplitDepth	= i_SplitDepth;
+	data.Bias		= i_Bias;
+	data.Padding[0]	= data.Padding[1] = 0.f;
+
+	XMFLOAT4X4 viewProj;
+	XMStoreFloat4x4(&viewProj, XMMatrixTranspose(i_ViewProjection));
+
+	m_ShadowViews.push_back(data);
+	m_ShadowViewProj.push_back(viewProj);
+	m_ShadowTiles.push_back(i_Tile);
+}
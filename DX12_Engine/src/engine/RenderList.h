@@ -8,17 +8,30 @@
 #include "dx12/d3dx12.h"
 #include "dx12/DX12Utils.h"
 #include "engine/Light.h"
+#include "engine/LightCluster.h"
+#include "engine/ShadowAtlas.h"
+#include "engine/ShadowCascade.h"
+#include "engine/CommandRecorder.h"
+#include "engine/ParallelAppend.h"
+#include "engine/DebugDraw.h"
+#include "engine/TransparentSort.h"
+#include "engine/RenderBackend.h"
 #include <DirectXMath.h>
 #include <vector>
 
 using namespace DirectX;
 
+#define			MIN_RECORD_DRAW			32		// draws recorded by a worker before using another worker
+#define			MIN_SUBMIT_MERGE		4096	// render components merged on the calling thread under this count
+
 // class predef
 class RenderComponent;	// this is the basis component to render objects
 class LightComponent;
+class ParticleComponent;
 class Actor;
 class DX12Material;
 class DX12Mesh;
+class DX12UploadBuffer;
 
 class RenderList
 {
@@ -29,6 +42,7 @@ public:
 		XMMATRIX		ViewMatrix;
 		XMMATRIX		ProjectionMatrix;
 		XMFLOAT3		CameraPosition;
+		float			InterpolationAlpha = 1.f;	// fixed timestep : world matrices between the previous and the current step (1 : current)
 		// dx12
 		ID3D12GraphicsCommandList *		DeferredCommandList = nullptr;	// command list to render
 		ID3D12GraphicsCommandList *		ImmediateCommandList = nullptr;	// command list to render
@@ -54,86 +68,161 @@ public:
 	void	SetupRenderList(const RenderListSetup & i_Setup);
 	size_t	RenderComponentCount() const;
 	void	RenderGBuffer() const;	// render meshes, opaque geometry
+	void	RenderShadows() const;	// render shadow casters in the shadow atlas (deferred context, after the GBuffer)
 	void	RenderLight() const;	// render lights and immediate pass
+	void	RenderTransparent() const;	// render the semi transparent pass : meshes and particles back to front or order independent (immediate context, after the lights)
+	void	RenderDebugDraw() const;	// render the debug primitives on the back buffer (immediate context, after the transparent pass)
+	void	BuildHiZ() const;			// build the Hi-Z pyramid of the GPU culling from the depth buffer (immediate context, after the GBuffer)
 	void	Reset();	// reset render list var
 
 	// add rendering objects
 	void	PushRenderComponent(const RenderComponent * i_Component);
 	void	PushLightComponent(const LightComponent * i_Component);
+	void	PushParticleComponent(ParticleComponent * i_Component);	// simulated during the frame (see ParticleSystem)
+
+	// parallel submission : each worker pushes the components of its actors in its own buffers (see World::RenderWorld)
+	// the buffers are merged in worker order by EndSubmit : the components are in the order of a serial submission
+	void	BeginSubmit(UINT i_WorkerCount);
+	void	PushRenderComponent(UINT i_Worker, const RenderComponent * i_Component);
+	void	PushLightComponent(UINT i_Worker, const LightComponent * i_Component);
+	void	PushParticleComponent(UINT i_Worker, ParticleComponent * i_Component);
+	void	EndSubmit();
+	CommandRecorder *	GetCommandRecorder() const;	// workers of the submission and of the GBuffer recording
+	const std::vector<ParticleComponent *> &	GetParticleComponents() const;
+
+	// information
+	UINT64	GetLightUploadSize() const;	// bytes of light data uploaded for the last frame
+	UINT	GetShadowViewCount() const;		// shadow views rendered the last frame
+	UINT	GetShadowDrawCount() const;		// instanced draw calls of the shadow pass the last frame
+	UINT	GetRecordWorkerUsed() const;	// workers that recorded GBuffer draws the last frame
+	UINT	GetDebugDrawCount() const;		// instanced draw calls of the debug draw pass the last frame
+	UINT	GetIndirectBatchCount() const;	// indirect draws of the GBuffer the last frame (0 : the GBuffer is drawn by the CPU)
+	UINT	GetTransparentDrawCount() const;	// draw calls of the semi transparent pass the last frame
 
 private:
+	// backend : records the passes (command lists or draw streams)
+	RenderBackend *								m_Backend;
+	bool										m_IsSetup;	// setup called since the last reset
+
 	// components to render
 	std::vector<const RenderComponent *>		m_RenderComponents;
+	mutable std::vector<const RenderComponent *>	m_OpaqueComponents;			// GBuffer (partitioned by render pass each frame)
+	mutable std::vector<const RenderComponent *>	m_TransparentComponents;	// forward pass
 	std::vector<const LightComponent *>			m_LightComponents;
+	ParallelAppend<const RenderComponent *>		m_SubmitRenderComponents;	// append buffers of the workers of the submission
+	ParallelAppend<const LightComponent *>		m_SubmitLightComponents;
+	std::vector<ParticleComponent *>			m_ParticleComponents;		// emitters of the semi transparent pass
+	ParallelAppend<ParticleComponent *>			m_SubmitParticleComponents;
 
 	// light management
-	__declspec(align(16)) struct LightData
+	// lights are sorted per type : the light index used by clusters is points, then spots, then directionals
+	const size_t									m_MaxLight;
+	mutable std::vector<Light *>					m_Lights[Light::eLightTypeCount];	// lights of the frame per type
+	mutable std::vector<std::vector<const Light *>>	m_LightSlots;		// light uploaded in each slot of the buffers [frame index][light type]
+	mutable UINT64									m_LightUploadSize;	// bytes of light data uploaded for the last frame
+
+	// clustered lighting
+	LightCluster *								m_LightCluster;		// assign lights to view clusters
+	mutable std::vector<LightCluster::LightBound>	m_LightBounds;	// view space bounds of the lights (rebuilt each frame)
+	DX12UploadBuffer *							m_LightBuffer[Light::eLightTypeCount];	// packed lights data per type (t5 to t7)
+	DX12UploadBuffer *							m_ClusterBuffer;	// offset and light count for each clusters (t8)
+	DX12UploadBuffer *							m_LightIndexBuffer;	// light index list (t9)
+
+	// shadows
+	// GPU data of a shadow view (must match DeferredLightPS.hlsl)
+	struct ShadowViewData
 	{
-		DirectX::XMFLOAT4		Padding[8];	// padding (matrix4 size for each lights data)
+		XMFLOAT4X4		ShadowMatrix;	// world to atlas texture coordinates and depth
+		float			SplitDepth;		// far view depth of the cascade (directional lights only)
+		float			Bias;
+		float			Padding[2];
 	};
 
-	__declspec(align(16)) struct PointLightData
+	// shadow caster of the frame
+	struct ShadowCaster
 	{
-		// ---
-		int						Type;
-		DirectX::XMFLOAT3		Position;
-		// ---
-		DirectX::XMFLOAT4		Color;
-		// ---
-		float					Constant;
-		float					Linear;
-		float					Quadratic;
-		float					Range;
-		// ---
-		float					Padding[20];	// padding
+		XMFLOAT4X4			World;		// transposed world matrix (copied in the instance buffer)
+		XMFLOAT4			Sphere;		// world bounding sphere
+		const DX12Mesh *	Mesh;
+		UINT64				ElementFlags;
 	};
 
-	__declspec(align(16)) struct SpotLightData
+	// visible caster sorted by pipeline state and mesh for batching
+	struct ShadowInstance
 	{
-		// ---
-		int						Type;
-		DirectX::XMFLOAT3		Position;
-		// ---
-		DirectX::XMFLOAT4		Color;
-		// ---
-		float					Constant;
-		float					Linear;
-		float					Quadratic;
-		float					Range;
-		// ---
-		DirectX::XMFLOAT3		Direction;
-		float					SpotAngle;
-		// ---
-		float					OuterCutoff;
-		// ---
-		float					Padding[15];	// padding
+		UINT64				ElementFlags;
+		const DX12Mesh *	Mesh;
+		UINT				Caster;
 	};
 
-	__declspec(align(16)) struct DirectionnalLightData
+	const float										m_ShadowDistance;	// directional shadows are computed until this view depth
+	ShadowAtlas *									m_ShadowAtlas;
+	mutable std::vector<ShadowViewData>				m_ShadowViews;		// views of the frame (t11)
+	mutable std::vector<XMFLOAT4X4>					m_ShadowViewProj;	// view projection of each views (for rendering)
+	mutable std::vector<ShadowAtlas::Tile>			m_ShadowTiles;		// atlas tile of each views
+	mutable std::vector<UINT>						m_LightShadows;		// first shadow view of each lights (t12)
+	mutable std::vector<ShadowCaster>				m_ShadowCasters;
+	mutable std::vector<ShadowInstance>				m_ShadowInstances;
+	mutable std::vector<RenderBackend::ShadowView>	m_ShadowPassViews;	// views with casters
+	mutable std::vector<RenderBackend::ShadowBatch>	m_ShadowBatches;
+	DX12UploadBuffer *								m_ShadowViewBuffer;
+	DX12UploadBuffer *								m_LightShadowBuffer;
+	DX12UploadBuffer *								m_ShadowInstanceBuffer;	// transforms of the shadow casters instances
+	mutable UINT									m_ShadowDrawCount;
+	mutable bool									m_LightsPrepared;	// lights are prepared once per frame
+	mutable bool									m_LightsRendered;	// clustered lights uploaded this frame (read by the forward pass)
+	mutable bool									m_ShadowsRendered;
+
+	// GBuffer recording
+	// draws are sorted per input layout, material and mesh then recorded in parallel (one range per worker)
+	typedef RenderBackend::MeshDraw			DrawCommand;
+	typedef RenderBackend::IndirectBatch	IndirectBatch;
+
+	// record the depth pre pass and the GBuffer of a range with the backend
+	// indirect : the range is a range of batches and there is no depth pre pass
+	class GBufferRecorder : public CommandRecorder::Recorder
 	{
-		// ---
-		int						Type;
-		DirectX::XMFLOAT3		Position;
-		// ---
-		DirectX::XMFLOAT4		Color;
-		// ---
-		DirectX::XMFLOAT3		Direction;
-		// ---
-		float					Padding[21];	// padding
-	};
-	
-	__declspec(align(16)) struct LightDesc
-	{
-		LightData	Data[MAX_LIGHT];
+	public:
+		GBufferRecorder(const RenderList * i_RenderList, bool i_DepthPrePass, bool i_IndirectDraw);
+		virtual void	RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range) override;
+
+	private:
+		const RenderList *	m_RenderList;
+		const bool			m_DepthPrePass;
+		const bool			m_IndirectDraw;
 	};
 
-	const size_t					m_MaxLight;
-	LightDesc *						m_LightsData;
+	CommandRecorder *								m_CommandRecorder;
+	mutable std::vector<DrawCommand>				m_DrawQueue;
+	mutable std::vector<CommandRecorder::DrawRange>	m_DrawRanges;
+	mutable std::vector<IndirectBatch>				m_IndirectBatches;
+	ADDRESS_ID										m_IndirectTransformAddress;	// view and projection of the indirect draws (the model is in the instance records)
+
+	// debug draw : instances of the frame per primitive type (t0 to t2)
+	DX12UploadBuffer *								m_DebugDrawBuffer[DebugDraw::ePrimitiveCount];
+	mutable UINT									m_DebugDrawCount;
+
+	// semi transparent pass : the meshes and the emitters are sorted back to front on the depth of their center (see TransparentSort)
+	// order independent : the meshes are sorted by pipeline state and composited before the emitters
+	mutable std::vector<DrawCommand>				m_TransparentQueue;		// transforms updated with the GBuffer
+	mutable std::vector<TransparentSort::Draw>		m_TransparentDraws;
+	mutable std::vector<std::pair<const DX12Material *, UINT64>>	m_TransparentStates;	// pipeline states of the frame (material and mesh layout)
+	mutable std::vector<UINT64>						m_TransparentKeys;
+	mutable std::vector<UINT64>						m_TransparentScratch;
+	mutable UINT									m_TransparentDrawCount;
 
 	DX12Mesh *			m_RectMesh;
-	ADDRESS_ID			m_LightConstantAddress;
 	ADDRESS_ID			m_LightCameraConstAddress;
 
+	// internal helpers
+	XMMATRIX	GetWorldTransform(Actor * i_Actor) const;	// interpolated world matrix
+	bool	PrepareDraw(const RenderComponent * i_Component, TransformConstantBuffer & io_ConstantBuffer, DrawCommand & o_Draw) const;	// update the transform, false if the component can't be drawn
+	bool	PrepareIndirectDraws() const;	// build the batches and the instance records of the draw queue, false if the GPU culling can't draw them
+	void	PrepareLights() const;		// sort, upload lights data and compute lights bounds
+	RenderBackend::Lighting		GetLighting() const;	// buffers of the clustered lights
+	void	ComputeShadowViews() const;	// allocate atlas tiles and compute shadow matrices
+	void	PushShadowView(const XMMATRIX & i_ViewProjection, const ShadowAtlas::Tile & i_Tile, float i_SplitDepth, float i_Bias) const;
+
 	// to do : render objects per materials and not loop between components
 	// materials management
 	struct RenderMeshData
@@ -149,6 +238,7 @@ private:
 	XMMATRIX	m_View;
 	XMMATRIX	m_Projection;
 	XMFLOAT3	m_CameraPosition;
+	float		m_InterpolationAlpha;
 	// dx12
 	ID3D12GraphicsCommandList *	m_ImmediateCommandList;
 	ID3D12GraphicsCommandList *	m_DeferredCommandList;
@@ -0,0 +1,401 @@
+#include "SceneFile.h"
+
+#include "engine/Debug.h"
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+// the layout of the records is the file layout
+static_assert(sizeof(SceneFile::ActorRecord) == 80, "actor record layout changed : increase SCENE_FILE_MAJOR_VERSION");
+static_assert(sizeof(SceneFile::LightRecord) == 52, "light record layout changed : increase SCENE_FILE_MAJOR_VERSION");
+// records are copied (memcpy) from the file data into aligned tables : they are never read in place from an unaligned offset
+static_assert(std::is_trivially_copyable<SceneFile::ActorRecord>::value, "actor records are copied as bytes");
+static_assert(std::is_trivially_copyable<SceneFile::LightRecord>::value, "light records are copied as bytes");
+
+// table of fixed size records : count, record size then the records
+template <typename _Record>
+static void WriteRecords(std::vector<BYTE> & o_Data, const std::vector<_Record> & i_Records)
+{
+	const UINT header[2] = { (UINT)i_Records.size(), (UINT)sizeof(_Record) };
+	const BYTE * records = reinterpret_cast<const BYTE *>(i_Records.data());
+
+	o_Data.insert(o_Data.end(), reinterpret_cast<const BYTE *>(header), reinterpret_cast<const BYTE *>(header) + sizeof(header));
+	o_Data.insert(o_Data.end(), records, records + i_Records.size() * sizeof(_Record));
+}
+
+template <typename _Record>
+static bool ReadRecords(std::vector<_Record> & o_Records, const BYTE * i_Data, size_t i_Size)
+{
+	UINT header[2];
+
+	if (i_Size < sizeof(header))
+		return false;
+
+	memcpy(header, i_Data, sizeof(header));
+
+	if (header[1] != sizeof(_Record) || i_Size - sizeof(header) < (size_t)header[0] * sizeof(_Record))
+		return false;
+
+	// one allocation and one copy for the whole table
+	o_Records.resize(header[0]);
+	memcpy(o_Records.data(), i_Data + sizeof(header), (size_t)header[0] * sizeof(_Record));
+
+	return true;
+}
+
+// json strings
+static void WriteJsonString(FILE * i_File, const char * i_String)
+{
+	fputc('"', i_File);
+
+	for (const char * c = i_String; *c != '\0'; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+			fputc('\\', i_File);
+		fputc(*c, i_File);
+	}
+
+	fputc('"', i_File);
+}
+
+SceneFile::SceneFile()
+{
+}
+
+SceneFile::~SceneFile()
+{
+}
+
+void SceneFile::Clear()
+{
+	m_StringOffsets.clear();
+	m_Strings.clear();
+	m_StringIndices.clear();
+	m_Actors.clear();
+	m_Lights.clear();
+}
+
+UINT SceneFile::AddString(const std::string & i_String)
+{
+	auto itr = m_StringIndices.find(i_String);
+
+	if (itr != m_StringIndices.end())
+		return itr->second;
+
+	const UINT index = (UINT)m_StringOffsets.size();
+
+	m_StringOffsets.push_back((UINT)m_Strings.size());
+	m_Strings.insert(m_Strings.end(), i_String.c_str(), i_String.c_str() + i_String.size() + 1);
+	m_StringIndices[i_String] = index;
+
+	return index;
+}
+
+UINT SceneFile::AddActor(const ActorRecord & i_Actor)
+{
+	m_Actors.push_back(i_Actor);
+	return (UINT)m_Actors.size() - 1;
+}
+
+UINT SceneFile::AddLight(const LightRecord & i_Light)
+{
+	m_Lights.push_back(i_Light);
+	return (UINT)m_Lights.size() - 1;
+}
+
+void SceneFile::Reserve(UINT i_ActorCount, UINT i_LightCount)
+{
+	m_Actors.reserve(i_ActorCount);
+	m_Lights.reserve(i_LightCount);
+}
+
+bool SceneFile::Write(const std::string & i_Filename) const
+{
+	std::vector<BYTE> data;
+	WriteToMemory(data);
+
+	FILE * file = nullptr;
+	if (fopen_s(&file, i_Filename.c_str(), "wb") != 0 || file == nullptr)
+	{
+		PRINT_DEBUG("[SceneFile] unable to open %s", i_Filename.c_str());
+		return false;
+	}
+
+	const bool written = (fwrite(data.data(), 1, data.size(), file) == data.size());
+	fclose(file);
+
+	return written;
+}
+
+bool SceneFile::Read(const std::string & i_Filename)
+{
+	FILE * file = nullptr;
+	if (fopen_s(&file, i_Filename.c_str(), "rb") != 0 || file == nullptr)
+	{
+		PRINT_DEBUG("[SceneFile] unable to open %s", i_Filename.c_str());
+		return false;
+	}
+
+	// the file is read at once
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	std::vector<BYTE> data((size > 0) ? (size_t)size : 0);
+	const bool read = (size > 0) && (fread(data.data(), 1, data.size(), file) == data.size());
+	fclose(file);
+
+	if (!read)
+	{
+		PRINT_DEBUG("[SceneFile] unable to read %s", i_Filename.c_str());
+		return false;
+	}
+
+	return ReadFromMemory(data.data(), data.size());
+}
+
+void SceneFile::WriteToMemory(std::vector<BYTE> & o_Data) const
+{
+	o_Data.clear();
+	o_Data.reserve(sizeof(Header) + 3 * sizeof(ChunkHeader) + m_StringOffsets.size() * sizeof(UINT) + m_Strings.size()
+		+ m_Actors.size() * sizeof(ActorRecord) + m_Lights.size() * sizeof(LightRecord) + 64);
+
+	Header header;
+	header.Magic		= SCENE_FILE_MAGIC;
+	header.MajorVersion	= SCENE_FILE_MAJOR_VERSION;
+	header.MinorVersion	= SCENE_FILE_MINOR_VERSION;
+	header.ChunkCount	= 3;
+	header.ByteOrder	= SCENE_FILE_BYTE_ORDER;
+	o_Data.insert(o_Data.end(), reinterpret_cast<const BYTE *>(&header), reinterpret_cast<const BYTE *>(&header) + sizeof(Header));
+
+	// each chunk size is patched once its data is written
+	for (UINT chunk = 0; chunk < header.ChunkCount; ++chunk)
+	{
+		static const UINT chunkIds[] = { s_StringChunk, s_ActorChunk, s_LightChunk };
+
+		const size_t chunkStart = o_Data.size();
+		ChunkHeader chunkHeader = { chunkIds[chunk], 0 };
+		o_Data.insert(o_Data.end(), reinterpret_cast<const BYTE *>(&chunkHeader), reinterpret_cast<const BYTE *>(&chunkHeader) + sizeof(ChunkHeader));
+
+		switch (chunkIds[chunk])
+		{
+		case s_StringChunk:
+			WriteRecords(o_Data, m_StringOffsets);
+			o_Data.insert(o_Data.end(), reinterpret_cast<const BYTE *>(m_Strings.data()), reinterpret_cast<const BYTE *>(m_Strings.data()) + m_Strings.size());
+			break;
+		case s_ActorChunk:
+			WriteRecords(o_Data, m_Actors);
+			break;
+		case s_LightChunk:
+			WriteRecords(o_Data, m_Lights);
+			break;
+		}
+
+		chunkHeader.Size = (UINT)(o_Data.size() - chunkStart - sizeof(ChunkHeader));
+		memcpy(o_Data.data() + chunkStart, &chunkHeader, sizeof(ChunkHeader));
+	}
+}
+
+bool SceneFile::ReadFromMemory(const BYTE * i_Data, size_t i_Size)
+{
+	Clear();
+
+	Header header;
+
+	if (i_Size < sizeof(Header))
+		return false;
+
+	memcpy(&header, i_Data, sizeof(Header));
+
+	// another major version can not be read, a newer minor version only adds chunks
+	if (header.Magic != SCENE_FILE_MAGIC || header.MajorVersion != SCENE_FILE_MAJOR_VERSION)
+	{
+		PRINT_DEBUG("[SceneFile] unknown file or version (%u.%u)", header.MajorVersion, header.MinorVersion);
+		return false;
+	}
+
+	// records are read as they are in memory : the file must have the byte order of the machine
+	if (header.ByteOrder != SCENE_FILE_BYTE_ORDER && !(header.MinorVersion == 0 && header.ByteOrder == 0))
+	{
+		PRINT_DEBUG("[SceneFile] byte order of the file is not supported (0x%08X)", header.ByteOrder);
+		return false;
+	}
+
+	size_t offset = sizeof(Header);
+
+	for (UINT chunk = 0; chunk < header.ChunkCount; ++chunk)
+	{
+		ChunkHeader chunkHeader;
+
+		if (i_Size - offset < sizeof(ChunkHeader))
+			return false;
+
+		memcpy(&chunkHeader, i_Data + offset, sizeof(ChunkHeader));
+		offset += sizeof(ChunkHeader);
+
+		if (i_Size - offset < chunkHeader.Size)
+			return false;
+
+		const BYTE * data = i_Data + offset;
+		bool valid = true;
+
+		switch (chunkHeader.Id)
+		{
+		case s_StringChunk:
+			valid = ReadStrings(data, chunkHeader.Size);
+			break;
+		case s_ActorChunk:
+			valid = ReadRecords(m_Actors, data, chunkHeader.Size);
+			break;
+		case s_LightChunk:
+			valid = ReadRecords(m_Lights, data, chunkHeader.Size);
+			break;
+		default:
+			// unknown chunk : skipped
+			break;
+		}
+
+		if (!valid)
+		{
+			PRINT_DEBUG("[SceneFile] chunk %u is corrupted", chunk);
+			Clear();
+			return false;
+		}
+
+		offset += chunkHeader.Size;
+	}
+
+	if (!Validate())
+	{
+		PRINT_DEBUG("[SceneFile] invalid references in the scene");
+		Clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool SceneFile::ExportJson(const std::string & i_Filename) const
+{
+	FILE * file = nullptr;
+	if (fopen_s(&file, i_Filename.c_str(), "w") != 0 || file == nullptr)
+	{
+		PRINT_DEBUG("[SceneFile] unable to open %s", i_Filename.c_str());
+		return false;
+	}
+
+	// references are written with their strings (one line per record : stable diffs)
+	fprintf(file, "{\n\"version\": \"%u.%u\",\n\"actors\": [\n", SCENE_FILE_MAJOR_VERSION, SCENE_FILE_MINOR_VERSION);
+
+	for (size_t i = 0; i < m_Actors.size(); ++i)
+	{
+		const ActorRecord & actor = m_Actors[i];
+
+		fprintf(file, "{\"index\": %u, \"id\": %llu, \"parent\": %d, \"name\": ", (UINT)i, actor.Id, (actor.Parent == InvalidIndex) ? -1 : (int)actor.Parent);
+		WriteJsonString(file, GetString(actor.Name));
+		fprintf(file, ", \"flags\": %u, \"position\": [%g, %g, %g], \"rotation\": [%g, %g, %g], \"scale\": [%g, %g, %g]",
+			actor.Flags,
+			actor.Position[0], actor.Position[1], actor.Position[2],
+			actor.Rotation[0], actor.Rotation[1], actor.Rotation[2],
+			actor.Scale[0], actor.Scale[1], actor.Scale[2]);
+
+		if (actor.Mesh != InvalidIndex)
+		{
+			fprintf(file, ", \"mesh\": ");
+			WriteJsonString(file, GetString(actor.Mesh));
+			fprintf(file, ", \"submesh\": %u", actor.SubMesh);
+		}
+
+		if (actor.Material != InvalidIndex)
+		{
+			fprintf(file, ", \"material\": ");
+			WriteJsonString(file, GetString(actor.Material));
+			fprintf(file, ", \"submaterial\": %u", actor.SubMaterial);
+		}
+
+		if (actor.Light != InvalidIndex)
+			fprintf(file, ", \"light\": %u", actor.Light);
+
+		fprintf(file, "}%s\n", (i + 1 < m_Actors.size()) ? "," : "");
+	}
+
+	fprintf(file, "],\n\"lights\": [\n");
+
+	for (size_t i = 0; i < m_Lights.size(); ++i)
+	{
+		const LightRecord & light = m_Lights[i];
+
+		fprintf(file, "{\"index\": %u, \"type\": %u, \"color\": [%g, %g, %g, %g], \"intensity\": %g, \"range\": %g, \"constant\": %g, \"linear\": %g, \"quadratic\": %g, \"spot_angle\": %g, \"soft_edge\": %g, \"cast_shadows\": %s}%s\n",
+			(UINT)i, light.Type,
+			light.Color[0], light.Color[1], light.Color[2], light.Color[3],
+			light.Intensity, light.Range, light.Constant, light.Linear, light.Quadratic, light.SpotAngle, light.SoftEdge,
+			light.CastShadows ? "true" : "false",
+			(i + 1 < m_Lights.size()) ? "," : "");
+	}
+
+	fprintf(file, "]\n}\n");
+	fclose(file);
+
+	return true;
+}
+
+UINT SceneFile::GetStringCount() const
+{
+	return (UINT)m_StringOffsets.size();
+}
+
+const char * SceneFile::GetString(UINT i_Index) const
+{
+	return (i_Index < m_StringOffsets.size()) ? m_Strings.data() + m_StringOffsets[i_Index] : "";
+}
+
+const std::vector<SceneFile::ActorRecord> & SceneFile::GetActors() const
+{
+	return m_Actors;
+}
+
+const std::vector<SceneFile::LightRecord> & SceneFile::GetLights() const
+{
+	return m_Lights;
+}
+
+bool SceneFile::ReadStrings(const BYTE * i_Data, size_t i_Size)
+{
+	if (!ReadRecords(m_StringOffsets, i_Data, i_Size))
+		return false;
+
+	// the characters follow the offsets
+	const size_t tableSize = 2 * sizeof(UINT) + m_StringOffsets.size() * sizeof(UINT);
+	m_Strings.assign(reinterpret_cast<const char *>(i_Data + tableSize), reinterpret_cast<const char *>(i_Data + i_Size));
+
+	// every string is terminated in the buffer
+	if (!m_StringOffsets.empty() && (m_Strings.empty() || m_Strings.back() != '\0'))
+		return false;
+
+	for (size_t i = 0; i < m_StringOffsets.size(); ++i)
+	{
+		if (m_StringOffsets[i] >= m_Strings.size())
+			return false;
+	}
+
+	return true;
+}
+
+bool SceneFile::Validate() const
+{
+	const UINT stringCount = GetStringCount();
+
+	for (size_t i = 0; i < m_Actors.size(); ++i)
+	{
+		const ActorRecord & actor = m_Actors[i];
+
+		if ((actor.Parent != InvalidIndex && actor.Parent >= i)
+			|| actor.Name >= stringCount
+			|| (actor.Mesh != InvalidIndex && actor.Mesh >= stringCount)
+			|| (actor.Material != InvalidIndex && actor.Material >= stringCount)
+			|| (actor.Light != InvalidIndex && actor.Light >= m_Lights.size()))
+			return false;
+	}
+
+	return true;
+}
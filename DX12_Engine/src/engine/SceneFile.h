@@ -0,0 +1,122 @@
+// Scene file
+// compact binary format of a world : a versioned header followed by chunks (four character code, size)
+// chunks : string table (names and resource paths), actors and lights as fixed size records
+// actors are stored parents first : a load is one pass over the records, tables are read with one copy each
+// resources are referenced by their file path and the index of the buffer in the resource
+// the engine targets x86/x64 : records are little-endian as they are in memory, the header stores a byte order marker checked on load
+// versions : a new major version changes the layout of the header or of the records (older majors are rejected)
+// a new minor version only adds chunks or uses reserved header fields : unknown chunks are skipped (files of a newer minor version can be loaded)
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#define SCENE_FILE_MAGIC		0x4E435344	// "DSCN"
+#define SCENE_FILE_MAJOR_VERSION	1	// layout of the header and of the records
+#define SCENE_FILE_MINOR_VERSION	1	// chunks (readers skip the unknown ones), 1 : byte order marker
+#define SCENE_FILE_BYTE_ORDER		0x01020304	// written as a native integer (04 03 02 01 in little-endian files)
+
+class SceneFile
+{
+public:
+	static const UINT InvalidIndex = (UINT)-1;
+
+	// actor flags
+	enum EActorFlags
+	{
+		eActorNeedTick		= 1 << 0,
+		eActorHidden		= 1 << 1,
+		eActorDisabled		= 1 << 2,
+	};
+
+	// actor record (80 bytes)
+	struct ActorRecord
+	{
+		UINT64		Id;
+		UINT		Parent;			// actor index (InvalidIndex : root actor)
+		UINT		Name;			// string index (utf-8)
+		UINT		Flags;			// EActorFlags
+		UINT		Mesh;			// string index of the mesh resource (InvalidIndex : no render component)
+		UINT		SubMesh;		// mesh buffer index in the mesh resource
+		UINT		Material;		// string index of the material resource (InvalidIndex : default material)
+		UINT		SubMaterial;	// material index in the material resource
+		UINT		Light;			// light index (InvalidIndex : no light component)
+		float		Position[3];
+		float		Rotation[3];	// degrees
+		float		Scale[3];
+	};
+
+	// light record (52 bytes)
+	struct LightRecord
+	{
+		UINT		Type;			// Light::ELightType
+		float		Color[4];
+		float		Intensity;
+		float		Range;
+		float		Constant;
+		float		Linear;
+		float		Quadratic;
+		float		SpotAngle;		// cosine of the half angle (see Light::SetSpotAngle)
+		float		SoftEdge;
+		UINT		CastShadows;
+	};
+
+	SceneFile();
+	~SceneFile();
+
+	// building
+	void		Clear();
+	UINT		AddString(const std::string & i_String);	// same strings share their index
+	UINT		AddActor(const ActorRecord & i_Actor);
+	UINT		AddLight(const LightRecord & i_Light);
+	void		Reserve(UINT i_ActorCount, UINT i_LightCount);
+
+	// serialization
+	bool		Write(const std::string & i_Filename) const;
+	bool		Read(const std::string & i_Filename);
+	void		WriteToMemory(std::vector<BYTE> & o_Data) const;
+	bool		ReadFromMemory(const BYTE * i_Data, size_t i_Size);
+	bool		ExportJson(const std::string & i_Filename) const;	// human-readable (diff), not loadable
+
+	// data
+	UINT						GetStringCount() const;
+	const char *				GetString(UINT i_Index) const;	// empty string if the index is not valid
+	const std::vector<ActorRecord> &	GetActors() const;
+	const std::vector<LightRecord> &	GetLights() const;
+
+private:
+	// file layout
+	struct Header
+	{
+		UINT		Magic;
+		USHORT		MajorVersion;	// low half of the previous 32 bits version : version 1 files read as 1.0
+		USHORT		MinorVersion;
+		UINT		ChunkCount;
+		UINT		ByteOrder;		// SCENE_FILE_BYTE_ORDER (0 in 1.0 files, which are little-endian)
+	};
+
+	struct ChunkHeader
+	{
+		UINT		Id;		// four character code
+		UINT		Size;	// bytes after the header
+	};
+
+	// chunk ids
+	static const UINT	s_StringChunk	= 0x53525453;	// "STRS"
+	static const UINT	s_ActorChunk	= 0x53544341;	// "ACTS"
+	static const UINT	s_LightChunk	= 0x5354474C;	// "LGTS"
+
+	bool		ReadStrings(const BYTE * i_Data, size_t i_Size);
+	bool		Validate() const;	// indices in range and parents before children
+
+	// strings : offsets in one buffer of null terminated strings
+	std::vector<UINT>				m_StringOffsets;
+	std::vector<char>				m_Strings;
+	std::map<std::string, UINT>		m_StringIndices;	// building only
+
+	std::vector<ActorRecord>		m_Actors;
+	std::vector<LightRecord>		m_Lights;
+};
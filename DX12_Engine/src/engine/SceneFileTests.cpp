@@ -0,0 +1,173 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <stdio.h>
+#include <string.h>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/Light.h"
+#include "engine/World.h"
+#include "engine/Actor.h"
+#include "engine/SceneFile.h"
+#include "engine/TestUtils.h"
+
+CFSceneCheck::CFSceneCheck()
+	:Console::Function("scene_check", "[actor count]", "round trip and load time of a generated scene (records, versions, byte order and bulk spawn in a temporary world)")
+{
+}
+
+bool CFSceneCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT actorCount = 100000;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		actorCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	// generated hierarchy : the parent of an actor is a previous actor or none
+	SceneFile scene;
+	TestRandom random(0x6C078965);
+	UINT errors = 0;
+	Clock clock;
+
+	scene.Reserve(actorCount, actorCount / 16 + 1);
+
+	for (UINT i = 0; i < actorCount; ++i)
+	{
+		char name[32];
+		sprintf_s(name, "Actor %u", i);
+
+		const UINT seed = random.Next();
+
+		SceneFile::ActorRecord record;
+		record.Id			= i;
+		record.Parent		= (i > 0 && (seed & 3) != 0) ? (seed >> 8) % i : SceneFile::InvalidIndex;
+		record.Name			= scene.AddString(name);
+		record.Flags		= (seed >> 4) & 7;
+		record.Mesh			= SceneFile::InvalidIndex;
+		record.SubMesh		= 0;
+		record.Material		= SceneFile::InvalidIndex;
+		record.SubMaterial	= 0;
+		record.Light		= SceneFile::InvalidIndex;
+
+		for (UINT axis = 0; axis < 3; ++axis)
+		{
+			record.Position[axis]	= (float)((seed >> axis) % 1000) * 0.1f;
+			record.Rotation[axis]	= (float)((seed >> (axis + 3)) % 360);
+			record.Scale[axis]		= 1.f;
+		}
+
+		if (i % 16 == 0)
+		{
+			SceneFile::LightRecord light = { (UINT)Light::ePointLight, { 1.f, 0.5f, 0.25f, 1.f }, 1.f, 10.f, 1.f, 0.1f, 0.01f, 0.f, 0.f, 0 };
+			record.Light = scene.AddLight(light);
+		}
+
+		scene.AddActor(record);
+	}
+
+	const float buildTime = clock.Restart().ToMilliseconds();
+
+	// round trip : the records must be the same (bitwise)
+	std::vector<BYTE> data;
+	scene.WriteToMemory(data);
+	const float writeTime = clock.Restart().ToMilliseconds();
+
+	SceneFile loaded;
+	if (!loaded.ReadFromMemory(data.data(), data.size()))
+		++errors;
+	const float readTime = clock.Restart().ToMilliseconds();
+
+	if (loaded.GetActors().size() != scene.GetActors().size() || loaded.GetLights().size() != scene.GetLights().size() || loaded.GetStringCount() != scene.GetStringCount())
+		++errors;
+	else
+	{
+		if (memcmp(loaded.GetActors().data(), scene.GetActors().data(), scene.GetActors().size() * sizeof(SceneFile::ActorRecord)) != 0)
+			++errors;
+		if (memcmp(loaded.GetLights().data(), scene.GetLights().data(), scene.GetLights().size() * sizeof(SceneFile::LightRecord)) != 0)
+			++errors;
+		for (UINT i = 0; i < scene.GetStringCount(); ++i)
+		{
+			if (strcmp(loaded.GetString(i), scene.GetString(i)) != 0)
+				++errors;
+		}
+	}
+
+	// corrupted data must be refused
+	std::vector<BYTE> corrupted(data.begin(), data.begin() + data.size() / 2);
+	if (loaded.ReadFromMemory(corrupted.data(), corrupted.size()))
+		++errors;
+
+	// versions (header : magic, major, minor, chunk count) : a newer minor version with an unknown chunk is loaded, another major version is refused
+	{
+		std::vector<BYTE> newer(data);
+		const USHORT minor = SCENE_FILE_MINOR_VERSION + 1;
+		const UINT chunk[3] = { 0x54534554, sizeof(UINT), 0 };	// "TEST" chunk of 4 bytes
+		UINT chunkCount;
+
+		memcpy(newer.data() + 6, &minor, sizeof(minor));
+		memcpy(&chunkCount, newer.data() + 8, sizeof(chunkCount));
+		++chunkCount;
+		memcpy(newer.data() + 8, &chunkCount, sizeof(chunkCount));
+		newer.insert(newer.end(), reinterpret_cast<const BYTE *>(chunk), reinterpret_cast<const BYTE *>(chunk) + sizeof(chunk));
+
+		if (!loaded.ReadFromMemory(newer.data(), newer.size()) || loaded.GetActors().size() != scene.GetActors().size())
+			++errors;
+
+		std::vector<BYTE> major(data);
+		const USHORT nextMajor = SCENE_FILE_MAJOR_VERSION + 1;
+		memcpy(major.data() + 4, &nextMajor, sizeof(nextMajor));
+
+		if (loaded.ReadFromMemory(major.data(), major.size()))
+			++errors;
+
+		// byte order marker (offset 12) of a big-endian writer
+		std::vector<BYTE> swapped(data);
+		const UINT swappedOrder = _byteswap_ulong(SCENE_FILE_BYTE_ORDER);
+		memcpy(swapped.data() + 12, &swappedOrder, sizeof(swappedOrder));
+
+		if (loaded.ReadFromMemory(swapped.data(), swapped.size()))
+			++errors;
+	}
+
+	GetConsole()->Print("scene check : %u actors, %u KB, build %.2f ms, write %.2f ms, read %.2f ms", actorCount, (UINT)(data.size() / 1024), buildTime, writeTime, readTime);
+
+	// spawn in a temporary world : actors and light components (no gpu resources)
+	{
+		World::WorldDesc worldDesc;
+		World world(worldDesc);
+
+		const UINT actorBlockCount = Actor::GetPool().GetBlockCount();
+		const UINT lightBlockCount = LightComponent::GetPool().GetBlockCount();
+
+		clock.Restart();
+		world.LoadScene(scene);
+		const float spawnTime = clock.Restart().ToMilliseconds();
+
+		// actors and lights are allocated in bulk : at most one new block per pool
+		if (Actor::GetPool().GetBlockCount() > actorBlockCount + 1 || LightComponent::GetPool().GetBlockCount() > lightBlockCount + 1)
+			++errors;
+
+		SceneFile rebuilt;
+		world.BuildScene(rebuilt);
+		const float saveTime = clock.Restart().ToMilliseconds();
+
+		// the rebuilt scene is ordered depth first : only the counts are compared
+		if (world.GetActorCount() != actorCount || rebuilt.GetActors().size() != actorCount || rebuilt.GetLights().size() != scene.GetLights().size())
+			++errors;
+
+		world.Clear();
+
+		GetConsole()->Print("scene check : spawn %.2f ms, build from the world %.2f ms", spawnTime, saveTime);
+	}
+
+	GetConsole()->Print("scene check : %u errors", errors);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
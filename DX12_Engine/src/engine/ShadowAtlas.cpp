@@ -0,0 +1,155 @@
+#include "ShadowAtlas.h"
+
+#include "engine/Debug.h"
+
+ShadowAtlas::ShadowAtlas(UINT i_Size, UINT i_MinTileSize)
+	:m_Size(i_Size)
+	,m_MinTileSize(i_MinTileSize)
+	,m_LevelCount(0)
+	,m_AllocatedArea(0)
+{
+	// sizes must be power of two
+	ASSERT(i_Size != 0 && (i_Size & (i_Size - 1)) == 0);
+	ASSERT(i_MinTileSize != 0 && (i_MinTileSize & (i_MinTileSize - 1)) == 0);
+	ASSERT(i_MinTileSize <= i_Size);
+
+	for (UINT size = m_Size; size >= m_MinTileSize; size >>= 1)
+	{
+		++m_LevelCount;
+	}
+
+	m_FreeTiles.resize(m_LevelCount);
+	Reset();
+}
+
+ShadowAtlas::~ShadowAtlas()
+{
+}
+
+bool ShadowAtlas::Allocate(UINT i_Size, Tile & o_Tile)
+{
+	if (i_Size == 0 || i_Size > m_Size)
+		return false;
+
+	const UINT level = GetLevel(i_Size);
+
+	// find the smallest free tile that can contain the requested size
+	int freeLevel = (int)level;
+	while (freeLevel >= 0 && m_FreeTiles[freeLevel].empty())
+	{
+		--freeLevel;
+	}
+
+	// atlas is full
+	if (freeLevel < 0)
+		return false;
+
+	Tile tile = m_FreeTiles[freeLevel].back();
+	m_FreeTiles[freeLevel].pop_back();
+
+	// split the tile until we reach the needed size (the first quarter is kept)
+	for (UINT l = (UINT)freeLevel + 1; l <= level; ++l)
+	{
+		const UINT size = GetTileSize(l);
+
+		// push in reverse order : the next allocation will take the top left tile
+		m_FreeTiles[l].push_back({ tile.X + size, tile.Y + size, size });
+		m_FreeTiles[l].push_back({ tile.X, tile.Y + size, size });
+		m_FreeTiles[l].push_back({ tile.X + size, tile.Y, size });
+
+		tile.Size = size;
+	}
+
+	m_AllocatedArea += (UINT64)tile.Size * tile.Size;
+	o_Tile = tile;
+	return true;
+}
+
+void ShadowAtlas::Free(const Tile & i_Tile)
+{
+	ASSERT(m_AllocatedArea >= (UINT64)i_Tile.Size * i_Tile.Size);
+	m_AllocatedArea -= (UINT64)i_Tile.Size * i_Tile.Size;
+
+	Tile tile = i_Tile;
+	UINT level = GetLevel(tile.Size);
+
+	// merge with the buddies if they are all free
+	while (level > 0)
+	{
+		const UINT parentSize = GetTileSize(level - 1);
+		const UINT parentX = tile.X - (tile.X % parentSize);
+		const UINT parentY = tile.Y - (tile.Y % parentSize);
+
+		std::vector<Tile> & freeTiles = m_FreeTiles[level];
+		size_t buddies[3];
+		UINT buddyCount = 0;
+
+		for (size_t i = 0; i < freeTiles.size() && buddyCount < 3; ++i)
+		{
+			const Tile & other = freeTiles[i];
+			if (other.X >= parentX && other.X < parentX + parentSize
+				&& other.Y >= parentY && other.Y < parentY + parentSize)
+			{
+				buddies[buddyCount++] = i;
+			}
+		}
+
+		if (buddyCount < 3)
+			break;
+
+		// remove buddies (from the back to keep indices valid)
+		for (int i = 2; i >= 0; --i)
+		{
+			freeTiles[buddies[i]] = freeTiles.back();
+			freeTiles.pop_back();
+		}
+
+		tile = { parentX, parentY, parentSize };
+		--level;
+	}
+
+	m_FreeTiles[level].push_back(tile);
+}
+
+void ShadowAtlas::Reset()
+{
+	for (size_t i = 0; i < m_FreeTiles.size(); ++i)
+	{
+		m_FreeTiles[i].clear();
+	}
+
+	m_FreeTiles[0].push_back({ 0, 0, m_Size });
+	m_AllocatedArea = 0;
+}
+
+UINT ShadowAtlas::GetSize() const
+{
+	return m_Size;
+}
+
+UINT ShadowAtlas::GetMinTileSize() const
+{
+	return m_MinTileSize;
+}
+
+UINT64 ShadowAtlas::GetAllocatedArea() const
+{
+	return m_AllocatedArea;
+}
+
+FORCEINLINE UINT ShadowAtlas::GetLevel(UINT i_Size) const
+{
+	// smallest tile that contains the size
+	UINT level = 0;
+	while (level + 1 < m_LevelCount && GetTileSize(level + 1) >= i_Size)
+	{
+		++level;
+	}
+
+	return level;
+}
+
+FORCEINLINE UINT ShadowAtlas::GetTileSize(UINT i_Level) const
+{
+	return m_Size >> i_Level;
+}
@@ -0,0 +1,47 @@
+// shadow atlas allocator
+// all shadow maps of the frame are packed in one depth texture
+// tiles are square and power of two sized (buddy allocation : a tile is split in 4 when a smaller one is needed)
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+
+class ShadowAtlas
+{
+public:
+	// area of the atlas in pixels
+	struct Tile
+	{
+		UINT		X;
+		UINT		Y;
+		UINT		Size;
+	};
+
+	ShadowAtlas(UINT i_Size, UINT i_MinTileSize = 64);
+	~ShadowAtlas();
+
+	// allocation management
+	bool		Allocate(UINT i_Size, Tile & o_Tile);	// the size is rounded to the next power of two
+	void		Free(const Tile & i_Tile);
+	void		Reset();	// free all tiles
+
+	// information
+	UINT		GetSize() const;
+	UINT		GetMinTileSize() const;
+	UINT64		GetAllocatedArea() const;	// in pixels
+
+private:
+	// helpers
+	UINT		GetLevel(UINT i_Size) const;	// 0 is the whole atlas
+	UINT		GetTileSize(UINT i_Level) const;
+
+	// free tiles for each level
+	std::vector<std::vector<Tile>>		m_FreeTiles;
+
+	// desc
+	const UINT		m_Size;
+	const UINT		m_MinTileSize;
+	UINT			m_LevelCount;
+	UINT64			m_AllocatedArea;
+};
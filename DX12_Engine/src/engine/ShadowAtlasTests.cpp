@@ -0,0 +1,125 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <math.h>
+
+#include "engine/Utils.h"
+#include "engine/ShadowAtlas.h"
+#include "engine/ShadowCascade.h"
+
+CFShadowCheck::CFShadowCheck()
+	:Console::Function("shadow_check", "", "validate the shadow atlas allocator and the shadow views math")
+{
+}
+
+bool CFShadowCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT errors = 0;
+
+	// -- atlas : tiles are inside the atlas and never overlap -- //
+	ShadowAtlas atlas(4096, 64);
+	std::vector<ShadowAtlas::Tile> tiles;
+	ShadowAtlas::Tile tile;
+	const UINT sizes[] = { 1024, 512, 1024, 64, 2048, 256, 100 };
+
+	for (UINT i = 0; i < _countof(sizes); ++i)
+	{
+		if (atlas.Allocate(sizes[i], tile))		tiles.push_back(tile);
+		else									++errors;
+	}
+
+	// fill the atlas
+	while (atlas.Allocate(512, tile))
+	{
+		tiles.push_back(tile);
+	}
+
+	for (size_t i = 0; i < tiles.size(); ++i)
+	{
+		const ShadowAtlas::Tile & a = tiles[i];
+		if (a.X + a.Size > atlas.GetSize() || a.Y + a.Size > atlas.GetSize())
+			++errors;
+
+		for (size_t j = i + 1; j < tiles.size(); ++j)
+		{
+			const ShadowAtlas::Tile & b = tiles[j];
+			if (a.X < b.X + b.Size && b.X < a.X + a.Size && a.Y < b.Y + b.Size && b.Y < a.Y + a.Size)
+				++errors;
+		}
+	}
+
+	// free tiles are merged back
+	for (size_t i = 0; i < tiles.size(); ++i)
+	{
+		atlas.Free(tiles[i]);
+	}
+
+	if (atlas.GetAllocatedArea() != 0 || !atlas.Allocate(atlas.GetSize(), tile))
+		++errors;
+
+	GetConsole()->Print("atlas : %u tiles checked", (UINT)tiles.size());
+
+	// -- cascades : splits are increasing and slices fit in their cascade -- //
+	float splits[SHADOW_CASCADE_COUNT + 1];
+	ShadowCascade::ComputeSplits(0.1f, 150.f, SHADOW_CASCADE_COUNT, 0.8f, splits);
+
+	if (splits[0] != 0.1f || splits[SHADOW_CASCADE_COUNT] != 150.f)
+		++errors;
+
+	const XMMATRIX view = XMMatrixLookToLH(XMVectorSet(3.f, 2.f, -5.f, 1.f), XMVectorSet(0.6f, -0.2f, 0.8f, 0.f), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	const XMMATRIX invView = XMMatrixInverse(nullptr, view);
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(45.f * DegToRad, 16.f / 9.f, 0.1f, 1000.f));
+
+	for (UINT c = 0; c < SHADOW_CASCADE_COUNT; ++c)
+	{
+		if (splits[c] >= splits[c + 1])
+			++errors;
+
+		XMVECTOR corners[8];
+		ShadowCascade::ComputeFrustumCorners(invView, projection._11, projection._22, splits[c], splits[c + 1], corners);
+
+		const XMMATRIX cascade = ShadowCascade::ComputeCascadeMatrix(corners, XMVectorSet(0.3f, -1.f, 0.2f, 0.f), 1024, 50.f);
+		XMVECTOR planes[6];
+		ShadowCascade::ExtractFrustumPlanes(cascade, planes);
+
+		for (UINT i = 0; i < 8; ++i)
+		{
+			XMFLOAT3 ndc;
+			XMStoreFloat3(&ndc, XMVector3TransformCoord(corners[i], cascade));
+
+			if (fabsf(ndc.x) > 1.0001f || fabsf(ndc.y) > 1.0001f || ndc.z < -0.0001f || ndc.z > 1.0001f)
+				++errors;
+			if (!ShadowCascade::SphereInFrustum(planes, XMVectorSetW(corners[i], 0.01f)))
+				++errors;
+		}
+	}
+
+	// -- spot : points on the cone axis are projected at the center -- //
+	const XMVECTOR spotPosition = XMVectorSet(1.f, 5.f, 2.f, 1.f);
+	const XMVECTOR spotDirection = XMVector3Normalize(XMVectorSet(0.f, -1.f, 0.1f, 0.f));
+	const XMMATRIX spot = ShadowCascade::ComputeSpotMatrix(spotPosition, spotDirection, 0.8f, 20.f);
+
+	for (float d = 0.5f; d < 20.f; d += 2.f)
+	{
+		XMFLOAT3 ndc;
+		XMStoreFloat3(&ndc, XMVector3TransformCoord(XMVectorAdd(spotPosition, XMVectorScale(spotDirection, d)), spot));
+
+		if (fabsf(ndc.x) > 0.0001f || fabsf(ndc.y) > 0.0001f || ndc.z < 0.f || ndc.z > 1.f)
+			++errors;
+	}
+
+	// -- atlas matrix : NDC corners map to the tile corners -- //
+	const ShadowAtlas::Tile atlasTile = { 1024, 2048, 1024 };
+	XMFLOAT3 uv;
+	XMStoreFloat3(&uv, XMVector3TransformCoord(XMVectorSet(-1.f, 1.f, 0.5f, 1.f), ShadowCascade::ComputeAtlasMatrix(atlasTile, 4096)));
+
+	if (fabsf(uv.x - 0.25f) > 0.0001f || fabsf(uv.y - 0.5f) > 0.0001f)
+		++errors;
+
+	GetConsole()->Print("shadow check : %u errors", errors);
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -0,0 +1,154 @@
+#include "ShadowCascade.h"
+
+#include "engine/Debug.h"
+#include <math.h>
+
+void ShadowCascade::ComputeSplits(float i_Near, float i_Far, UINT i_CascadeCount, float i_Lambda, float * o_Splits)
+{
+	ASSERT(i_Near > 0.f && i_Far > i_Near);
+	ASSERT(i_CascadeCount > 0);
+
+	const float ratio = i_Far / i_Near;
+	const float range = i_Far - i_Near;
+
+	o_Splits[0] = i_Near;
+
+	for (UINT i = 1; i < i_CascadeCount; ++i)
+	{
+		const float p = (float)i / (float)i_CascadeCount;
+		const float logSplit = i_Near * powf(ratio, p);
+		const float uniformSplit = i_Near + range * p;
+
+		o_Splits[i] = i_Lambda * logSplit + (1.f - i_Lambda) * uniformSplit;
+	}
+
+	o_Splits[i_CascadeCount] = i_Far;
+}
+
+void ShadowCascade::ComputeFrustumCorners(const XMMATRIX & i_InvView, float i_ProjX, float i_ProjY, float i_Near, float i_Far, XMVECTOR * o_Corners)
+{
+	// corners of the slice in view space : x = z / proj._11, y = z / proj._22
+	const XMVECTOR signs[4] =
+	{
+		XMVectorSet(-1.f,  1.f, 1.f, 0.f),
+		XMVectorSet( 1.f,  1.f, 1.f, 0.f),
+		XMVectorSet( 1.f, -1.f, 1.f, 0.f),
+		XMVectorSet(-1.f, -1.f, 1.f, 0.f),
+	};
+
+	const XMVECTOR nearExtent	= XMVectorSet(i_Near / i_ProjX, i_Near / i_ProjY, i_Near, 1.f);
+	const XMVECTOR farExtent	= XMVectorSet(i_Far / i_ProjX, i_Far / i_ProjY, i_Far, 1.f);
+
+	for (UINT i = 0; i < 4; ++i)
+	{
+		o_Corners[i]		= XMVector3TransformCoord(XMVectorMultiply(nearExtent, signs[i]), i_InvView);
+		o_Corners[i + 4]	= XMVector3TransformCoord(XMVectorMultiply(farExtent, signs[i]), i_InvView);
+	}
+}
+
+XMMATRIX ShadowCascade::ComputeCascadeMatrix(const XMVECTOR * i_Corners, FXMVECTOR i_LightDirection, UINT i_Resolution, float i_Extrusion)
+{
+	// bounding sphere of the slice
+	XMVECTOR center = XMVectorZero();
+	for (UINT i = 0; i < 8; ++i)
+	{
+		center = XMVectorAdd(center, i_Corners[i]);
+	}
+	center = XMVectorScale(center, 1.f / 8.f);
+
+	XMVECTOR radiusSq = XMVectorZero();
+	for (UINT i = 0; i < 8; ++i)
+	{
+		radiusSq = XMVectorMax(radiusSq, XMVector3LengthSq(XMVectorSubtract(i_Corners[i], center)));
+	}
+
+	// round the radius : the texel size must stay constant between frames
+	const float radius = ceilf(sqrtf(XMVectorGetX(radiusSq)) * 16.f) / 16.f;
+	const float texelSize = (2.f * radius) / (float)i_Resolution;
+
+	// the light view only depends on the light direction : the sphere center is snapped in this space
+	const XMVECTOR direction = XMVector3Normalize(i_LightDirection);
+	const XMMATRIX lightView = XMMatrixLookToLH(XMVectorZero(), direction, GetLightUp(direction));
+
+	XMVECTOR lightCenter = XMVector3TransformCoord(center, lightView);
+	const XMVECTOR texel = XMVectorSet(texelSize, texelSize, 1.f, 1.f);
+	lightCenter = XMVectorSelect(lightCenter, XMVectorMultiply(XMVectorFloor(XMVectorDivide(lightCenter, texel)), texel), g_XMSelect1100);
+
+	XMFLOAT3 c;
+	XMStoreFloat3(&c, lightCenter);
+
+	const XMMATRIX projection = XMMatrixOrthographicOffCenterLH(
+		c.x - radius, c.x + radius,
+		c.y - radius, c.y + radius,
+		c.z - radius - i_Extrusion, c.z + radius);
+
+	return XMMatrixMultiply(lightView, projection);
+}
+
+XMMATRIX ShadowCascade::ComputeSpotMatrix(FXMVECTOR i_Position, FXMVECTOR i_Direction, float i_CosAngle, float i_Range)
+{
+	const XMVECTOR direction = XMVector3Normalize(i_Direction);
+	const XMMATRIX view = XMMatrixLookToLH(i_Position, direction, GetLightUp(direction));
+
+	// the cone must fit in the frustum (clamped to avoid degenerated projections)
+	const float cosAngle = XMVectorGetX(XMVectorClamp(XMVectorReplicate(i_CosAngle), g_XMNegativeOne, g_XMOne));
+	const float fov = XMVectorGetX(XMVectorClamp(XMVectorReplicate(2.f * acosf(cosAngle)), XMVectorReplicate(XMConvertToRadians(1.f)), XMVectorReplicate(XMConvertToRadians(170.f))));
+	const float range = (i_Range > 0.1f) ? i_Range : 0.1f;
+
+	const XMMATRIX projection = XMMatrixPerspectiveFovLH(fov, 1.f, 0.05f, range);
+
+	return XMMatrixMultiply(view, projection);
+}
+
+XMMATRIX ShadowCascade::ComputeAtlasMatrix(const ShadowAtlas::Tile & i_Tile, UINT i_AtlasSize)
+{
+	// NDC [-1, 1] to texture coordinates inside the tile (y is flipped)
+	const float scale = (float)i_Tile.Size / (float)i_AtlasSize;
+	const float offsetX = (float)i_Tile.X / (float)i_AtlasSize;
+	const float offsetY = (float)i_Tile.Y / (float)i_AtlasSize;
+
+	return XMMatrixSet(
+		0.5f * scale, 0.f, 0.f, 0.f,
+		0.f, -0.5f * scale, 0.f, 0.f,
+		0.f, 0.f, 1.f, 0.f,
+		0.5f * scale + offsetX, 0.5f * scale + offsetY, 0.f, 1.f);
+}
+
+void ShadowCascade::ExtractFrustumPlanes(const XMMATRIX & i_ViewProjection, XMVECTOR * o_Planes)
+{
+	// planes are extracted from the columns of the matrix (rows of the transposed one)
+	const XMMATRIX m = XMMatrixTranspose(i_ViewProjection);
+
+	o_Planes[0] = XMVectorAdd(m.r[3], m.r[0]);			// left
+	o_Planes[1] = XMVectorSubtract(m.r[3], m.r[0]);		// right
+	o_Planes[2] = XMVectorAdd(m.r[3], m.r[1]);			// bottom
+	o_Planes[3] = XMVectorSubtract(m.r[3], m.r[1]);		// top
+	o_Planes[4] = m.r[2];								// near (z in [0, 1])
+	o_Planes[5] = XMVectorSubtract(m.r[3], m.r[2]);		// far
+
+	for (UINT i = 0; i < 6; ++i)
+	{
+		o_Planes[i] = XMPlaneNormalize(o_Planes[i]);
+	}
+}
+
+bool ShadowCascade::SphereInFrustum(const XMVECTOR * i_Planes, FXMVECTOR i_Sphere)
+{
+	const XMVECTOR center = XMVectorSetW(i_Sphere, 1.f);
+	const XMVECTOR radius = XMVectorNegate(XMVectorSplatW(i_Sphere));
+
+	XMVECTOR outside = XMVectorFalseInt();
+
+	for (UINT i = 0; i < 6; ++i)
+	{
+		outside = XMVectorOrInt(outside, XMVectorLess(XMPlaneDot(i_Planes[i], center), radius));
+	}
+
+	return XMVector4EqualInt(outside, XMVectorFalseInt());
+}
+
+FORCEINLINE XMVECTOR ShadowCascade::GetLightUp(FXMVECTOR i_Direction)
+{
+	// avoid an up vector parallel to the light direction
+	return (fabsf(XMVectorGetY(i_Direction)) > 0.99f) ? g_XMIdentityR0 : g_XMIdentityR1;
+}
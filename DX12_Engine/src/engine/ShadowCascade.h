@@ -0,0 +1,46 @@
+// shadow views computation
+// cascaded shadow maps for directional lights and perspective shadow views for spot lights
+// all the math is done on the CPU with DirectXMath (SIMD)
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+#include "engine/ShadowAtlas.h"
+
+using namespace DirectX;
+
+// define
+#define			SHADOW_CASCADE_COUNT		4		// cascades for each directional light (must match DeferredLightPS.hlsl)
+#define			MAX_SHADOW_VIEW				64		// shadow views for a frame
+#define			MAX_SHADOW_INSTANCE			0x4000	// shadow casters instances for a frame
+#define			NO_SHADOW					0xffffffff	// the light have no shadow view
+
+class ShadowCascade
+{
+public:
+	// cascade splits : blend between logarithmic and uniform distribution (0 : uniform, 1 : logarithmic)
+	// o_Splits must contain i_CascadeCount + 1 values (o_Splits[0] is near and o_Splits[i_CascadeCount] is far)
+	static void			ComputeSplits(float i_Near, float i_Far, UINT i_CascadeCount, float i_Lambda, float * o_Splits);
+
+	// world space corners of the view frustum between 2 view depths (4 near corners then 4 far corners)
+	static void			ComputeFrustumCorners(const XMMATRIX & i_InvView, float i_ProjX, float i_ProjY, float i_Near, float i_Far, XMVECTOR * o_Corners);
+
+	// directional light view projection fitting the frustum corners
+	// the projection is a sphere so it doesn't change with the camera rotation and it is snapped to the texels (no shimmering)
+	// i_Extrusion move the near plane toward the light to keep casters that are outside of the frustum
+	static XMMATRIX		ComputeCascadeMatrix(const XMVECTOR * i_Corners, FXMVECTOR i_LightDirection, UINT i_Resolution, float i_Extrusion);
+
+	// spot light view projection (i_CosAngle : cos of the half angle)
+	static XMMATRIX		ComputeSpotMatrix(FXMVECTOR i_Position, FXMVECTOR i_Direction, float i_CosAngle, float i_Range);
+
+	// transform from NDC space to the atlas tile texture coordinates
+	static XMMATRIX		ComputeAtlasMatrix(const ShadowAtlas::Tile & i_Tile, UINT i_AtlasSize);
+
+	// culling helpers
+	static void			ExtractFrustumPlanes(const XMMATRIX & i_ViewProjection, XMVECTOR * o_Planes);	// 6 normalized planes (inside is positive)
+	static bool			SphereInFrustum(const XMVECTOR * i_Planes, FXMVECTOR i_Sphere);	// xyz : center, w : radius
+
+private:
+	static XMVECTOR		GetLightUp(FXMVECTOR i_Direction);
+};
@@ -0,0 +1,417 @@
+#include "TLSFAllocator.h"
+
+#include "engine/Debug.h"
+#include "engine/Utils.h"
+
+#include <intrin.h>
+
+TLSFAllocator::TLSFAllocator(UINT64 i_Size, UINT64 i_Granularity)
+	:m_Size(i_Size / i_Granularity)
+	,m_Granularity(i_Granularity)
+	,m_AllocatedSize(0)
+	,m_FreeBlockCount(0)
+{
+	// the granularity is a power of two
+	ASSERT(i_Granularity != 0 && (i_Granularity & (i_Granularity - 1)) == 0);
+	ASSERT(m_Size != 0);
+
+	Reset();
+}
+
+TLSFAllocator::~TLSFAllocator()
+{
+}
+
+UINT64 TLSFAllocator::Allocate(UINT64 i_Size)
+{
+	if (i_Size == 0 || i_Size > m_Size * m_Granularity)
+		return InvalidOffset;
+
+	const UINT64 size = (i_Size + m_Granularity - 1) / m_Granularity;
+	const UINT block = FindFreeBlock(size);
+
+	if (block == NullBlock)
+		return InvalidOffset;
+
+	RemoveFreeBlock(block);
+
+	// the end of the block is given back to the free lists
+	if (m_Blocks[block].Size > size)
+	{
+		const UINT remaining = CreateBlock(m_Blocks[block].Offset + size, m_Blocks[block].Size - size);
+		const UINT next = m_Blocks[block].NextPhysical;
+
+		m_Blocks[remaining].PreviousPhysical	= block;
+		m_Blocks[remaining].NextPhysical		= next;
+		if (next != NullBlock)
+			m_Blocks[next].PreviousPhysical = remaining;
+
+		m_Blocks[block].NextPhysical	= remaining;
+		m_Blocks[block].Size			= size;
+
+		InsertFreeBlock(remaining);
+	}
+
+	m_AllocatedBlocks[m_Blocks[block].Offset] = block;
+	m_AllocatedSize += size;
+
+	return m_Blocks[block].Offset * m_Granularity;
+}
+
+void TLSFAllocator::Free(UINT64 i_Offset)
+{
+	if (i_Offset == InvalidOffset)
+		return;
+
+	auto itr = m_AllocatedBlocks.find(i_Offset / m_Granularity);
+
+	// a block is freed once
+	if (itr == m_AllocatedBlocks.end())
+	{
+		PRINT_DEBUG("[TLSFAllocator] Error, the offset %llu is not allocated", i_Offset);
+		ASSERT(false);
+		return;
+	}
+
+	UINT block = itr->second;
+	m_AllocatedBlocks.erase(itr);
+	m_AllocatedSize -= m_Blocks[block].Size;
+
+	// merge with the previous free block
+	const UINT previous = m_Blocks[block].PreviousPhysical;
+
+	if (previous != NullBlock && m_Blocks[previous].IsFree)
+	{
+		RemoveFreeBlock(previous);
+
+		const UINT next = m_Blocks[block].NextPhysical;
+		m_Blocks[previous].Size			+= m_Blocks[block].Size;
+		m_Blocks[previous].NextPhysical	= next;
+		if (next != NullBlock)
+			m_Blocks[next].PreviousPhysical = previous;
+
+		DestroyBlock(block);
+		block = previous;
+	}
+
+	// merge with the next free block
+	const UINT next = m_Blocks[block].NextPhysical;
+
+	if (next != NullBlock && m_Blocks[next].IsFree)
+	{
+		RemoveFreeBlock(next);
+
+		const UINT nextNext = m_Blocks[next].NextPhysical;
+		m_Blocks[block].Size			+= m_Blocks[next].Size;
+		m_Blocks[block].NextPhysical	= nextNext;
+		if (nextNext != NullBlock)
+			m_Blocks[nextNext].PreviousPhysical = block;
+
+		DestroyBlock(next);
+	}
+
+	InsertFreeBlock(block);
+}
+
+void TLSFAllocator::Reset()
+{
+	m_Blocks.clear();
+	m_UnusedBlocks.clear();
+	m_AllocatedBlocks.clear();
+	m_AllocatedSize		= 0;
+	m_FreeBlockCount	= 0;
+	m_FirstLevelMap		= 0;
+
+	for (UINT i = 0; i < FirstLevelCount; ++i)
+	{
+		m_SecondLevelMap[i] = 0;
+
+		for (UINT j = 0; j < SecondLevelCount; ++j)
+		{
+			m_FreeLists[i][j] = NullBlock;
+		}
+	}
+
+	// one free block for the whole range
+	m_FirstBlock = CreateBlock(0, m_Size);
+	InsertFreeBlock(m_FirstBlock);
+}
+
+UINT64 TLSFAllocator::GetSize() const
+{
+	return m_Size * m_Granularity;
+}
+
+UINT64 TLSFAllocator::GetGranularity() const
+{
+	return m_Granularity;
+}
+
+UINT64 TLSFAllocator::GetAllocatedSize() const
+{
+	return m_AllocatedSize * m_Granularity;
+}
+
+UINT64 TLSFAllocator::GetAllocationSize(UINT64 i_Offset) const
+{
+	auto itr = m_AllocatedBlocks.find(i_Offset / m_Granularity);
+
+	if (itr == m_AllocatedBlocks.end())
+		return 0;
+
+	return m_Blocks[itr->second].Size * m_Granularity;
+}
+
+UINT TLSFAllocator::GetAllocationCount() const
+{
+	return (UINT)m_AllocatedBlocks.size();
+}
+
+UINT TLSFAllocator::GetFreeBlockCount() const
+{
+	return m_FreeBlockCount;
+}
+
+UINT64 TLSFAllocator::GetLargestFreeBlock() const
+{
+	if (m_FirstLevelMap == 0)
+		return 0;
+
+	// the largest blocks are in the last non empty class
+	const UINT firstLevel = BitScanReverse(m_FirstLevelMap);
+	const UINT secondLevel = BitScanReverse(m_SecondLevelMap[firstLevel]);
+	UINT64 largest = 0;
+
+	for (UINT block = m_FreeLists[firstLevel][secondLevel]; block != NullBlock; block = m_Blocks[block].NextFree)
+	{
+		largest = Math::Max(largest, m_Blocks[block].Size);
+	}
+
+	return largest * m_Granularity;
+}
+
+float TLSFAllocator::GetFragmentation() const
+{
+	const UINT64 freeSize = m_Size - m_AllocatedSize;
+
+	if (freeSize == 0)
+		return 0.f;
+
+	return 1.f - (float)(GetLargestFreeBlock() / m_Granularity) / (float)freeSize;
+}
+
+bool TLSFAllocator::IsValid() const
+{
+	// the physical blocks cover the range without gap and the free blocks are merged
+	UINT64 offset = 0, allocatedSize = 0;
+	UINT freeCount = 0, allocatedCount = 0;
+	UINT previous = NullBlock;
+
+	for (UINT block = m_FirstBlock; block != NullBlock; block = m_Blocks[block].NextPhysical)
+	{
+		const Block & current = m_Blocks[block];
+
+		if (current.Offset != offset || current.Size == 0 || current.PreviousPhysical != previous)
+			return false;
+
+		if (current.IsFree)
+		{
+			if (previous != NullBlock && m_Blocks[previous].IsFree)
+				return false;
+
+			// the block is in the list of its class
+			UINT firstLevel, secondLevel;
+			Mapping(current.Size, firstLevel, secondLevel);
+
+			bool found = false;
+			for (UINT free = m_FreeLists[firstLevel][secondLevel]; free != NullBlock && !found; free = m_Blocks[free].NextFree)
+			{
+				found = (free == block);
+			}
+
+			if (!found)
+				return false;
+
+			++freeCount;
+		}
+		else
+		{
+			auto itr = m_AllocatedBlocks.find(current.Offset);
+			if (itr == m_AllocatedBlocks.end() || itr->second != block)
+				return false;
+
+			allocatedSize += current.Size;
+			++allocatedCount;
+		}
+
+		offset += current.Size;
+		previous = block;
+	}
+
+	// the bitmaps match the lists
+	for (UINT i = 0; i < FirstLevelCount; ++i)
+	{
+		if (((m_FirstLevelMap >> i) & 1) != (m_SecondLevelMap[i] != 0 ? 1u : 0u))
+			return false;
+
+		for (UINT j = 0; j < SecondLevelCount; ++j)
+		{
+			if (((m_SecondLevelMap[i] >> j) & 1) != (m_FreeLists[i][j] != NullBlock ? 1u : 0u))
+				return false;
+		}
+	}
+
+	return offset == m_Size && allocatedSize == m_AllocatedSize && freeCount == m_FreeBlockCount && allocatedCount == m_AllocatedBlocks.size();
+}
+
+FORCEINLINE void TLSFAllocator::Mapping(UINT64 i_Size, UINT & o_FirstLevel, UINT & o_SecondLevel)
+{
+	// small sizes are in the first class, one size per list
+	if (i_Size < SecondLevelCount)
+	{
+		o_FirstLevel = 0;
+		o_SecondLevel = (UINT)i_Size;
+		return;
+	}
+
+	const UINT bit = BitScanReverse(i_Size);
+	o_FirstLevel = bit - SecondLevelLog2 + 1;
+	o_SecondLevel = (UINT)(i_Size >> (bit - SecondLevelLog2)) - SecondLevelCount;
+}
+
+FORCEINLINE UINT TLSFAllocator::BitScanForward(UINT64 i_Value)
+{
+	unsigned long index;
+	_BitScanForward64(&index, i_Value);
+	return (UINT)index;
+}
+
+FORCEINLINE UINT TLSFAllocator::BitScanReverse(UINT64 i_Value)
+{
+	unsigned long index;
+	_BitScanReverse64(&index, i_Value);
+	return (UINT)index;
+}
+
+UINT TLSFAllocator::CreateBlock(UINT64 i_Offset, UINT64 i_Size)
+{
+	UINT block;
+
+	if (!m_UnusedBlocks.empty())
+	{
+		block = m_UnusedBlocks.back();
+		m_UnusedBlocks.pop_back();
+	}
+	else
+	{
+		block = (UINT)m_Blocks.size();
+		m_Blocks.push_back(Block());
+	}
+
+	Block & newBlock = m_Blocks[block];
+	newBlock.Offset				= i_Offset;
+	newBlock.Size				= i_Size;
+	newBlock.PreviousPhysical	= NullBlock;
+	newBlock.NextPhysical		= NullBlock;
+	newBlock.PreviousFree		= NullBlock;
+	newBlock.NextFree			= NullBlock;
+	newBlock.IsFree				= false;
+
+	return block;
+}
+
+void TLSFAllocator::DestroyBlock(UINT i_Block)
+{
+	m_UnusedBlocks.push_back(i_Block);
+}
+
+void TLSFAllocator::InsertFreeBlock(UINT i_Block)
+{
+	UINT firstLevel, secondLevel;
+	Mapping(m_Blocks[i_Block].Size, firstLevel, secondLevel);
+
+	// the block is the new head of the list
+	const UINT head = m_FreeLists[firstLevel][secondLevel];
+
+	m_Blocks[i_Block].PreviousFree	= NullBlock;
+	m_Blocks[i_Block].NextFree		= head;
+	m_Blocks[i_Block].IsFree		= true;
+	if (head != NullBlock)
+		m_Blocks[head].PreviousFree = i_Block;
+
+	m_FreeLists[firstLevel][secondLevel] = i_Block;
+	m_FirstLevelMap |= (1ULL << firstLevel);
+	m_SecondLevelMap[firstLevel] |= (1ULL << secondLevel);
+	++m_FreeBlockCount;
+}
+
+void TLSFAllocator::RemoveFreeBlock(UINT i_Block)
+{
+	UINT firstLevel, secondLevel;
+	Mapping(m_Blocks[i_Block].Size, firstLevel, secondLevel);
+
+	const UINT previous = m_Blocks[i_Block].PreviousFree;
+	const UINT next = m_Blocks[i_Block].NextFree;
+
+	if (previous != NullBlock)
+		m_Blocks[previous].NextFree = next;
+	if (next != NullBlock)
+		m_Blocks[next].PreviousFree = previous;
+
+	// the block was the head of the list
+	if (m_FreeLists[firstLevel][secondLevel] == i_Block)
+	{
+		m_FreeLists[firstLevel][secondLevel] = next;
+
+		if (next == NullBlock)
+		{
+			m_SecondLevelMap[firstLevel] &= ~(1ULL << secondLevel);
+			if (m_SecondLevelMap[firstLevel] == 0)
+				m_FirstLevelMap &= ~(1ULL << firstLevel);
+		}
+	}
+
+	m_Blocks[i_Block].PreviousFree	= NullBlock;
+	m_Blocks[i_Block].NextFree		= NullBlock;
+	m_Blocks[i_Block].IsFree		= false;
+	--m_FreeBlockCount;
+}
+
+UINT TLSFAllocator::FindFreeBlock(UINT64 i_Size) const
+{
+	// the size is rounded to the next class : all the blocks of the class are large enough
+	UINT64 size = i_Size;
+	if (size >= SecondLevelCount)
+		size += (1ULL << (BitScanReverse(size) - SecondLevelLog2)) - 1;
+
+	UINT firstLevel, secondLevel;
+	Mapping(size, firstLevel, secondLevel);
+
+	// a class of the same first level, or the smallest class of a larger first level
+	UINT64 secondLevelMap = (firstLevel < FirstLevelCount) ? (m_SecondLevelMap[firstLevel] & (~0ULL << secondLevel)) : 0;
+
+	if (secondLevelMap == 0)
+	{
+		const UINT64 firstLevelMap = (firstLevel + 1 < 64) ? (m_FirstLevelMap & (~0ULL << (firstLevel + 1))) : 0;
+
+		if (firstLevelMap != 0)
+		{
+			firstLevel = BitScanForward(firstLevelMap);
+			secondLevelMap = m_SecondLevelMap[firstLevel];
+		}
+	}
+
+	if (secondLevelMap != 0)
+		return m_FreeLists[firstLevel][BitScanForward(secondLevelMap)];
+
+	// no rounded class : a block of the class of the size can still be large enough (the last blocks of a page)
+	Mapping(i_Size, firstLevel, secondLevel);
+
+	for (UINT block = m_FreeLists[firstLevel][secondLevel]; block != NullBlock; block = m_Blocks[block].NextFree)
+	{
+		if (m_Blocks[block].Size >= i_Size)
+			return block;
+	}
+
+	return NullBlock;
+}
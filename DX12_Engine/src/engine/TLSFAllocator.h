@@ -0,0 +1,79 @@
+// two level segregated fit allocator
+// ranges of bytes in a large buffer (see DX12MeshArena), the allocator does not use the device
+// free blocks are stored in lists per size class : the first level is the power of two of the size, the second level splits it in linear classes
+// an allocation takes the first non empty class that fits (constant time), freed blocks are merged with their physical neighbours
+// sizes and offsets are multiples of the granularity
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <unordered_map>
+
+class TLSFAllocator
+{
+public:
+	static const UINT64 InvalidOffset = (UINT64)-1;
+
+	TLSFAllocator(UINT64 i_Size, UINT64 i_Granularity = 16);
+	~TLSFAllocator();
+
+	// allocation management
+	UINT64		Allocate(UINT64 i_Size);	// offset of the block, InvalidOffset when no free block is large enough
+	void		Free(UINT64 i_Offset);
+	void		Reset();	// free all blocks
+
+	// information
+	UINT64		GetSize() const;
+	UINT64		GetGranularity() const;
+	UINT64		GetAllocatedSize() const;	// bytes of the allocated blocks (rounded to the granularity)
+	UINT64		GetAllocationSize(UINT64 i_Offset) const;
+	UINT		GetAllocationCount() const;
+	UINT		GetFreeBlockCount() const;
+	UINT64		GetLargestFreeBlock() const;
+	float		GetFragmentation() const;	// 0 : the free bytes are contiguous, near 1 : the free bytes are scattered
+	bool		IsValid() const;	// check the blocks and the lists (debug)
+
+private:
+	static const UINT	SecondLevelLog2 = 4;
+	static const UINT	SecondLevelCount = 1 << SecondLevelLog2;
+	static const UINT	FirstLevelCount = 64 - SecondLevelLog2 + 1;
+	static const UINT	NullBlock = (UINT)-1;
+
+	struct Block
+	{
+		UINT64		Offset;		// in granularity units
+		UINT64		Size;
+		UINT		PreviousPhysical;
+		UINT		NextPhysical;
+		UINT		PreviousFree;
+		UINT		NextFree;
+		bool		IsFree;
+	};
+
+	// size classes
+	static void		Mapping(UINT64 i_Size, UINT & o_FirstLevel, UINT & o_SecondLevel);
+	static UINT		BitScanForward(UINT64 i_Value);
+	static UINT		BitScanReverse(UINT64 i_Value);
+
+	// blocks
+	UINT		CreateBlock(UINT64 i_Offset, UINT64 i_Size);
+	void		DestroyBlock(UINT i_Block);
+	void		InsertFreeBlock(UINT i_Block);
+	void		RemoveFreeBlock(UINT i_Block);
+	UINT		FindFreeBlock(UINT64 i_Size) const;
+
+	std::vector<Block>						m_Blocks;
+	std::vector<UINT>						m_UnusedBlocks;		// slots of the destroyed blocks
+	std::unordered_map<UINT64, UINT>		m_AllocatedBlocks;	// offset to block
+	UINT									m_FirstBlock;		// block at the offset 0 (never merged in a previous block)
+	UINT64									m_FirstLevelMap;
+	UINT64									m_SecondLevelMap[FirstLevelCount];
+	UINT									m_FreeLists[FirstLevelCount][SecondLevelCount];
+
+	// desc
+	const UINT64		m_Size;			// in granularity units
+	const UINT64		m_Granularity;
+	UINT64				m_AllocatedSize;
+	UINT				m_FreeBlockCount;
+};
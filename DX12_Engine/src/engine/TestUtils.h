@@ -0,0 +1,49 @@
+// helpers of the console tests (check and bench commands)
+// TestRandom : deterministic random numbers (linear congruential generator), a test generates the same data on every run
+
+#pragma once
+
+#include "engine/Defines.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <Windows.h>
+
+class TestRandom
+{
+public:
+	TestRandom(UINT i_Seed = 0x1234567)
+		:m_Seed(i_Seed)
+	{
+	}
+
+	// next state of the generator (the low bits have short periods : use the high bits)
+	FORCEINLINE UINT	Next()
+	{
+		m_Seed = m_Seed * 1664525u + 1013904223u;
+		return m_Seed;
+	}
+
+	// integer in [0, i_Max[
+	FORCEINLINE UINT	Index(UINT i_Max)
+	{
+		return (Next() >> 8) % i_Max;
+	}
+
+	// float in [0, 1[ (24 bits)
+	FORCEINLINE float	Unit()
+	{
+		return (float)(Next() >> 8) / (float)(1 << 24);
+	}
+
+	// float in [i_Min, i_Max[
+	FORCEINLINE float	Range(float i_Min, float i_Max)
+	{
+		return i_Min + Unit() * (i_Max - i_Min);
+	}
+
+private:
+	UINT		m_Seed;
+};
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -108,6 +108,16 @@ XMFLOAT4 Transform::GetForward()
 		1.f);
 }
 
+XMMATRIX Transform::Interpolate(const Transform & i_Previous, const Transform & i_Current, float i_Alpha)
+{
+	const XMVECTOR position	= XMVectorLerp(i_Previous.m_Position, i_Current.m_Position, i_Alpha);
+	const XMVECTOR scale	= XMVectorLerp(i_Previous.m_Scale, i_Current.m_Scale, i_Alpha);
+	const XMVECTOR rotation	= XMQuaternionSlerp(ToQuaternion(i_Previous.m_Rotation), ToQuaternion(i_Current.m_Rotation), i_Alpha);
+
+	// scale, rotation then translation (as RecomputeMatrix)
+	return XMMatrixAffineTransformation(scale, XMVectorZero(), rotation, position);
+}
+
 Transform & Transform::operator=(const Transform i_Other)
 {
 	m_Position	= i_Other.m_Position;
@@ -151,3 +161,16 @@ inline void Transform::RecomputeMatrix()
 	XMStoreFloat4x4(&m_CacheMatrix, mat);
 	XMStoreFloat4x4(&m_CacheTransposed, XMMatrixTranspose(mat));
 }
+
+XMVECTOR Transform::ToQuaternion(FXMVECTOR i_Rotation)
+{
+	XMFLOAT3 tRot;
+	DirectX::XMStoreFloat3(&tRot, i_Rotation);
+
+	// rotation around X, then Y, then Z
+	const XMVECTOR rotX = XMQuaternionRotationNormal(XMVectorSet(1.f, 0.f, 0.f, 0.f), tRot.x * DegToRad);
+	const XMVECTOR rotY = XMQuaternionRotationNormal(XMVectorSet(0.f, 1.f, 0.f, 0.f), tRot.y * DegToRad);
+	const XMVECTOR rotZ = XMQuaternionRotationNormal(XMVectorSet(0.f, 0.f, 1.f, 0.f), tRot.z * DegToRad);
+
+	return XMQuaternionMultiply(XMQuaternionMultiply(rotX, rotY), rotZ);
+}
@@ -32,12 +32,16 @@ public:
 	// transform compute information
 	XMFLOAT4		GetForward();
 
+	// interpolated matrix between two states (positions and scales are lerped, rotations are slerped)
+	static XMMATRIX	Interpolate(const Transform & i_Previous, const Transform & i_Current, float i_Alpha);
+
 	// operator
 	Transform &	operator=(const Transform i_Other);
 
 private:
 	// recompute
 	void		RecomputeMatrix();
+	static XMVECTOR		ToQuaternion(FXMVECTOR i_Rotation);	// same rotation order than the matrix (degrees)
 
 	// transform
 	XMVECTOR	m_Position;
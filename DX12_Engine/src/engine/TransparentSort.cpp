@@ -0,0 +1,44 @@
+#include "TransparentSort.h"
+
+#include "engine/RadixSort.h"
+#include "engine/Utils.h"
+
+#include <float.h>
+
+float TransparentSort::GetViewDepth(const XMFLOAT4X4 & i_View, const XMFLOAT3 & i_Center)
+{
+	return i_Center.x * i_View._13 + i_Center.y * i_View._23 + i_Center.z * i_View._33 + i_View._43;
+}
+
+void TransparentSort::BuildKeys(EMode i_Mode, const XMMATRIX & i_View, const Draw * i_Draws, UINT i_Count, UINT64 * o_Keys, UINT i_FirstIndex)
+{
+	if (i_Mode == eOrderIndependent)
+	{
+		for (UINT i = 0; i < i_Count; ++i)
+		{
+			o_Keys[i] = ((UINT64)i_Draws[i].State << 32) | (i_FirstIndex + i);
+		}
+
+		return;
+	}
+
+	XMFLOAT4X4 view;
+	XMStoreFloat4x4(&view, i_View);
+
+	for (UINT i = 0; i < i_Count; ++i)
+	{
+		const float depth = GetViewDepth(view, i_Draws[i].Center);
+		o_Keys[i] = ((UINT64)RadixSort::BackToFrontKey(Math::Max(depth, FLT_MIN)) << 32) | (i_FirstIndex + i);
+	}
+}
+
+void TransparentSort::SortKeys(UINT64 * io_Keys, UINT64 * io_Scratch, UINT i_Count)
+{
+	// the indices are written in ascending order : the sort of the high bits is a full sort
+	RadixSort::Sort(io_Keys, io_Scratch, i_Count, 32, 32);
+}
+
+UINT TransparentSort::GetDrawIndex(UINT64 i_Key)
+{
+	return (UINT)(i_Key & 0xFFFFFFFF);
+}
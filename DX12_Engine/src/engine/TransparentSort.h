@@ -0,0 +1,58 @@
+// semi transparent pass sorting
+// the render components are partitioned by render pass : the opaque meshes are drawn in the GBuffer, the semi transparent meshes
+// are drawn with the particle emitters by the forward pass after the lights (see RenderList::RenderTransparent)
+// sorted blending : the draws are sorted back to front on the view depth of their center
+// order independent : the blending is commutative (see DX12Transparency), the draws are only sorted by pipeline state
+// a key is the sort value in the high 32 bits and the draw index in the low bits : the high bits are radix sorted (see RadixSort)
+// this is used by the render list and validated on the CPU (see transparency_check)
+
+#pragma once
+
+#include <Windows.h>
+#include <DirectXMath.h>
+#include <vector>
+
+using namespace DirectX;
+
+class TransparentSort
+{
+public:
+	enum EMode
+	{
+		eSortedBlend,			// back to front, alpha blended on the back buffer
+		eOrderIndependent,		// weighted blended order independent transparency
+	};
+
+	// draw of the pass
+	struct Draw
+	{
+		XMFLOAT3		Center;		// world center (bounding sphere of the mesh or origin of the emitter)
+		UINT			State;		// pipeline state of the draw (order independent sort)
+	};
+
+	// partition : the items keep their submission order in both partitions
+	template <typename T, typename Predicate>
+	static void		Partition(const std::vector<T> & i_Items, Predicate i_IsTransparent, std::vector<T> & o_Opaque, std::vector<T> & o_Transparent);
+
+	// sort keys : the draw index of a key is i_FirstIndex + the index in i_Draws
+	// the draws behind the camera are drawn first, in submission order
+	static float	GetViewDepth(const XMFLOAT4X4 & i_View, const XMFLOAT3 & i_Center);
+	static void		BuildKeys(EMode i_Mode, const XMMATRIX & i_View, const Draw * i_Draws, UINT i_Count, UINT64 * o_Keys, UINT i_FirstIndex = 0);
+	static void		SortKeys(UINT64 * io_Keys, UINT64 * io_Scratch, UINT i_Count);	// stable : the draws with the same sort value stay in index order
+	static UINT		GetDrawIndex(UINT64 i_Key);
+};
+
+template <typename T, typename Predicate>
+inline void TransparentSort::Partition(const std::vector<T> & i_Items, Predicate i_IsTransparent, std::vector<T> & o_Opaque, std::vector<T> & o_Transparent)
+{
+	o_Opaque.clear();
+	o_Transparent.clear();
+
+	for (size_t i = 0; i < i_Items.size(); ++i)
+	{
+		if (i_IsTransparent(i_Items[i]))
+			o_Transparent.push_back(i_Items[i]);
+		else
+			o_Opaque.push_back(i_Items[i]);
+	}
+}
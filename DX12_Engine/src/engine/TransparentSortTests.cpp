@@ -0,0 +1,158 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <algorithm>
+#include <float.h>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/TransparentSort.h"
+#include "engine/TestUtils.h"
+
+CFTransparencyCheck::CFTransparencyCheck()
+	:Console::Function("transparency_check", "[draw count]", "check the render pass partition and the back to front and pipeline state sorts of the semi transparent pass against std::stable_sort")
+{
+}
+
+bool CFTransparencyCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT drawCount = 1 << 16;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		drawCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	const UINT stateCount = 8;
+	UINT errors = 0;
+
+	// random draws around the camera (deterministic), some behind it and some on the same depth
+	TestRandom random(0x7654321);
+
+	std::vector<TransparentSort::Draw> draws(drawCount);
+	std::vector<bool> transparent(drawCount);
+
+	for (UINT i = 0; i < drawCount; ++i)
+	{
+		TransparentSort::Draw & draw = draws[i];
+		draw.Center = XMFLOAT3((random.Unit() * 2.f - 1.f) * 50.f, random.Unit() * 20.f, (random.Unit() * 2.f - 1.f) * 100.f);
+		draw.State = (UINT)(random.Unit() * stateCount) % stateCount;
+
+		// duplicated depths : the ties are drawn in submission order
+		if (i > 0 && random.Unit() < 0.1f)
+			draw.Center = draws[i - 1].Center;
+
+		transparent[i] = random.Unit() < 0.3f;
+	}
+
+	// partition : the submission order is kept in both render passes
+	std::vector<UINT> items(drawCount), opaque, semiTransparent;
+	for (UINT i = 0; i < drawCount; ++i)
+	{
+		items[i] = i;
+	}
+
+	Clock partitionClock;
+	TransparentSort::Partition(items, [&transparent](UINT i_Item) { return (bool)transparent[i_Item]; }, opaque, semiTransparent);
+	const UINT64 partitionTime = partitionClock.GetElaspedTime().ToMicroseconds();
+
+	UINT partitionErrors = (opaque.size() + semiTransparent.size() == drawCount) ? 0 : 1;
+
+	for (size_t i = 0; i < opaque.size(); ++i)
+	{
+		partitionErrors += (transparent[opaque[i]] || (i > 0 && opaque[i] <= opaque[i - 1])) ? 1 : 0;
+	}
+
+	for (size_t i = 0; i < semiTransparent.size(); ++i)
+	{
+		partitionErrors += (!transparent[semiTransparent[i]] || (i > 0 && semiTransparent[i] <= semiTransparent[i - 1])) ? 1 : 0;
+	}
+
+	errors += (partitionErrors > 0) ? 1 : 0;
+
+	GetConsole()->Print("transparency check : partition, %u opaque, %u semi transparent, %llu us, %u errors",
+		(UINT)opaque.size(), (UINT)semiTransparent.size(), partitionTime, partitionErrors);
+
+	// sorted blending : back to front, the draws behind the camera first
+	const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.f, 10.f, 0.f, 1.f), XMVectorSet(0.f, 5.f, 50.f, 1.f), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	XMFLOAT4X4 viewMatrix;
+	XMStoreFloat4x4(&viewMatrix, view);
+
+	std::vector<UINT64> keys(drawCount), scratch(drawCount);
+
+	Clock keyClock;
+	TransparentSort::BuildKeys(TransparentSort::eSortedBlend, view, draws.data(), drawCount, keys.data());
+	const UINT64 keyTime = keyClock.GetElaspedTime().ToMicroseconds();
+
+	Clock sortClock;
+	TransparentSort::SortKeys(keys.data(), scratch.data(), drawCount);
+	const UINT64 sortTime = sortClock.GetElaspedTime().ToMicroseconds();
+
+	// reference : stable sort on the clamped view depth, far first
+	std::vector<float> depths(drawCount);
+	std::vector<UINT> reference(items);
+
+	for (UINT i = 0; i < drawCount; ++i)
+	{
+		depths[i] = Math::Max(TransparentSort::GetViewDepth(viewMatrix, draws[i].Center), FLT_MIN);
+	}
+
+	Clock referenceClock;
+	std::stable_sort(reference.begin(), reference.end(), [&depths](UINT i_A, UINT i_B) { return depths[i_A] > depths[i_B]; });
+	const UINT64 referenceTime = referenceClock.GetElaspedTime().ToMicroseconds();
+
+	UINT orderErrors = 0;
+
+	for (UINT i = 0; i < drawCount; ++i)
+	{
+		const UINT index = TransparentSort::GetDrawIndex(keys[i]);
+		orderErrors += (index != reference[i]) ? 1 : 0;
+		orderErrors += (i > 0 && depths[index] > depths[TransparentSort::GetDrawIndex(keys[i - 1])]) ? 1 : 0;
+	}
+
+	errors += (orderErrors > 0) ? 1 : 0;
+
+	GetConsole()->Print("transparency check : sorted blending, %u draws, keys %llu us, radix sort %llu us (std::stable_sort %llu us), %u order errors",
+		drawCount, keyTime, sortTime, referenceTime, orderErrors);
+
+	// order independent : grouped by pipeline state in submission order, the draw indices are offset
+	const UINT firstIndex = 100;
+
+	TransparentSort::BuildKeys(TransparentSort::eOrderIndependent, view, draws.data(), drawCount, keys.data(), firstIndex);
+	TransparentSort::SortKeys(keys.data(), scratch.data(), drawCount);
+
+	UINT stateErrors = 0;
+	UINT stateChanges = 0;
+
+	for (UINT i = 0; i < drawCount; ++i)
+	{
+		const UINT index = TransparentSort::GetDrawIndex(keys[i]);
+
+		if (index < firstIndex || index >= firstIndex + drawCount)
+		{
+			++stateErrors;
+			continue;
+		}
+
+		if (i > 0)
+		{
+			const UINT previous = TransparentSort::GetDrawIndex(keys[i - 1]);
+			const UINT state = draws[index - firstIndex].State, previousState = draws[previous - firstIndex].State;
+
+			stateErrors += (state < previousState || (state == previousState && index <= previous)) ? 1 : 0;
+			stateChanges += (state != previousState) ? 1 : 0;
+		}
+	}
+
+	errors += (stateErrors > 0) ? 1 : 0;
+
+	GetConsole()->Print("transparency check : order independent, %u pipeline state changes for %u states, %u errors", stateChanges, stateCount, stateErrors);
+	GetConsole()->Print("transparency check : %u errors", errors);
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -6,6 +6,15 @@
 #include "engine/Engine.h"
 #include "engine/RenderList.h"
 #include "engine/Debug.h"
+#include "engine/CPUProfiler.h"
+#include "engine/SceneFile.h"
+#include "engine/Utils.h"
+#include "resource/ResourceManager.h"
+#include "resource/Mesh.h"
+#include "resource/Material.h"
+#include <map>
+#include <set>
+#include <algorithm>
 
 World::World(const WorldDesc & i_WorldDesc)
 	:m_CurrentCamera(new Camera)
@@ -39,14 +48,318 @@ World::~World()
 {
 }
 
-void World::LoadWorld(const std::string & i_File, bool i_CleanBeforeLoad)
+bool World::LoadWorld(const std::string & i_File, bool i_CleanBeforeLoad)
 {
+	SceneFile scene;
+
+	if (!scene.Read(i_File))
+		return false;
+
 	if (i_CleanBeforeLoad)
 		Clear();
+
+	LoadScene(scene);
+	return true;
+}
+
+bool World::SaveWorld(const std::string & i_OutputFile) const
+{
+	SceneFile scene;
+	BuildScene(scene);
+
+	return scene.Write(i_OutputFile);
+}
+
+void World::LoadScene(const SceneFile & i_Scene)
+{
+	CPU_ZONE("Load Scene");
+
+	SceneLoad load;
+	BeginSceneLoad(i_Scene, load);
+	SpawnSceneActors(load, (UINT)i_Scene.GetActors().size());
+}
+
+void World::BeginSceneLoad(const SceneFile & i_Scene, SceneLoad & o_Load)
+{
+	const std::vector<SceneFile::ActorRecord> & records = i_Scene.GetActors();
+
+	// actor lists are allocated once (the capacity is the limit of a limited world)
+	UINT rootCount = 0;
+	UINT meshCount = 0;
+	UINT lightCount = 0;
+
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		if (records[i].Parent == SceneFile::InvalidIndex)
+			++rootCount;
+		if (records[i].Mesh != SceneFile::InvalidIndex)
+			++meshCount;
+		if (records[i].Light != SceneFile::InvalidIndex)
+			++lightCount;
+	}
+
+	if (!m_LimitedActorCount)
+		m_Actors.reserve(m_Actors.size() + records.size());
+	m_RootActors.reserve(m_RootActors.size() + rootCount);
+
+	// actors and components are allocated in one block per type : the spawn only takes free slots
+	Actor::ReservePool((UINT)records.size());
+	RenderComponent::ReservePool(meshCount);
+	LightComponent::ReservePool(lightCount);
+
+	// resources are resolved once per path (string index)
+	o_Load.Scene			= &i_Scene;
+	o_Load.NextActor		= 0;
+	o_Load.DefaultMaterial	= Engine::GetInstance().GetResourceManager()->GetMaterialByName("Default");
+	o_Load.Actors.assign(records.size(), nullptr);
+	o_Load.Meshes.assign(i_Scene.GetStringCount(), nullptr);
+	o_Load.Materials.assign(i_Scene.GetStringCount(), nullptr);
+	o_Load.CreatedResources.clear();
+	o_Load.Resolved			= false;
 }
 
-void World::SaveWorld(const std::string & i_OutputFile) const
+UINT World::SpawnSceneActors(SceneLoad & io_Load, UINT i_MaxActorCount)
 {
+	ASSERT(io_Load.Scene != nullptr);
+
+	const SceneFile & scene = *io_Load.Scene;
+	const std::vector<SceneFile::ActorRecord> & records = scene.GetActors();
+	const std::vector<SceneFile::LightRecord> & lights = scene.GetLights();
+	ResourceManager * manager = Engine::GetInstance().GetResourceManager();
+
+	// parents are before their children : the parent of a record is already spawned
+	const UINT last = (UINT)Math::Min<size_t>(records.size(), (size_t)io_Load.NextActor + i_MaxActorCount);
+	UINT spawnCount = 0;
+
+	for (UINT i = io_Load.NextActor; i < last; ++i)
+	{
+		const SceneFile::ActorRecord & record = records[i];
+
+		Actor::ActorDesc desc;
+		String::Utf8ToUtf16(desc.Name, scene.GetString(record.Name));
+		desc.Id			= record.Id;
+		desc.NeedTick	= (record.Flags & SceneFile::eActorNeedTick) != 0;
+
+		Actor * parent = (record.Parent != SceneFile::InvalidIndex) ? io_Load.Actors[record.Parent] : nullptr;
+		Actor * actor = SpawnActor(desc, parent);
+
+		if (actor == nullptr)
+			continue;
+
+		io_Load.Actors[i] = actor;
+		++spawnCount;
+
+		const Transform transform(XMFLOAT3(record.Position), XMFLOAT3(record.Rotation), XMFLOAT3(record.Scale));
+		actor->m_Transform			= transform;
+		actor->m_PreviousTransform	= transform;
+		actor->m_Hidden				= (record.Flags & SceneFile::eActorHidden) != 0;
+		actor->m_Enabled			= (record.Flags & SceneFile::eActorDisabled) == 0;
+
+		// render component
+		if (record.Mesh != SceneFile::InvalidIndex)
+		{
+			// the resources loaded by the scene are kept (the streaming release them)
+			if (io_Load.Meshes[record.Mesh] == nullptr && !io_Load.Resolved)
+			{
+				const char * path = scene.GetString(record.Mesh);
+
+				io_Load.Meshes[record.Mesh] = manager->GetMeshByFilename(path);
+				if (io_Load.Meshes[record.Mesh] == nullptr)
+				{
+					io_Load.Meshes[record.Mesh] = manager->LoadMesh(path);
+					if (io_Load.Meshes[record.Mesh] != nullptr)
+						io_Load.CreatedResources.push_back(io_Load.Meshes[record.Mesh]);
+				}
+			}
+
+			if (record.Material != SceneFile::InvalidIndex && io_Load.Materials[record.Material] == nullptr && !io_Load.Resolved)
+			{
+				const char * path = scene.GetString(record.Material);
+
+				// generated materials are loaded with their mesh
+				io_Load.Materials[record.Material] = manager->GetMaterialByFilename(path);
+				if (io_Load.Materials[record.Material] == nullptr)
+					io_Load.Materials[record.Material] = manager->GetGeneratedMaterialByFilename(path);
+				if (io_Load.Materials[record.Material] == nullptr && !String::StartWith(path, "Generated:"))
+				{
+					io_Load.Materials[record.Material] = manager->LoadMaterial(path);
+					if (io_Load.Materials[record.Material] != nullptr)
+						io_Load.CreatedResources.push_back(io_Load.Materials[record.Material]);
+				}
+			}
+
+			const Mesh * mesh = io_Load.Meshes[record.Mesh];
+			const Material * material = (record.Material != SceneFile::InvalidIndex) ? io_Load.Materials[record.Material] : nullptr;
+
+			RenderComponent::RenderComponentDesc componentDesc;
+			componentDesc.Mesh		= (mesh != nullptr && record.SubMesh < mesh->GetMeshCount()) ? mesh->GetMeshBuffer(record.SubMesh) : nullptr;
+			componentDesc.Material	= (material != nullptr) ? material->GetDX12Material(record.SubMaterial) : nullptr;
+
+			if (componentDesc.Material == nullptr && io_Load.DefaultMaterial != nullptr)
+				componentDesc.Material = io_Load.DefaultMaterial->GetDX12Material();
+
+			if (componentDesc.Mesh != nullptr)
+				actor->AttachRenderComponent(componentDesc);
+			else
+				PRINT_DEBUG("Error, unable to get mesh %s [%u]", scene.GetString(record.Mesh), record.SubMesh);
+		}
+
+		// light component
+		if (record.Light != SceneFile::InvalidIndex)
+		{
+			const SceneFile::LightRecord & light = lights[record.Light];
+			const Light::ELightType type = (Light::ELightType)light.Type;
+
+			// directional lights have no range : the component is created as a point light and changed after
+			LightComponent::LightDesc lightDesc;
+			lightDesc.Type			= (type != Light::eDirectionalLight) ? type : Light::ePointLight;
+			lightDesc.Color			= XMFLOAT4(light.Color);
+			lightDesc.Range			= (type != Light::eDirectionalLight) ? light.Range : 1.f;
+			lightDesc.Constant		= light.Constant;
+			lightDesc.Linear		= light.Linear;
+			lightDesc.Quadratic		= light.Quadratic;
+			lightDesc.SoftEdge		= light.SoftEdge;
+			lightDesc.CastShadows	= (light.CastShadows != 0);
+
+			actor->AttachLightComponent(lightDesc);
+
+			// the spot angle is stored as used by the light (cosine)
+			Light * componentLight = actor->GetLightComponent()->GetLight();
+			componentLight->SetType(type);
+			componentLight->SetSpotAngle(light.SpotAngle);
+			componentLight->SetIntensity(light.Intensity);
+		}
+	}
+
+	io_Load.NextActor = last;
+	return spawnCount;
+}
+
+void World::BuildScene(SceneFile & o_Scene) const
+{
+	CPU_ZONE("Build Scene");
+
+	o_Scene.Clear();
+	o_Scene.Reserve((UINT)m_Actors.size(), 0);
+
+	// resource references : path of the resource and index of the buffer
+	struct ResourceReference
+	{
+		UINT	Path;
+		UINT	Index;
+	};
+
+	std::map<const DX12Mesh *, ResourceReference> meshReferences;
+	std::map<const DX12Material *, ResourceReference> materialReferences;
+	const ResourceManager * manager = Engine::GetInstance().GetResourceManager();
+
+	for (size_t i = 0; i < manager->GetResourceCount(ResourceManager::eMesh); ++i)
+	{
+		const Mesh * mesh = manager->GetMeshByIndex(i);
+
+		for (size_t j = 0; mesh != nullptr && j < mesh->GetMeshCount(); ++j)
+		{
+			meshReferences[mesh->GetMeshBuffer(j)] = { o_Scene.AddString(mesh->GetFilepath()), (UINT)j };
+		}
+	}
+
+	for (size_t i = 0; i < manager->GetResourceCount(ResourceManager::eMaterial); ++i)
+	{
+		const Material * material = manager->GetMaterialByIndex(i);
+
+		for (size_t j = 0; material != nullptr && j < material->GetMaterialCount(); ++j)
+		{
+			materialReferences[material->GetDX12Material(j)] = { o_Scene.AddString(material->GetFilepath()), (UINT)j };
+		}
+	}
+
+	// depth first : parents are written before their children
+	std::vector<std::pair<const Actor *, UINT>> stack;
+
+	for (size_t i = m_RootActors.size(); i > 0; --i)
+	{
+		stack.push_back(std::make_pair(m_RootActors[i - 1], (UINT)SceneFile::InvalidIndex));
+	}
+
+	while (!stack.empty())
+	{
+		const Actor * actor	= stack.back().first;
+		const UINT parent	= stack.back().second;
+		stack.pop_back();
+
+		std::string name;
+		String::Utf16ToUtf8(name, actor->GetName());
+
+		SceneFile::ActorRecord record;
+		record.Id			= actor->GetId();
+		record.Parent		= parent;
+		record.Name			= o_Scene.AddString(name);
+		record.Flags		= (actor->m_NeedTick ? SceneFile::eActorNeedTick : 0)
+							| (actor->m_Hidden ? SceneFile::eActorHidden : 0)
+							| (actor->m_Enabled ? 0 : SceneFile::eActorDisabled);
+		record.Mesh			= SceneFile::InvalidIndex;
+		record.SubMesh		= 0;
+		record.Material		= SceneFile::InvalidIndex;
+		record.SubMaterial	= 0;
+		record.Light		= SceneFile::InvalidIndex;
+
+		const XMFLOAT3 position	= actor->m_Transform.GetPosition();
+		const XMFLOAT3 rotation	= actor->m_Transform.GetRotation();
+		const XMFLOAT3 scale	= actor->m_Transform.GetScale();
+		memcpy(record.Position, &position, sizeof(record.Position));
+		memcpy(record.Rotation, &rotation, sizeof(record.Rotation));
+		memcpy(record.Scale, &scale, sizeof(record.Scale));
+
+		// render component
+		const RenderComponent * render = actor->GetRenderComponent();
+
+		if (render != nullptr)
+		{
+			auto mesh = meshReferences.find(render->GetMeshBuffer());
+			auto material = materialReferences.find(render->GetMaterial());
+
+			if (mesh != meshReferences.end())
+			{
+				record.Mesh		= mesh->second.Path;
+				record.SubMesh	= mesh->second.Index;
+			}
+
+			if (material != materialReferences.end())
+			{
+				record.Material		= material->second.Path;
+				record.SubMaterial	= material->second.Index;
+			}
+		}
+
+		// light component
+		const LightComponent * lightComponent = actor->GetLightComponent();
+
+		if (lightComponent != nullptr)
+		{
+			const Light * light = lightComponent->GetLight();
+
+			SceneFile::LightRecord lightRecord;
+			lightRecord.Type		= (UINT)light->GetType();
+			lightRecord.Intensity	= light->GetIntensity();
+			lightRecord.Range		= (light->GetType() != Light::eDirectionalLight) ? light->GetRange() : 0.f;
+			lightRecord.Constant	= light->GetConstant();
+			lightRecord.Linear		= light->GetLinear();
+			lightRecord.Quadratic	= light->GetQuadratic();
+			lightRecord.SpotAngle	= light->GetSpotAngle();
+			lightRecord.SoftEdge	= light->GetEdgeCutoff();
+			lightRecord.CastShadows	= light->IsCastingShadows() ? 1 : 0;
+			memcpy(lightRecord.Color, &light->GetColor(), sizeof(lightRecord.Color));
+
+			record.Light = o_Scene.AddLight(lightRecord);
+		}
+
+		const UINT index = o_Scene.AddActor(record);
+
+		for (size_t i = actor->m_Children.size(); i > 0; --i)
+		{
+			stack.push_back(std::make_pair(actor->m_Children[i - 1], index));
+		}
+	}
 }
 
 float World::GetFrameTime() const
@@ -89,7 +402,7 @@ Actor * World::SpawnActor(const Actor::ActorDesc & i_Desc, Actor * i_Parent)
 	m_Actors.push_back(newActor);
 
 	// add actor to the parent if needed
-	if (i_Parent = nullptr)
+	if (i_Parent != nullptr)
 	{
 		newActor->m_Parent = i_Parent;
 		i_Parent->m_Children.push_back(newActor);
@@ -112,8 +425,9 @@ Actor * World::SpawnActor(const Actor::ActorDesc & i_Desc, const Transform & i_T
 	Actor * newActor = SpawnActor(i_Desc, i_Parent);
 	if (newActor != nullptr)
 	{
-		// setup the transform of the actor
+		// setup the transform of the actor (no interpolation from the default transform)
 		newActor->m_Transform = i_Transform;
+		newActor->m_PreviousTransform = i_Transform;
 	}
 	return newActor;
 }
@@ -177,6 +491,51 @@ bool World::DeleteActor(Actor * i_ActorToRemove, bool i_RemoveChildren)
 	return true;
 }
 
+UINT World::DeleteActors(const std::vector<Actor *> & i_Actors)
+{
+	// the actors and their children
+	std::vector<Actor *> actors;
+	std::set<Actor *> deleted;
+
+	for (size_t i = 0; i < i_Actors.size(); ++i)
+	{
+		actors.push_back(i_Actors[i]);
+
+		while (!actors.empty())
+		{
+			Actor * actor = actors.back();
+			actors.pop_back();
+
+			if (!deleted.insert(actor).second)
+				continue;
+
+			actors.insert(actors.end(), actor->m_Children.begin(), actor->m_Children.end());
+		}
+	}
+
+	// remove the actors from the parents that are kept
+	for (auto itr = deleted.begin(); itr != deleted.end(); ++itr)
+	{
+		Actor * parent = (*itr)->m_Parent;
+
+		if (parent != nullptr && deleted.find(parent) == deleted.end())
+			parent->m_Children.erase(std::remove(parent->m_Children.begin(), parent->m_Children.end(), *itr), parent->m_Children.end());
+	}
+
+	// one pass over the world lists
+	auto isDeleted = [&deleted](Actor * i_Actor) { return deleted.find(i_Actor) != deleted.end(); };
+	m_Actors.erase(std::remove_if(m_Actors.begin(), m_Actors.end(), isDeleted), m_Actors.end());
+	m_RootActors.erase(std::remove_if(m_RootActors.begin(), m_RootActors.end(), isDeleted), m_RootActors.end());
+
+	for (auto itr = deleted.begin(); itr != deleted.end(); ++itr)
+	{
+		(*itr)->Destroyed();
+		delete (*itr);
+	}
+
+	return (UINT)deleted.size();
+}
+
 bool World::AttachActor(Actor * i_Parent, Actor * i_Child)
 {
 	if (i_Parent == nullptr || i_Child == nullptr)
@@ -356,6 +715,8 @@ void World::Clear()
 
 void World::TickWorld(float i_Elapsed)
 {
+	CPU_ZONE("Tick World");
+
 	// save elapsed time
 	m_FrameTime = i_Elapsed;
 
@@ -378,6 +739,14 @@ void World::TickWorld(float i_Elapsed)
 	}
 }
 
+void World::SaveTransforms()
+{
+	for (size_t i = 0; i < m_Actors.size(); ++i)
+	{
+		m_Actors[i]->m_PreviousTransform = m_Actors[i]->m_Transform;
+	}
+}
+
 #ifdef WITH_EDITOR
 void World::TickCamera(float i_Elapsed)
 {
@@ -391,14 +760,41 @@ void World::TickCamera(float i_Elapsed)
 
 void World::RenderWorld(RenderList * i_RenderList) const
 {
-	// take all root actors
-	for (size_t i = 0; i < m_RootActors.size(); ++i)
+	CPU_ZONE("Render World");
+
+	CommandRecorder * recorder = i_RenderList->GetCommandRecorder();
+	const UINT workerCount = recorder->GetWorkerCount();
+
+	// contiguous ranges of root actors in worker order : the merged components keep the order of a serial traversal
+	std::vector<CommandRecorder::DrawRange> ranges;
+	CommandRecorder::Partition((UINT)m_RootActors.size(), workerCount, MIN_SUBMIT_ROOT, ranges);
+
+	i_RenderList->BeginSubmit(workerCount);
+
+	RenderRecorder renderRecorder(this, i_RenderList);
+	recorder->Record(ranges, &renderRecorder);
+
+	i_RenderList->EndSubmit();
+}
+
+World::RenderRecorder::RenderRecorder(const World * i_World, RenderList * i_RenderList)
+	:m_World(i_World)
+	,m_RenderList(i_RenderList)
+{
+}
+
+void World::RenderRecorder::RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range)
+{
+	CPU_ZONE("Render Actors");
+
+	// take the root actors of the range
+	for (UINT i = i_Range.First; i < i_Range.First + i_Range.Count; ++i)
 	{
-		RenderActor(m_RootActors[i], i_RenderList);
+		m_World->RenderActor(m_World->m_RootActors[i], m_RenderList, i_Worker);
 	}
 }
 
-void World::RenderActor(const Actor * i_Actor, RenderList * i_RenderList) const
+void World::RenderActor(const Actor * i_Actor, RenderList * i_RenderList, UINT i_Worker) const
 {
 	// if the actor is hidden, we do not render his other children
 	if (i_Actor->IsHidden())
@@ -415,7 +811,7 @@ void World::RenderActor(const Actor * i_Actor, RenderList * i_RenderList) const
 
 		if (mesh != nullptr && mesh->IsEnabled())
 		{
-			i_RenderList->PushRenderComponent(mesh);
+			i_RenderList->PushRenderComponent(i_Worker, mesh);
 		}
 
 		// the actor have a light component attached to him
@@ -424,7 +820,15 @@ void World::RenderActor(const Actor * i_Actor, RenderList * i_RenderList) const
 
 		if (light != nullptr && light->IsEnabled())
 		{
-			i_RenderList->PushLightComponent(light);
+			i_RenderList->PushLightComponent(i_Worker, light);
+		}
+
+		// the particles are simulated and drawn in the semi transparent pass
+		ParticleComponent * particles = i_Actor->GetParticleComponent();
+
+		if (particles != nullptr && particles->IsEnabled())
+		{
+			i_RenderList->PushParticleComponent(i_Worker, particles);
 		}
 	}
 
@@ -434,6 +838,6 @@ void World::RenderActor(const Actor * i_Actor, RenderList * i_RenderList) const
 	for (size_t i = 0; i < children->size(); ++i)
 	{
 		// render actor if needed
-		RenderActor((*children)[i], i_RenderList);
+		RenderActor((*children)[i], i_RenderList, i_Worker);
 	}
 }
@@ -7,10 +7,18 @@
 #include <vector>
 
 #include "Actor.h"
+#include "engine/CommandRecorder.h"
 #include "dx12/DX12Utils.h"
 
+// define
+#define			MIN_SUBMIT_ROOT			16		// root actors traversed by a worker before using another worker
+
 class Camera;
 class RenderList;
+class SceneFile;
+class Resource;
+class Mesh;
+class Material;
 
 class World
 {
@@ -30,9 +38,26 @@ public:
 	World(const WorldDesc & i_WorldDesc);
 	~World();
 
-	// load world
-	void	LoadWorld(const std::string & i_File, bool i_CleanBeforeLoad = true);
-	void	SaveWorld(const std::string & i_OutputFile) const;
+	// load world (scene file, see SceneFile)
+	bool	LoadWorld(const std::string & i_File, bool i_CleanBeforeLoad = true);
+	bool	SaveWorld(const std::string & i_OutputFile) const;
+	void	LoadScene(const SceneFile & i_Scene);	// spawn the actors of a scene
+	void	BuildScene(SceneFile & o_Scene) const;	// records of the actors of the world
+
+	// incremental scene load : the actors of the scene are spawned by ranges (the scene must be kept during the load)
+	struct SceneLoad
+	{
+		const SceneFile *			Scene = nullptr;
+		UINT						NextActor = 0;		// next record to spawn
+		std::vector<Actor *>		Actors;				// spawned actor of each record
+		std::vector<Mesh *>			Meshes;				// resources resolved by the load (string index)
+		std::vector<Material *>		Materials;
+		std::vector<Resource *>		CreatedResources;	// resources that were not loaded before the load
+		const Material *			DefaultMaterial = nullptr;
+		bool						Resolved = false;	// the resources are resolved before the spawn (missing ones are not loaded by the spawn)
+	};
+	void	BeginSceneLoad(const SceneFile & i_Scene, SceneLoad & o_Load);
+	UINT	SpawnSceneActors(SceneLoad & io_Load, UINT i_MaxActorCount);	// spawn the next actors, return the spawned actor count
 
 
 	// world public functions can be called by actors
@@ -49,6 +74,7 @@ public:
 	Actor *	SpawnActor(const Actor::ActorDesc & i_Desc, Actor * i_Parent = nullptr);
 	Actor *	SpawnActor(const Actor::ActorDesc & i_Desc, const Transform & i_Transform, Actor * i_Parent = nullptr);	// Warning : the transform is relative to the parent
 	bool	DeleteActor(Actor * i_ActorToRemove, bool i_RemoveChildren = true);
+	UINT	DeleteActors(const std::vector<Actor *> & i_Actors);	// delete the actors and their children (one pass over the world lists)
 
 	bool	AttachActor(Actor * i_Parent, Actor * i_Child);
 	bool	DetachActor(Actor * i_ActorToDetach);
@@ -73,14 +99,27 @@ private:
 
 	// call by engine class (this tick each actor that need a tick)
 	void		TickWorld(float i_Elapsed);
+	void		SaveTransforms();	// transforms of the previous fixed step (render interpolation)
 #ifdef WITH_EDITOR
 	void		TickCamera(float i_Elapsed);
 #endif
 
-	void		RenderWorld(RenderList * i_RenderList) const;
+	void		RenderWorld(RenderList * i_RenderList) const;	// the root actors are traversed in parallel on the workers of the render list
 
 	// internal call
-	void		RenderActor(const Actor * i_Actor, RenderList  * i_RenderList) const;
+	void		RenderActor(const Actor * i_Actor, RenderList  * i_RenderList, UINT i_Worker) const;
+
+	// traverse a range of root actors on a worker
+	class RenderRecorder : public CommandRecorder::Recorder
+	{
+	public:
+		RenderRecorder(const World * i_World, RenderList * i_RenderList);
+		virtual void	RecordRange(UINT i_Worker, const CommandRecorder::DrawRange & i_Range) override;
+
+	private:
+		const World *	m_World;
+		RenderList *	m_RenderList;
+	};
 
 	// actors management
 	std::vector<Actor *>	m_RootActors;
@@ -109,7 +148,7 @@ _Actor * World::SpawnActor(Actor * i_Parent /* = nullptr */)
 	m_Actors.push_back(newActor);
 
 	// add actor to the parent if needed
-	if (i_Parent = nullptr)
+	if (i_Parent != nullptr)
 	{
 		newActor->m_Parent = i_Parent;
 		i_Parent->m_Children.push_back(newActor);
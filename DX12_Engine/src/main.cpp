@@ -6,6 +6,7 @@
 #include "engine/Actor.h"
 // WinMain
 #include <Windows.h>
+#include <string.h>
 
 int WINAPI WinMain(
 	HINSTANCE hInstance,    //Main windows function
@@ -19,6 +20,8 @@ int WINAPI WinMain(
 	desc.HInstance				= hInstance;
 	desc.FramePerSecondTargeted = 60;
 	desc.CameraPosition			= XMFLOAT4(0.f, 1.f, 5.f, 0.f);
+	// headless run for automated runs (no window, no GPU, Windows only) : DX12_Engine.exe -headless
+	desc.Headless				= (strstr(lpCmdLine, "-headless") != nullptr);
 
 	// create the engine singleton
 	Engine::Create();
@@ -0,0 +1,331 @@
+#include "AnimationClip.h"
+
+#include "resource/Skeleton.h"
+#include "engine/Debug.h"
+#include <stdio.h>
+#include <math.h>
+
+using namespace Animation;
+
+// compression thresholds : channels closer than this to their first key are constant
+static const float	s_ConstantRotationDot	= 1.f - 1e-6f;
+static const float	s_ConstantRange			= 1e-5f;
+
+// smallest three : the components that are not the largest one are in [-1/sqrt(2), 1/sqrt(2)]
+static const float	s_SmallestThreeRange	= 0.70710678f;
+
+void AnimationClip::Sample(float i_Time, bool i_Loop, BoneTransform * o_Pose) const
+{
+	// frames around the time
+	const UINT lastFrame = m_FrameCount - 1;
+	float position = i_Time * m_SampleRate;
+
+	if (i_Loop && lastFrame > 0)
+	{
+		// the last frame of a looped clip is its first frame
+		position = fmodf(position, (float)lastFrame);
+		if (position < 0.f)		position += (float)lastFrame;
+	}
+	else
+	{
+		position = (position < 0.f) ? 0.f : ((position > (float)lastFrame) ? (float)lastFrame : position);
+	}
+
+	const UINT frame0 = ((UINT)position < lastFrame) ? (UINT)position : lastFrame;
+	const UINT frame1 = (frame0 < lastFrame) ? frame0 + 1 : lastFrame;
+	const XMVECTOR weight = XMVectorReplicate(position - (float)frame0);
+
+	const XMUSHORTN4 * keys0 = m_Keys.data() + frame0 * m_FrameStride;
+	const XMUSHORTN4 * keys1 = m_Keys.data() + frame1 * m_FrameStride;
+
+	for (size_t i = 0; i < m_Tracks.size(); ++i)
+	{
+		const Track & track = m_Tracks[i];
+		BoneTransform & bone = o_Pose[i];
+
+		// rotation : normalized lerp on the shortest path (q and -q are the same rotation)
+		if (track.RotationKey == ConstantChannel)
+		{
+			bone.Rotation = XMLoadFloat4(&track.Rotation);
+		}
+		else
+		{
+			const XMVECTOR rotation0 = DecodeRotation(keys0[track.RotationKey]);
+			XMVECTOR rotation1 = DecodeRotation(keys1[track.RotationKey]);
+
+			rotation1 = XMVectorSelect(rotation1, XMVectorNegate(rotation1), XMVectorLess(XMVector4Dot(rotation0, rotation1), XMVectorZero()));
+			bone.Rotation = XMQuaternionNormalize(XMVectorLerpV(rotation0, rotation1, weight));
+		}
+
+		// translation and scale : the quantized keys are interpolated then moved in the range of the track
+		if (track.TranslationKey == ConstantChannel)
+		{
+			bone.Translation = XMLoadFloat3(&track.Translation);
+		}
+		else
+		{
+			const XMVECTOR key = XMVectorLerpV(XMLoadUShortN4(&keys0[track.TranslationKey]), XMLoadUShortN4(&keys1[track.TranslationKey]), weight);
+			bone.Translation = XMVectorMultiplyAdd(key, XMLoadFloat3(&track.TranslationExtent), XMLoadFloat3(&track.TranslationMin));
+		}
+
+		if (track.ScaleKey == ConstantChannel)
+		{
+			bone.Scale = XMLoadFloat3(&track.Scale);
+		}
+		else
+		{
+			const XMVECTOR key = XMVectorLerpV(XMLoadUShortN4(&keys0[track.ScaleKey]), XMLoadUShortN4(&keys1[track.ScaleKey]), weight);
+			bone.Scale = XMVectorMultiplyAdd(key, XMLoadFloat3(&track.ScaleExtent), XMLoadFloat3(&track.ScaleMin));
+		}
+	}
+}
+
+UINT AnimationClip::GetBoneCount() const
+{
+	return (UINT)m_Tracks.size();
+}
+
+UINT AnimationClip::GetFrameCount() const
+{
+	return m_FrameCount;
+}
+
+float AnimationClip::GetSampleRate() const
+{
+	return m_SampleRate;
+}
+
+float AnimationClip::GetDuration() const
+{
+	return (m_FrameCount > 1) ? (float)(m_FrameCount - 1) / m_SampleRate : 0.f;
+}
+
+size_t AnimationClip::GetCompressedSize() const
+{
+	return m_Tracks.size() * sizeof(Track) + m_Keys.size() * sizeof(XMUSHORTN4);
+}
+
+size_t AnimationClip::GetRawSize() const
+{
+	return (size_t)m_FrameCount * m_Tracks.size() * sizeof(KeyRecord);
+}
+
+AnimationClip::AnimationClip()
+	:Resource()
+	,m_FrameStride(0)
+	,m_FrameCount(0)
+	,m_SampleRate(0.f)
+{
+}
+
+AnimationClip::~AnimationClip()
+{
+}
+
+void AnimationClip::LoadFromFile(const std::string & i_Filepath)
+{
+	ClipData data;
+	data.Filepath	= i_Filepath;
+	data.Name		= ExtractFileName(i_Filepath);
+
+	FILE * file = nullptr;
+	if (fopen_s(&file, i_Filepath.c_str(), "rb") != 0 || file == nullptr)
+	{
+		PRINT_DEBUG("[AnimationClip] unable to open %s", i_Filepath.c_str());
+		return;
+	}
+
+	Header header;
+	bool read = (fread(&header, sizeof(Header), 1, file) == 1)
+		&& header.Magic == ANIMATION_FILE_MAGIC
+		&& header.Version == ANIMATION_FILE_VERSION
+		&& header.BoneCount > 0 && header.BoneCount <= SKELETON_MAX_BONES
+		&& header.FrameCount > 0;
+
+	std::vector<KeyRecord> records(read ? (size_t)header.FrameCount * header.BoneCount : 0);
+	read = read && (fread(records.data(), sizeof(KeyRecord), records.size(), file) == records.size());
+	fclose(file);
+
+	if (!read)
+	{
+		PRINT_DEBUG("[AnimationClip] %s is not a valid animation file", i_Filepath.c_str());
+		return;
+	}
+
+	data.SampleRate	= header.SampleRate;
+	data.FrameCount	= header.FrameCount;
+	data.BoneCount	= header.BoneCount;
+	data.Keys.resize(records.size());
+
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		data.Keys[i].Rotation		= XMFLOAT4(records[i].Rotation);
+		data.Keys[i].Translation	= XMFLOAT3(records[i].Translation);
+		data.Keys[i].Scale			= XMFLOAT3(records[i].Scale);
+	}
+
+	LoadFromData(&data);
+}
+
+void AnimationClip::LoadFromData(const void * i_Data)
+{
+	const ClipData * data = (const ClipData*)i_Data;
+
+	if (data->Name != "")		m_Name = data->Name;
+	if (data->Filepath != "")	m_Filepath = data->Filepath;
+
+	if (Compress(*data))
+		NotifyFinishLoad();
+}
+
+bool AnimationClip::Compress(const ClipData & i_Data)
+{
+	if (i_Data.BoneCount == 0 || i_Data.BoneCount > SKELETON_MAX_BONES || i_Data.FrameCount == 0 || i_Data.SampleRate <= 0.f
+		|| i_Data.Keys.size() != (size_t)i_Data.FrameCount * i_Data.BoneCount)
+	{
+		PRINT_DEBUG("[AnimationClip] %s : invalid clip data", m_Name.c_str());
+		return false;
+	}
+
+	const UINT boneCount = i_Data.BoneCount;
+	m_FrameCount	= i_Data.FrameCount;
+	m_SampleRate	= i_Data.SampleRate;
+	m_Tracks.resize(boneCount);
+
+	// find the constant channels and the quantization range of the animated ones
+	UINT rotationCount = 0, translationCount = 0, scaleCount = 0;
+
+	for (UINT bone = 0; bone < boneCount; ++bone)
+	{
+		Track & track = m_Tracks[bone];
+		const Key & first = i_Data.Keys[bone];
+		const XMVECTOR firstRotation = XMQuaternionNormalize(XMLoadFloat4(&first.Rotation));
+
+		XMVECTOR translationMin = XMLoadFloat3(&first.Translation), translationMax = translationMin;
+		XMVECTOR scaleMin = XMLoadFloat3(&first.Scale), scaleMax = scaleMin;
+		bool constantRotation = true;
+
+		for (UINT frame = 1; frame < m_FrameCount; ++frame)
+		{
+			const Key & key = i_Data.Keys[frame * boneCount + bone];
+			const XMVECTOR rotation = XMQuaternionNormalize(XMLoadFloat4(&key.Rotation));
+
+			constantRotation = constantRotation && (fabsf(XMVectorGetX(XMVector4Dot(rotation, firstRotation))) >= s_ConstantRotationDot);
+			translationMin	= XMVectorMin(translationMin, XMLoadFloat3(&key.Translation));
+			translationMax	= XMVectorMax(translationMax, XMLoadFloat3(&key.Translation));
+			scaleMin		= XMVectorMin(scaleMin, XMLoadFloat3(&key.Scale));
+			scaleMax		= XMVectorMax(scaleMax, XMLoadFloat3(&key.Scale));
+		}
+
+		const XMVECTOR constantRange = XMVectorReplicate(s_ConstantRange);
+		const bool constantTranslation	= XMVector3Less(XMVectorSubtract(translationMax, translationMin), constantRange);
+		const bool constantScale		= XMVector3Less(XMVectorSubtract(scaleMax, scaleMin), constantRange);
+
+		XMStoreFloat4(&track.Rotation, firstRotation);
+		XMStoreFloat3(&track.Translation, XMLoadFloat3(&first.Translation));
+		XMStoreFloat3(&track.Scale, XMLoadFloat3(&first.Scale));
+		XMStoreFloat3(&track.TranslationMin, translationMin);
+		XMStoreFloat3(&track.TranslationExtent, XMVectorSubtract(translationMax, translationMin));
+		XMStoreFloat3(&track.ScaleMin, scaleMin);
+		XMStoreFloat3(&track.ScaleExtent, XMVectorSubtract(scaleMax, scaleMin));
+
+		track.RotationKey		= constantRotation ? ConstantChannel : rotationCount++;
+		track.TranslationKey	= constantTranslation ? ConstantChannel : translationCount++;
+		track.ScaleKey			= constantScale ? ConstantChannel : scaleCount++;
+	}
+
+	// a frame is the animated rotations, then the translations, then the scales
+	for (UINT bone = 0; bone < boneCount; ++bone)
+	{
+		Track & track = m_Tracks[bone];
+		if (track.TranslationKey != ConstantChannel)	track.TranslationKey += rotationCount;
+		if (track.ScaleKey != ConstantChannel)			track.ScaleKey += rotationCount + translationCount;
+	}
+
+	m_FrameStride = rotationCount + translationCount + scaleCount;
+	m_Keys.resize((size_t)m_FrameCount * m_FrameStride);
+
+	for (UINT frame = 0; frame < m_FrameCount; ++frame)
+	{
+		XMUSHORTN4 * keys = m_Keys.data() + frame * m_FrameStride;
+
+		for (UINT bone = 0; bone < boneCount; ++bone)
+		{
+			const Track & track = m_Tracks[bone];
+			const Key & key = i_Data.Keys[frame * boneCount + bone];
+
+			if (track.RotationKey != ConstantChannel)
+			{
+				keys[track.RotationKey] = EncodeRotation(XMLoadFloat4(&key.Rotation));
+			}
+
+			// extents of the animated channels are not null (see s_ConstantRange)
+			if (track.TranslationKey != ConstantChannel)
+			{
+				const XMVECTOR translation = XMVectorDivide(XMVectorSubtract(XMLoadFloat3(&key.Translation), XMLoadFloat3(&track.TranslationMin)),
+					XMVectorSelect(XMVectorSplatOne(), XMLoadFloat3(&track.TranslationExtent), g_XMSelect1110));
+				XMStoreUShortN4(&keys[track.TranslationKey], translation);
+			}
+
+			if (track.ScaleKey != ConstantChannel)
+			{
+				const XMVECTOR scale = XMVectorDivide(XMVectorSubtract(XMLoadFloat3(&key.Scale), XMLoadFloat3(&track.ScaleMin)),
+					XMVectorSelect(XMVectorSplatOne(), XMLoadFloat3(&track.ScaleExtent), g_XMSelect1110));
+				XMStoreUShortN4(&keys[track.ScaleKey], scale);
+			}
+		}
+	}
+
+	return true;
+}
+
+XMUSHORTN4 AnimationClip::EncodeRotation(FXMVECTOR i_Rotation)
+{
+	XMFLOAT4 rotation;
+	XMStoreFloat4(&rotation, XMQuaternionNormalize(i_Rotation));
+	const float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+
+	// the largest component is dropped and rebuilt from the others, its sign is positive (q and -q are the same rotation)
+	UINT largest = 0;
+	for (UINT i = 1; i < 4; ++i)
+	{
+		if (fabsf(components[i]) > fabsf(components[largest]))
+			largest = i;
+	}
+
+	const float sign = (components[largest] < 0.f) ? -1.f : 1.f;
+	float smallest[3];
+
+	for (UINT i = 0, j = 0; i < 4; ++i)
+	{
+		if (i != largest)
+			smallest[j++] = components[i] * sign;
+	}
+
+	// [-range, range] to [0, 1]
+	const XMVECTOR packed = XMVectorMultiplyAdd(XMVectorSet(smallest[0], smallest[1], smallest[2], 0.f),
+		XMVectorReplicate(0.5f / s_SmallestThreeRange), XMVectorReplicate(0.5f));
+
+	XMUSHORTN4 key;
+	XMStoreUShortN4(&key, packed);
+	key.w = (USHORT)largest;
+
+	return key;
+}
+
+FORCEINLINE XMVECTOR AnimationClip::DecodeRotation(const XMUSHORTN4 & i_Key)
+{
+	// [0, 1] to [-range, range], the dropped component is sqrt(1 - dot(smallest, smallest))
+	XMVECTOR smallest = XMVectorMultiplyAdd(XMLoadUShortN4(&i_Key), XMVectorReplicate(2.f * s_SmallestThreeRange), XMVectorReplicate(-s_SmallestThreeRange));
+	const XMVECTOR largest = XMVectorSqrt(XMVectorMax(XMVectorZero(), XMVectorSubtract(XMVectorSplatOne(), XMVector3Dot(smallest, smallest))));
+	const XMVECTOR rotation = XMVectorSelect(largest, smallest, g_XMSelect1110);
+
+	// put the dropped component back at its index
+	switch (i_Key.w)
+	{
+	case 0:		return XMVectorSwizzle<XM_SWIZZLE_W, XM_SWIZZLE_X, XM_SWIZZLE_Y, XM_SWIZZLE_Z>(rotation);
+	case 1:		return XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_W, XM_SWIZZLE_Y, XM_SWIZZLE_Z>(rotation);
+	case 2:		return XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Y, XM_SWIZZLE_W, XM_SWIZZLE_Z>(rotation);
+	default:	return rotation;
+	}
+}
@@ -0,0 +1,104 @@
+// Animation clip management
+// a clip is a track of keys per bone of a skeleton, sampled at a fixed rate
+// keys are compressed on load : rotations are smallest three quaternions (3 x 16 bits, the index of the dropped component in the last 16 bits)
+// translations and scales are quantized on 16 bits in the range of their track, constant channels keep one full precision key
+// animated keys are stored frame after frame : sampling a frame reads contiguous memory for all bones
+// file (.anim) : header and raw keys (frame after frame, bone after bone), compressed when loaded
+
+#pragma once
+
+#include "Resource.h"
+#include "engine/Animation.h"
+#include <DirectXPackedVector.h>
+#include <vector>
+
+using namespace DirectX::PackedVector;
+
+#define ANIMATION_FILE_MAGIC		0x4D4E4144	// "DANM"
+#define ANIMATION_FILE_VERSION		1
+
+class AnimationClip : public Resource
+{
+public:
+	// raw key of a bone
+	struct Key
+	{
+		XMFLOAT4		Rotation = XMFLOAT4(0.f, 0.f, 0.f, 1.f);
+		XMFLOAT3		Translation = XMFLOAT3(0.f, 0.f, 0.f);
+		XMFLOAT3		Scale = XMFLOAT3(1.f, 1.f, 1.f);
+	};
+
+	// generated clip (see ResourceManager::LoadAnimationWithData)
+	struct ClipData
+	{
+		std::string			Name, Filepath;
+		float				SampleRate = 30.f;	// frames per second
+		UINT				FrameCount = 0;
+		UINT				BoneCount = 0;
+		std::vector<Key>	Keys;				// frame count x bone count keys (frame after frame)
+	};
+
+	// sampling : o_Pose is bone count transforms, the time is looped or clamped in the clip
+	void		Sample(float i_Time, bool i_Loop, Animation::BoneTransform * o_Pose) const;
+
+	// information
+	UINT		GetBoneCount() const;
+	UINT		GetFrameCount() const;
+	float		GetSampleRate() const;
+	float		GetDuration() const;
+	size_t		GetCompressedSize() const;	// bytes of the keys
+	size_t		GetRawSize() const;			// bytes of the raw keys
+
+	friend class ResourceManager;
+protected:
+	AnimationClip();
+	~AnimationClip();
+
+	// Inherited via Resource
+	virtual void LoadFromFile(const std::string & i_Filepath) override;
+	virtual void LoadFromData(const void * i_Data) override;
+
+private:
+	static const UINT	ConstantChannel = (UINT)-1;
+
+	// file records
+	struct Header
+	{
+		UINT		Magic;
+		UINT		Version;
+		UINT		BoneCount;
+		UINT		FrameCount;
+		float		SampleRate;
+		UINT		Reserved[3];
+	};
+
+	struct KeyRecord
+	{
+		float		Rotation[4];
+		float		Translation[3];
+		float		Scale[3];
+	};
+
+	// channels of a bone : a constant key or the index of the animated key in a frame
+	struct Track
+	{
+		XMFLOAT4		Rotation;			// constant channels
+		XMFLOAT3		Translation;
+		XMFLOAT3		Scale;
+		XMFLOAT3		TranslationMin, TranslationExtent;	// quantization range
+		XMFLOAT3		ScaleMin, ScaleExtent;
+		UINT			RotationKey, TranslationKey, ScaleKey;	// ConstantChannel : the channel is constant
+	};
+
+	bool		Compress(const ClipData & i_Data);
+
+	// compression helpers
+	static XMUSHORTN4	EncodeRotation(FXMVECTOR i_Rotation);
+	static XMVECTOR		DecodeRotation(const XMUSHORTN4 & i_Key);
+
+	std::vector<Track>			m_Tracks;
+	std::vector<XMUSHORTN4>		m_Keys;		// animated keys : frame count x frame stride keys
+	UINT						m_FrameStride;	// animated keys of a frame
+	UINT						m_FrameCount;
+	float						m_SampleRate;
+};
@@ -6,15 +6,43 @@
 #include "dx12/DX12RenderTarget.h"
 #include "dx12/DX12DepthBuffer.h"
 #include "dx12/DX12ConstantBuffer.h"
+#include "dx12/DX12ShaderCache.h"
 #include "dx12/DX12Utils.h"
+#include "dx12/DX12BindlessHeap.h"
+#include "dx12/DX12GPUCulling.h"
+#include "dx12/DX12Transparency.h"
+#include "resource/DX12Texture.h"
+
+// permutation defines
+const DX12ShaderCache::PermutationDefine DX12Material::s_FeatureDefines[] =
+{
+	{ DX12Material::eAmbientMap,	"MAP_AMBIENT" },
+	{ DX12Material::eDiffuseMap,	"MAP_DIFFUSE" },
+	{ DX12Material::eSpecularMap,	"MAP_SPECULAR" },
+	{ DX12Material::eGBufferPacked,	"GBUFFER_PACKED" },
+	{ DX12Material::eIndirectDraw,	"INDIRECT_DRAW" },
+	{ DX12Material::eForwardPass,	"FORWARD_PASS" },
+	{ DX12Material::eForwardOIT,	"FORWARD_OIT" },
+};
+
+const UINT DX12Material::s_FeatureDefineCount = _countof(DX12Material::s_FeatureDefines);
+
+const wchar_t * const DX12Material::s_DefaultPixelShader = L"src/shaders/rendering/GBufferPS.hlsl";
 
 DX12Material::DX12Material()
 	:DX12Resource()
-	,m_ConstantBuffer(nullptr)
-	,m_PipelineState(nullptr)
 	,m_RootSignature(nullptr)
-	,m_BufferAddress(UnavailableAdressId)
+	,m_PipelineStates()
+	,m_Parent(nullptr)
+	,m_FeatureFlags(eNoFeature)
+	,m_PixelShader(s_DefaultPixelShader)
+	,m_ParameterBlock(DX12MaterialParameterBuffer::InvalidBlock)
+	,m_Data()
 {
+	for (UINT i = 0; i < eTextureSlotCount; ++i)
+	{
+		m_Textures[i] = nullptr;
+	}
 }
 
 DX12Material::~DX12Material()
@@ -22,32 +50,228 @@ DX12Material::~DX12Material()
 	Release();
 }
 
-void DX12Material::PushPipelineState(ID3D12GraphicsCommandList * i_CommandList) const
+void DX12Material::PushPipelineState(ID3D12GraphicsCommandList * i_CommandList, UINT64 i_ElementFlags, bool i_IndirectDraw) const
 {
+	// instances use the pipeline states of the parent
+	if (m_Parent != nullptr)
+	{
+		m_Parent->PushPipelineState(i_CommandList, i_ElementFlags, i_IndirectDraw);
+		return;
+	}
+
+	DX12PipelineState * pipelineState = GetPipelineState(i_ElementFlags, i_IndirectDraw ? eIndirectDraw : eNoFeature);
+
+	// the permutation is created before the draw (see PreparePipelineState)
+	ASSERT(pipelineState != nullptr);
+
+	if (pipelineState == nullptr)
+		return;
+
 	// add pso and root signature to the commandlist
 	i_CommandList->SetGraphicsRootSignature(m_RootSignature->GetRootSignature());
 	// Setup the pipeline state
-	i_CommandList->SetPipelineState(m_PipelineState->GetPipelineState());
+	i_CommandList->SetPipelineState(pipelineState->GetPipelineState());
+}
+
+bool DX12Material::PreparePipelineState(UINT64 i_ElementFlags, bool i_IndirectDraw) const
+{
+	if (m_Parent != nullptr)
+		return m_Parent->PreparePipelineState(i_ElementFlags, i_IndirectDraw);
+
+	return GetPipelineState(i_ElementFlags, i_IndirectDraw ? eIndirectDraw : eNoFeature) != nullptr;
+}
+
+void DX12Material::PushForwardPipelineState(ID3D12GraphicsCommandList * i_CommandList, UINT64 i_ElementFlags, bool i_OrderIndependent) const
+{
+	if (m_Parent != nullptr)
+	{
+		m_Parent->PushForwardPipelineState(i_CommandList, i_ElementFlags, i_OrderIndependent);
+		return;
+	}
+
+	DX12PipelineState * pipelineState = GetPipelineState(i_ElementFlags, eForwardPass | (i_OrderIndependent ? eForwardOIT : eNoFeature));
+
+	// the permutation is created before the draw (see PrepareForwardPipelineState)
+	ASSERT(pipelineState != nullptr);
+
+	if (pipelineState == nullptr)
+		return;
+
+	i_CommandList->SetGraphicsRootSignature(m_RootSignature->GetRootSignature());
+	i_CommandList->SetPipelineState(pipelineState->GetPipelineState());
+}
+
+void DX12Material::PushForwardLighting(ID3D12GraphicsCommandList * i_CommandList, const ForwardLighting & i_Lighting) const
+{
+	// same root signature for the instances
+	i_CommandList->SetGraphicsRootConstantBufferView(eSceneDataRoot, i_Lighting.SceneData);
+	i_CommandList->SetGraphicsRoot32BitConstant(eForwardShadowRoot, i_Lighting.ShadowMap, 0);
+	i_CommandList->SetGraphicsRootShaderResourceView(ePointLightRoot, i_Lighting.PointLights);
+	i_CommandList->SetGraphicsRootShaderResourceView(eSpotLightRoot, i_Lighting.SpotLights);
+	i_CommandList->SetGraphicsRootShaderResourceView(eDirectionalLightRoot, i_Lighting.DirectionalLights);
+	i_CommandList->SetGraphicsRootShaderResourceView(eClusterRoot, i_Lighting.Clusters);
+	i_CommandList->SetGraphicsRootShaderResourceView(eLightIndexRoot, i_Lighting.LightIndices);
+	i_CommandList->SetGraphicsRootShaderResourceView(eShadowViewRoot, i_Lighting.ShadowViews);
+	i_CommandList->SetGraphicsRootShaderResourceView(eLightShadowRoot, i_Lighting.LightShadows);
+}
+
+bool DX12Material::PrepareForwardPipelineState(UINT64 i_ElementFlags, bool i_OrderIndependent) const
+{
+	if (m_Parent != nullptr)
+		return m_Parent->PrepareForwardPipelineState(i_ElementFlags, i_OrderIndependent);
+
+	return GetPipelineState(i_ElementFlags, eForwardPass | (i_OrderIndependent ? eForwardOIT : eNoFeature)) != nullptr;
+}
+
+void DX12Material::PushSharedResources(ID3D12GraphicsCommandList * i_CommandList, bool i_IndirectDraw) const
+{
+	// the root signature and the maps are the ones of the parent
+	if (m_Parent != nullptr)
+	{
+		m_Parent->PushSharedResources(i_CommandList, i_IndirectDraw);
+		return;
+	}
+
+	// parameter blocks of all materials
+	i_CommandList->SetGraphicsRootShaderResourceView(eParameterBufferRoot, DX12RenderEngine::GetInstance().GetMaterialParameterBuffer()->GetGPUVirtualAddress());
+
+	// the maps are indexed in the bindless heap by the parameter block
+	i_CommandList->SetGraphicsRootDescriptorTable(eBindlessRoot, DX12RenderEngine::GetInstance().GetBindlessHeap()->GetGPUDescriptorHandle());
+
+	// palettes of the animators
+	i_CommandList->SetGraphicsRootShaderResourceView(eSkinningRoot, DX12RenderEngine::GetInstance().GetSkinningBuffer()->GetGPUVirtualAddress());
+
+	// instances of the batches
+	if (i_IndirectDraw)
+	{
+		const DX12GPUCulling * culling = DX12RenderEngine::GetInstance().GetGPUCulling();
+
+		i_CommandList->SetGraphicsRootShaderResourceView(eInstanceRoot, culling->GetInstanceBufferAddress());
+		i_CommandList->SetGraphicsRootShaderResourceView(eVisibleRoot, culling->GetVisibleBufferAddress());
+	}
 }
 
 void DX12Material::PushOnCommandList(ID3D12GraphicsCommandList * i_CommandList, UINT i_RootParameter /* = 2 */) const
 {
-	// bind a buffer on the root signature to the index needed
-	// warning : this can be changed if the mesh is multiple materials rendering
-	i_CommandList->SetGraphicsRootConstantBufferView(i_RootParameter, m_ConstantBuffer->GetUploadVirtualAddress(m_BufferAddress));
+	// the draw selects its parameter block in the buffer
+	i_CommandList->SetGraphicsRoot32BitConstant(i_RootParameter, m_ParameterBlock, 0);
+}
+
+void DX12Material::PushFirstInstance(ID3D12GraphicsCommandList * i_CommandList, UINT i_FirstInstance) const
+{
+	i_CommandList->SetGraphicsRoot32BitConstant(eDrawRoot, i_FirstInstance, 0);
+}
+
+void DX12Material::PushFirstBone(ID3D12GraphicsCommandList * i_CommandList, UINT i_FirstBone) const
+{
+	i_CommandList->SetGraphicsRoot32BitConstant(eBoneRoot, i_FirstBone, 0);
+}
+
+void DX12Material::SetParameters(const Color & i_Ka, const Color & i_Kd, const Color & i_Ks, const Color & i_Ke, float i_Ns)
+{
+	m_Data.Ka = ColorToVec4(i_Ka);
+	m_Data.Kd = ColorToVec4(i_Kd);
+	m_Data.Ks = ColorToVec4(i_Ks);
+	m_Data.Ke = ColorToVec4(i_Ke);
+	m_Data.Ns = i_Ns;
+
+	// the block is written when the material is loaded
+	if (m_ParameterBlock != DX12MaterialParameterBuffer::InvalidBlock)
+		UpdateParameterBlock();
+}
+
+UINT DX12Material::GetParameterBlock() const
+{
+	return m_ParameterBlock;
+}
+
+bool DX12Material::IsInstance() const
+{
+	return m_Parent != nullptr;
+}
+
+bool DX12Material::HasSamePermutation(const DX12MaterialData & i_Data) const
+{
+	const std::wstring pixelShader = i_Data.PixelShader.empty() ? s_DefaultPixelShader : i_Data.PixelShader;
+	return (m_FeatureFlags == GetMapFeatures(i_Data)) && (m_PixelShader == pixelShader);
+}
+
+const DX12Material * DX12Material::GetParentMaterial() const
+{
+	return (m_Parent != nullptr) ? m_Parent : this;
 }
 
-FORCEINLINE void DX12Material::UpdateConstantBuffer() const
+UINT DX12Material::GetPipelineStateCount() const
 {
-	if (m_BufferAddress == UnavailableAdressId || m_ConstantBuffer == nullptr)
+	return (UINT)m_PipelineStates.size();
+}
+
+FORCEINLINE void DX12Material::UpdateParameterBlock() const
+{
+	// the buffer is uploaded once per frame (see RenderList::RenderGBuffer)
+	DX12RenderEngine::GetInstance().GetMaterialParameterBuffer()->UpdateBlock(m_ParameterBlock, m_Data);
+}
+
+FORCEINLINE void DX12Material::LoadParameterBlock()
+{
+	ASSERT(m_ParameterBlock == DX12MaterialParameterBuffer::InvalidBlock);
+
+	// the textures are loaded before the material (no index when headless)
+	m_Data.MapKa = (m_Textures[eAmbient] != nullptr) ? m_Textures[eAmbient]->GetBindlessIndex() : DescriptorAllocator::InvalidIndex;
+	m_Data.MapKd = (m_Textures[eDiffuse] != nullptr) ? m_Textures[eDiffuse]->GetBindlessIndex() : DescriptorAllocator::InvalidIndex;
+	m_Data.MapKs = (m_Textures[eSpecular] != nullptr) ? m_Textures[eSpecular]->GetBindlessIndex() : DescriptorAllocator::InvalidIndex;
+
+	m_ParameterBlock = DX12RenderEngine::GetInstance().GetMaterialParameterBuffer()->ReserveBlock();
+
+	if (m_ParameterBlock == DX12MaterialParameterBuffer::InvalidBlock)
 	{
-		PRINT_DEBUG("Error unable to update the constant buffer");
+		PRINT_DEBUG("Error unable to reserve a parameter block for the material %s", m_Name.c_str());
 		DEBUG_BREAK;
 		return;
 	}
 
-	// update constant buffer on each frame (To do : do not duplicate the constant buffer for materials)
-	m_ConstantBuffer->UpdateConstantBufferForEachFrame(m_BufferAddress, &m_Data, sizeof(MaterialData));
+	UpdateParameterBlock();
+}
+
+FORCEINLINE UINT64 DX12Material::GetMapFeatures(const DX12MaterialData & i_Data)
+{
+	UINT64 features = eNoFeature;
+
+	if (i_Data.map_Ka != nullptr)	features |= eAmbientMap;
+	if (i_Data.map_Kd != nullptr)	features |= eDiffuseMap;
+	if (i_Data.map_Ks != nullptr)	features |= eSpecularMap;
+
+	return features;
+}
+
+UINT64 DX12Material::GetFeatureFlags() const
+{
+	return m_FeatureFlags;
+}
+
+UINT64 DX12Material::GetPermutationKey(UINT64 i_ElementFlags, UINT64 i_PassFeatures) const
+{
+	UINT64 features = m_FeatureFlags;
+
+	// texture maps can't be sampled without uv
+	if (!(i_ElementFlags & DX12PipelineState::eHaveTexcoord))
+	{
+		features &= ~(UINT64)(eAmbientMap | eDiffuseMap | eSpecularMap);
+	}
+
+	// the ambient map is only sampled by the material graph shaders : no GBufferPS permutation for it
+	if (m_PixelShader == s_DefaultPixelShader)
+	{
+		features &= ~(UINT64)eAmbientMap;
+	}
+
+	// the GBuffer layout is shared by all materials (the forward pass does not write the GBuffer)
+	if (!(i_PassFeatures & eForwardPass))
+		features |= DX12RenderEngine::GetInstance().GetGBufferFeatureFlags();
+
+	features |= i_PassFeatures;
+
+	return DX12ShaderCache::MakePermutationKey(i_ElementFlags, features);
 }
 
 void DX12Material::LoadFromData(const void * i_Data, ID3D12GraphicsCommandList * i_CommandList, ID3D12Device * i_Device)
@@ -55,13 +279,26 @@ void DX12Material::LoadFromData(const void * i_Data, ID3D12GraphicsCommandList *
 	const DX12MaterialData * data = (const DX12MaterialData*)i_Data;
 
 	// upload data to the GPU
-	m_ConstantBuffer = DX12RenderEngine::GetInstance().GetConstantBuffer(DX12RenderEngine::eMaterial);
-	m_BufferAddress = m_ConstantBuffer->ReserveVirtualAddress();
-	UpdateConstantBuffer();
+	LoadParameterBlock();
+
+	// generate pipeline state (instances use the parent ones)
+	// the default layout permutation is created now, others are created when a mesh need it
+	if (m_Parent == nullptr)
+	{
+		GenerateRootSignature(i_Device);
+		GetPipelineState(DX12PipelineState::eHaveNormal | DX12PipelineState::eHaveTexcoord);
+	}
+
+	// delete the data
+	delete data;
+}
 
-	// generate pipeline state
-	GenerateRootSignature(i_Device);
-	GeneratePipelineState(i_Device);
+void DX12Material::LoadHeadless(const void * i_Data)
+{
+	const DX12MaterialData * data = (const DX12MaterialData*)i_Data;
+
+	// parameter buffer in system memory, no root signature or pipeline state
+	LoadParameterBlock();
 
 	// delete the data
 	delete data;
@@ -87,23 +324,54 @@ void DX12Material::PreloadData(const void * i_Data)
 
 	m_Data.Ns = data->Ns;
 
-	// To do : manage texture
-	m_Data.Map_A = m_Data.Map_D = m_Data.Map_S = false;
+	// textures : each map enable a feature of the material (instances have their own maps in the parameter block)
+	m_Textures[eAmbient]	= data->map_Ka;
+	m_Textures[eDiffuse]	= data->map_Kd;
+	m_Textures[eSpecular]	= data->map_Ks;
+
+	m_FeatureFlags = GetMapFeatures(*data);
+
+	// shaders : the permutations of a material graph shader are the GBuffer ones
+	if (!data->PixelShader.empty())
+		m_PixelShader = data->PixelShader;
+
+	// instance : the pipeline states of the root material are used (the parent is preloaded when it is pushed)
+	if (data->Parent != nullptr)
+	{
+		const DX12Material * parent = data->Parent->GetParentMaterial();
+
+		if (parent->HasSamePermutation(*data))
+		{
+			m_Parent = parent;
+		}
+		else
+		{
+			// the pipeline states of the parent would not sample the maps of the material : it is not an instance
+			PRINT_DEBUG("Error, the material %s does not have the permutation of its parent %s", m_Name.c_str(), parent->GetName().c_str());
+			DEBUG_BREAK;
+		}
+	}
 
 	// To do : preload textures on the GPU
 }
 
 void DX12Material::Release()
 {
-	// release address from constant buffer
-	if (m_ConstantBuffer != nullptr)
+	// release the parameter block
+	if (m_ParameterBlock != DX12MaterialParameterBuffer::InvalidBlock)
 	{
-		m_ConstantBuffer->ReleaseVirtualAddress(m_BufferAddress);
+		DX12RenderEngine::GetInstance().GetMaterialParameterBuffer()->ReleaseBlock(m_ParameterBlock);
+		m_ParameterBlock = DX12MaterialParameterBuffer::InvalidBlock;
 	}
 
 	// release dx12 resources
 	if (m_RootSignature)	delete m_RootSignature;
-	if (m_PipelineState)	delete m_PipelineState;
+	m_RootSignature = nullptr;
+	for (auto itr = m_PipelineStates.begin(); itr != m_PipelineStates.end(); ++itr)
+	{
+		delete itr->second;
+	}
+	m_PipelineStates.clear();
 
 	DX12Resource::Release();
 }
@@ -116,45 +384,84 @@ FORCEINLINE void DX12Material::GenerateRootSignature(ID3D12Device * i_Device)
 	m_RootSignature = new DX12RootSignature();
 	// generate default root signature
 
-	// constant buffer
+	// constant buffer (same order as ERootParameter)
 	m_RootSignature->AddConstantBuffer(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// b0 : transform constant
 	m_RootSignature->AddConstantBuffer(1, 0, D3D12_SHADER_VISIBILITY_ALL);		// b1 : global constant
-	m_RootSignature->AddConstantBuffer(2, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// b2 : material constant
-
-	// To do : manage textures
-	//D3D12_DESCRIPTOR_RANGE descriptorTableRanges[eCount];
-
-	//for (UINT i = 0; i < eCount; ++i)
-	//{
-	//	descriptorTableRanges[i].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV; // this is a range of shader resource views (descriptors)
-	//	descriptorTableRanges[i].NumDescriptors = 1; // we only have one texture right now, so the range is only 1
-	//	descriptorTableRanges[i].BaseShaderRegister = i; // start index of the shader registers in the range
-	//	descriptorTableRanges[i].RegisterSpace = 0; // space 0. can usually be zero
-	//	descriptorTableRanges[i].OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND; // this appends the range to the end of the root signature descriptor tables
-	//}
-
-	//m_RootSignature->AddDescriptorRange(&descriptorTableRanges[0], 1, D3D12_SHADER_VISIBILITY_PIXEL);
-	//m_RootSignature->AddDescriptorRange(&descriptorTableRanges[1], 1, D3D12_SHADER_VISIBILITY_PIXEL);
-	//m_RootSignature->AddDescriptorRange(&descriptorTableRanges[2], 1, D3D12_SHADER_VISIBILITY_PIXEL);
-
-	//// add static sampler for textures
-	//D3D12_STATIC_SAMPLER_DESC sampler = {};
-
-	//sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
-	//sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
-	//sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
-	//sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
-	//sampler.MipLODBias = 0;
-	//sampler.MaxAnisotropy = 0;
-	//sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
-	//sampler.BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
-	//sampler.MinLOD = 0.0f;
-	//sampler.MaxLOD = D3D12_FLOAT32_MAX;
-	//sampler.ShaderRegister = 0;
-	//sampler.RegisterSpace = 0;
-	//sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
-
-	//m_RootSignature->AddStaticSampler(sampler);
+	m_RootSignature->AddConstants(1, 2, 0, D3D12_SHADER_VISIBILITY_PIXEL);		// b2 : parameter block of the draw
+	m_RootSignature->AddShaderResourceView(3, 0, D3D12_SHADER_VISIBILITY_PIXEL);	// t3 : material parameter buffer
+
+	// bindless textures : the whole heap in one table, the maps are indexed by the parameter block
+	D3D12_DESCRIPTOR_RANGE bindlessRange;
+	bindlessRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+	bindlessRange.NumDescriptors = (UINT)-1;	// unbounded
+	bindlessRange.BaseShaderRegister = 0;
+	bindlessRange.RegisterSpace = 1;
+	bindlessRange.OffsetInDescriptorsFromTableStart = 0;
+
+	m_RootSignature->AddDescriptorRange(&bindlessRange, 1, D3D12_SHADER_VISIBILITY_PIXEL);	// t0, space1
+
+	// indirect draws : the vertex shader reads the instance of the batch (see DX12GPUCulling)
+	m_RootSignature->AddShaderResourceView(4, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// t4 : instance records
+	m_RootSignature->AddShaderResourceView(5, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// t5 : visible instances
+	m_RootSignature->AddConstants(1, 3, 0, D3D12_SHADER_VISIBILITY_VERTEX);		// b3 : first instance of the batch
+
+	// skinned meshes : the vertex shader reads the palette of the animator (see AnimationSystem)
+	m_RootSignature->AddShaderResourceView(6, 0, D3D12_SHADER_VISIBILITY_VERTEX);	// t6 : skinning palette
+	m_RootSignature->AddConstants(1, 4, 0, D3D12_SHADER_VISIBILITY_VERTEX);		// b4 : first bone of the draw
+
+	// forward pass : clustered lights of the frame, in space2 after the material registers (see Lighting.hlsli)
+	m_RootSignature->AddConstantBuffer(0, 2, D3D12_SHADER_VISIBILITY_PIXEL);		// b0, space2 : camera and clusters
+	m_RootSignature->AddConstants(1, 1, 2, D3D12_SHADER_VISIBILITY_PIXEL);		// b1, space2 : shadow atlas index
+	m_RootSignature->AddShaderResourceView(5, 2, D3D12_SHADER_VISIBILITY_PIXEL);	// t5, space2 : point lights
+	m_RootSignature->AddShaderResourceView(6, 2, D3D12_SHADER_VISIBILITY_PIXEL);	// t6, space2 : spot lights
+	m_RootSignature->AddShaderResourceView(7, 2, D3D12_SHADER_VISIBILITY_PIXEL);	// t7, space2 : directional lights
+	m_RootSignature->AddShaderResourceView(8, 2, D3D12_SHADER_VISIBILITY_PIXEL);	// t8, space2 : light clusters
+	m_RootSignature->AddShaderResourceView(9, 2, D3D12_SHADER_VISIBILITY_PIXEL);	// t9, space2 : light index list
+	m_RootSignature->AddShaderResourceView(11, 2, D3D12_SHADER_VISIBILITY_PIXEL);	// t11, space2 : shadow views
+	m_RootSignature->AddShaderResourceView(12, 2, D3D12_SHADER_VISIBILITY_PIXEL);	// t12, space2 : first shadow view of each lights
+
+	// comparison sampler for the shadow atlas (outside of the tile is lit)
+	D3D12_STATIC_SAMPLER_DESC shadowSampler = {};
+
+	shadowSampler.Filter = D3D12_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+	shadowSampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
+	shadowSampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
+	shadowSampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
+	shadowSampler.MipLODBias = 0;
+	shadowSampler.MaxAnisotropy = 0;
+	shadowSampler.ComparisonFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+	shadowSampler.BorderColor = D3D12_STATIC_BORDER_COLOR_OPAQUE_WHITE;
+	shadowSampler.MinLOD = 0.0f;
+	shadowSampler.MaxLOD = D3D12_FLOAT32_MAX;
+	shadowSampler.ShaderRegister = 1;
+	shadowSampler.RegisterSpace = 2;
+	shadowSampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+	m_RootSignature->AddStaticSampler(shadowSampler);
+
+	const bool haveTexture = (m_FeatureFlags & (eAmbientMap | eDiffuseMap | eSpecularMap)) != 0;
+
+	if (haveTexture)
+	{
+		// add static sampler for textures
+		D3D12_STATIC_SAMPLER_DESC sampler = {};
+
+		sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+		sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+		sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+		sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+		sampler.MipLODBias = 0;
+		sampler.MaxAnisotropy = 0;
+		sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+		sampler.BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+		sampler.MinLOD = 0.0f;
+		sampler.MaxLOD = D3D12_FLOAT32_MAX;
+		sampler.ShaderRegister = 0;
+		sampler.RegisterSpace = 0;
+		sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+		m_RootSignature->AddStaticSampler(sampler);
+	}
 
 	m_RootSignature->Create(i_Device,
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
@@ -163,20 +470,47 @@ FORCEINLINE void DX12Material::GenerateRootSignature(ID3D12Device * i_Device)
 		| D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS);
 }
 
-FORCEINLINE void DX12Material::GeneratePipelineState(ID3D12Device * i_Device)
+DX12PipelineState * DX12Material::GetPipelineState(UINT64 i_ElementFlags, UINT64 i_PassFeatures) const
+{
+	if (m_Parent != nullptr)
+		return m_Parent->GetPipelineState(i_ElementFlags, i_PassFeatures);
+
+	// the draw mode and the pass are features of the key
+	const UINT64 key = DX12ShaderCache::MakePermutationKey(i_ElementFlags, i_PassFeatures);
+
+	auto itr = m_PipelineStates.find(key);
+	if (itr != m_PipelineStates.end())
+	{
+		return itr->second;
+	}
+
+	// first use of the material with this layout
+	DX12PipelineState * pipelineState = GeneratePipelineState(i_ElementFlags, i_PassFeatures);
+	m_PipelineStates[key] = pipelineState;
+
+	return pipelineState;
+}
+
+FORCEINLINE DX12PipelineState * DX12Material::GeneratePipelineState(UINT64 i_ElementFlags, UINT64 i_PassFeatures) const
 {
 	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	DX12ShaderCache * shaderCache = render.GetShaderCache();
 
-	
-	DX12Shader * PShader = nullptr;
-	LOAD_SHADER(PShader, DX12Shader::ePixel, L"src/shaders/rendering/GBufferPS.hlsl", L"resources/build/shaders/GBufferPS.cso");
+	// retreive the permutation for the mesh layout and the material features
+	const UINT64 key = GetPermutationKey(i_ElementFlags, i_PassFeatures);
 
-	DX12Shader * VShader = nullptr;
-	LOAD_SHADER(VShader, DX12Shader::eVertex, L"src/shaders/rendering/GBufferVS.hlsl", L"resources/build/shaders/GBufferVS.cso");
+	DX12Shader * PShader = shaderCache->GetShader(DX12Shader::ePixel, m_PixelShader.c_str(), key, s_FeatureDefines, s_FeatureDefineCount);
+	DX12Shader * VShader = shaderCache->GetShader(DX12Shader::eVertex, L"src/shaders/rendering/GBufferVS.hlsl", key, s_FeatureDefines, s_FeatureDefineCount);
+
+	if (PShader == nullptr || VShader == nullptr)
+	{
+		PRINT_DEBUG("Error unable to compile material permutation %llx", key);
+		return nullptr;
+	}
 
 	// create pipeline state object
 	D3D12_INPUT_LAYOUT_DESC inputLayout;
-	DX12PipelineState::CreateInputLayoutFromFlags(inputLayout, DX12PipelineState::EElementFlags::eHaveNormal | DX12PipelineState::EElementFlags::eHaveTexcoord);
+	DX12PipelineState::CreateInputLayoutFromFlags(inputLayout, i_ElementFlags);
 
 	DX12PipelineState::PipelineStateDesc desc;
 
@@ -186,17 +520,34 @@ FORCEINLINE void DX12Material::GeneratePipelineState(ID3D12Device * i_Device)
 	desc.PixelShader = PShader;
 	desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 
+	// forward pass : back buffer or order independent targets, the depth is not written
+	if (i_PassFeatures & eForwardPass)
+	{
+		render.GetTransparency()->SetupPipelineState(desc, (i_PassFeatures & eForwardOIT) != 0);
+
+		DX12PipelineState * pipelineState = new DX12PipelineState(desc);
+		delete [] inputLayout.pInputElementDescs;
+
+		return pipelineState;
+	}
+
 	// setup render target
 	desc.RenderTargetCount = DX12RenderEngine::ERenderTargetId::eRenderTargetCount;
-	desc.RenderTargetFormat[0] = render.GetRenderTarget(DX12RenderEngine::ERenderTargetId::eNormal)->GetFormat();
-	desc.RenderTargetFormat[1] = render.GetRenderTarget(DX12RenderEngine::ERenderTargetId::eDiffuse)->GetFormat();
-	desc.RenderTargetFormat[2] = render.GetRenderTarget(DX12RenderEngine::ERenderTargetId::eSpecular)->GetFormat();
-	desc.RenderTargetFormat[3] = render.GetRenderTarget(DX12RenderEngine::ERenderTargetId::ePosition)->GetFormat();
+	for (UINT i = 0; i < DX12RenderEngine::ERenderTargetId::eRenderTargetCount; ++i)
+	{
+		desc.RenderTargetFormat[i] = render.GetRenderTargetFormat((DX12RenderEngine::ERenderTargetId)i);
+	}
 
 	desc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT); // a default blend state.
 	desc.DepthStencilDesc = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT); // a default depth stencil state
+	desc.DepthStencilDesc.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;	// pass on the depth written by the depth pre pass
+	desc.DepthEnabled = true;
 	desc.DepthStencilFormat = render.GetDepthBuffer()->GetFormat();
 
-	m_PipelineState = new DX12PipelineState(desc);
-}
+	DX12PipelineState * pipelineState = new DX12PipelineState(desc);
 
+	// the pipeline state keep a copy of the layout
+	delete [] inputLayout.pInputElementDescs;
+
+	return pipelineState;
+}
@@ -1,4 +1,6 @@
 // material that contains data to render properly objects (color, textures...)
+// a material instance uses the shader, the pipeline states and the textures of its parent material and only owns its parameters (colors)
+// the parameters of all materials are blocks of one buffer (see DX12MaterialParameterBuffer) : draws only change the block index when they share the parent
 #pragma once
 
 // class predef
@@ -10,17 +12,55 @@ class DX12PipelineState;
 #include "dx12/DX12Utils.h"
 #include "dx12/DX12Shader.h"
 #include "dx12/DX12ConstantBuffer.h"
+#include "dx12/DX12MaterialParameterBuffer.h"
+#include "dx12/DX12ShaderCache.h"
+#include "dx12/DX12PipelineState.h"
 #include <string>
+#include <map>
 
 class DX12Material : public DX12Resource
 {
 public:
+	// material features : each feature generate a specific shader permutation
+	enum EMaterialFeature
+	{
+		eNoFeature			= 0,
+		eAmbientMap			= 1 << 0,	// map_Ka is sampled (material graph shaders only, GBufferPS does not sample it)
+		eDiffuseMap			= 1 << 1,	// map_Kd is sampled
+		eSpecularMap		= 1 << 2,	// map_Ks is sampled
+		// pass features (setupped by the render engine)
+		eGBufferPacked		= 1 << 3,	// packed GBuffer layout (see DX12RenderEngine::EGBufferLayout)
+		eIndirectDraw		= 1 << 4,	// instances culled on the GPU : transforms and parameter blocks are read from the instance records (see DX12GPUCulling)
+		eForwardPass		= 1 << 5,	// semi transparent pass : lit with the clustered lights and blended on the back buffer (see DX12Transparency)
+		eForwardOIT			= 1 << 6,	// forward pass accumulated in the order independent transparency targets
+	};
+
+	// clustered lights of the frame read by the forward pass (see RenderList::RenderLight)
+	struct ForwardLighting
+	{
+		D3D12_GPU_VIRTUAL_ADDRESS	SceneData;			// camera and clusters
+		UINT						ShadowMap;			// bindless index of the shadow atlas
+		D3D12_GPU_VIRTUAL_ADDRESS	PointLights, SpotLights, DirectionalLights;
+		D3D12_GPU_VIRTUAL_ADDRESS	Clusters, LightIndices;
+		D3D12_GPU_VIRTUAL_ADDRESS	ShadowViews, LightShadows;
+	};
+
+	// defines generated for each feature (see GBufferPS.hlsl)
+	static const DX12ShaderCache::PermutationDefine		s_FeatureDefines[];
+	static const UINT									s_FeatureDefineCount;
+	static const wchar_t * const						s_DefaultPixelShader;	// GBufferPS.hlsl
+
 	struct DX12MaterialData
 	{
 		// material data
 		Color Ka = color::Pink, Kd = color::Pink, Ks = color::Pink, Ke = color::Pink;
 		float Ns = 32.f;
 		DX12Texture *	map_Kd = nullptr, *map_Ks = nullptr, *map_Ka = nullptr;
+		// pixel shader (empty : GBufferPS.hlsl), a material graph shader can be used (see MaterialGraph)
+		std::wstring	PixelShader;
+		// material instance : the pipeline states of the parent are used, the maps are the ones of the data (indices in the parameter block)
+		// the data must have the permutation of the parent (see HasSamePermutation), the parent must be deleted after its instances
+		const DX12Material *	Parent = nullptr;
 		// data info
 		std::string	Name, Filepath;
 	};
@@ -29,39 +69,103 @@ public:
 	~DX12Material();
 
 	// dx12 management
-	void		PushPipelineState(ID3D12GraphicsCommandList * i_CommandList) const;
+	// the pipeline state depends on the mesh layout (i_ElementFlags : DX12PipelineState::EElementFlags)
+	// the shared resources (parameter buffer and bindless table) are pushed after the pipeline state, then the parameter block of each draw
+	// the bindless heap must be set on the command list (see DX12BindlessHeap::SetOnCommandList)
+	// indirect draws use their own permutation : the instance buffers are pushed with the shared resources, then the first instance of each batch
+	// skinned meshes read the skinning palette of the frame (pushed with the shared resources) from the first bone of their animator
+	void		PushPipelineState(ID3D12GraphicsCommandList * i_CommandList, UINT64 i_ElementFlags = DX12PipelineState::eHaveNormal | DX12PipelineState::eHaveTexcoord, bool i_IndirectDraw = false) const;
+	void		PushSharedResources(ID3D12GraphicsCommandList * i_CommandList, bool i_IndirectDraw = false) const;
 	void		PushOnCommandList(ID3D12GraphicsCommandList * i_CommandList, UINT i_RootParameter = 2 /* Root parameter index (basically 2 but can be changed) */) const;
-	void		UpdateConstantBuffer() const;	// this update constant buffer for Shader buffer
+	void		PushFirstInstance(ID3D12GraphicsCommandList * i_CommandList, UINT i_FirstInstance) const;	// indirect draws : range of the batch in the visible instances
+	void		PushFirstBone(ID3D12GraphicsCommandList * i_CommandList, UINT i_FirstBone) const;		// skinned draws : palette of the animator (the indirect draws read it in the instance records)
+	bool		PreparePipelineState(UINT64 i_ElementFlags, bool i_IndirectDraw = false) const;	// create the pipeline state before a parallel recording (workers only read the pipeline states)
+
+	// forward pass : the forward permutation is pushed instead of the GBuffer one, then the shared resources and the lights of the frame
+	void		PushForwardPipelineState(ID3D12GraphicsCommandList * i_CommandList, UINT64 i_ElementFlags, bool i_OrderIndependent) const;
+	void		PushForwardLighting(ID3D12GraphicsCommandList * i_CommandList, const ForwardLighting & i_Lighting) const;
+	bool		PrepareForwardPipelineState(UINT64 i_ElementFlags, bool i_OrderIndependent) const;
+
+	// parameters
+	void		SetParameters(const Color & i_Ka, const Color & i_Kd, const Color & i_Ks, const Color & i_Ke, float i_Ns);
+	UINT		GetParameterBlock() const;	// block in the material parameter buffer
+
+	// instance management
+	bool					IsInstance() const;
+	bool					HasSamePermutation(const DX12MaterialData & i_Data) const;	// same maps sampled and same shader : the data can be an instance of the material
+	const DX12Material *	GetParentMaterial() const;	// the material itself when it is not an instance
+	UINT					GetPipelineStateCount() const;	// pipeline states owned by the material (none for an instance)
+
+	// permutation management
+	UINT64		GetFeatureFlags() const;
+	UINT64		GetPermutationKey(UINT64 i_ElementFlags, UINT64 i_PassFeatures = eNoFeature) const;	// key used by the shader cache for this material, a mesh layout and the pass features
 
 	friend class DX12ResourceManager;
 private:
 	DX12Material();
 
-	// internal helper
-	void		GenerateRootSignature(ID3D12Device * i_Device);
-	void		GeneratePipelineState(ID3D12Device * i_Device);
+	// texture slots (indices of the maps in the parameter block)
+	enum ETextureSlot
+	{
+		eAmbient,
+		eSpecular,
+		eDiffuse,
 
-	// define data for material
-	__declspec(align(16)) struct MaterialData
+		eTextureSlotCount,
+	};
+
+	// root parameters
+	enum ERootParameter
 	{
-		DirectX::XMFLOAT4		Ka, Kd, Ks, Ke;
-		BOOL					Map_A, Map_D, Map_S;
-		float					Ns;
+		eTransformRoot,			// b0
+		eGlobalRoot,			// b1
+		eParameterBlockRoot,	// b2 : index of the parameter block
+		eParameterBufferRoot,	// t3 : material parameter buffer
+		eBindlessRoot,			// t0, space1 : bindless textures (see DX12BindlessHeap)
+		eInstanceRoot,			// t4 : instance records (indirect draws)
+		eVisibleRoot,			// t5 : visible instances (indirect draws)
+		eDrawRoot,				// b3 : first instance of the batch (indirect draws)
+		eSkinningRoot,			// t6 : skinning palette (see AnimationSystem)
+		eBoneRoot,				// b4 : first bone of the draw (skinned draws)
+		// forward pass : clustered lighting in space2 (see Lighting.hlsli)
+		eSceneDataRoot,			// b0, space2 : camera and clusters
+		eForwardShadowRoot,		// b1, space2 : bindless index of the shadow atlas
+		ePointLightRoot,		// t5 to t9, space2 : lights and clusters
+		eSpotLightRoot,
+		eDirectionalLightRoot,
+		eClusterRoot,
+		eLightIndexRoot,
+		eShadowViewRoot,		// t11, space2 : shadow views
+		eLightShadowRoot,		// t12, space2 : first shadow view of each light
 	};
 
+	// internal helper
+	void					GenerateRootSignature(ID3D12Device * i_Device);
+	void					UpdateParameterBlock() const;
+	void					LoadParameterBlock();
+	static UINT64			GetMapFeatures(const DX12MaterialData & i_Data);	// features of the maps of the data
+	DX12PipelineState *		GeneratePipelineState(UINT64 i_ElementFlags, UINT64 i_PassFeatures) const;
+	DX12PipelineState *		GetPipelineState(UINT64 i_ElementFlags, UINT64 i_PassFeatures = eNoFeature) const;	// i_PassFeatures : eIndirectDraw, eForwardPass, eForwardOIT
+
 	// Inherited via DX12Resource
 	virtual void LoadFromData(const void * i_Data, ID3D12GraphicsCommandList * i_CommandList, ID3D12Device * i_Device) override;
+	virtual void LoadHeadless(const void * i_Data) override;
 	virtual void PreloadData(const void * i_Data) override;
 	virtual void Release() override;
 
 	// pipeline state object
 	DX12RootSignature *		m_RootSignature;
-	DX12PipelineState *		m_PipelineState;
+	mutable std::map<UINT64, DX12PipelineState *>	m_PipelineStates;	// pipeline state per mesh layout and pass (created when needed)
 
-	// external
-	DX12ConstantBuffer *	m_ConstantBuffer;
+	// textures
+	DX12Texture *			m_Textures[eTextureSlotCount];
 
 	// material specs
-	ADDRESS_ID				m_BufferAddress;
-	MaterialData			m_Data;	// data sended to the GPU
+	const DX12Material *	m_Parent;		// null when the material is not an instance
+	UINT64					m_FeatureFlags;	// EMaterialFeature
+	std::wstring			m_PixelShader;
+
+	// parameters : bindless indices of the maps are in the block, the permutation only selects the sampled maps
+	UINT					m_ParameterBlock;
+	DX12MaterialParameterBuffer::ParameterBlock		m_Data;	// data sended to the GPU
 };
\ No newline at end of file
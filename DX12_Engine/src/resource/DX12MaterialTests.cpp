@@ -0,0 +1,182 @@
+#include "engine/Console.h"
+
+#ifdef WITH_CONSOLE_TESTS
+
+#include <algorithm>
+
+#include "engine/Utils.h"
+#include "engine/Clock.h"
+#include "engine/Engine.h"
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12MaterialParameterBuffer.h"
+#include "resource/DX12ResourceManager.h"
+#include "resource/DX12Material.h"
+
+CFMaterialInstanceCheck::CFMaterialInstanceCheck()
+	:Console::Function("material_instance_check", "[variant count] [parent count]", "create material instances, count the pipeline states and the parameter bytes, time the upload of the parameter blocks")
+{
+}
+
+bool CFMaterialInstanceCheck::Execute(const Console::CommandLine & i_CommandLine)
+{
+	UINT variantCount = 10000;
+	UINT parentCount = 4;
+
+	if (i_CommandLine.m_Parameters.size() > 0)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[0]))
+			return false;
+		variantCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[0]), 1);
+	}
+
+	if (i_CommandLine.m_Parameters.size() > 1)
+	{
+		if (!i_CommandLine.IsNumber(i_CommandLine.m_Parameters[1]))
+			return false;
+		parentCount = (UINT)Math::Max(i_CommandLine.ToInt(i_CommandLine.m_Parameters[1]), 1);
+	}
+
+	DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+	DX12ResourceManager * manager = Engine::GetInstance().GetRenderResourceManager();
+	DX12MaterialParameterBuffer * parameterBuffer = render.GetMaterialParameterBuffer();
+	const UINT usedBlockCount = parameterBuffer->GetBlockCount();
+	UINT errors = 0;
+
+	if (usedBlockCount + parentCount + variantCount > parameterBuffer->GetCapacity())
+	{
+		GetConsole()->Print("material instance check : %u blocks needed, %u available", parentCount + variantCount, parameterBuffer->GetCapacity() - usedBlockCount);
+		return false;
+	}
+
+	// parents own the shader, each variant is an instance (one out of eight is an instance of an instance : it is flattened to the parent)
+	std::vector<DX12Material *> parents;
+	std::vector<DX12Material *> instances;
+
+	for (UINT i = 0; i < parentCount; ++i)
+	{
+		DX12Material::DX12MaterialData * data = new DX12Material::DX12MaterialData;
+		data->Name = "InstanceCheckParent" + String::UInt64ToString(i);
+		data->Kd = color::White;
+
+		parents.push_back(manager->PushMaterial(data));
+	}
+
+	for (UINT i = 0; i < variantCount; ++i)
+	{
+		DX12Material::DX12MaterialData * data = new DX12Material::DX12MaterialData;
+		data->Name = "InstanceCheckVariant" + String::UInt64ToString(i);
+		data->Kd = Color((float)i / (float)variantCount, 0.5f, 1.f);
+		data->Ns = (float)(i % 128);
+		data->Parent = (i >= parentCount && i % 8 == 0) ? instances[i - parentCount] : parents[i % parentCount];
+
+		instances.push_back(manager->PushMaterial(data));
+	}
+
+	manager->PushResourceOnGPUWithWait();
+
+	// pipeline states : only the parents own them
+	std::vector<BYTE> blocks(parameterBuffer->GetCapacity(), 0);
+	UINT pipelineStateCount = 0;
+
+	for (UINT i = 0; i < parentCount; ++i)
+	{
+		pipelineStateCount += parents[i]->GetPipelineStateCount();
+
+		if (parents[i]->IsInstance() || parents[i]->GetParentMaterial() != parents[i] || !parents[i]->IsValid()
+			|| (render.IsHeadless() == (parents[i]->GetPipelineStateCount() != 0)))
+			++errors;
+	}
+
+	for (UINT i = 0; i < parentCount + variantCount; ++i)
+	{
+		const DX12Material * material = (i < parentCount) ? parents[i] : instances[i - parentCount];
+		const UINT block = material->GetParameterBlock();
+
+		// each material has its own block
+		if (block >= parameterBuffer->GetCapacity() || blocks[block]++ != 0)
+			++errors;
+	}
+
+	for (UINT i = 0; i < variantCount; ++i)
+	{
+		if (!instances[i]->IsInstance() || instances[i]->GetParentMaterial() != parents[i % parentCount]
+			|| instances[i]->GetPipelineStateCount() != 0 || !instances[i]->IsValid())
+			++errors;
+	}
+
+	if (parameterBuffer->GetBlockCount() != usedBlockCount + parentCount + variantCount)
+		++errors;
+
+	// a material with other maps or another shader can not be an instance (the pipeline states would not sample its maps)
+	DX12Material::DX12MaterialData sameData, graphData;
+	graphData.PixelShader = L"src/shaders/generated/MaterialGraphPS.hlsl";
+
+	if (!parents[0]->HasSamePermutation(sameData) || parents[0]->HasSamePermutation(graphData))
+		++errors;
+
+	// draws sorted as the render list does : the pipeline state only changes with the parent
+	std::vector<const DX12Material *> draws;
+
+	for (UINT i = 0; i < variantCount; ++i)
+	{
+		draws.push_back(instances[(UINT)(((UINT64)i * 7919) % variantCount)]);
+	}
+
+	std::sort(draws.begin(), draws.end(), [](const DX12Material * i_A, const DX12Material * i_B)
+	{
+		if (i_A->GetParentMaterial() != i_B->GetParentMaterial())	return i_A->GetParentMaterial() < i_B->GetParentMaterial();
+		return i_A < i_B;
+	});
+
+	UINT stateChangeCount = 0;
+
+	for (size_t i = 0; i < draws.size(); ++i)
+	{
+		if (i == 0 || draws[i]->GetParentMaterial() != draws[i - 1]->GetParentMaterial())
+			++stateChangeCount;
+	}
+
+	if (stateChangeCount != Math::Min(parentCount, variantCount))
+		++errors;
+
+	// parameters : every variant changes, the blocks are uploaded once
+	Clock updateClock;
+
+	for (UINT i = 0; i < variantCount; ++i)
+	{
+		instances[i]->SetParameters(color::Black, Color(1.f, (float)i / (float)variantCount, 0.f), color::White, color::Black, 16.f);
+	}
+
+	const float updateTime = updateClock.GetElaspedTime().ToMilliseconds();
+
+	Clock uploadClock;
+	parameterBuffer->Upload();
+	const float uploadTime = uploadClock.GetElaspedTime().ToMilliseconds();
+
+	// sizes : a parameter block per material, a duplicated 256 bytes constant buffer slot per material before the instances
+	const UINT64 parameterSize = (UINT64)(parentCount + variantCount) * sizeof(DX12MaterialParameterBuffer::ParameterBlock);
+	const UINT64 constantBufferSize = (UINT64)(parentCount + variantCount) * 256 * render.GetFrameBufferCount();
+
+	// instances are deleted before their parents
+	for (size_t i = instances.size(); i > 0; --i)
+	{
+		delete instances[i - 1];
+	}
+
+	for (size_t i = 0; i < parents.size(); ++i)
+	{
+		delete parents[i];
+	}
+
+	if (parameterBuffer->GetBlockCount() != usedBlockCount)
+		++errors;
+
+	GetConsole()->Print("material instance check : %u variants of %u parents, %u pipeline states (%u without instances), %u state changes for %u draws",
+		variantCount, parentCount, pipelineStateCount, pipelineStateCount * (parentCount + variantCount) / parentCount, stateChangeCount, variantCount);
+	GetConsole()->Print("material instance check : %llu parameter bytes (%llu in constant buffers), update %.2f ms, upload %llu bytes in %.2f ms, %u errors",
+		parameterSize, constantBufferSize, updateTime, parameterBuffer->GetUploadSize(), uploadTime, errors);
+
+	return errors == 0;
+}
+
+#endif /* WITH_CONSOLE_TESTS */
@@ -2,6 +2,7 @@
 
 #include "dx12/DX12Utils.h"
 #include "dx12/DX12PipelineState.h"
+#include "dx12/DX12RenderEngine.h"
 #include "engine/Debug.h"
 #include "engine/Utils.h"
 
@@ -52,13 +53,25 @@ const D3D12_INPUT_LAYOUT_DESC & DX12Mesh::GetInputLayoutDesc() const
 	return m_InputLayoutDesc;
 }
 
+UINT64 DX12Mesh::GetElementFlags() const
+{
+	return m_ElementFlags;
+}
+
+const DirectX::XMFLOAT4 & DX12Mesh::GetBoundingSphere() const
+{
+	return m_BoundingSphere;
+}
+
 DX12Mesh::DX12Mesh(DX12MeshData * i_Data, ID3D12GraphicsCommandList * i_CommandList, ID3D12Device * i_Device)
 	:DX12Resource(true)	// the data is loaded on different path than the resource manager
-	,m_IndexBuffer(nullptr)
-	,m_VertexBuffer(nullptr)
+	,m_IndexBuffer(DX12MeshArena::InvalidHandle)
+	,m_VertexBuffer(DX12MeshArena::InvalidHandle)
 	,m_Count(0)
 	,m_IndexCount(0)
 	,m_VertexCount(0)
+	,m_ElementFlags(0)
+	,m_BoundingSphere(0.f, 0.f, 0.f, 0.f)
 {
 	PreloadData(i_Data);
 	LoadFromData(i_Data, i_CommandList, i_Device);
@@ -66,11 +79,13 @@ DX12Mesh::DX12Mesh(DX12MeshData * i_Data, ID3D12GraphicsCommandList * i_CommandL
 
 DX12Mesh::DX12Mesh()
 	:DX12Resource()
-	,m_IndexBuffer(nullptr)
-	,m_VertexBuffer(nullptr)
+	,m_IndexBuffer(DX12MeshArena::InvalidHandle)
+	,m_VertexBuffer(DX12MeshArena::InvalidHandle)
 	,m_Count(0)
 	,m_IndexCount(0)
 	,m_VertexCount(0)
+	,m_ElementFlags(0)
+	,m_BoundingSphere(0.f, 0.f, 0.f, 0.f)
 {
 }
 
@@ -90,26 +105,25 @@ void DX12Mesh::LoadFromData(const void * i_Data, ID3D12GraphicsCommandList * i_C
 	// index count
 	const UINT iBufferSize = sizeof(DWORD) * m_IndexCount;
 
-	std::wstring name;
-	String::Utf8ToUtf16(name, m_Name);
+	DX12MeshArena * arena = DX12RenderEngine::GetInstance().GetMeshArena();
 
-	// create vertex buffer
-	CreateBuffer(i_Device, &m_VertexBuffer, vBufferSize, name.c_str());
-	UpdateData(i_Device, i_CommandList, m_VertexBuffer, vBufferSize, (data->VerticesBuffer));
+	// allocate the vertex buffer in the arena
+	m_VertexBuffer = arena->Allocate(vBufferSize, this);
+	DX12_ASSERT(arena->Upload(i_CommandList, m_VertexBuffer, data->VerticesBuffer, vBufferSize));
 
-	// create a vertex buffer view for the triangle. We get the GPU memory address to the pointer using the GetGPUVirtualAddress() method
-	m_VertexBufferView.BufferLocation = m_VertexBuffer->GetGPUVirtualAddress();
+	// create a vertex buffer view for the triangle. The GPU address is the address of the allocation in its page
+	m_VertexBufferView.BufferLocation = arena->GetGPUVirtualAddress(m_VertexBuffer);
 	m_VertexBufferView.StrideInBytes = stride;
 	m_VertexBufferView.SizeInBytes = vBufferSize;
 
 	// create index buffer if necessary
 	if (m_IndexCount != 0)
 	{
-		CreateBuffer(i_Device, &m_IndexBuffer, iBufferSize, name.c_str());
-		UpdateData(i_Device, i_CommandList, m_IndexBuffer, iBufferSize, reinterpret_cast<const BYTE*>(data->IndexBuffer));
+		m_IndexBuffer = arena->Allocate(iBufferSize, this);
+		DX12_ASSERT(arena->Upload(i_CommandList, m_IndexBuffer, data->IndexBuffer, iBufferSize));
 
-		// create a index buffer view for the triangle. We get the GPU memory address to the vertex pointer using the GetGPUVirtualAddress() method
-		m_IndexBufferView.BufferLocation = m_IndexBuffer->GetGPUVirtualAddress();
+		// create a index buffer view for the triangle
+		m_IndexBufferView.BufferLocation = arena->GetGPUVirtualAddress(m_IndexBuffer);
 		m_IndexBufferView.Format = DXGI_FORMAT_R32_UINT; // 32-bit unsigned integer (this is what a dword is, double word, a word is 2 bytes)
 		m_IndexBufferView.SizeInBytes = iBufferSize;
 	}
@@ -118,6 +132,12 @@ void DX12Mesh::LoadFromData(const void * i_Data, ID3D12GraphicsCommandList * i_C
 	delete data;
 }
 
+void DX12Mesh::LoadHeadless(const void * i_Data)
+{
+	// layout, counts and bounds are preloaded : there is no vertex or index buffer
+	delete (const DX12MeshData*)i_Data;
+}
+
 void DX12Mesh::PreloadData(const void * i_Data)
 {
 	// we are retreiving data
@@ -136,73 +156,56 @@ void DX12Mesh::PreloadData(const void * i_Data)
 
 	// retreive the input layout
 	DX12PipelineState::CopyInputLayout(m_InputLayoutDesc, data->InputLayout);
-}
+	m_ElementFlags = DX12PipelineState::CreateFlagsFromInputLayout(m_InputLayoutDesc);	// used to select the shader permutation
 
-void DX12Mesh::Release()
-{
-	SAFE_RELEASE(m_VertexBuffer);
+	// compute the bounding sphere from the vertices position (position is always the first element)
+	const UINT stride = DX12PipelineState::GetElementSize(m_InputLayoutDesc);
+	DirectX::XMVECTOR minPos = DirectX::g_XMFltMax;
+	DirectX::XMVECTOR maxPos = DirectX::XMVectorNegate(DirectX::g_XMFltMax);
 
-	if (HaveIndexBuffer())
+	for (UINT i = 0; i < m_VertexCount; ++i)
 	{
-		SAFE_RELEASE(m_IndexBuffer);
+		DirectX::XMVECTOR pos = DirectX::XMLoadFloat3((const DirectX::XMFLOAT3 *)(data->VerticesBuffer + i * stride));
+		minPos = DirectX::XMVectorMin(minPos, pos);
+		maxPos = DirectX::XMVectorMax(maxPos, pos);
 	}
 
-	// call for release of the resource
-	DX12Resource::Release();
-}
-
-HRESULT DX12Mesh::CreateBuffer(ID3D12Device * i_Device, ID3D12Resource ** i_Buffer, UINT i_BufferSize, const wchar_t * i_Name)
-{
-	HRESULT hr;
-
-	hr = i_Device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), // a default heap
-		D3D12_HEAP_FLAG_NONE, // no flags
-		&CD3DX12_RESOURCE_DESC::Buffer(i_BufferSize), // resource description for a buffer
-		D3D12_RESOURCE_STATE_COPY_DEST, // we will start this heap in the copy destination state since we will copy data
-										// from the upload heap to this heap
-		nullptr, // optimized clear value must be null for this type of resource. used for render targets and depth/stencil buffers
-		IID_PPV_ARGS(i_Buffer));
+	DirectX::XMVECTOR center = (minPos + maxPos) * 0.5f;
+	DirectX::XMVECTOR radius = DirectX::XMVectorZero();
 
-	// return if failed
-	if (FAILED(hr)) return hr;
+	for (UINT i = 0; i < m_VertexCount; ++i)
+	{
+		DirectX::XMVECTOR pos = DirectX::XMLoadFloat3((const DirectX::XMFLOAT3 *)(data->VerticesBuffer + i * stride));
+		radius = DirectX::XMVectorMax(radius, DirectX::XMVector3LengthSq(pos - center));
+	}
 
-	(*i_Buffer)->SetName(i_Name);
-	return hr;
+	DirectX::XMStoreFloat4(&m_BoundingSphere, DirectX::XMVectorSelect(DirectX::XMVectorSqrt(radius), center, DirectX::g_XMSelect1110));
 }
 
-HRESULT DX12Mesh::UpdateData(ID3D12Device * i_Device, ID3D12GraphicsCommandList * i_CommandList, ID3D12Resource * i_Buffer, UINT i_BufferSize, const BYTE * i_Data)
+void DX12Mesh::Release()
 {
-	HRESULT hr;
-	ID3D12Resource* bufferUploadHeap;
-	hr = i_Device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // upload heap
-		D3D12_HEAP_FLAG_NONE, // no flags
-		&CD3DX12_RESOURCE_DESC::Buffer(i_BufferSize), // resource description for a buffer
-		D3D12_RESOURCE_STATE_GENERIC_READ, // GPU will read from this buffer and copy its contents to the default heap
-		nullptr,
-		IID_PPV_ARGS(&bufferUploadHeap));
-
-	// return if failed
-	if (FAILED(hr)) return hr;
+	// the ranges are reused after the frames in flight (headless meshes have no buffer)
+	DX12MeshArena * arena = DX12RenderEngine::GetInstance().GetMeshArena();
 
-	bufferUploadHeap->SetName(L"Vertex Buffer Upload Resource Heap");
-
-	// store buffer in upload heap
-	D3D12_SUBRESOURCE_DATA data = {};
-	data.pData = i_Data; // pointer to our vertex array
-	data.RowPitch = i_BufferSize; // size of all our triangle vertex data
-	data.SlicePitch = i_BufferSize; // also the size of our triangle vertex data
+	if (arena != nullptr)
+	{
+		arena->Free(m_VertexBuffer);
+		arena->Free(m_IndexBuffer);
+	}
 
-									// we are now creating a command with the command list to copy the data from
-									// the upload heap to the default heap
-	UINT64 size = UpdateSubresources(i_CommandList, i_Buffer, bufferUploadHeap, 0, 0, 1, &data);
+	m_VertexBuffer = DX12MeshArena::InvalidHandle;
+	m_IndexBuffer = DX12MeshArena::InvalidHandle;
 
-	// return if failed
-	if (size != i_BufferSize) return E_UNEXPECTED;
+	// call for release of the resource
+	DX12Resource::Release();
+}
 
-	// transition the vertex buffer data from copy destination state to vertex buffer state
-	i_CommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(i_Buffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER));
+void DX12Mesh::OnAllocationMoved(DX12MeshArena::Handle i_Handle)
+{
+	const DX12MeshArena * arena = DX12RenderEngine::GetInstance().GetMeshArena();
 
-	return hr;
+	if (i_Handle == m_VertexBuffer)
+		m_VertexBufferView.BufferLocation = arena->GetGPUVirtualAddress(m_VertexBuffer);
+	else if (i_Handle == m_IndexBuffer)
+		m_IndexBufferView.BufferLocation = arena->GetGPUVirtualAddress(m_IndexBuffer);
 }
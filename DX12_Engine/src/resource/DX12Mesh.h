@@ -1,11 +1,12 @@
 #pragma once
 
 #include "DX12Resource.h"
+#include "dx12/DX12MeshArena.h"
 #include <d3d12.h>
 #include <DirectXMath.h>
 
-
-class DX12Mesh : public DX12Resource
+// the vertex and index buffers are allocated in the mesh arena of the render engine (see DX12MeshArena)
+class DX12Mesh : public DX12Resource, public DX12MeshArena::Listener
 {
 public:
 	struct DX12MeshData
@@ -34,6 +35,8 @@ public:
 	UINT							GetIndexCount() const;
 	bool							HaveIndexBuffer() const;
 	const D3D12_INPUT_LAYOUT_DESC &	GetInputLayoutDesc() const;
+	UINT64							GetElementFlags() const;	// DX12PipelineState::EElementFlags of the layout
+	const DirectX::XMFLOAT4 &		GetBoundingSphere() const;	// local space bounding sphere (xyz : center, w : radius)
 
 	// friend class
 	friend class DX12ResourceManager;
@@ -47,18 +50,20 @@ private:
 
 	// Inherited via DX12Resource
 	virtual void LoadFromData(const void * i_Data, ID3D12GraphicsCommandList * i_CommandList, ID3D12Device * i_Device) override;
+	virtual void LoadHeadless(const void * i_Data) override;
 	virtual void PreloadData(const void * i_Data) override;
 	virtual void Release() override;
 
-	// dx12 helpers
-	static HRESULT	CreateBuffer(ID3D12Device * i_Device, ID3D12Resource ** i_Buffer, UINT i_BufferSize, const wchar_t * i_Name = L"Default Buffer");
-	static HRESULT	UpdateData(ID3D12Device * i_Device, ID3D12GraphicsCommandList* i_CommandList, ID3D12Resource * i_Buffer, UINT i_BufferSize, const BYTE * i_Data);
+	// Inherited via DX12MeshArena::Listener
+	virtual void OnAllocationMoved(DX12MeshArena::Handle i_Handle) override;	// the defragmentation moved a buffer : update the views
 
 	// Mesh data
 	D3D12_INPUT_LAYOUT_DESC			m_InputLayoutDesc;
-	// Buffer
-	ID3D12Resource*					m_VertexBuffer;
-	ID3D12Resource*					m_IndexBuffer;
+	UINT64							m_ElementFlags;
+	DirectX::XMFLOAT4				m_BoundingSphere;
+	// Buffer (allocations in the mesh arena)
+	DX12MeshArena::Handle			m_VertexBuffer;
+	DX12MeshArena::Handle			m_IndexBuffer;
 	// Descriptors
 	D3D12_VERTEX_BUFFER_VIEW		m_VertexBufferView;
 	D3D12_INDEX_BUFFER_VIEW			m_IndexBufferView;
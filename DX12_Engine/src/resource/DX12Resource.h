@@ -35,6 +35,7 @@ protected:
 private:
 	// load resource
 	virtual void		LoadFromData(const void * i_Data, ID3D12GraphicsCommandList * i_CommandList, ID3D12Device * i_Device) = 0;
+	virtual void		LoadHeadless(const void * i_Data) = 0;	// headless render engine : only the CPU side is loaded
 	virtual void		PreloadData(const void * i_Data);	// preload needed data for recognition (as name setup...)
 
 	// callbacks
@@ -8,6 +8,7 @@
 
 #include "dx12/DX12Context.h"
 #include "dx12/DX12RenderEngine.h"
+#include "engine/CPUProfiler.h"
 
 DX12Mesh * DX12ResourceManager::PushMesh(void * i_Data)
 {
@@ -70,7 +71,14 @@ DX12Texture * DX12ResourceManager::PushTexture(void * i_Data)
 }
 
 DX12ResourceManager::DX12ResourceManager()
+	:m_FenceEvent(nullptr)
+	,m_CopyContext(nullptr)
+	,m_CommandQueue(nullptr)
 {
+	// headless : resources are loaded without GPU
+	if (DX12RenderEngine::GetInstance().IsHeadless())
+		return;
+
 	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
 
 	D3D12_COMMAND_QUEUE_DESC cqDesc = {};
@@ -105,6 +113,21 @@ void DX12ResourceManager::PushResourceOnGPUWithWait()
 	// if we don't have any resource to load
 	if (m_ResourceQueue.size() == 0)		return;
 
+	CPU_ZONE("Push Resources");
+
+	// headless : only the CPU side of the resources is loaded
+	if (DX12RenderEngine::GetInstance().IsHeadless())
+	{
+		for (size_t i = 0; i < m_ResourceQueue.size(); ++i)
+		{
+			m_ResourceQueue[i].Resource->LoadHeadless(m_ResourceQueue[i].Data);
+			m_ResourceQueue[i].Resource->FinishLoading();
+		}
+
+		m_ResourceQueue.clear();
+		return;
+	}
+
 	// initialize context
 	m_CopyContext->ResetContext();
 	ID3D12Device * device = DX12RenderEngine::GetInstance().GetDevice();
@@ -139,7 +162,10 @@ void DX12ResourceManager::PushResourceOnGPUWithWait()
 	DX12_ASSERT(fence->SetEventOnCompletion(fenceValue, m_FenceEvent));
 
 	// we wait for the deferred context to be executed by the GPU
-	WaitForSingleObject(m_FenceEvent, INFINITE);
+	{
+		CPU_ZONE("Wait Upload");
+		WaitForSingleObject(m_FenceEvent, INFINITE);
+	}
 
 	// callbacks for resources to load
 	for (size_t i = 0; i < m_ResourceQueue.size(); ++i)
@@ -22,6 +22,9 @@ public:
 	DX12Material *		PushMaterial(void * i_Data);
 	DX12Texture *		PushTexture(void * i_Data);
 
+	// load the resources in queue now (called by the engine at the beginning of each frame)
+	void		PushResourceOnGPUWithWait();
+
 	// friend class
 	friend class Engine;
 private:
@@ -29,7 +32,6 @@ private:
 	~DX12ResourceManager();
 
 	// resource management
-	void		PushResourceOnGPUWithWait();
 	void		PushResourceOnGPU();
 	
 	struct ResourceData
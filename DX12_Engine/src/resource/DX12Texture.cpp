@@ -1,6 +1,8 @@
 #include "DX12Texture.h"
 
 #include "dx12/DX12Utils.h"
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12BindlessHeap.h"
 
 DXGI_FORMAT DX12Texture::GetFormat() const
 {
@@ -22,8 +24,19 @@ D3D12_CPU_DESCRIPTOR_HANDLE DX12Texture::GetCPUDescriptorHandle() const
 	return m_DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
 }
 
+ID3D12DescriptorHeap * DX12Texture::GetDescriptorHeap() const
+{
+	return m_DescriptorHeap;
+}
+
+UINT DX12Texture::GetBindlessIndex() const
+{
+	return m_BindlessIndex;
+}
+
 DX12Texture::DX12Texture()
 	:m_DescriptorHeap(nullptr)
+	,m_BindlessIndex(DescriptorAllocator::InvalidIndex)
 	,m_ResourceBuffer(nullptr)
 	,m_UploadBuffer(nullptr)
 {
@@ -71,10 +84,21 @@ void DX12Texture::LoadFromData(const void * i_Data, ID3D12GraphicsCommandList *
 
 	i_Device->CreateShaderResourceView(m_ResourceBuffer, &srvDesc, m_DescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 
+	// the same view in the bindless heap : the materials index the texture
+	DX12BindlessHeap * bindlessHeap = DX12RenderEngine::GetInstance().GetBindlessHeap();
+	m_BindlessIndex = bindlessHeap->Allocate();
+	bindlessHeap->CreateShaderResourceView(m_BindlessIndex, m_ResourceBuffer, &srvDesc);
+
 	// delete the data
 	delete data;
 }
 
+void DX12Texture::LoadHeadless(const void * i_Data)
+{
+	// the description is preloaded : there is no resource buffer
+	delete (const DX12TextureData*)i_Data;
+}
+
 void DX12Texture::PreloadData(const void * i_Data)
 {
 	const DX12TextureData * data = (const DX12TextureData*)i_Data;
@@ -104,6 +128,13 @@ void DX12Texture::Release()
 	SAFE_RELEASE(m_ResourceBuffer);
 	SAFE_RELEASE(m_DescriptorHeap);
 
+	// the index is reused after the frames in flight
+	if (m_BindlessIndex != DescriptorAllocator::InvalidIndex)
+	{
+		DX12RenderEngine::GetInstance().GetBindlessHeap()->Free(m_BindlessIndex);
+		m_BindlessIndex = DescriptorAllocator::InvalidIndex;
+	}
+
 	DX12Resource::Release();
 }
 
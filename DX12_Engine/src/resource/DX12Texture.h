@@ -25,6 +25,8 @@ public:
 	IntVec2						GetSize() const;
 	D3D12_GPU_DESCRIPTOR_HANDLE	GetGPUDescriptorHandle() const;
 	D3D12_CPU_DESCRIPTOR_HANDLE	GetCPUDescriptorHandle() const;
+	ID3D12DescriptorHeap *		GetDescriptorHeap() const;
+	UINT						GetBindlessIndex() const;	// index of the texture in the bindless heap, persistent while the texture is loaded (see DX12BindlessHeap)
 
 	// friend class
 	friend class DX12ResourceManager;
@@ -34,6 +36,7 @@ private:
 
 	// Inherited via DX12Resource
 	virtual void	LoadFromData(const void * i_Data, ID3D12GraphicsCommandList * i_CommandList, ID3D12Device * i_Device) override;
+	virtual void	LoadHeadless(const void * i_Data) override;
 	virtual void	PreloadData(const void * i_Data) override;
 	virtual void	Release() override;
 
@@ -46,4 +49,5 @@ private:
 	ID3D12Resource *		m_ResourceBuffer;
 	ID3D12Resource *		m_UploadBuffer;
 	ID3D12DescriptorHeap *	m_DescriptorHeap;
+	UINT					m_BindlessIndex;
 };
\ No newline at end of file
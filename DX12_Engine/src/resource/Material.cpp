@@ -47,57 +47,52 @@ Material::~Material()
 
 void Material::LoadFromFile(const std::string & i_Filepath)
 {
-	// resource manage to load some other mData if needed (textures)
-	ResourceManager * resourceManager = Engine::GetInstance().GetResourceManager();
-
-	// generate the file reader to load the material with tinyobj loader
-	tinyobj::MaterialFileReader fileReader(i_Filepath);
-	std::vector<tinyobj::material_t> materials;
-	std::map<std::string, int> materialMap;
+	std::vector<MaterialSpec> materials;
 	std::string error;
 
-	// fill global information
-	m_Filepath	= i_Filepath;
-	m_Name		= i_Filepath;
-
-	fileReader("", &materials, &materialMap, &error);
-
-	if (materials.size() == 0)
+	if (!ReadMaterialFile(i_Filepath, materials, error))
 	{
 		ASSERT_ERROR(error.c_str());
 		return;
 	}
 
-	for (size_t i = 0; i < materials.size(); ++i)
-	{
-		// create mData (this will be deleted by DX12Resources)
-		DX12Material::DX12MaterialData * mData = new DX12Material::DX12MaterialData;
-		tinyobj::material_t mat = materials[i];
+	// the materials of the file are loaded as the ones of a data
+	MaterialData data;
+	data.Materials		= materials.data();
+	data.MaterialCount	= materials.size();
+	data.Filepath		= i_Filepath;
+	data.Name			= i_Filepath;
+
+	LoadFromData(&data);
+}
+
+bool Material::ReadMaterialFile(const std::string & i_Filepath, std::vector<MaterialSpec> & o_Materials, std::string & o_Error)
+{
+	// generate the file reader to load the material with tinyobj loader
+	tinyobj::MaterialFileReader fileReader(i_Filepath);
+	std::vector<tinyobj::material_t> materials;
+	std::map<std::string, int> materialMap;
 
-		// fill global mData resource
-		mData->Filepath	= m_Filepath;
-		mData->Name		= mat.name;
+	fileReader("", &materials, &materialMap, &o_Error);
 
-		// retreive other mData
-		mData->Ka = mat.ambient;
-		mData->Kd = mat.diffuse;
-		mData->Ke = mat.emission;
-		mData->Ks = mat.specular;
+	if (materials.size() == 0)
+		return false;
 
-		DX12Material * material = Engine::GetInstance().GetRenderResourceManager()->PushMaterial(mData);
+	o_Materials.resize(materials.size());
 
-		if (material == nullptr)
-		{
-			ASSERT_ERROR("Unable to load DX12Material correctly");
-			DEBUG_BREAK;
-		}
-		else
-		{
-			m_Materials.push_back(material);
-		}
+	for (size_t i = 0; i < materials.size(); ++i)
+	{
+		const tinyobj::material_t & mat = materials[i];
+		MaterialSpec & spec = o_Materials[i];
+
+		spec.Name	= mat.name;
+		spec.Ka		= mat.ambient;
+		spec.Kd		= mat.diffuse;
+		spec.Ke		= mat.emission;
+		spec.Ks		= mat.specular;
 	}
 
-	NotifyFinishLoad();
+	return true;
 }
 
 void Material::LoadFromData(const void * i_Data)
@@ -126,6 +121,13 @@ void Material::LoadFromData(const void * i_Data)
 		// To do : 
 		mData->map_Ka = mData->map_Kd = mData->map_Ks = false;
 
+		// the material is an instance of the first one with the same permutation (maps and shader)
+		for (size_t j = 0; j < m_Materials.size() && mData->Parent == nullptr; ++j)
+		{
+			if (!m_Materials[j]->IsInstance() && m_Materials[j]->HasSamePermutation(*mData))
+				mData->Parent = m_Materials[j];
+		}
+
 		DX12Material * material = Engine::GetInstance().GetRenderResourceManager()->PushMaterial(mData);
 
 		if (material == nullptr)
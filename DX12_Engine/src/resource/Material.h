@@ -34,6 +34,9 @@ public:
 	// infomation
 	size_t				GetMaterialCount() const;
 
+	// materials of a file, read without the engine : can be done on any thread (see LevelStreamer)
+	static bool			ReadMaterialFile(const std::string & i_Filepath, std::vector<MaterialSpec> & o_Materials, std::string & o_Error);
+
 	// friend class
 	friend class ResourceManager;
 private:
@@ -170,7 +170,11 @@ void Mesh::LoadFromFile(const std::string & i_Filepath)
 
 void Mesh::LoadFromData(const void * i_Data)
 {
-	TO_DO;
+	MeshFileData * data = (MeshFileData*)i_Data;
+
+	m_Filepath	= data->Filepath;
+	m_Name		= ExtractFileName(data->Filepath);
+	LoadMeshFileData(*data);
 }
 
 FORCEINLINE void Mesh::LoadPrimitiveMesh(const std::string & i_PrimitiveName)
@@ -236,43 +240,125 @@ FORCEINLINE void Mesh::LoadPrimitiveMesh(const std::string & i_PrimitiveName)
 }
 
 FORCEINLINE void Mesh::LoadMeshFromFile(const std::string & i_Filepath)
+{
+	MeshFileData data;
+	std::string error;
+
+	if (!ReadMeshFile(i_Filepath, data, error))
+	{
+		// end loading
+		ASSERT_ERROR(error.c_str());
+		DEBUG_BREAK;
+		return;
+	}
+
+	LoadMeshFileData(data);
+}
+
+void Mesh::LoadMeshFileData(MeshFileData & io_Data)
 {
 	ResourceManager * const resourceManager			= Engine::GetInstance().GetResourceManager();
 	DX12ResourceManager * const dx12ResourceManager = Engine::GetInstance().GetRenderResourceManager();
 
+	const std::string materialName = "Generated:" + m_Filepath + "_" + m_Name;
+
+	// for each shapes
+	for (size_t sh = 0; sh < io_Data.Shapes.size(); ++sh)
+	{
+		MeshData mData;	// create a new mesh data that will be contains
+		MeshFileData::Shape & shape = io_Data.Shapes[sh];
+
+		// meshes without normals or uv are rendered with a specific shader permutation (see DX12Material)
+		if (!(shape.Flags & DX12PipelineState::EElementFlags::eHaveNormal) || !(shape.Flags & DX12PipelineState::EElementFlags::eHaveTexcoord))
+		{
+			PRINT_DEBUG("Mesh %s : shape %s loaded with a partial layout (flags : %llu)", m_Name.c_str(), shape.Name.c_str(), shape.Flags);
+		}
+
+		// To do : search before and 
+		if (!shape.Materials.empty())
+		{
+			Material::MaterialData matData;
+			matData.Filepath = materialName;	// put the identifier
+			matData.MaterialCount = shape.Materials.size();
+			matData.Materials = shape.Materials.data();
+
+			Material * material = resourceManager->LoadMaterialWithData(&matData);
+
+			if (material != nullptr && material->IsLoaded())
+			{
+				for (size_t i = 0; i < shape.Materials.size(); ++i)
+				{
+					DX12Material * m = material->GetDX12Material(shape.Materials[i].Name);
+
+					if (m != nullptr)
+					{
+						mData.Materials.push_back(m);
+					}
+				}
+			}
+			else
+			{
+				ASSERT_ERROR("Error when loading materials");
+				return;
+			}
+		}
+
+		// generate layout for the shape
+		D3D12_INPUT_LAYOUT_DESC layout;
+		DX12PipelineState::CreateInputLayoutFromFlags(layout, shape.Flags);
+		
+		// generate mesh data for mesh loading
+		DX12Mesh::DX12MeshData * meshData = new DX12Mesh::DX12MeshData;
+		DX12PipelineState::CopyInputLayout(meshData->InputLayout, layout);
+
+		// fill buffers into the data (the mesh takes the vertex buffer)
+		meshData->VerticesBuffer	= reinterpret_cast<BYTE*>(shape.Vertices);
+		meshData->VerticesCount		= shape.VertexCount;
+
+		// fill name
+		meshData->Filepath	= m_Filepath;
+		meshData->Name		= shape.Name;
+
+		// generate the mesh (will be uploaded onto the GPU later)
+		mData.MeshBuffer = dx12ResourceManager->PushMesh(meshData);
+		mData.VertexData = reinterpret_cast<BYTE*>(shape.Vertices);
+		mData.IndexData = nullptr;
+		shape.Vertices = nullptr;
+
+		ASSERT(mData.MeshBuffer != nullptr);
+
+		m_MeshData.push_back(mData);
+	}
+
+	NotifyFinishLoad();
+}
+
+bool Mesh::ReadMeshFile(const std::string & i_Filepath, MeshFileData & o_Data, std::string & o_Error)
+{
 	tinyobj::attrib_t					attrib;
 	std::vector<tinyobj::shape_t>		shapes;
 	std::vector<tinyobj::material_t>	materials;
 
-	// create load directory
-	std::string error;
-	std::string textureFolderDefault = "resources/tex/";	// default path for textures (tested if texture not found in the base path)
-	std::string textureFolder = ExtractFilePath(i_Filepath);
-	std::string materialFolder = ExtractFilePath(i_Filepath);
-	std::string objFilepath(i_Filepath);
+	// create load directory (the materials are next to the mesh)
+	const std::string materialFolder = i_Filepath.substr(0, i_Filepath.find_last_of('/') + 1);
 
 	// load the mesh and materials
-	bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &error, objFilepath.c_str(), materialFolder.c_str());
+	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &o_Error, i_Filepath.c_str(), materialFolder.c_str()))
+		return false;
 
-	if (!ret)
-	{
-		// end loading
-		ASSERT_ERROR(error.c_str());
-		DEBUG_BREAK;
-		return;
-	}
+	o_Data.Filepath = i_Filepath;
+	o_Data.Shapes.resize(shapes.size());
 
 	// for each shapes
 	for (size_t sh = 0; sh < shapes.size(); ++sh)
 	{
-		MeshData mData;	// create a new mesh data that will be contains
+		MeshFileData::Shape & data = o_Data.Shapes[sh];
 		UINT stride = 3;	// default stride in float (3 float for positions)
 		tinyobj::shape_t * shape = &shapes[sh];
 		const size_t verticeCount = shape->mesh.indices.size();
-		std::string shapeName = m_Name + ":" + shape->name;	// this will be : Resource name : 
 
 		// compute the flag :
-		// by default the mesh always have normals
+		// position is always here, normals and uv are optional
 		const tinyobj::index_t origin = shape->mesh.indices[0];
 		UINT64 flags = DX12PipelineState::EElementFlags::eNone;
 
@@ -303,20 +389,8 @@ FORCEINLINE void Mesh::LoadMeshFromFile(const std::string & i_Filepath)
 			flags |= DX12PipelineState::EElementFlags::eHaveTexcoord;
 			stride += 2;
 		}
-		if (meshMaterials.size() > 1)
-		{
-			// To do : add a flags for material index
-			// the materials will be filled into the buffer needed
-			TO_DO;
-		}
-
-		// To do : support other mesh types
-		// only one supported type for now
-		if (!(flags & DX12PipelineState::EElementFlags::eHaveNormal) || !(flags & DX12PipelineState::EElementFlags::eHaveTexcoord))
-		{
-			TO_DO;
-			return;
-		}
+		// To do : add a flags for material index when the shape have more than one material
+		// the materials will be filled into the buffer needed
 
 		// generate vertex buffer
 		FLOAT * const verticeBuffer = new FLOAT[verticeCount * stride];
@@ -347,87 +421,42 @@ FORCEINLINE void Mesh::LoadMeshFromFile(const std::string & i_Filepath)
 			}
 		}
 
-		std::string materialName = "Generated:" + m_Filepath + "_" + m_Name;
+		data.Name			= shape->name;
+		data.Flags			= flags;
+		data.Vertices		= verticeBuffer;
+		data.VertexCount	= (UINT)verticeCount;
+		data.Materials.resize(meshMaterials.size());
 
-		// To do : search before and 
-		if (!meshMaterials.empty())
+		for (size_t i = 0; i < meshMaterials.size(); ++i)
 		{
-			Material::MaterialData matData;
-			matData.Filepath = materialName;	// put the identifier
-			matData.MaterialCount = meshMaterials.size();
-			matData.Materials = new Material::MaterialSpec[matData.MaterialCount];
-
-			for (size_t i = 0; i < meshMaterials.size(); ++i)
-			{
-				if (meshMaterials[i] == -1)	continue;	// the mesh have no material
-
-				tinyobj::material_t mat = materials[meshMaterials[i]];
-				Material::MaterialSpec & m = matData.Materials[i];
-
-				// Name
-				m.Name = mat.name;
-
-				// To do : load textures
-				/*desc.map_Ka = LoadTexture(mat.ambient_texname, textureFolder, resourcesManager);
-				desc.map_Kd = LoadTexture(mat.diffuse_texname, textureFolder, resourcesManager);
-				desc.map_Ks = LoadTexture(mat.specular_texname, textureFolder, resourcesManager);*/
-
-				// retreive other data
-				m.Ka = mat.ambient;
-				m.Kd = mat.diffuse;
-				m.Ke = mat.emission;
-				m.Ks = mat.specular;
-			}
-
-			Material * material = resourceManager->LoadMaterialWithData(&matData);
-
-			if (material->IsLoaded())
-			{
-				for (size_t i = 0; i < meshMaterials.size(); ++i)
-				{
-					tinyobj::material_t mat = materials[meshMaterials[i]];
-					DX12Material * m = material->GetDX12Material(mat.name);
-
-					if (m != nullptr)
-					{
-						mData.Materials.push_back(m);
-					}
-				}
-			}
-			else
-			{
-				ASSERT_ERROR("Error when loading materials");
-				return;
-			}
+			const tinyobj::material_t & mat = materials[meshMaterials[i]];
+			Material::MaterialSpec & m = data.Materials[i];
+
+			// Name
+			m.Name = mat.name;
+
+			// To do : load textures
+			/*desc.map_Ka = LoadTexture(mat.ambient_texname, textureFolder, resourcesManager);
+			desc.map_Kd = LoadTexture(mat.diffuse_texname, textureFolder, resourcesManager);
+			desc.map_Ks = LoadTexture(mat.specular_texname, textureFolder, resourcesManager);*/
+
+			// retreive other data
+			m.Ka = mat.ambient;
+			m.Kd = mat.diffuse;
+			m.Ke = mat.emission;
+			m.Ks = mat.specular;
 		}
+	}
 
-		// generate layout for the shape
-		D3D12_INPUT_LAYOUT_DESC layout;
-		DX12PipelineState::CreateInputLayoutFromFlags(layout, flags);
-		
-		// generate mesh data for mesh loading
-		DX12Mesh::DX12MeshData * meshData = new DX12Mesh::DX12MeshData;
-		DX12PipelineState::CopyInputLayout(meshData->InputLayout, layout);
-
-		// fill buffers into the data
-		meshData->VerticesBuffer	= reinterpret_cast<BYTE*>(verticeBuffer);
-		meshData->VerticesCount		= (UINT)verticeCount;
-
-		// fill name
-		meshData->Filepath	= m_Filepath;
-		meshData->Name		= shape->name;
-
-		// generate the mesh (will be uploaded onto the GPU later)
-		mData.MeshBuffer = dx12ResourceManager->PushMesh(meshData);
-		mData.VertexData = reinterpret_cast<BYTE*>(verticeBuffer);
-		mData.IndexData = nullptr;
-
-		ASSERT(mData.MeshBuffer != nullptr);
+	return true;
+}
 
-		m_MeshData.push_back(mData);
+Mesh::MeshFileData::~MeshFileData()
+{
+	for (size_t i = 0; i < Shapes.size(); ++i)
+	{
+		delete[] Shapes[i].Vertices;
 	}
-
-	NotifyFinishLoad();
 }
 
 Mesh::Mesh()
@@ -6,6 +6,7 @@
 
 #include "Resource.h"
 #include "resource/DX12Mesh.h"
+#include "resource/Material.h"
 #include <vector>
 
 // class predef : these are all the DX12Resource used for render the model
@@ -28,6 +29,27 @@ public:
 	size_t			GetMaterialCount(const std::string & i_Name) const;
 	bool			IsMultiMesh() const;	// mesh have multi shapes
 
+	// CPU data of a mesh file, read without the engine : can be done on any thread (see LevelStreamer)
+	// the mesh loaded with the data takes the vertex buffers (see ResourceManager::LoadMesh)
+	struct MeshFileData
+	{
+		struct Shape
+		{
+			std::string							Name;
+			UINT64								Flags = 0;		// DX12PipelineState::EElementFlags
+			FLOAT *								Vertices = nullptr;
+			UINT								VertexCount = 0;
+			std::vector<Material::MaterialSpec>	Materials;		// generated materials of the shape
+		};
+
+		std::string				Filepath;
+		std::vector<Shape>		Shapes;
+
+		~MeshFileData();	// delete the vertex buffers not taken by a mesh
+	};
+
+	static bool		ReadMeshFile(const std::string & i_Filepath, MeshFileData & o_Data, std::string & o_Error);
+
 	friend class ResourceManager;
 protected:
 	// constructor
@@ -53,4 +75,5 @@ protected:
 	// internal helpers
 	void	LoadPrimitiveMesh(const std::string & i_PrimitiveName);
 	void	LoadMeshFromFile(const std::string & i_Filepath);
+	void	LoadMeshFileData(MeshFileData & io_Data);
 };
\ No newline at end of file
@@ -4,9 +4,14 @@
 #include "resource/Mesh.h"
 #include "resource/Material.h"
 #include "resource/Texture.h"
+#include "resource/Skeleton.h"
+#include "resource/AnimationClip.h"
+#include "engine/CPUProfiler.h"
+#include "engine/Utils.h"
 
 Mesh * ResourceManager::LoadMesh(const std::string & i_File)
 {
+	CPU_ZONE("Load Mesh");
 	Mesh * mesh = m_Meshes[i_File];
 
 	if (mesh == nullptr)
@@ -35,6 +40,7 @@ Mesh * ResourceManager::LoadMesh(const std::string & i_File)
 
 Material * ResourceManager::LoadMaterial(const std::string & i_File)
 {
+	CPU_ZONE("Load Material");
 	Material * material = m_Materials[i_File];
 
 	if (material == nullptr)
@@ -62,6 +68,7 @@ Material * ResourceManager::LoadMaterial(const std::string & i_File)
 
 Texture * ResourceManager::LoadTexture(const std::string & i_File)
 {
+	CPU_ZONE("Load Texture");
 	Texture * texture = m_Textures[i_File];
 
 	if (texture == nullptr)
@@ -87,6 +94,122 @@ Texture * ResourceManager::LoadTexture(const std::string & i_File)
 	return texture;
 }
 
+Skeleton * ResourceManager::LoadSkeleton(const std::string & i_File)
+{
+	CPU_ZONE("Load Skeleton");
+	Skeleton * skeleton = m_Skeletons[i_File];
+
+	if (skeleton == nullptr)
+	{
+		skeleton = new Skeleton;
+		skeleton->LoadFromFile(i_File);
+
+		if (skeleton->IsLoaded())
+		{
+			m_Skeletons[i_File]					= skeleton;
+			m_SkeletonsId[skeleton->GetId()]	= skeleton;
+			m_AllResources[skeleton->GetId()]	= skeleton;
+		}
+		else
+		{
+			ASSERT_ERROR("Unable to load skeleton %s", i_File.c_str());
+			delete skeleton;
+			skeleton = nullptr;
+		}
+	}
+
+	return skeleton;
+}
+
+AnimationClip * ResourceManager::LoadAnimation(const std::string & i_File)
+{
+	CPU_ZONE("Load Animation");
+	AnimationClip * animation = m_Animations[i_File];
+
+	if (animation == nullptr)
+	{
+		animation = new AnimationClip;
+		animation->LoadFromFile(i_File);
+
+		if (animation->IsLoaded())
+		{
+			m_Animations[i_File]				= animation;
+			m_AnimationsId[animation->GetId()]	= animation;
+			m_AllResources[animation->GetId()]	= animation;
+		}
+		else
+		{
+			ASSERT_ERROR("Unable to load animation %s", i_File.c_str());
+			delete animation;
+			animation = nullptr;
+		}
+	}
+
+	return animation;
+}
+
+Mesh * ResourceManager::LoadMesh(const std::string & i_File, const void * i_FileData)
+{
+	CPU_ZONE("Load Mesh");
+	Mesh * mesh = m_Meshes[i_File];
+
+	if (mesh == nullptr)
+	{
+		mesh = new Mesh;
+		mesh->LoadFromData(i_FileData);
+
+		if (mesh->IsLoaded())
+		{
+			m_Meshes[i_File]				= mesh;
+			m_MeshesId[mesh->GetId()]		= mesh;
+			m_AllResources[mesh->GetId()]	= mesh;
+		}
+		else
+		{
+			ASSERT_ERROR("Unable to load mesh %s", i_File.c_str());
+			delete mesh;
+			mesh = nullptr;
+		}
+	}
+
+	return mesh;
+}
+
+Material * ResourceManager::LoadMaterial(const std::string & i_File, const void * i_FileData)
+{
+	CPU_ZONE("Load Material");
+	Material * material = m_Materials[i_File];
+
+	if (material == nullptr)
+	{
+		const std::vector<Material::MaterialSpec> & specs = *(const std::vector<Material::MaterialSpec>*)i_FileData;
+
+		Material::MaterialData data;
+		data.Materials		= const_cast<Material::MaterialSpec*>(specs.data());
+		data.MaterialCount	= specs.size();
+		data.Filepath		= i_File;
+		data.Name			= i_File;
+
+		material = new Material;
+		material->LoadFromData(&data);
+
+		if (material->IsLoaded())
+		{
+			m_Materials[i_File]					= material;
+			m_MaterialsId[material->GetId()]	= material;
+			m_AllResources[material->GetId()]	= material;
+		}
+		else
+		{
+			ASSERT_ERROR("Unable to load material %s", i_File.c_str());
+			delete material;
+			material = nullptr;
+		}
+	}
+
+	return material;
+}
+
 Material * ResourceManager::LoadMaterialWithData(const void * i_Data)
 {
 	Material * material = new Material;
@@ -107,6 +230,46 @@ Material * ResourceManager::LoadMaterialWithData(const void * i_Data)
 	return material;
 }
 
+Skeleton * ResourceManager::LoadSkeletonWithData(const void * i_Data)
+{
+	Skeleton * skeleton = new Skeleton;
+	skeleton->LoadFromData(i_Data);
+
+	if (skeleton->IsLoaded())
+	{
+		m_AllResources[skeleton->GetId()] = skeleton;
+		m_SkeletonsId[skeleton->GetId()] = skeleton;
+	}
+	else
+	{
+		ASSERT_ERROR("Unable to load skeleton");
+		delete skeleton;
+		skeleton = nullptr;
+	}
+
+	return skeleton;
+}
+
+AnimationClip * ResourceManager::LoadAnimationWithData(const void * i_Data)
+{
+	AnimationClip * animation = new AnimationClip;
+	animation->LoadFromData(i_Data);
+
+	if (animation->IsLoaded())
+	{
+		m_AllResources[animation->GetId()] = animation;
+		m_AnimationsId[animation->GetId()] = animation;
+	}
+	else
+	{
+		ASSERT_ERROR("Unable to load animation");
+		delete animation;
+		animation = nullptr;
+	}
+
+	return animation;
+}
+
 Mesh * ResourceManager::GetMeshByName(const std::string & i_Name) const
 {
 	auto itr = m_MeshesId.begin();
@@ -278,6 +441,28 @@ FORCEINLINE Material * ResourceManager::GetMaterialById(UINT64 i_Id) const
 	return nullptr;
 }
 
+Skeleton * ResourceManager::GetSkeletonById(UINT64 i_Id) const
+{
+	auto itr = m_SkeletonsId.find(i_Id);
+	if (itr != m_SkeletonsId.end())
+	{
+		return (*itr).second;
+	}
+
+	return nullptr;
+}
+
+AnimationClip * ResourceManager::GetAnimationById(UINT64 i_Id) const
+{
+	auto itr = m_AnimationsId.find(i_Id);
+	if (itr != m_AnimationsId.end())
+	{
+		return (*itr).second;
+	}
+
+	return nullptr;
+}
+
 size_t ResourceManager::GetResourceCount(EResourceType i_ResourceType) const
 {
 	switch (i_ResourceType)
@@ -286,6 +471,8 @@ size_t ResourceManager::GetResourceCount(EResourceType i_ResourceType) const
 	case ResourceManager::eMesh:		return m_MeshesId.size();
 	case ResourceManager::eTexture:		return m_TexturesId.size();
 	case ResourceManager::eMaterial:	return m_MaterialsId.size();
+	case ResourceManager::eSkeleton:	return m_SkeletonsId.size();
+	case ResourceManager::eAnimation:	return m_AnimationsId.size();
 	default:							return 0;
 	}
 }
@@ -349,8 +536,55 @@ Texture * ResourceManager::GetTextureByIndex(size_t i_Index) const
 
 bool ResourceManager::ReleaseResource(const UINT64 i_Id)
 {
-	TO_DO;
-	return false;
+	auto resourceItr = m_AllResources.find(i_Id);
+
+	if (resourceItr == m_AllResources.end())
+		return false;
+
+	Resource * resource = (*resourceItr).second;
+	m_AllResources.erase(resourceItr);
+
+	// remove the resource from the researchers
+	if (m_MeshesId.erase(i_Id) != 0)
+	{
+		EraseResource(m_Meshes, resource);
+
+		// the generated materials of the mesh are released with it
+		const std::string generatedPath = "Generated:" + resource->GetFilepath() + "_";
+		std::vector<UINT64> generatedMaterials;
+
+		for (auto itr = m_MaterialsId.begin(); itr != m_MaterialsId.end(); ++itr)
+		{
+			if (String::StartWith((*itr).second->GetFilepath(), generatedPath))
+				generatedMaterials.push_back((*itr).first);
+		}
+
+		for (size_t i = 0; i < generatedMaterials.size(); ++i)
+		{
+			ReleaseResource(generatedMaterials[i]);
+		}
+	}
+	else if (m_MaterialsId.erase(i_Id) != 0)
+	{
+		EraseResource(m_Materials, resource);
+	}
+	else if (m_TexturesId.erase(i_Id) != 0)
+	{
+		EraseResource(m_Textures, resource);
+	}
+	else if (m_SkeletonsId.erase(i_Id) != 0)
+	{
+		EraseResource(m_Skeletons, resource);
+	}
+	else if (m_AnimationsId.erase(i_Id) != 0)
+	{
+		EraseResource(m_Animations, resource);
+	}
+
+	resource->Unload();
+	delete resource;
+
+	return true;
 }
 
 void ResourceManager::CleanUnusedResources()
@@ -370,6 +604,20 @@ void ResourceManager::CleanResources()
 	}
 }
 
+template <class _Resource>
+void ResourceManager::EraseResource(std::map<const std::string, _Resource *> & io_Resources, const Resource * i_Resource)
+{
+	auto itr = io_Resources.begin();
+
+	while (itr != io_Resources.end())
+	{
+		if ((*itr).second == i_Resource)
+			itr = io_Resources.erase(itr);
+		else
+			++itr;
+	}
+}
+
 ResourceManager::ResourceManager()
 {
 }
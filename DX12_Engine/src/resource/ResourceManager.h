@@ -6,6 +6,8 @@ class Resource;
 class Mesh;
 class Texture;
 class Material;
+class Skeleton;
+class AnimationClip;
 
 #include <basetsd.h>	// types UINT64
 #include <vector>
@@ -18,8 +20,15 @@ public:
 	Mesh *		LoadMesh(const std::string & i_File);
 	Material *	LoadMaterial(const std::string & i_File);
 	Texture *	LoadTexture(const std::string & i_File);
+	Skeleton *		LoadSkeleton(const std::string & i_File);
+	AnimationClip *	LoadAnimation(const std::string & i_File);
+	// resource loading with the data of the file read before (the file is not read again, see Mesh::ReadMeshFile and Material::ReadMaterialFile)
+	Mesh *		LoadMesh(const std::string & i_File, const void * i_FileData);		// Mesh::MeshFileData
+	Material *	LoadMaterial(const std::string & i_File, const void * i_FileData);	// std::vector<Material::MaterialSpec>
 	// resource loading with data
 	Material *	LoadMaterialWithData(const void * i_Data);
+	Skeleton *		LoadSkeletonWithData(const void * i_Data);		// Skeleton::SkeletonData
+	AnimationClip *	LoadAnimationWithData(const void * i_Data);	// AnimationClip::ClipData
 
 	// To do : manage data generated resources (can be loaded with unique id)
 
@@ -48,6 +57,8 @@ public:
 	Mesh *			GetMeshById(UINT64 i_Id) const;
 	Texture *		GetTextureById(UINT64 i_Id) const;
 	Material *		GetMaterialById(UINT64 i_Id) const;
+	Skeleton *		GetSkeletonById(UINT64 i_Id) const;
+	AnimationClip *	GetAnimationById(UINT64 i_Id) const;
 
 	// informations
 	enum EResourceType
@@ -56,6 +67,8 @@ public:
 		eMesh,
 		eTexture,
 		eMaterial,
+		eSkeleton,
+		eAnimation,
 	};
 	size_t		GetResourceCount(EResourceType i_ResourceType) const;
 
@@ -67,7 +80,7 @@ public:
 	Texture *		GetTextureByIndex(size_t i_Index) const;
 
 	// release resource
-	bool			ReleaseResource(const UINT64 i_Id);	// release resource by Id
+	bool			ReleaseResource(const UINT64 i_Id);	// release resource by Id (the generated materials of a mesh are released with it)
 	void			CleanUnusedResources();	// clean resources witch are not used
 	void			CleanResources();	// clean all loaded resources
 
@@ -76,6 +89,10 @@ private:
 	ResourceManager();
 	~ResourceManager();
 
+	// remove a resource from a file name researcher
+	template <class _Resource>
+	void		EraseResource(std::map<const std::string, _Resource *> & io_Resources, const Resource * i_Resource);
+
 	// resource mapper
 	std::map<const UINT64, Resource *>	m_AllResources;
 
@@ -83,11 +100,15 @@ private:
 	std::map<const std::string, Mesh *>		m_Meshes;		// mesh data
 	std::map<const std::string, Texture*>	m_Textures;		// textures data
 	std::map<const std::string, Material*>	m_Materials;	// materials data
+	std::map<const std::string, Skeleton*>		m_Skeletons;
+	std::map<const std::string, AnimationClip*>	m_Animations;
 
 	// id researcher
 	// this contains all generated or not generated resources (there can be more resources)
 	std::map<const UINT64, Mesh*>		m_MeshesId;		
 	std::map<const UINT64, Texture*>	m_TexturesId;
 	std::map<const UINT64, Material*>	m_MaterialsId;
+	std::map<const UINT64, Skeleton*>		m_SkeletonsId;
+	std::map<const UINT64, AnimationClip*>	m_AnimationsId;
 
 };
\ No newline at end of file
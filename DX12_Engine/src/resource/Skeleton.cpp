@@ -0,0 +1,135 @@
+#include "Skeleton.h"
+
+#include "engine/Debug.h"
+#include <stdio.h>
+
+UINT Skeleton::GetBoneCount() const
+{
+	return (UINT)m_Bones.size();
+}
+
+const Skeleton::Bone & Skeleton::GetBone(UINT i_Index) const
+{
+	ASSERT(i_Index < m_Bones.size());
+	return m_Bones[i_Index];
+}
+
+UINT Skeleton::GetBoneIndex(const std::string & i_Name) const
+{
+	for (UINT i = 0; i < (UINT)m_Bones.size(); ++i)
+	{
+		if (m_Bones[i].Name == i_Name)
+			return i;
+	}
+
+	return InvalidBone;
+}
+
+const XMMATRIX & Skeleton::GetInverseBindMatrix(UINT i_Index) const
+{
+	ASSERT(i_Index < m_InverseBindMatrices.size());
+	return m_InverseBindMatrices[i_Index];
+}
+
+Skeleton::Skeleton()
+	:Resource()
+{
+}
+
+Skeleton::~Skeleton()
+{
+}
+
+void Skeleton::LoadFromFile(const std::string & i_Filepath)
+{
+	m_Filepath	= i_Filepath;
+	m_Name		= ExtractFileName(i_Filepath);
+
+	FILE * file = nullptr;
+	if (fopen_s(&file, i_Filepath.c_str(), "rb") != 0 || file == nullptr)
+	{
+		PRINT_DEBUG("[Skeleton] unable to open %s", i_Filepath.c_str());
+		return;
+	}
+
+	Header header;
+	bool read = (fread(&header, sizeof(Header), 1, file) == 1)
+		&& header.Magic == SKELETON_FILE_MAGIC
+		&& header.Version == SKELETON_FILE_VERSION
+		&& header.BoneCount > 0 && header.BoneCount <= SKELETON_MAX_BONES;
+
+	std::vector<BoneRecord> records(read ? header.BoneCount : 0);
+	read = read && (fread(records.data(), sizeof(BoneRecord), records.size(), file) == records.size());
+	fclose(file);
+
+	if (!read)
+	{
+		PRINT_DEBUG("[Skeleton] %s is not a valid skeleton file", i_Filepath.c_str());
+		return;
+	}
+
+	std::vector<Bone> bones(records.size());
+
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		const BoneRecord & record = records[i];
+		Bone & bone = bones[i];
+
+		bone.Name			= std::string(record.Name, strnlen_s(record.Name, sizeof(record.Name)));
+		bone.Parent			= record.Parent;
+		bone.Rotation		= XMFLOAT4(record.Rotation);
+		bone.Translation	= XMFLOAT3(record.Translation);
+		bone.Scale			= XMFLOAT3(record.Scale);
+	}
+
+	if (Build(bones))
+		NotifyFinishLoad();
+}
+
+void Skeleton::LoadFromData(const void * i_Data)
+{
+	const SkeletonData * data = (const SkeletonData*)i_Data;
+
+	if (data->Name != "")		m_Name = data->Name;
+	if (data->Filepath != "")	m_Filepath = data->Filepath;
+
+	if (data->Bones.empty() || data->Bones.size() > SKELETON_MAX_BONES)
+	{
+		PRINT_DEBUG("[Skeleton] %s : invalid bone count %u", m_Name.c_str(), (UINT)data->Bones.size());
+		return;
+	}
+
+	if (Build(data->Bones))
+		NotifyFinishLoad();
+}
+
+bool Skeleton::Build(const std::vector<Bone> & i_Bones)
+{
+	// the parent of a bone is before it : model transforms are computed in order
+	for (UINT i = 0; i < (UINT)i_Bones.size(); ++i)
+	{
+		if (i_Bones[i].Parent != InvalidBone && i_Bones[i].Parent >= i)
+		{
+			PRINT_DEBUG("[Skeleton] %s : the parent of the bone %s is not before it", m_Name.c_str(), i_Bones[i].Name.c_str());
+			return false;
+		}
+	}
+
+	m_Bones = i_Bones;
+
+	// bind pose in model space
+	std::vector<XMMATRIX> bindMatrices(m_Bones.size());
+	m_InverseBindMatrices.resize(m_Bones.size());
+
+	for (size_t i = 0; i < m_Bones.size(); ++i)
+	{
+		const Bone & bone = m_Bones[i];
+		const XMMATRIX local = XMMatrixAffineTransformation(XMLoadFloat3(&bone.Scale), XMVectorZero(),
+			XMQuaternionNormalize(XMLoadFloat4(&bone.Rotation)), XMLoadFloat3(&bone.Translation));
+
+		bindMatrices[i]				= (bone.Parent == InvalidBone) ? local : XMMatrixMultiply(local, bindMatrices[bone.Parent]);
+		m_InverseBindMatrices[i]	= XMMatrixInverse(nullptr, bindMatrices[i]);
+	}
+
+	return true;
+}
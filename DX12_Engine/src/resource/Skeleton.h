@@ -0,0 +1,79 @@
+// Skeleton management
+// bones are sorted parents first : the model transforms of a pose are computed in one pass (see Animation::ComputeSkinningPalette)
+// the bind pose is the local transform of each bone, the inverse bind matrices bring the vertices of the skinned meshes in bone space
+// file (.skel) : header and fixed size bone records, little-endian as in memory (see SceneFile)
+
+#pragma once
+
+#include "Resource.h"
+#include <Windows.h>
+#include <DirectXMath.h>
+#include <vector>
+
+using namespace DirectX;
+
+#define SKELETON_FILE_MAGIC		0x4C4B5344	// "DSKL"
+#define SKELETON_FILE_VERSION	1
+#define SKELETON_MAX_BONES		256			// bone indices of the vertices are 8 bits
+
+class Skeleton : public Resource
+{
+public:
+	static const UINT InvalidBone = (UINT)-1;
+
+	struct Bone
+	{
+		std::string		Name;
+		UINT			Parent = InvalidBone;	// InvalidBone : root bone
+		// bind pose (local to the parent)
+		XMFLOAT4		Rotation = XMFLOAT4(0.f, 0.f, 0.f, 1.f);
+		XMFLOAT3		Translation = XMFLOAT3(0.f, 0.f, 0.f);
+		XMFLOAT3		Scale = XMFLOAT3(1.f, 1.f, 1.f);
+	};
+
+	// generated skeleton (see ResourceManager::LoadSkeletonWithData)
+	struct SkeletonData
+	{
+		std::string			Name, Filepath;
+		std::vector<Bone>	Bones;	// parents first
+	};
+
+	// information
+	UINT				GetBoneCount() const;
+	const Bone &		GetBone(UINT i_Index) const;
+	UINT				GetBoneIndex(const std::string & i_Name) const;	// InvalidBone when the skeleton has no bone with this name
+	const XMMATRIX &	GetInverseBindMatrix(UINT i_Index) const;
+
+	friend class ResourceManager;
+protected:
+	Skeleton();
+	~Skeleton();
+
+	// Inherited via Resource
+	virtual void LoadFromFile(const std::string & i_Filepath) override;
+	virtual void LoadFromData(const void * i_Data) override;
+
+private:
+	// file records
+	struct Header
+	{
+		UINT		Magic;
+		UINT		Version;
+		UINT		BoneCount;
+		UINT		Reserved;
+	};
+
+	struct BoneRecord
+	{
+		char		Name[48];	// utf-8, null terminated
+		UINT		Parent;
+		float		Rotation[4];
+		float		Translation[3];
+		float		Scale[3];
+	};
+
+	bool	Build(const std::vector<Bone> & i_Bones);	// check the order of the bones and compute the inverse bind matrices
+
+	std::vector<Bone>		m_Bones;
+	std::vector<XMMATRIX>	m_InverseBindMatrices;
+};
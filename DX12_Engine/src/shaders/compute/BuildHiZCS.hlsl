@@ -0,0 +1,50 @@
+// Hi-Z pyramid compute shader
+// one dispatch per mip : the mip 0 is a copy of the depth buffer, each other mip is the max of 2x2 texels of the previous mip
+// the last texel of a row or column also reduces the remaining texel of an odd size (see GPUCulling::BuildHiZMip)
+
+#include "../lib/Bindless.hlsli"
+
+#define GROUP_SIZE		8		// GPU_CULLING_HIZ_GROUP_SIZE
+
+// b0 root constants (see DX12GPUCulling::BuildHiZ)
+cbuffer HiZMip : register(b0)
+{
+	uint2		source_size;
+	uint2		size;
+	uint		source_index;	// bindless index of the depth buffer or the previous mip
+	uint		copy;			// mip 0 : copy of the depth buffer
+};
+
+RWTexture2D<float>	destination		: register(u0);
+
+[numthreads(GROUP_SIZE, GROUP_SIZE, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+	if (id.x >= size.x || id.y >= size.y)
+		return;
+
+	const Texture2D source = bindless_textures[source_index];
+
+	if (copy != 0)
+	{
+		destination[id.xy] = source.Load(int3(id.xy, 0)).r;
+		return;
+	}
+
+	const uint2 s0 = min(id.xy * 2, source_size - 1);
+	const uint2 s1 = uint2(
+		(id.x == size.x - 1) ? source_size.x - 1 : s0.x + 1,
+		(id.y == size.y - 1) ? source_size.y - 1 : s0.y + 1);
+
+	float depth = 0.f;
+
+	for (uint y = s0.y; y <= s1.y; ++y)
+	{
+		for (uint x = s0.x; x <= s1.x; ++x)
+		{
+			depth = max(depth, source.Load(int3(x, y, 0)).r);
+		}
+	}
+
+	destination[id.xy] = depth;
+}
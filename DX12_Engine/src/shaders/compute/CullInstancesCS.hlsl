@@ -0,0 +1,34 @@
+// instance culling compute shader
+// one thread per instance : frustum and Hi-Z occlusion tests, the visible instances are compacted in the range of their batch
+// the instance count of the draw arguments is incremented with an atomic (the order of the instances in a batch is not deterministic)
+
+#define CULLING_CONSTANTS
+#include "../lib/Culling.hlsli"
+
+#define GROUP_SIZE		64		// GPU_CULLING_GROUP_SIZE
+
+StructuredBuffer<InstanceRecord>	instances		: register(t0);
+RWStructuredBuffer<DrawArguments>	arguments		: register(u0);
+RWStructuredBuffer<uint>			visible_instances	: register(u1);
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+	const uint index = id.x;
+
+	if (index >= instance_count)
+		return;
+
+	const InstanceRecord instance = instances[index];
+
+	if (!IsInFrustum(instance.center, instance.extents))
+		return;
+
+	if (occlusion_enabled != 0 && IsOccluded(instance.center, instance.extents))
+		return;
+
+	uint slot;
+	InterlockedAdd(arguments[instance.batch].instance_count, 1, slot);
+
+	visible_instances[arguments[instance.batch].first_instance + slot] = index;
+}
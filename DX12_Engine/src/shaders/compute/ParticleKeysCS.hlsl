@@ -0,0 +1,33 @@
+// particle sort keys compute shader
+// one thread per key : the visible particles (alive and in front of the camera) get their depth key, the others and the padding of the
+// power of 2 key count get the invalid key (same keys as Particles::BuildSortKeys, stored as slot then depth key)
+
+#define SORT_CONSTANTS
+#include "../lib/Particles.hlsli"
+
+StructuredBuffer<float>		particles	: register(t0);
+RWStructuredBuffer<uint2>	keys		: register(u1);
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+	const uint slot = id.x;
+
+	if (slot >= sort_capacity)
+		return;
+
+	uint2 key = uint2(INVALID_KEY, INVALID_KEY);
+
+	if (slot < capacity && particles[STREAM_AGE * capacity + slot] < particles[STREAM_LIFETIME * capacity + slot])
+	{
+		precise float depth = particles[STREAM_POSITION_X * capacity + slot] * view_depth.x + view_depth.w;
+		depth = particles[(STREAM_POSITION_X + 1) * capacity + slot] * view_depth.y + depth;
+		depth = particles[(STREAM_POSITION_X + 2) * capacity + slot] * view_depth.z + depth;
+
+		// back to front : the complement of the bits of the depth (see RadixSort::BackToFrontKey)
+		if (depth > 0.f)
+			key = uint2(slot, ~asuint(depth));
+	}
+
+	keys[slot] = key;
+}
@@ -0,0 +1,58 @@
+// particle simulation compute shader
+// one thread per slot : the slots of the spawn ring range are spawned, the other alive slots are integrated
+// same kernel as Particles::SimulateReference (precise : no fused operations, the CPU path doesn't fuse them)
+
+#define SIMULATE_CONSTANTS
+#include "../lib/Particles.hlsli"
+
+RWStructuredBuffer<float>	particles	: register(u0);	// streams of capacity floats
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+	const uint slot = id.x;
+
+	if (slot >= capacity)
+		return;
+
+	// spawned slot : random values of the spawn index
+	const uint offset = (slot + capacity - spawn_first) % capacity;
+
+	if (offset < spawn_count)
+	{
+		uint state = Hash(seed ^ Hash(spawn_index + offset));
+
+		[unroll]
+		for (uint axis = 0; axis < 3; ++axis)
+		{
+			particles[(STREAM_POSITION_X + axis) * capacity + slot] = origin[axis] + (Random(state) * 2.f - 1.f) * spawn_extents[axis];
+		}
+
+		[unroll]
+		for (uint axis = 0; axis < 3; ++axis)
+		{
+			particles[(STREAM_VELOCITY_X + axis) * capacity + slot] = velocity_min[axis] + (velocity_max[axis] - velocity_min[axis]) * Random(state);
+		}
+
+		particles[STREAM_AGE * capacity + slot]			= 0.f;
+		particles[STREAM_LIFETIME * capacity + slot]	= lifetime_min + (lifetime_max - lifetime_min) * Random(state);
+		return;
+	}
+
+	const float age = particles[STREAM_AGE * capacity + slot];
+
+	if (age >= particles[STREAM_LIFETIME * capacity + slot])
+		return;
+
+	[unroll]
+	for (uint axis = 0; axis < 3; ++axis)
+	{
+		precise const float velocity = (particles[(STREAM_VELOCITY_X + axis) * capacity + slot] + gravity[axis] * elapsed) * damping;
+		precise const float position = particles[(STREAM_POSITION_X + axis) * capacity + slot] + velocity * elapsed;
+
+		particles[(STREAM_VELOCITY_X + axis) * capacity + slot] = velocity;
+		particles[(STREAM_POSITION_X + axis) * capacity + slot] = position;
+	}
+
+	particles[STREAM_AGE * capacity + slot] = age + elapsed;
+}
@@ -0,0 +1,34 @@
+// particle bitonic sort compute shader
+// one dispatch per step of the bitonic network : each thread compares a key with the key at the compare distance
+// the keys are sorted in ascending order of depth key then slot (same order as the radix sort of the CPU path)
+
+#define SORT_CONSTANTS
+#include "../lib/Particles.hlsli"
+
+RWStructuredBuffer<uint2>	keys		: register(u1);	// x : slot, y : depth key
+
+bool IsGreater(const uint2 i_First, const uint2 i_Second)
+{
+	return (i_First.y > i_Second.y) || (i_First.y == i_Second.y && i_First.x > i_Second.x);
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+	const uint index = id.x;
+	const uint other = index ^ compare_distance;
+
+	// the pair is compared by its lowest index
+	if (index >= sort_capacity || other <= index)
+		return;
+
+	const bool ascending = ((index & merge_size) == 0);
+	const uint2 first = keys[index];
+	const uint2 second = keys[other];
+
+	if (IsGreater(first, second) == ascending)
+	{
+		keys[index] = second;
+		keys[other] = first;
+	}
+}
@@ -0,0 +1,12 @@
+// debug draw pixel shader : vertex color
+
+struct VS_OUTPUT
+{
+	float4 pos		: SV_POSITION;
+	float4 color	: COLOR;
+};
+
+float4 main(const VS_OUTPUT input) : SV_TARGET
+{
+	return input.color;
+}
@@ -0,0 +1,106 @@
+// debug draw vertex shader
+// no vertex buffer : the line list vertices of a primitive are generated from the vertex id
+// each instanced draw reads the instances of one primitive type (see DebugDraw and RenderList::RenderDebugDraw)
+
+#define SPHERE_SEGMENTS		32	// see DEBUG_DRAW_SPHERE_SEGMENTS
+#define PI					3.14159265f
+
+// b0 root constants
+cbuffer DebugDrawConstants : register(b0)
+{
+	float4x4	view_proj;
+	uint		primitive_type;		// 0 : lines, 1 : boxes, 2 : spheres (see DebugDraw::EPrimitive)
+	uint		instance_offset;	// first instance of the draw in the instance buffer
+};
+
+// instances (same layout than DebugDraw)
+struct LineInstance
+{
+	float3		start;
+	uint		color;
+	float3		end;
+	uint		pad;
+};
+
+struct BoxInstance
+{
+	float4		rows[3];	// transform of the [-1, 1] box
+	uint		color;
+	uint3		pad;
+};
+
+struct SphereInstance
+{
+	float3		center;
+	float		radius;
+	uint		color;
+	uint3		pad;
+};
+
+StructuredBuffer<LineInstance>		lines	: register(t0);
+StructuredBuffer<BoxInstance>		boxes	: register(t1);
+StructuredBuffer<SphereInstance>	spheres	: register(t2);
+
+struct VS_OUTPUT
+{
+	float4 pos		: SV_POSITION;
+	float4 color	: COLOR;
+};
+
+float4 UnpackColor(uint i_Color)
+{
+	return float4(i_Color & 0xff, (i_Color >> 8) & 0xff, (i_Color >> 16) & 0xff, i_Color >> 24) / 255.f;
+}
+
+VS_OUTPUT main(uint vertex : SV_VertexID, uint instance : SV_InstanceID)
+{
+	const uint index = instance_offset + instance;
+
+	float3 pos;
+	uint color;
+
+	if (primitive_type == 0)
+	{
+		const LineInstance segment = lines[index];
+
+		pos		= (vertex & 1) ? segment.end : segment.start;
+		color	= segment.color;
+	}
+	else if (primitive_type == 1)
+	{
+		// 12 edges : 4 edges along each axis, the two other axes give the corner of the edge
+		const BoxInstance box = boxes[index];
+		const uint edge = vertex / 2;
+		const uint axis = edge / 4;
+
+		float3 corner;
+		corner[axis]			= (vertex & 1) ? 1.f : -1.f;
+		corner[(axis + 1) % 3]	= (edge & 1) ? 1.f : -1.f;
+		corner[(axis + 2) % 3]	= (edge & 2) ? 1.f : -1.f;
+
+		const float4 local = float4(corner, 1.f);
+		pos		= float3(dot(box.rows[0], local), dot(box.rows[1], local), dot(box.rows[2], local));
+		color	= box.color;
+	}
+	else
+	{
+		// three circles (XY, YZ and ZX planes)
+		const SphereInstance sphere = spheres[index];
+		const uint circle = vertex / (SPHERE_SEGMENTS * 2);
+		const uint segment = (vertex % (SPHERE_SEGMENTS * 2)) / 2 + (vertex & 1);
+		const float angle = (float)segment * (2.f * PI / SPHERE_SEGMENTS);
+
+		float3 offset = 0.f;
+		offset[circle]				= cos(angle);
+		offset[(circle + 1) % 3]	= sin(angle);
+
+		pos		= sphere.center + offset * sphere.radius;
+		color	= sphere.color;
+	}
+
+	VS_OUTPUT output;
+	output.pos		= mul(float4(pos, 1.f), view_proj);
+	output.color	= UnpackColor(color);
+
+	return output;
+}
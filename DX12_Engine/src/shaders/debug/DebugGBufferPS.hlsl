@@ -1,5 +1,12 @@
-// texture to display on the rect
-Texture2D tex			: register(t0);
+// texture to display on the rect (GBuffer target or depth buffer, see DX12Debug::DrawDebugGBuffer)
+#include "../lib/Bindless.hlsli"
+
+// b0 root constant
+cbuffer DebugTexture : register(b0)
+{
+	uint index_texture;
+};
+
 SamplerState tex_sample	: register(s0);
 
 struct VS_OUTPUT
@@ -11,5 +18,5 @@ struct VS_OUTPUT
 float4 main(const VS_OUTPUT input) : SV_TARGET
 {
 	// draw the texture on the rectangle
-	return tex.Sample(tex_sample, input.uv);
-}
\ No newline at end of file
+	return bindless_textures[index_texture].Sample(tex_sample, input.uv);
+}
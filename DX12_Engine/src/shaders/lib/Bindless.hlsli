@@ -0,0 +1,10 @@
+// bindless resources
+// the shader visible heap of the engine is bound as one unbounded table (see DX12BindlessHeap)
+// textures are selected by their persistent index (GetBindlessIndex of the textures and render targets)
+
+#ifndef BINDLESS_HLSLI
+#define BINDLESS_HLSLI
+
+Texture2D bindless_textures[]	: register(t0, space1);
+
+#endif
@@ -0,0 +1,111 @@
+// GPU driven culling
+// instance records, draw arguments and culling tests of the culling kernels
+// the CPU mirror of this file is GPUCulling (same operations in the same order)
+
+#ifndef CULLING_HLSLI
+#define CULLING_HLSLI
+
+// same layout as GPUCulling::InstanceRecord
+struct InstanceRecord
+{
+	float4x4	world;			// transposed world matrix
+	float3		center;			// world bounding box
+	uint		batch;
+	float3		extents;
+	uint		material_block;
+	uint		first_bone;		// skinning palette of the animator
+	uint3		padding;
+};
+
+// same layout as GPUCulling::DrawArguments
+struct DrawArguments
+{
+	uint		count_per_instance;
+	uint		instance_count;
+	uint		start_location;
+	int			base_vertex;
+	uint		start_instance;
+	uint		first_instance;
+};
+
+#ifdef CULLING_CONSTANTS
+#include "Bindless.hlsli"
+
+// same layout as GPUCulling::CullConstants
+cbuffer CullConstants : register(b0)
+{
+	float4		planes[6];
+	float4x4	hiz_view_proj;
+	float2		hiz_size;
+	uint		hiz_mip_count;
+	uint		hiz_index;
+	uint		instance_count;
+	uint		occlusion_enabled;
+};
+
+// the box is outside when its nearest corner to the plane is behind the plane
+bool IsInFrustum(const float3 i_Center, const float3 i_Extents)
+{
+	[unroll]
+	for (uint i = 0; i < 6; ++i)
+	{
+		const float distance = dot(planes[i].xyz, i_Center) + planes[i].w;
+		const float radius = dot(abs(planes[i].xyz), i_Extents);
+
+		if (distance + radius < 0.f)
+			return false;
+	}
+
+	return true;
+}
+
+// the nearest point of the box is behind the farthest occluder of its screen rectangle (Hi-Z of the previous frame)
+bool IsOccluded(const float3 i_Center, const float3 i_Extents)
+{
+	float2 min_uv = 1.f, max_uv = 0.f;
+	float min_depth = 1.f;
+
+	[unroll]
+	for (uint i = 0; i < 8; ++i)
+	{
+		const float3 corner = i_Center + float3((i & 1) ? i_Extents.x : -i_Extents.x, (i & 2) ? i_Extents.y : -i_Extents.y, (i & 4) ? i_Extents.z : -i_Extents.z);
+		const float4 clip = mul(float4(corner, 1.f), hiz_view_proj);
+
+		// a corner behind the camera : the box cross the near plane
+		if (clip.w <= 0.f)
+			return false;
+
+		const float2 uv = clip.xy / clip.w * float2(0.5f, -0.5f) + 0.5f;
+
+		min_uv = min(min_uv, uv);
+		max_uv = max(max_uv, uv);
+		min_depth = min(min_depth, clip.z / clip.w);
+	}
+
+	// pixels of the rectangle in the mip 0
+	const uint2 size = (uint2)hiz_size;
+	const uint2 p0 = min((uint2)(saturate(min_uv) * hiz_size), size - 1);
+	const uint2 p1 = min((uint2)(saturate(max_uv) * hiz_size), size - 1);
+
+	// the first mip where the rectangle covers 2x2 texels (the texels of the last row and column cover the remaining pixels)
+	uint mip = 0;
+	uint2 mip_size = size;
+	uint2 t0 = p0, t1 = p1;
+
+	while (mip + 1 < hiz_mip_count && (t1.x - t0.x > 1 || t1.y - t0.y > 1))
+	{
+		++mip;
+		mip_size = max(size >> mip, 1);
+		t0 = min(p0 >> mip, mip_size - 1);
+		t1 = min(p1 >> mip, mip_size - 1);
+	}
+
+	const float hiz_depth = max(
+		max(bindless_textures[hiz_index].Load(int3(t0.x, t0.y, mip)).r, bindless_textures[hiz_index].Load(int3(t1.x, t0.y, mip)).r),
+		max(bindless_textures[hiz_index].Load(int3(t0.x, t1.y, mip)).r, bindless_textures[hiz_index].Load(int3(t1.x, t1.y, mip)).r));
+
+	return min_depth > hiz_depth;
+}
+#endif
+
+#endif
@@ -0,0 +1,271 @@
+// clustered lighting
+// lights, clusters and shadow views of the frame (see RenderList::RenderLight)
+// shared by the deferred light pass and the forward pass of the semi transparent meshes (see GBufferPS.hlsl)
+// the registers are in LIGHTING_SPACE (the forward pass uses space2 : the lower registers are the material ones)
+// the includer defines tex_shadow, the shadow atlas in the bindless table
+
+#ifndef LIGHTING_HLSLI
+#define LIGHTING_HLSLI
+
+#ifndef LIGHTING_SPACE
+#define LIGHTING_SPACE		space0
+#endif
+
+SamplerComparisonState shadow_sample	: register(s1, LIGHTING_SPACE);
+
+// lights are tightly packed in one buffer per type (see Light::PointLightData...)
+// point light struct definition
+struct PointLight
+{
+	float3		position;
+	float		range;
+	float3		color;
+	float		constant;
+	float		lin;		// linear
+	float		quad;		// quadratic
+};
+
+// spot light struct definition
+struct SpotLight
+{
+	float3		position;
+	float		range;
+	float3		color;
+	float		constant;
+	float		lin;		// linear
+	float		quad;		// quadratic
+	float3		direction;
+	float		spot_angle;
+	float		outer_cutoff;
+};
+
+// directionnal light struct definition
+struct DirectionnalLight
+{
+	float3		direction;
+	float3		color;
+};
+
+// shadow view (see RenderList::ShadowViewData)
+#define SHADOW_CASCADE_COUNT	4		// must match ShadowCascade.h
+#define NO_SHADOW				0xffffffff
+
+struct ShadowView
+{
+	float4x4	shadow_matrix;	// world to atlas texture coordinates
+	float		split_depth;	// far view depth of the cascade
+	float		bias;
+	float2		padding;
+};
+
+// Pixel specs (for on particular pixel)
+struct PixelData
+{
+	float4		diffuse_color;
+	float4		specular_color;
+	float4		normal;
+	float4		position;
+	float		view_depth;
+};
+
+/////////////////////////////////////////
+// constant buffer definition
+cbuffer SceneData : register(b0, LIGHTING_SPACE)
+{
+	// basics matrix for compute space position
+	float4x4	view;
+	float4x4	inv_view;
+	float4x4	inv_projection;		// depth reconstruction
+	float3		camera_pos;
+	int			light_count;		// light to compute this frame
+	// clusters (see LightCluster)
+	uint3		cluster_count;		// tiles x, tiles y, depth slices
+	uint		global_light_count;	// lights affecting every clusters (first in the index list)
+	float2		tile_size;			// tile size in pixels
+	float		slice_scale;		// slice = log(z) * scale + bias
+	float		slice_bias;
+	// light buffers : the light index is points, then spots, then directionals
+	uint		point_light_count;
+	uint		spot_light_count;
+};
+
+// lights data
+StructuredBuffer<PointLight>		point_lights		: register(t5, LIGHTING_SPACE);
+StructuredBuffer<SpotLight>			spot_lights			: register(t6, LIGHTING_SPACE);
+StructuredBuffer<DirectionnalLight>	directional_lights	: register(t7, LIGHTING_SPACE);
+// clustered lights data
+StructuredBuffer<uint2>				light_clusters		: register(t8, LIGHTING_SPACE);	// offset and light count in the index list
+StructuredBuffer<uint>				light_indices		: register(t9, LIGHTING_SPACE);	// light index list
+// shadows
+StructuredBuffer<ShadowView>		shadow_views		: register(t11, LIGHTING_SPACE);
+StructuredBuffer<uint>				light_shadows		: register(t12, LIGHTING_SPACE);	// first shadow view of each light (NO_SHADOW if none)
+
+/////////////////////////////////////////
+// Shadow computation function
+float		ComputeShadow(in ShadowView shadow, in float3 world_pos)
+{
+	float4 pos = mul(float4(world_pos, 1.f), shadow.shadow_matrix);
+	pos.xyz /= pos.w;
+
+	return tex_shadow.SampleCmpLevelZero(shadow_sample, pos.xy, pos.z - shadow.bias);
+}
+
+float		ComputeSpotShadow(in uint shadow_index, in PixelData pixel)
+{
+	if (shadow_index == NO_SHADOW)
+		return 1.f;
+
+	return ComputeShadow(shadow_views[shadow_index], pixel.position.xyz);
+}
+
+float		ComputeDirectionnalShadow(in uint shadow_index, in PixelData pixel)
+{
+	if (shadow_index == NO_SHADOW)
+		return 1.f;
+
+	// select the cascade from the view depth (no shadow after the last cascade)
+	for (uint i = 0; i < SHADOW_CASCADE_COUNT; ++i)
+	{
+		const ShadowView shadow = shadow_views[shadow_index + i];
+
+		if (pixel.view_depth < shadow.split_depth)
+		{
+			return ComputeShadow(shadow, pixel.position.xyz);
+		}
+	}
+
+	return 1.f;
+}
+
+/////////////////////////////////////////
+// Light computation function
+float3		ComputePointLight(in PointLight light, in PixelData pixel)
+{
+	// retreive the light direction and range between the
+	const float3 light_diff = light.position - pixel.position.xyz;
+	const float distance = length(light_diff);
+
+	float3 ret_value = float3(0.f, 0.f, 0.f);
+
+	if (distance < light.range)
+	{
+		// diffuse light calculation
+		const float3 light_dir = normalize(light_diff);
+		const float diff = max(dot(pixel.normal.xyz, light_dir), 0.f);
+		const float3 light_diffuse = pixel.diffuse_color.rgb * diff * light.color;
+
+		// specular calculation
+		const float3 view_dir = normalize(camera_pos.xyz - pixel.position.xyz);
+		const float3 reflect_dir = reflect(-light_dir, pixel.normal.xyz);
+		const float spec = pow(max(dot(view_dir, reflect_dir), 0.f), pixel.specular_color.a);
+		const float3 specular = light.color * spec * pixel.specular_color.rgb;
+
+		// attenuation
+		float attenuation = 1.f / (light.constant + light.lin * distance + light.quad * (distance * distance));
+		ret_value = (specular * attenuation) + (light_diffuse * attenuation);
+	}
+
+	return ret_value;
+}
+
+float3		ComputeSpotLight(in SpotLight light, in PixelData pixel)
+{
+	// retreive the light direction and range between the
+	const float3 light_diff = light.position - pixel.position.xyz;
+	const float distance = length(light_diff);
+	const float3 light_dir = normalize(light_diff);
+
+	// check if lighting is inside the spotlight cone
+	const float theta = dot(light_dir, normalize(-light.direction));
+
+	float3 ret_value = float3(0.f, 0.f, 0.f);
+
+	// radian angles
+	if (theta > light.spot_angle)
+	{
+		// diffuse
+		const float diff = max(dot(pixel.normal.xyz, light_dir), 0.0);
+		const float3 light_diffuse = pixel.diffuse_color.rgb * diff * light.color;
+
+		// specular calculation
+		const float3 view_dir = normalize(camera_pos.xyz - pixel.position.xyz);
+		const float3 reflect_dir = reflect(-light_dir, pixel.normal.xyz);
+		const float spec = pow(max(dot(view_dir, reflect_dir), 0.f), pixel.specular_color.a);
+		const float3 specular = light.color * spec * pixel.specular_color.rgb;
+
+		// soft edges
+		const float epsilon = light.outer_cutoff;
+		const float intensity = clamp((theta - light.spot_angle) / epsilon, 0.f, 1.f);
+
+		//// attenuation
+		float attenuation = 1.f / (light.constant + light.lin * distance + light.quad * (distance * distance));
+		ret_value = (specular * intensity * attenuation) + (light_diffuse * intensity * attenuation);
+	}
+
+	return ret_value;
+}
+
+float3		ComputeDirectionnalLight(in DirectionnalLight light, in PixelData pixel)
+{
+	// compute directionnal light
+	const float3 light_dir = normalize(-light.direction);
+	const float diff = max(dot(pixel.normal.xyz, light_dir), 0.0);
+	return pixel.diffuse_color.rgb * diff * light.color;
+}
+
+float3		ComputeLight(in uint index, in PixelData pixel)
+{
+	const uint shadow_index = light_shadows[index];
+
+	if (index < point_light_count)
+	{
+		return ComputePointLight(point_lights[index], pixel);
+	}
+
+	index -= point_light_count;
+
+	if (index < spot_light_count)
+	{
+		return ComputeSpotLight(spot_lights[index], pixel) * ComputeSpotShadow(shadow_index, pixel);
+	}
+
+	return ComputeDirectionnalLight(directional_lights[index - spot_light_count], pixel) * ComputeDirectionnalShadow(shadow_index, pixel);
+}
+
+uint		GetClusterIndex(in float2 screen_pos, in float view_depth)
+{
+	// tile
+	const uint2 tile = min(uint2(screen_pos / tile_size), cluster_count.xy - 1);
+
+	// depth slice
+	const uint slice = min(uint(max(log(view_depth) * slice_scale + slice_bias, 0.f)), cluster_count.z - 1);
+
+	return tile.x + cluster_count.x * (tile.y + cluster_count.y * slice);
+}
+
+// lighting of a pixel : the global lights, then the lights of its cluster (screen_pos in pixels)
+float3		ComputeClusteredLighting(in float2 screen_pos, in PixelData pixel)
+{
+	if (light_count == 0)
+		return pixel.diffuse_color.rgb;
+
+	float3 lighting = float3(0.f, 0.f, 0.f);
+
+	// global lights
+	for (uint i = 0; i < global_light_count; ++i)
+	{
+		lighting += ComputeLight(light_indices[i], pixel);
+	}
+
+	// lights of the cluster
+	const uint2 cluster = light_clusters[GetClusterIndex(screen_pos, pixel.view_depth)];
+
+	for (uint j = 0; j < cluster.y; ++j)
+	{
+		lighting += ComputeLight(light_indices[cluster.x + j], pixel);
+	}
+
+	return lighting;
+}
+
+#endif
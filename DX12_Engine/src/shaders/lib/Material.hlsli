@@ -1,33 +1,75 @@
 // material buffer definition
 // define all constant for the buffer that are pushed to shaders
+// the parameters of all materials are in one buffer, the draw selects its block (see DX12MaterialParameterBuffer)
+// texture maps used are selected at compile time (see Permutation.hlsli), the textures are indexed in the bindless table by the parameter block
 
-/*
-DirectX::XMFLOAT3		Ka, Kd, Ks, Ke;
-BOOL					Map_A, Map_D, Map_S;
-float					Ns;
-*/
+#ifndef MATERIAL_HLSLI
+#define MATERIAL_HLSLI
 
+#include "Permutation.hlsli"
+#include "Bindless.hlsli"
 
-/*
-eAmbient,
-eSpecular,
-eDiffuse,
-*/
 // texture sampler for material
-Texture2D tex_ambient		: register(t0);
-Texture2D tex_specular		: register(t1);
-Texture2D tex_diffuse		: register(t2);
+#if HAVE_TEXTURE_MAP
 SamplerState tex_sample		: register(s0);
+#endif
 
-cbuffer MaterialBuffer : register(b2)	// the material buffer is instanced on the buffer 1
+// same layout as DX12MaterialParameterBuffer::ParameterBlock
+struct MaterialParameters
 {
-	// default material implementation
 	float4	ka;
 	float4	kd;
 	float4	ks;
 	float4	ke;
-	bool	map_a;
-	bool	map_d;
-	bool	map_s;
 	float	ns;
-};
\ No newline at end of file
+	uint	map_ka;		// bindless indices of the maps
+	uint	map_kd;
+	uint	map_ks;
+};
+
+StructuredBuffer<MaterialParameters> material_parameters	: register(t3);
+
+cbuffer MaterialBuffer : register(b2)	// the parameter block of the draw is pushed on the buffer 2
+{
+	uint	material_block;
+};
+
+// default material implementation (see LoadMaterialParameters)
+static float4	ka;
+static float4	kd;
+static float4	ks;
+static float4	ke;
+static float	ns;
+static uint		map_ka;
+static uint		map_kd;
+static uint		map_ks;
+
+// call it before reading the material values
+void LoadMaterialParameters(const uint i_Block)
+{
+	const MaterialParameters parameters = material_parameters[i_Block];
+
+	ka = parameters.ka;
+	kd = parameters.kd;
+	ks = parameters.ks;
+	ke = parameters.ke;
+	ns = parameters.ns;
+	map_ka = parameters.map_ka;
+	map_kd = parameters.map_kd;
+	map_ks = parameters.map_ks;
+}
+
+void LoadMaterialParameters()
+{
+	LoadMaterialParameters(material_block);
+}
+
+#if HAVE_TEXTURE_MAP
+// sample a map of the material (map_ka, map_kd or map_ks)
+float4 SampleMaterialMap(const uint i_Map, const float2 i_UV)
+{
+	return bindless_textures[i_Map].Sample(tex_sample, i_UV);
+}
+#endif
+
+#endif
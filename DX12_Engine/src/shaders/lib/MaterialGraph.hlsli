@@ -0,0 +1,57 @@
+// material graph definitions
+// the shaders generated by the material graph compiler (see MaterialGraph) define EvaluateMaterial and include GBufferPS.hlsl
+// the material function reads the mesh and the material and overrides the values written to the GBuffer
+
+#ifndef MATERIAL_GRAPH_HLSLI
+#define MATERIAL_GRAPH_HLSLI
+
+#define MATERIAL_GRAPH		1
+
+#include "GlobalBuffer.hlsli"
+#include "Material.hlsli"
+
+struct MaterialInput
+{
+	float3 position;	// world space
+	float3 normal;		// world space
+	float2 uv;			// zero when the mesh has no uv
+};
+
+struct MaterialOutput
+{
+	// initialized with the material values
+	float4 diffuse;
+	float4 specular;
+	float3 normal;
+	float specular_power;
+};
+
+// maps not used by the material are white
+float4 SampleAmbientMap(const float2 i_UV)
+{
+#if MAP_AMBIENT
+	return SampleMaterialMap(map_ka, i_UV);
+#else
+	return float4(1.f, 1.f, 1.f, 1.f);
+#endif
+}
+
+float4 SampleDiffuseMap(const float2 i_UV)
+{
+#if MAP_DIFFUSE
+	return SampleMaterialMap(map_kd, i_UV);
+#else
+	return float4(1.f, 1.f, 1.f, 1.f);
+#endif
+}
+
+float4 SampleSpecularMap(const float2 i_UV)
+{
+#if MAP_SPECULAR
+	return SampleMaterialMap(map_ks, i_UV);
+#else
+	return float4(1.f, 1.f, 1.f, 1.f);
+#endif
+}
+
+#endif
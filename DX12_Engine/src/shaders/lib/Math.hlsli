@@ -6,4 +6,68 @@
 float		InvertLerp(float min, float max, float value)
 {
 	return (value - min) / (max - min);
-}
\ No newline at end of file
+}
+
+/////////////////////////////////////////
+// GBuffer packing
+// C++ mirror : GBufferPacking (keep the same operations in the same order)
+#define GBUFFER_FLAG_GEOMETRY		0x1		// the pixel contains geometry (background pixels are not lit)
+
+// octahedral normal : unit normal to coordinates in [-1, 1] (written in a RG16 snorm target : axis are exactly stored)
+float2		EncodeOctahedralNormal(float3 n)
+{
+	// project on the octahedron
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+
+	// fold the lower hemisphere
+	if (n.z < 0.f)
+	{
+		const float2 wrap = float2((1.f - abs(n.y)) * (n.x >= 0.f ? 1.f : -1.f), (1.f - abs(n.x)) * (n.y >= 0.f ? 1.f : -1.f));
+		n.xy = wrap;
+	}
+
+	return n.xy;
+}
+
+float3		DecodeOctahedralNormal(float2 e)
+{
+	float3 n = float3(e.x, e.y, 1.f - abs(e.x) - abs(e.y));
+
+	// unfold the lower hemisphere
+	const float t = saturate(-n.z);
+	n.x += (n.x >= 0.f) ? -t : t;
+	n.y += (n.y >= 0.f) ? -t : t;
+
+	return n * (1.f / sqrt(dot(n, n)));
+}
+
+// specular : the color is reduced to an intensity (albedo alpha) and the exponent to a roughness
+float		EncodeSpecularIntensity(float3 specular)
+{
+	return saturate(max(max(specular.r, specular.g), specular.b));
+}
+
+float		SpecularPowerToRoughness(float power)
+{
+	// blinn phong exponent to roughness : power = 2 / roughness^2 - 2
+	return sqrt(2.f / (power + 2.f));
+}
+
+float		RoughnessToSpecularPower(float roughness)
+{
+	return 2.f / max(roughness * roughness, 1e-4f) - 2.f;
+}
+
+// roughness (8 bits) and flags (8 bits) shared in one R16 unorm channel
+float		PackMaterial(float roughness, uint flags)
+{
+	return (floor(saturate(roughness) * 255.f + 0.5f) + (float)(flags * 256)) / 65535.f;
+}
+
+void		UnpackMaterial(float packed, out float roughness, out uint flags)
+{
+	const uint code = (uint)(packed * 65535.f + 0.5f);
+
+	roughness = (float)(code & 0xff) / 255.f;
+	flags = code >> 8;
+}
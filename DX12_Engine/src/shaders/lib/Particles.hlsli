@@ -0,0 +1,68 @@
+// particle simulation
+// constants, random and streams of the particle compute shaders
+// the CPU side of this file is Particles (same operations in the same order)
+
+#ifndef PARTICLES_HLSLI
+#define PARTICLES_HLSLI
+
+#define GROUP_SIZE				256		// PARTICLE_GROUP_SIZE
+
+// streams of the particle buffer (see Particles::EStream)
+#define STREAM_POSITION_X		0
+#define STREAM_AGE				3
+#define STREAM_LIFETIME			4
+#define STREAM_VELOCITY_X		5
+
+// sort key of the dead particles (sorted last, see PARTICLE_INVALID_KEY)
+#define INVALID_KEY				0xffffffff
+
+// pcg hash
+uint Hash(uint i_Value)
+{
+	const uint state = i_Value * 747796405u + 2891336453u;
+	const uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+
+	return (word >> 22u) ^ word;
+}
+
+// [0, 1) : 24 bits are exact in a float
+float Random(inout uint io_State)
+{
+	io_State = Hash(io_State);
+	return (float)(io_State >> 8) * (1.f / 16777216.f);
+}
+
+#ifdef SIMULATE_CONSTANTS
+// same layout as Particles::SimulateConstants
+cbuffer SimulateConstants : register(b0)
+{
+	float3		origin;
+	float		elapsed;
+	float3		gravity;
+	float		damping;
+	float3		velocity_min;
+	float		lifetime_min;
+	float3		velocity_max;
+	float		lifetime_max;
+	float3		spawn_extents;
+	uint		capacity;
+	uint		spawn_first;	// first slot of the spawned particles
+	uint		spawn_count;
+	uint		spawn_index;	// spawn index of the first spawned particle
+	uint		seed;
+};
+#endif
+
+#ifdef SORT_CONSTANTS
+// same layout as Particles::SortConstants
+cbuffer SortConstants : register(b0)
+{
+	float4		view_depth;		// view depth = dot(position, xyz) + w
+	uint		capacity;
+	uint		sort_capacity;	// power of 2
+	uint		merge_size;		// bitonic sort step
+	uint		compare_distance;
+};
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+// permutation defines
+// these are set by the shader cache (see DX12ShaderCache and DX12Material)
+// default values are used when the shader is compiled offline (cso) : default mesh layout and no texture map
+
+// input layout (DX12PipelineState::EElementFlags)
+#ifndef HAVE_NORMAL
+#define HAVE_NORMAL		1
+#endif
+
+#ifndef HAVE_TEXCOORD
+#define HAVE_TEXCOORD	1
+#endif
+
+#ifndef HAVE_SKINNING
+#define HAVE_SKINNING	0
+#endif
+
+// material features (DX12Material::EMaterialFeature)
+// the ambient map is only sampled by the material graph shaders (not set for GBufferPS, see DX12Material::GetPermutationKey)
+#ifndef MAP_AMBIENT
+#define MAP_AMBIENT		0
+#endif
+
+#ifndef MAP_DIFFUSE
+#define MAP_DIFFUSE		0
+#endif
+
+#ifndef MAP_SPECULAR
+#define MAP_SPECULAR	0
+#endif
+
+// pass features
+#ifndef GBUFFER_PACKED
+#define GBUFFER_PACKED	0
+#endif
+
+#ifndef INDIRECT_DRAW
+#define INDIRECT_DRAW	0
+#endif
+
+#ifndef FORWARD_PASS
+#define FORWARD_PASS	0
+#endif
+
+#ifndef FORWARD_OIT
+#define FORWARD_OIT		0
+#endif
+
+// maps can't be sampled without uv
+#if !HAVE_TEXCOORD
+#undef MAP_AMBIENT
+#undef MAP_DIFFUSE
+#undef MAP_SPECULAR
+#define MAP_AMBIENT		0
+#define MAP_DIFFUSE		0
+#define MAP_SPECULAR	0
+#endif
+
+#define HAVE_TEXTURE_MAP	(MAP_AMBIENT || MAP_DIFFUSE || MAP_SPECULAR)
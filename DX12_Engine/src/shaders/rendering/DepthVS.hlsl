@@ -0,0 +1,30 @@
+// depth pre pass vertex shader
+// depth only : no pixel shader is bound, the GBuffer pass then only shades the visible pixels
+// the position must be computed exactly as in GBufferVS.hlsl (same operations, precise) to pass the depth test
+
+#include "../lib/Permutation.hlsli"
+#include "../Lib/TransformBuffer.hlsli"
+
+// the input layout depends on the mesh (see DX12PipelineState::CreateInputLayoutFromFlags)
+struct VS_INPUT
+{
+	float3 pos		: POSITION;
+#if HAVE_NORMAL
+	float3 normal	: NORMAL;
+#endif
+#if HAVE_TEXCOORD
+	float2 uv		: TEXCOORD;
+#endif
+};
+
+float4 main(const VS_INPUT input) : SV_POSITION
+{
+	precise float4 pos = float4(input.pos, 1.f);
+
+	// go to clip space
+	pos = mul(pos, model);
+	pos = mul(pos, view);
+	pos = mul(pos, projection);
+
+	return pos;
+}
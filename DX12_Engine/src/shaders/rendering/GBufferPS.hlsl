@@ -1,81 +1,176 @@
 // GBuffer rendering pixel shader
 // this takes data from a mesh and materials and push results into GBuffer
-// GBuffers are : 
-// - Normals	(float4)
-// - Colors		(float4)
-// - Specular	(float4)
-// - Depth		(int64)
+// GBuffers are (default layout / packed layout, see DX12RenderEngine::s_RenderTargetDef) : 
+// - Normals	(float4 / octahedral float2)
+// - Colors		(float4 / albedo and specular intensity)
+// - Specular	(float4 / roughness and flags in one channel)
+// - Depth		(depth buffer, the position is reconstructed by the light pass)
+// material graph shaders include this file after their material function (see MaterialGraph.hlsli)
+// forward pass (FORWARD_PASS) : the semi transparent meshes are lit with the clustered lights and blended on the back buffer
+// with FORWARD_OIT the weighted color and the revealage are accumulated instead (see DX12Transparency)
 
 // include render light lib
 #include "../lib/GlobalBuffer.hlsli"
 
-// Material buffer
-/*
-	eAmbient,
-	eSpecular,
-	eDiffuse,
-*/
-// texture sampler for material
-Texture2D tex_ambient		: register(t0);
-Texture2D tex_specular		: register(t1);
-Texture2D tex_diffuse		: register(t2);
-SamplerState tex_sample		: register(s0);
-
-cbuffer MaterialBuffer : register(b2)	// the material buffer is instanced on the buffer 1
+// Material buffer (textures are enabled by the material permutation)
+#include "../lib/Material.hlsli"
+#include "../lib/Math.hlsli"
+
+#ifndef MATERIAL_GRAPH
+#define MATERIAL_GRAPH		0
+#endif
+
+#if FORWARD_PASS
+// lights of the frame in space2 (see DX12Material::ForwardLighting)
+cbuffer ForwardLighting : register(b1, space2)
 {
-	// default material implementation
-	float4	ka;
-	float4	kd;
-	float4	ks;
-	float4	ke;
-	bool	map_a;
-	bool	map_d;
-	bool	map_s;
-	float	ns;	// shininess
+	uint index_shadow;		// shadow atlas
 };
 
+#define tex_shadow		bindless_textures[index_shadow]
+#define LIGHTING_SPACE	space2
+#include "../lib/Lighting.hlsli"
+#endif
+
 struct VS_OUTPUT
 {
 	// data for pipeline
 	float4 position :		SV_POSITION;
 	// GBuffer needed data
 	float4 world_position :	POSITION;
+#if HAVE_NORMAL
 	float3 normal :			NORMAL;
+#endif
+#if HAVE_TEXCOORD
+	float2 uv :				TEXCOORD;
+#endif
 	float depth :			DEPTH_VIEW_SPACE;
+#if INDIRECT_DRAW
+	nointerpolation uint material_block :	MATERIAL_BLOCK;	// parameter block of the instance (see DX12GPUCulling)
+#endif
 };
 
 struct PS_OUTPUT
 {
+#if FORWARD_OIT
+	float4 accumulation :	SV_Target0;	// weighted premultiplied color and weighted alpha (additive)
+	float revealage :		SV_Target1;	// alpha (the target is multiplied by 1 - alpha)
+#elif FORWARD_PASS
+	float4 color :			SV_Target0;	// alpha blended
+#elif GBUFFER_PACKED
+	float2 normal :			SV_Target0;
+	float4 diffuse :		SV_Target1;
+	float specular :		SV_Target2;
+#else
 	float4 normal :			SV_Target0;
 	float4 diffuse :		SV_Target1;
 	float4 specular :		SV_Target2;
-	float4 position :		SV_Target3;
+#endif
 };
 
+#if FORWARD_PASS
+PS_OUTPUT main(const VS_OUTPUT input, const bool front_face : SV_IsFrontFace)
+#else
 PS_OUTPUT main(const VS_OUTPUT input)
+#endif
 {
 	PS_OUTPUT output;
 
+	// parameters of the material or the material instance
+#if INDIRECT_DRAW
+	LoadMaterialParameters(input.material_block);
+#else
+	LoadMaterialParameters();
+#endif
+
 	/////////////////////////////////////////////
-	// update the normal buffer
-	output.normal = float4(input.normal.xyz, 1.f);
+	// retreive the normal
+#if HAVE_NORMAL
+	float3 normal = input.normal.xyz;
+#else
+	// no normal in the mesh : use the flat normal of the face
+	float3 normal = normalize(cross(ddy(input.world_position.xyz), ddx(input.world_position.xyz)));
+#endif
 	
 	/////////////////////////////////////////////
-	// update the diffuse buffer
-	output.diffuse = kd;
+	// retreive the diffuse color
+#if MAP_DIFFUSE
+	float4 diffuse = kd * SampleMaterialMap(map_kd, input.uv);
+#else
+	float4 diffuse = kd;
+#endif
 
 	/////////////////////////////////////////////
-	// update the specular buffer
-	output.specular = ks;
-	output.specular.a = ns;	// save the specular exponent to the alpha
+	// retreive the specular color
+#if MAP_SPECULAR
+	float4 specular = ks * SampleMaterialMap(map_ks, input.uv);
+#else
+	float4 specular = ks;
+#endif
+	float specularPower = ns;
 
 	/////////////////////////////////////////////
-	// update the position buffer
-	output.position = input.world_position;
+	// material graph : the generated function overrides the material values
+#if MATERIAL_GRAPH
+	MaterialInput materialInput;
+	materialInput.position = input.world_position.xyz;
+	materialInput.normal = normal;
+#if HAVE_TEXCOORD
+	materialInput.uv = input.uv;
+#else
+	materialInput.uv = float2(0.f, 0.f);
+#endif
+
+	MaterialOutput material;
+	material.diffuse = diffuse;
+	material.specular = specular;
+	material.normal = normal;
+	material.specular_power = specularPower;
+
+	EvaluateMaterial(materialInput, material);
+
+	normal = normalize(material.normal);
+	diffuse = material.diffuse;
+	specular = material.specular;
+	specularPower = material.specular_power;
+#endif
+
+#if FORWARD_PASS
+	/////////////////////////////////////////////
+	// forward lighting : the alpha of the diffuse color is the opacity
+	PixelData pixel;
+	pixel.diffuse_color		= float4(diffuse.rgb, 1.f);
+	pixel.specular_color	= float4(specular.rgb, specularPower);
+	pixel.normal			= float4(normalize(front_face ? normal : -normal), 1.f);	// both faces are drawn
+	pixel.position			= float4(input.world_position.xyz, 1.f);
+	pixel.view_depth		= mul(float4(input.world_position.xyz, 1.f), view).z;
+
+	const float3 lighting = ComputeClusteredLighting(input.position.xy, pixel);
+	const float alpha = saturate(diffuse.a);
+
+#if FORWARD_OIT
+	// depth weight of the weighted blended OIT : the closest surfaces dominate the average color
+	const float weight = clamp(alpha * 10.f / (1e-5f + pow(pixel.view_depth / 5.f, 2.f) + pow(pixel.view_depth / 200.f, 6.f)), 1e-2f, 3e3f);
+
+	output.accumulation = float4(lighting * alpha, alpha) * weight;
+	output.revealage = alpha;
+#else
+	output.color = float4(lighting, alpha);
+#endif
 
+#else
 	/////////////////////////////////////////////
-	// update the depth buffer
-	// To do ...
+	// update the GBuffer
+#if GBUFFER_PACKED
+	output.normal = EncodeOctahedralNormal(normal);
+	output.diffuse = float4(diffuse.rgb, EncodeSpecularIntensity(specular.rgb));
+	output.specular = PackMaterial(SpecularPowerToRoughness(specularPower), GBUFFER_FLAG_GEOMETRY);
+#else
+	output.normal = float4(normal, 1.f);
+	output.diffuse = diffuse;
+	output.specular = float4(specular.rgb, specularPower);	// save the specular exponent to the alpha
+#endif
+#endif
 
 	return output;
 }
\ No newline at end of file
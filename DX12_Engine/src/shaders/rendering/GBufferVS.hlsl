@@ -4,15 +4,55 @@
 // - Normals	(float4)
 // - Colors		(float4)
 // - Specular	(float4)
-// - Depth		(int64)
+// - Depth		(depth buffer, the position is reconstructed by the light pass)
 
+#include "../lib/Permutation.hlsli"
 #include "../Lib/TransformBuffer.hlsli"
 
+#if INDIRECT_DRAW
+// instances culled on the GPU : the model matrix and the parameter block are read from the instance record (see DX12GPUCulling)
+#include "../lib/Culling.hlsli"
+
+StructuredBuffer<InstanceRecord> instances		: register(t4);
+StructuredBuffer<uint> visible_instances		: register(t5);
+
+cbuffer IndirectDraw : register(b3)
+{
+	uint	first_instance;		// range of the batch in the visible instances
+};
+#endif
+
+#if HAVE_SKINNING
+// palettes of the animators (see AnimationSystem) : bind space to model space, rows of the transposed matrix
+struct SkinningMatrix
+{
+	float4	rows[3];
+};
+
+StructuredBuffer<SkinningMatrix> skinning_palette	: register(t6);
+
+#if !INDIRECT_DRAW
+cbuffer SkinnedDraw : register(b4)
+{
+	uint	first_bone;			// palette of the animator (indirect draws : in the instance record)
+};
+#endif
+#endif
+
+// the input layout depends on the mesh (see DX12PipelineState::CreateInputLayoutFromFlags)
 struct VS_INPUT
 {
 	float3 pos		: POSITION;
+#if HAVE_NORMAL
 	float3 normal	: NORMAL;
+#endif
+#if HAVE_TEXCOORD
 	float2 uv		: TEXCOORD;
+#endif
+#if HAVE_SKINNING
+	uint4 bones		: BLENDINDICES;
+	float4 weights	: BLENDWEIGHT;
+#endif
 };
 
 struct VS_OUTPUT
@@ -21,24 +61,72 @@ struct VS_OUTPUT
 	float4 position :		SV_POSITION;
 	// GBuffer needed data
 	float4 world_position :	POSITION;
+#if HAVE_NORMAL
 	float3 normal :			NORMAL;
+#endif
+#if HAVE_TEXCOORD
+	float2 uv :				TEXCOORD;
+#endif
 	float depth :			DEPTH_VIEW_SPACE;
+#if INDIRECT_DRAW
+	nointerpolation uint material_block :	MATERIAL_BLOCK;
+#endif
 };
 
+#if INDIRECT_DRAW
+VS_OUTPUT main( const VS_INPUT input, const uint instance_id : SV_InstanceID )
+{
+	VS_OUTPUT output;
+
+	const InstanceRecord instance = instances[visible_instances[first_instance + instance_id]];
+	const float4x4 world = instance.world;
+	output.material_block = instance.material_block;
+#if HAVE_SKINNING
+	const uint first_bone = instance.first_bone;
+#endif
+#else
 VS_OUTPUT main( const VS_INPUT input )
 {
 	VS_OUTPUT output;
 
-	float4 pos = float4(input.pos, 1.f);
+	const float4x4 world = model;
+#endif
+
+	// precise : the depth must match the depth pre pass (see DepthVS.hlsl)
+	precise float4 pos = float4(input.pos, 1.f);
+	float3 normal = float3(0.f, 0.f, 0.f);
+#if HAVE_NORMAL
+	normal = input.normal;
+#endif
+
+#if HAVE_SKINNING
+	// blend the matrices of the 4 bones of the vertex (skinned meshes have no depth pre pass)
+	float4 skin[3] = { float4(0.f, 0.f, 0.f, 0.f), float4(0.f, 0.f, 0.f, 0.f), float4(0.f, 0.f, 0.f, 0.f) };
+
+	[unroll]
+	for (uint i = 0; i < 4; ++i)
+	{
+		const SkinningMatrix bone = skinning_palette[first_bone + input.bones[i]];
+		skin[0] += bone.rows[0] * input.weights[i];
+		skin[1] += bone.rows[1] * input.weights[i];
+		skin[2] += bone.rows[2] * input.weights[i];
+	}
+
+	pos = float4(dot(pos, skin[0]), dot(pos, skin[1]), dot(pos, skin[2]), 1.f);
+	normal = float3(dot(normal, skin[0].xyz), dot(normal, skin[1].xyz), dot(normal, skin[2].xyz));
+#endif
+
+#if HAVE_NORMAL
 	// compute normal using matrix 3x3 (removing the position)
 	float3x3 mod;
-	mod[0] = model[0].xyz;
-	mod[1] = model[1].xyz;
-	mod[2] = model[2].xyz;
-	float3 norm = normalize(mul(input.normal, mod));
+	mod[0] = world[0].xyz;
+	mod[1] = world[1].xyz;
+	mod[2] = world[2].xyz;
+	float3 norm = normalize(mul(normal, mod));
+#endif
 
 	// Transform the vertex position into projected space.
-	pos = mul(pos, model);
+	pos = mul(pos, world);
 
 	// retreive the world position here
 	output.world_position = pos;
@@ -50,7 +138,12 @@ VS_OUTPUT main( const VS_INPUT input )
 	// Return 
 	output.position = pos;
 	// data for GBuffer
+#if HAVE_NORMAL
 	output.normal = float3(norm.xyz);
+#endif
+#if HAVE_TEXCOORD
+	output.uv = input.uv;
+#endif
 	output.depth = 0.1f;		// dummy
 
 	return output;
@@ -0,0 +1,14 @@
+// particle pixel shader : vertex color with a round falloff
+
+struct VS_OUTPUT
+{
+	float4 pos		: SV_POSITION;
+	float4 color	: COLOR;
+	float2 uv		: TEXCOORD;
+};
+
+float4 main(const VS_OUTPUT input) : SV_TARGET
+{
+	const float falloff = saturate(1.f - dot(input.uv, input.uv));
+	return float4(input.color.rgb, input.color.a * falloff);
+}
@@ -0,0 +1,56 @@
+// particle vertex shader
+// no vertex buffer : one camera facing quad per instance (triangle strip), the instance is a sorted key
+// the CPU emitters draw their visible particles, the GPU emitters draw all keys (the invalid keys are degenerated quads)
+
+#define INVALID_KEY		0xffffffff	// PARTICLE_INVALID_KEY
+
+// b0 root constants (same layout as Particles::DrawConstants)
+cbuffer DrawConstants : register(b0)
+{
+	float4x4	view_proj;
+	float3		camera_right;
+	float		size_start;
+	float3		camera_up;
+	float		size_end;
+	float4		color_start;
+	float4		color_end;
+	uint		capacity;
+	uint3		padding;
+};
+
+StructuredBuffer<float>		particles	: register(t0);	// render streams : position x, y, z, age and lifetime (see Particles::EStream)
+StructuredBuffer<uint2>		keys		: register(t1);	// back to front (x : slot, y : depth key)
+
+struct VS_OUTPUT
+{
+	float4 pos		: SV_POSITION;
+	float4 color	: COLOR;
+	float2 uv		: TEXCOORD;
+};
+
+VS_OUTPUT main(uint vertex : SV_VertexID, uint instance : SV_InstanceID)
+{
+	const uint2 key = keys[instance];
+
+	VS_OUTPUT output;
+	output.uv = float2(vertex & 1, vertex >> 1) * 2.f - 1.f;
+
+	if (key.y == INVALID_KEY)
+	{
+		output.pos		= 0.f;
+		output.color	= 0.f;
+		return output;
+	}
+
+	const uint slot = key.x;
+	const float3 position = float3(particles[slot], particles[capacity + slot], particles[2 * capacity + slot]);
+	const float t = saturate(particles[3 * capacity + slot] / particles[4 * capacity + slot]);
+	const float size = lerp(size_start, size_end, t);
+
+	const float3 corner = position + (camera_right * output.uv.x + camera_up * output.uv.y) * size;
+
+	output.pos		= mul(float4(corner, 1.f), view_proj);
+	output.color	= lerp(color_start, color_end, t);
+
+	return output;
+}
@@ -0,0 +1,34 @@
+// shadow map rendering vertex shader
+// depth only : no pixel shader is bound, the depth is written in the shadow atlas
+// shadow casters are instanced : each instance read its model matrix in the instance buffer
+
+#include "../lib/Permutation.hlsli"
+
+// b0 root constants (see RenderList::RenderShadows)
+cbuffer ShadowView : register(b0)
+{
+	float4x4	view_proj;			// light view projection
+	uint		instance_offset;	// first instance of the batch in the instance buffer
+};
+
+StructuredBuffer<float4x4>	instance_transforms	: register(t0);
+
+// the input layout depends on the mesh (see DX12PipelineState::CreateInputLayoutFromFlags)
+struct VS_INPUT
+{
+	float3 pos		: POSITION;
+#if HAVE_NORMAL
+	float3 normal	: NORMAL;
+#endif
+#if HAVE_TEXCOORD
+	float2 uv		: TEXCOORD;
+#endif
+};
+
+float4 main(const VS_INPUT input, uint instance : SV_InstanceID) : SV_POSITION
+{
+	const float4x4 model = instance_transforms[instance_offset + instance];
+
+	float4 pos = mul(float4(input.pos, 1.f), model);
+	return mul(pos, view_proj);
+}
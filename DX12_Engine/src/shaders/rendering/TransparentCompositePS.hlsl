@@ -0,0 +1,33 @@
+// order independent transparency composite pixel shader
+// the weighted average color of the semi transparent surfaces is blended on the back buffer with the revealage (see DX12Transparency)
+// blend : color * (1 - revealage) + back buffer * revealage
+
+#include "../lib/Bindless.hlsli"
+
+// b0 root constants (see DX12Transparency::Composite)
+cbuffer CompositeTargets : register(b0)
+{
+	uint index_accumulation;
+	uint index_revealage;
+};
+
+struct VS_OUTPUT
+{
+	float4 pos		: SV_POSITION;
+	float2 uv		: TEXCOORD;
+};
+
+float4 main(const VS_OUTPUT input) : SV_TARGET
+{
+	const int3 texel = int3(input.pos.xy, 0);
+	const float revealage = bindless_textures[index_revealage].Load(texel).r;
+
+	// no semi transparent surface on the pixel
+	if (revealage == 1.f)
+		discard;
+
+	const float4 accumulation = bindless_textures[index_accumulation].Load(texel);
+	const float3 color = accumulation.rgb / clamp(accumulation.a, 1e-4f, 5e4f);
+
+	return float4(color, revealage);
+}
@@ -4,6 +4,19 @@
 #include "engine/Engine.h"
 #include "engine/World.h"
 #include "engine/Camera.h"
+#include "engine/RenderList.h"
+#include "engine/FrameGraph.h"
+#include "engine/GPUProfiler.h"
+#include "engine/CPUProfiler.h"
+#include "engine/FramePacer.h"
+#include "engine/FixedTimestep.h"
+#include "engine/LevelStreamer.h"
+#include "engine/DebugDraw.h"
+#include "engine/Utils.h"
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12GPUProfiler.h"
+
+#define CPU_ZONE_ROW_HEIGHT		16.f
 
 UIDebug::UIDebug()
 	:UIWindow("Debug")
@@ -29,4 +42,131 @@ void UIDebug::DrawWindow()
 	// draw the window
 	ImGui::InputFloat3("Camera Position", camPos, 2);
 	ImGui::Text("FPS = %u [Frame Time : %.2f]", m_Engine->GetFramePerSecond(), m_Engine->GetFrameTime() * 1'000);
+	// GPU time of the last resolved frame (see UIProfiler)
+	const DX12GPUProfiler * gpuProfiler = DX12RenderEngine::GetInstance().GetGPUProfiler();
+	const GPUProfiler::Statistic * gpuFrame = (gpuProfiler != nullptr) ? gpuProfiler->GetProfiler().GetStatistic("Frame") : nullptr;
+
+	if (gpuFrame != nullptr)
+		ImGui::Text("GPU Frame = %.2f ms [Average : %.2f]", gpuFrame->Last, gpuFrame->Average);
+	ImGui::Text("Light upload = %llu bytes", m_Engine->GetRenderList()->GetLightUploadSize());
+	ImGui::Text("Shadow views = %u [Draws : %u]", m_Engine->GetRenderList()->GetShadowViewCount(), m_Engine->GetRenderList()->GetShadowDrawCount());
+	ImGui::Text("GBuffer record workers = %u", m_Engine->GetRenderList()->GetRecordWorkerUsed());
+	const DebugDraw::Stats & debugDraw = DebugDraw::GetStats();
+	ImGui::Text("Debug draw = %u lines, %u boxes, %u spheres [Draws : %u, Dropped : %llu]", debugDraw.InstanceCount[DebugDraw::eLine], debugDraw.InstanceCount[DebugDraw::eBox],
+		debugDraw.InstanceCount[DebugDraw::eSphere], m_Engine->GetRenderList()->GetDebugDrawCount(), debugDraw.DroppedCount);
+	const FrameGraph * frameGraph = m_Engine->GetFrameGraph();
+	ImGui::Text("Frame graph passes = %u [Culled : %u]", (UINT)frameGraph->GetExecutionOrder().size(), frameGraph->GetPassCount() - (UINT)frameGraph->GetExecutionOrder().size());
+
+	if (ImGui::CollapsingHeader("Frame Pacing"))
+		DrawFramePacing();
+
+	if (ImGui::CollapsingHeader("CPU Zones"))
+		DrawCPUZones();
+}
+
+void UIDebug::DrawFramePacing() const
+{
+	const FramePacer * pacer = m_Engine->GetFramePacer();
+
+	ImGui::Text("Smoothed frame time = %.3f ms [Target : %u FPS]", pacer->GetSmoothedDeltaTime() * 1'000, pacer->GetTarget());
+	ImGui::Text("Missed frames = %llu / %llu [Sleep margin : %.2f ms]", pacer->GetMissedFrameCount(), pacer->GetFrameCount(), pacer->GetSleepMargin());
+
+	const FixedTimestep * timestep = m_Engine->GetFixedTimestep();
+
+	if (timestep != nullptr)
+		ImGui::Text("Fixed ticks = %u Hz [Alpha : %.2f, Dropped : %.3f s]", timestep->GetTickRate(), timestep->GetAlpha(), timestep->GetDroppedTime());
+
+	const LevelStreamer * streamer = m_Engine->GetLevelStreamer();
+
+	if (streamer->GetCellCount() != 0)
+	{
+		const LevelStreamer::Stats & stats = streamer->GetStats();
+		ImGui::Text("Streaming = %u / %u cells [Pending : %u, Update : %.2f ms]", stats.LoadedCells, streamer->GetCellCount(), stats.PendingCells, stats.UpdateTime);
+	}
+
+	// frame times of the last frames
+	ImGui::PlotLines("Frame Times", pacer->GetHistory(), FRAME_HISTORY_SIZE, pacer->GetHistoryOffset(), "ms", 0.f, FLT_MAX, ImVec2(0.f, 60.f));
+
+	// distribution of all the frame times
+	float histogram[FRAME_HISTOGRAM_BUCKET_COUNT];
+
+	for (UINT i = 0; i < FRAME_HISTOGRAM_BUCKET_COUNT; ++i)
+	{
+		histogram[i] = (float)pacer->GetHistogram()[i];
+	}
+
+	ImGui::PlotHistogram("Histogram", histogram, FRAME_HISTOGRAM_BUCKET_COUNT, 0, "0 - 40 ms", 0.f, FLT_MAX, ImVec2(0.f, 60.f));
+}
+
+void UIDebug::DrawCPUZones() const
+{
+	const std::vector<CPUProfiler::Event> & events = CPUProfiler::GetLastFrame();
+	const UINT threadCount = CPUProfiler::GetThreadCount();
+
+	// scale of the view : from the previous collect to the last one
+	const UINT64 frameStart		= CPUProfiler::GetLastFrameStart();
+	const UINT64 frameEnd		= CPUProfiler::GetLastFrameEnd();
+	const float frameDuration	= (float)CPUProfiler::TicksToMicroseconds(frameEnd - frameStart);
+
+	ImGui::Text("CPU Frame = %.3f ms [Zones : %u, Dropped : %llu]", frameDuration / 1000.f, (UINT)events.size(), CPUProfiler::GetDroppedZoneCount());
+
+	// rows of each thread
+	std::vector<UINT> depthCount(threadCount, 0);
+
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		if (events[i].Thread < threadCount)
+			depthCount[events[i].Thread] = Math::Max(depthCount[events[i].Thread], events[i].Depth + 1);
+	}
+
+	std::vector<float> threadOffset(threadCount, 0.f);
+	float height = 0.f;
+
+	for (UINT i = 0; i < threadCount; ++i)
+	{
+		threadOffset[i] = height;
+		height += (Math::Max(depthCount[i], 1u) + 1) * CPU_ZONE_ROW_HEIGHT;
+	}
+
+	const ImVec2 origin	= ImGui::GetCursorScreenPos();
+	const float width	= Math::Max(ImGui::GetContentRegionAvailWidth(), 1.f);
+	const float scale	= (frameDuration > 0.f) ? width / frameDuration : 0.f;
+	ImDrawList * drawList = ImGui::GetWindowDrawList();
+
+	// thread names
+	for (UINT i = 0; i < threadCount; ++i)
+	{
+		drawList->AddText(ImVec2(origin.x, origin.y + threadOffset[i]), IM_COL32_WHITE, CPUProfiler::GetThreadName(i));
+	}
+
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		const CPUProfiler::Event & event = events[i];
+
+		if (event.Thread >= threadCount)
+			continue;
+
+		// zones began in the previous frame are clamped
+		const UINT64 start	= Math::Max(event.Start, frameStart);
+		const UINT64 end	= Math::Max(event.End, start);
+		const float begin	= (float)CPUProfiler::TicksToMicroseconds(start - frameStart);
+		const float duration = (float)CPUProfiler::TicksToMicroseconds(end - start);
+
+		const ImVec2 min(origin.x + begin * scale, origin.y + threadOffset[event.Thread] + (event.Depth + 1) * CPU_ZONE_ROW_HEIGHT);
+		const ImVec2 max(Math::Max(min.x + duration * scale, min.x + 1.f), min.y + CPU_ZONE_ROW_HEIGHT - 2.f);
+
+		// color from the name (same zone, same color over the frames)
+		const UINT hash = (UINT)((size_t)event.Name >> 3);
+		const ImU32 color = ImColor(80 + (int)((hash * 53) % 150), 120 + (int)((hash * 97) % 120), 200 - (int)((hash * 31) % 120));
+
+		drawList->AddRectFilled(min, max, color);
+		drawList->PushClipRect(min, max, true);
+		drawList->AddText(ImVec2(min.x + 2.f, min.y + 1.f), IM_COL32_BLACK, event.Name);
+		drawList->PopClipRect();
+
+		if (ImGui::IsMouseHoveringRect(min, max))
+			ImGui::SetTooltip("%s : %.3f ms (start %.3f ms)", event.Name, duration / 1000.f, begin / 1000.f);
+	}
+
+	ImGui::Dummy(ImVec2(width, height));
 }
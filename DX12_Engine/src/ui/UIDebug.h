@@ -15,6 +15,12 @@ private:
 	// Inherited via UIWindow
 	virtual void DrawWindow() override;
 
+	// frame times of the frame pacer
+	void	DrawFramePacing() const;
+
+	// flame view of the CPU zones of the last frame (one band per thread)
+	void	DrawCPUZones() const;
+
 	// direct pointer
 	DirectX::XMFLOAT4 *		m_CameraPos;
 	
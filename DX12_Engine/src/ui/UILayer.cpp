@@ -2,9 +2,11 @@
 
 #include "dx12/DX12RenderEngine.h"
 #include "dx12/DX12ImGui.h"
+#include "dx12/DX12GPUProfiler.h"
 #include "engine/Window.h"
 #include "engine/Utils.h"
 #include "engine/Debug.h"
+#include "engine/CPUProfiler.h"
 #include "ui/UIWindow.h"
 
 // imgui
@@ -217,6 +219,8 @@ UIWindow * UILayer::FindUIWindowById(unsigned int i_Id)
 
 void UILayer::DisplayUIOnLayer()
 {
+	CPU_ZONE("Display UI");
+
 	ImGuiIO & io = ImGui::GetIO();
 
 	// Setup display size (every frame to accommodate for window resizing)
@@ -255,6 +259,8 @@ void UILayer::PushOnCommandList(ID3D12GraphicsCommandList * i_CommandList)
 	if (m_Enabled)
 	{
 		DX12RenderEngine & render = DX12RenderEngine::GetInstance();
+		DX12GPUProfiler::Scope gpuScope(i_CommandList, "UI");
+
 		ImGuiD3D12::SetRenderDataImGui(i_CommandList, render.GetBackBufferDesc());
 		ImGui::Render();	// call to render
 	}
@@ -0,0 +1,118 @@
+#include "UIProfiler.h"
+
+#include "ui/UI.h"
+#include "dx12/DX12RenderEngine.h"
+#include "dx12/DX12GPUProfiler.h"
+#include "engine/GPUProfiler.h"
+
+#define		TIMELINE_ROW_HEIGHT		20.f
+
+UIProfiler::UIProfiler()
+	:UIWindow("GPU Profiler")
+{
+	m_Profiler = DX12RenderEngine::GetInstance().GetGPUProfiler();
+}
+
+UIProfiler::~UIProfiler()
+{
+}
+
+void UIProfiler::DrawWindow()
+{
+	if (m_Profiler == nullptr)
+	{
+		ImGui::Text("No GPU profiler");
+		return;
+	}
+
+	const GPUProfiler & profiler = m_Profiler->GetProfiler();
+
+	ImGui::Text("Resolved frames = %llu [Dropped : %llu, Scope overflow : %llu]", profiler.GetResolvedFrameCount(), profiler.GetDroppedFrameCount(), profiler.GetOverflowCount());
+
+	// frame time history
+	const GPUProfiler::Statistic * frame = profiler.GetStatistic("Frame");
+
+	if (frame != nullptr)
+	{
+		char overlay[64];
+		sprintf_s(overlay, "%.3f ms [avg %.3f ms]", frame->Last, frame->Average);
+
+		// the ring is read from the oldest sample
+		const int offset = (frame->Count < (UINT)frame->History.size()) ? 0 : (int)frame->Head;
+		ImGui::PlotLines("GPU Frame", frame->History.data(), (int)frame->Count, offset, overlay, 0.f, frame->Max * 1.2f, ImVec2(0.f, 60.f));
+	}
+
+	if (ImGui::CollapsingHeader("Timeline", ImGuiTreeNodeFlags_DefaultOpen))
+		DrawTimeline();
+
+	if (ImGui::CollapsingHeader("Statistics", ImGuiTreeNodeFlags_DefaultOpen))
+		DrawStatistics();
+}
+
+void UIProfiler::DrawTimeline() const
+{
+	const std::vector<GPUProfiler::Timing> & timings = m_Profiler->GetProfiler().GetTimings();
+
+	// scale of the timeline : the whole frame
+	float frameEnd = 0.f;
+	UINT depthCount = 1;
+
+	for (size_t i = 0; i < timings.size(); ++i)
+	{
+		frameEnd	= Math::Max(frameEnd, timings[i].Start + timings[i].Duration);
+		depthCount	= Math::Max(depthCount, timings[i].Depth + 1);
+	}
+
+	const ImVec2 origin	= ImGui::GetCursorScreenPos();
+	const float width	= Math::Max(ImGui::GetContentRegionAvailWidth(), 1.f);
+	const float scale	= (frameEnd > 0.f) ? width / frameEnd : 0.f;
+	ImDrawList * drawList = ImGui::GetWindowDrawList();
+
+	// one row per nested level
+	for (size_t i = 0; i < timings.size(); ++i)
+	{
+		const GPUProfiler::Timing & timing = timings[i];
+
+		const ImVec2 min(origin.x + timing.Start * scale, origin.y + timing.Depth * TIMELINE_ROW_HEIGHT);
+		const ImVec2 max(Math::Max(min.x + timing.Duration * scale, min.x + 1.f), min.y + TIMELINE_ROW_HEIGHT - 2.f);
+
+		// color from the scope index
+		const ImU32 color = ImColor(80 + (int)(i * 53) % 150, 120 + (int)(i * 97) % 120, 200 - (int)(i * 31) % 120);
+
+		drawList->AddRectFilled(min, max, color);
+		drawList->PushClipRect(min, max, true);
+		drawList->AddText(ImVec2(min.x + 2.f, min.y + 2.f), IM_COL32_BLACK, timing.Name.c_str());
+		drawList->PopClipRect();
+
+		if (ImGui::IsMouseHoveringRect(min, max))
+			ImGui::SetTooltip("%s : %.3f ms (start %.3f ms)", timing.Name.c_str(), timing.Duration, timing.Start);
+	}
+
+	ImGui::Dummy(ImVec2(width, depthCount * TIMELINE_ROW_HEIGHT));
+}
+
+void UIProfiler::DrawStatistics() const
+{
+	const std::vector<GPUProfiler::Statistic> & statistics = m_Profiler->GetProfiler().GetStatistics();
+
+	ImGui::Columns(5, "GPU Statistics");
+	ImGui::Text("Scope");	ImGui::NextColumn();
+	ImGui::Text("Last");	ImGui::NextColumn();
+	ImGui::Text("Average");	ImGui::NextColumn();
+	ImGui::Text("Min");		ImGui::NextColumn();
+	ImGui::Text("Max");		ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (size_t i = 0; i < statistics.size(); ++i)
+	{
+		const GPUProfiler::Statistic & statistic = statistics[i];
+
+		ImGui::Text("%*s%s", (int)statistic.Depth * 2, "", statistic.Name.c_str());	ImGui::NextColumn();
+		ImGui::Text("%.3f ms", statistic.Last);		ImGui::NextColumn();
+		ImGui::Text("%.3f ms", statistic.Average);	ImGui::NextColumn();
+		ImGui::Text("%.3f ms", statistic.Min);		ImGui::NextColumn();
+		ImGui::Text("%.3f ms", statistic.Max);		ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
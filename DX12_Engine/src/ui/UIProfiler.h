@@ -0,0 +1,26 @@
+// GPU profiler UI window
+// timeline of the passes of the last resolved frame and rolling statistics of each scope
+
+#pragma once
+
+#include "ui/UIWindow.h"
+
+class DX12GPUProfiler;
+
+class UIProfiler : public UIWindow
+{
+public:
+	UIProfiler();
+	~UIProfiler();
+private:
+
+	// Inherited via UIWindow
+	virtual void DrawWindow() override;
+
+	// helpers
+	void	DrawTimeline() const;
+	void	DrawStatistics() const;
+
+	// profiler of the render engine
+	const DX12GPUProfiler *		m_Profiler;
+};